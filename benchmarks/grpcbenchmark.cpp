@@ -0,0 +1,343 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>, Viktor Kopp <vifactor@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "testservice_grpc.qpb.h"
+
+#include <QGrpcHttp2Channel>
+#include <QGrpcInsecureCredentials>
+#ifdef QT_PROTOBUF_NATIVE_GRPC_CHANNEL
+#include <QGrpcChannel>
+#endif
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QHash>
+#include <QProcess>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+using namespace qtprotobufnamespace::tests;
+using namespace QtProtobuf;
+
+namespace {
+const QUrl EchoServerAddress("http://localhost:50051", QUrl::StrictMode);
+#ifdef QT_PROTOBUF_NATIVE_GRPC_CHANNEL
+const QString EchoServerAddressNative("localhost:50051");
+#endif
+const int WarmUpCalls = 100;
+const int CallTimeout = 60000;
+
+//! \brief Result of single benchmark run
+struct BenchmarkResult {
+    QString channel;
+    QString benchmark;
+    int payload = 0;
+    int count = 0;
+    int failed = 0;
+    double rate = 0;
+    double p50 = 0;
+    double p99 = 0;
+    double cpuPerCall = 0;
+    qint64 memoryGrowth = -1;
+};
+
+//! \brief Returns resident set size of process in KiB or -1 if it's unknown
+qint64 residentMemory()
+{
+#ifdef Q_OS_LINUX
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1) {
+            return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE) / 1024;
+        }
+    }
+#endif
+    return -1;
+}
+
+double percentile(std::vector<qint64> &latencies, double percentile)
+{
+    if (latencies.empty()) {
+        return 0;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    const size_t index = std::min(latencies.size() - 1, static_cast<size_t>(percentile / 100.0 * latencies.size()));
+    return latencies[index] / 1000.0;
+}
+
+//! \brief Measures time, CPU time and memory growth of benchmark run
+class RunMeter {
+public:
+    RunMeter() : m_cpu(std::clock())
+      , m_memory(residentMemory())
+    {
+        m_timer.start();
+    }
+
+    void finish(BenchmarkResult &result) const {
+        const double seconds = m_timer.nsecsElapsed() / 1e9;
+        const double cpuSeconds = static_cast<double>(std::clock() - m_cpu) / CLOCKS_PER_SEC;
+        const qint64 memory = residentMemory();
+        result.rate = seconds > 0 ? result.count / seconds : 0;
+        result.cpuPerCall = result.count > 0 ? cpuSeconds * 1e6 / result.count : 0;
+        result.memoryGrowth = memory >= 0 && m_memory >= 0 ? memory - m_memory : -1;
+    }
+
+private:
+    QElapsedTimer m_timer;
+    std::clock_t m_cpu;
+    qint64 m_memory;
+};
+
+//! \brief Makes \a calls unary calls with \a payload bytes long argument keeping \a concurrency calls in flight
+BenchmarkResult runUnary(TestServiceClient &client, int payload, int calls, int concurrency)
+{
+    BenchmarkResult result;
+    result.benchmark = concurrency > 1 ? QString("unary x%1").arg(concurrency) : QString("unary");
+    result.payload = payload;
+
+    SimpleStringMessage request;
+    request.setTestFieldString(QString(payload, QChar('x')));
+
+    std::vector<qint64> latencies;
+    latencies.reserve(static_cast<size_t>(calls));
+    QHash<QGrpcAsyncReply *, QGrpcAsyncReplyShared> pending;
+    int started = 0;
+    int finished = 0;
+    QEventLoop loop;
+
+    std::function<void()> startCall;
+    auto complete = [&](QGrpcAsyncReply *reply, const QElapsedTimer &timer, bool ok) {
+        if (pending.remove(reply) == 0) {
+            return;
+        }
+        latencies.push_back(timer.nsecsElapsed() / 1000);
+        if (!ok) {
+            ++result.failed;
+        }
+        if (++finished == calls) {
+            loop.quit();
+        } else if (started < calls) {
+            startCall();
+        }
+    };
+    startCall = [&] {
+        ++started;
+        QElapsedTimer timer;
+        timer.start();
+        QGrpcAsyncReplyShared reply = client.testMethod(request);
+        QGrpcAsyncReply *replyPtr = reply.get();
+        pending.insert(replyPtr, reply);
+        QObject::connect(replyPtr, &QGrpcAsyncReply::finished, &loop, [&complete, replyPtr, timer] {
+            complete(replyPtr, timer, true);
+        });
+        QObject::connect(replyPtr, &QGrpcAsyncReply::error, &loop, [&complete, replyPtr, timer] {
+            complete(replyPtr, timer, false);
+        });
+    };
+
+    RunMeter meter;
+    for (int i = 0; i < std::min(concurrency, calls); ++i) {
+        startCall();
+    }
+    QTimer::singleShot(CallTimeout, &loop, &QEventLoop::quit);
+    if (calls > 0) {
+        loop.exec();
+    }
+    result.count = finished;
+    meter.finish(result);
+    result.p50 = percentile(latencies, 50);
+    result.p99 = percentile(latencies, 99);
+    return result;
+}
+
+//! \brief Sends \a messages messages with \a payload bytes long field to bidirectional echo stream keeping
+//!        \a window messages in flight
+BenchmarkResult runStream(TestServiceClient &client, int payload, int messages, int window)
+{
+    BenchmarkResult result;
+    result.benchmark = QString("bidi stream");
+    result.payload = payload;
+
+    SimpleStringMessage request;
+    request.setTestFieldString(QString(payload, QChar('x')));
+
+    std::vector<qint64> latencies;
+    latencies.reserve(static_cast<size_t>(messages));
+    std::vector<QElapsedTimer> sent;
+    sent.reserve(static_cast<size_t>(messages));
+    int received = 0;
+    QEventLoop loop;
+
+    RunMeter meter;
+    QGrpcClientStreamShared stream = client.streamTestMethodBiStream();
+    auto send = [&] {
+        QElapsedTimer timer;
+        timer.start();
+        sent.push_back(timer);
+        stream->write(request);
+    };
+    QObject::connect(stream.get(), &QGrpcClientStream::messageReceived, &loop, [&] {
+        //Echo server responds in order, so response matches the oldest message in flight
+        latencies.push_back(sent[static_cast<size_t>(received)].nsecsElapsed() / 1000);
+        if (++received == messages) {
+            stream->writesDone();
+            loop.quit();
+        } else if (static_cast<int>(sent.size()) < messages) {
+            send();
+        }
+    });
+    QObject::connect(stream.get(), &QGrpcClientStream::error, &loop, [&] {
+        result.failed = messages - received;
+        loop.quit();
+    });
+    for (int i = 0; i < std::min(window, messages); ++i) {
+        send();
+    }
+    QTimer::singleShot(CallTimeout, &loop, &QEventLoop::quit);
+    if (messages > 0) {
+        loop.exec();
+    }
+    result.count = received;
+    meter.finish(result);
+    result.p50 = percentile(latencies, 50);
+    result.p99 = percentile(latencies, 99);
+    return result;
+}
+
+void printRow(QTextStream &out, const QStringList &columns)
+{
+    const int widths[] = {-8, -14, 9, 10, 8, 12, 10, 10, 12, 12};
+    QString row;
+    for (int i = 0; i < columns.size(); ++i) {
+        row += widths[i] < 0 ? columns.at(i).leftJustified(-widths[i]) : columns.at(i).rightJustified(widths[i]);
+    }
+    out << row << "\n";
+    out.flush();
+}
+
+void printResult(QTextStream &out, const BenchmarkResult &result)
+{
+    printRow(out, {result.channel, result.benchmark, QString::number(result.payload), QString::number(result.count),
+                   QString::number(result.failed), QString::number(result.rate, 'f', 1), QString::number(result.p50, 'f', 3),
+                   QString::number(result.p99, 'f', 3), QString::number(result.cpuPerCall, 'f', 1),
+                   result.memoryGrowth >= 0 ? QString::number(result.memoryGrowth) : QString("n/a")});
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QtProtobuf::qRegisterProtobufTypes();
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures throughput and latency of QtGrpc channels against echo server");
+    parser.addHelpOption();
+    QCommandLineOption serverOption("server", "Starts echo server <path> for the time of benchmark.", "path");
+    QCommandLineOption callsOption("calls", "Number of unary calls or stream messages per run.", "count", "10000");
+    QCommandLineOption concurrencyOption("concurrency", "Number of unary calls or stream messages in flight.", "count", "16");
+    QCommandLineOption payloadsOption("payloads", "Comma separated sizes of payload in bytes.", "sizes", "16,1024,65536");
+    parser.addOptions({serverOption, callsOption, concurrencyOption, payloadsOption});
+    parser.process(app);
+
+    const int calls = parser.value(callsOption).toInt();
+    const int concurrency = std::max(parser.value(concurrencyOption).toInt(), 1);
+    QList<int> payloads;
+    for (const QString &payload : parser.value(payloadsOption).split(',')) {
+        if (!payload.isEmpty()) {
+            payloads.append(payload.toInt());
+        }
+    }
+    QList<int> concurrencies{1};
+    if (concurrency > 1) {
+        concurrencies.append(concurrency);
+    }
+
+    QProcess server;
+    if (parser.isSet(serverOption)) {
+        //Echo server logs every call, its output is dropped to not affect measurements
+        server.setStandardOutputFile(QProcess::nullDevice());
+        server.setStandardErrorFile(QProcess::nullDevice());
+        server.start(parser.value(serverOption), QStringList());
+        if (!server.waitForStarted()) {
+            qCritical() << "Unable to start echo server" << parser.value(serverOption);
+            return 1;
+        }
+        QThread::msleep(200);
+    }
+
+    std::vector<std::pair<QString, std::function<std::shared_ptr<QAbstractGrpcChannel>()>>> channels;
+    channels.emplace_back("http2", [] {
+        return std::make_shared<QGrpcHttp2Channel>(EchoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials());
+    });
+#ifdef QT_PROTOBUF_NATIVE_GRPC_CHANNEL
+    channels.emplace_back("native", [] {
+        return std::make_shared<QGrpcChannel>(EchoServerAddressNative, grpc::InsecureChannelCredentials());
+    });
+#endif
+
+    QTextStream out(stdout);
+    printRow(out, {"channel", "benchmark", "payload", "count", "failed", "per sec", "p50 ms", "p99 ms", "cpu us/op", "rss KiB"});
+
+    for (const auto &channel : channels) {
+        TestServiceClient client;
+        client.attachChannel(channel.second());
+        runUnary(client, 16, WarmUpCalls, 1);
+
+        for (int payload : payloads) {
+            for (int callConcurrency : concurrencies) {
+                BenchmarkResult result = runUnary(client, payload, calls, callConcurrency);
+                result.channel = channel.first;
+                printResult(out, result);
+            }
+            BenchmarkResult result = runStream(client, payload, calls, concurrency);
+            result.channel = channel.first;
+            printResult(out, result);
+        }
+    }
+
+    if (server.state() != QProcess::NotRunning) {
+        server.kill();
+        server.waitForFinished();
+    }
+    return 0;
+}
@@ -0,0 +1,436 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "testservice_grpc.qpb.h"
+
+#include <QGrpcHttp2Channel>
+#include <QGrpcInsecureCredentials>
+#include <QGrpcReconnectPolicy>
+#ifdef QT_PROTOBUF_NATIVE_GRPC_CHANNEL
+#include <QGrpcChannel>
+#endif
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+
+#ifdef QT_PROTOBUF_BENCHMARK_QOBJECT_HOOKS
+#include <private/qhooks_p.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+using namespace qtprotobufnamespace::tests;
+using namespace QtProtobuf;
+
+namespace {
+const QUrl EchoServerAddress("http://localhost:50051", QUrl::StrictMode);
+#ifdef QT_PROTOBUF_NATIVE_GRPC_CHANNEL
+const QString EchoServerAddressNative("localhost:50051");
+#endif
+const int ServerStartDelay = 200;
+const int WarmUpCycles = 50;
+
+//! \brief Resources of process, sampled while soak test runs
+struct Sample {
+    int cycle = 0;
+    double seconds = 0;
+    double usPerCycle = 0;
+    qint64 rss = -1;
+    qint64 qobjects = -1;
+    int sockets = -1;
+    int descriptors = -1;
+};
+
+//! \brief Returns resident set size of process in KiB or -1 if it's unknown
+qint64 residentMemory()
+{
+#ifdef Q_OS_LINUX
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1) {
+            return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE) / 1024;
+        }
+    }
+#endif
+    return -1;
+}
+
+//! \brief Counts open file descriptors and sockets of process, both are -1 if it's unknown
+void openDescriptors(int &descriptors, int &sockets)
+{
+    descriptors = -1;
+    sockets = -1;
+#ifdef Q_OS_LINUX
+    QDir fds("/proc/self/fd");
+    if (!fds.exists()) {
+        return;
+    }
+    descriptors = 0;
+    sockets = 0;
+    for (const QFileInfo &fd : fds.entryInfoList(QDir::System | QDir::NoDotAndDotDot)) {
+        ++descriptors;
+        if (fd.symLinkTarget().contains("socket:")) {
+            ++sockets;
+        }
+    }
+#endif
+}
+
+#ifdef QT_PROTOBUF_BENCHMARK_QOBJECT_HOOKS
+//Counter of live QObjects, maintained by QtCore hooks that are used by debugging tools
+std::atomic<qint64> liveObjects(0);
+QHooks::AddQObjectCallback previousAddHook = nullptr;
+QHooks::RemoveQObjectCallback previousRemoveHook = nullptr;
+
+void addQObject(QObject *object)
+{
+    ++liveObjects;
+    if (previousAddHook) {
+        previousAddHook(object);
+    }
+}
+
+void removeQObject(QObject *object)
+{
+    --liveObjects;
+    if (previousRemoveHook) {
+        previousRemoveHook(object);
+    }
+}
+#endif
+
+//! \brief Installs counter of live QObjects, objects created before installation are not counted
+void installQObjectCounter()
+{
+#ifdef QT_PROTOBUF_BENCHMARK_QOBJECT_HOOKS
+    previousAddHook = reinterpret_cast<QHooks::AddQObjectCallback>(qtHookData[QHooks::AddQObject]);
+    previousRemoveHook = reinterpret_cast<QHooks::RemoveQObjectCallback>(qtHookData[QHooks::RemoveQObject]);
+    qtHookData[QHooks::AddQObject] = reinterpret_cast<quintptr>(&addQObject);
+    qtHookData[QHooks::RemoveQObject] = reinterpret_cast<quintptr>(&removeQObject);
+#endif
+}
+
+//! \brief Returns number of live QObjects created after installQObjectCounter() call or -1 if it's unknown
+qint64 liveQObjects()
+{
+#ifdef QT_PROTOBUF_BENCHMARK_QOBJECT_HOOKS
+    return liveObjects;
+#else
+    return -1;
+#endif
+}
+
+//! \brief Runs event loop for \a msecs or until \a done becomes true
+void processEvents(int msecs, const std::function<bool()> &done = nullptr)
+{
+    QElapsedTimer timer;
+    timer.start();
+    do {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
+    } while (timer.elapsed() < msecs && !(done && done()));
+    //Canceled streams are released using deleteLater, they shouldn't be counted as leaked
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+}
+
+Sample sample(int cycle, const QElapsedTimer &timer, qint64 cycleTime)
+{
+    Sample result;
+    result.cycle = cycle;
+    result.seconds = timer.nsecsElapsed() / 1e9;
+    result.usPerCycle = cycleTime / 1000.0;
+    result.rss = residentMemory();
+    result.qobjects = liveQObjects();
+    openDescriptors(result.descriptors, result.sockets);
+    return result;
+}
+
+QString formatValue(qint64 value)
+{
+    return value >= 0 ? QString::number(value) : QString("n/a");
+}
+
+QString formatGrowth(qint64 from, qint64 to)
+{
+    return from >= 0 && to >= 0 ? QString("%1%2").arg(to >= from ? "+" : "").arg(to - from) : QString("n/a");
+}
+
+void printRow(QTextStream &out, const QStringList &columns)
+{
+    const int widths[] = {-8, 8, 9, 12, 10, 10, 9, 6, 9};
+    QString row;
+    for (int i = 0; i < columns.size(); ++i) {
+        row += widths[i] < 0 ? columns.at(i).leftJustified(-widths[i]) : columns.at(i).rightJustified(widths[i]);
+    }
+    out << row << "\n";
+    out.flush();
+}
+
+void printSample(QTextStream &out, const QString &channel, const Sample &sample, int restarts)
+{
+    printRow(out, {channel, QString::number(sample.cycle), QString::number(sample.seconds, 'f', 1),
+                   QString::number(sample.usPerCycle, 'f', 1), formatValue(sample.rss), formatValue(sample.qobjects),
+                   formatValue(sample.sockets), formatValue(sample.descriptors), QString::number(restarts)});
+}
+
+//! \brief Echo server process, that may be restarted to break connections of channel
+class EchoServer {
+public:
+    bool start(const QString &path) {
+        m_path = path;
+        //Echo server logs every call, its output is dropped to not affect measurements
+        m_process.setStandardOutputFile(QProcess::nullDevice());
+        m_process.setStandardErrorFile(QProcess::nullDevice());
+        m_process.start(m_path, QStringList());
+        if (!m_process.waitForStarted()) {
+            qCritical() << "Unable to start echo server" << m_path;
+            return false;
+        }
+        QThread::msleep(ServerStartDelay);
+        return true;
+    }
+
+    bool restart() {
+        stop();
+        return start(m_path);
+    }
+
+    void stop() {
+        if (m_process.state() != QProcess::NotRunning) {
+            m_process.kill();
+            m_process.waitForFinished();
+        }
+    }
+
+    bool isStarted() const {
+        return !m_path.isEmpty();
+    }
+
+private:
+    QString m_path;
+    QProcess m_process;
+};
+
+//! \brief Parameters of soak run
+struct SoakOptions {
+    int cycles = 0;
+    int hold = 0;
+    int reportEvery = 0;
+    int reconnectEvery = 0;
+    int restartEvery = 0;
+    int streams = 0;
+};
+
+//! \brief Churns subscribe/cancel/reconnect cycles and prints samples of process resources
+//! \return false if QObjects or sockets are not released after all streams are canceled
+bool runSoak(QTextStream &out, const QString &channelName, const std::function<std::shared_ptr<QAbstractGrpcChannel>()> &makeChannel,
+             const SoakOptions &options, EchoServer &server)
+{
+    const auto reconnectPolicy = std::make_shared<QGrpcReconnectPolicy>(std::chrono::milliseconds(50),
+                                                                        std::chrono::milliseconds(500));
+    TestServiceClient client;
+    auto attachChannel = [&] {
+        std::shared_ptr<QAbstractGrpcChannel> channel = makeChannel();
+        channel->setReconnectPolicy(reconnectPolicy);
+        client.attachChannel(channel);
+    };
+    attachChannel();
+
+    SimpleStringMessage request;
+    auto runCycle = [&](int cycle) {
+        //Every stream has unique argument, otherwise client merges it with already running one
+        request.setTestFieldString(QString("soak%1").arg(cycle));
+        QGrpcStreamShared serverStream = client.subscribeTestMethodServerStream(request);
+
+        bool echoed = false;
+        QGrpcClientStreamShared biStream = client.streamTestMethodBiStream();
+        QMetaObject::Connection echo = QObject::connect(biStream.get(), &QGrpcClientStream::messageReceived, [&echoed] {
+            echoed = true;
+        });
+        biStream->write(request);
+        processEvents(options.hold, [&echoed] { return echoed; });
+        QObject::disconnect(echo);
+
+        serverStream->cancel();
+        biStream->cancel();
+    };
+
+    //Lazy initialization of channel and first connection are not counted as growth
+    for (int cycle = 0; cycle < WarmUpCycles; ++cycle) {
+        runCycle(-cycle - 1);
+    }
+    processEvents(options.hold);
+
+    int restarts = 0;
+    QElapsedTimer timer;
+    timer.start();
+    const Sample baseline = sample(0, timer, 0);
+    printSample(out, channelName, baseline, restarts);
+
+    //Long living streams are restored by reconnect policy every time server restarts. Echo server finishes
+    //stream after few messages, so finished streams are subscribed again.
+    std::vector<QGrpcStreamShared> persistentStreams(static_cast<size_t>(options.streams));
+    std::vector<int> finishedStreams(persistentStreams.size(), 1);
+    int resubscriptions = 0;
+    auto renewStreams = [&] {
+        for (size_t i = 0; i < persistentStreams.size(); ++i) {
+            if (!finishedStreams[i]) {
+                continue;
+            }
+            finishedStreams[i] = 0;
+            request.setTestFieldString(QString("persistent%1-%2").arg(i).arg(resubscriptions++));
+            persistentStreams[i] = client.subscribeTestMethodServerStream(request);
+            QObject::connect(persistentStreams[i].get(), &QGrpcStream::finished, persistentStreams[i].get(), [&finishedStreams, i] {
+                finishedStreams[i] = 1;
+            });
+        }
+    };
+    renewStreams();
+
+    QElapsedTimer cycleTimer;
+    qint64 reportTime = 0;
+    Sample last = baseline;
+    for (int cycle = 1; cycle <= options.cycles; ++cycle) {
+        cycleTimer.start();
+        runCycle(cycle);
+        renewStreams();
+        if (options.reconnectEvery > 0 && cycle % options.reconnectEvery == 0) {
+            attachChannel();
+        }
+        if (server.isStarted() && options.restartEvery > 0 && cycle % options.restartEvery == 0) {
+            if (!server.restart()) {
+                return false;
+            }
+            ++restarts;
+        }
+        reportTime += cycleTimer.nsecsElapsed();
+
+        if (cycle % options.reportEvery == 0 || cycle == options.cycles) {
+            const int cycles = cycle - last.cycle;
+            last = sample(cycle, timer, cycles > 0 ? reportTime / cycles : 0);
+            printSample(out, channelName, last, restarts);
+            reportTime = 0;
+        }
+    }
+
+    for (const QGrpcStreamShared &stream : persistentStreams) {
+        stream->cancel();
+    }
+    persistentStreams.clear();
+    processEvents(options.hold);
+
+    const Sample canceled = sample(options.cycles, timer, 0);
+    out << "\n" << channelName << " growth after " << options.cycles << " cycles: rss "
+        << formatGrowth(baseline.rss, last.rss) << " KiB, QObjects " << formatGrowth(baseline.qobjects, canceled.qobjects)
+        << ", sockets " << formatGrowth(baseline.sockets, canceled.sockets) << " after all streams are canceled\n\n";
+    out.flush();
+
+    //Growth of memory is only reported, because allocator doesn't necessarily return freed memory to system
+    return (baseline.qobjects < 0 || canceled.qobjects <= baseline.qobjects)
+            && (baseline.sockets < 0 || canceled.sockets <= baseline.sockets);
+}
+}
+
+int main(int argc, char *argv[])
+{
+    installQObjectCounter();
+    QCoreApplication app(argc, argv);
+    QtProtobuf::qRegisterProtobufTypes();
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Churns stream subscribe/cancel/reconnect cycles against echo server and reports "
+                                     "growth of memory, QObjects and sockets");
+    parser.addHelpOption();
+    QCommandLineOption serverOption("server", "Starts echo server <path> for the time of benchmark.", "path");
+    QCommandLineOption cyclesOption("cycles", "Number of subscribe/cancel cycles per channel.", "count", "5000");
+    QCommandLineOption holdOption("hold", "Maximum time in milliseconds streams are kept open in every cycle.", "msecs", "5");
+    QCommandLineOption reportOption("report-every", "Number of cycles in between of samples.", "count", "500");
+    QCommandLineOption reconnectOption("reconnect-every", "Number of cycles client keeps channel for, zero disables reconnection.",
+                                       "count", "100");
+    QCommandLineOption restartOption("restart-every", "Number of cycles in between of echo server restarts, zero disables "
+                                     "restarts. Requires --server.", "count", "1000");
+    QCommandLineOption streamsOption("streams", "Number of streams kept open for the whole run.", "count", "4");
+    QCommandLineOption strictOption("strict", "Fails if QObjects or sockets are not released after all streams are canceled.");
+    parser.addOptions({serverOption, cyclesOption, holdOption, reportOption, reconnectOption, restartOption, streamsOption,
+                       strictOption});
+    parser.process(app);
+
+    SoakOptions options;
+    options.cycles = std::max(parser.value(cyclesOption).toInt(), 1);
+    options.hold = std::max(parser.value(holdOption).toInt(), 0);
+    options.reportEvery = std::max(parser.value(reportOption).toInt(), 1);
+    options.reconnectEvery = std::max(parser.value(reconnectOption).toInt(), 0);
+    options.restartEvery = std::max(parser.value(restartOption).toInt(), 0);
+    options.streams = std::max(parser.value(streamsOption).toInt(), 0);
+
+    EchoServer server;
+    if (parser.isSet(serverOption) && !server.start(parser.value(serverOption))) {
+        return 1;
+    }
+
+    std::vector<std::pair<QString, std::function<std::shared_ptr<QAbstractGrpcChannel>()>>> channels;
+    channels.emplace_back("http2", [] {
+        return std::make_shared<QGrpcHttp2Channel>(EchoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials());
+    });
+#ifdef QT_PROTOBUF_NATIVE_GRPC_CHANNEL
+    channels.emplace_back("native", [] {
+        return std::make_shared<QGrpcChannel>(EchoServerAddressNative, grpc::InsecureChannelCredentials());
+    });
+#endif
+
+    QTextStream out(stdout);
+    printRow(out, {"channel", "cycle", "seconds", "us/cycle", "rss KiB", "QObjects", "sockets", "fds", "restarts"});
+
+    bool released = true;
+    for (const auto &channel : channels) {
+        released = runSoak(out, channel.first, channel.second, options, server) && released;
+    }
+
+    server.stop();
+    if (!released && parser.isSet(strictOption)) {
+        qCritical() << "QObjects or sockets are leaked by stream cycles";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,338 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>, Viktor Kopp <vifactor@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "benchmark.qpb.h"
+#ifdef QT_PROTOBUF_BENCHMARK_LIBPROTOBUF
+#include "benchmark.pb.h"
+#endif
+
+#include <QHash>
+#include <QObject>
+#include <QtTest>
+
+#include <qprotobufjsonserializer.h>
+#include <qprotobufserializer.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <cstdlib>
+#include <string>
+
+using namespace QtProtobuf;
+
+namespace qt = QtProtobufBenchmark::qtprotobufnamespace::benchmarks;
+#ifdef QT_PROTOBUF_BENCHMARK_LIBPROTOBUF
+namespace pb = ::qtprotobufnamespace::benchmarks;
+#define QT_PROTOBUF_BENCHMARK_PB(Type) pb::Type
+#else
+#define QT_PROTOBUF_BENCHMARK_PB(Type) void
+#endif
+
+namespace {
+std::atomic<quint64> allocationCount{0};
+std::atomic<bool> allocationCounting{false};
+
+inline void countAllocation()
+{
+    if (allocationCounting.load(std::memory_order_relaxed)) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+}
+
+#ifdef __GLIBC__
+//Heap allocations are counted by interposing malloc family, since Qt containers don't use operator new
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) __THROW
+{
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) __THROW
+{
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) __THROW
+{
+    countAllocation();
+    return __libc_realloc(ptr, size);
+}
+}
+#endif
+
+namespace {
+enum Format {
+    Protobuf,
+    Json,
+    LibProtobuf
+};
+
+const char *FormatNames[] = {"protobuf", "json", "libprotobuf"};
+
+const int PackedSize = 1000;
+const int MapSize = 100;
+const int LargeRepeatedSize = 10000;
+}
+
+class SerializationBenchmark : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+
+    void serialize_data() { addRows(); }
+    void serialize();
+    void deserialize_data() { addRows(); }
+    void deserialize();
+    void serializeAllocations_data() { addRows(); }
+    void serializeAllocations();
+    void deserializeAllocations_data() { addRows(); }
+    void deserializeAllocations();
+
+private:
+    void addRows();
+    std::function<void()> operation(const QString &message, int format, bool serialize);
+    void countAllocations(bool serialize);
+
+    template<typename T, typename PbT>
+    std::function<void()> messageOperation(const T &message, int format, bool serialize);
+
+    std::unique_ptr<QProtobufSerializer> m_serializer;
+    std::unique_ptr<QProtobufJsonSerializer> m_jsonSerializer;
+    qt::ScalarMessage m_scalar;
+    qt::PackedMessage m_packed;
+    qt::StringMessage m_string;
+    qt::NestedMessage m_nested;
+    qt::MapMessage m_map;
+    qt::LargeRepeatedMessage m_largeRepeated;
+};
+
+void SerializationBenchmark::initTestCase()
+{
+    QtProtobuf::qRegisterProtobufTypes();
+    m_serializer.reset(new QProtobufSerializer);
+    m_jsonSerializer.reset(new QProtobufJsonSerializer);
+
+    m_scalar.setFieldInt32(-123456);
+    m_scalar.setFieldInt64(-1234567890123);
+    m_scalar.setFieldUInt32(123456);
+    m_scalar.setFieldUInt64(1234567890123);
+    m_scalar.setFieldSInt32(-123456);
+    m_scalar.setFieldSInt64(-1234567890123);
+    m_scalar.setFieldFixed32(123456);
+    m_scalar.setFieldFixed64(1234567890123);
+    m_scalar.setFieldSFixed32(-123456);
+    m_scalar.setFieldSFixed64(-1234567890123);
+    m_scalar.setFieldFloat(0.125f);
+    m_scalar.setFieldDouble(-1234.5678);
+    m_scalar.setFieldBool(true);
+
+    int32List ints;
+    sint64List sints;
+    fixed32List fixeds;
+    DoubleList doubles;
+    for (int i = 0; i < PackedSize; ++i) {
+        ints.append(i * 997 - 500000);
+        sints.append(static_cast<qint64>(i) * -1234567);
+        fixeds.append(static_cast<quint32>(i) * 4099);
+        doubles.append(i * 0.5);
+    }
+    m_packed.setFieldInt32(ints);
+    m_packed.setFieldSInt64(sints);
+    m_packed.setFieldFixed32(fixeds);
+    m_packed.setFieldDouble(doubles);
+
+    QStringList strings;
+    for (int i = 0; i < MapSize; ++i) {
+        strings.append(QString("string %1").arg(i));
+    }
+    m_string.setFieldString(QString(1024, QChar('q')));
+    m_string.setFieldBytes(QByteArray(1024, '\x7f'));
+    m_string.setFieldRepeatedString(strings);
+
+    m_nested.setId(42);
+    qt::StringMessage nestedStrings;
+    nestedStrings.setFieldString("nested");
+    nestedStrings.setFieldBytes(QByteArray(16, '\x01'));
+    nestedStrings.setFieldRepeatedString({"a", "b", "c"});
+    m_nested.setStrings(nestedStrings);
+    m_nested.setScalars(m_scalar);
+
+    qt::MapMessage::FieldInt32StringEntry int32Strings;
+    qt::MapMessage::FieldStringNestedEntry stringNested;
+    for (int i = 0; i < MapSize; ++i) {
+        int32Strings.insert(i, strings.at(i));
+        stringNested.insert(strings.at(i), QSharedPointer<qt::NestedMessage>(new qt::NestedMessage(m_nested)));
+    }
+    m_map.setFieldInt32String(int32Strings);
+    m_map.setFieldStringNested(stringNested);
+
+    qt::NestedMessageRepeated items;
+    for (int i = 0; i < LargeRepeatedSize; ++i) {
+        QSharedPointer<qt::NestedMessage> item(new qt::NestedMessage(m_nested));
+        item->setId(i);
+        items.append(item);
+    }
+    m_largeRepeated.setItems(items);
+}
+
+void SerializationBenchmark::addRows()
+{
+    QTest::addColumn<QString>("message");
+    QTest::addColumn<int>("format");
+
+    const char *messages[] = {"ScalarMessage", "PackedMessage", "StringMessage", "NestedMessage", "MapMessage", "LargeRepeatedMessage"};
+#ifdef QT_PROTOBUF_BENCHMARK_LIBPROTOBUF
+    const int formatCount = 3;
+#else
+    const int formatCount = 2;
+#endif
+    for (const char *message : messages) {
+        for (int format = 0; format < formatCount; ++format) {
+            QTest::newRow(QString("%1/%2").arg(message, FormatNames[format]).toLatin1().constData()) << QString(message) << format;
+        }
+    }
+}
+
+template<typename T, typename PbT>
+std::function<void()> SerializationBenchmark::messageOperation(const T &message, int format, bool serialize)
+{
+#ifdef QT_PROTOBUF_BENCHMARK_LIBPROTOBUF
+    if (format == LibProtobuf) {
+        //libprotobuf message is filled from the same wire data, so both libraries process identical content
+        const QByteArray payload = message.serialize(m_serializer.get());
+        auto source = std::make_shared<PbT>();
+        const bool parsed = source->ParseFromArray(payload.constData(), payload.size());
+        Q_ASSERT(parsed);
+        Q_UNUSED(parsed)
+        if (serialize) {
+            return [source] {
+                std::string data;
+                source->SerializeToString(&data);
+            };
+        }
+        const std::string data(payload.constData(), static_cast<size_t>(payload.size()));
+        return [data] {
+            PbT result;
+            const bool ok = result.ParseFromString(data);
+            Q_UNUSED(ok)
+        };
+    }
+#endif
+
+    QAbstractProtobufSerializer *serializer = format == Json ? static_cast<QAbstractProtobufSerializer *>(m_jsonSerializer.get())
+                                                             : m_serializer.get();
+    if (serialize) {
+        return [&message, serializer] {
+            QByteArray data = message.serialize(serializer);
+            Q_UNUSED(data)
+        };
+    }
+    const QByteArray payload = message.serialize(serializer);
+    return [payload, serializer] {
+        T result;
+        result.deserialize(serializer, payload);
+    };
+}
+
+std::function<void()> SerializationBenchmark::operation(const QString &message, int format, bool serialize)
+{
+    if (message == "ScalarMessage") {
+        return messageOperation<qt::ScalarMessage, QT_PROTOBUF_BENCHMARK_PB(ScalarMessage)>(m_scalar, format, serialize);
+    }
+    if (message == "PackedMessage") {
+        return messageOperation<qt::PackedMessage, QT_PROTOBUF_BENCHMARK_PB(PackedMessage)>(m_packed, format, serialize);
+    }
+    if (message == "StringMessage") {
+        return messageOperation<qt::StringMessage, QT_PROTOBUF_BENCHMARK_PB(StringMessage)>(m_string, format, serialize);
+    }
+    if (message == "NestedMessage") {
+        return messageOperation<qt::NestedMessage, QT_PROTOBUF_BENCHMARK_PB(NestedMessage)>(m_nested, format, serialize);
+    }
+    if (message == "MapMessage") {
+        return messageOperation<qt::MapMessage, QT_PROTOBUF_BENCHMARK_PB(MapMessage)>(m_map, format, serialize);
+    }
+    return messageOperation<qt::LargeRepeatedMessage, QT_PROTOBUF_BENCHMARK_PB(LargeRepeatedMessage)>(m_largeRepeated, format, serialize);
+}
+
+void SerializationBenchmark::serialize()
+{
+    QFETCH(QString, message);
+    QFETCH(int, format);
+    std::function<void()> serializeMessage = operation(message, format, true);
+    QBENCHMARK {
+        serializeMessage();
+    }
+}
+
+void SerializationBenchmark::deserialize()
+{
+    QFETCH(QString, message);
+    QFETCH(int, format);
+    std::function<void()> deserializeMessage = operation(message, format, false);
+    QBENCHMARK {
+        deserializeMessage();
+    }
+}
+
+void SerializationBenchmark::countAllocations(bool serialize)
+{
+#ifdef __GLIBC__
+    QFETCH(QString, message);
+    QFETCH(int, format);
+    std::function<void()> run = operation(message, format, serialize);
+    //Warm up run excludes lazy initialization of serializer internals
+    run();
+    allocationCount.store(0);
+    allocationCounting.store(true);
+    run();
+    allocationCounting.store(false);
+    QTest::setBenchmarkResult(allocationCount.load(), QTest::Events);
+#else
+    Q_UNUSED(serialize)
+    QSKIP("Allocations are counted with glibc only");
+#endif
+}
+
+void SerializationBenchmark::serializeAllocations()
+{
+    countAllocations(true);
+}
+
+void SerializationBenchmark::deserializeAllocations()
+{
+    countAllocations(false);
+}
+
+QTEST_GUILESS_MAIN(SerializationBenchmark)
+#include "serializationbenchmark.moc"
@@ -0,0 +1,6 @@
+# Copies files generated to SOURCE_DIR to DESTINATION_DIR, keeping relative paths.
+# Files with unchanged content are not touched, so sources that include them are not rebuilt.
+file(GLOB_RECURSE GENERATED_FILES RELATIVE "${SOURCE_DIR}" "${SOURCE_DIR}/*")
+foreach(GENERATED_FILE IN LISTS GENERATED_FILES)
+    configure_file("${SOURCE_DIR}/${GENERATED_FILE}" "${DESTINATION_DIR}/${GENERATED_FILE}" COPYONLY)
+endforeach()
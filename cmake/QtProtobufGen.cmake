@@ -5,9 +5,9 @@ function(qtprotobuf_link_target TARGET GENERATED_TARGET)
 endfunction()
 
 function(qtprotobuf_generate)
-    set(options MULTI QML COMMENTS FOLDER FIELDENUM)
-    set(oneValueArgs OUT_DIR TARGET GENERATED_TARGET EXTRA_NAMESPACE)
-    set(multiValueArgs GENERATED_HEADERS EXCLUDE_HEADERS PROTO_FILES PROTO_INCLUDES)
+    set(options MULTI QML COMMENTS FOLDER FIELDENUM DIRECT FINGERPRINT VALUE COROUTINES COMPACT UTF8 QHASH NATIVE_WELLKNOWN SCALAR_VIEWS PCH UNITY)
+    set(oneValueArgs OUT_DIR TARGET GENERATED_TARGET EXTRA_NAMESPACE UNITY_BATCH_SIZE)
+    set(multiValueArgs GENERATED_HEADERS EXCLUDE_HEADERS PROTO_FILES PROTO_INCLUDES INTERN_STRINGS)
     cmake_parse_arguments(qtprotobuf_generate "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN})
 
     if(DEFINED qtprotobuf_generate_GENERATED_TARGET)
@@ -56,6 +56,57 @@ function(qtprotobuf_generate)
         set(GENERATION_OPTIONS "${GENERATION_OPTIONS}:FIELDENUM")
     endif()
 
+    if(qtprotobuf_generate_DIRECT)
+        message(STATUS "Enabled DIRECT serializers generation for ${GENERATED_TARGET_NAME}")
+        set(GENERATION_OPTIONS "${GENERATION_OPTIONS}:DIRECT")
+    endif()
+
+    if(qtprotobuf_generate_FINGERPRINT)
+        message(STATUS "Enabled FINGERPRINT generation for ${GENERATED_TARGET_NAME}")
+        set(GENERATION_OPTIONS "${GENERATION_OPTIONS}:FINGERPRINT")
+    endif()
+
+    if(qtprotobuf_generate_VALUE)
+        message(STATUS "Enabled VALUE types generation for ${GENERATED_TARGET_NAME}")
+        set(GENERATION_OPTIONS "${GENERATION_OPTIONS}:VALUE")
+    endif()
+
+    if(qtprotobuf_generate_COROUTINES)
+        message(STATUS "Enabled COROUTINES generation for ${GENERATED_TARGET_NAME}")
+        set(GENERATION_OPTIONS "${GENERATION_OPTIONS}:COROUTINES")
+    endif()
+
+    if(qtprotobuf_generate_COMPACT)
+        message(STATUS "Enabled COMPACT messages generation for ${GENERATED_TARGET_NAME}")
+        set(GENERATION_OPTIONS "${GENERATION_OPTIONS}:COMPACT")
+    endif()
+
+    if(qtprotobuf_generate_UTF8)
+        message(STATUS "Enabled UTF8 strings generation for ${GENERATED_TARGET_NAME}")
+        set(GENERATION_OPTIONS "${GENERATION_OPTIONS}:UTF8")
+    endif()
+
+    if(qtprotobuf_generate_QHASH)
+        message(STATUS "Enabled QHash map fields generation for ${GENERATED_TARGET_NAME}")
+        set(GENERATION_OPTIONS "${GENERATION_OPTIONS}:QHASH")
+    endif()
+
+    if(qtprotobuf_generate_NATIVE_WELLKNOWN)
+        message(STATUS "Enabled native well-known types generation for ${GENERATED_TARGET_NAME}")
+        set(GENERATION_OPTIONS "${GENERATION_OPTIONS}:NATIVE_WELLKNOWN")
+    endif()
+
+    if(qtprotobuf_generate_SCALAR_VIEWS)
+        message(STATUS "Enabled views of repeated numeric fields generation for ${GENERATED_TARGET_NAME}")
+        set(GENERATION_OPTIONS "${GENERATION_OPTIONS}:SCALAR_VIEWS")
+    endif()
+
+    if(qtprotobuf_generate_INTERN_STRINGS)
+        message(STATUS "Enabled string interning of ${qtprotobuf_generate_INTERN_STRINGS} fields for ${GENERATED_TARGET_NAME}")
+        string(REPLACE ";" "," INTERN_STRINGS_FIELDS "${qtprotobuf_generate_INTERN_STRINGS}")
+        set(GENERATION_OPTIONS "${GENERATION_OPTIONS}:INTERN_STRINGS=${INTERN_STRINGS_FIELDS}")
+    endif()
+
     if(qtprotobuf_generate_EXTRA_NAMESPACE)
         set(GENERATION_OPTIONS
             "${GENERATION_OPTIONS}:EXTRA_NAMESPACE=\"${qtprotobuf_generate_EXTRA_NAMESPACE}\""
@@ -139,13 +190,25 @@ function(qtprotobuf_generate)
 
     qt5_wrap_cpp(MOC_SOURCES ${GENERATED_HEADERS_FULL})
 
+    get_target_property(COPY_IF_DIFFERENT_SCRIPT ${QT_PROTOBUF_NAMESPACE}::qtprotobufgen COPY_IF_DIFFERENT_SCRIPT)
+    if(NOT COPY_IF_DIFFERENT_SCRIPT)
+        message(FATAL_ERROR "Unable to locate QtProtobufCopyIfDifferent.cmake script")
+    endif()
+
+    # Code is generated to staging directory first and copied to OUT_DIR only if changed,
+    # so regeneration doesn't trigger rebuild of everything that includes generated headers
+    set(STAGING_DIR "${OUT_DIR}/.qtprotobufgen")
     add_custom_command(
             OUTPUT ${GENERATED_SOURCES_FULL} ${GENERATED_HEADERS_FULL}
+            COMMAND ${CMAKE_COMMAND} -E remove_directory ${STAGING_DIR}
+            COMMAND ${CMAKE_COMMAND} -E make_directory ${STAGING_DIR}
             COMMAND ${PROTOC_COMMAND}
                 --plugin=protoc-gen-qtprotobufgen=${QT_PROTOBUF_EXECUTABLE}
-                --qtprotobufgen_out=${OUT_DIR}
+                --qtprotobufgen_out=${STAGING_DIR}
                 ${PROTO_INCLUDES}
                 ${qtprotobuf_generate_PROTO_FILES}
+            COMMAND ${CMAKE_COMMAND} -DSOURCE_DIR=${STAGING_DIR} -DDESTINATION_DIR=${OUT_DIR}
+                -P ${COPY_IF_DIFFERENT_SCRIPT}
             WORKING_DIRECTORY ${OUT_DIR}
             DEPENDS ${qtprotobuf_generate_PROTO_FILES} ${QT_PROTOBUF_EXECUTABLE}
             COMMENT "Generating QtProtobuf ${GENERATED_TARGET_NAME} sources..."
@@ -158,6 +221,42 @@ function(qtprotobuf_generate)
 
     add_library(${GENERATED_TARGET_NAME} OBJECT ${GENERATED_SOURCES_FULL} ${MOC_SOURCES})
     add_dependencies(${GENERATED_TARGET_NAME} ${deps_target})
+
+    if((qtprotobuf_generate_PCH OR qtprotobuf_generate_UNITY) AND ${CMAKE_VERSION} VERSION_LESS "3.16.0")
+        message(WARNING "PCH and UNITY options require CMake 3.16 or higher, ignored for ${GENERATED_TARGET_NAME}")
+    else()
+        if(qtprotobuf_generate_PCH)
+            #Headers included by every generated file, parsing of them dominates compilation of generated code
+            message(STATUS "Enabled precompiled headers for ${GENERATED_TARGET_NAME}")
+            target_precompile_headers(${GENERATED_TARGET_NAME} PRIVATE
+                <QObject>
+                <QMetaType>
+                <QList>
+                <QVector>
+                <QSharedPointer>
+                <QProtobufObject>
+                <QProtobufLazyMessagePointer>
+                <QProtobufFieldPresence>
+                <memory>
+                <unordered_map>
+            )
+            if(qtprotobuf_generate_QML)
+                target_precompile_headers(${GENERATED_TARGET_NAME} PRIVATE
+                    <QtQml/QQmlListProperty>
+                    <QQmlListPropertyConstructor>
+                )
+            endif()
+        endif()
+
+        if(qtprotobuf_generate_UNITY)
+            message(STATUS "Enabled unity build for ${GENERATED_TARGET_NAME}")
+            set_target_properties(${GENERATED_TARGET_NAME} PROPERTIES UNITY_BUILD ON)
+            if(DEFINED qtprotobuf_generate_UNITY_BATCH_SIZE)
+                set_target_properties(${GENERATED_TARGET_NAME} PROPERTIES
+                    UNITY_BUILD_BATCH_SIZE ${qtprotobuf_generate_UNITY_BATCH_SIZE})
+            endif()
+        endif()
+    endif()
     if(qtprotobuf_generate_TARGET)
         set_property(TARGET ${qtprotobuf_generate_TARGET} APPEND PROPERTY PUBLIC_HEADER ${GENERATED_HEADERS_FULL})
     endif()
@@ -14,9 +14,9 @@ function(qtprotobuf_parse_arguments prefix option single multi)
 endfunction()
 
 function(qt_protobuf_internal_add_test)
-    set(options MULTI QML FIELDENUM)
+    set(options MULTI QML FIELDENUM DIRECT FINGERPRINT VALUE COROUTINES COMPACT UTF8 QHASH NATIVE_WELLKNOWN SCALAR_VIEWS)
     set(oneValueArgs QML_DIR TARGET EXTRA_NAMESPACE)
-    set(multiValueArgs SOURCES GENERATED_HEADERS EXCLUDE_HEADERS PROTO_FILES PROTO_INCLUDES)
+    set(multiValueArgs SOURCES GENERATED_HEADERS EXCLUDE_HEADERS PROTO_FILES PROTO_INCLUDES INTERN_STRINGS)
     cmake_parse_arguments(add_test_target "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN})
 
     ## test sources build
@@ -45,9 +45,39 @@ function(qt_protobuf_internal_add_test)
     if(add_test_target_FIELDENUM)
         set(EXTRA_OPTIONS ${EXTRA_OPTIONS} FIELDENUM)
     endif()
+    if(add_test_target_DIRECT)
+        set(EXTRA_OPTIONS ${EXTRA_OPTIONS} DIRECT)
+    endif()
+    if(add_test_target_FINGERPRINT)
+        set(EXTRA_OPTIONS ${EXTRA_OPTIONS} FINGERPRINT)
+    endif()
+    if(add_test_target_VALUE)
+        set(EXTRA_OPTIONS ${EXTRA_OPTIONS} VALUE)
+    endif()
+    if(add_test_target_COROUTINES)
+        set(EXTRA_OPTIONS ${EXTRA_OPTIONS} COROUTINES)
+    endif()
+    if(add_test_target_COMPACT)
+        set(EXTRA_OPTIONS ${EXTRA_OPTIONS} COMPACT)
+    endif()
+    if(add_test_target_UTF8)
+        set(EXTRA_OPTIONS ${EXTRA_OPTIONS} UTF8)
+    endif()
+    if(add_test_target_QHASH)
+        set(EXTRA_OPTIONS ${EXTRA_OPTIONS} QHASH)
+    endif()
+    if(add_test_target_NATIVE_WELLKNOWN)
+        set(EXTRA_OPTIONS ${EXTRA_OPTIONS} NATIVE_WELLKNOWN)
+    endif()
     if(add_test_target_EXTRA_NAMESPACE)
         set(EXTRA_OPTIONS ${EXTRA_OPTIONS} EXTRA_NAMESPACE ${add_test_target_EXTRA_NAMESPACE})
     endif()
+    if(add_test_target_SCALAR_VIEWS)
+        set(EXTRA_OPTIONS ${EXTRA_OPTIONS} SCALAR_VIEWS)
+    endif()
+    if(add_test_target_INTERN_STRINGS)
+        set(EXTRA_OPTIONS ${EXTRA_OPTIONS} INTERN_STRINGS ${add_test_target_INTERN_STRINGS})
+    endif()
 
     qtprotobuf_generate(TARGET ${add_test_target_TARGET}
         OUT_DIR ${GENERATED_SOURCES_DIR}
@@ -0,0 +1,147 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>, Viktor Kopp <vifactor@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "fuzzing.qpb.h"
+
+#include <qprotobufserializer.h>
+
+#include <sanitizer/allocator_interface.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace qtprotobufnamespace::fuzzing;
+
+namespace {
+//Allocations of deserialization are expected to be proportional to the input size
+const size_t MaxAllocationRatio = 16;
+const size_t MaxAllocationBase = 64 * 1024;
+const size_t MaxPeakUsageRatio = 1024;
+const size_t MaxPeakUsageBase = 1024 * 1024;
+
+enum ModeFlags {
+    FuzzMessageMode = 0x01,
+    LazyMessagesMode = 0x02,
+    PreserveUnknownFieldsMode = 0x04,
+    ZeroCopyBytesMode = 0x08,
+};
+
+std::atomic<bool> trackAllocations(false);
+size_t liveBytes = 0;
+size_t peakBytes = 0;
+size_t largestAllocation = 0;
+
+void mallocHook(const volatile void *, size_t size)
+{
+    if (!trackAllocations) {
+        return;
+    }
+    liveBytes += size;
+    peakBytes = std::max(peakBytes, liveBytes);
+    largestAllocation = std::max(largestAllocation, size);
+}
+
+void freeHook(const volatile void *ptr)
+{
+    if (!trackAllocations || ptr == nullptr) {
+        return;
+    }
+    //Memory allocated before tracking is started may be freed while it's in progress
+    const size_t size = __sanitizer_get_allocated_size(const_cast<const void *>(ptr));
+    liveBytes = size < liveBytes ? liveBytes - size : 0;
+}
+
+void checkAllocations(size_t inputSize)
+{
+    if (largestAllocation > MaxAllocationRatio * inputSize + MaxAllocationBase) {
+        fprintf(stderr, "Allocation of %zu bytes for %zu bytes of input\n", largestAllocation, inputSize);
+        abort();
+    }
+    if (peakBytes > MaxPeakUsageRatio * inputSize + MaxPeakUsageBase) {
+        fprintf(stderr, "Peak heap usage of %zu bytes for %zu bytes of input\n", peakBytes, inputSize);
+        abort();
+    }
+}
+
+template<typename T>
+void fuzzMessage(QProtobufSerializer *serializer, const QByteArray &data, bool checkRoundTrip)
+{
+    T message;
+    if (serializer->tryDeserialize(&message, data) != QtProtobuf::NoDeserializationError || !checkRoundTrip) {
+        return;
+    }
+
+    //Message that is deserialized successfully is always serialized to valid payload
+    const QByteArray serialized = message.serialize(serializer);
+    T copy;
+    if (serializer->tryDeserialize(&copy, serialized) != QtProtobuf::NoDeserializationError) {
+        fprintf(stderr, "Unable to deserialize serialized message\n");
+        abort();
+    }
+}
+}
+
+extern "C" int LLVMFuzzerInitialize(int *, char ***)
+{
+    QtProtobuf::qRegisterProtobufTypes();
+    __sanitizer_install_malloc_and_free_hooks(mallocHook, freeHook);
+    return 0;
+}
+
+//First byte of input selects message type and deserialization modes, the rest is payload
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *input, size_t size)
+{
+    if (size < 1) {
+        return 0;
+    }
+
+    static QProtobufSerializer serializer;
+    serializer.setMaxRecursionDepth(32);
+    serializer.setMaxElementCount(64 * 1024);
+
+    const uint8_t mode = input[0];
+    serializer.setLazyMessagesEnabled((mode & LazyMessagesMode) != 0);
+    serializer.setPreserveUnknownFieldsEnabled((mode & PreserveUnknownFieldsMode) != 0);
+    serializer.setZeroCopyBytesEnabled((mode & ZeroCopyBytesMode) != 0);
+    //Payload of lazy messages is stored as is and validated at first access only
+    const bool checkRoundTrip = (mode & LazyMessagesMode) == 0;
+    const QByteArray data = QByteArray::fromRawData(reinterpret_cast<const char *>(input + 1), static_cast<int>(size - 1));
+
+    liveBytes = 0;
+    peakBytes = 0;
+    largestAllocation = 0;
+    trackAllocations = true;
+    if (mode & FuzzMessageMode) {
+        fuzzMessage<FuzzMessage>(&serializer, data, checkRoundTrip);
+    } else {
+        fuzzMessage<FlatMessage>(&serializer, data, checkRoundTrip);
+    }
+    trackAllocations = false;
+    checkAllocations(size);
+    return 0;
+}
@@ -67,6 +67,14 @@ void ClientDeclarationPrinter::printClientIncludes()
     includeSet.insert("QAbstractGrpcClient");
     includeSet.insert("QGrpcAsyncReply");
     includeSet.insert("QGrpcStream");
+    includeSet.insert("QGrpcClientStream");
+    includeSet.insert("QAbstractGrpcService");
+    if (GeneratorOptions::instance().generateCoroutines()) {
+        includeSet.insert("QGrpcAwaitableReply");
+    }
+    if (GeneratorOptions::instance().hasQml()) {
+        includeSet.insert("QGrpcQmlReply");
+    }
     for (auto type : includeSet) {
         mPrinter->Print({{"include", type}}, Templates::ExternalIncludeTemplate);
     }
@@ -86,11 +94,20 @@ void ClientDeclarationPrinter::printClientMethodsDeclaration()
             mPrinter->Print(parameters, Templates::ClientMethodDeclarationSyncTemplate);
             mPrinter->Print(parameters, Templates::ClientMethodDeclarationAsyncTemplate);
             mPrinter->Print(parameters, Templates::ClientMethodDeclarationAsync2Template);
+            mPrinter->Print(parameters, Templates::ClientMethodDeclarationAsync3Template);
+            mPrinter->Print(parameters, Templates::ClientMethodDeclarationAsync4Template);
+            if (GeneratorOptions::instance().generateCoroutines()) {
+                mPrinter->Print(parameters, Templates::ClientMethodDeclarationAwaitableTemplate);
+            }
             if (GeneratorOptions::instance().hasQml()) {
                 mPrinter->Print(parameters, Templates::ClientMethodDeclarationQmlTemplate);
                 mPrinter->Print(parameters, Templates::ClientMethodDeclarationQml2Template);
+                mPrinter->Print(parameters, Templates::ClientMethodDeclarationQmlReplyTemplate);
             }
         }
+        if (method->client_streaming()) {
+            mPrinter->Print(parameters, Templates::ClientMethodClientStreamDeclarationTemplate);
+        }
         mPrinter->Print("\n");
     }
     Outdent();
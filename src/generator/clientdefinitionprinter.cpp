@@ -57,11 +57,20 @@ void ClientDefinitionPrinter::printMethods()
             mPrinter->Print(parameters, Templates::ClientMethodDefinitionSyncTemplate);
             mPrinter->Print(parameters, Templates::ClientMethodDefinitionAsyncTemplate);
             mPrinter->Print(parameters, Templates::ClientMethodDefinitionAsync2Template);
+            mPrinter->Print(parameters, Templates::ClientMethodDefinitionAsync3Template);
+            mPrinter->Print(parameters, Templates::ClientMethodDefinitionAsync4Template);
+            if (GeneratorOptions::instance().generateCoroutines()) {
+                mPrinter->Print(parameters, Templates::ClientMethodDefinitionAwaitableTemplate);
+            }
             if (GeneratorOptions::instance().hasQml()) {
                 mPrinter->Print(parameters, Templates::ClientMethodDefinitionQmlTemplate);
                 mPrinter->Print(parameters, Templates::ClientMethodDefinitionQml2Template);
+                mPrinter->Print(parameters, Templates::ClientMethodDefinitionQmlReplyTemplate);
             }
         }
+        if (method->client_streaming()) {
+            mPrinter->Print(parameters, Templates::ClientMethodClientStreamDefinitionTemplate);
+        }
     }
 }
 
@@ -59,4 +59,5 @@ void EnumDefinitionPrinter::printRegisterBody()
     mPrinter->Print(typeMap, Templates::RegisterEnumSerializersTemplate);
     Outdent();
     mPrinter->Print(Templates::SimpleBlockEnclosureTemplate);
+    mPrinter->Print(typeMap, Templates::LazyRegistrationGlobalEnumDefinition);
 }
@@ -30,6 +30,12 @@
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/io/printer.h>
 #include <google/protobuf/io/zero_copy_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/io/coded_stream.h>
+
+#include <atomic>
+#include <map>
+#include <thread>
 
 #include "utils.h"
 #include "templates.h"
@@ -40,6 +46,45 @@ using namespace ::QtProtobuf::generator;
 using namespace ::google::protobuf;
 using namespace ::google::protobuf::compiler;
 
+namespace {
+/*!
+ * \private
+ * \brief The BufferedGeneratorContext class keeps files generated for single .proto file in memory
+ *
+ * \details GeneratorContext of protoc may not be used by several threads, so files are generated to buffers
+ *          and passed to protoc by the thread that started generation.
+ */
+class BufferedGeneratorContext : public GeneratorContext
+{
+public:
+    BufferedGeneratorContext(GeneratorContext *target) : m_target(target) {}
+
+    io::ZeroCopyOutputStream *Open(const std::string &filename) override {
+        return new io::StringOutputStream(&m_files[filename]);
+    }
+
+    void ListParsedFiles(std::vector<const FileDescriptor *> *output) override {
+        m_target->ListParsedFiles(output);
+    }
+
+    void GetCompilerVersion(Version *version) const override {
+        m_target->GetCompilerVersion(version);
+    }
+
+    void commit() {
+        for (const auto &file : m_files) {
+            std::unique_ptr<io::ZeroCopyOutputStream> stream(m_target->Open(file.first));
+            io::CodedOutputStream output(stream.get());
+            output.WriteString(file.second);
+        }
+    }
+
+private:
+    GeneratorContext *m_target;
+    std::map<std::string, std::string> m_files;
+};
+}
+
 GeneratorBase::GeneratorBase(Mode mode) : m_mode(mode)
 {
 
@@ -47,7 +92,40 @@ GeneratorBase::GeneratorBase(Mode mode) : m_mode(mode)
 
 bool GeneratorBase::GenerateAll(const std::vector<const FileDescriptor *> &files, const string &parameter, GeneratorContext *generatorContext, string *error) const
 {
-    return CodeGenerator::GenerateAll(files, parameter, generatorContext, error);
+    //Each .proto file is generated by one of worker threads, files are taken in order
+    std::vector<std::unique_ptr<BufferedGeneratorContext>> contexts;
+    std::vector<std::string> errors(files.size());
+    std::vector<char> results(files.size(), false);
+    for (size_t i = 0; i < files.size(); ++i) {
+        contexts.emplace_back(new BufferedGeneratorContext(generatorContext));
+    }
+
+    std::atomic<size_t> nextFile(0);
+    auto worker = [&] {
+        for (size_t i = nextFile++; i < files.size(); i = nextFile++) {
+            results[i] = Generate(files[i], parameter, contexts[i].get(), &errors[i]);
+        }
+    };
+
+    const size_t threadCount = std::min<size_t>(files.size(), std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    //Files are passed to protoc in order, so output doesn't depend on threads scheduling
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (!results[i]) {
+            *error = files[i]->name() + ": " + errors[i];
+            return false;
+        }
+        contexts[i]->commit();
+    }
+    return true;
 }
 
 std::string GeneratorBase::generateBaseName(const ::google::protobuf::FileDescriptor *file, std::string name)
@@ -85,12 +163,15 @@ void GeneratorBase::printInclude(const std::shared_ptr<::google::protobuf::io::P
     switch (field->type()) {
     case FieldDescriptor::TYPE_MESSAGE:
         if (field->is_map()) {
-            newInclude = "QMap";
+            newInclude = GeneratorOptions::instance().generateHashMaps() ? "QHash" : "QMap";
             assert(field->message_type() != nullptr);
             assert(field->message_type()->field_count() == 2);
             printInclude(printer, message, field->message_type()->field(0), existingIncludes);
             printInclude(printer, message, field->message_type()->field(1), existingIncludes);
             includeTemplate = Templates::ExternalIncludeTemplate;
+        } else if (!common::nativeWellKnownType(field).empty()) {
+            newInclude = "QtProtobufWellKnownTypes";
+            includeTemplate = Templates::ExternalIncludeTemplate;
         } else if (common::isQtType(field)) {
             newInclude = field->message_type()->name();
             includeTemplate = Templates::ExternalIncludeTemplate;
@@ -57,7 +57,7 @@ namespace generator {
  * \section Manual usage
  *
  * \code
- * [QT_PROTOBUF_OPTIONS="[SINGLE|MULTI]:QML:COMMENTS:FOLDER"] protoc --plugin=protoc-gen-qtprotobuf=<path/to/bin/>qtprotobufgen --qtprotobuf_out=<output_dir> [-I/extra/proto/include/path] <protofile>.proto
+ * [QT_PROTOBUF_OPTIONS="[SINGLE|MULTI]:QML:COMMENTS:FOLDER:DIRECT"] protoc --plugin=protoc-gen-qtprotobuf=<path/to/bin/>qtprotobufgen --qtprotobuf_out=<output_dir> [-I/extra/proto/include/path] <protofile>.proto
  * \endcode
  *
  * Generator supports options that could be provided as environment variable to tune generation.
@@ -77,6 +77,9 @@ namespace generator {
  *
  * *FOLDER* - enables folder-based generation
  *
+ * *DIRECT* - enables generation of serializeTo() and parseFrom() methods for messages that contain basic type fields only.
+ *            QProtobufSerializer uses them instead of meta-object system based serialization
+ *
  * \section cmake CMake
  *
  * For CMake based project QtProtobuf has macroses those should be used to generate code and in link it to your project:
@@ -89,6 +92,9 @@ namespace generator {
  *
  * \brief qtprotobuf_generate is cmake helper function that automatically generates STATIC library target from your .proto files
  *
+ * \details .proto files are generated in parallel. Generated files which content is not changed are not rewritten, so
+ *          changes of .proto files trigger rebuild of affected sources only.
+ *
  * \param TARGET name of you target that generated code archive will be linked to
  * \param GENERATED_TARGET name that will be used for generated archive library target. It's usefull when you supposed to have multiple generated targets to be linked to single one.
  * \param OUT_DIR output directory that will contain generated artifacts. Usually subfolder in build directory should be used
@@ -101,6 +107,7 @@ namespace generator {
  * \param COMMENTS Enables comments copying from .proto files. If provided in parameter list message and field related comments will be copied to generated header files.
  * \param FOLDER Enables folder based generation. If provided in parameter list generator will place generated artifacts to folder structure according to package of corresponding .proto file
  * \param FIELDENUM Enables generation of field numbers as an enum within the message class.
+ * \param DIRECT Enables generation of serializeTo() and parseFrom() methods for messages that contain basic type fields only. QProtobufSerializer uses them instead of meta-object system based serialization.
  * \param EXTRA_NAMESPACE <namespace> Wraps the generated code with the specified namespace(EXPERIMENTAL).
  *
  * \subsection cmake_qtprotobuf_link_target qtprotobuf_link_target
@@ -141,6 +148,9 @@ public:
                              ::google::protobuf::compiler::GeneratorContext *generatorContext,
                              std::string *error) const override;
     bool HasGenerateAll() const override { return true; }
+#if GOOGLE_PROTOBUF_VERSION >= 3012000
+    uint64_t GetSupportedFeatures() const override { return FEATURE_PROTO3_OPTIONAL; }
+#endif
 
     static void printDisclaimer(const std::shared_ptr<::google::protobuf::io::Printer> printer);
     static void printPreamble(const std::shared_ptr<::google::protobuf::io::Printer> printer);
@@ -26,7 +26,12 @@
 #include "generatorcommon.h"
 #include "generatoroptions.h"
 
+#include <google/protobuf/descriptor.pb.h>
+
 #include <assert.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 
 using namespace ::QtProtobuf::generator;
 using namespace ::google::protobuf;
@@ -92,6 +97,27 @@ TypeMap common::produceQtTypeMap(const ::Descriptor *type, const Descriptor *sco
     };
 }
 
+TypeMap common::produceNativeTypeMap(const std::string &name)
+{
+    std::string listName = std::string("QList<") + name + ">";
+
+    return {
+        {"type", name},
+        {"full_type", name},
+        {"scope_type", name},
+        {"list_type", listName},
+        {"full_list_type", listName},
+        {"scope_list_type", listName},
+        {"namespaces", ""},
+        {"scope_namespaces", ""},
+        {"qml_package", ""},
+        {"property_type", name},
+        {"property_list_type", listName},
+        {"getter_type", name},
+        {"setter_type", name}
+    };
+}
+
 TypeMap common::produceMessageTypeMap(const ::Descriptor *type, const Descriptor *scope)
 {
     std::vector<std::string> namespaceList = getNamespaces(type);
@@ -267,16 +293,390 @@ TypeMap common::produceSimpleTypeMap(FieldDescriptor::Type type)
 
 bool common::isQtType(const FieldDescriptor *field)
 {
+    if (!nativeWellKnownType(field).empty()) {
+        return true;
+    }
     auto namespaces = getNamespaces(field->message_type());
     return namespaces.size() == 1 && namespaces[0] == "QtProtobuf"
             && field->file()->package() != "QtProtobuf"; //Used for qttypes library to avoid types conversion inside library
 }
 
+std::string common::nativeWellKnownType(const FieldDescriptor *field)
+{
+    //Repeated fields and maps keep generated messages, library registers serializers for singular values only
+    if (!GeneratorOptions::instance().generateNativeWellKnownTypes() || field->type() != FieldDescriptor::TYPE_MESSAGE
+            || field->is_repeated() || field->message_type()->file()->package() != "google.protobuf"
+            || field->file()->package() == "google.protobuf"
+            || (field->containing_type() != nullptr && field->containing_type()->options().map_entry())) {
+        return "";
+    }
+
+    static const std::map<std::string, std::string> nativeTypes = {
+        {"Timestamp", "QDateTime"},
+        {"Duration", "std::chrono::nanoseconds"},
+        {"DoubleValue", "QtProtobuf::DoubleOptional"},
+        {"FloatValue", "QtProtobuf::FloatOptional"},
+        {"Int64Value", "QtProtobuf::Int64Optional"},
+        {"UInt64Value", "QtProtobuf::UInt64Optional"},
+        {"Int32Value", "QtProtobuf::Int32Optional"},
+        {"UInt32Value", "QtProtobuf::UInt32Optional"},
+        {"BoolValue", "QtProtobuf::BoolOptional"},
+        {"StringValue", "QtProtobuf::StringOptional"},
+        {"BytesValue", "QtProtobuf::BytesOptional"}
+    };
+    auto it = nativeTypes.find(field->message_type()->name());
+    return it != nativeTypes.end() ? it->second : "";
+}
+
 bool common::isPureMessage(const ::google::protobuf::FieldDescriptor *field)
 {
     return field->type() == FieldDescriptor::TYPE_MESSAGE && !field->is_map() && !field->is_repeated() && !common::isQtType(field);
 }
 
+bool common::isOneofMember(const FieldDescriptor *field)
+{
+#if GOOGLE_PROTOBUF_VERSION >= 3012000
+    //proto3 optional fields are members of synthetic oneofs
+    return field->real_containing_oneof() != nullptr;
+#else
+    return field->containing_oneof() != nullptr;
+#endif
+}
+
+int common::realOneofCount(const Descriptor *message)
+{
+#if GOOGLE_PROTOBUF_VERSION >= 3012000
+    //Synthetic oneofs follow real ones
+    return message->real_oneof_decl_count();
+#else
+    return message->oneof_decl_count();
+#endif
+}
+
+bool common::hasExplicitPresence(const FieldDescriptor *field)
+{
+    //Message fields keep their presence semantics regardless of optional keyword
+#if GOOGLE_PROTOBUF_VERSION >= 3012000
+    return field->has_optional_keyword() && !isPureMessage(field);
+#else
+    (void)field;
+    return false;
+#endif
+}
+
+bool common::hasPresenceUpdate(const FieldDescriptor *field)
+{
+    return isOneofMember(field) || hasExplicitPresence(field);
+}
+
+bool common::isUtf8String(const FieldDescriptor *field)
+{
+    //Keys and values of maps keep QString, map types are registered by library for basic types only
+    return GeneratorOptions::instance().generateUtf8Strings()
+            && field->type() == FieldDescriptor::TYPE_STRING && !field->is_repeated()
+            && (field->containing_type() == nullptr || !field->containing_type()->options().map_entry());
+}
+
+bool common::isInternedString(const FieldDescriptor *field)
+{
+    if (!GeneratorOptions::instance().isInternedStringField(field->full_name())) {
+        return false;
+    }
+    //Both keys and values of map fields are interned
+    if (field->is_map()) {
+        const Descriptor *entry = field->message_type();
+        return entry->field(0)->type() == FieldDescriptor::TYPE_STRING
+                || entry->field(1)->type() == FieldDescriptor::TYPE_STRING;
+    }
+    return field->type() == FieldDescriptor::TYPE_STRING && !isUtf8String(field);
+}
+
+bool common::hasScalarView(const FieldDescriptor *field)
+{
+    if (!GeneratorOptions::instance().generateScalarViews() || !field->is_repeated() || field->is_map()) {
+        return false;
+    }
+    switch (field->type()) {
+    case FieldDescriptor::TYPE_DOUBLE:
+    case FieldDescriptor::TYPE_FLOAT:
+    case FieldDescriptor::TYPE_INT32:
+    case FieldDescriptor::TYPE_INT64:
+    case FieldDescriptor::TYPE_UINT32:
+    case FieldDescriptor::TYPE_UINT64:
+    case FieldDescriptor::TYPE_SINT32:
+    case FieldDescriptor::TYPE_SINT64:
+    case FieldDescriptor::TYPE_FIXED32:
+    case FieldDescriptor::TYPE_FIXED64:
+    case FieldDescriptor::TYPE_SFIXED32:
+    case FieldDescriptor::TYPE_SFIXED64:
+        return true;
+    default:
+        break;
+    }
+    return false;
+}
+
+std::string common::wireType(const ::google::protobuf::FieldDescriptor *field)
+{
+    //Repeated fields are either packed or serialized as sequence of length delimited values
+    if (field->is_repeated() || field->is_map()) {
+        return "LengthDelimited";
+    }
+
+    switch (field->type()) {
+    case FieldDescriptor::TYPE_DOUBLE:
+    case FieldDescriptor::TYPE_FIXED64:
+    case FieldDescriptor::TYPE_SFIXED64:
+        return "Fixed64";
+    case FieldDescriptor::TYPE_FLOAT:
+    case FieldDescriptor::TYPE_FIXED32:
+    case FieldDescriptor::TYPE_SFIXED32:
+        return "Fixed32";
+    case FieldDescriptor::TYPE_STRING:
+    case FieldDescriptor::TYPE_BYTES:
+    case FieldDescriptor::TYPE_MESSAGE:
+    case FieldDescriptor::TYPE_GROUP:
+        return "LengthDelimited";
+    default:
+        break;
+    }
+    return "Varint";
+}
+
+std::string common::fieldKind(const ::google::protobuf::FieldDescriptor *field)
+{
+    if (field->is_map()) {
+        return "Map";
+    }
+
+    switch (field->type()) {
+    case FieldDescriptor::TYPE_INT32:
+        return "Int32";
+    case FieldDescriptor::TYPE_INT64:
+        return "Int64";
+    case FieldDescriptor::TYPE_UINT32:
+        return "UInt32";
+    case FieldDescriptor::TYPE_UINT64:
+        return "UInt64";
+    case FieldDescriptor::TYPE_SINT32:
+        return "SInt32";
+    case FieldDescriptor::TYPE_SINT64:
+        return "SInt64";
+    case FieldDescriptor::TYPE_FIXED32:
+        return "Fixed32";
+    case FieldDescriptor::TYPE_FIXED64:
+        return "Fixed64";
+    case FieldDescriptor::TYPE_SFIXED32:
+        return "SFixed32";
+    case FieldDescriptor::TYPE_SFIXED64:
+        return "SFixed64";
+    case FieldDescriptor::TYPE_FLOAT:
+        return "Float";
+    case FieldDescriptor::TYPE_DOUBLE:
+        return "Double";
+    case FieldDescriptor::TYPE_BOOL:
+        return "Bool";
+    case FieldDescriptor::TYPE_STRING:
+        return "String";
+    case FieldDescriptor::TYPE_BYTES:
+        return "Bytes";
+    case FieldDescriptor::TYPE_ENUM:
+        return "Enum";
+    default:
+        break;
+    }
+    return "Message";
+}
+
+bool common::isDirectSerializable(const ::google::protobuf::FieldDescriptor *field)
+{
+    if (field->is_map()) {
+        return false;
+    }
+
+    switch (field->type()) {
+    case FieldDescriptor::TYPE_MESSAGE:
+    case FieldDescriptor::TYPE_GROUP:
+        return false;
+    case FieldDescriptor::TYPE_ENUM:
+    case FieldDescriptor::TYPE_BOOL:
+        //Repeated enums and bools are serialized using meta-object system only
+        return !field->is_repeated();
+    default:
+        break;
+    }
+    return true;
+}
+
+bool common::hasDirectSerializers(const ::google::protobuf::Descriptor *message)
+{
+    if (!GeneratorOptions::instance().generateDirectSerializers()) {
+        return false;
+    }
+
+    //Generated parsers write members directly, without activation of oneof members,
+    //and skip default values regardless of explicit presence
+    if (realOneofCount(message) > 0) {
+        return false;
+    }
+
+    for (int i = 0; i < message->field_count(); i++) {
+        if (!isDirectSerializable(message->field(i)) || hasExplicitPresence(message->field(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool common::hasSchemaFingerprint(const ::google::protobuf::Descriptor *message)
+{
+    return GeneratorOptions::instance().generateSchemaFingerprints() && hasDirectSerializers(message);
+}
+
+std::string common::schemaFingerprint(const ::google::protobuf::Descriptor *message)
+{
+    //64-bit FNV-1a over everything that affects the wire layout of the message
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto append = [&hash](const std::string &data) {
+        for (unsigned char c : data) {
+            hash ^= c;
+            hash *= 0x100000001b3ULL;
+        }
+        hash ^= 0xff;
+        hash *= 0x100000001b3ULL;
+    };
+
+    append(message->full_name());
+    iterateMessageFieldsInNumberOrder(message, [&append](const ::google::protobuf::FieldDescriptor *field, PropertyMap &) {
+        append(std::to_string(field->number()));
+        append(std::to_string(field->type()));
+        append(std::to_string(field->label()));
+        append(field->is_packed() ? "packed" : "unpacked");
+    });
+
+    char buffer[19];
+    snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+    return std::string("Q_UINT64_C(0x") + buffer + ")";
+}
+
+void common::iterateMessageFieldsInNumberOrder(const ::google::protobuf::Descriptor *message, InterateMessageLogic callback)
+{
+    std::vector<const ::google::protobuf::FieldDescriptor *> fields;
+    for (int i = 0; i < message->field_count(); i++) {
+        fields.push_back(message->field(i));
+    }
+    std::stable_sort(fields.begin(), fields.end(), [](const ::google::protobuf::FieldDescriptor *a,
+                                                      const ::google::protobuf::FieldDescriptor *b) {
+        return a->number() < b->number();
+    });
+
+    for (const ::google::protobuf::FieldDescriptor *field : fields) {
+        auto propertyMap = common::producePropertyMap(field, message);
+        callback(field, propertyMap);
+    }
+}
+
+bool common::isCompact(const ::google::protobuf::Descriptor *message)
+{
+    if (!GeneratorOptions::instance().generateCompact()) {
+        return false;
+    }
+
+    //Shared functions write fields through properties, that don't switch oneof cases
+    //and can't reset presence of optional fields
+    if (realOneofCount(message) > 0) {
+        return false;
+    }
+
+    for (int i = 0; i < message->field_count(); i++) {
+        if (hasExplicitPresence(message->field(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool common::isValueType(const ::google::protobuf::Descriptor *message)
+{
+    //Well-known types are generated separately, without value types
+    if (!GeneratorOptions::instance().generateValueTypes() || message->field_count() <= 0
+            || realOneofCount(message) > 0 || message->file()->package() == "google.protobuf") {
+        return false;
+    }
+
+    //Only messages that consist of singular scalar fields are stored inline
+    for (int i = 0; i < message->field_count(); i++) {
+        const FieldDescriptor *field = message->field(i);
+        switch (field->type()) {
+        case FieldDescriptor::TYPE_MESSAGE:
+        case FieldDescriptor::TYPE_GROUP:
+        case FieldDescriptor::TYPE_ENUM:
+            return false;
+        default:
+            break;
+        }
+        if (field->is_repeated() || hasExplicitPresence(field)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool common::isValueList(const ::google::protobuf::FieldDescriptor *field)
+{
+    return field->type() == FieldDescriptor::TYPE_MESSAGE && field->is_repeated() && !field->is_map()
+            && !isQtType(field) && isValueType(field->message_type());
+}
+
+bool common::hasTrackedPresence(const ::google::protobuf::FieldDescriptor *field)
+{
+    //Repeated and message fields are modified by reference, setters are not called for them.
+    //Oneof members are activated by setters only, inactive members are not serialized
+    return !field->is_repeated() && (!isPureMessage(field) || isOneofMember(field));
+}
+
+int common::presenceIndex(const ::google::protobuf::FieldDescriptor *field)
+{
+    //Presence bits follow field number order, same as QProtobufPropertyOrdering
+    const Descriptor *message = field->containing_type();
+    int index = 0;
+    for (int i = 0; i < message->field_count(); i++) {
+        if (message->field(i)->number() < field->number()) {
+            ++index;
+        }
+    }
+    return index;
+}
+
+int common::presenceWordCount(const ::google::protobuf::Descriptor *message)
+{
+    return std::max(1, (message->field_count() + 31) / 32);
+}
+
+std::string common::presenceMask(const ::google::protobuf::Descriptor *message, int initializedFieldCount)
+{
+    std::vector<uint32_t> words(static_cast<size_t>(presenceWordCount(message)), 0);
+    for (int i = 0; i < message->field_count(); i++) {
+        const FieldDescriptor *field = message->field(i);
+        //Oneof members passed to constructor are activated in constructor body
+        if ((i < initializedFieldCount && !isOneofMember(field)) || !hasTrackedPresence(field)) {
+            const int index = presenceIndex(field);
+            words[static_cast<size_t>(index / 32)] |= uint32_t(1) << (index % 32);
+        }
+    }
+
+    std::string mask;
+    for (uint32_t word : words) {
+        char wordString[16];
+        snprintf(wordString, sizeof(wordString), "0x%08xu", word);
+        if (!mask.empty()) {
+            mask += ", ";
+        }
+        mask += wordString;
+    }
+    return mask;
+}
+
 TypeMap common::produceTypeMap(const FieldDescriptor *field, const Descriptor *scope)
 {
     TypeMap typeMap;
@@ -287,10 +687,20 @@ TypeMap common::produceTypeMap(const FieldDescriptor *field, const Descriptor *s
 
     switch (field->type()) {
     case FieldDescriptor::TYPE_MESSAGE: {
-        if (isQtType(field)) {
+        std::string nativeType = nativeWellKnownType(field);
+        if (!nativeType.empty()) {
+            typeMap = produceNativeTypeMap(nativeType);
+        } else if (isQtType(field)) {
             typeMap = produceQtTypeMap(field->message_type(), nullptr);
         } else {
             typeMap = produceMessageTypeMap(field->message_type(), scope);
+            if (isValueList(field)) {
+                //Repeated fields store value type elements inline
+                for (auto key : {"list_type", "full_list_type", "scope_list_type", "property_list_type"}) {
+                    std::string &listType = typeMap[key];
+                    listType.insert(listType.size() - strlen(Templates::ListSuffix), Templates::ValueTypeSuffix);
+                }
+            }
         }
     }
         break;
@@ -331,6 +741,28 @@ PropertyMap common::producePropertyMap(const FieldDescriptor *field, const Descr
     propertyMap["value_type"] = "";
     propertyMap["classname"] = scope != nullptr ? scopeTypeMap["classname"] : "";
     propertyMap["number"] = std::to_string(field->number());
+    propertyMap["presence_index"] = field->containing_type() != nullptr ? std::to_string(presenceIndex(field)) : "0";
+
+    propertyMap["oneof_name"] = "";
+    propertyMap["oneof_name_cap"] = "";
+    propertyMap["presence_update"] = "";
+    if (isOneofMember(field)) {
+        auto oneofMap = produceOneofMap(field->containing_oneof());
+        propertyMap["oneof_name"] = oneofMap["oneof_name"];
+        propertyMap["oneof_name_cap"] = oneofMap["oneof_name_cap"];
+        //Setting of oneof member, even to default value, makes it active
+        propertyMap["presence_update"] = "    set" + oneofMap["oneof_name_cap"] + "Case(" + oneofMap["oneof_name_cap"]
+                + "Case::" + propertyNameCap + ");\n";
+    } else if (hasExplicitPresence(field)) {
+        //Setting of optional field, even to default value, makes it present
+        propertyMap["presence_update"] = "    m_protobufPresence.set(" + propertyMap["presence_index"] + ");\n";
+    }
+
+    if (isUtf8String(field)) {
+        for (const char *key : {"full_type", "scope_type", "property_type", "qml_alias_type", "getter_type", "setter_type"}) {
+            propertyMap[key] = Templates::Utf8StringType;
+        }
+    }
 
     if (field->is_map()) {
         const Descriptor *type = field->message_type();
@@ -347,6 +779,22 @@ PropertyMap common::producePropertyMap(const FieldDescriptor *field, const Descr
     return propertyMap;
 }
 
+PropertyMap common::produceOneofMap(const OneofDescriptor *oneof)
+{
+    assert(oneof != nullptr);
+
+    std::string oneofName;
+    for (const auto &part : utils::split(oneof->name(), '_')) {
+        if (!part.empty()) {
+            oneofName += oneofName.empty() ? part : utils::upperCaseName(part);
+        }
+    }
+    oneofName = utils::lowerCaseName(oneofName);
+
+    return {{"oneof_name", oneofName},
+            {"oneof_name_cap", utils::upperCaseName(oneofName)}};
+}
+
 std::string common::qualifiedName(const std::string &name)
 {
     std::string fieldName(name);
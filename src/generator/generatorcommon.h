@@ -75,17 +75,40 @@ struct common {
     static std::string getNamespacesString(const std::vector<std::string> &namespacesList, const std::string &separator);
     static std::string getScopeNamespacesString(std::string original, const std::string &scope);
     static TypeMap produceQtTypeMap(const ::google::protobuf::Descriptor *type, const ::google::protobuf::Descriptor *scope);
+    static TypeMap produceNativeTypeMap(const std::string &name);
     static TypeMap produceMessageTypeMap(const ::google::protobuf::Descriptor *type, const ::google::protobuf::Descriptor *scope);
     static TypeMap produceEnumTypeMap(const ::google::protobuf::EnumDescriptor *type, const ::google::protobuf::Descriptor *scope);
     static TypeMap produceSimpleTypeMap(::google::protobuf::FieldDescriptor::Type type);
     static TypeMap produceTypeMap(const ::google::protobuf::FieldDescriptor *field, const ::google::protobuf::Descriptor *scope);
     static PropertyMap producePropertyMap(const ::google::protobuf::FieldDescriptor *field, const ::google::protobuf::Descriptor *scope);
+    static PropertyMap produceOneofMap(const ::google::protobuf::OneofDescriptor *oneof);
     static std::string qualifiedName(const std::string &name);
     static bool isLocalEnum(const ::google::protobuf::EnumDescriptor *type, const google::protobuf::Descriptor *scope);
     static EnumVisibility enumVisibility(const ::google::protobuf::EnumDescriptor *type, const ::google::protobuf::Descriptor *scope);
     static bool hasQmlAlias(const ::google::protobuf::FieldDescriptor *field);
     static bool isQtType(const ::google::protobuf::FieldDescriptor *field);
+    static std::string nativeWellKnownType(const ::google::protobuf::FieldDescriptor *field);
     static bool isPureMessage(const ::google::protobuf::FieldDescriptor *field);
+    static bool isOneofMember(const ::google::protobuf::FieldDescriptor *field);
+    static int realOneofCount(const ::google::protobuf::Descriptor *message);
+    static bool hasExplicitPresence(const ::google::protobuf::FieldDescriptor *field);
+    static bool hasPresenceUpdate(const ::google::protobuf::FieldDescriptor *field);
+    static bool isUtf8String(const ::google::protobuf::FieldDescriptor *field);
+    static bool isInternedString(const ::google::protobuf::FieldDescriptor *field);
+    static bool hasScalarView(const ::google::protobuf::FieldDescriptor *field);
+    static std::string wireType(const ::google::protobuf::FieldDescriptor *field);
+    static std::string fieldKind(const ::google::protobuf::FieldDescriptor *field);
+    static bool isDirectSerializable(const ::google::protobuf::FieldDescriptor *field);
+    static bool hasDirectSerializers(const ::google::protobuf::Descriptor *message);
+    static bool hasSchemaFingerprint(const ::google::protobuf::Descriptor *message);
+    static std::string schemaFingerprint(const ::google::protobuf::Descriptor *message);
+    static bool isValueType(const ::google::protobuf::Descriptor *message);
+    static bool isCompact(const ::google::protobuf::Descriptor *message);
+    static bool isValueList(const ::google::protobuf::FieldDescriptor *field);
+    static bool hasTrackedPresence(const ::google::protobuf::FieldDescriptor *field);
+    static int presenceIndex(const ::google::protobuf::FieldDescriptor *field);
+    static int presenceWordCount(const ::google::protobuf::Descriptor *message);
+    static std::string presenceMask(const ::google::protobuf::Descriptor *message, int initializedFieldCount);
 
     using InterateMessageLogic = std::function<void(const ::google::protobuf::FieldDescriptor *, PropertyMap &)>;
     static void iterateMessageFields(const ::google::protobuf::Descriptor *message, InterateMessageLogic callback) {
@@ -96,6 +119,19 @@ struct common {
         }
     }
 
+    //Iterates fields in field number order, that is the order fields are serialized in
+    static void iterateMessageFieldsInNumberOrder(const ::google::protobuf::Descriptor *message, InterateMessageLogic callback);
+
+    using IterateOneofLogic = std::function<void(const ::google::protobuf::OneofDescriptor *, PropertyMap &)>;
+    static void iterateOneofs(const ::google::protobuf::Descriptor *message, IterateOneofLogic callback) {
+        for (int i = 0; i < realOneofCount(message); i++) {
+            const ::google::protobuf::OneofDescriptor *oneof = message->oneof_decl(i);
+            auto oneofMap = common::produceOneofMap(oneof);
+            oneofMap["classname"] = common::produceMessageTypeMap(message, nullptr)["classname"];
+            callback(oneof, oneofMap);
+        }
+    }
+
     static MethodMap produceMethodMap(const ::google::protobuf::MethodDescriptor *method, const std::string &scope); //TODO: scope should be ServiceDescriptor
 
     static void iterateMessages(const ::google::protobuf::FileDescriptor *file, std::function<void(const ::google::protobuf::Descriptor *)> callback);
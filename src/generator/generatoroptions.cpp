@@ -35,6 +35,16 @@ static const std::string CommentsGenerationOption("COMMENTS");
 static const std::string FolderGenerationOption("FOLDER");
 static const std::string FieldEnumGenerationOption("FIELDENUM");
 static const std::string ExtraNamespaceGenerationOption("EXTRA_NAMESPACE");
+static const std::string DirectSerializersGenerationOption("DIRECT");
+static const std::string SchemaFingerprintGenerationOption("FINGERPRINT");
+static const std::string ValueTypesGenerationOption("VALUE");
+static const std::string CoroutinesGenerationOption("COROUTINES");
+static const std::string CompactGenerationOption("COMPACT");
+static const std::string Utf8StringsGenerationOption("UTF8");
+static const std::string HashMapsGenerationOption("QHASH");
+static const std::string NativeWellKnownTypesGenerationOption("NATIVE_WELLKNOWN");
+static const std::string InternStringsGenerationOption("INTERN_STRINGS");
+static const std::string ScalarViewsGenerationOption("SCALAR_VIEWS");
 
 using namespace ::QtProtobuf::generator;
 
@@ -43,6 +53,15 @@ GeneratorOptions::GeneratorOptions() : mIsMulti(false)
   , mGenerateComments(false)
   , mIsFolder(false)
   , mGenerateFieldEnum(false)
+  , mGenerateDirectSerializers(false)
+  , mGenerateSchemaFingerprints(false)
+  , mGenerateValueTypes(false)
+  , mGenerateCoroutines(false)
+  , mGenerateCompact(false)
+  , mGenerateUtf8Strings(false)
+  , mGenerateHashMaps(false)
+  , mGenerateNativeWellKnownTypes(false)
+  , mGenerateScalarViews(false)
 {
 }
 
@@ -66,6 +85,39 @@ void GeneratorOptions::parseFromEnv(const std::string &options)
         } else if (option.compare(FieldEnumGenerationOption) == 0) {
             QT_PROTOBUF_DEBUG("set mGenerateFieldEnum: true");
             mGenerateFieldEnum = true;
+        } else if (option.compare(DirectSerializersGenerationOption) == 0) {
+            QT_PROTOBUF_DEBUG("set mGenerateDirectSerializers: true");
+            mGenerateDirectSerializers = true;
+        } else if (option.compare(SchemaFingerprintGenerationOption) == 0) {
+            QT_PROTOBUF_DEBUG("set mGenerateSchemaFingerprints: true");
+            mGenerateSchemaFingerprints = true;
+        } else if (option.compare(ValueTypesGenerationOption) == 0) {
+            QT_PROTOBUF_DEBUG("set mGenerateValueTypes: true");
+            mGenerateValueTypes = true;
+        } else if (option.compare(CoroutinesGenerationOption) == 0) {
+            QT_PROTOBUF_DEBUG("set mGenerateCoroutines: true");
+            mGenerateCoroutines = true;
+        } else if (option.compare(CompactGenerationOption) == 0) {
+            QT_PROTOBUF_DEBUG("set mGenerateCompact: true");
+            mGenerateCompact = true;
+        } else if (option.compare(Utf8StringsGenerationOption) == 0) {
+            QT_PROTOBUF_DEBUG("set mGenerateUtf8Strings: true");
+            mGenerateUtf8Strings = true;
+        } else if (option.compare(HashMapsGenerationOption) == 0) {
+            QT_PROTOBUF_DEBUG("set mGenerateHashMaps: true");
+            mGenerateHashMaps = true;
+        } else if (option.compare(NativeWellKnownTypesGenerationOption) == 0) {
+            QT_PROTOBUF_DEBUG("set mGenerateNativeWellKnownTypes: true");
+            mGenerateNativeWellKnownTypes = true;
+        } else if (option.compare(ScalarViewsGenerationOption) == 0) {
+            QT_PROTOBUF_DEBUG("set mGenerateScalarViews: true");
+            mGenerateScalarViews = true;
+        } else if (option.find(InternStringsGenerationOption + "=") == 0) {
+            //Fields are listed by full names, e.g. package.Message.field, separated by commas
+            for (const auto &field : utils::split(option.substr(InternStringsGenerationOption.size() + 1), ',')) {
+                QT_PROTOBUF_DEBUG("add interned string field: " << field);
+                mInternedStringFields.insert(field);
+            }
         } else if (option.find(ExtraNamespaceGenerationOption) == 0) {
             QT_PROTOBUF_DEBUG("set mGenerateFieldEnum: true");
             std::vector<std::string> compositeOption = utils::split(options, '=');
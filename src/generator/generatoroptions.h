@@ -26,6 +26,7 @@
 #pragma once
 
 #include <string>
+#include <set>
 
 namespace QtProtobuf {
 namespace generator {
@@ -51,7 +52,17 @@ public:
     bool generateComments() const { return mGenerateComments; }
     bool isFolder() const { return mIsFolder; }
     bool generateFieldEnum() const { return mGenerateFieldEnum; }
+    bool generateDirectSerializers() const { return mGenerateDirectSerializers; }
+    bool generateSchemaFingerprints() const { return mGenerateSchemaFingerprints; }
+    bool generateValueTypes() const { return mGenerateValueTypes; }
+    bool generateCoroutines() const { return mGenerateCoroutines; }
+    bool generateCompact() const { return mGenerateCompact; }
+    bool generateUtf8Strings() const { return mGenerateUtf8Strings; }
+    bool generateHashMaps() const { return mGenerateHashMaps; }
+    bool generateNativeWellKnownTypes() const { return mGenerateNativeWellKnownTypes; }
+    bool generateScalarViews() const { return mGenerateScalarViews; }
     const std::string &extraNamespace() const { return mExtraNamespace; }
+    bool isInternedStringField(const std::string &fullName) const { return mInternedStringFields.count(fullName) > 0; }
 
 private:
     bool mIsMulti;
@@ -59,7 +70,17 @@ private:
     bool mGenerateComments;
     bool mIsFolder;
     bool mGenerateFieldEnum;
+    bool mGenerateDirectSerializers;
+    bool mGenerateSchemaFingerprints;
+    bool mGenerateValueTypes;
+    bool mGenerateCoroutines;
+    bool mGenerateCompact;
+    bool mGenerateUtf8Strings;
+    bool mGenerateHashMaps;
+    bool mGenerateNativeWellKnownTypes;
+    bool mGenerateScalarViews;
     std::string mExtraNamespace;
+    std::set<std::string> mInternedStringFields;
 };
 
 }}
@@ -56,6 +56,9 @@ void MessageDeclarationPrinter::printClassForwardDeclarationPrivate()
 
     mPrinter->Print(mTypeMap, Templates::ProtoClassForwardDeclarationTemplate);
     mPrinter->Print(mTypeMap, Templates::ComplexListTypeUsingTemplate);
+    if (common::isValueType(mDescriptor)) {
+        mPrinter->Print(mTypeMap, Templates::ValueTypeForwardDeclarationTemplate);
+    }
 }
 
 void MessageDeclarationPrinter::printClassForwardDeclaration()
@@ -87,6 +90,7 @@ void MessageDeclarationPrinter::printClassDeclarationPrivate()
     printClassBody();
     encloseClass();
     printListType();
+    printValueType();
 }
 
 void MessageDeclarationPrinter::printCopyFunctionality()
@@ -158,7 +162,11 @@ void MessageDeclarationPrinter::printMaps()
         const FieldDescriptor *field = mDescriptor->field(i);
         if (field->is_map()) {
             const Descriptor *type = field->message_type();
-            const char *mapTemplate = type->field(1)->type() == FieldDescriptor::TYPE_MESSAGE ? Templates::MessageMapTypeUsingTemplate : Templates::MapTypeUsingTemplate;
+            const bool isMessageMap = type->field(1)->type() == FieldDescriptor::TYPE_MESSAGE;
+            const char *mapTemplate = isMessageMap ? Templates::MessageMapTypeUsingTemplate : Templates::MapTypeUsingTemplate;
+            if (GeneratorOptions::instance().generateHashMaps()) {
+                mapTemplate = isMessageMap ? Templates::MessageHashTypeUsingTemplate : Templates::HashTypeUsingTemplate;
+            }
             mPrinter->Print(common::producePropertyMap(field, mDescriptor), mapTemplate);
         }
     }
@@ -190,6 +198,10 @@ void MessageDeclarationPrinter::printMetaTypesDeclaration()
         mPrinter->Print(mTypeMap,
                         Templates::DeclareComplexQmlListTypeTemplate);
     }
+    mPrinter->Print(mTypeMap, Templates::DeclareStdHashTemplate);
+    if (common::isValueType(mDescriptor)) {
+        mPrinter->Print(mTypeMap, Templates::DeclareValueTypeTemplate);
+    }
     common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *field, PropertyMap &propertyMap) {
         if (field->type() == FieldDescriptor::TYPE_ENUM
                 && common::isLocalEnum(field->enum_type(), mDescriptor)) {
@@ -202,7 +214,8 @@ void MessageDeclarationPrinter::printMetaTypesDeclaration()
             propertyMap["value_type_underscore"] = propertyMap["key_type"];
             utils::replace(propertyMap["value_type_underscore"], "::", "_");
 
-            mPrinter->Print(propertyMap, Templates::DeclareMetaTypeMapTemplate);
+            mPrinter->Print(propertyMap, GeneratorOptions::instance().generateHashMaps() ? Templates::DeclareMetaTypeHashTemplate
+                                                                                          : Templates::DeclareMetaTypeMapTemplate);
         }
     });
 
@@ -235,11 +248,14 @@ void MessageDeclarationPrinter::printProperties()
     for (int i = 0; i < mDescriptor->field_count(); i++) {
         const FieldDescriptor *field = mDescriptor->field(i);
         if (field->type() == FieldDescriptor::TYPE_MESSAGE && field->is_repeated() && !field->is_map()
-                && GeneratorOptions::instance().hasQml()) {
+                && !common::isValueList(field) && GeneratorOptions::instance().hasQml()) {
             mPrinter->Print(common::producePropertyMap(field, mDescriptor), Templates::QmlListPropertyTemplate);
         } else if (common::hasQmlAlias(field)) {
             mPrinter->Print(common::producePropertyMap(field, mDescriptor), Templates::NonScriptableAliasPropertyTemplate);
         }
+        if (common::hasScalarView(field)) {
+            mPrinter->Print(common::producePropertyMap(field, mDescriptor), Templates::ScalarViewPropertyTemplate);
+        }
     }
 
     Outdent();
@@ -257,13 +273,22 @@ void MessageDeclarationPrinter::printGetters()
             mPrinter->Print(propertyMap, Templates::GetterTemplate);
         }
 
+        if (common::hasExplicitPresence(field)) {
+            mPrinter->Print(propertyMap, Templates::HasFieldTemplate);
+            mPrinter->Print(propertyMap, Templates::ClearFieldDeclarationTemplate);
+        }
+
         if (field->is_repeated()) {
             mPrinter->Print(propertyMap, Templates::GetterContainerExtraTemplate);
             if (field->type() == FieldDescriptor::TYPE_MESSAGE && !field->is_map()
-                    && GeneratorOptions::instance().hasQml()) {
+                    && !common::isValueList(field) && GeneratorOptions::instance().hasQml()) {
                 mPrinter->Print(propertyMap, Templates::GetterQmlListDeclarationTemplate);
             }
         }
+
+        if (common::hasScalarView(field)) {
+            mPrinter->Print(propertyMap, Templates::ScalarViewGetterTemplate);
+        }
     });
     Outdent();
 }
@@ -285,13 +310,35 @@ void MessageDeclarationPrinter::printSetters()
             mPrinter->Print(propertyMap, Templates::SetterTemplateDeclarationComplexType);
             break;
         default:
-            mPrinter->Print(propertyMap, Templates::SetterTemplate);
+            //Setters of oneof members and optional fields update presence, they are defined out of class
+            if (common::hasPresenceUpdate(field)) {
+                mPrinter->Print(propertyMap, Templates::SetterTemplateDeclarationComplexType);
+            } else {
+                mPrinter->Print(propertyMap, Templates::SetterTemplate);
+            }
             break;
         }
     });
     Outdent();
 }
 
+void MessageDeclarationPrinter::printOneofs()
+{
+    Indent();
+    common::iterateOneofs(mDescriptor, [&](const OneofDescriptor *oneof, const PropertyMap &oneofMap) {
+        mPrinter->Print(oneofMap, Templates::OneofCaseEnumBeginTemplate);
+        Indent();
+        for (int i = 0; i < oneof->field_count(); i++) {
+            mPrinter->Print(common::producePropertyMap(oneof->field(i), mDescriptor), Templates::OneofCaseEnumFieldTemplate);
+        }
+        Outdent();
+        mPrinter->Print(Templates::SemicolonBlockEnclosureTemplate);
+        mPrinter->Print(oneofMap, Templates::OneofCaseGetterTemplate);
+        mPrinter->Print(oneofMap, Templates::OneofClearTemplate);
+    });
+    Outdent();
+}
+
 void MessageDeclarationPrinter::printPrivateGetters()
 {
     Indent();
@@ -330,9 +377,13 @@ void MessageDeclarationPrinter::printPrivateMethods()
     common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *field, const PropertyMap &propertyMap) {
         if (common::hasQmlAlias(field)) {
             mPrinter->Print(propertyMap, Templates::NonScriptableGetterTemplate);
-            mPrinter->Print(propertyMap, Templates::NonScriptableSetterTemplate);
+            mPrinter->Print(propertyMap, common::hasPresenceUpdate(field) ? Templates::DelegatingNonScriptableSetterTemplate
+                                                                          : Templates::NonScriptableSetterTemplate);
         }
     });
+    common::iterateOneofs(mDescriptor, [&](const OneofDescriptor *, const PropertyMap &oneofMap) {
+        mPrinter->Print(oneofMap, Templates::OneofCaseSetterDeclarationTemplate);
+    });
     Outdent();
 }
 
@@ -391,13 +442,24 @@ void MessageDeclarationPrinter::printClassBody()
     printMoveSemantic();
 
     printComparisonOperators();
+    mPrinter->Print(Templates::ClearDeclarationTemplate);
+    mPrinter->Print(Templates::SpaceUsedDeclarationTemplate);
+    mPrinter->Print(mTypeMap, Templates::DeltaDeclarationTemplate);
     Outdent();
 
+    printOneofs();
     printGetters();
     printSetters();
+    printFieldVisitors();
 
     Indent();
     mPrinter->Print(mTypeMap, Templates::ManualRegistrationDeclaration);
+    if (common::hasDirectSerializers(mDescriptor)) {
+        mPrinter->Print(Templates::DirectSerializersDeclarationTemplate);
+    }
+    if (common::hasSchemaFingerprint(mDescriptor)) {
+        mPrinter->Print(Templates::ParseInOrderDeclarationTemplate);
+    }
     Outdent();
 
     printSignalsBlock();
@@ -415,6 +477,31 @@ void MessageDeclarationPrinter::printClassBody()
 void MessageDeclarationPrinter::printListType()
 {
     mPrinter->Print(mTypeMap, Templates::ComplexListTypeUsingTemplate);
+    mPrinter->Print(mTypeMap, Templates::HashFunctionDeclarationTemplate);
+}
+
+void MessageDeclarationPrinter::printValueType()
+{
+    if (!common::isValueType(mDescriptor)) {
+        return;
+    }
+
+    //Value type is a gadget without d-pointer, it's stored inline in repeated fields of other messages
+    mPrinter->Print(mTypeMap, Templates::ValueTypeDeclarationBeginTemplate);
+    Indent();
+    common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *, const PropertyMap &propertyMap) {
+        mPrinter->Print(propertyMap, Templates::ValueTypePropertyTemplate);
+    });
+    Outdent();
+    printPublicBlock();
+    Indent();
+    mPrinter->Print(mTypeMap, Templates::ValueTypePublicDeclarationTemplate);
+    common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *, const PropertyMap &propertyMap) {
+        mPrinter->Print(propertyMap, Templates::ValueTypeMemberTemplate);
+    });
+    Outdent();
+    encloseClass();
+    mPrinter->Print(mTypeMap, Templates::ValueTypeListUsingTemplate);
 }
 
 void MessageDeclarationPrinter::printClassMembers()
@@ -428,6 +515,15 @@ void MessageDeclarationPrinter::printClassMembers()
         } else {
             mPrinter->Print(propertyMap, Templates::MemberTemplate);
         }
+        if (common::hasScalarView(field)) {
+            mPrinter->Print(propertyMap, Templates::ScalarViewMemberTemplate);
+        }
+    });
+    mPrinter->Print(Templates::UnknownFieldsMemberTemplate);
+    mPrinter->Print({{"presence_words", std::to_string(common::presenceWordCount(mDescriptor))}}, Templates::PresenceMemberTemplate);
+    mPrinter->Print({{"presence_words", std::to_string(common::presenceWordCount(mDescriptor))}}, Templates::DirtyFieldsMemberTemplate);
+    common::iterateOneofs(mDescriptor, [&](const OneofDescriptor *, const PropertyMap &oneofMap) {
+        mPrinter->Print(oneofMap, Templates::OneofCaseMemberTemplate);
     });
     Outdent();
 }
@@ -437,6 +533,32 @@ void MessageDeclarationPrinter::printDestructor()
     mPrinter->Print(mTypeMap, "virtual ~$classname$();\n");
 }
 
+void MessageDeclarationPrinter::printFieldVisitors()
+{
+    //Visitors dispatch over field numbers of QtProtobufFieldEnum
+    if (!GeneratorOptions::instance().generateFieldEnum() || mDescriptor->field_count() <= 0) {
+        return;
+    }
+
+    Indent();
+    mPrinter->Print(Templates::VisitFieldBeginTemplate);
+    Indent();
+    common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *, const PropertyMap &propertyMap) {
+        mPrinter->Print(propertyMap, Templates::VisitFieldCaseTemplate);
+    });
+    Outdent();
+    mPrinter->Print(Templates::VisitFieldEndTemplate);
+
+    mPrinter->Print(Templates::ForEachFieldBeginTemplate);
+    Indent();
+    common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *, const PropertyMap &propertyMap) {
+        mPrinter->Print(propertyMap, Templates::ForEachFieldTemplate);
+    });
+    Outdent();
+    mPrinter->Print(Templates::SimpleBlockEnclosureTemplate);
+    Outdent();
+}
+
 void MessageDeclarationPrinter::printFieldEnum()
 {
     Indent();
@@ -53,6 +53,7 @@ private:
     void printProperties();
     void printGetters();
     void printSetters();
+    void printOneofs();
     void printPrivateGetters();
     void printPrivateSetters();
     void printSignals();
@@ -62,11 +63,13 @@ private:
     void printConstructors();
     void printDestructor();
     void printListType();
+    void printValueType();
     void printMaps();
     void printNested();
     void printMetaTypesDeclaration();
     void printClassDeclarationBegin();
     void printFieldEnum();
+    void printFieldVisitors();
 
     void printQEnums();
 
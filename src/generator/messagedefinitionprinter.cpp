@@ -28,6 +28,10 @@
 #include <google/protobuf/descriptor.h>
 #include "generatoroptions.h"
 
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
 using namespace QtProtobuf::generator;
 using namespace ::google::protobuf;
 
@@ -54,8 +58,15 @@ void MessageDefinitionPrinter::printClassDefinitionPrivate()
     printConstructors();
     printCopyFunctionality();
     printMoveSemantic();
+    printClearFunctionality();
+    printSpaceUsed();
+    printOneofs();
+    printMergeFunctionality();
     printComparisonOperators();
+    printHashFunction();
     printGetters();
+    printDirectSerializers();
+    printValueType();
 }
 
 void MessageDefinitionPrinter::printClassDefinition()
@@ -75,32 +86,154 @@ void MessageDefinitionPrinter::printRegisterBody()
         mPrinter->Print(mTypeMap, Templates::QmlRegisterTypeTemplate);
     }
 
+    mRegisteredTypes.clear();
     common::iterateMessageFields(mDescriptor, [this](const FieldDescriptor *field, const PropertyMap &propertyMap) {
         if (field->type() == FieldDescriptor::TYPE_ENUM
                 && common::isLocalEnum(field->enum_type(), mDescriptor)) {
-            mPrinter->Print(propertyMap, Templates::RegisterLocalEnumTemplate);
+            printRegistrationOnce(propertyMap, Templates::RegisterLocalEnumTemplate, propertyMap.at("scope_type"));
         } else if (field->is_map()) {
-            mPrinter->Print(propertyMap, Templates::RegisterMapTemplate);
+            printRegistrationOnce(propertyMap, GeneratorOptions::instance().generateHashMaps() ? Templates::RegisterHashTemplate
+                                                                                                : Templates::RegisterMapTemplate,
+                                  propertyMap.at("scope_type"));
         }
+        printRegisterFieldType(field, propertyMap);
     });
+    if (common::isValueType(mDescriptor)) {
+        mPrinter->Print(mTypeMap, Templates::RegisterValueTypeTemplate);
+    }
 
     Outdent();
     mPrinter->Print(Templates::SimpleBlockEnclosureTemplate);
+    mPrinter->Print(mTypeMap, Templates::LazyRegistrationComplexTypeDefinition);
+}
+
+void MessageDefinitionPrinter::printRegisterFieldType(const FieldDescriptor *field, const PropertyMap &propertyMap)
+{
+    //Types of fields are registered with message, so message is serialized correctly when it's registered on demand
+    if (field->is_map()) {
+        const FieldDescriptor *valueField = field->message_type()->field(1);
+        if (valueField->type() == FieldDescriptor::TYPE_MESSAGE && !common::isQtType(valueField)) {
+            printRegistrationOnce({{"scope_type", propertyMap.at("value_type")}}, Templates::RegisterFieldTypeTemplate,
+                                  propertyMap.at("value_type"));
+        }
+        return;
+    }
+
+    if (field->type() == FieldDescriptor::TYPE_MESSAGE && !common::isQtType(field)) {
+        printRegistrationOnce(propertyMap, Templates::RegisterFieldTypeTemplate, propertyMap.at("scope_type"));
+    } else if (field->type() == FieldDescriptor::TYPE_ENUM) {
+        switch (common::enumVisibility(field->enum_type(), mDescriptor)) {
+        case common::GLOBAL_ENUM:
+            printRegistrationOnce(propertyMap, Templates::RegisterGlobalEnumFieldTypeTemplate, propertyMap.at("scope_namespaces"));
+            break;
+        case common::NEIGHBOR_ENUM: {
+            //Enum is registered by message that contains it
+            const PropertyMap containingTypeMap = common::produceMessageTypeMap(field->enum_type()->containing_type(), mDescriptor);
+            printRegistrationOnce(containingTypeMap, Templates::RegisterFieldTypeTemplate, containingTypeMap.at("scope_type"));
+        }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+//Several fields of the same type would register it several times, so every registration is printed once per message
+void MessageDefinitionPrinter::printRegistrationOnce(const PropertyMap &propertyMap, const char *registrationTemplate, const std::string &type)
+{
+    if (mRegisteredTypes.insert(std::string(registrationTemplate) + type).second) {
+        mPrinter->Print(propertyMap, registrationTemplate);
+    }
 }
 
 void MessageDefinitionPrinter::printFieldsOrdering() {
-    mPrinter->Print({{"type", mTypeMap["classname"]}}, Templates::FieldsOrderingContainerTemplate);
+    const char *containerTemplate = common::hasDirectSerializers(mDescriptor) ? Templates::DirectFieldsOrderingContainerTemplate
+                                                                              : Templates::FieldsOrderingContainerTemplate;
+    //Fields are printed in field number order, to keep table initialization close to its final layout
+    std::vector<int> fieldOrder(static_cast<size_t>(mDescriptor->field_count()));
+    std::iota(fieldOrder.begin(), fieldOrder.end(), 0);
+    std::stable_sort(fieldOrder.begin(), fieldOrder.end(), [this](int a, int b) {
+        return mDescriptor->field(a)->number() < mDescriptor->field(b)->number();
+    });
+
+    //Arguments are positional, revision accessor follows them
+    std::string schemaFingerprint = ", 0, nullptr";
+    if (common::hasSchemaFingerprint(mDescriptor)) {
+        schemaFingerprint = ",\n    " + common::schemaFingerprint(mDescriptor)
+                + ",\n    [](QObject *object, const QByteArray &data) { static_cast<" + mTypeMap["classname"] + " *>(object)->parseInOrder(data); }";
+    }
+
+    //Empty array can't be defined, so messages without fields have no descriptor table
+    mPrinter->Print({{"type", mTypeMap["classname"]},
+                     {"field_descriptors", fieldOrder.empty() ? "nullptr" : mTypeMap["classname"] + "::protobufFieldDescriptors"},
+                     {"schema_fingerprint", schemaFingerprint}},
+                    containerTemplate);
     Indent();
-    for (int i = 0; i < mDescriptor->field_count(); i++) {
+    for (size_t j = 0; j < fieldOrder.size(); j++) {
+        const int i = fieldOrder[j];
         const FieldDescriptor *field = mDescriptor->field(i);
-        if (i != 0) {
+        if (j != 0) {
             mPrinter->Print("\n,");
         }
         //property_number is incremented by 1 because user properties stating from 1.
         //Property with index 0 is "objectName"
+        //Singular message fields accept unparsed payload for lazy parsing, except oneof members
+        //that are activated by setter
+        const bool isMessage = common::isPureMessage(field) && !common::isOneofMember(field);
         mPrinter->Print({{"field_number", std::to_string(field->number())},
                          {"property_number", std::to_string(i + 1)},
-                         {"json_name", field->json_name()}}, Templates::FieldOrderTemplate);
+                         {"json_name", field->json_name()},
+                         {"proto_name", field->name()},
+                         {"wire_type", common::wireType(field)},
+                         {"type", mTypeMap["classname"]},
+                         {"property_name", isMessage ? common::producePropertyMap(field, mDescriptor)["property_name"] : ""},
+                         {"presence_index", std::to_string(j)}},
+                        isMessage ? Templates::MessageFieldOrderTemplate : Templates::FieldOrderTemplate);
+    }
+    Outdent();
+    mPrinter->Print(Templates::SemicolonBlockEnclosureTemplate);
+    mPrinter->Print("\n");
+    printFieldDescriptors(fieldOrder);
+}
+
+void MessageDefinitionPrinter::printFieldDescriptors(const std::vector<int> &fieldOrder)
+{
+    if (fieldOrder.empty()) {
+        return;
+    }
+
+    mPrinter->Print({{"type", mTypeMap["classname"]}}, Templates::FieldDescriptorsContainerTemplate);
+    Indent();
+    for (size_t j = 0; j < fieldOrder.size(); j++) {
+        const int i = fieldOrder[j];
+        const FieldDescriptor *field = mDescriptor->field(i);
+        if (j != 0) {
+            mPrinter->Print("\n,");
+        }
+        auto propertyMap = common::producePropertyMap(field, mDescriptor);
+        //Metatype follows type of property declared for field, see MessageDeclarationPrinter::printProperties
+        std::string metaType = propertyMap["property_type"];
+        if (common::isPureMessage(field)) {
+            metaType += " *";
+        } else if (field->is_repeated() && !field->is_map() && !common::hasQmlAlias(field)) {
+            metaType = propertyMap["property_list_type"];
+        }
+        std::string nestedType = "nullptr";
+        if (field->type() == FieldDescriptor::TYPE_MESSAGE && !field->is_map() && !common::isQtType(field)) {
+            nestedType = "&" + common::produceMessageTypeMap(field->message_type(), mDescriptor)["scope_type"] + "::protobufMetaObject";
+        }
+        mPrinter->Print({{"field_number", std::to_string(field->number())},
+                         {"property_number", std::to_string(i + 1)},
+                         {"wire_type", common::wireType(field)},
+                         {"field_kind", common::fieldKind(field)},
+                         {"repeated", field->is_repeated() && !field->is_map() ? "true" : "false"},
+                         {"explicit_presence", common::hasExplicitPresence(field) ? "true" : "false"},
+                         {"json_name", field->json_name()},
+                         {"proto_name", field->name()},
+                         {"meta_type", metaType},
+                         {"nested_type", nestedType},
+                         {"intern_strings", common::isInternedString(field) ? "true" : "false"}},
+                        Templates::FieldDescriptorTemplate);
     }
     Outdent();
     mPrinter->Print(Templates::SemicolonBlockEnclosureTemplate);
@@ -113,13 +246,14 @@ void MessageDefinitionPrinter::printConstructors() {
         printConstructor(i);
         mPrinter->Print(mTypeMap, Templates::ProtoConstructorDefinitionEndTemplate);
         printInitializationList(i);
-        mPrinter->Print(Templates::ConstructorContentTemplate);
+        printConstructorContent(i);
     }
 
     if (mDescriptor->full_name() == std::string("google.protobuf.Timestamp")) {
         mPrinter->Print("Timestamp::Timestamp(const QDateTime &datetime, QObject *parent) : QObject(parent)\n"
                         ", m_seconds(datetime.toMSecsSinceEpoch() / 1000)\n"
                         ", m_nanos((datetime.toMSecsSinceEpoch() % 1000) * 1000)\n"
+                        ", m_protobufPresence({0x00000003u})\n"
                         "{}\n"
                         "Timestamp::operator QDateTime() const\n"
                         "{\n"
@@ -146,6 +280,30 @@ void MessageDefinitionPrinter::printConstructor(int fieldCount)
     }
 }
 
+void MessageDefinitionPrinter::printConstructorContent(int fieldCount)
+{
+    //Oneof members that are passed with non-default values are activated in order of parameters
+    bool hasOneofParameters = false;
+    for (int i = 0; i < fieldCount; i++) {
+        hasOneofParameters |= common::isOneofMember(mDescriptor->field(i));
+    }
+    if (!hasOneofParameters) {
+        mPrinter->Print(Templates::ConstructorContentTemplate);
+        return;
+    }
+
+    mPrinter->Print("\n{\n");
+    Indent();
+    for (int i = 0; i < fieldCount; i++) {
+        const FieldDescriptor *field = mDescriptor->field(i);
+        if (common::isOneofMember(field)) {
+            mPrinter->Print(common::producePropertyMap(field, mDescriptor), Templates::OneofConstructorActivationTemplate);
+        }
+    }
+    Outdent();
+    mPrinter->Print(Templates::SimpleBlockEnclosureTemplate);
+}
+
 void MessageDefinitionPrinter::printInitializationList(int fieldCount)
 {
     for (int i = 0; i < mDescriptor->field_count(); i++) {
@@ -174,6 +332,12 @@ void MessageDefinitionPrinter::printInitializationList(int fieldCount)
             case FieldDescriptor::TYPE_ENUM:
                 propertyMap["initializer"] = propertyMap["scope_type"] + "::" + field->enum_type()->value(0)->name();
                 break;
+            case FieldDescriptor::TYPE_MESSAGE:
+                //std::chrono::nanoseconds is not zeroed by default constructor
+                if (common::nativeWellKnownType(field) == "std::chrono::nanoseconds") {
+                    propertyMap["initializer"] = "0";
+                }
+                break;
             default:
                 break;
             }
@@ -195,48 +359,67 @@ void MessageDefinitionPrinter::printInitializationList(int fieldCount)
             }
         }
     }
+    //Fields initialized by constructor arguments are marked as set
+    mPrinter->Print({{"presence_mask", common::presenceMask(mDescriptor, fieldCount)}}, Templates::PresenceInitializerTemplate);
 }
 
 void MessageDefinitionPrinter::printCopyFunctionality()
 {
     assert(mDescriptor != nullptr);
 
-    const char *constructorTemplate = Templates::CopyConstructorDefinitionTemplate;
-    const char *assignmentOperatorTemplate = Templates::AssignmentOperatorDefinitionTemplate;
-    if (mDescriptor->field_count() <= 0) {
-        constructorTemplate = Templates::EmptyCopyConstructorDefinitionTemplate;
-        assignmentOperatorTemplate = Templates::EmptyAssignmentOperatorDefinitionTemplate;
-    }
-
+    //Other message is used even if message has no fields, to copy unknown fields.
+    //New object has no connections, so fields are copied directly without setters. Strings, bytes,
+    //repeated fields and maps are implicitly shared, only materialized nested messages are cloned.
     mPrinter->Print(mTypeMap,
-                    constructorTemplate);
+                    Templates::CopyConstructorDefinitionTemplate);
     common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *field, const PropertyMap &propertyMap) {
         if (common::isPureMessage(field)) {
             mPrinter->Print(propertyMap, Templates::MessagePropertyDefaultInitializerTemplate);
+        } else {
+            mPrinter->Print(propertyMap, Templates::CopyFieldInitializerTemplate);
         }
     });
+    mPrinter->Print(Templates::CopyStateInitializerTemplate);
+    common::iterateOneofs(mDescriptor, [&](const OneofDescriptor *, const PropertyMap &oneofMap) {
+        mPrinter->Print(oneofMap, Templates::OneofCaseInitializerTemplate);
+    });
     mPrinter->Print("\n{\n");
 
     Indent();
     common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *field, const PropertyMap &propertyMap) {
         if (common::isPureMessage(field)) {
             mPrinter->Print(propertyMap, Templates::CopyComplexFieldTemplate);
-        } else {
-            mPrinter->Print(propertyMap, Templates::CopyFieldTemplate);
         }
     });
+    mPrinter->Print(Templates::CleanDirtyFieldsTemplate);
     Outdent();
     mPrinter->Print(Templates::SimpleBlockEnclosureTemplate);
 
-    mPrinter->Print(mTypeMap, assignmentOperatorTemplate);
+    //Active members are switched first, then members are assigned directly to keep them active
+    mPrinter->Print(mTypeMap, Templates::AssignmentOperatorDefinitionTemplate);
     Indent();
+    common::iterateOneofs(mDescriptor, [&](const OneofDescriptor *, const PropertyMap &oneofMap) {
+        mPrinter->Print(oneofMap, Templates::OneofCopyCaseTemplate);
+    });
+    const bool compact = common::isCompact(mDescriptor);
+    if (compact) {
+        mPrinter->Print(Templates::CompactCopyFieldsTemplate);
+    }
     common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *field, const PropertyMap &propertyMap) {
         if (common::isPureMessage(field)) {
             mPrinter->Print(propertyMap, Templates::AssignComplexFieldTemplate);
+        } else if (compact) {
+            return;
+        } else if (common::isOneofMember(field)) {
+            mPrinter->Print(propertyMap, Templates::OneofAssignFieldTemplate);
         } else {
             mPrinter->Print(propertyMap, Templates::CopyFieldTemplate);
         }
     });
+    if (!compact) {
+        mPrinter->Print(Templates::CopyUnknownFieldsTemplate);
+    }
+    mPrinter->Print(Templates::CopyPresenceTemplate);
     mPrinter->Print(Templates::AssignmentOperatorReturnTemplate);
     Outdent();
     mPrinter->Print(Templates::SimpleBlockEnclosureTemplate);
@@ -246,15 +429,8 @@ void MessageDefinitionPrinter::printMoveSemantic()
 {
     assert(mDescriptor != nullptr);
 
-    const char *constructorTemplate = Templates::MoveConstructorDefinitionTemplate;
-    const char *assignmentOperatorTemplate = Templates::MoveAssignmentOperatorDefinitionTemplate;
-    if (mDescriptor->field_count() <= 0) {
-        constructorTemplate = Templates::EmptyMoveConstructorDefinitionTemplate;
-        assignmentOperatorTemplate = Templates::EmptyMoveAssignmentOperatorDefinitionTemplate;
-    }
-
     mPrinter->Print(mTypeMap,
-                    constructorTemplate);
+                    Templates::MoveConstructorDefinitionTemplate);
     common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *field, const PropertyMap &propertyMap) {
         if (common::isPureMessage(field)) {
             mPrinter->Print(propertyMap, Templates::MessagePropertyDefaultInitializerTemplate);
@@ -262,9 +438,12 @@ void MessageDefinitionPrinter::printMoveSemantic()
     });
     mPrinter->Print("\n{\n");
 
+    //Members of oneofs are moved directly, other message is reset to inactive oneofs afterwards
     Indent();
     common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *field, const PropertyMap &propertyMap) {
-        if (field->type() == FieldDescriptor::TYPE_MESSAGE
+        if (common::isOneofMember(field) && !common::isPureMessage(field)) {
+            mPrinter->Print(propertyMap, Templates::OneofMoveFieldTemplate);
+        } else if (field->type() == FieldDescriptor::TYPE_MESSAGE
                 || field->type() == FieldDescriptor::TYPE_STRING
                 || field->type() == FieldDescriptor::TYPE_BYTES
                 || field->is_repeated()) {
@@ -282,13 +461,25 @@ void MessageDefinitionPrinter::printMoveSemantic()
             }
         }
     });
+    mPrinter->Print(Templates::MoveUnknownFieldsTemplate);
+    mPrinter->Print(Templates::CopyPresenceTemplate);
+    common::iterateOneofs(mDescriptor, [&](const OneofDescriptor *, const PropertyMap &oneofMap) {
+        mPrinter->Print(oneofMap, Templates::OneofMoveCaseTemplate);
+        mPrinter->Print(oneofMap, Templates::OneofClearOtherCaseTemplate);
+    });
+    mPrinter->Print(Templates::CleanDirtyFieldsTemplate);
     Outdent();
     mPrinter->Print(Templates::SimpleBlockEnclosureTemplate);
 
-    mPrinter->Print(mTypeMap, assignmentOperatorTemplate);
+    mPrinter->Print(mTypeMap, Templates::MoveAssignmentOperatorDefinitionTemplate);
     Indent();
+    common::iterateOneofs(mDescriptor, [&](const OneofDescriptor *, const PropertyMap &oneofMap) {
+        mPrinter->Print(oneofMap, Templates::OneofCopyCaseTemplate);
+    });
     common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *field, const PropertyMap &propertyMap) {
-        if (field->type() == FieldDescriptor::TYPE_MESSAGE
+        if (common::isOneofMember(field) && !common::isPureMessage(field)) {
+            mPrinter->Print(propertyMap, Templates::OneofAssignFieldTemplate);
+        } else if (field->type() == FieldDescriptor::TYPE_MESSAGE
                 || field->type() == FieldDescriptor::TYPE_STRING
                 || field->type() == FieldDescriptor::TYPE_BYTES
                 || field->is_repeated()) {
@@ -306,11 +497,120 @@ void MessageDefinitionPrinter::printMoveSemantic()
             }
         }
     });
+    mPrinter->Print(Templates::MoveUnknownFieldsTemplate);
+    mPrinter->Print(Templates::CopyPresenceTemplate);
+    common::iterateOneofs(mDescriptor, [&](const OneofDescriptor *, const PropertyMap &oneofMap) {
+        mPrinter->Print(oneofMap, Templates::OneofClearOtherCaseTemplate);
+    });
     mPrinter->Print(Templates::AssignmentOperatorReturnTemplate);
     Outdent();
     mPrinter->Print(Templates::SimpleBlockEnclosureTemplate);
 }
 
+void MessageDefinitionPrinter::printClearFunctionality()
+{
+    assert(mDescriptor != nullptr);
+
+    //Inactive oneof members hold default values, so only active members are reset
+    mPrinter->Print(mTypeMap, Templates::ClearDefinitionTemplate);
+    Indent();
+    common::iterateOneofs(mDescriptor, [&](const OneofDescriptor *, const PropertyMap &oneofMap) {
+        mPrinter->Print(oneofMap, Templates::OneofClearCaseTemplate);
+    });
+    const bool compact = common::isCompact(mDescriptor);
+    if (compact) {
+        mPrinter->Print(Templates::CompactClearFieldsTemplate);
+    }
+    common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *field, const PropertyMap &propertyMap) {
+        if (common::isOneofMember(field)) {
+            return;
+        }
+        if (common::isPureMessage(field)) {
+            mPrinter->Print(propertyMap, Templates::ClearMessageFieldTemplate);
+        } else if (compact) {
+            return;
+        } else if (field->type() == FieldDescriptor::TYPE_STRING
+                   || field->type() == FieldDescriptor::TYPE_BYTES
+                   || field->is_repeated()) {
+            mPrinter->Print(propertyMap, Templates::ClearComplexFieldTemplate);
+        } else if (field->type() == FieldDescriptor::TYPE_ENUM) {
+            mPrinter->Print(propertyMap, Templates::EnumClearFieldTemplate);
+        } else {
+            mPrinter->Print(propertyMap, Templates::ClearFieldTemplate);
+        }
+    });
+    if (!compact) {
+        mPrinter->Print(Templates::ClearUnknownFieldsTemplate);
+    }
+    mPrinter->Print({{"presence_mask", common::presenceMask(mDescriptor, 0)}}, Templates::ClearPresenceTemplate);
+    Outdent();
+    mPrinter->Print(Templates::SimpleBlockEnclosureTemplate);
+}
+
+void MessageDefinitionPrinter::printSpaceUsed()
+{
+    mPrinter->Print(mTypeMap, Templates::SpaceUsedDefinitionTemplate);
+    Indent();
+    common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *, const PropertyMap &propertyMap) {
+        mPrinter->Print(propertyMap, Templates::SpaceUsedFieldTemplate);
+    });
+    mPrinter->Print(Templates::SpaceUsedUnknownFieldsTemplate);
+    Outdent();
+    mPrinter->Print(Templates::SimpleBlockEnclosureTemplate);
+}
+
+void MessageDefinitionPrinter::printOneofs()
+{
+    common::iterateOneofs(mDescriptor, [&](const OneofDescriptor *oneof, const PropertyMap &oneofMap) {
+        mPrinter->Print(oneofMap, Templates::OneofCaseSetterDefinitionTemplate);
+        Indent();
+        for (int i = 0; i < oneof->field_count(); i++) {
+            mPrinter->Print(common::producePropertyMap(oneof->field(i), mDescriptor), Templates::OneofActivateFieldTemplate);
+        }
+        mPrinter->Print(Templates::OneofCaseSetterMiddleTemplate);
+        for (int i = 0; i < oneof->field_count(); i++) {
+            const FieldDescriptor *field = oneof->field(i);
+            mPrinter->Print(common::producePropertyMap(field, mDescriptor),
+                            common::isPureMessage(field) ? Templates::OneofResetMessageFieldTemplate
+                                                         : Templates::OneofResetFieldTemplate);
+        }
+        mPrinter->Print(Templates::OneofCaseSetterEndTemplate);
+        Outdent();
+        mPrinter->Print(Templates::SimpleBlockEnclosureTemplate);
+    });
+}
+
+void MessageDefinitionPrinter::printMergeFunctionality()
+{
+    assert(mDescriptor != nullptr);
+    if (mDescriptor->field_count() <= 0) {
+        mPrinter->Print(mTypeMap, Templates::EmptyMergeFieldsDefinitionTemplate);
+        return;
+    }
+
+    //Fields are assigned using setters, so signals are emitted for changed fields only
+    mPrinter->Print(mTypeMap, Templates::MergeFieldsDefinitionTemplate);
+    Indent();
+    const bool compact = common::isCompact(mDescriptor);
+    if (compact) {
+        mPrinter->Print(Templates::CompactMergeFieldsTemplate);
+    }
+    common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *field, const PropertyMap &propertyMap) {
+        if (compact && !common::isPureMessage(field)) {
+            return;
+        }
+        if (common::isOneofMember(field)) {
+            mPrinter->Print(propertyMap, Templates::OneofMergeFieldTemplate);
+        } else if (common::hasExplicitPresence(field)) {
+            mPrinter->Print(propertyMap, Templates::OptionalMergeFieldTemplate);
+        } else {
+            mPrinter->Print(propertyMap, Templates::MergeFieldTemplate);
+        }
+    });
+    Outdent();
+    mPrinter->Print(Templates::SimpleBlockEnclosureTemplate);
+}
+
 void MessageDefinitionPrinter::printComparisonOperators()
 {
     assert(mDescriptor != nullptr);
@@ -322,8 +622,53 @@ void MessageDefinitionPrinter::printComparisonOperators()
 
     mPrinter->Print(mTypeMap, Templates::EqualOperatorDefinitionTemplate);
 
-    bool isFirst = true;
+    //Cheap comparisons go first to exit early: scalars, container sizes, strings, and then
+    //deep comparison of messages and containers
+    enum ComparisonStage {
+        ScalarStage = 0,
+        SizeStage,
+        StringStage,
+        ContainerStage,
+        MessageStage,
+        MessageContainerStage
+    };
+    struct Comparison {
+        ComparisonStage stage;
+        const char *templ;
+        PropertyMap propertyMap;
+    };
+    std::vector<Comparison> comparisons;
     common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *field, PropertyMap &propertyMap) {
+        //Optional field set to default value differs from unset one
+        if (common::hasExplicitPresence(field)) {
+            comparisons.push_back({ScalarStage, Templates::EqualOperatorPresenceTemplate, propertyMap});
+        }
+        if (common::isPureMessage(field)) {
+            comparisons.push_back({MessageStage, Templates::EqualOperatorMessagePropertyTemplate, propertyMap});
+        } else if (field->is_repeated()) {
+            comparisons.push_back({SizeStage, Templates::EqualOperatorSizePropertyTemplate, propertyMap});
+            if (field->type() == FieldDescriptor::TYPE_MESSAGE && !common::isValueList(field)) {
+                comparisons.push_back({MessageContainerStage, Templates::EqualOperatorRepeatedPropertyTemplate, propertyMap});
+            } else {
+                comparisons.push_back({ContainerStage, Templates::EqualOperatorPropertyTemplate, propertyMap});
+            }
+        } else if (field->type() == FieldDescriptor::TYPE_STRING
+                   || field->type() == FieldDescriptor::TYPE_BYTES
+                   || field->type() == FieldDescriptor::TYPE_MESSAGE) {
+            comparisons.push_back({StringStage, Templates::EqualOperatorPropertyTemplate, propertyMap});
+        } else {
+            comparisons.push_back({ScalarStage, Templates::EqualOperatorPropertyTemplate, propertyMap});
+        }
+    });
+    common::iterateOneofs(mDescriptor, [&](const OneofDescriptor *, PropertyMap &oneofMap) {
+        comparisons.push_back({ScalarStage, Templates::EqualOperatorOneofCaseTemplate, oneofMap});
+    });
+    std::stable_sort(comparisons.begin(), comparisons.end(), [](const Comparison &a, const Comparison &b) {
+        return a.stage < b.stage;
+    });
+
+    bool isFirst = true;
+    for (const auto &comparison : comparisons) {
         if (!isFirst) {
             mPrinter->Print("\n&& ");
         } else {
@@ -331,14 +676,8 @@ void MessageDefinitionPrinter::printComparisonOperators()
             Indent();
             isFirst = false;
         }
-        if (common::isPureMessage(field)) {
-            mPrinter->Print(propertyMap, Templates::EqualOperatorMessagePropertyTemplate);
-        } else if (field->type() == FieldDescriptor::TYPE_MESSAGE && field->is_repeated()) {
-            mPrinter->Print(propertyMap, Templates::EqualOperatorRepeatedPropertyTemplate);
-        } else {
-            mPrinter->Print(propertyMap, Templates::EqualOperatorPropertyTemplate);
-        }
-    });
+        mPrinter->Print(comparison.propertyMap, comparison.templ);
+    }
 
     //Only if at least one field "copied"
     if (!isFirst) {
@@ -352,6 +691,11 @@ void MessageDefinitionPrinter::printComparisonOperators()
     mPrinter->Print(mTypeMap, Templates::NotEqualOperatorDefinitionTemplate);
 }
 
+void MessageDefinitionPrinter::printHashFunction()
+{
+    mPrinter->Print(mTypeMap, Templates::HashFunctionDefinitionTemplate);
+}
+
 void MessageDefinitionPrinter::printGetters()
 {
     common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *field, PropertyMap &propertyMap) {
@@ -361,7 +705,7 @@ void MessageDefinitionPrinter::printGetters()
         }
         if (field->is_repeated()) {
             if (field->type() == FieldDescriptor::TYPE_MESSAGE && !field->is_map() && !common::isQtType(field)
-                    && GeneratorOptions::instance().hasQml()) {
+                    && !common::isValueList(field) && GeneratorOptions::instance().hasQml()) {
                 mPrinter->Print(propertyMap, Templates::GetterQmlListDefinitionTemplate);
             }
         }
@@ -382,8 +726,14 @@ void MessageDefinitionPrinter::printGetters()
             mPrinter->Print(propertyMap, Templates::SetterTemplateDefinitionComplexType);
             break;
         default:
+            if (common::hasPresenceUpdate(field)) {
+                mPrinter->Print(propertyMap, Templates::SetterTemplateDefinitionComplexType);
+            }
             break;
         }
+        if (common::hasExplicitPresence(field)) {
+            mPrinter->Print(propertyMap, Templates::ClearOptionalFieldDefinitionTemplate);
+        }
     });
 }
 
@@ -393,3 +743,103 @@ void MessageDefinitionPrinter::printDestructor()
     mPrinter->Print(mTypeMap, "$classname$::~$classname$()\n"
                                                  "{}\n\n");
 }
+
+void MessageDefinitionPrinter::printDirectSerializers()
+{
+    if (!common::hasDirectSerializers(mDescriptor)) {
+        return;
+    }
+
+    const char *serializeToTemplate = mDescriptor->field_count() > 0 ? Templates::SerializeToDefinitionTemplate
+                                                                     : Templates::EmptySerializeToDefinitionTemplate;
+    mPrinter->Print(mTypeMap, serializeToTemplate);
+    Indent();
+    common::iterateMessageFieldsInNumberOrder(mDescriptor, [&](const FieldDescriptor *field, PropertyMap &propertyMap) {
+        if (field->type() == FieldDescriptor::TYPE_ENUM) {
+            mPrinter->Print(propertyMap, Templates::SerializeEnumFieldTemplate);
+        } else {
+            mPrinter->Print(propertyMap, Templates::SerializeFieldTemplate);
+        }
+    });
+    Outdent();
+    mPrinter->Print(Templates::SimpleBlockEnclosureTemplate);
+
+    mPrinter->Print(mTypeMap, Templates::ParseFromDefinitionBeginTemplate);
+    Indent();
+    Indent();
+    common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *field, PropertyMap &propertyMap) {
+        if (field->type() == FieldDescriptor::TYPE_ENUM) {
+            mPrinter->Print(propertyMap, Templates::ParseEnumFieldTemplate);
+        } else if (field->is_repeated()) {
+            mPrinter->Print(propertyMap, Templates::ParseRepeatedFieldTemplate);
+        } else {
+            mPrinter->Print(propertyMap, Templates::ParseFieldTemplate);
+        }
+    });
+    Outdent();
+    Outdent();
+    mPrinter->Print(Templates::ParseFromDefinitionEndTemplate);
+
+    if (!common::hasSchemaFingerprint(mDescriptor)) {
+        return;
+    }
+
+    //Fields are expected in the order serializeTo writes them, so each one costs a single header comparison
+    mPrinter->Print(mTypeMap, Templates::ParseInOrderDefinitionBeginTemplate);
+    Indent();
+    common::iterateMessageFieldsInNumberOrder(mDescriptor, [&](const FieldDescriptor *field, PropertyMap &propertyMap) {
+        propertyMap["wire_type"] = common::wireType(field);
+        if (field->type() == FieldDescriptor::TYPE_ENUM) {
+            mPrinter->Print(propertyMap, Templates::OrderedParseEnumFieldTemplate);
+        } else if (field->is_repeated()) {
+            mPrinter->Print(propertyMap, Templates::OrderedParseRepeatedFieldTemplate);
+        } else {
+            mPrinter->Print(propertyMap, Templates::OrderedParseFieldTemplate);
+        }
+    });
+    Outdent();
+    mPrinter->Print(Templates::ParseInOrderDefinitionEndTemplate);
+}
+
+void MessageDefinitionPrinter::printValueType()
+{
+    if (!common::isValueType(mDescriptor)) {
+        return;
+    }
+
+    mPrinter->Print(mTypeMap, Templates::ValueTypeConstructorDefinitionTemplate);
+    bool isFirst = true;
+    common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *, const PropertyMap &propertyMap) {
+        mPrinter->Print(propertyMap, isFirst ? Templates::ValueTypeFirstInitializerTemplate : Templates::ValueTypeInitializerTemplate);
+        isFirst = false;
+    });
+    mPrinter->Print(Templates::ConstructorContentTemplate);
+
+    mPrinter->Print(mTypeMap, Templates::ValueTypeCopyToDefinitionTemplate);
+    Indent();
+    common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *, const PropertyMap &propertyMap) {
+        mPrinter->Print(propertyMap, Templates::ValueTypeCopyFieldTemplate);
+    });
+    Outdent();
+    mPrinter->Print(Templates::SimpleBlockEnclosureTemplate);
+
+    mPrinter->Print(mTypeMap, Templates::ValueTypeEqualOperatorDefinitionTemplate);
+    isFirst = true;
+    //Scalars are compared before strings and bytes
+    for (bool stringStage : {false, true}) {
+        common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *field, const PropertyMap &propertyMap) {
+            bool isString = field->type() == FieldDescriptor::TYPE_STRING || field->type() == FieldDescriptor::TYPE_BYTES;
+            if (isString != stringStage) {
+                return;
+            }
+            if (!isFirst) {
+                mPrinter->Print("\n        && ");
+            }
+            mPrinter->Print(propertyMap, Templates::ValueTypeEqualOperatorPropertyTemplate);
+            isFirst = false;
+        });
+    }
+    mPrinter->Print(";\n");
+    mPrinter->Print(Templates::SimpleBlockEnclosureTemplate);
+    mPrinter->Print(mTypeMap, Templates::ValueTypeNotEqualOperatorDefinitionTemplate);
+}
@@ -27,6 +27,8 @@
 
 #include "descriptorprinterbase.h"
 
+#include <set>
+
 namespace QtProtobuf {
 namespace generator {
 
@@ -45,17 +47,30 @@ public:
 
 private:
     void printRegisterBody();
+    void printRegisterFieldType(const google::protobuf::FieldDescriptor *field, const PropertyMap &propertyMap);
+    void printRegistrationOnce(const PropertyMap &propertyMap, const char *registrationTemplate, const std::string &type);
     void printFieldsOrdering();
+    void printFieldDescriptors(const std::vector<int> &fieldOrder);
     void printConstructors();
     void printConstructor(int fieldCount);
+    void printConstructorContent(int fieldCount);
     void printInitializationList(int fieldCount);
     void printCopyFunctionality();
     void printMoveSemantic();
+    void printClearFunctionality();
+    void printSpaceUsed();
+    void printOneofs();
+    void printMergeFunctionality();
     void printComparisonOperators();
+    void printHashFunction();
     void printGetters();
     void printDestructor();
+    void printDirectSerializers();
+    void printValueType();
 
     void printClassDefinitionPrivate();
+
+    std::set<std::string> mRegisteredTypes;
 };
 
 }}
@@ -82,6 +82,9 @@ bool MultiFileGenerator::Generate(const FileDescriptor *file,
         if (GeneratorOptions::instance().hasQml()) {
             headerPrinter->Print(Templates::QmlProtobufIncludesTemplate);
         }
+        if (GeneratorOptions::instance().generateScalarViews()) {
+            headerPrinter->Print(Templates::ScalarViewsIncludesTemplate);
+        }
 
         std::set<std::string> existingIncludes;
         for (int i = 0; i < message->field_count(); i++) {
@@ -92,7 +95,8 @@ bool MultiFileGenerator::Generate(const FileDescriptor *file,
 
         for (int i = 0; i < message->field_count(); i++) {
             auto field = message->field(i);
-            if (common::isPureMessage(field)) {
+            //Value type elements are stored inline, so complete type is required
+            if (common::isPureMessage(field) || common::isValueList(field)) {
                 auto dependency = field->message_type();
                 deps.push_back(dependency);
             }
@@ -143,6 +147,9 @@ bool MultiFileGenerator::Generate(const FileDescriptor *file,
         if (GeneratorOptions::instance().hasQml()) {
             sourcePrinter->Print({{"include", "QQmlEngine"}}, Templates::ExternalIncludeTemplate);
         }
+        if (GeneratorOptions::instance().generateDirectSerializers()) {
+            sourcePrinter->Print(Templates::DirectSerializersIncludesTemplate);
+        }
 
         MessageDefinitionPrinter messageDef(message, sourcePrinter);
         messageDef.printClassDefinition();
@@ -166,6 +173,9 @@ bool MultiFileGenerator::Generate(const FileDescriptor *file,
         clientGen.printClientIncludes();
         clientGen.run();
 
+        ServerDeclarationPrinter serverGen(service, headerPrinter);
+        serverGen.run();
+
         printDisclaimer(sourcePrinter);
         std::string includeFileName = service->name();
         utils::tolower(includeFileName);
@@ -28,6 +28,9 @@
 #include <google/protobuf/io/printer.h>
 #include <google/protobuf/descriptor.h>
 
+#include "generatorcommon.h"
+#include "templates.h"
+
 using namespace ::QtProtobuf::generator;
 using namespace ::google::protobuf;
 
@@ -37,3 +40,40 @@ ServerDeclarationPrinter::ServerDeclarationPrinter(const ::google::protobuf::Ser
 {
     mName += "Server";
 }
+
+void ServerDeclarationPrinter::printServerClass()
+{
+    mPrinter->Print({{"classname", mName}, {"parent_class", "QtProtobuf::QAbstractGrpcService"}}, Templates::ClassDefinitionTemplate);
+}
+
+void ServerDeclarationPrinter::printConstructor()
+{
+    Indent();
+    mPrinter->Print({{"classname", mName}, {"parent_class", "QtProtobuf::QAbstractGrpcService"},
+                     {"service_name", mDescriptor->full_name()}}, Templates::ServerConstructorBeginTemplate);
+    Indent();
+    for (int i = 0; i < mDescriptor->method_count(); i++) {
+        const MethodDescriptor *method = mDescriptor->method(i);
+        //Only unary methods are served by QGrpcServer
+        if (method->client_streaming() || method->server_streaming()) {
+            continue;
+        }
+        mPrinter->Print(common::produceMethodMap(method, mName), Templates::ServerMethodRegistrationTemplate);
+    }
+    Outdent();
+    mPrinter->Print(Templates::ServerConstructorEndTemplate);
+    Outdent();
+}
+
+void ServerDeclarationPrinter::printServerMethodsDeclaration()
+{
+    Indent();
+    for (int i = 0; i < mDescriptor->method_count(); i++) {
+        const MethodDescriptor *method = mDescriptor->method(i);
+        if (method->client_streaming() || method->server_streaming()) {
+            continue;
+        }
+        mPrinter->Print(common::produceMethodMap(method, mName), Templates::ServerMethodDeclarationTemplate);
+    }
+    Outdent();
+}
@@ -40,7 +40,8 @@ namespace generator {
 /*!
  * \ingroup generator
  * \private
- * \brief The ServerDeclarationPrinter class
+ * \brief The ServerDeclarationPrinter class prints base class of service implementation, that is hosted by
+ *        QGrpcServer. Server class is printed to the same header as client class.
  */
 class ServerDeclarationPrinter : public ServiceDeclarationPrinterBase
 {
@@ -50,14 +51,19 @@ public:
     virtual ~ServerDeclarationPrinter() = default;
 
     void run() {
-        printIncludes();
         printNamespaces();
-        printClassName();
+        printServerClass();
         printPublicBlock();
-        printMethodsDeclaration(Templates::ServerMethodDeclarationTemplate);
+        printConstructor();
+        printServerMethodsDeclaration();
         encloseClass();
         encloseNamespaces();
     }
+
+private:
+    void printServerClass();
+    void printConstructor();
+    void printServerMethodsDeclaration();
 };
 
 } //namespace generator
@@ -90,9 +90,15 @@ bool SingleFileGenerator::GenerateMessages(const ::google::protobuf::FileDescrip
     if (GeneratorOptions::instance().hasQml()) {
         headerPrinter->Print(Templates::QmlProtobufIncludesTemplate);
     }
+    if (GeneratorOptions::instance().generateScalarViews()) {
+        headerPrinter->Print(Templates::ScalarViewsIncludesTemplate);
+    }
 
     printDisclaimer(sourcePrinter);
     sourcePrinter->Print({{"include", basename + Templates::ProtoFileSuffix}}, Templates::InternalIncludeTemplate);
+    if (GeneratorOptions::instance().generateDirectSerializers()) {
+        sourcePrinter->Print(Templates::DirectSerializersIncludesTemplate);
+    }
 
     externalIncludes.insert("QByteArray");
     externalIncludes.insert("QString");
@@ -104,6 +110,10 @@ bool SingleFileGenerator::GenerateMessages(const ::google::protobuf::FileDescrip
             if (field->type() == ::google::protobuf::FieldDescriptor::TYPE_MESSAGE
                     && !field->is_map() && !field->is_repeated()
                     && common::isQtType(field)) {
+                if (!common::nativeWellKnownType(field).empty()) {
+                    externalIncludes.insert("QtProtobufWellKnownTypes");
+                    continue;
+                }
                 externalIncludes.insert(field->message_type()->name());
                 hasQtTypes = true;
             }
@@ -212,6 +222,10 @@ bool SingleFileGenerator::GenerateServices(const ::google::protobuf::FileDescrip
     externalIncludes.insert("QAbstractGrpcClient");
     externalIncludes.insert("QGrpcAsyncReply");
     externalIncludes.insert("QGrpcStream");
+    externalIncludes.insert("QAbstractGrpcService");
+    if (GeneratorOptions::instance().hasQml()) {
+        externalIncludes.insert("QGrpcQmlReply");
+    }
 
     if (file->message_type_count() > 0) {
         internalIncludes.insert(basename + Templates::ProtoFileSuffix);
@@ -235,18 +249,12 @@ bool SingleFileGenerator::GenerateServices(const ::google::protobuf::FileDescrip
 
     for (int i = 0; i < file->service_count(); i++) {
         const ServiceDescriptor *service = file->service(i);
-        // Serverside descriptor is not in use
-        //        std::string baseFilename(service->name());
-        //        utils::tolower(baseFilename);
-
-        //        std::string fullFilename = baseFilename + "server.h";
-        //        ServerDeclarationprinter serverGen(service,
-        //                                  std::shared_ptr<io::ZeroCopyOutputStream>(generatorContext->Open(fullFilename)));
-        //        serverGen.run();
-
         ClientDeclarationPrinter clientDecl(service, headerPrinter);
         clientDecl.run();
 
+        ServerDeclarationPrinter serverDecl(service, headerPrinter);
+        serverDecl.run();
+
         ClientDefinitionPrinter clientDef(service, sourcePrinter);
         clientDef.run();
     }
@@ -33,14 +33,18 @@ const std::vector<std::string> Templates::ListOfQmlExeptions{"id", "property", "
 
 const char *Templates::DefaultProtobufIncludesTemplate = "#include <QMetaType>\n"
                                                          "#include <QList>\n"
+                                                         "#include <QVector>\n"
                                                          "#include <QProtobufObject>\n"
                                                          "#include <QProtobufLazyMessagePointer>\n"
+                                                         "#include <QProtobufFieldPresence>\n"
+                                                         "#include <QProtobufSpaceUsed>\n"
                                                          "#include <QSharedPointer>\n"
                                                          "\n"
                                                          "#include <memory>\n"
                                                          "#include <unordered_map>\n"
                                                          "\n";
 
+const char *Templates::ScalarViewsIncludesTemplate = "#include <QProtobufScalarListView>\n";
 const char *Templates::QmlProtobufIncludesTemplate = "#include <QtQml/QQmlListProperty>\n"
                                                      "#include <QQmlListPropertyConstructor>\n\n";
 
@@ -56,7 +60,8 @@ const char *Templates::ExternalIncludeTemplate = "#include <$include$>\n";
 const char *Templates::GlobalEnumIncludeTemplate = "#include <globalenums.h>\n";
 
 const char *Templates::UsingQtProtobufNamespaceTemplate = "\nusing namespace QtProtobuf;\n";
-const char *Templates::ManualRegistrationDeclaration = "static void registerTypes();\n";
+const char *Templates::ManualRegistrationDeclaration = "static void registerTypes();\n"
+                                                       "static void ensureTypesRegistered();\n";
 const char *Templates::ManualRegistrationComplexTypeDefinition = "void $type$::registerTypes()\n{\n"
                                                                  "    qRegisterMetaType<$type$>(\"$full_type$\");\n"
                                                                  "    qRegisterMetaType<$type$*>(\"$full_type$*\");\n" //Somehow for aliastypes qRegisterMetaType logic doesn't work for pointer type registration
@@ -64,10 +69,22 @@ const char *Templates::ManualRegistrationComplexTypeDefinition = "void $type$::r
         "";
 const char *Templates::ManualRegistrationGlobalEnumDefinition = "void $enum_gadget$::registerTypes()\n{\n"
                                                                 "";
+const char *Templates::LazyRegistrationComplexTypeDefinition = "\nvoid $classname$::ensureTypesRegistered()\n{\n"
+                                                               "    static QtProtobuf::LazyTypeRegistration registration;\n"
+                                                               "    QtProtobuf::registerTypeOnce(registration, qRegisterProtobufType<$classname$>);\n"
+                                                               "}\n";
+const char *Templates::LazyRegistrationGlobalEnumDefinition = "\nvoid $enum_gadget$::ensureTypesRegistered()\n{\n"
+                                                              "    static QtProtobuf::LazyTypeRegistration registration;\n"
+                                                              "    QtProtobuf::registerTypeOnce(registration, $enum_gadget$::registerTypes);\n"
+                                                              "}\n";
+const char *Templates::RegisterFieldTypeTemplate = "$scope_type$::ensureTypesRegistered();\n";
+const char *Templates::RegisterGlobalEnumFieldTypeTemplate = "$scope_namespaces$::ensureTypesRegistered();\n";
 const char *Templates::ComplexGlobalEnumFieldRegistrationTemplate = "qRegisterMetaType<$type$>(\"$full_type$\");\n";
 const char *Templates::ComplexListTypeUsingTemplate = "using $classname$Repeated = QList<QSharedPointer<$classname$>>;\n";
 const char *Templates::MapTypeUsingTemplate = "using $type$ = QMap<$key_type$, $value_type$>;\n";
 const char *Templates::MessageMapTypeUsingTemplate = "using $type$ = QMap<$key_type$, QSharedPointer<$value_type$>>;\n";
+const char *Templates::HashTypeUsingTemplate = "using $type$ = QHash<$key_type$, $value_type$>;\n";
+const char *Templates::MessageHashTypeUsingTemplate = "using $type$ = QHash<$key_type$, QSharedPointer<$value_type$>>;\n";
 const char *Templates::NestedMessageUsingTemplate = "using $type$ = $scope_namespaces$::$type$;\n"
                                                     "using $list_type$ = $scope_namespaces$::$list_type$;\n";
 
@@ -87,6 +104,7 @@ const char *Templates::ProtoClassDeclarationBeginTemplate = "\nclass $classname$
 
 const char *Templates::PropertyTemplate = "Q_PROPERTY($property_type$ $property_name$ READ $property_name$ WRITE set$property_name_cap$ NOTIFY $property_name$Changed SCRIPTABLE $scriptable$)\n";
 const char *Templates::RepeatedPropertyTemplate = "Q_PROPERTY($property_list_type$ $property_name$Data READ $property_name$ WRITE set$property_name_cap$ NOTIFY $property_name$Changed SCRIPTABLE $scriptable$)\n";
+const char *Templates::ScalarViewPropertyTemplate = "Q_PROPERTY(QtProtobuf::QProtobufScalarListView *$property_name$View READ $property_name$View CONSTANT)\n";
 const char *Templates::NonScriptablePropertyTemplate = "Q_PROPERTY($property_type$ $property_name$_p READ $property_name$ WRITE set$property_name_cap$ NOTIFY $property_name$Changed SCRIPTABLE false)\n";
 const char *Templates::NonScriptableAliasPropertyTemplate = "Q_PROPERTY($qml_alias_type$ $property_name$ READ $property_name$_p WRITE set$property_name_cap$_p NOTIFY $property_name$Changed SCRIPTABLE true)\n";
 const char *Templates::MessagePropertyTemplate = "Q_PROPERTY($property_type$ *$property_name$ READ $property_name$_p WRITE set$property_name_cap$_p NOTIFY $property_name$Changed)\n";
@@ -101,6 +119,10 @@ const char *Templates::ProtoConstructorEndTemplate = "QObject *parent = nullptr)
 const char *Templates::MemberTemplate = "$scope_type$ m_$property_name$;\n";
 const char *Templates::ListMemberTemplate = "$scope_list_type$ m_$property_name$;\n";
 const char *Templates::ComplexMemberTemplate = "QProtobufLazyMessagePointer<$scope_type$> m_$property_name$;\n";
+const char *Templates::ScalarViewMemberTemplate = "mutable QtProtobuf::QProtobufScalarListView *m_$property_name$View = nullptr;\n";
+const char *Templates::UnknownFieldsMemberTemplate = "QByteArray m_protobufUnknownFields;\n";
+const char *Templates::PresenceMemberTemplate = "QtProtobuf::QProtobufFieldPresence<$presence_words$> m_protobufPresence;\n";
+const char *Templates::DirtyFieldsMemberTemplate = "QtProtobuf::QProtobufDirtyFields<$presence_words$> m_protobufDirty;\n";
 const char *Templates::PublicBlockTemplate = "\npublic:\n";
 const char *Templates::PrivateBlockTemplate = "\nprivate:\n";
 const char *Templates::EnumDefinitionTemplate = "enum $type$ {\n";
@@ -117,47 +139,200 @@ const char *Templates::CopyConstructorDeclarationTemplate = "$classname$(const $
 const char *Templates::MoveConstructorDeclarationTemplate = "$classname$($classname$ &&other);\n";
 const char *Templates::CopyConstructorDefinitionTemplate = "$classname$::$classname$(const $classname$ &other) : QObject()";
 const char *Templates::MoveConstructorDefinitionTemplate = "$classname$::$classname$($classname$ &&other) : QObject()";
-const char *Templates::EmptyCopyConstructorDefinitionTemplate = "$classname$::$classname$(const $classname$ &) : QObject()";
-const char *Templates::EmptyMoveConstructorDefinitionTemplate = "$classname$::$classname$($classname$ &&) : QObject()";
 const char *Templates::DeletedCopyConstructorTemplate = "$classname$(const $classname$ &) = delete;\n";
 const char *Templates::DeletedMoveConstructorTemplate = "$classname$($classname$ &&) = delete;\n";
 const char *Templates::CopyFieldTemplate = "set$property_name_cap$(other.m_$property_name$);\n";
-const char *Templates::CopyComplexFieldTemplate = "if (m_$property_name$ != other.m_$property_name$) {\n"
-                                                  "    *m_$property_name$ = *other.m_$property_name$;\n"
-                                                  "}\n";
-const char *Templates::AssignComplexFieldTemplate = "if (m_$property_name$ != other.m_$property_name$) {\n"
-                                                    "    *m_$property_name$ = *other.m_$property_name$;\n"
+const char *Templates::CopyUnknownFieldsTemplate = "m_protobufUnknownFields = other.m_protobufUnknownFields;\n"
+                                                   "m_protobufDirty.touch();\n";
+const char *Templates::MoveUnknownFieldsTemplate = "m_protobufUnknownFields = std::move(other.m_protobufUnknownFields);\n"
+                                                   "m_protobufDirty.touch();\n";
+const char *Templates::CopyPresenceTemplate = "m_protobufPresence = other.m_protobufPresence;\n";
+const char *Templates::CleanDirtyFieldsTemplate = "m_protobufDirty = {};\n";
+const char *Templates::CopyComplexFieldTemplate = "m_$property_name$.copyMessage(other.m_$property_name$);\n";
+const char *Templates::CopyFieldInitializerTemplate = "\n    , m_$property_name$(other.m_$property_name$)";
+const char *Templates::CopyStateInitializerTemplate = "\n    , m_protobufUnknownFields(other.m_protobufUnknownFields)"
+                                                      "\n    , m_protobufPresence(other.m_protobufPresence)";
+const char *Templates::AssignComplexFieldTemplate = "if (m_$property_name$.copyLazyPayload(other.m_$property_name$)) {\n"
+                                                    "    m_protobufDirty.set($presence_index$);\n"
+                                                    "    $property_name$Changed();\n"
+                                                    "} else if (m_$property_name$ != other.m_$property_name$) {\n"
+                                                    "    *m_$property_name$ = other.m_$property_name$.constRef();\n"
+                                                    "    m_protobufDirty.set($presence_index$);\n"
                                                     "    $property_name$Changed();\n"
                                                     "}\n";
-const char *Templates::MoveMessageFieldTemplate = "if (m_$property_name$ != other.m_$property_name$) {\n"
+const char *Templates::MoveMessageFieldTemplate = "if (!m_$property_name$.copyLazyPayload(other.m_$property_name$)\n"
+                                                  "        && m_$property_name$ != other.m_$property_name$) {\n"
                                                   "    *m_$property_name$ = std::move(*other.m_$property_name$);\n"
                                                   "}\n";
-const char *Templates::MoveAssignMessageFieldTemplate = "if (m_$property_name$ != other.m_$property_name$) {\n"
+const char *Templates::MoveAssignMessageFieldTemplate = "if (m_$property_name$.copyLazyPayload(other.m_$property_name$)) {\n"
+                                                        "    m_protobufDirty.set($presence_index$);\n"
+                                                        "    $property_name$Changed();\n"
+                                                        "} else if (m_$property_name$ != other.m_$property_name$) {\n"
                                                         "    *m_$property_name$ = std::move(*other.m_$property_name$);\n"
+                                                        "    m_protobufDirty.set($presence_index$);\n"
                                                         "    $property_name$Changed();\n"
+                                                        "    other.m_protobufDirty.set($presence_index$);\n"
                                                         "    other.$property_name$Changed();\n"
                                                         "}\n";
+const char *Templates::ClearDeclarationTemplate = "void clear();\n";
+const char *Templates::SpaceUsedDeclarationTemplate = "size_t spaceUsed() const;\n";
+const char *Templates::OneofCaseEnumBeginTemplate = "enum class $oneof_name_cap$Case {\n"
+                                                 "    NotSet = 0,\n";
+const char *Templates::OneofCaseEnumFieldTemplate = "$property_name_cap$ = $number$,\n";
+const char *Templates::OneofCaseGetterTemplate = "$oneof_name_cap$Case $oneof_name$Case() const {\n"
+                                                 "    return m_$oneof_name$Case;\n"
+                                                 "}\n\n";
+const char *Templates::OneofClearTemplate = "void clear$oneof_name_cap$() {\n"
+                                            "    set$oneof_name_cap$Case($oneof_name_cap$Case::NotSet);\n"
+                                            "}\n\n";
+const char *Templates::OneofCaseSetterDeclarationTemplate = "void set$oneof_name_cap$Case($oneof_name_cap$Case value);\n";
+const char *Templates::OneofCaseMemberTemplate = "$oneof_name_cap$Case m_$oneof_name$Case = $oneof_name_cap$Case::NotSet;\n";
+const char *Templates::OneofCaseSetterDefinitionTemplate = "void $classname$::set$oneof_name_cap$Case($oneof_name_cap$Case value)\n{\n"
+                                                           "    const $oneof_name_cap$Case previous = m_$oneof_name$Case;\n"
+                                                           "    if (previous == value) {\n"
+                                                           "        return;\n"
+                                                           "    }\n"
+                                                           "    m_$oneof_name$Case = value;\n"
+                                                           "    switch (value) {\n";
+const char *Templates::OneofActivateFieldTemplate = "case $oneof_name_cap$Case::$property_name_cap$:\n"
+                                                    "    m_protobufPresence.set($presence_index$);\n"
+                                                    "    break;\n";
+const char *Templates::OneofCaseSetterMiddleTemplate = "default:\n"
+                                                       "    break;\n"
+                                                       "}\n"
+                                                       "//Previously active member is reset to default value\n"
+                                                       "switch (previous) {\n";
+const char *Templates::OneofResetFieldTemplate = "case $oneof_name_cap$Case::$property_name_cap$:\n"
+                                                 "    m_$property_name$ = {};\n"
+                                                 "    m_protobufPresence.reset($presence_index$);\n"
+                                                 "    m_protobufDirty.set($presence_index$);\n"
+                                                 "    if (!signalsBlocked()) {\n"
+                                                 "        $property_name$Changed();\n"
+                                                 "    }\n"
+                                                 "    break;\n";
+const char *Templates::OneofResetMessageFieldTemplate = "case $oneof_name_cap$Case::$property_name_cap$:\n"
+                                                        "    m_$property_name$.clearMessage();\n"
+                                                        "    m_protobufPresence.reset($presence_index$);\n"
+                                                        "    m_protobufDirty.set($presence_index$);\n"
+                                                        "    if (!signalsBlocked()) {\n"
+                                                        "        $property_name$Changed();\n"
+                                                        "    }\n"
+                                                        "    break;\n";
+const char *Templates::OneofCaseSetterEndTemplate = "default:\n"
+                                                    "    break;\n"
+                                                    "}\n";
+const char *Templates::OneofConstructorActivationTemplate = "if ($property_name$ != $scope_type$()) {\n"
+                                                            "    set$oneof_name_cap$Case($oneof_name_cap$Case::$property_name_cap$);\n"
+                                                            "}\n";
+const char *Templates::OneofCaseInitializerTemplate = "\n    , m_$oneof_name$Case(other.m_$oneof_name$Case)";
+const char *Templates::OneofCopyCaseTemplate = "set$oneof_name_cap$Case(other.m_$oneof_name$Case);\n";
+const char *Templates::OneofMoveCaseTemplate = "m_$oneof_name$Case = other.m_$oneof_name$Case;\n";
+const char *Templates::OneofClearCaseTemplate = "set$oneof_name_cap$Case($oneof_name_cap$Case::NotSet);\n";
+const char *Templates::OneofClearOtherCaseTemplate = "other.set$oneof_name_cap$Case($oneof_name_cap$Case::NotSet);\n";
+const char *Templates::OneofAssignFieldTemplate = "if (m_$property_name$ != other.m_$property_name$) {\n"
+                                                  "    m_$property_name$ = other.m_$property_name$;\n"
+                                                  "    m_protobufDirty.set($presence_index$);\n"
+                                                  "    if (!signalsBlocked()) {\n"
+                                                  "        $property_name$Changed();\n"
+                                                  "    }\n"
+                                                  "}\n";
+const char *Templates::DelegatingNonScriptableSetterTemplate = "void set$property_name_cap$_p(const $qml_alias_type$ &$property_name$) {\n"
+                                                          "    set$property_name_cap$($property_name$);\n"
+                                                          "}\n\n";
+const char *Templates::OneofMoveFieldTemplate = "m_$property_name$ = std::move(other.m_$property_name$);\n";
+const char *Templates::OneofMergeFieldTemplate = "if (fields.contains($number$) && other.m_$oneof_name$Case == $oneof_name_cap$Case::$property_name_cap$) {\n"
+                                                 "    set$property_name_cap$(other.$property_name$());\n"
+                                                 "}\n";
+const char *Templates::HasFieldTemplate = "bool has$property_name_cap$() const {\n"
+                                          "    return m_protobufPresence.test($presence_index$);\n"
+                                          "}\n\n";
+const char *Templates::ClearFieldDeclarationTemplate = "void clear$property_name_cap$();\n";
+const char *Templates::ClearOptionalFieldDefinitionTemplate = "void $classname$::clear$property_name_cap$()\n{\n"
+                                                              "    if (!m_protobufPresence.test($presence_index$)) {\n"
+                                                              "        return;\n"
+                                                              "    }\n"
+                                                              "    m_protobufPresence.reset($presence_index$);\n"
+                                                              "    m_protobufDirty.set($presence_index$);\n"
+                                                              "    if (m_$property_name$ != $scope_type$()) {\n"
+                                                              "        m_$property_name$ = {};\n"
+                                                              "        if (!signalsBlocked()) {\n"
+                                                              "            $property_name$Changed();\n"
+                                                              "        }\n"
+                                                              "    }\n"
+                                                              "}\n\n";
+const char *Templates::OptionalMergeFieldTemplate = "if (fields.contains($number$)) {\n"
+                                                    "    if (other.has$property_name_cap$()) {\n"
+                                                    "        set$property_name_cap$(other.$property_name$());\n"
+                                                    "    } else {\n"
+                                                    "        clear$property_name_cap$();\n"
+                                                    "    }\n"
+                                                    "}\n";
+const char *Templates::EqualOperatorPresenceTemplate = "has$property_name_cap$() == other.has$property_name_cap$()";
+const char *Templates::EqualOperatorOneofCaseTemplate = "m_$oneof_name$Case == other.m_$oneof_name$Case";
+const char *Templates::DeltaDeclarationTemplate = "QByteArray serializeDelta(QtProtobuf::QAbstractProtobufSerializer *serializer) const {\n"
+                                                  "    Q_ASSERT_X(serializer != nullptr, \"$classname$\", \"Serializer is null\");\n"
+                                                  "    return serializer->serializeDelta<$classname$>(this);\n"
+                                                  "}\n"
+                                                  "void mergeDelta(QtProtobuf::QAbstractProtobufSerializer *serializer, const QByteArray &data) {\n"
+                                                  "    Q_ASSERT_X(serializer != nullptr, \"$classname$\", \"Serializer is null\");\n"
+                                                  "    serializer->mergeDelta<$classname$>(this, data);\n"
+                                                  "}\n"
+                                                  "void markClean() {\n"
+                                                  "    m_protobufDirty = {};\n"
+                                                  "}\n"
+                                                  "void mergeFields(const $classname$ &other, const QtProtobuf::QProtobufFieldMask &fields);\n";
+const char *Templates::MergeFieldsDefinitionTemplate = "void $classname$::mergeFields(const $classname$ &other, const QtProtobuf::QProtobufFieldMask &fields)\n{\n";
+const char *Templates::EmptyMergeFieldsDefinitionTemplate = "void $classname$::mergeFields(const $classname$ &, const QtProtobuf::QProtobufFieldMask &)\n{\n"
+                                                            "}\n\n";
+const char *Templates::MergeFieldTemplate = "if (fields.contains($number$)) {\n"
+                                            "    set$property_name_cap$(other.$property_name$());\n"
+                                            "}\n";
+const char *Templates::CompactCopyFieldsTemplate = "QtProtobuf::copyMessageFields(this, &other, protobufMetaObject);\n";
+const char *Templates::CompactClearFieldsTemplate = "QtProtobuf::clearMessageFields(this, protobufMetaObject);\n";
+const char *Templates::CompactMergeFieldsTemplate = "QtProtobuf::mergeMessageFields(this, &other, protobufMetaObject, fields);\n";
+const char *Templates::ClearDefinitionTemplate = "void $classname$::clear()\n{\n";
+const char *Templates::ClearMessageFieldTemplate = "m_$property_name$.clearMessage();\n"
+                                                   "m_protobufDirty.set($presence_index$);\n";
+const char *Templates::ClearComplexFieldTemplate = "if (!m_$property_name$.isEmpty()) {\n"
+                                                   "    QtProtobufPrivate::clearKeepingCapacity(m_$property_name$);\n"
+                                                   "    m_protobufDirty.set($presence_index$);\n"
+                                                   "    $property_name$Changed();\n"
+                                                   "}\n";
+const char *Templates::ClearFieldTemplate = "set$property_name_cap$({});\n";
+const char *Templates::EnumClearFieldTemplate = "m_$property_name$ = {};\n"
+                                                "m_protobufDirty.set($presence_index$);\n";
+const char *Templates::ClearUnknownFieldsTemplate = "m_protobufUnknownFields.clear();\n"
+                                                    "m_protobufDirty.touch();\n";
+const char *Templates::ClearPresenceTemplate = "m_protobufPresence = {$presence_mask$};\n";
+const char *Templates::SpaceUsedDefinitionTemplate = "size_t $classname$::spaceUsed() const\n{\n"
+                                                     "    size_t size = sizeof($classname$) + QtProtobuf::QObjectSpaceUsed;\n";
+const char *Templates::SpaceUsedFieldTemplate = "size += QtProtobuf::spaceUsedOf(m_$property_name$);\n";
+const char *Templates::SpaceUsedUnknownFieldsTemplate = "size += QtProtobuf::spaceUsedOf(m_protobufUnknownFields);\n"
+                                                        "return size;\n";
 const char *Templates::MoveComplexFieldTemplate = "if (m_$property_name$ != other.m_$property_name$) {\n"
                                                   "    m_$property_name$ = std::move(other.m_$property_name$);\n"
+                                                  "    m_protobufDirty.set($presence_index$);\n"
                                                   "    $property_name$Changed();\n"
+                                                  "    other.m_protobufDirty.set($presence_index$);\n"
                                                   "    other.$property_name$Changed();\n"
                                                   "}";
 
 const char *Templates::MoveComplexFieldConstructorTemplate = "m_$property_name$ = std::move(other.m_$property_name$);\n"
+                                                             "other.m_protobufDirty.set($presence_index$);\n"
                                                              "other.$property_name$Changed();\n";
 
 const char *Templates::MoveFieldTemplate = "set$property_name_cap$(std::exchange(other.m_$property_name$, 0));\n"
+                                           "other.m_protobufDirty.set($presence_index$);\n"
                                            "other.$property_name$Changed();\n";
-const char *Templates::EnumMoveFieldTemplate = "m_$property_name$ = other.m_$property_name$;\n";
+const char *Templates::EnumMoveFieldTemplate = "m_$property_name$ = other.m_$property_name$;\n"
+                                               "m_protobufDirty.set($presence_index$);\n";
 
 const char *Templates::AssignmentOperatorDeclarationTemplate = "$classname$ &operator =(const $classname$ &other);\n";
 const char *Templates::AssignmentOperatorDefinitionTemplate = "$classname$ &$classname$::operator =(const $classname$ &other)\n{\n";
-const char *Templates::EmptyAssignmentOperatorDefinitionTemplate = "$classname$ &$classname$::operator =(const $classname$ &)\n{\n";
 const char *Templates::AssignmentOperatorReturnTemplate = "return *this;\n";
 
 const char *Templates::MoveAssignmentOperatorDeclarationTemplate = "$classname$ &operator =($classname$ &&other);\n";
 const char *Templates::MoveAssignmentOperatorDefinitionTemplate = "$classname$ &$classname$::operator =($classname$ &&other)\n{\n";
-const char *Templates::EmptyMoveAssignmentOperatorDefinitionTemplate = "$classname$ &$classname$::operator =($classname$ &&)\n{\n";
 
 const char *Templates::EqualOperatorDeclarationTemplate = "bool operator ==(const $classname$ &other) const;\n";
 const char *Templates::EqualOperatorDefinitionTemplate = "bool $classname$::operator ==(const $classname$ &other) const\n{\n"
@@ -166,8 +341,8 @@ const char *Templates::EmptyEqualOperatorDefinitionTemplate = "bool $classname$:
                                                               "    return true;\n"
                                                               "}\n\n";
 const char *Templates::EqualOperatorPropertyTemplate = "m_$property_name$ == other.m_$property_name$";
-const char *Templates::EqualOperatorMessagePropertyTemplate = "(m_$property_name$ == other.m_$property_name$\n"
-                                                              "    || *m_$property_name$ == *other.m_$property_name$)\n";
+const char *Templates::EqualOperatorMessagePropertyTemplate = "m_$property_name$ == other.m_$property_name$";
+const char *Templates::EqualOperatorSizePropertyTemplate = "m_$property_name$.size() == other.m_$property_name$.size()";
 const char *Templates::EqualOperatorRepeatedPropertyTemplate = "QtProtobuf::repeatedValueCompare(m_$property_name$, other.m_$property_name$)";
 
 const char *Templates::NotEqualOperatorDeclarationTemplate = "bool operator !=(const $classname$ &other) const;\n";
@@ -175,6 +350,18 @@ const char *Templates::NotEqualOperatorDefinitionTemplate = "bool $classname$::o
                                                             "    return !this->operator ==(other);\n"
                                                             "}\n\n";
 
+const char *Templates::HashFunctionDeclarationTemplate = "uint qHash(const $classname$ &value, uint seed = 0);\n";
+const char *Templates::HashFunctionDefinitionTemplate = "uint qHash(const $classname$ &value, uint seed)\n{\n"
+                                                        "    return QtProtobuf::qHashMessage(&value, $classname$::protobufMetaObject, seed);\n"
+                                                        "}\n\n";
+const char *Templates::DeclareStdHashTemplate = "namespace std {\n"
+                                                "template<> struct hash<$full_type$> {\n"
+                                                "    std::size_t operator()(const $full_type$ &value) const {\n"
+                                                "        return qHash(value);\n"
+                                                "    }\n"
+                                                "};\n"
+                                                "}\n";
+
 const char *Templates::GetterPrivateMessageDeclarationTemplate = "$getter_type$ *$property_name$_p() const;\n";
 const char *Templates::GetterPrivateMessageDefinitionTemplate = "$getter_type$ *$classname$::$property_name$_p() const\n{\n"
                                                                 "    return m_$property_name$.get();\n"
@@ -182,13 +369,24 @@ const char *Templates::GetterPrivateMessageDefinitionTemplate = "$getter_type$ *
 
 const char *Templates::GetterMessageDeclarationTemplate = "const $getter_type$ &$property_name$() const;\n";
 const char *Templates::GetterMessageDefinitionTemplate = "const $getter_type$ &$classname$::$property_name$() const\n{\n"
-                                                         "    return *m_$property_name$;\n"
+                                                         "    return m_$property_name$.constRef();\n"
                                                          "}\n\n";
 
 const char *Templates::GetterTemplate = "$getter_type$ $property_name$() const {\n"
                                         "    return m_$property_name$;\n"
                                         "}\n\n";
 
+//View is created at first access, so messages that are not used by QML don't hold views
+const char *Templates::ScalarViewGetterTemplate = "QtProtobuf::QProtobufScalarListView *$property_name$View() const {\n"
+                                                  "    if (m_$property_name$View == nullptr) {\n"
+                                                  "        auto self = const_cast<$classname$ *>(this);\n"
+                                                  "        m_$property_name$View = new QtProtobuf::QProtobufScalarListView(&m_$property_name$, self);\n"
+                                                  "        QObject::connect(self, &$classname$::$property_name$Changed,\n"
+                                                  "                         m_$property_name$View, &QtProtobuf::QProtobufScalarListView::changed);\n"
+                                                  "    }\n"
+                                                  "    return m_$property_name$View;\n"
+                                                  "}\n\n";
+
 const char *Templates::NonScriptableGetterTemplate = "$qml_alias_type$ $property_name$_p() const {\n"
                                                      "    return m_$property_name$;\n"
                                                      "}\n\n";
@@ -204,47 +402,195 @@ const char *Templates::GetterQmlListDefinitionTemplate = "QQmlListProperty<$full
 
 const char *Templates::SetterPrivateTemplateDeclarationMessageType = "void set$property_name_cap$_p($setter_type$ *$property_name$);\n";
 const char *Templates::SetterPrivateTemplateDefinitionMessageType = "void $classname$::set$property_name_cap$_p($setter_type$ *$property_name$)\n{\n"
+                                                                    "$presence_update$"
                                                                     "    if (m_$property_name$.get() != $property_name$) {\n"
                                                                     "        m_$property_name$.reset($property_name$);\n"
-                                                                    "        $property_name$Changed();\n"
+                                                                    "        m_protobufDirty.set($presence_index$);\n"
+                                                                    "        if (!signalsBlocked()) {\n"
+                                                                    "            $property_name$Changed();\n"
+                                                                    "        }\n"
                                                                     "    }\n"
                                                                     "}\n\n";
 
 const char *Templates::SetterTemplateDeclarationMessageType = "void set$property_name_cap$(const $setter_type$ &$property_name$);\n";
 const char *Templates::SetterTemplateDefinitionMessageType = "void $classname$::set$property_name_cap$(const $setter_type$ &$property_name$)\n{\n"
-                                                             "    if (*m_$property_name$ != $property_name$) {\n"
+                                                             "$presence_update$"
+                                                             "    if (m_$property_name$.constRef() != $property_name$) {\n"
                                                              "        *m_$property_name$ = $property_name$;\n"
-                                                             "        $property_name$Changed();\n"
+                                                             "        m_protobufDirty.set($presence_index$);\n"
+                                                             "        if (!signalsBlocked()) {\n"
+                                                             "            $property_name$Changed();\n"
+                                                             "        }\n"
                                                              "    }\n"
                                                              "}\n\n";
 
 const char *Templates::SetterTemplateDeclarationComplexType = "void set$property_name_cap$(const $setter_type$ &$property_name$);\n";
 const char *Templates::SetterTemplateDefinitionComplexType = "void $classname$::set$property_name_cap$(const $setter_type$ &$property_name$)\n{\n"
+                                                             "$presence_update$"
                                                              "    if (m_$property_name$ != $property_name$) {\n"
                                                              "        m_$property_name$ = $property_name$;\n"
-                                                             "        $property_name$Changed();\n"
+                                                             "        m_protobufPresence.set($presence_index$);\n"
+                                                             "        m_protobufDirty.set($presence_index$);\n"
+                                                             "        if (!signalsBlocked()) {\n"
+                                                             "            $property_name$Changed();\n"
+                                                             "        }\n"
                                                              "    }\n"
                                                              "}\n\n";
 
 const char *Templates::SetterTemplate = "void set$property_name_cap$(const $setter_type$ &$property_name$) {\n"
                                         "    if (m_$property_name$ != $property_name$) {\n"
                                         "        m_$property_name$ = $property_name$;\n"
-                                        "        $property_name$Changed();\n"
+                                        "        m_protobufPresence.set($presence_index$);\n"
+                                        "        m_protobufDirty.set($presence_index$);\n"
+                                        "        if (!signalsBlocked()) {\n"
+                                        "            $property_name$Changed();\n"
+                                        "        }\n"
                                         "    }\n"
                                         "}\n\n";
 const char *Templates::NonScriptableSetterTemplate = "void set$property_name_cap$_p(const $qml_alias_type$ &$property_name$) {\n"
                                                      "    if (m_$property_name$ != $property_name$) {\n"
                                                      "        m_$property_name$ = $property_name$;\n"
-                                                     "        $property_name$Changed();\n"
+                                                     "        m_protobufPresence.set($presence_index$);\n"
+                                                     "        m_protobufDirty.set($presence_index$);\n"
+                                                     "        if (!signalsBlocked()) {\n"
+                                                     "            $property_name$Changed();\n"
+                                                     "        }\n"
                                                      "    }\n"
                                                      "}\n\n";
 
 const char *Templates::SignalsBlockTemplate = "\nsignals:\n";
 const char *Templates::SignalTemplate = "void $property_name$Changed();\n";
 
-const char *Templates::FieldsOrderingContainerTemplate = "const QtProtobuf::QProtobufMetaObject $type$::protobufMetaObject = QtProtobuf::QProtobufMetaObject($type$::staticMetaObject, $type$::propertyOrdering);\n"
+const char *Templates::FieldsOrderingContainerTemplate = "const QtProtobuf::QProtobufMetaObject $type$::protobufMetaObject = QtProtobuf::QProtobufMetaObject($type$::staticMetaObject, $type$::propertyOrdering,\n"
+                                                         "    nullptr, nullptr,\n"
+                                                         "    [](QObject *object) { return &static_cast<$type$ *>(object)->m_protobufUnknownFields; },\n"
+                                                         "    [](const QObject *object) { return static_cast<const $type$ *>(object)->m_protobufPresence.words(); },\n"
+                                                         "    [](const QObject *object) { return static_cast<const $type$ *>(object)->m_protobufDirty.words(); },\n"
+                                                         "    $field_descriptors$, 0, nullptr,\n"
+                                                         "    [](const QObject *object) { return static_cast<const $type$ *>(object)->m_protobufDirty.revision(); });\n"
                                                          "const QtProtobuf::QProtobufPropertyOrdering $type$::propertyOrdering = {";
-const char *Templates::FieldOrderTemplate = "{$field_number$, {$property_number$, \"$json_name$\"}}";
+const char *Templates::DirectFieldsOrderingContainerTemplate = "const QtProtobuf::QProtobufMetaObject $type$::protobufMetaObject = QtProtobuf::QProtobufMetaObject($type$::staticMetaObject, $type$::propertyOrdering,\n"
+                                                               "    [](const QObject *object, QByteArray &buffer) { static_cast<const $type$ *>(object)->serializeTo(buffer); },\n"
+                                                               "    [](QObject *object, const QByteArray &data) { static_cast<$type$ *>(object)->parseFrom(data); },\n"
+                                                               "    [](QObject *object) { return &static_cast<$type$ *>(object)->m_protobufUnknownFields; },\n"
+                                                               "    [](const QObject *object) { return static_cast<const $type$ *>(object)->m_protobufPresence.words(); },\n"
+                                                               "    [](const QObject *object) { return static_cast<const $type$ *>(object)->m_protobufDirty.words(); },\n"
+                                                               "    $field_descriptors$$schema_fingerprint$,\n"
+                                                               "    [](const QObject *object) { return static_cast<const $type$ *>(object)->m_protobufDirty.revision(); });\n"
+                                                               "const QtProtobuf::QProtobufPropertyOrdering $type$::propertyOrdering = {";
+const char *Templates::FieldDescriptorsContainerTemplate = "const QtProtobuf::QProtobufFieldDescriptor $type$::protobufFieldDescriptors[] = {";
+const char *Templates::FieldDescriptorTemplate = "{$field_number$, $property_number$, QtProtobuf::$wire_type$, QtProtobuf::FieldKind::$field_kind$, $repeated$, $explicit_presence$, "
+                                                 "\"$json_name$\", \"$proto_name$\", &QtProtobuf::metaTypeIdOf<$meta_type$>, $nested_type$, $intern_strings$}";
+const char *Templates::FieldOrderTemplate = "{$field_number$, {$property_number$, \"$json_name$\", $field_number$, QtProtobuf::$wire_type$, nullptr, \"$proto_name$\"}}";
+const char *Templates::MessageFieldOrderTemplate = "{$field_number$, {$property_number$, \"$json_name$\", $field_number$, QtProtobuf::$wire_type$,\n"
+                                                   "    [](QObject *object, const QByteArray &payload) {\n"
+                                                   "        auto message = static_cast<$type$ *>(object);\n"
+                                                   "        message->m_$property_name$.setLazyPayload(payload);\n"
+                                                   "        message->m_protobufDirty.set($presence_index$);\n"
+                                                   "        if (!message->signalsBlocked()) {\n"
+                                                   "            message->$property_name$Changed();\n"
+                                                   "        }\n"
+                                                   "    }, \"$proto_name$\"}}";
+
+const char *Templates::DirectSerializersIncludesTemplate = "#include <QProtobufWireFormat>\n"
+                                                           "#include <QProtobufSelfcheckIterator>\n";
+const char *Templates::DirectSerializersDeclarationTemplate = "void serializeTo(QByteArray &buffer) const;\n"
+                                                              "void parseFrom(const QByteArray &data);\n";
+const char *Templates::SerializeToDefinitionTemplate = "void $classname$::serializeTo(QByteArray &buffer) const\n{\n";
+const char *Templates::EmptySerializeToDefinitionTemplate = "void $classname$::serializeTo(QByteArray &/*buffer*/) const\n{\n";
+const char *Templates::SerializeFieldTemplate = "QtProtobuf::QProtobufWireFormat::writeField(buffer, $number$, m_$property_name$);\n";
+const char *Templates::SerializeEnumFieldTemplate = "QtProtobuf::QProtobufWireFormat::writeField(buffer, $number$, QtProtobuf::int64(static_cast<int64_t>(m_$property_name$)));\n";
+const char *Templates::ParseFromDefinitionBeginTemplate = "void $classname$::parseFrom(const QByteArray &data)\n{\n"
+                                                          "    for (QtProtobuf::QProtobufSelfcheckIterator it(data); it != data.end()\n"
+                                                          "         && QtProtobufPrivate::deserializationError() == QtProtobuf::NoDeserializationError;) {\n"
+                                                          "        int fieldNumber = 0;\n"
+                                                          "        QtProtobuf::WireTypes wireType = QtProtobuf::UnknownWireType;\n"
+                                                          "        QtProtobuf::QProtobufWireFormat::readFieldHeader(it, fieldNumber, wireType);\n"
+                                                          "        switch (fieldNumber) {\n";
+const char *Templates::ParseFieldTemplate = "case $number$: {\n"
+                                            "    auto value = m_$property_name$;\n"
+                                            "    QtProtobuf::QProtobufWireFormat::readField(it, value);\n"
+                                            "    set$property_name_cap$(value);\n"
+                                            "}\n"
+                                            "    break;\n";
+const char *Templates::ParseRepeatedFieldTemplate = "case $number$:\n"
+                                                    "    QtProtobuf::QProtobufWireFormat::readRepeatedField(it, wireType, m_$property_name$);\n"
+                                                    "    m_protobufPresence.set($presence_index$);\n"
+                                                    "    m_protobufDirty.set($presence_index$);\n"
+                                                    "    if (!signalsBlocked()) {\n"
+                                                    "        $property_name$Changed();\n"
+                                                    "    }\n"
+                                                    "    break;\n";
+const char *Templates::ParseEnumFieldTemplate = "case $number$: {\n"
+                                                "    QtProtobuf::int64 value;\n"
+                                                "    QtProtobuf::QProtobufWireFormat::readField(it, value);\n"
+                                                "    set$property_name_cap$(static_cast<$scope_type$>(value._t));\n"
+                                                "}\n"
+                                                "    break;\n";
+const char *Templates::ParseFromDefinitionEndTemplate = "        default:\n"
+                                                        "            QtProtobuf::QProtobufWireFormat::skipField(it, wireType);\n"
+                                                        "            break;\n"
+                                                        "        }\n"
+                                                        "    }\n"
+                                                        "}\n\n";
+const char *Templates::ParseInOrderDeclarationTemplate = "void parseInOrder(const QByteArray &data);\n";
+const char *Templates::ParseInOrderDefinitionBeginTemplate = "void $classname$::parseInOrder(const QByteArray &data)\n{\n"
+                                                             "    QtProtobuf::QProtobufSelfcheckIterator it(data);\n";
+const char *Templates::OrderedParseFieldTemplate = "if (QtProtobuf::QProtobufWireFormat::takeFieldHeader(it, $number$, QtProtobuf::$wire_type$)) {\n"
+                                                   "    auto value = m_$property_name$;\n"
+                                                   "    QtProtobuf::QProtobufWireFormat::readField(it, value);\n"
+                                                   "    set$property_name_cap$(value);\n"
+                                                   "}\n";
+const char *Templates::OrderedParseRepeatedFieldTemplate = "while (QtProtobuf::QProtobufWireFormat::takeFieldHeader(it, $number$, QtProtobuf::LengthDelimited)) {\n"
+                                                           "    QtProtobuf::QProtobufWireFormat::readRepeatedField(it, QtProtobuf::LengthDelimited, m_$property_name$);\n"
+                                                           "    m_protobufPresence.set($presence_index$);\n"
+                                                           "    m_protobufDirty.set($presence_index$);\n"
+                                                           "    if (!signalsBlocked()) {\n"
+                                                           "        $property_name$Changed();\n"
+                                                           "    }\n"
+                                                           "}\n";
+const char *Templates::OrderedParseEnumFieldTemplate = "if (QtProtobuf::QProtobufWireFormat::takeFieldHeader(it, $number$, QtProtobuf::Varint)) {\n"
+                                                       "    QtProtobuf::int64 value;\n"
+                                                       "    QtProtobuf::QProtobufWireFormat::readField(it, value);\n"
+                                                       "    set$property_name_cap$(static_cast<$scope_type$>(value._t));\n"
+                                                       "}\n";
+const char *Templates::ParseInOrderDefinitionEndTemplate = "    //Fields that don't follow the expected layout are handled by generic parser\n"
+                                                           "    if (it.size() > 0 && QtProtobufPrivate::deserializationError() == QtProtobuf::NoDeserializationError) {\n"
+                                                           "        parseFrom(QByteArray::fromRawData(it.data(), it.size()));\n"
+                                                           "    }\n"
+                                                           "}\n\n";
+
+const char *Templates::ValueTypeForwardDeclarationTemplate = "class $classname$Value;\n"
+                                                             "using $classname$ValueRepeated = QVector<$classname$Value>;\n";
+const char *Templates::ValueTypeDeclarationBeginTemplate = "\nclass $classname$Value\n"
+                                                           "{\n"
+                                                           "    Q_GADGET\n";
+const char *Templates::ValueTypePropertyTemplate = "Q_PROPERTY($full_type$ $property_name$ MEMBER $property_name$)\n";
+const char *Templates::ValueTypePublicDeclarationTemplate = "using Message = $classname$;\n\n"
+                                                            "$classname$Value() = default;\n"
+                                                            "$classname$Value(const $classname$ &message);\n"
+                                                            "void copyTo($classname$ &message) const;\n\n"
+                                                            "bool operator ==(const $classname$Value &other) const;\n"
+                                                            "bool operator !=(const $classname$Value &other) const;\n\n";
+const char *Templates::ValueTypeMemberTemplate = "$full_type$ $property_name$ = {};\n";
+const char *Templates::ValueTypeListUsingTemplate = "using $classname$ValueRepeated = QVector<$classname$Value>;\n";
+const char *Templates::DeclareValueTypeTemplate = "Q_DECLARE_TYPEINFO($full_type$Value, Q_MOVABLE_TYPE);\n"
+                                                  "Q_DECLARE_METATYPE($full_type$Value)\n"
+                                                  "Q_DECLARE_METATYPE($full_type$ValueRepeated)\n";
+const char *Templates::ValueTypeConstructorDefinitionTemplate = "$classname$Value::$classname$Value(const $classname$ &message)";
+const char *Templates::ValueTypeFirstInitializerTemplate = " : $property_name$(message.$property_name$())";
+const char *Templates::ValueTypeInitializerTemplate = "\n    , $property_name$(message.$property_name$())";
+const char *Templates::ValueTypeCopyToDefinitionTemplate = "void $classname$Value::copyTo($classname$ &message) const\n{\n";
+const char *Templates::ValueTypeCopyFieldTemplate = "message.set$property_name_cap$($property_name$);\n";
+const char *Templates::ValueTypeEqualOperatorDefinitionTemplate = "bool $classname$Value::operator ==(const $classname$Value &other) const\n{\n"
+                                                                  "    return ";
+const char *Templates::ValueTypeEqualOperatorPropertyTemplate = "$property_name$ == other.$property_name$";
+const char *Templates::ValueTypeNotEqualOperatorDefinitionTemplate = "bool $classname$Value::operator !=(const $classname$Value &other) const\n{\n"
+                                                                     "    return !this->operator ==(other);\n"
+                                                                     "}\n\n";
+const char *Templates::RegisterValueTypeTemplate = "qRegisterMetaType<$type$Value>(\"$full_type$Value\");\n"
+                                                   "qRegisterMetaType<$type$ValueRepeated>(\"$full_type$ValueRepeated\");\n"
+                                                   "qRegisterProtobufValueType<$type$Value>();\n";
 
 const char *Templates::EnumTemplate = "$type$";
 
@@ -255,6 +601,7 @@ const char *Templates::PropertyInitializerTemplate = "\n    , m_$property_name$(
 const char *Templates::PropertyDefaultInitializerTemplate = "\n    , m_$property_name$($initializer$)";
 const char *Templates::MessagePropertyInitializerTemplate = "\n    , m_$property_name$(new $scope_type$($property_name$))";
 const char *Templates::MessagePropertyDefaultInitializerTemplate = "\n    , m_$property_name$(nullptr)";
+const char *Templates::PresenceInitializerTemplate = "\n    , m_protobufPresence({$presence_mask$})";
 const char *Templates::ConstructorContentTemplate = "\n{\n}\n";
 
 const char *Templates::DeclareMetaTypeTemplate = "Q_DECLARE_METATYPE($full_type$)\n";
@@ -269,6 +616,10 @@ const char *Templates::DeclareMetaTypeMapTemplate = "#ifndef Q_PROTOBUF_MAP_$key
                                                     "#define Q_PROTOBUF_MAP_$key_type_underscore$_$value_type_underscore$\n"
                                                     "Q_DECLARE_METATYPE($full_type$)\n"
                                                     "#endif\n";
+const char *Templates::DeclareMetaTypeHashTemplate = "#ifndef Q_PROTOBUF_HASH_$key_type_underscore$_$value_type_underscore$\n"
+                                                     "#define Q_PROTOBUF_HASH_$key_type_underscore$_$value_type_underscore$\n"
+                                                     "Q_DECLARE_METATYPE($full_type$)\n"
+                                                     "#endif\n";
 
 
 const char *Templates::RegisterLocalEnumTemplate = "qRegisterProtobufEnumType<$scope_type$>();\n"
@@ -278,6 +629,9 @@ const char *Templates::RegisterLocalEnumTemplate = "qRegisterProtobufEnumType<$s
 const char *Templates::RegisterMapTemplate = "qRegisterMetaType<$scope_type$>(\"$full_type$\");\n"
                                              "qRegisterMetaType<$scope_type$>(\"$full_list_type$\");\n"
                                              "qRegisterProtobufMapType<$key_type$, $value_type$>();\n";
+const char *Templates::RegisterHashTemplate = "qRegisterMetaType<$scope_type$>(\"$full_type$\");\n"
+                                              "qRegisterMetaType<$scope_type$>(\"$full_list_type$\");\n"
+                                              "qRegisterProtobufHashType<$key_type$, $value_type$>();\n";
 
 const char *Templates::RegisterMetaTypeTemplateNoNamespace = "qRegisterMetaType<$namespaces$::$type$>(\"$type$\");\n";
 const char *Templates::RegisterMetaTypeTemplate = "qRegisterMetaType<$namespaces$::$type$>(\"$namespaces$::$type$\");\n";
@@ -293,10 +647,18 @@ const char *Templates::QObjectMacro = "Q_OBJECT";
 const char *Templates::ClientMethodDeclarationSyncTemplate = "QtProtobuf::QGrpcStatus $method_name$(const $param_type$ &$param_name$, const QPointer<$return_type$> &$return_name$);\n";
 const char *Templates::ClientMethodDeclarationAsyncTemplate = "QtProtobuf::QGrpcAsyncReplyShared $method_name$(const $param_type$ &$param_name$);\n";
 const char *Templates::ClientMethodDeclarationAsync2Template = "Q_INVOKABLE void $method_name$(const $param_type$ &$param_name$, const QObject *context, const std::function<void(QtProtobuf::QGrpcAsyncReplyShared)> &callback);\n";
+const char *Templates::ClientMethodDeclarationAsync3Template = "void $method_name$(const $param_type$ &$param_name$, const std::function<void(const QtProtobuf::QGrpcStatus &, $return_type$ &&)> &callback);\n";
+const char *Templates::ClientMethodDeclarationAsync4Template = "QtProtobuf::QGrpcAsyncReplyShared $method_name$(const $param_type$ &$param_name$, const QtProtobuf::QGrpcCallOptions &options);\n";
+const char *Templates::ClientMethodDeclarationAwaitableTemplate = "QtProtobuf::QGrpcAwaitableReply<$return_type$> $method_name$Awaitable(const $param_type$ &$param_name$);\n";
 const char *Templates::ClientMethodDeclarationQmlTemplate = "Q_INVOKABLE void $method_name$($param_type$ *$param_name$, const QJSValue &callback, const QJSValue &errorCallback);\n";
 const char *Templates::ClientMethodDeclarationQml2Template = "Q_INVOKABLE void $method_name$($param_type$ *$param_name$, $return_type$ *$return_name$, const QJSValue &errorCallback);\n";
+const char *Templates::ClientMethodDeclarationQmlReplyTemplate = "Q_INVOKABLE QtProtobuf::QGrpcQmlReply *$method_name$Reply($param_type$ *$param_name$);\n";
 
-const char *Templates::ServerMethodDeclarationTemplate = "Q_INVOKABLE virtual $return_type$ $method_name$(const $param_type$ &$param_name$) = 0;\n";
+const char *Templates::ServerMethodDeclarationTemplate = "virtual QtProtobuf::QGrpcStatus $method_name$(const $param_type$ &$param_name$, $return_type$ &$return_name$) = 0;\n";
+const char *Templates::ServerConstructorBeginTemplate = "$classname$() : $parent_class$(\"$service_name$\")\n"
+                                                        "{\n";
+const char *Templates::ServerMethodRegistrationTemplate = "registerMethod(\"$method_name$\", &$classname$::$method_name$);\n";
+const char *Templates::ServerConstructorEndTemplate = "}\n";
 
 
 const char *Templates::ClientConstructorDefinitionTemplate = "\n$classname$::$classname$(QObject *parent) : $parent_class$(\"$service_name$\", parent)\n"
@@ -317,6 +679,18 @@ const char *Templates::ClientMethodDefinitionAsync2Template = "\nvoid $classname
                                                               "        callback(reply);\n"
                                                               "    });\n"
                                                               "}\n";
+const char *Templates::ClientMethodDefinitionAsync3Template = "\nvoid $classname$::$method_name$(const $param_type$ &$param_name$, const std::function<void(const QtProtobuf::QGrpcStatus &, $return_type$ &&)> &callback)\n"
+                                                              "{\n"
+                                                              "    call(\"$method_name$\", $param_name$, callback);\n"
+                                                              "}\n";
+const char *Templates::ClientMethodDefinitionAsync4Template = "\nQtProtobuf::QGrpcAsyncReplyShared $classname$::$method_name$(const $param_type$ &$param_name$, const QtProtobuf::QGrpcCallOptions &options)\n"
+                                                              "{\n"
+                                                              "    return call(\"$method_name$\", $param_name$, options);\n"
+                                                              "}\n";
+const char *Templates::ClientMethodDefinitionAwaitableTemplate = "\nQtProtobuf::QGrpcAwaitableReply<$return_type$> $classname$::$method_name$Awaitable(const $param_type$ &$param_name$)\n"
+                                                                 "{\n"
+                                                                 "    return QtProtobuf::QGrpcAwaitableReply<$return_type$>(call(\"$method_name$\", $param_name$));\n"
+                                                                 "}\n";
 
 const char *Templates::ClientMethodDefinitionQmlTemplate = "\nvoid $classname$::$method_name$($param_type$ *$param_name$, const QJSValue &callback, const QJSValue &errorCallback)\n"
                                                            "{\n"
@@ -369,10 +743,25 @@ const char *Templates::ClientMethodDefinitionQml2Template = "\nvoid $classname$:
                                                             "        QJSValue(errorCallback).call(QJSValueList{jsEngine->toScriptValue(status)});\n"
                                                             "    });\n"
                                                             "}\n";
+const char *Templates::ClientMethodDefinitionQmlReplyTemplate = "\nQtProtobuf::QGrpcQmlReply *$classname$::$method_name$Reply($param_type$ *$param_name$)\n"
+                                                                "{\n"
+                                                                "    if ($param_name$ == nullptr) {\n"
+                                                                "        qProtoWarning() << \"Invalid argument provided for method $classname$::$method_name$Reply, argument of type '$param_type$ *' expected\";\n"
+                                                                "        return nullptr;\n"
+                                                                "    }\n\n"
+                                                                "    QtProtobuf::QGrpcQmlReply *qmlReply = QtProtobuf::QGrpcQmlReply::acquire<$return_type$>();\n"
+                                                                "    QtProtobuf::QGrpcAsyncReplyShared reply = call(\"$method_name$\", *$param_name$);\n"
+                                                                "    reply->subscribe(qmlReply, [this, reply, qmlReply]() {\n"
+                                                                "        qmlReply->finish(readReply(reply, *qmlReply->result<$return_type$>()));\n"
+                                                                "    }, [qmlReply](const QGrpcStatus &status) {\n"
+                                                                "        qmlReply->finish(status);\n"
+                                                                "    });\n"
+                                                                "    return qmlReply;\n"
+                                                                "}\n";
 const char *Templates::RegisterSerializersTemplate = "qRegisterProtobufType<$classname$>();\n";
 const char *Templates::RegisterEnumSerializersTemplate = "qRegisterProtobufEnumType<$full_type$>();\n";
-const char *Templates::RegistrarTemplate = "static QtProtobuf::ProtoTypeRegistrar<$classname$> ProtoTypeRegistrar$classname$(qRegisterProtobufType<$classname$>);\n";
-const char *Templates::EnumRegistrarTemplate = "static QtProtobuf::ProtoTypeRegistrar<$enum_gadget$> ProtoTypeRegistrar$enum_gadget$($enum_gadget$::registerTypes);\n";
+const char *Templates::RegistrarTemplate = "static QtProtobuf::ProtoTypeRegistrar<$classname$> ProtoTypeRegistrar$classname$($classname$::ensureTypesRegistered);\n";
+const char *Templates::EnumRegistrarTemplate = "static QtProtobuf::ProtoTypeRegistrar<$enum_gadget$> ProtoTypeRegistrar$enum_gadget$($enum_gadget$::ensureTypesRegistered);\n";
 const char *Templates::QmlRegisterTypeTemplate = "qmlRegisterType<$scope_type$>(\"$qml_package$\", 1, 0, \"$type$\");\n";
 const char *Templates::QmlRegisterEnumTypeTemplate = "qmlRegisterUncreatableType<$enum_gadget$>(\"$qml_package$\", 1, 0, \"$type$\", \"$full_type$ Could not be created from qml context\");\n";
 
@@ -394,8 +783,14 @@ const char *Templates::ClientMethodServerStreamQmlDefinitionTemplate = "QtProtob
                                                                        "{\n"
                                                                        "    return subscribe(\"$method_name$\", *$param_name$, QPointer<$return_type$>($return_name$));\n"
                                                                        "}\n";
+const char *Templates::ClientMethodClientStreamDeclarationTemplate = "QtProtobuf::QGrpcClientStreamShared stream$method_name_upper$();\n";
+const char *Templates::ClientMethodClientStreamDefinitionTemplate = "QtProtobuf::QGrpcClientStreamShared $classname$::stream$method_name_upper$()\n"
+                                                                    "{\n"
+                                                                    "    return openStream(\"$method_name$\");\n"
+                                                                    "}\n";
 
 const char *Templates::ListSuffix = "Repeated";
+const char *Templates::ValueTypeSuffix = "Value";
 
 
 const std::unordered_map<::google::protobuf::FieldDescriptor::Type, std::string> Templates::TypeReflection = {
@@ -422,8 +817,23 @@ const char *Templates::GrpcFileSuffix = "_grpc";
 const char *Templates::EnumClassSuffix = "Gadget";
 
 const char *Templates::QtProtobufNamespace = "QtProtobuf";
+const char *Templates::Utf8StringType = "QtProtobuf::utf8string";
 const char *Templates::QtProtobufNestedNamespace = "_QtProtobufNested";
 
 const char *Templates::QtProtobufFieldEnum = "QtProtobufFieldEnum";
 const char *Templates::FieldEnumTemplate = "enum QtProtobufFieldEnum {\n";
 const char *Templates::FieldNumberTemplate = "$property_name_cap$ProtoFieldNumber = $number$,\n";
+const char *Templates::VisitFieldBeginTemplate = "template<typename Visitor>\n"
+                                                "bool visitField(int fieldNumber, Visitor &&visitor) const {\n"
+                                                "    switch (fieldNumber) {\n";
+const char *Templates::VisitFieldCaseTemplate = "case $property_name_cap$ProtoFieldNumber:\n"
+                                               "    visitor($property_name_cap$ProtoFieldNumber, $property_name$());\n"
+                                               "    return true;\n";
+const char *Templates::VisitFieldEndTemplate = "    default:\n"
+                                              "        break;\n"
+                                              "    }\n"
+                                              "    return false;\n"
+                                              "}\n\n";
+const char *Templates::ForEachFieldBeginTemplate = "template<typename Visitor>\n"
+                                                  "void forEachField(Visitor &&visitor) const {\n";
+const char *Templates::ForEachFieldTemplate = "visitor($property_name_cap$ProtoFieldNumber, $property_name$());\n";
@@ -43,6 +43,7 @@ public:
     static const char *ProtoSufix;
     static const char *DefaultProtobufIncludesTemplate;
     static const char *QmlProtobufIncludesTemplate;
+    static const char *ScalarViewsIncludesTemplate;
     static const char *GlobalEnumClassNameTemplate;
     static const char *PreambleTemplate;
     static const char *DisclaimerTemplate;
@@ -53,10 +54,16 @@ public:
     static const char *ManualRegistrationDeclaration;
     static const char *ManualRegistrationComplexTypeDefinition;
     static const char *ManualRegistrationGlobalEnumDefinition;
+    static const char *LazyRegistrationComplexTypeDefinition;
+    static const char *LazyRegistrationGlobalEnumDefinition;
+    static const char *RegisterFieldTypeTemplate;
+    static const char *RegisterGlobalEnumFieldTypeTemplate;
     static const char *ComplexGlobalEnumFieldRegistrationTemplate;
     static const char *ComplexListTypeUsingTemplate;
     static const char *MapTypeUsingTemplate;
     static const char *MessageMapTypeUsingTemplate;
+    static const char *HashTypeUsingTemplate;
+    static const char *MessageHashTypeUsingTemplate;
     static const char *NestedMessageUsingTemplate;
     static const char *EnumTypeRepeatedTemplate;
     static const char *NamespaceTemplate;
@@ -71,6 +78,7 @@ public:
     static const char *PropertyTemplate;
     static const char *RepeatedPropertyTemplate;
     static const char *NonScriptablePropertyTemplate;
+    static const char *ScalarViewPropertyTemplate;
     static const char *NonScriptableAliasPropertyTemplate;
     static const char *MessagePropertyTemplate;
     static const char *QmlListPropertyTemplate;
@@ -91,6 +99,10 @@ public:
     static const char *MemberTemplate;
     static const char *ListMemberTemplate;
     static const char *ComplexMemberTemplate;
+    static const char *UnknownFieldsMemberTemplate;
+    static const char *ScalarViewMemberTemplate;
+    static const char *PresenceMemberTemplate;
+    static const char *DirtyFieldsMemberTemplate;
     static const char *PublicBlockTemplate;
     static const char *PrivateBlockTemplate;
     static const char *EnumDefinitionTemplate;
@@ -101,40 +113,94 @@ public:
     static const char *MoveConstructorDeclarationTemplate;
     static const char *CopyConstructorDefinitionTemplate;
     static const char *MoveConstructorDefinitionTemplate;
-    static const char *EmptyCopyConstructorDefinitionTemplate;
-    static const char *EmptyMoveConstructorDefinitionTemplate;
     static const char *DeletedCopyConstructorTemplate;
     static const char *DeletedMoveConstructorTemplate;
     static const char *CopyFieldTemplate;
+    static const char *CopyUnknownFieldsTemplate;
+    static const char *MoveUnknownFieldsTemplate;
+    static const char *CopyPresenceTemplate;
+    static const char *CleanDirtyFieldsTemplate;
     static const char *CopyComplexFieldTemplate;
+    static const char *CopyFieldInitializerTemplate;
+    static const char *CopyStateInitializerTemplate;
     static const char *AssignComplexFieldTemplate;
     static const char *MoveMessageFieldTemplate;
     static const char *MoveAssignMessageFieldTemplate;
+    static const char *ClearDeclarationTemplate;
+    static const char *SpaceUsedDeclarationTemplate;
+    static const char *OneofCaseEnumBeginTemplate;
+    static const char *OneofCaseEnumFieldTemplate;
+    static const char *OneofCaseGetterTemplate;
+    static const char *OneofClearTemplate;
+    static const char *OneofCaseSetterDeclarationTemplate;
+    static const char *OneofCaseMemberTemplate;
+    static const char *OneofCaseSetterDefinitionTemplate;
+    static const char *OneofActivateFieldTemplate;
+    static const char *OneofCaseSetterMiddleTemplate;
+    static const char *OneofResetFieldTemplate;
+    static const char *OneofResetMessageFieldTemplate;
+    static const char *OneofCaseSetterEndTemplate;
+    static const char *OneofConstructorActivationTemplate;
+    static const char *OneofCaseInitializerTemplate;
+    static const char *OneofCopyCaseTemplate;
+    static const char *OneofMoveCaseTemplate;
+    static const char *OneofClearCaseTemplate;
+    static const char *OneofClearOtherCaseTemplate;
+    static const char *OneofAssignFieldTemplate;
+    static const char *DelegatingNonScriptableSetterTemplate;
+    static const char *OneofMoveFieldTemplate;
+    static const char *OneofMergeFieldTemplate;
+    static const char *HasFieldTemplate;
+    static const char *ClearFieldDeclarationTemplate;
+    static const char *ClearOptionalFieldDefinitionTemplate;
+    static const char *OptionalMergeFieldTemplate;
+    static const char *EqualOperatorPresenceTemplate;
+    static const char *EqualOperatorOneofCaseTemplate;
+    static const char *ClearDefinitionTemplate;
+    static const char *ClearMessageFieldTemplate;
+    static const char *ClearComplexFieldTemplate;
+    static const char *ClearFieldTemplate;
+    static const char *EnumClearFieldTemplate;
+    static const char *ClearUnknownFieldsTemplate;
+    static const char *SpaceUsedDefinitionTemplate;
+    static const char *SpaceUsedFieldTemplate;
+    static const char *SpaceUsedUnknownFieldsTemplate;
+    static const char *ClearPresenceTemplate;
+    static const char *DeltaDeclarationTemplate;
+    static const char *MergeFieldsDefinitionTemplate;
+    static const char *EmptyMergeFieldsDefinitionTemplate;
+    static const char *MergeFieldTemplate;
+    static const char *CompactCopyFieldsTemplate;
+    static const char *CompactClearFieldsTemplate;
+    static const char *CompactMergeFieldsTemplate;
     static const char *MoveComplexFieldTemplate;
     static const char *MoveComplexFieldConstructorTemplate;
     static const char *MoveFieldTemplate;
     static const char *EnumMoveFieldTemplate;
     static const char *AssignmentOperatorDeclarationTemplate;
     static const char *AssignmentOperatorDefinitionTemplate;
-    static const char *EmptyAssignmentOperatorDefinitionTemplate;
     static const char *AssignmentOperatorReturnTemplate;
     static const char *MoveAssignmentOperatorDeclarationTemplate;
     static const char *MoveAssignmentOperatorDefinitionTemplate;
-    static const char *EmptyMoveAssignmentOperatorDefinitionTemplate;
     static const char *EqualOperatorDeclarationTemplate;
     static const char *EqualOperatorDefinitionTemplate;
     static const char *EmptyEqualOperatorDefinitionTemplate;
     static const char *EqualOperatorPropertyTemplate;
     static const char *EqualOperatorMessagePropertyTemplate;
+    static const char *EqualOperatorSizePropertyTemplate;
     static const char *EqualOperatorRepeatedPropertyTemplate;
     static const char *NotEqualOperatorDeclarationTemplate;
     static const char *NotEqualOperatorDefinitionTemplate;
+    static const char *HashFunctionDeclarationTemplate;
+    static const char *HashFunctionDefinitionTemplate;
+    static const char *DeclareStdHashTemplate;
     static const char *GetterPrivateMessageDeclarationTemplate;
     static const char *GetterPrivateMessageDefinitionTemplate;
     static const char *GetterMessageDeclarationTemplate;
     static const char *GetterMessageDefinitionTemplate;
     static const char *GetterTemplate;
     static const char *NonScriptableGetterTemplate;
+    static const char *ScalarViewGetterTemplate;
     static const char *GetterContainerExtraTemplate;
     static const char *GetterQmlListDeclarationTemplate;
     static const char *GetterQmlListDefinitionTemplate;
@@ -149,7 +215,44 @@ public:
     static const char *SignalsBlockTemplate;
     static const char *SignalTemplate;
     static const char *FieldsOrderingContainerTemplate;
+    static const char *FieldDescriptorsContainerTemplate;
+    static const char *FieldDescriptorTemplate;
     static const char *FieldOrderTemplate;
+    static const char *MessageFieldOrderTemplate;
+    static const char *DirectFieldsOrderingContainerTemplate;
+    static const char *DirectSerializersIncludesTemplate;
+    static const char *DirectSerializersDeclarationTemplate;
+    static const char *SerializeToDefinitionTemplate;
+    static const char *EmptySerializeToDefinitionTemplate;
+    static const char *SerializeFieldTemplate;
+    static const char *SerializeEnumFieldTemplate;
+    static const char *ParseFromDefinitionBeginTemplate;
+    static const char *ParseFieldTemplate;
+    static const char *ParseRepeatedFieldTemplate;
+    static const char *ParseEnumFieldTemplate;
+    static const char *ParseFromDefinitionEndTemplate;
+    static const char *ParseInOrderDeclarationTemplate;
+    static const char *ParseInOrderDefinitionBeginTemplate;
+    static const char *OrderedParseFieldTemplate;
+    static const char *OrderedParseRepeatedFieldTemplate;
+    static const char *OrderedParseEnumFieldTemplate;
+    static const char *ParseInOrderDefinitionEndTemplate;
+    static const char *ValueTypeForwardDeclarationTemplate;
+    static const char *ValueTypeDeclarationBeginTemplate;
+    static const char *ValueTypePropertyTemplate;
+    static const char *ValueTypePublicDeclarationTemplate;
+    static const char *ValueTypeMemberTemplate;
+    static const char *ValueTypeListUsingTemplate;
+    static const char *DeclareValueTypeTemplate;
+    static const char *ValueTypeConstructorDefinitionTemplate;
+    static const char *ValueTypeFirstInitializerTemplate;
+    static const char *ValueTypeInitializerTemplate;
+    static const char *ValueTypeCopyToDefinitionTemplate;
+    static const char *ValueTypeCopyFieldTemplate;
+    static const char *ValueTypeEqualOperatorDefinitionTemplate;
+    static const char *ValueTypeEqualOperatorPropertyTemplate;
+    static const char *ValueTypeNotEqualOperatorDefinitionTemplate;
+    static const char *RegisterValueTypeTemplate;
     static const char *EnumTemplate;
     static const char *SimpleBlockEnclosureTemplate;
     static const char *SemicolonBlockEnclosureTemplate;
@@ -158,6 +261,7 @@ public:
     static const char *PropertyDefaultInitializerTemplate;
     static const char *MessagePropertyInitializerTemplate;
     static const char *MessagePropertyDefaultInitializerTemplate;
+    static const char *PresenceInitializerTemplate;
     static const char *ConstructorContentTemplate;
     static const char *DeclareMetaTypeTemplate;
     static const char *DeclareMetaTypeListTemplate;
@@ -165,8 +269,10 @@ public:
     static const char *DeclareComplexListTypeTemplate;
     static const char *DeclareComplexQmlListTypeTemplate;
     static const char *DeclareMetaTypeMapTemplate;
+    static const char *DeclareMetaTypeHashTemplate;
     static const char *RegisterLocalEnumTemplate;
     static const char *RegisterMapTemplate;
+    static const char *RegisterHashTemplate;
     static const char *RegisterMetaTypeTemplate;
     static const char *RegisterGlobalEnumMetaTypeTemplate;
     static const char *RegisterMetaTypeTemplateNoNamespace;
@@ -185,16 +291,27 @@ public:
     static const char *ClientMethodDeclarationSyncTemplate;
     static const char *ClientMethodDeclarationAsyncTemplate;
     static const char *ClientMethodDeclarationAsync2Template;
+    static const char *ClientMethodDeclarationAsync3Template;
+    static const char *ClientMethodDeclarationAsync4Template;
+    static const char *ClientMethodDeclarationAwaitableTemplate;
     static const char *ClientMethodDeclarationQmlTemplate;
     static const char *ClientMethodDeclarationQml2Template;
+    static const char *ClientMethodDeclarationQmlReplyTemplate;
 
     static const char *ServerMethodDeclarationTemplate;
+    static const char *ServerConstructorBeginTemplate;
+    static const char *ServerMethodRegistrationTemplate;
+    static const char *ServerConstructorEndTemplate;
 
     static const char *ClientMethodDefinitionSyncTemplate;
     static const char *ClientMethodDefinitionAsyncTemplate;
     static const char *ClientMethodDefinitionAsync2Template;
+    static const char *ClientMethodDefinitionAsync3Template;
+    static const char *ClientMethodDefinitionAsync4Template;
+    static const char *ClientMethodDefinitionAwaitableTemplate;
     static const char *ClientMethodDefinitionQmlTemplate;
     static const char *ClientMethodDefinitionQml2Template;
+    static const char *ClientMethodDefinitionQmlReplyTemplate;
 
     //Streaming
     static const char *ClientMethodSignalDeclarationTemplate;
@@ -204,8 +321,11 @@ public:
     static const char *ClientMethodServerStreamDefinitionTemplate;
     static const char *ClientMethodServerStream2DefinitionTemplate;
     static const char *ClientMethodServerStreamQmlDefinitionTemplate;
+    static const char *ClientMethodClientStreamDeclarationTemplate;
+    static const char *ClientMethodClientStreamDefinitionTemplate;
 
     static const char *ListSuffix;
+    static const char *ValueTypeSuffix;
     static const char *ProtoFileSuffix;
     static const char *GrpcFileSuffix;
     static const char *EnumClassSuffix;
@@ -213,10 +333,16 @@ public:
     static const std::unordered_map<::google::protobuf::FieldDescriptor::Type, std::string> TypeReflection;
 
     static const char *QtProtobufNamespace;
+    static const char *Utf8StringType;
     static const char *QtProtobufNestedNamespace;
 
     static const char *FieldEnumTemplate;
     static const char *FieldNumberTemplate;
+    static const char *VisitFieldBeginTemplate;
+    static const char *VisitFieldCaseTemplate;
+    static const char *VisitFieldEndTemplate;
+    static const char *ForEachFieldBeginTemplate;
+    static const char *ForEachFieldTemplate;
     static const char *QtProtobufFieldEnum;
 };
 
@@ -27,15 +27,21 @@
 
 #include "qgrpcasyncreply.h"
 #include "qgrpcstream.h"
+#include "qgrpcclientstream.h"
+#include "qgrpcreconnectpolicy.h"
 #include <QThread>
+#include <QTimer>
 
 namespace QtProtobuf {
 
 struct QAbstractGrpcChannelPrivate {
-    QAbstractGrpcChannelPrivate() : thread(QThread::currentThread()) {
+    QAbstractGrpcChannelPrivate() : thread(QThread::currentThread())
+      , reconnectPolicy(std::make_shared<QGrpcReconnectPolicy>())
+    {
         assert(thread != nullptr && "QAbstractGrpcChannel has to be created in QApplication context");
     }
     const QThread *thread;
+    std::shared_ptr<QGrpcReconnectPolicy> reconnectPolicy;
 };
 
 QAbstractGrpcChannel::QAbstractGrpcChannel() : dPtr(new QAbstractGrpcChannelPrivate)
@@ -58,6 +64,44 @@ void QAbstractGrpcChannel::cancel(QGrpcStream *stream)
     stream->finished();
 }
 
+void QAbstractGrpcChannel::callWithHandler(const QString &, const QString &, const QByteArray &, const CallHandler &handler)
+{
+    //Error is reported asynchronously, like result of any asynchronous call
+    QTimer::singleShot(0, [handler] {
+        handler({QGrpcStatus::StatusCode::Unimplemented, QLatin1String("Calls with handler are not supported by channel")}, {});
+    });
+}
+
+void QAbstractGrpcChannel::openStream(QGrpcClientStream *stream, const QString &, QAbstractGrpcClient *)
+{
+    assert(stream != nullptr);
+    //Error is reported asynchronously, when client is able to handle stream signals
+    QMetaObject::invokeMethod(stream, [stream] {
+        stream->error({QGrpcStatus::StatusCode::Unimplemented, QLatin1String("Client streams are not supported by channel")});
+    }, Qt::QueuedConnection);
+}
+
+bool QAbstractGrpcChannel::isThreadSafe() const
+{
+    return false;
+}
+
+void QAbstractGrpcChannel::cancel(QGrpcClientStream *stream)
+{
+    assert(stream != nullptr);
+    stream->error({QGrpcStatus::StatusCode::Aborted, QLatin1String("Stream aborted by user")});
+}
+
+void QAbstractGrpcChannel::setReconnectPolicy(const std::shared_ptr<QGrpcReconnectPolicy> &policy)
+{
+    dPtr->reconnectPolicy = policy;
+}
+
+std::shared_ptr<QGrpcReconnectPolicy> QAbstractGrpcChannel::reconnectPolicy() const
+{
+    return dPtr->reconnectPolicy;
+}
+
 const QThread *QAbstractGrpcChannel::thread() const
 {
     return dPtr->thread;
@@ -40,9 +40,18 @@ namespace QtProtobuf {
 
 class QGrpcAsyncReply;
 class QGrpcStream;
+class QGrpcClientStream;
 class QAbstractGrpcClient;
 class QAbstractProtobufSerializer;
+class QGrpcReconnectPolicy;
 struct QAbstractGrpcChannelPrivate;
+
+/*!
+ * \private
+ * \brief Handler of asynchronous call, that receives status of call and serialized returned message
+ */
+using CallHandler = std::function<void(const QGrpcStatus &status, const QByteArray &data)>;
+
 /*!
  * \ingroup QtGrpc
  * \brief The QAbstractGrpcChannel class is interface that represents common gRPC channel functionality.
@@ -77,6 +86,18 @@ public:
      */
     virtual void call(const QString &method, const QString &service, const QByteArray &args, QtProtobuf::QGrpcAsyncReply *ret) = 0;
 
+    /*!
+     * \brief Calls \p method asynchronously and passes result of call to \p handler. In comparison with asynchronous
+     *        QAbstractGrpcChannel::call() neither QGrpcAsyncReply nor signal connections are created for the call.
+     *        \note This method should not be called directly.
+     *        \note Default implementation reports QGrpcStatus::Unimplemented error to \p handler.
+     * \param[in] method remote method is called
+     * \param[in] service service identified in URL path format
+     * \param[in] args serialized argument message
+     * \param[in] handler invoked once, when call is completed
+     */
+    virtual void callWithHandler(const QString &method, const QString &service, const QByteArray &args, const CallHandler &handler);
+
     /*!
      * \brief Subscribes to server-side stream to receive updates for given \p method.
      *        \note This method should not be called directly.
@@ -87,10 +108,41 @@ public:
      */
     virtual void subscribe(QGrpcStream *stream, const QString &service, QAbstractGrpcClient *client) = 0;
 
+    /*!
+     * \brief Opens client-streaming or bidirectional-streaming call of \p stream method.
+     *        \note This method should not be called directly.
+     *        \note Default implementation reports QGrpcStatus::Unimplemented error to \p stream.
+     * \param[in] stream client stream, that provides messages written by client and receives messages of server
+     * \param[in] service service identified in URL path format
+     * \param[in] client client that owns \p stream
+     */
+    virtual void openStream(QGrpcClientStream *stream, const QString &service, QAbstractGrpcClient *client);
+
     virtual std::shared_ptr<QAbstractProtobufSerializer> serializer() const = 0;
 
+    /*!
+     * \brief Returns true if synchronous and asynchronous QAbstractGrpcChannel::call() may be invoked from any thread.
+     *        Asynchronous call delivers result in thread of QGrpcAsyncReply. Otherwise calls made from other threads
+     *        are redirected by QAbstractGrpcClient to thread of client.
+     *        \note Default implementation returns false.
+     * \see QAbstractGrpcClient::setMultiThreadingEnabled
+     */
+    virtual bool isThreadSafe() const;
+
     const QThread *thread() const;
 
+    /*!
+     * \brief Sets policy of server streams reconnection after stream failure. By default streams are restored
+     *        using exponential backoff, implemented by QGrpcReconnectPolicy.
+     * \param[in] policy reconnect policy, nullptr disables restoring of streams
+     */
+    void setReconnectPolicy(const std::shared_ptr<QGrpcReconnectPolicy> &policy);
+
+    /*!
+     * \brief Returns policy of server streams reconnection
+     */
+    std::shared_ptr<QGrpcReconnectPolicy> reconnectPolicy() const;
+
 protected:
     //! \private
     QAbstractGrpcChannel();
@@ -111,8 +163,16 @@ protected:
      */
     virtual void cancel(QGrpcStream *stream);
 
+    /*!
+     * \private
+     * \brief Cancels client \p stream
+     * \param[in] stream opened by QAbstractGrpcChannel::openStream() method
+     */
+    virtual void cancel(QGrpcClientStream *stream);
+
     friend class QGrpcAsyncReply;
     friend class QGrpcStream;
+    friend class QGrpcClientStream;
 private:
     Q_DISABLE_COPY(QAbstractGrpcChannel)
     std::unique_ptr<QAbstractGrpcChannelPrivate> dPtr;
@@ -27,10 +27,22 @@
 
 #include "qgrpcasyncreply.h"
 #include "qgrpcstream.h"
+#include "qgrpcclientstream.h"
+#include "qgrpcclientinterceptor.h"
+#include "qgrpcmetrics.h"
+#include "qgrpcreconnectpolicy.h"
 #include "qprotobufserializerregistry_p.h"
 
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QPair>
 #include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+
+#include <algorithm>
+#include <atomic>
 
 namespace QtProtobuf {
 
@@ -44,7 +56,88 @@ public:
     std::shared_ptr<QAbstractGrpcChannel> channel;
     const QString service;
     std::shared_ptr<QAbstractProtobufSerializer> serializer;
-    std::vector<QGrpcStreamShared> activeStreams;
+    //Active streams indexed by method and serialized arguments, to find stream to merge without comparing to each stream
+    QHash<QPair<QString, QByteArray>, QGrpcStreamShared> activeStreams;
+    bool streamMergeEnabled = false;
+    bool backgroundDeserializationEnabled = false;
+    std::atomic<bool> multiThreadingEnabled{false};
+    bool callCoalescingEnabled = false;
+    std::shared_ptr<QGrpcMetrics> metrics;
+    std::shared_ptr<QGrpcTracer> tracer;
+    std::vector<std::shared_ptr<QGrpcClientInterceptor>> interceptors;
+
+    //! \brief Returns metrics of \a method, or nullptr if metrics are not recorded
+    //! \details Returned pointer shares ownership of metrics collection, so pending calls may outlive it
+    std::shared_ptr<QGrpcMethodMetrics> methodMetrics(const QString &method) const {
+        return metrics ? std::shared_ptr<QGrpcMethodMetrics>(metrics, metrics->method(service, method)) : nullptr;
+    }
+
+    //! \brief Starts span of \a method, that may add trace context to \a metadata. Returns nullptr if calls are not traced
+    std::shared_ptr<QGrpcSpan> startSpan(const QString &method, QGrpcMetadata &metadata) const {
+        return tracer ? tracer->startSpan(service, method, metadata) : nullptr;
+    }
+
+    //! \brief Returns chain of interceptors of \a method, that passes call to \a channelCall at the end
+    QGrpcClientInterceptor::Next interceptorChain(const QString &method, const QGrpcClientInterceptor::Next &channelCall) const {
+        QGrpcClientInterceptor::Next next = channelCall;
+        for (auto it = interceptors.rbegin(); it != interceptors.rend(); ++it) {
+            std::shared_ptr<QGrpcClientInterceptor> interceptor = *it;
+            QString service = this->service;
+            next = [interceptor, service, method, next](const QByteArray &arg, const QGrpcCallOptions &options,
+                    const QGrpcClientInterceptor::ResponseHandler &handler) {
+                interceptor->interceptCall(service, method, arg, options, handler, next);
+            };
+        }
+        return next;
+    }
+
+    //! \brief Passes start of stream of \a method to interceptors, sets \a messageInterceptor, that passes received
+    //!        messages to interceptors
+    QGrpcStatus interceptStream(const QString &method, QByteArray &arg, std::function<bool(QByteArray &)> &messageInterceptor) const {
+        for (const auto &interceptor : interceptors) {
+            QGrpcStatus status = interceptor->interceptStream(service, method, arg);
+            if (status.code() != QGrpcStatus::Ok) {
+                return status;
+            }
+        }
+
+        if (!interceptors.empty()) {
+            messageInterceptor = [interceptors = this->interceptors, service = this->service, method](QByteArray &data) {
+                for (const auto &interceptor : interceptors) {
+                    if (!interceptor->interceptStreamMessage(service, method, data)) {
+                        return false;
+                    }
+                }
+                return true;
+            };
+        }
+        return {QGrpcStatus::Ok};
+    }
+
+    //! \private
+    //! \brief Request shared by coalesced calls
+    struct CoalescedCall {
+        QGrpcAsyncReplyShared request;
+        std::vector<QPointer<QGrpcAsyncReply>> replies;
+        std::vector<CallHandler> handlers;
+        bool completed = false;
+    };
+
+    //Active coalesced calls indexed by method and serialized arguments
+    QHash<QPair<QString, QByteArray>, std::shared_ptr<CoalescedCall>> coalescedCalls;
+    QHash<QPair<QString, QByteArray>, std::shared_ptr<CoalescedCall>> coalescedHandlerCalls;
+};
+
+//! \private
+class QGrpcBackgroundTask final : public QRunnable {
+public:
+    QGrpcBackgroundTask(const std::function<void()> &task) : m_task(task) {}
+    void run() override {
+        m_task();
+    }
+
+private:
+    std::function<void()> m_task;
 };
 }
 
@@ -60,7 +153,7 @@ QAbstractGrpcClient::~QAbstractGrpcClient()
 
 void QAbstractGrpcClient::attachChannel(const std::shared_ptr<QAbstractGrpcChannel> &channel)
 {
-    if (channel->thread() != QThread::currentThread()) {
+    if (!channel->isThreadSafe() && channel->thread() != QThread::currentThread()) {
         qProtoCritical() << "QAbstractGrpcClient::attachChannel is called from different thread.\n"
                            "QtGrpc doesn't guarantie thread safety on channel level.\n"
                            "You have to be confident that channel routines are working in the same thread as QAbstractGrpcClient";
@@ -70,10 +163,113 @@ void QAbstractGrpcClient::attachChannel(const std::shared_ptr<QAbstractGrpcChann
     dPtr->serializer = channel->serializer();
 }
 
+void QAbstractGrpcClient::setStreamMergeEnabled(bool enabled)
+{
+    dPtr->streamMergeEnabled = enabled;
+}
+
+bool QAbstractGrpcClient::isStreamMergeEnabled() const
+{
+    return dPtr->streamMergeEnabled;
+}
+
+void QAbstractGrpcClient::setBackgroundDeserializationEnabled(bool enabled)
+{
+    dPtr->backgroundDeserializationEnabled = enabled;
+}
+
+bool QAbstractGrpcClient::isBackgroundDeserializationEnabled() const
+{
+    return dPtr->backgroundDeserializationEnabled;
+}
+
+void QAbstractGrpcClient::setMultiThreadingEnabled(bool enabled)
+{
+    dPtr->multiThreadingEnabled = enabled;
+}
+
+bool QAbstractGrpcClient::isMultiThreadingEnabled() const
+{
+    return dPtr->multiThreadingEnabled;
+}
+
+void QAbstractGrpcClient::setCallCoalescingEnabled(bool enabled)
+{
+    dPtr->callCoalescingEnabled = enabled;
+}
+
+bool QAbstractGrpcClient::isCallCoalescingEnabled() const
+{
+    return dPtr->callCoalescingEnabled;
+}
+
+void QAbstractGrpcClient::setMetrics(const std::shared_ptr<QGrpcMetrics> &metrics)
+{
+    dPtr->metrics = metrics;
+}
+
+std::shared_ptr<QGrpcMetrics> QAbstractGrpcClient::metrics() const
+{
+    return dPtr->metrics;
+}
+
+void QAbstractGrpcClient::setTracer(const std::shared_ptr<QGrpcTracer> &tracer)
+{
+    dPtr->tracer = tracer;
+}
+
+std::shared_ptr<QGrpcTracer> QAbstractGrpcClient::tracer() const
+{
+    return dPtr->tracer;
+}
+
+void QAbstractGrpcClient::addInterceptor(const std::shared_ptr<QGrpcClientInterceptor> &interceptor)
+{
+    if (interceptor) {
+        dPtr->interceptors.push_back(interceptor);
+    }
+}
+
+void QAbstractGrpcClient::removeInterceptor(const std::shared_ptr<QGrpcClientInterceptor> &interceptor)
+{
+    auto &interceptors = dPtr->interceptors;
+    interceptors.erase(std::remove(interceptors.begin(), interceptors.end(), interceptor), interceptors.end());
+}
+
+std::vector<std::shared_ptr<QGrpcClientInterceptor>> QAbstractGrpcClient::interceptors() const
+{
+    return dPtr->interceptors;
+}
+
+void QAbstractGrpcClient::traceStreamEvent(QGrpcStream *stream, QGrpcSpan::Event event)
+{
+    if (stream != nullptr) {
+        stream->traceEvent(event);
+    }
+}
+
+QGrpcDecodedStreamMessage *QAbstractGrpcClient::decodedStreamMessage(QGrpcStream *stream, int type)
+{
+    if (stream == nullptr || stream->m_handlers.size() < 2) {
+        return nullptr;
+    }
+    return &stream->m_decodedMessages[type];
+}
+
+void QAbstractGrpcClient::runInBackground(const std::function<void()> &task)
+{
+    //Single thread keeps order of messages, that are deserialized in background
+    static QThreadPool pool;
+    static const bool poolInitialized = (pool.setMaxThreadCount(1), true);
+    Q_UNUSED(poolInitialized)
+    pool.start(new QGrpcBackgroundTask(task));
+}
+
 QGrpcStatus QAbstractGrpcClient::call(const QString &method, const QByteArray &arg, QByteArray &ret)
 {
     QGrpcStatus callStatus{QGrpcStatus::Unknown};
-    if (thread() != QThread::currentThread()) {
+    std::shared_ptr<QAbstractGrpcChannel> channel = dPtr->channel;
+    if (thread() != QThread::currentThread() && !(channel && channel->isThreadSafe())) {
         QMetaObject::invokeMethod(this, [&]()->QGrpcStatus {
                                                 qProtoDebug() << "Method: " << dPtr->service << method << " called from different thread";
                                                 return call(method, arg, ret);
@@ -81,8 +277,43 @@ QGrpcStatus QAbstractGrpcClient::call(const QString &method, const QByteArray &a
         return callStatus;
     }
 
-    if (dPtr->channel) {
-        callStatus = dPtr->channel->call(method, dPtr->service, arg, ret);
+    //Thread-safe channels are called directly from calling thread, to avoid extra thread hop
+    if (channel) {
+        std::shared_ptr<QGrpcMethodMetrics> metrics = dPtr->methodMetrics(method);
+        QElapsedTimer timer;
+        if (metrics) {
+            metrics->callStarted(arg.size());
+            timer.start();
+        }
+        //Synchronous calls are made without metadata, so trace context isn't sent
+        QGrpcMetadata metadata;
+        std::shared_ptr<QGrpcSpan> span = dPtr->startSpan(method, metadata);
+        if (dPtr->interceptors.empty()) {
+            callStatus = channel->call(method, dPtr->service, arg, ret);
+        } else {
+            //Interceptors complete synchronous call before chain returns, so locals are safe to be referenced
+            bool completed = false;
+            auto channelCall = [this, &channel, &method](const QByteArray &arg, const QGrpcCallOptions &,
+                    const QGrpcClientInterceptor::ResponseHandler &handler) {
+                QByteArray data;
+                QGrpcStatus status = channel->call(method, dPtr->service, arg, data);
+                handler(status, data, {});
+            };
+            dPtr->interceptorChain(method, channelCall)(arg, {}, [&](const QGrpcStatus &status, const QByteArray &data, const QGrpcMetadata &) {
+                callStatus = status;
+                ret = data;
+                completed = true;
+            });
+            if (!completed) {
+                callStatus = QGrpcStatus{QGrpcStatus::Internal, QLatin1String("Interceptor didn't complete synchronous call")};
+            }
+        }
+        if (metrics) {
+            metrics->callFinished(callStatus.code(), std::chrono::microseconds(timer.nsecsElapsed() / 1000), ret.size());
+        }
+        if (span) {
+            span->finish(callStatus);
+        }
     } else {
         callStatus = QGrpcStatus{QGrpcStatus::Unknown, QLatin1String("No channel(s) attached.")};
     }
@@ -94,33 +325,68 @@ QGrpcStatus QAbstractGrpcClient::call(const QString &method, const QByteArray &a
     return callStatus;
 }
 
-QGrpcAsyncReplyShared QAbstractGrpcClient::call(const QString &method, const QByteArray &arg)
+QGrpcAsyncReplyShared QAbstractGrpcClient::call(const QString &method, const QByteArray &arg, const QGrpcCallOptions &options)
 {
     QGrpcAsyncReplyShared reply;
-    if (thread() != QThread::currentThread()) {
+    std::shared_ptr<QAbstractGrpcChannel> channel = dPtr->channel;
+    //In multi-threaded mode reply is created in calling thread and thread-safe channel is called directly
+    if (thread() != QThread::currentThread() && !(dPtr->multiThreadingEnabled && channel && channel->isThreadSafe())) {
         QMetaObject::invokeMethod(this, [&]()->QGrpcAsyncReplyShared {
                                       qProtoDebug() << "Method: " << dPtr->service << method << " called from different thread";
-                                      return call(method, arg);
+                                      return call(method, arg, options);
                                   }, Qt::BlockingQueuedConnection, &reply);
-    } else if (dPtr->channel) {
-        reply.reset(new QGrpcAsyncReply(dPtr->channel, this), [](QGrpcAsyncReply *reply) { reply->deleteLater(); });
+    } else if (channel) {
+        reply.reset(new QGrpcAsyncReply(channel, this), [](QGrpcAsyncReply *reply) { reply->deleteLater(); });
+        reply->m_options = options;
+
+        //Trace context is sent as metadata of call
+        QGrpcMetadata metadata = options.metadata();
+        reply->m_span = dPtr->startSpan(method, metadata);
+        if (reply->m_span) {
+            reply->m_options.setMetadata(metadata);
+        }
+
+        std::shared_ptr<QGrpcMethodMetrics> metrics = dPtr->methodMetrics(method);
+        QElapsedTimer timer;
+        if (metrics) {
+            metrics->callStarted(arg.size());
+            timer.start();
+        }
 
         auto errorConnection = std::make_shared<QMetaObject::Connection>();
         auto finishedConnection = std::make_shared<QMetaObject::Connection>();
-        *errorConnection = connect(reply.get(), &QGrpcAsyncReply::error, this, [this, reply, errorConnection, finishedConnection](const QGrpcStatus &status) mutable {
+        *errorConnection = connect(reply.get(), &QGrpcAsyncReply::error, this, [this, reply, errorConnection, finishedConnection, metrics, timer](const QGrpcStatus &status) mutable {
+            if (metrics) {
+                metrics->callFinished(status.code(), std::chrono::microseconds(timer.nsecsElapsed() / 1000), 0);
+            }
+            if (reply->m_span) {
+                reply->m_span->finish(status);
+            }
             error(status);
             QObject::disconnect(*finishedConnection);
             QObject::disconnect(*errorConnection);
             reply.reset();
         });
 
-        *finishedConnection = connect(reply.get(), &QGrpcAsyncReply::finished, [reply, errorConnection, finishedConnection]() mutable {
+        *finishedConnection = connect(reply.get(), &QGrpcAsyncReply::finished, [reply, errorConnection, finishedConnection, metrics, timer]() mutable {
+            if (metrics) {
+                metrics->callFinished(QGrpcStatus::Ok, std::chrono::microseconds(timer.nsecsElapsed() / 1000), reply->data().size());
+            }
+            //Connection is made before receivers of reply are connected, so message is delivered to them right after
+            if (reply->m_span) {
+                reply->m_span->addEvent(QGrpcSpan::MessageDelivered);
+                reply->m_span->finish(QGrpcStatus::Ok);
+            }
             QObject::disconnect(*finishedConnection);
             QObject::disconnect(*errorConnection);
             reply.reset();
         });
 
-        dPtr->channel->call(method, dPtr->service, arg, reply.get());
+        if (dPtr->interceptors.empty()) {
+            startCall(method, arg, reply);
+        } else {
+            interceptCall(method, arg, reply);
+        }
     } else {
         error({QGrpcStatus::Unknown, QLatin1String("No channel(s) attached.")});
     }
@@ -128,6 +394,311 @@ QGrpcAsyncReplyShared QAbstractGrpcClient::call(const QString &method, const QBy
     return reply;
 }
 
+void QAbstractGrpcClient::startCall(const QString &method, const QByteArray &arg, const QGrpcAsyncReplyShared &request)
+{
+    //Calls with own options may differ from each other, even if arguments are the same
+    if (dPtr->callCoalescingEnabled && request->options().isEmpty() && thread() == QThread::currentThread()) {
+        coalesceCall(method, arg, request);
+    } else {
+        dPtr->channel->call(method, dPtr->service, arg, request.get());
+    }
+}
+
+void QAbstractGrpcClient::interceptCall(const QString &method, const QByteArray &arg, const QGrpcAsyncReplyShared &reply)
+{
+    //State is shared by all attempts of call made by interceptors
+    struct InterceptedCall {
+        //Attempts may run concurrently, e.g. hedged ones. Pending attempts are cancelled, once call is completed.
+        std::vector<QGrpcAsyncReplyShared> requests;
+        bool completed = false;
+        //Call may be completed by interceptor before reply is returned to caller
+        bool dispatching = true;
+    };
+    auto call = std::make_shared<InterceptedCall>();
+    QPointer<QGrpcAsyncReply> replyPtr(reply.get());
+
+    QPointer<QAbstractGrpcClient> client(this);
+    auto channelCall = [this, client, method, call, replyPtr](const QByteArray &arg, const QGrpcCallOptions &options,
+            const QGrpcClientInterceptor::ResponseHandler &handler) {
+        if (call->completed || replyPtr.isNull()) {
+            return;
+        }
+
+        //Interceptors may repeat call later, e.g. retry it after backoff
+        if (client.isNull()) {
+            handler({QGrpcStatus::Cancelled, QLatin1String("Client is destroyed")}, {}, {});
+            return;
+        }
+
+        //Result of attempt is passed back to interceptors by connections of internal reply in thread of call
+        QGrpcAsyncReplyShared request(new QGrpcAsyncReply(dPtr->channel, this), [](QGrpcAsyncReply *reply) { reply->deleteLater(); });
+        request->m_options = options;
+        request->m_span = replyPtr->m_span;
+        QGrpcAsyncReply *requestPtr = request.get();
+        auto release = [call, requestPtr] {
+            auto &requests = call->requests;
+            requests.erase(std::remove_if(requests.begin(), requests.end(), [requestPtr](const QGrpcAsyncReplyShared &request) {
+                return request.get() == requestPtr;
+            }), requests.end());
+        };
+        connect(requestPtr, &QGrpcAsyncReply::finished, requestPtr, [requestPtr, handler, release] {
+            release();
+            handler({}, requestPtr->data(), requestPtr->metadata());
+        });
+        connect(requestPtr, &QGrpcAsyncReply::error, requestPtr, [requestPtr, handler, release](const QGrpcStatus &status) {
+            release();
+            handler(status, {}, requestPtr->metadata());
+        });
+        call->requests.push_back(request);
+        startCall(method, arg, request);
+    };
+
+    auto complete = [call, replyPtr](const QGrpcStatus &status, const QByteArray &data, const QGrpcMetadata &metadata) {
+        if (call->completed || replyPtr.isNull()) {
+            return;
+        }
+
+        call->completed = true;
+        //Releasing of internal replies cancels attempts, that are still pending
+        call->requests.clear();
+        auto deliver = [replyPtr, status, data, metadata] {
+            if (replyPtr.isNull()) {
+                return;
+            }
+
+            replyPtr->setMetadata(metadata);
+            if (status.code() == QGrpcStatus::Ok) {
+                replyPtr->setData(data);
+                replyPtr->finished();
+            } else {
+                replyPtr->setData({});
+                replyPtr->error(status);
+            }
+        };
+
+        if (call->dispatching) {
+            QMetaObject::invokeMethod(replyPtr.data(), deliver, Qt::QueuedConnection);
+        } else {
+            deliver();
+        }
+    };
+
+    //Active attempt is cancelled, when reply is aborted or destroyed
+    auto cancel = [call] {
+        if (call->completed) {
+            return;
+        }
+
+        call->completed = true;
+        const std::vector<QGrpcAsyncReplyShared> requests = std::move(call->requests);
+        call->requests.clear();
+        for (const auto &request : requests) {
+            request->abort();
+        }
+    };
+    connect(reply.get(), &QGrpcAsyncReply::error, this, [cancel](const QGrpcStatus &status) {
+        if (status.code() == QGrpcStatus::Aborted) {
+            cancel();
+        }
+    });
+    connect(reply.get(), &QObject::destroyed, this, cancel);
+
+    dPtr->interceptorChain(method, channelCall)(arg, reply->options(), complete);
+    call->dispatching = false;
+}
+
+void QAbstractGrpcClient::coalesceCall(const QString &method, const QByteArray &arg, const QGrpcAsyncReplyShared &reply)
+{
+    using CoalescedCall = QAbstractGrpcClientPrivate::CoalescedCall;
+    const QPair<QString, QByteArray> key(method, arg);
+    std::shared_ptr<CoalescedCall> &coalesced = dPtr->coalescedCalls[key];
+    if (!coalesced) {
+        //Request is made using internal reply, so any of joined calls may be aborted independently
+        coalesced = std::make_shared<CoalescedCall>();
+        coalesced->request.reset(new QGrpcAsyncReply(dPtr->channel, this), [](QGrpcAsyncReply *reply) { reply->deleteLater(); });
+        std::weak_ptr<CoalescedCall> weakCall = coalesced;
+        auto complete = [this, key, weakCall](const QGrpcStatus &status) {
+            std::shared_ptr<CoalescedCall> call = weakCall.lock();
+            if (!call || call->completed) {
+                return;
+            }
+
+            call->completed = true;
+            dPtr->coalescedCalls.remove(key);
+            const QByteArray data = call->request->data();
+            //Replies are copied, because handlers of reply signals may abort other joined calls
+            const std::vector<QPointer<QGrpcAsyncReply>> replies = call->replies;
+            for (const auto &reply : replies) {
+                if (reply.isNull()) {
+                    continue;
+                }
+
+                reply->setMetadata(call->request->metadata());
+                if (status.code() == QGrpcStatus::Ok) {
+                    reply->setData(data);
+                    reply->finished();
+                } else {
+                    reply->setData({});
+                    reply->error(status);
+                }
+            }
+        };
+        connect(coalesced->request.get(), &QGrpcAsyncReply::finished, this, [complete] {
+            complete({});
+        });
+        connect(coalesced->request.get(), &QGrpcAsyncReply::error, this, complete);
+        dPtr->channel->call(method, dPtr->service, arg, coalesced->request.get());
+    } else {
+        qProtoDebug() << "Method: " << dPtr->service << method << " joins active call";
+    }
+
+    coalesced->replies.push_back(reply.get());
+
+    //Request is cancelled when all joined calls are aborted or destroyed
+    std::weak_ptr<CoalescedCall> weakCall = coalesced;
+    auto leave = [this, key, weakCall](QObject *leaving) {
+        std::shared_ptr<CoalescedCall> call = weakCall.lock();
+        if (!call || call->completed) {
+            return;
+        }
+
+        auto &replies = call->replies;
+        replies.erase(std::remove_if(replies.begin(), replies.end(), [leaving](const QPointer<QGrpcAsyncReply> &reply) {
+            return reply.isNull() || reply.data() == leaving;
+        }), replies.end());
+
+        if (replies.empty()) {
+            qProtoDebug() << "All joined calls are aborted, request is cancelled";
+            call->completed = true;
+            dPtr->coalescedCalls.remove(key);
+            call->request->abort();
+        }
+    };
+
+    QGrpcAsyncReply *replyPtr = reply.get();
+    connect(replyPtr, &QGrpcAsyncReply::error, this, [leave, replyPtr](const QGrpcStatus &status) {
+        if (status.code() == QGrpcStatus::Aborted) {
+            leave(replyPtr);
+        }
+    });
+    connect(replyPtr, &QObject::destroyed, this, [leave](QObject *object) {
+        leave(object);
+    });
+}
+
+void QAbstractGrpcClient::callWithHandler(const QString &method, const QByteArray &arg, const CallHandler &handler)
+{
+    std::shared_ptr<QAbstractGrpcChannel> channel = dPtr->channel;
+    if (thread() != QThread::currentThread() && !(dPtr->multiThreadingEnabled && channel && channel->isThreadSafe())) {
+        //Nothing is returned to caller, so there is no need to block calling thread
+        QMetaObject::invokeMethod(this, [this, method, arg, handler]() {
+                                      qProtoDebug() << "Method: " << dPtr->service << method << " called from different thread";
+                                      callWithHandler(method, arg, handler);
+                                  }, Qt::QueuedConnection);
+        return;
+    }
+
+    if (channel) {
+        CallHandler callHandler = handler;
+        //Calls with handler are made without metadata, so trace context isn't sent
+        QGrpcMetadata metadata;
+        if (std::shared_ptr<QGrpcSpan> span = dPtr->startSpan(method, metadata)) {
+            callHandler = [handler, span](const QGrpcStatus &status, const QByteArray &data) {
+                span->addEvent(QGrpcSpan::MessageDelivered);
+                handler(status, data);
+                span->finish(status);
+            };
+        }
+
+        if (std::shared_ptr<QGrpcMethodMetrics> metrics = dPtr->methodMetrics(method)) {
+            metrics->callStarted(arg.size());
+            QElapsedTimer timer;
+            timer.start();
+            callHandler = [callHandler, metrics, timer](const QGrpcStatus &status, const QByteArray &data) {
+                metrics->callFinished(status.code(), std::chrono::microseconds(timer.nsecsElapsed() / 1000), data.size());
+                callHandler(status, data);
+            };
+        }
+
+        QPointer<QAbstractGrpcClient> client(this);
+        auto channelCall = [client, channel, method, service = dPtr->service](const QByteArray &arg, const CallHandler &handler) {
+            if (!client.isNull() && client->dPtr->callCoalescingEnabled && client->thread() == QThread::currentThread()) {
+                client->coalesceCall(method, arg, handler);
+            } else {
+                channel->callWithHandler(method, service, arg, handler);
+            }
+        };
+
+        if (dPtr->interceptors.empty()) {
+            channelCall(arg, callHandler);
+        } else {
+            //Calls with handler have neither options nor metadata
+            auto interceptedCall = [channelCall](const QByteArray &arg, const QGrpcCallOptions &,
+                    const QGrpcClientInterceptor::ResponseHandler &handler) {
+                channelCall(arg, [handler](const QGrpcStatus &status, const QByteArray &data) {
+                    handler(status, data, {});
+                });
+            };
+            //Handler is invoked asynchronously, even if interceptor completes call right away
+            auto dispatching = std::make_shared<bool>(true);
+            dPtr->interceptorChain(method, interceptedCall)(arg, {}, [callHandler, dispatching, client](const QGrpcStatus &status, const QByteArray &data, const QGrpcMetadata &) {
+                if (!*dispatching) {
+                    callHandler(status, data);
+                } else if (!client.isNull()) {
+                    QTimer::singleShot(0, client.data(), [callHandler, status, data] {
+                        callHandler(status, data);
+                    });
+                }
+            });
+            *dispatching = false;
+        }
+    } else {
+        handler({QGrpcStatus::Unknown, QLatin1String("No channel(s) attached.")}, {});
+    }
+}
+
+void QAbstractGrpcClient::coalesceCall(const QString &method, const QByteArray &arg, const CallHandler &handler)
+{
+    const QPair<QString, QByteArray> key(method, arg);
+    std::shared_ptr<QAbstractGrpcClientPrivate::CoalescedCall> &coalesced = dPtr->coalescedHandlerCalls[key];
+    if (coalesced) {
+        qProtoDebug() << "Method: " << dPtr->service << method << " joins active call";
+        coalesced->handlers.push_back(handler);
+        return;
+    }
+
+    coalesced = std::make_shared<QAbstractGrpcClientPrivate::CoalescedCall>();
+    coalesced->handlers.push_back(handler);
+    QPointer<QAbstractGrpcClient> client(this);
+    dPtr->channel->callWithHandler(method, dPtr->service, arg, [client, key](const QGrpcStatus &status, const QByteArray &data) {
+        //Handlers are registered and completed in thread of client
+        auto complete = [client, key, status, data] {
+            if (client.isNull()) {
+                return;
+            }
+
+            std::shared_ptr<QAbstractGrpcClientPrivate::CoalescedCall> call = client->dPtr->coalescedHandlerCalls.take(key);
+            if (!call) {
+                return;
+            }
+
+            for (const auto &handler : call->handlers) {
+                handler(status, data);
+            }
+        };
+
+        if (client.isNull()) {
+            return;
+        }
+
+        if (client->thread() == QThread::currentThread()) {
+            complete();
+        } else {
+            QMetaObject::invokeMethod(client.data(), complete, Qt::QueuedConnection);
+        }
+    });
+}
+
 QGrpcStreamShared QAbstractGrpcClient::subscribe(const QString &method, const QByteArray &arg, const QtProtobuf::StreamHandler &handler)
 {
     QGrpcStreamShared stream;
@@ -138,50 +709,163 @@ QGrpcStreamShared QAbstractGrpcClient::subscribe(const QString &method, const QB
                                       return subscribe(method, arg, handler);
                                   }, Qt::BlockingQueuedConnection, &stream);
     } else if (dPtr->channel) {
-        stream.reset(new QGrpcStream(dPtr->channel, method, arg, handler, this), [](QGrpcStream *stream) { stream->deleteLater(); });
+        //Interceptors may modify argument of stream, so it's intercepted before stream to merge is looked up
+        QByteArray streamArg(arg);
+        std::function<bool(QByteArray &)> messageInterceptor;
+        QGrpcStatus interceptStatus = dPtr->interceptStream(method, streamArg, messageInterceptor);
+        if (interceptStatus.code() != QGrpcStatus::Ok) {
+            error(interceptStatus);
+            return stream;
+        }
 
-        auto it = std::find_if(std::begin(dPtr->activeStreams), std::end(dPtr->activeStreams), [stream](const QGrpcStreamShared &activeStream) {
-           return *activeStream == *stream;
-        });
+        const QPair<QString, QByteArray> key(method, streamArg);
+        auto it = dPtr->activeStreams.constFind(key);
+        if (it != dPtr->activeStreams.constEnd()) {
+            it.value()->addHandler(handler);
+            return it.value(); //If stream already exists return it for handling
+        }
 
-        if (it != std::end(dPtr->activeStreams)) {
-            (*it)->addHandler(handler);
-            return *it; //If stream already exists return it for handling
+        stream.reset(new QGrpcStream(dPtr->channel, method, streamArg, handler, this), [](QGrpcStream *stream) { stream->deleteLater(); });
+        stream->m_messageInterceptor = messageInterceptor;
+
+        //Streams are started without metadata, so trace context isn't sent. Span covers reconnections of stream.
+        QGrpcMetadata metadata;
+        stream->m_span = dPtr->startSpan(method, metadata);
+
+        //Every connection attempt of stream is recorded as call, messages of stream are recorded as they are received
+        std::shared_ptr<QGrpcMethodMetrics> metrics = dPtr->methodMetrics(method);
+        auto timer = std::make_shared<QElapsedTimer>();
+        if (metrics) {
+            metrics->callStarted(streamArg.size());
+            timer->start();
+            QGrpcStream *streamPtr = stream.get();
+            connect(streamPtr, &QGrpcStream::messageReceived, this, [streamPtr, metrics] {
+                metrics->streamMessageReceived(streamPtr->data().size());
+            });
         }
 
         auto errorConnection = std::make_shared<QMetaObject::Connection>();
-        *errorConnection = connect(stream.get(), &QGrpcStream::error, this, [this, stream](const QGrpcStatus &status) {
+        auto finishedConnection = std::make_shared<QMetaObject::Connection>();
+        //Stream is kept alive by connections until it's finished or not restored after error
+        auto releaseStream = [this, key, errorConnection, finishedConnection](const QGrpcStreamShared &stream) {
+            auto it = dPtr->activeStreams.find(key);
+            if (it != dPtr->activeStreams.end() && it.value() == stream) {
+                dPtr->activeStreams.erase(it);
+            }
+            QObject::disconnect(*errorConnection);
+            QObject::disconnect(*finishedConnection);
+        };
+
+        *errorConnection = connect(stream.get(), &QGrpcStream::error, this, [this, key, stream, releaseStream, metrics, timer](const QGrpcStatus &status) mutable {
             qProtoWarning() << stream->method() << "call" << dPtr->service << "stream error: " << status.message();
+            if (metrics) {
+                metrics->callFinished(status.code(), std::chrono::microseconds(timer->nsecsElapsed() / 1000), 0);
+            }
             error(status);
+
+            std::chrono::milliseconds delay(0);
+            std::shared_ptr<QGrpcReconnectPolicy> policy = stream->reconnectPolicy();
+            if (!policy || !policy->reconnectDelay(++stream->m_reconnectAttempts, status, delay)) {
+                qProtoWarning() << "Stream for" << dPtr->service << "method" << stream->method() << "will not be restored";
+                if (stream->m_span) {
+                    stream->m_span->finish(status);
+                }
+                releaseStream(stream);
+                stream.reset();
+                return;
+            }
+
+            qProtoDebug() << "Stream for" << dPtr->service << "method" << stream->method() << "will be restored in" << delay.count() << "ms";
             std::weak_ptr<QGrpcStream> weakStream = stream;
-            //TODO: Make timeout configurable from channel settings
-            QTimer::singleShot(1000, this, [this, weakStream, method = stream->method()] {
+            QTimer::singleShot(delay.count(), this, [this, key, weakStream, metrics, timer] {
                 auto stream = weakStream.lock();
-                if (stream) {
+                //Stream could be finished or cancelled, while reconnection was pending
+                if (stream && dPtr->activeStreams.value(key) == stream) {
+                    stream->prepareResume();
+                    if (metrics) {
+                        metrics->callStarted(stream->arg().size());
+                        timer->start();
+                    }
                     dPtr->channel->subscribe(stream.get(), dPtr->service, this);
-                } else {
-                    qProtoDebug() << "Stream for " << dPtr->service << "method" << method << " will not be restored by timeout.";
                 }
             });
         });
 
-        auto finishedConnection = std::make_shared<QMetaObject::Connection>();
-        *finishedConnection = connect(stream.get(), &QGrpcStream::finished, this, [this, stream, errorConnection, finishedConnection]() mutable {
+        *finishedConnection = connect(stream.get(), &QGrpcStream::finished, this, [this, stream, releaseStream, metrics, timer]() mutable {
             qProtoWarning() << stream->method() << "call" << dPtr->service << "stream finished";
-            auto it = std::find_if(std::begin(dPtr->activeStreams), std::end(dPtr->activeStreams), [stream](QGrpcStreamShared activeStream) {
-               return *activeStream == *stream;
+            if (metrics) {
+                metrics->callFinished(QGrpcStatus::Ok, std::chrono::microseconds(timer->nsecsElapsed() / 1000), 0);
+            }
+            if (stream->m_span) {
+                stream->m_span->finish(QGrpcStatus::Ok);
+            }
+            releaseStream(stream);
+            stream.reset();
+        });
+
+        dPtr->channel->subscribe(stream.get(), dPtr->service, this);
+        dPtr->activeStreams.insert(key, stream);
+    } else {
+        error({QGrpcStatus::Unknown, QLatin1String("No channel(s) attached.")});
+    }
+    return stream;
+}
+
+QGrpcClientStreamShared QAbstractGrpcClient::openStream(const QString &method)
+{
+    QGrpcClientStreamShared stream;
+    if (thread() != QThread::currentThread()) {
+        QMetaObject::invokeMethod(this, [&]()->QGrpcClientStreamShared {
+                                      qProtoDebug() << "Client stream: " << dPtr->service << method << " called from different thread";
+                                      return openStream(method);
+                                  }, Qt::BlockingQueuedConnection, &stream);
+    } else if (dPtr->channel) {
+        QByteArray streamArg;
+        std::function<bool(QByteArray &)> messageInterceptor;
+        QGrpcStatus interceptStatus = dPtr->interceptStream(method, streamArg, messageInterceptor);
+        if (interceptStatus.code() != QGrpcStatus::Ok) {
+            error(interceptStatus);
+            return stream;
+        }
+
+        stream.reset(new QGrpcClientStream(dPtr->channel, method, this), [](QGrpcClientStream *stream) { stream->deleteLater(); });
+        stream->m_messageInterceptor = messageInterceptor;
+
+        std::shared_ptr<QGrpcMethodMetrics> metrics = dPtr->methodMetrics(method);
+        QElapsedTimer timer;
+        if (metrics) {
+            metrics->callStarted(0);
+            timer.start();
+            QGrpcClientStream *streamPtr = stream.get();
+            connect(streamPtr, &QGrpcClientStream::messageReceived, this, [streamPtr, metrics] {
+                metrics->streamMessageReceived(streamPtr->data().size());
             });
+        }
 
-            if (it != std::end(dPtr->activeStreams)) {
-                dPtr->activeStreams.erase(it);
+        //Stream is kept alive until it's finished
+        auto errorConnection = std::make_shared<QMetaObject::Connection>();
+        auto finishedConnection = std::make_shared<QMetaObject::Connection>();
+        *errorConnection = connect(stream.get(), &QGrpcClientStream::error, this, [this, stream, errorConnection, finishedConnection, metrics, timer](const QGrpcStatus &status) mutable {
+            qProtoWarning() << stream->method() << "call" << dPtr->service << "client stream error: " << status.message();
+            if (metrics) {
+                metrics->callFinished(status.code(), std::chrono::microseconds(timer.nsecsElapsed() / 1000), 0);
             }
+            error(status);
+            QObject::disconnect(*finishedConnection);
             QObject::disconnect(*errorConnection);
+            stream.reset();
+        });
+
+        *finishedConnection = connect(stream.get(), &QGrpcClientStream::finished, this, [stream, errorConnection, finishedConnection, metrics, timer]() mutable {
+            if (metrics) {
+                metrics->callFinished(QGrpcStatus::Ok, std::chrono::microseconds(timer.nsecsElapsed() / 1000), 0);
+            }
             QObject::disconnect(*finishedConnection);
+            QObject::disconnect(*errorConnection);
             stream.reset();
         });
 
-        dPtr->channel->subscribe(stream.get(), dPtr->service, this);
-        dPtr->activeStreams.push_back(stream);
+        dPtr->channel->openStream(stream.get(), dPtr->service, this);
     } else {
         error({QGrpcStatus::Unknown, QLatin1String("No channel(s) attached.")});
     }
@@ -192,3 +876,8 @@ QAbstractProtobufSerializer *QAbstractGrpcClient::serializer() const
 {
     return dPtr->serializer.get();
 }
+
+std::shared_ptr<QAbstractProtobufSerializer> QAbstractGrpcClient::sharedSerializer() const
+{
+    return dPtr->serializer;
+}
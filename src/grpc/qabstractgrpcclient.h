@@ -28,6 +28,7 @@
 #include <memory>
 #include <functional>
 #include <type_traits>
+#include <vector>
 
 #include <QObject>
 #include <QPointer>
@@ -35,8 +36,11 @@
 
 #include <qtprotobuflogging.h>
 #include <qabstractprotobufserializer.h>
+#include <qprotobufbufferallocator.h>
 
 #include "qabstractgrpcchannel.h"
+#include "qgrpccalloptions.h"
+#include "qgrpctracer.h"
 
 #include "qtgrpcglobal.h"
 
@@ -48,15 +52,27 @@ namespace QtProtobuf {
 
 class QGrpcAsyncReply;
 class QGrpcStream;
+class QGrpcClientStream;
 class QGrpcAsyncOperationBase;
 class QAbstractGrpcChannel;
 class QAbstractGrpcClientPrivate;
+class QGrpcMetrics;
+class QGrpcClientInterceptor;
 
 /*!
  * \private
  */
 using StreamHandler = std::function<void(const QByteArray&)>;
 
+/*!
+ * \private
+ * \brief Message decoded from stream update once and shared by all handlers of the stream
+ */
+struct QGrpcDecodedStreamMessage {
+    std::shared_ptr<void> message;
+    QGrpcStatus status;
+};
+
 /*!
  * \ingroup QtGrpc
  * \brief The QAbstractGrpcClient class is bridge between gRPC clients and channels. QAbstractGrpcClient provides set of
@@ -71,12 +87,96 @@ public:
      * \brief Attaches \a channel to client as transport layer for gRPC. Parameters and return values will be serialized
      *        to supported by channel format.
      * \note \b Warning: QtGrpc doesn't guarantie thread safety on channel level.
-     *       You have to be confident that channel routines are working in the same thread as QAbstractGrpcClient.
+     *       You have to be confident that channel routines are working in the same thread as QAbstractGrpcClient,
+     *       unless channel is thread-safe.
      * \see QAbstractGrcpChannel
+     * \see QAbstractGrpcChannel::isThreadSafe
      * \param channel Shared pointer to channel will be used as transport layer for gRPC
      */
     void attachChannel(const std::shared_ptr<QAbstractGrpcChannel> &channel);
 
+    /*!
+     * \brief Enables merge of server-stream updates into preallocated return-messages
+     * \details When enabled, only fields that are stored in received update are written to return-message
+     *          and NOTIFY signals are emitted only for fields which values are changed. Repeated and map fields
+     *          that are stored in update replace existing values. Note that fields that have default values
+     *          are not stored in update, so they are never reset. Disabled by default, return-message is
+     *          fully replaced by each update.
+     * \see QAbstractProtobufSerializer::merge
+     */
+    void setStreamMergeEnabled(bool enabled);
+    bool isStreamMergeEnabled() const;
+
+    /*!
+     * \brief Enables deserialization of server-stream updates in background thread
+     * \details When enabled, updates of preallocated return-messages are deserialized in background thread and
+     *          fully decoded message is assigned to return-message in thread of client. Updates are applied in order
+     *          they are received. Keeps thread of client responsive, when large messages are received. Merged
+     *          updates are always deserialized in thread of client. Disabled by default.
+     * \see setStreamMergeEnabled
+     * \see QGrpcAsyncOperationBase::readInBackground
+     */
+    void setBackgroundDeserializationEnabled(bool enabled);
+    bool isBackgroundDeserializationEnabled() const;
+
+    /*!
+     * \brief Enables multi-threaded mode of client
+     * \details When enabled and attached channel is thread-safe, asynchronous calls made from other threads are passed
+     *          to channel directly instead of being marshalled through thread of client. QGrpcAsyncReply of such call
+     *          is owned by calling thread and delivers its signals there, so calling thread has to run event loop or
+     *          wait for QGrpcAsyncReply::future(). Streams are always started in thread of client. Synchronous calls
+     *          are passed to thread-safe channels directly regardless of this option. Disabled by default.
+     * \see QAbstractGrpcChannel::isThreadSafe
+     */
+    void setMultiThreadingEnabled(bool enabled);
+    bool isMultiThreadingEnabled() const;
+
+    /*!
+     * \brief Enables coalescing of identical asynchronous calls
+     * \details When enabled, asynchronous call of method with the same serialized arguments as call that is in
+     *          progress doesn't make new request, but joins the active one. Response of the request is delivered
+     *          to every joined call. Aborting one of joined calls doesn't affect the others, request is cancelled
+     *          once all joined calls are aborted or destroyed. Applies to calls made in thread of client. Use it only
+     *          for idempotent methods. Disabled by default.
+     */
+    void setCallCoalescingEnabled(bool enabled);
+    bool isCallCoalescingEnabled() const;
+
+    /*!
+     * \brief Sets \p metrics, that calls and streams of client are recorded to. Metrics are not recorded by default.
+     * \details Metrics may be shared by multiple clients. Metrics have to be set before calls are made.
+     *          nullptr disables recording of metrics.
+     */
+    void setMetrics(const std::shared_ptr<QGrpcMetrics> &metrics);
+    std::shared_ptr<QGrpcMetrics> metrics() const;
+
+    /*!
+     * \brief Sets \p tracer, that creates spans of calls and streams of client. Calls are not traced by default.
+     * \details Tracer may be shared by multiple clients. Tracer has to be set before calls are made.
+     *          nullptr disables tracing.
+     * \see QGrpcSpan
+     */
+    void setTracer(const std::shared_ptr<QGrpcTracer> &tracer);
+    std::shared_ptr<QGrpcTracer> tracer() const;
+
+    /*!
+     * \brief Appends \p interceptor to chain of interceptors, that calls and streams of client pass through
+     * \details Interceptors may be shared by multiple clients. Interceptors have to be added before calls are made.
+     *          Metrics and spans of tracer are recorded outside of interceptors, for calls as they are seen by client.
+     * \see QGrpcClientInterceptor
+     */
+    void addInterceptor(const std::shared_ptr<QGrpcClientInterceptor> &interceptor);
+
+    /*!
+     * \brief Removes \p interceptor from chain of interceptors
+     */
+    void removeInterceptor(const std::shared_ptr<QGrpcClientInterceptor> &interceptor);
+
+    /*!
+     * \brief Returns interceptors of client in order they are invoked
+     */
+    std::vector<std::shared_ptr<QGrpcClientInterceptor>> interceptors() const;
+
 signals:
     /*!
      * \brief error signal is emited by client when error occured in channel or while serialization/deserialization
@@ -99,22 +199,40 @@ protected:
     template<typename A, typename R>
     QGrpcStatus call(const QString &method, const A &arg, const QPointer<R> &ret) {
         QGrpcStatus status{QGrpcStatus::Ok};
+        static const QString errorString("Unable to call method: %1. Pointer to return data is null");
         if (ret.isNull()) {
-            static const QString errorString("Unable to call method: %1. Pointer to return data is null");
             status = QGrpcStatus{QGrpcStatus::InvalidArgument, errorString.arg(method)};
             error(status);
             qProtoCritical() << errorString.arg(method);
             return status;
         }
 
+        QByteArray argData = arg.serialize(serializer());
         QByteArray retData;
-        status = call(method, arg.serialize(serializer()), retData);
+        status = call(method, argData, retData);
+        //Serialized argument is not used after synchronous call, its buffer is reused by next serializations
+        QProtobufBufferAllocator::current()->release(std::move(argData));
         if (status == QGrpcStatus::StatusCode::Ok) {
+            //Call may be made from other thread, so return data could be destroyed while call was in progress
+            if (ret.isNull()) {
+                status = QGrpcStatus{QGrpcStatus::InvalidArgument, errorString.arg(method)};
+                error(status);
+                return status;
+            }
             return tryDeserialize(*ret, retData);
         }
         return status;
     }
 
+    /*!
+     * \private
+     * \brief Deserializes message received by finished \p reply directly into \p ret, without intermediate copy
+     */
+    template<typename R>
+    QGrpcStatus readReply(const QGrpcAsyncReplyShared &reply, R &ret) {
+        return tryDeserialize(ret, reply->data());
+    }
+
     /*!
      * \private
      * \brief Calls \p method of service client asynchronously and returns pointer to assigned to call AsyncReply
@@ -126,6 +244,47 @@ protected:
         return call(method, arg.serialize(serializer()));
     }
 
+    /*!
+     * \private
+     * \brief Calls \p method of service client asynchronously with call \p options and returns pointer to assigned to
+     *        call AsyncReply
+     * \param[in] method Name of the method to be called
+     * \param[in] arg Protobuf message argument for \p method
+     * \param[in] options Options of call, that override options of channel
+     */
+    template<typename A>
+    QGrpcAsyncReplyShared call(const QString &method, const A &arg, const QGrpcCallOptions &options) {
+        return call(method, arg.serialize(serializer()), options);
+    }
+
+    /*!
+     * \private
+     * \brief Calls \p method of service client asynchronously and passes status of call and returned message to \p callback
+     * \details Lightweight alternative of QGrpcAsyncReply based call: neither reply object nor signal connections
+     *          are created for the call, so call can't be aborted. \p callback is invoked in thread of channel operation,
+     *          that is thread of client, unless multi-threading is enabled.
+     * \param[in] method Name of the method to be called
+     * \param[in] arg Protobuf message argument for \p method
+     * \param[in] callback Invoked once, when call is completed
+     */
+    template<typename A, typename R>
+    void call(const QString &method, const A &arg, const std::function<void(const QGrpcStatus &, R &&)> &callback) {
+        std::shared_ptr<QAbstractProtobufSerializer> serializer = sharedSerializer();
+        QPointer<QAbstractGrpcClient> client(this);
+        callWithHandler(method, arg.serialize(serializer.get()), [serializer, client, callback](const QGrpcStatus &status, const QByteArray &data) {
+            R ret;
+            QGrpcStatus callStatus = status;
+            if (callStatus == QGrpcStatus::Ok) {
+                callStatus = deserializeMessage(serializer.get(), ret, data);
+            }
+
+            if (callStatus != QGrpcStatus::Ok && !client.isNull()) {
+                client->error(callStatus);
+            }
+            callback(callStatus, std::move(ret));
+        });
+    }
+
     /*!
      * \private
      * \brief Subscribes to message notifications from server-stream with given message argument \a arg
@@ -148,6 +307,7 @@ protected:
      *        time message update recevied from server-stream.
      * \note If \p ret is used as property-fields in other object, property NOTIFY signal won't be called in case of
      *       updated message recevied from server-stream
+     * \see setStreamMergeEnabled
      */
     template<typename A, typename R>
     QGrpcStreamShared subscribe(const QString &method, const A &arg, const QPointer<R> &ret) {
@@ -158,17 +318,44 @@ protected:
             return nullptr;
         }
 
-        return subscribe(method, arg.serialize(serializer()), [ret, this](const QByteArray &data) {
-            if (!ret.isNull()) {
-                tryDeserialize(*ret, data);
+        //Stream is assigned once it's created or found, it's used to share decoded messages between handlers of stream
+        auto stream = std::make_shared<std::weak_ptr<QGrpcStream>>();
+        QGrpcStreamShared result = subscribe(method, arg.serialize(serializer()), [ret, stream, this](const QByteArray &data) {
+            if (!ret.isNull() && isBackgroundDeserializationEnabled() && !isStreamMergeEnabled()) {
+                QPointer<QAbstractGrpcClient> client(this);
+                deserializeInBackground<R>(sharedSerializer(), data, this, [ret](const R &value) {
+                    if (!ret.isNull()) {
+                        *ret = value;
+                    }
+                }, [client](const QGrpcStatus &status) {
+                    if (!client.isNull()) {
+                        client->error(status);
+                    }
+                });
+            } else if (!ret.isNull()) {
+                if (isStreamMergeEnabled()) {
+                    tryDeserialize(*ret, data, MergeMessage);
+                } else {
+                    tryDeserializeStreamMessage(stream->lock().get(), *ret, data);
+                }
             } else {
                 static const QLatin1String nullPointerError("Pointer to return data is null while stream update received");
                 error({QGrpcStatus::InvalidArgument, nullPointerError});
                 qProtoCritical() << nullPointerError;
             }
         });
+        *stream = result;
+        return result;
     }
 
+    /*!
+     * \private
+     * \brief Opens client-streaming or bidirectional-streaming call of \p method
+     * \param[in] method Name of the method to be called
+     * \return client stream, that is used to write messages to server and to read messages of server
+     */
+    QGrpcClientStreamShared openStream(const QString &method);
+
     /*!
      * \brief Canceles all streams for specified \p method
      * \param[in] method Name of method stream for to be canceled
@@ -181,43 +368,201 @@ protected:
      */
     QAbstractProtobufSerializer *serializer() const;
 
+    //! \private
+    //! \brief Returns serializer of attached channel, that is shared with jobs that may outlive the channel or client
+    std::shared_ptr<QAbstractProtobufSerializer> sharedSerializer() const;
+
     friend class QGrpcAsyncOperationBase;
+    friend class QGrpcInProcessChannel;
+    friend class QAbstractGrpcService;
 private:
     //!\private
     QGrpcStatus call(const QString &method, const QByteArray &arg, QByteArray &ret);
 
     //!\private
-    QGrpcAsyncReplyShared call(const QString &method, const QByteArray &arg);
+    QGrpcAsyncReplyShared call(const QString &method, const QByteArray &arg, const QGrpcCallOptions &options = {});
+
+    //!\private
+    void callWithHandler(const QString &method, const QByteArray &arg, const CallHandler &handler);
+
+    //!\private
+    //!\brief Joins \p reply to active call of \p method with the same \p arg or starts new call
+    void coalesceCall(const QString &method, const QByteArray &arg, const QGrpcAsyncReplyShared &reply);
+
+    //!\private
+    //!\brief Passes call of \p method with \p reply through interceptors, every attempt is made with own internal reply
+    void interceptCall(const QString &method, const QByteArray &arg, const QGrpcAsyncReplyShared &reply);
+
+    //!\private
+    //!\brief Starts call of \p method by channel with internal \p request, coalescing it if enabled
+    void startCall(const QString &method, const QByteArray &arg, const QGrpcAsyncReplyShared &request);
+
+    //!\private
+    //!\brief Joins \p handler to active call of \p method with the same \p arg or starts new call
+    void coalesceCall(const QString &method, const QByteArray &arg, const CallHandler &handler);
 
     //!\private
     QGrpcStreamShared subscribe(const QString &method, const QByteArray &arg, const QtProtobuf::StreamHandler &handler = {});
 
+    /*!
+     * \private
+     * \brief Defines how received message is written to existing return value
+     */
+    enum DeserializationMode {
+        ReplaceMessage,//!< Return value is replaced by received message
+        MergeMessage,//!< Received message is merged into return value
+        ReuseMessage//!< Return value is replaced by received message in place, its nested objects are reused
+    };
+
     /*!
      * \private
      * \brief Deserialization helper
+     * \param mode Defines how \p retData is written to \p ret
      */
     template<typename R>
-    QGrpcStatus tryDeserialize(R &ret, const QByteArray &retData) {
+    QGrpcStatus tryDeserialize(R &ret, const QByteArray &retData, DeserializationMode mode = ReplaceMessage) {
+        QGrpcStatus status = deserializeMessage(serializer(), ret, retData, mode);
+        if (status.code() != QGrpcStatus::Ok) {
+            error(status);
+        }
+        return status;
+    }
+
+    /*!
+     * \private
+     * \brief Deserializes update \p data of \p stream. If \p stream has several handlers, \p data is deserialized
+     *        once and decoded message is copied to \p ret of each handler.
+     */
+    template<typename R>
+    QGrpcStatus tryDeserializeStreamMessage(QGrpcStream *stream, R &ret, const QByteArray &data) {
+        QGrpcDecodedStreamMessage *decoded = decodedStreamMessage(stream, qMetaTypeId<R>());
+        if (decoded == nullptr) {
+            //Return value lives as long as stream, so its nested objects are reused by each update
+            traceStreamEvent(stream, QGrpcSpan::DeserializationStarted);
+            QGrpcStatus status = tryDeserialize(ret, data, ReuseMessage);
+            traceStreamEvent(stream, QGrpcSpan::DeserializationFinished);
+            return status;
+        }
+
+        if (!decoded->message) {
+            std::shared_ptr<R> value = std::make_shared<R>();
+            traceStreamEvent(stream, QGrpcSpan::DeserializationStarted);
+            decoded->status = deserializeMessage(serializer(), *value, data);
+            traceStreamEvent(stream, QGrpcSpan::DeserializationFinished);
+            decoded->message = value;
+            if (decoded->status.code() != QGrpcStatus::Ok) {
+                error(decoded->status);
+            }
+        }
+
+        if (decoded->status.code() == QGrpcStatus::Ok) {
+            ret = *std::static_pointer_cast<R>(decoded->message);
+        }
+        return decoded->status;
+    }
+
+    /*!
+     * \private
+     * \brief Returns message of \p type decoded from current update of \p stream, or nullptr if \p stream has
+     *        single handler and there is nothing to share
+     */
+    static QGrpcDecodedStreamMessage *decodedStreamMessage(QGrpcStream *stream, int type);
+
+    //! \private
+    //! \brief Records \p event in span of \p stream, if stream is traced
+    static void traceStreamEvent(QGrpcStream *stream, QGrpcSpan::Event event);
+
+    /*!
+     * \private
+     * \brief Deserializes \p retData to \p ret, doesn't emit error signal, so may be called from any thread
+     */
+    template<typename R>
+    static QGrpcStatus deserializeMessage(QAbstractProtobufSerializer *serializer, R &ret, const QByteArray &retData,
+                                          DeserializationMode mode = ReplaceMessage) {
         QGrpcStatus status{QGrpcStatus::Ok};
+        QtProtobuf::DeserializationError deserializationError = QtProtobuf::NoDeserializationError;
+#ifndef QT_PROTOBUF_NO_EXCEPTIONS
         try {
-            ret.deserialize(serializer(), retData);
-        } catch (std::invalid_argument &) {
-            static const QLatin1String invalidArgumentErrorMessage("Response deserialization failed invalid field found");
-            status = {QGrpcStatus::InvalidArgument, invalidArgumentErrorMessage};
-            error(status);
-            qProtoCritical() << invalidArgumentErrorMessage;
-        } catch (std::out_of_range &) {
+#endif
+            QtProtobufPrivate::DeserializationErrorScope scope;
+            switch (mode) {
+            case MergeMessage:
+                ret.merge(serializer, retData);
+                break;
+            case ReuseMessage:
+                serializer->deserializeReusing(&ret, retData);
+                break;
+            default:
+                ret.deserialize(serializer, retData);
+                break;
+            }
+            deserializationError = scope.error();
+#ifndef QT_PROTOBUF_NO_EXCEPTIONS
+        } catch (...) {
+            return {QGrpcStatus::Internal, QLatin1String("Unknown exception caught during deserialization")};
+        }
+#endif
+        switch (deserializationError) {
+        case QtProtobuf::NoDeserializationError:
+            break;
+        case QtProtobuf::UnexpectedEndOfStreamError: {
             static const QLatin1String outOfRangeErrorMessage("Invalid size of received buffer");
             status = {QGrpcStatus::OutOfRange, outOfRangeErrorMessage};
-            error(status);
             qProtoCritical() << outOfRangeErrorMessage;
-        } catch (...) {
-            status = {QGrpcStatus::Internal, QLatin1String("Unknown exception caught during deserialization")};
-            error(status);
+        }
+            break;
+        case QtProtobuf::LimitExceededError: {
+            static const QLatin1String limitExceededErrorMessage("Received message exceeds deserialization limits");
+            status = {QGrpcStatus::ResourceExhausted, limitExceededErrorMessage};
+            qProtoCritical() << limitExceededErrorMessage;
+        }
+            break;
+        default: {
+            static const QLatin1String invalidArgumentErrorMessage("Response deserialization failed invalid field found");
+            status = {QGrpcStatus::InvalidArgument, invalidArgumentErrorMessage};
+            qProtoCritical() << invalidArgumentErrorMessage;
+        }
+            break;
         }
         return status;
     }
 
+    /*!
+     * \private
+     * \brief Deserializes \p data in background thread and invokes \p callback with decoded message or \p errorCallback
+     *        in thread of \p context. Callbacks are not invoked if \p context is destroyed in meantime.
+     *        \p serializer is shared with the job, so it may be detached from client while message is deserialized.
+     *        Messages are deserialized and delivered in order this method is called.
+     */
+    template<typename R>
+    static void deserializeInBackground(const std::shared_ptr<QAbstractProtobufSerializer> &serializer, const QByteArray &data, QObject *context,
+                                        const std::function<void(const R &)> &callback,
+                                        const std::function<void(const QGrpcStatus &)> &errorCallback) {
+        //Courier is released in thread of context, after result is delivered
+        std::shared_ptr<QObject> courier(new QObject, [](QObject *courier) { courier->deleteLater(); });
+        courier->moveToThread(context->thread());
+        QPointer<QObject> receiver(context);
+        runInBackground([serializer, data, courier, receiver, callback, errorCallback]() {
+            std::shared_ptr<R> value = std::make_shared<R>();
+            QGrpcStatus status = deserializeMessage(serializer.get(), *value, data);
+            value->moveToThread(courier->thread());
+            QMetaObject::invokeMethod(courier.get(), [value, status, receiver, callback, errorCallback]() {
+                if (receiver.isNull()) {
+                    return;
+                }
+
+                if (status.code() == QGrpcStatus::Ok) {
+                    callback(*value);
+                } else {
+                    errorCallback(status);
+                }
+            }, Qt::QueuedConnection);
+        });
+    }
+
+    //! \private
+    static void runInBackground(const std::function<void()> &task);
+
     Q_DISABLE_COPY_MOVE(QAbstractGrpcClient)
 
     std::unique_ptr<QAbstractGrpcClientPrivate> dPtr;
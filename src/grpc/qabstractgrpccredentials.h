@@ -42,4 +42,10 @@ public:
     virtual QGrpcCredentialMap callCredentials() = 0;
     virtual QGrpcCredentialMap channelCredentials() = 0;
 };
+
+//! \private
+//! \brief Returns value of call credential, that is sent as header. Pre-encoded QByteArray values are sent as is.
+inline QByteArray qGrpcCredentialHeaderValue(const QVariant &value) {
+    return value.userType() == QMetaType::QByteArray ? value.toByteArray() : value.toString().toUtf8();
+}
 }
@@ -0,0 +1,88 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qabstractgrpcservice.h"
+
+#include <QHash>
+
+#include "qprotobufserializerregistry_p.h"
+#include "qtprotobuflogging.h"
+
+using namespace QtProtobuf;
+
+namespace QtProtobuf {
+
+//! \private
+struct QAbstractGrpcServicePrivate {
+    QAbstractGrpcServicePrivate(const QString &_service) : service(_service)
+      , serializer(QProtobufSerializerRegistry::instance().getSerializer("protobuf"))
+    {
+    }
+
+    QString service;
+    //Handlers are registered before service is hosted, so they are accessed without lock
+    QHash<QString, QAbstractGrpcService::MethodHandler> handlers;
+    std::shared_ptr<QAbstractProtobufSerializer> serializer;
+};
+
+}
+
+QAbstractGrpcService::QAbstractGrpcService(const QString &service) : dPtr(std::make_unique<QAbstractGrpcServicePrivate>(service))
+{
+}
+
+QAbstractGrpcService::~QAbstractGrpcService()
+{
+}
+
+QString QAbstractGrpcService::serviceName() const
+{
+    return dPtr->service;
+}
+
+QStringList QAbstractGrpcService::methods() const
+{
+    return dPtr->handlers.keys();
+}
+
+QGrpcStatus QAbstractGrpcService::handle(const QString &method, const QByteArray &args, QByteArray &ret) const
+{
+    auto it = dPtr->handlers.constFind(method);
+    if (it == dPtr->handlers.constEnd()) {
+        qProtoWarning() << "Method" << method << "is not implemented by service" << dPtr->service;
+        return {QGrpcStatus::Unimplemented, QString("%1 method of %2 service is not implemented").arg(method).arg(dPtr->service)};
+    }
+    return it.value()(args, ret);
+}
+
+void QAbstractGrpcService::registerMethod(const QString &method, const MethodHandler &handler)
+{
+    dPtr->handlers.insert(method, handler);
+}
+
+QAbstractProtobufSerializer *QAbstractGrpcService::serializer() const
+{
+    return dPtr->serializer.get();
+}
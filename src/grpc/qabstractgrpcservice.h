@@ -0,0 +1,118 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QAbstractGrpcService
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+#include <memory>
+
+#include "qabstractgrpcclient.h"
+#include "qgrpcstatus.h"
+#include "qtgrpcglobal.h"
+
+namespace QtProtobuf {
+
+struct QAbstractGrpcServicePrivate;
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QAbstractGrpcService class is base of generated server classes, that implement gRPC services
+ * \details Generated server class registers unary methods of service in constructor. Implementation of service
+ *          inherits generated class and implements its pure virtual methods. Service is hosted using QGrpcServer
+ *          or QGrpcInProcessChannel.
+ *          \note Methods of service may be invoked concurrently from multiple threads, so implementation of
+ *          service has to be thread-safe.
+ */
+class Q_GRPC_EXPORT QAbstractGrpcService
+{
+public:
+    /*!
+     * \brief Handler of method, that receives serialized argument message \p args and writes serialized result of call to \p ret
+     */
+    using MethodHandler = std::function<QGrpcStatus(const QByteArray &args, QByteArray &ret)>;
+
+    virtual ~QAbstractGrpcService();
+
+    /*!
+     * \brief Returns full name of service, e.g. "qtprotobufnamespace.tests.TestService"
+     */
+    QString serviceName() const;
+
+    /*!
+     * \brief Returns names of methods that are registered by service
+     */
+    QStringList methods() const;
+
+    /*!
+     * \brief Invokes \p method of service with serialized argument message \p args and writes serialized result
+     *        of call to \p ret. Returns QGrpcStatus::Unimplemented if method isn't registered by service.
+     */
+    QGrpcStatus handle(const QString &method, const QByteArray &args, QByteArray &ret) const;
+
+protected:
+    //! \private
+    QAbstractGrpcService(const QString &service);
+
+    /*!
+     * \brief Registers \p handler of \p method. Methods have to be registered before service is hosted.
+     */
+    void registerMethod(const QString &method, const MethodHandler &handler);
+
+    /*!
+     * \brief Registers \p method, that is implemented by \p handler member function of service. Argument message
+     *        is deserialized and returned message is serialized using protobuf serializer.
+     */
+    template<typename S, typename A, typename R>
+    void registerMethod(const QString &method, QGrpcStatus (S::*handler)(const A &, R &)) {
+        S *service = static_cast<S *>(this);
+        registerMethod(method, [this, service, handler](const QByteArray &args, QByteArray &ret) -> QGrpcStatus {
+            A arg;
+            QGrpcStatus status = QAbstractGrpcClient::deserializeMessage(serializer(), arg, args);
+            if (status.code() != QGrpcStatus::Ok) {
+                return status;
+            }
+
+            R result;
+            status = (service->*handler)(arg, result);
+            if (status.code() == QGrpcStatus::Ok) {
+                ret = result.serialize(serializer());
+            }
+            return status;
+        });
+    }
+
+private:
+    Q_DISABLE_COPY_MOVE(QAbstractGrpcService)
+
+    QAbstractProtobufSerializer *serializer() const;
+
+    std::unique_ptr<QAbstractGrpcServicePrivate> dPtr;
+};
+
+}
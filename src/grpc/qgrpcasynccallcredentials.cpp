@@ -0,0 +1,153 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qgrpcasynccallcredentials.h"
+
+#include <QDeadlineTimer>
+#include <QMutex>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include "qtprotobuflogging.h"
+
+namespace QtProtobuf {
+
+//! \private
+class QGrpcCredentialsFetchTask final : public QRunnable {
+public:
+    QGrpcCredentialsFetchTask(const std::function<void()> &task) : m_task(task) {}
+    void run() override {
+        m_task();
+    }
+
+private:
+    std::function<void()> m_task;
+};
+
+//! \private
+struct QGrpcAsyncCallCredentialsPrivate : public std::enable_shared_from_this<QGrpcAsyncCallCredentialsPrivate> {
+    QGrpcAsyncCallCredentialsPrivate(const QGrpcAsyncCallCredentials::Fetcher &_fetcher, std::chrono::milliseconds _refreshAhead) :
+        fetcher(_fetcher)
+      , refreshAhead(_refreshAhead)
+      , expiry(0)
+    {}
+
+    //! \brief Starts fetcher in thread pool, has to be called with mutex locked
+    void startRefresh() {
+        if (refreshing) {
+            return;
+        }
+        refreshing = true;
+
+        //Fetch keeps credentials alive, so result is not lost if all copies of credentials are destroyed
+        std::shared_ptr<QGrpcAsyncCallCredentialsPrivate> self = shared_from_this();
+        QThreadPool::globalInstance()->start(new QGrpcCredentialsFetchTask([self] {
+            QGrpcCredentialMap fetched;
+            std::chrono::milliseconds validity(0);
+            const bool ok = self->fetcher(fetched, validity);
+
+            QMutexLocker locker(&self->mutex);
+            if (ok) {
+                self->credentials = fetched;
+                if (validity.count() > 0) {
+                    self->expiry.setRemainingTime(validity.count());
+                } else {
+                    self->expiry = QDeadlineTimer(QDeadlineTimer::Forever);
+                }
+            } else {
+                qProtoWarning() << "Fetch of call credentials failed";
+            }
+            self->refreshing = false;
+            self->refreshed.wakeAll();
+        }));
+    }
+
+    //! \brief Returns true if cached credentials are not expired, has to be called with mutex locked
+    bool isValid() const {
+        return !expiry.hasExpired();
+    }
+
+    const QGrpcAsyncCallCredentials::Fetcher fetcher;
+    const std::chrono::milliseconds refreshAhead;
+    QMutex mutex;
+    QWaitCondition refreshed;
+    QGrpcCredentialMap credentials;
+    QDeadlineTimer expiry;
+    bool refreshing = false;
+};
+
+}
+
+using namespace QtProtobuf;
+
+QGrpcAsyncCallCredentials::QGrpcAsyncCallCredentials(const Fetcher &fetcher, std::chrono::milliseconds refreshAhead) :
+    dPtr(std::make_shared<QGrpcAsyncCallCredentialsPrivate>(fetcher, refreshAhead))
+{
+    refresh();
+}
+
+QGrpcAsyncCallCredentials::~QGrpcAsyncCallCredentials() = default;
+
+QGrpcAsyncCallCredentials::QGrpcAsyncCallCredentials(const QGrpcAsyncCallCredentials &other) : dPtr(other.dPtr)
+{
+}
+
+QGrpcAsyncCallCredentials &QGrpcAsyncCallCredentials::operator =(const QGrpcAsyncCallCredentials &other)
+{
+    dPtr = other.dPtr;
+    return *this;
+}
+
+void QGrpcAsyncCallCredentials::refresh()
+{
+    QMutexLocker locker(&dPtr->mutex);
+    dPtr->startRefresh();
+}
+
+bool QGrpcAsyncCallCredentials::isValid() const
+{
+    QMutexLocker locker(&dPtr->mutex);
+    return dPtr->isValid();
+}
+
+QGrpcCredentialMap QGrpcAsyncCallCredentials::operator()()
+{
+    QMutexLocker locker(&dPtr->mutex);
+    if (dPtr->isValid()) {
+        if (!dPtr->expiry.isForever() && dPtr->expiry.remainingTime() <= dPtr->refreshAhead.count()) {
+            dPtr->startRefresh();
+        }
+        return dPtr->credentials;
+    }
+
+    //Call is held only while credentials are actually missing. Calls that wait for the same fetch share its
+    //result, so failed fetch isn't repeated by every waiting call.
+    dPtr->startRefresh();
+    while (dPtr->refreshing) {
+        dPtr->refreshed.wait(&dPtr->mutex);
+    }
+    return dPtr->credentials;
+}
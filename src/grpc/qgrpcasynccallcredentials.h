@@ -0,0 +1,98 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QGrpcAsyncCallCredentials
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+#include "qgrpccredentials.h"
+#include "qtgrpcglobal.h"
+
+namespace QtProtobuf {
+
+struct QGrpcAsyncCallCredentialsPrivate;
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcAsyncCallCredentials class provides call credentials, that expire and are refreshed in background
+ * \details Credentials, e.g. access token, are obtained by fetcher, that is invoked in thread of
+ *          QThreadPool::globalInstance(), so slow token refresh doesn't block calls. Fetched credentials are cached
+ *          together with their validity and are refreshed ahead of expiry. Calls wait for fetcher only when no
+ *          valid credentials are cached, e.g. before the first fetch is completed or if refresh failed until
+ *          credentials expired.
+ *          \code{.cpp}
+ *          QtProtobuf::QGrpcAsyncCallCredentials tokenCredentials([](QtProtobuf::QGrpcCredentialMap &credentials,
+ *                                                                    std::chrono::milliseconds &validity) {
+ *              Token token = fetchToken(); //Blocking request to authorization server
+ *              credentials = {{QLatin1String("authorization"), QVariant::fromValue(QByteArray("Bearer ") + token.value)}};
+ *              validity = token.validity;
+ *              return token.isValid();
+ *          });
+ *          auto channel = std::make_shared<QtProtobuf::QGrpcHttp2Channel>(url, tokenCredentials | QtProtobuf::QGrpcSslCredentials(sslConfig));
+ *          \endcode
+ *          Values of credentials should be pre-encoded as QByteArray, they are sent as is then. Copies of
+ *          credentials share the same cache.
+ */
+class Q_GRPC_EXPORT QGrpcAsyncCallCredentials final : public QGrpcCallCredentials
+{
+public:
+    /*!
+     * \brief Fetches \a credentials and their \a validity, returns false if credentials are not fetched
+     */
+    using Fetcher = std::function<bool(QGrpcCredentialMap &credentials, std::chrono::milliseconds &validity)>;
+
+    /*!
+     * \brief Constructs credentials and starts the first fetch
+     * \param fetcher function that fetches credentials, it's invoked in thread of QThreadPool::globalInstance()
+     * \param refreshAhead time before expiry of credentials, when they are refreshed
+     */
+    QGrpcAsyncCallCredentials(const Fetcher &fetcher, std::chrono::milliseconds refreshAhead = std::chrono::seconds(30));
+    ~QGrpcAsyncCallCredentials();
+
+    QGrpcAsyncCallCredentials(const QGrpcAsyncCallCredentials &other);
+    QGrpcAsyncCallCredentials &operator =(const QGrpcAsyncCallCredentials &other);
+
+    /*!
+     * \brief Starts refresh of credentials in background, if it's not in progress already
+     */
+    void refresh();
+
+    /*!
+     * \brief Returns true if credentials are fetched and not expired
+     */
+    bool isValid() const;
+
+    //!\private
+    //! \brief Returns cached credentials, waits for fetcher only if credentials are expired. Cached map is
+    //!        implicitly shared, so channel compares credentials of consecutive calls without comparing values.
+    QGrpcCredentialMap operator()();
+
+private:
+    std::shared_ptr<QGrpcAsyncCallCredentialsPrivate> dPtr;
+};
+
+}
@@ -27,12 +27,19 @@
 
 #include <qtprotobuflogging.h>
 
+#include <QThread>
+
 using namespace QtProtobuf;
 
+QGrpcAsyncOperationBase::QGrpcAsyncOperationBase(const std::shared_ptr<QAbstractGrpcChannel> &channel, QAbstractGrpcClient *client) :
+    QObject(client->thread() == QThread::currentThread() ? client : nullptr)
+  , m_channel(channel)
+  , m_data(std::make_shared<Data>(QByteArray()))
+  , m_serializer(client->sharedSerializer())
+{
+}
+
 QGrpcAsyncOperationBase::~QGrpcAsyncOperationBase()
 {
-    qProtoDebug() << "Trying ~QGrpcAsyncOperationBase" << this;
-    QMutexLocker locker(&m_asyncLock);
     qProtoDebug() << "~QGrpcAsyncOperationBase" << this;
-    (void)locker;
 }
@@ -26,13 +26,15 @@
 #pragma once
 
 #include <QObject>
-#include <QMutex>
+#include <QPointer>
 
+#include <atomic>
 #include <functional>
 #include <memory>
 
 #include "qabstractgrpcchannel.h"
 #include "qabstractgrpcclient.h"
+#include "qgrpctracer.h"
 
 #include "qtgrpcglobal.h"
 
@@ -53,20 +55,41 @@ public:
      */
     template <typename T>
     T read() {
-        QMutexLocker locker(&m_asyncLock);
-        T value;
-        try {
-            value.deserialize(static_cast<QAbstractGrpcClient*>(parent())->serializer(), m_data);
-        } catch (std::invalid_argument &) {
-            static const QLatin1String invalidArgumentErrorMessage("Response deserialization failed invalid field found");
-            error({QGrpcStatus::InvalidArgument, invalidArgumentErrorMessage});
-        } catch (std::out_of_range &) {
-            static const QLatin1String outOfRangeErrorMessage("Invalid size of received buffer");
-            error({QGrpcStatus::OutOfRange, outOfRangeErrorMessage});
-        } catch (...) {
-            error({QGrpcStatus::Internal, QLatin1String("Unknown exception caught during deserialization")});
+        std::shared_ptr<Data> data = std::atomic_load(&m_data);
+        //Decoded message is cached with data, so repeated reads of the same data don't deserialize it again
+        std::shared_ptr<const DecodedMessage> decoded = std::atomic_load(&data->decoded);
+        if (!decoded || decoded->type != qMetaTypeId<T>()) {
+            std::shared_ptr<T> value = std::make_shared<T>();
+            traceEvent(QGrpcSpan::DeserializationStarted);
+            QGrpcStatus status = deserialize(value.get(), data->data);
+            traceEvent(QGrpcSpan::DeserializationFinished);
+            if (status.code() != QGrpcStatus::Ok) {
+                error(status);
+                return *value;
+            }
+            decoded = std::make_shared<const DecodedMessage>(DecodedMessage{qMetaTypeId<T>(), value});
+            std::atomic_store(&data->decoded, decoded);
         }
-        return value;
+        return *std::static_pointer_cast<const T>(decoded->message);
+    }
+
+    /*!
+     * \brief Reads message from raw byte array stored in QGrpcAsyncReply in background thread
+     * \details Message is deserialized in background thread and passed to \a callback in thread of \a context.
+     *          error() signal is emitted if deserialization is failed. Callback is not invoked if \a context is
+     *          destroyed before message is deserialized. \a context should live in thread of operation.
+     *          Use this method to keep thread of client responsive, when large messages are received.
+     */
+    template <typename T>
+    void readInBackground(QObject *context, const std::function<void(const T &)> &callback) {
+        QByteArray data = this->data();
+
+        QPointer<QGrpcAsyncOperationBase> operation(this);
+        QAbstractGrpcClient::deserializeInBackground<T>(m_serializer, data, context, callback, [operation](const QGrpcStatus &status) {
+            if (!operation.isNull()) {
+                operation->error(status);
+            }
+        });
     }
 
     /*!
@@ -76,8 +99,15 @@ public:
      */
     void setData(const QByteArray &data)
     {
-        QMutexLocker locker(&m_asyncLock);
-        m_data = data;
+        std::atomic_store(&m_data, std::make_shared<Data>(data));
+    }
+
+    /*!
+     * \brief Interface for implementation of QAbstractGrpcChannel. Returns span of operation, that records events
+     *        of channel, or nullptr if operation isn't traced. Should be taken in thread of operation.
+     */
+    std::shared_ptr<QGrpcSpan> span() const {
+        return m_span;
     }
 
 signals:
@@ -95,20 +125,105 @@ signals:
 
 protected:
     //! \private
-    QGrpcAsyncOperationBase(const std::shared_ptr<QAbstractGrpcChannel> &channel, QAbstractGrpcClient *parent) : QObject(parent)
-      , m_channel(channel) {}
+    //! \brief Operation is owned by \a client, unless it's started from other thread in multi-threaded mode of client
+    QGrpcAsyncOperationBase(const std::shared_ptr<QAbstractGrpcChannel> &channel, QAbstractGrpcClient *client);
     //! \private
     virtual ~QGrpcAsyncOperationBase();
 
+    //! \private
+    QAbstractProtobufSerializer *serializer() const {
+        return m_serializer.get();
+    }
+
+    //! \private
+    //! \brief Passes received message \p data to interceptors of client, returns false if message is dropped
+    bool interceptMessage(QByteArray &data) const {
+        return !m_messageInterceptor || m_messageInterceptor(data);
+    }
+
+    //! \private
+    //! \brief Records \p event in span of operation, if operation is traced
+    void traceEvent(QGrpcSpan::Event event) const {
+        if (m_span) {
+            m_span->addEvent(event);
+        }
+    }
+
     std::shared_ptr<QAbstractGrpcChannel> m_channel;
 private:
     QGrpcAsyncOperationBase();
     Q_DISABLE_COPY_MOVE(QGrpcAsyncOperationBase)
 
     friend class QAbstractGrpcClient;
+    friend class QGrpcCachingChannel;
+    friend class QGrpcStreamMultiplexer;
+    friend class QGrpcStream;
+
+    //! \private
+    //! \brief Returns raw data received by operation
+    QByteArray data() const {
+        return std::atomic_load(&m_data)->data;
+    }
+
+    //! \private
+    struct DecodedMessage {
+        int type;
+        std::shared_ptr<const void> message;
+    };
+
+    //! \private
+    //! \brief Received data, that is replaced as a whole by setData(), so channel is never blocked by readers
+    struct Data {
+        Data(const QByteArray &data) : data(data) {}
+        const QByteArray data;
+        //Accessed atomically, because operation may be read from several threads
+        std::shared_ptr<const DecodedMessage> decoded;
+    };
+
+    //! \private
+    //! \brief Deserializes \p data into \p value, returns status of deserialization
+    template <typename T>
+    QGrpcStatus deserialize(T *value, const QByteArray &data) const {
+        QtProtobuf::DeserializationError deserializationError = QtProtobuf::NoDeserializationError;
+#ifndef QT_PROTOBUF_NO_EXCEPTIONS
+        try {
+#endif
+            QtProtobufPrivate::DeserializationErrorScope scope;
+            //Received message is decoded directly into value, without intermediate copy
+            serializer()->deserializeInPlace(value, data);
+            deserializationError = scope.error();
+#ifndef QT_PROTOBUF_NO_EXCEPTIONS
+        } catch (...) {
+            return {QGrpcStatus::Internal, QLatin1String("Unknown exception caught during deserialization")};
+        }
+#endif
+        switch (deserializationError) {
+        case QtProtobuf::NoDeserializationError:
+            break;
+        case QtProtobuf::UnexpectedEndOfStreamError: {
+            static const QLatin1String outOfRangeErrorMessage("Invalid size of received buffer");
+            return {QGrpcStatus::OutOfRange, outOfRangeErrorMessage};
+        }
+        case QtProtobuf::LimitExceededError: {
+            static const QLatin1String limitExceededErrorMessage("Received message exceeds deserialization limits");
+            return {QGrpcStatus::ResourceExhausted, limitExceededErrorMessage};
+        }
+        default: {
+            static const QLatin1String invalidArgumentErrorMessage("Response deserialization failed invalid field found");
+            return {QGrpcStatus::InvalidArgument, invalidArgumentErrorMessage};
+        }
+        }
+        return {QGrpcStatus::Ok};
+    }
 
-    QByteArray m_data;
-    QMutex m_asyncLock;
+    //Accessed atomically, data is written by channel and read by operation thread or background threads
+    std::shared_ptr<Data> m_data;
+    //Serializer is shared with channel and background jobs, client may attach other channel meanwhile
+    std::shared_ptr<QAbstractProtobufSerializer> m_serializer;
+    //Span is assigned by client before operation is passed to channel
+    std::shared_ptr<QGrpcSpan> m_span;
+    //Assigned by client, if client has interceptors
+    std::function<bool(QByteArray &)> m_messageInterceptor;
 };
 
 }
@@ -29,6 +29,38 @@
 
 using namespace QtProtobuf;
 
+QGrpcAsyncReply::QGrpcAsyncReply(const std::shared_ptr<QAbstractGrpcChannel> &channel, QAbstractGrpcClient *parent) : QGrpcAsyncOperationBase(channel, parent)
+{
+    m_future.reportStarted();
+    //Data of reply is set by channel before signals are emitted, so it's available once future is finished
+    connect(this, &QGrpcAsyncReply::finished, this, [this] {
+        finishFuture({});
+    }, Qt::DirectConnection);
+    connect(this, &QGrpcAsyncReply::error, this, [this](const QGrpcStatus &status) {
+        finishFuture(status);
+    }, Qt::DirectConnection);
+}
+
+QGrpcAsyncReply::~QGrpcAsyncReply()
+{
+    if (!m_future.isFinished()) {
+        m_future.reportCanceled();
+        m_future.reportFinished();
+    }
+}
+
+QFuture<QGrpcStatus> QGrpcAsyncReply::future() const
+{
+    return m_future.future();
+}
+
+void QGrpcAsyncReply::finishFuture(const QGrpcStatus &status)
+{
+    if (!m_future.isFinished()) {
+        m_future.reportFinished(&status);
+    }
+}
+
 void QGrpcAsyncReply::abort()
 {
     if (thread() != QThread::currentThread()) {
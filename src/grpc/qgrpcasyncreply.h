@@ -26,12 +26,15 @@
 #pragma once //QGrpcAsyncReply
 
 #include <functional>
+#include <QFuture>
+#include <QFutureInterface>
 #include <QMutex>
 #include <memory>
 
 #include "qabstractgrpcchannel.h"
 #include "qabstractgrpcclient.h"
 #include "qgrpcasyncoperationbase_p.h"
+#include "qgrpccalloptions.h"
 
 #include "qtgrpcglobal.h"
 
@@ -74,18 +77,54 @@ public:
         QObject::connect(this, &QGrpcAsyncReply::finished, receiver, finishCallback, type);
     }
 
+    /*!
+     * \brief Returns future, that is finished together with call. Result of future is status of call.
+     * \details Future may be waited from any thread without event loop, e.g. using QFuture::waitForFinished().
+     *          Received message is read using QGrpcAsyncReply::read() once future is finished. If reply is
+     *          destroyed before call is completed, future is canceled.
+     */
+    QFuture<QGrpcStatus> future() const;
+
+    /*!
+     * \brief Returns options of call, that are applied by channel
+     */
+    const QGrpcCallOptions &options() const {
+        return m_options;
+    }
+
+    /*!
+     * \brief Returns metadata received from server with response of call. Initial and trailing metadata are
+     *        combined. Metadata is available when finished() or error() signal is emitted.
+     */
+    const QGrpcMetadata &metadata() const {
+        return m_metadata;
+    }
+
+    /*!
+     * \brief Interface for implementation of QAbstractGrpcChannel. Should be used to pass metadata received from
+     *        server to reply, before finished() or error() signal is emitted
+     */
+    void setMetadata(const QGrpcMetadata &metadata) {
+        m_metadata = metadata;
+    }
+
 protected:
     //! \private
-    QGrpcAsyncReply(const std::shared_ptr<QAbstractGrpcChannel> &channel, QAbstractGrpcClient *parent) : QGrpcAsyncOperationBase(channel, parent)
-    {}
+    QGrpcAsyncReply(const std::shared_ptr<QAbstractGrpcChannel> &channel, QAbstractGrpcClient *parent);
     //! \private
-    ~QGrpcAsyncReply() = default;
+    ~QGrpcAsyncReply();
 
 private:
     //! \private
     QGrpcAsyncReply();
     Q_DISABLE_COPY_MOVE(QGrpcAsyncReply)
 
+    void finishFuture(const QGrpcStatus &status);
+
+    mutable QFutureInterface<QGrpcStatus> m_future;
+    QGrpcCallOptions m_options;
+    QGrpcMetadata m_metadata;
+
     friend class QAbstractGrpcClient;
 };
 }
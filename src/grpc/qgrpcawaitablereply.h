@@ -0,0 +1,167 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QGrpcAwaitableReply
+
+#if !defined(__cpp_impl_coroutine) || !__has_include(<coroutine>)
+#error "QGrpcAwaitableReply requires compiler with C++20 coroutines support"
+#endif
+
+#include <coroutine>
+#include <memory>
+
+#include <QLatin1String>
+#include <QMetaObject>
+
+#include "qgrpcasyncreply.h"
+#include "qgrpcstatus.h"
+#include "qtgrpcglobal.h"
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcAwaitResult structure contains status and received message of awaited call
+ */
+template<typename T>
+struct QGrpcAwaitResult {
+    QGrpcStatus status;
+    T message;
+};
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcAwaitableReply class makes asynchronous call of gRPC client awaitable in C++20 coroutines
+ * \details Awaitable reply is returned by \<method\>Awaitable methods of clients, that are generated with COROUTINES
+ *          option. co_await expression resumes coroutine directly from finished() or error() signal of reply, in
+ *          thread of reply, and results in QGrpcAwaitResult with status of call and received message:
+ *          \code
+ *          QtProtobuf::QGrpcAwaitResult<SimpleStringMessage> result = co_await client->testMethodAwaitable(request);
+ *          if (result.status == QtProtobuf::QGrpcStatus::Ok) {
+ *              ...
+ *          }
+ *          \endcode
+ *          If awaitable reply is destroyed together with coroutine, that is suspended, coroutine is not resumed.
+ */
+template<typename T>
+class QGrpcAwaitableReply final
+{
+public:
+    explicit QGrpcAwaitableReply(const QGrpcAsyncReplyShared &reply) : m_state(std::make_shared<State>())
+    {
+        m_state->reply = reply;
+        if (!reply) {
+            //Reply is not created if client has no channel attached
+            m_state->completed = true;
+            m_state->status = {QGrpcStatus::Unknown, QLatin1String("No channel(s) attached.")};
+            return;
+        }
+
+        std::weak_ptr<State> weakState = m_state;
+        m_state->finishedConnection = QObject::connect(reply.get(), &QGrpcAsyncReply::finished, [weakState] {
+            complete(weakState.lock(), {});
+        });
+        //Error connection is kept until awaitable is destroyed, to collect deserialization errors of read()
+        m_state->errorConnection = QObject::connect(reply.get(), &QGrpcAsyncReply::error, [weakState](const QGrpcStatus &status) {
+            complete(weakState.lock(), status);
+        });
+
+        //Call could be completed before awaitable is created
+        QFuture<QGrpcStatus> future = reply->future();
+        if (future.isFinished() && !future.isCanceled()) {
+            m_state->completed = true;
+            m_state->status = future.result();
+        }
+    }
+
+    QGrpcAwaitableReply(QGrpcAwaitableReply &&other) = default;
+
+    ~QGrpcAwaitableReply()
+    {
+        if (m_state) {
+            QObject::disconnect(m_state->finishedConnection);
+            QObject::disconnect(m_state->errorConnection);
+        }
+    }
+
+    //! \private
+    bool await_ready() const noexcept {
+        return m_state->completed;
+    }
+
+    //! \private
+    void await_suspend(std::coroutine_handle<> handle) noexcept {
+        m_state->handle = handle;
+    }
+
+    //! \private
+    QGrpcAwaitResult<T> await_resume() {
+        QGrpcAwaitResult<T> result;
+        if (m_state->status == QGrpcStatus::Ok) {
+            result.message = m_state->reply->template read<T>();
+        }
+        result.status = m_state->status;
+        return result;
+    }
+
+private:
+    Q_DISABLE_COPY(QGrpcAwaitableReply)
+
+    //! \private
+    struct State {
+        QGrpcAsyncReplyShared reply;
+        QMetaObject::Connection finishedConnection;
+        QMetaObject::Connection errorConnection;
+        std::coroutine_handle<> handle;
+        QGrpcStatus status;
+        bool completed = false;
+    };
+
+    static void complete(const std::shared_ptr<State> &state, const QGrpcStatus &status) {
+        if (!state) {
+            return;
+        }
+
+        //Only first error is kept, e.g. deserialization error doesn't override status of call
+        if (state->completed) {
+            if (state->status == QGrpcStatus::Ok) {
+                state->status = status;
+            }
+            return;
+        }
+
+        state->completed = true;
+        state->status = status;
+        if (state->handle) {
+            std::coroutine_handle<> handle = state->handle;
+            state->handle = nullptr;
+            handle.resume();
+        }
+    }
+
+    std::shared_ptr<State> m_state;
+};
+
+}
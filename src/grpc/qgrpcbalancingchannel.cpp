@@ -0,0 +1,242 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qgrpcbalancingchannel.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "qgrpcasyncreply.h"
+#include "qgrpcstream.h"
+#include "qgrpcclientstream.h"
+#include "qtprotobuflogging.h"
+
+using namespace QtProtobuf;
+
+namespace  {
+const int DefaultEjectionThreshold = 3;
+const std::chrono::milliseconds DefaultEjectionTime(30000);
+}
+
+namespace QtProtobuf {
+
+//! \private
+struct QGrpcBalancingChannelPrivate {
+    //! \private
+    //! \brief Wrapped channel and statistics of its calls
+    struct Backend {
+        Backend(const std::shared_ptr<QAbstractGrpcChannel> &_channel) : channel(_channel) {}
+
+        void finish(QGrpcStatus::StatusCode code, int threshold) {
+            --activeCalls;
+            if (code == QGrpcStatus::Aborted) {
+                //Call is aborted by client, backend health is unknown
+                return;
+            }
+
+            if (code != QGrpcStatus::Unavailable && code != QGrpcStatus::DeadlineExceeded) {
+                failures = 0;
+                return;
+            }
+
+            if (threshold > 0 && ++failures >= threshold) {
+                qProtoWarning() << "Channel is ejected from balancing after" << failures << "failed calls";
+                failures = 0;
+                ejectionTimer.start();
+            }
+        }
+
+        std::shared_ptr<QAbstractGrpcChannel> channel;
+        int activeCalls = 0;
+        int failures = 0;
+        QElapsedTimer ejectionTimer;
+    };
+
+    QGrpcBalancingChannelPrivate(const std::vector<std::shared_ptr<QAbstractGrpcChannel>> &channels, QGrpcBalancingChannel::BalancingPolicy _policy)
+        : policy(_policy)
+    {
+        if (channels.empty()) {
+            throw std::invalid_argument("Balancing channel requires at least one channel.");
+        }
+
+        for (auto &channel : channels) {
+            if (!channel) {
+                throw std::invalid_argument("Balancing channel doesn't accept null channels.");
+            }
+            backends.push_back(std::make_shared<Backend>(channel));
+        }
+    }
+
+    bool isEjected(const Backend &backend) const {
+        return backend.ejectionTimer.isValid() && !backend.ejectionTimer.hasExpired(ejectionTime.count());
+    }
+
+    std::shared_ptr<Backend> select() {
+        bool allEjected = std::all_of(backends.begin(), backends.end(), [this](const std::shared_ptr<Backend> &backend) {
+            return isEjected(*backend);
+        });
+
+        //Search is started from next channel in turn, so channels with equal load are selected in turn as well
+        std::shared_ptr<Backend> selected;
+        size_t selectedIndex = 0;
+        for (size_t i = 0; i < backends.size(); i++) {
+            size_t index = (next + i) % backends.size();
+            const std::shared_ptr<Backend> &backend = backends[index];
+            if (!allEjected && isEjected(*backend)) {
+                continue;
+            }
+
+            if (!selected || backend->activeCalls < selected->activeCalls) {
+                selected = backend;
+                selectedIndex = index;
+            }
+
+            if (policy == QGrpcBalancingChannel::RoundRobin) {
+                break;
+            }
+        }
+
+        next = selectedIndex + 1;
+        return selected;
+    }
+
+    //Updates statistics of backend, when operation is completed
+    template<typename T>
+    void track(T *operation, const std::shared_ptr<Backend> &backend) {
+        ++backend->activeCalls;
+        std::shared_ptr<bool> completed(new bool(false));
+        const int threshold = ejectionThreshold;
+        QObject::connect(operation, &T::finished, [backend, completed, threshold]() {
+            if (!*completed) {
+                *completed = true;
+                backend->finish(QGrpcStatus::Ok, threshold);
+            }
+        });
+        QObject::connect(operation, &T::error, [backend, completed, threshold](const QGrpcStatus &status) {
+            if (!*completed) {
+                *completed = true;
+                backend->finish(status.code(), threshold);
+            }
+        });
+    }
+
+    std::vector<std::shared_ptr<Backend>> backends;
+    QGrpcBalancingChannel::BalancingPolicy policy;
+    size_t next = 0;
+    int ejectionThreshold = DefaultEjectionThreshold;
+    std::chrono::milliseconds ejectionTime = DefaultEjectionTime;
+};
+
+}
+
+QGrpcBalancingChannel::QGrpcBalancingChannel(const std::vector<std::shared_ptr<QAbstractGrpcChannel>> &channels, BalancingPolicy policy) : QAbstractGrpcChannel()
+  , dPtr(std::make_unique<QGrpcBalancingChannelPrivate>(channels, policy))
+{
+}
+
+QGrpcBalancingChannel::~QGrpcBalancingChannel()
+{
+}
+
+QGrpcStatus QGrpcBalancingChannel::call(const QString &method, const QString &service, const QByteArray &args, QByteArray &ret)
+{
+    std::shared_ptr<QGrpcBalancingChannelPrivate::Backend> backend = dPtr->select();
+    ++backend->activeCalls;
+    QGrpcStatus status = backend->channel->call(method, service, args, ret);
+    backend->finish(status.code(), dPtr->ejectionThreshold);
+    return status;
+}
+
+void QGrpcBalancingChannel::call(const QString &method, const QString &service, const QByteArray &args, QGrpcAsyncReply *reply)
+{
+    std::shared_ptr<QGrpcBalancingChannelPrivate::Backend> backend = dPtr->select();
+    dPtr->track(reply, backend);
+    backend->channel->call(method, service, args, reply);
+}
+
+void QGrpcBalancingChannel::callWithHandler(const QString &method, const QString &service, const QByteArray &args, const CallHandler &handler)
+{
+    std::shared_ptr<QGrpcBalancingChannelPrivate::Backend> backend = dPtr->select();
+    ++backend->activeCalls;
+    const int threshold = dPtr->ejectionThreshold;
+    backend->channel->callWithHandler(method, service, args, [backend, threshold, handler](const QGrpcStatus &status, const QByteArray &data) {
+        backend->finish(status.code(), threshold);
+        handler(status, data);
+    });
+}
+
+void QGrpcBalancingChannel::subscribe(QGrpcStream *stream, const QString &service, QAbstractGrpcClient *client)
+{
+    std::shared_ptr<QGrpcBalancingChannelPrivate::Backend> backend = dPtr->select();
+    dPtr->track(stream, backend);
+    backend->channel->subscribe(stream, service, client);
+}
+
+void QGrpcBalancingChannel::openStream(QGrpcClientStream *stream, const QString &service, QAbstractGrpcClient *client)
+{
+    std::shared_ptr<QGrpcBalancingChannelPrivate::Backend> backend = dPtr->select();
+    dPtr->track(stream, backend);
+    backend->channel->openStream(stream, service, client);
+}
+
+std::shared_ptr<QAbstractProtobufSerializer> QGrpcBalancingChannel::serializer() const
+{
+    return dPtr->backends.front()->channel->serializer();
+}
+
+QGrpcBalancingChannel::BalancingPolicy QGrpcBalancingChannel::policy() const
+{
+    return dPtr->policy;
+}
+
+void QGrpcBalancingChannel::setEjectionThreshold(int threshold)
+{
+    dPtr->ejectionThreshold = threshold;
+}
+
+int QGrpcBalancingChannel::ejectionThreshold() const
+{
+    return dPtr->ejectionThreshold;
+}
+
+void QGrpcBalancingChannel::setEjectionTime(std::chrono::milliseconds time)
+{
+    dPtr->ejectionTime = time;
+}
+
+std::chrono::milliseconds QGrpcBalancingChannel::ejectionTime() const
+{
+    return dPtr->ejectionTime;
+}
+
+int QGrpcBalancingChannel::healthyChannelCount() const
+{
+    return static_cast<int>(std::count_if(dPtr->backends.begin(), dPtr->backends.end(),
+                                          [this](const std::shared_ptr<QGrpcBalancingChannelPrivate::Backend> &backend) {
+        return !dPtr->isEjected(*backend);
+    }));
+}
@@ -0,0 +1,110 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QGrpcBalancingChannel
+
+#include "qabstractgrpcchannel.h"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace QtProtobuf {
+
+struct QGrpcBalancingChannelPrivate;
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcBalancingChannel class distributes calls between multiple channels connected to different backends
+ * \details QGrpcBalancingChannel wraps list of QAbstractGrpcChannel implementations, e.g. QGrpcHttp2Channel
+ *          instances created for every endpoint of service. Every call is made using single channel selected
+ *          according to balancing policy. Channel is ejected from balancing for ejectionTime() after
+ *          ejectionThreshold() consecutive calls failed with QGrpcStatus::Unavailable or
+ *          QGrpcStatus::DeadlineExceeded status. When all channels are ejected, calls are distributed between
+ *          all of them.
+ */
+class Q_GRPC_EXPORT QGrpcBalancingChannel final : public QAbstractGrpcChannel
+{
+public:
+    /*!
+     * \brief Policy of channel selection for calls
+     */
+    enum BalancingPolicy {
+        RoundRobin,              //!< Channels are selected in turn
+        LeastOutstandingRequests //!< Channel with least number of active calls is selected
+    };
+
+    /*!
+     * \brief QGrpcBalancingChannel constructs QGrpcBalancingChannel
+     * \param channels channels that are used to make calls, list must not be empty. All channels
+     *        have to use the same serializer.
+     * \param policy policy of channel selection
+     */
+    QGrpcBalancingChannel(const std::vector<std::shared_ptr<QAbstractGrpcChannel>> &channels, BalancingPolicy policy = RoundRobin);
+    ~QGrpcBalancingChannel();
+
+    QGrpcStatus call(const QString &method, const QString &service, const QByteArray &args, QByteArray &ret) override;
+    void call(const QString &method, const QString &service, const QByteArray &args, QtProtobuf::QGrpcAsyncReply *reply) override;
+    void callWithHandler(const QString &method, const QString &service, const QByteArray &args, const CallHandler &handler) override;
+    void subscribe(QGrpcStream *stream, const QString &service, QAbstractGrpcClient *client) override;
+    void openStream(QGrpcClientStream *stream, const QString &service, QAbstractGrpcClient *client) override;
+    std::shared_ptr<QAbstractProtobufSerializer> serializer() const override;
+
+    /*!
+     * \brief Returns policy of channel selection
+     */
+    BalancingPolicy policy() const;
+
+    /*!
+     * \brief Sets number of consecutive failed calls, after that channel is ejected. Default threshold is 3 calls.
+     *        Zero \a threshold disables ejection.
+     */
+    void setEjectionThreshold(int threshold);
+
+    /*!
+     * \brief Returns number of consecutive failed calls, after that channel is ejected
+     */
+    int ejectionThreshold() const;
+
+    /*!
+     * \brief Sets time, while ejected channel is not used for calls. Default ejection time is 30 seconds.
+     */
+    void setEjectionTime(std::chrono::milliseconds time);
+
+    /*!
+     * \brief Returns time, while ejected channel is not used for calls
+     */
+    std::chrono::milliseconds ejectionTime() const;
+
+    /*!
+     * \brief Returns number of channels, that are not ejected at the moment
+     */
+    int healthyChannelCount() const;
+
+private:
+    Q_DISABLE_COPY_MOVE(QGrpcBalancingChannel)
+
+    std::unique_ptr<QGrpcBalancingChannelPrivate> dPtr;
+};
+}
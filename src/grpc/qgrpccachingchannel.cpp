@@ -0,0 +1,296 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qgrpccachingchannel.h"
+
+#include <QCache>
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QPointer>
+#include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "qgrpcasyncreply.h"
+#include "qtprotobuflogging.h"
+
+using namespace QtProtobuf;
+
+namespace  {
+const int DefaultMaxSize = 4 * 1024 * 1024;
+}
+
+namespace QtProtobuf {
+
+//! \private
+struct QGrpcCacheKey {
+    QString service;
+    QString method;
+    QByteArray args;
+
+    bool operator ==(const QGrpcCacheKey &other) const {
+        return service == other.service && method == other.method && args == other.args;
+    }
+};
+
+//! \private
+inline uint qHash(const QGrpcCacheKey &key, uint seed = 0)
+{
+    return ::qHash(key.args, seed) ^ ::qHash(key.method, seed) ^ ::qHash(key.service, seed);
+}
+
+//! \private
+//! \brief Cached responses, shared with callbacks of calls that are in progress
+class QGrpcResponseCache {
+public:
+    //! \private
+    struct Entry {
+        QByteArray data;
+        QDeadlineTimer deadline;
+    };
+
+    QGrpcResponseCache() {
+        cache.setMaxCost(DefaultMaxSize);
+    }
+
+    bool isEnabled(const QString &service, const QString &method) const {
+        QMutexLocker locker(&mutex);
+        return ttls.contains(qMakePair(service, method));
+    }
+
+    bool find(const QGrpcCacheKey &key, QByteArray &data) {
+        QMutexLocker locker(&mutex);
+        Entry *entry = cache.object(key);
+        if (entry == nullptr) {
+            return false;
+        }
+
+        if (entry->deadline.hasExpired()) {
+            cache.remove(key);
+            return false;
+        }
+
+        data = entry->data;
+        ++hits;
+        return true;
+    }
+
+    void store(const QGrpcCacheKey &key, const QByteArray &data) {
+        QMutexLocker locker(&mutex);
+        auto it = ttls.constFind(qMakePair(key.service, key.method));
+        //Caching could be disabled while call was in progress
+        if (it == ttls.constEnd()) {
+            return;
+        }
+
+        //Entry is deleted by cache if it doesn't fit into cache
+        cache.insert(key, new Entry{data, QDeadlineTimer(it.value())}, std::max(1, data.size() + key.args.size()));
+    }
+
+    void invalidate(const QString &service, const QString &method) {
+        QMutexLocker locker(&mutex);
+        for (const QGrpcCacheKey &key : cache.keys()) {
+            if (key.service == service && key.method == method) {
+                cache.remove(key);
+            }
+        }
+    }
+
+    mutable QMutex mutex;
+    QHash<QPair<QString, QString>, std::chrono::milliseconds> ttls;
+    QCache<QGrpcCacheKey, Entry> cache;
+    int hits = 0;
+};
+
+//! \private
+struct QGrpcCachingChannelPrivate {
+    QGrpcCachingChannelPrivate(const std::shared_ptr<QAbstractGrpcChannel> &_channel) : channel(_channel)
+      , cache(std::make_shared<QGrpcResponseCache>())
+    {
+        if (!channel) {
+            throw std::invalid_argument("Caching channel doesn't accept null channel.");
+        }
+    }
+
+    std::shared_ptr<QAbstractGrpcChannel> channel;
+    std::shared_ptr<QGrpcResponseCache> cache;
+};
+
+}
+
+QGrpcCachingChannel::QGrpcCachingChannel(const std::shared_ptr<QAbstractGrpcChannel> &channel) : QAbstractGrpcChannel()
+  , dPtr(std::make_unique<QGrpcCachingChannelPrivate>(channel))
+{
+}
+
+QGrpcCachingChannel::~QGrpcCachingChannel()
+{
+}
+
+QGrpcStatus QGrpcCachingChannel::call(const QString &method, const QString &service, const QByteArray &args, QByteArray &ret)
+{
+    if (!dPtr->cache->isEnabled(service, method)) {
+        return dPtr->channel->call(method, service, args, ret);
+    }
+
+    QGrpcCacheKey key{service, method, args};
+    if (dPtr->cache->find(key, ret)) {
+        qProtoDebug() << "Response of" << service << method << "is found in cache";
+        return {QGrpcStatus::Ok};
+    }
+
+    QGrpcStatus status = dPtr->channel->call(method, service, args, ret);
+    if (status.code() == QGrpcStatus::Ok) {
+        dPtr->cache->store(key, ret);
+    }
+    return status;
+}
+
+void QGrpcCachingChannel::call(const QString &method, const QString &service, const QByteArray &args, QGrpcAsyncReply *reply)
+{
+    if (!dPtr->cache->isEnabled(service, method)) {
+        dPtr->channel->call(method, service, args, reply);
+        return;
+    }
+
+    QGrpcCacheKey key{service, method, args};
+    QByteArray data;
+    if (dPtr->cache->find(key, data)) {
+        qProtoDebug() << "Response of" << service << method << "is found in cache";
+        //Cached response is delivered asynchronously, like response received from server
+        QPointer<QGrpcAsyncReply> replyPtr(reply);
+        QMetaObject::invokeMethod(reply, [replyPtr, data] {
+            if (!replyPtr.isNull()) {
+                replyPtr->setData(data);
+                replyPtr->finished();
+            }
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    std::shared_ptr<QGrpcResponseCache> cache = dPtr->cache;
+    //Response is stored before it's delivered to reply handlers, that are connected after this connection
+    std::shared_ptr<QMetaObject::Connection> connection(new QMetaObject::Connection);
+    *connection = QObject::connect(reply, &QGrpcAsyncReply::finished, reply, [reply, key, cache, connection] {
+        QObject::disconnect(*connection);
+        cache->store(key, reply->data());
+    }, Qt::DirectConnection);
+    dPtr->channel->call(method, service, args, reply);
+}
+
+void QGrpcCachingChannel::callWithHandler(const QString &method, const QString &service, const QByteArray &args, const CallHandler &handler)
+{
+    if (!dPtr->cache->isEnabled(service, method)) {
+        dPtr->channel->callWithHandler(method, service, args, handler);
+        return;
+    }
+
+    QGrpcCacheKey key{service, method, args};
+    QByteArray data;
+    if (dPtr->cache->find(key, data)) {
+        qProtoDebug() << "Response of" << service << method << "is found in cache";
+        //Cached response is delivered asynchronously, like response received from server
+        QTimer::singleShot(0, [handler, data] {
+            handler({QGrpcStatus::Ok}, data);
+        });
+        return;
+    }
+
+    std::shared_ptr<QGrpcResponseCache> cache = dPtr->cache;
+    dPtr->channel->callWithHandler(method, service, args, [key, cache, handler](const QGrpcStatus &status, const QByteArray &data) {
+        if (status.code() == QGrpcStatus::Ok) {
+            cache->store(key, data);
+        }
+        handler(status, data);
+    });
+}
+
+void QGrpcCachingChannel::subscribe(QGrpcStream *stream, const QString &service, QAbstractGrpcClient *client)
+{
+    dPtr->channel->subscribe(stream, service, client);
+}
+
+void QGrpcCachingChannel::openStream(QGrpcClientStream *stream, const QString &service, QAbstractGrpcClient *client)
+{
+    dPtr->channel->openStream(stream, service, client);
+}
+
+std::shared_ptr<QAbstractProtobufSerializer> QGrpcCachingChannel::serializer() const
+{
+    return dPtr->channel->serializer();
+}
+
+bool QGrpcCachingChannel::isThreadSafe() const
+{
+    return dPtr->channel->isThreadSafe();
+}
+
+void QGrpcCachingChannel::enableCaching(const QString &service, const QString &method, std::chrono::milliseconds ttl)
+{
+    QMutexLocker locker(&dPtr->cache->mutex);
+    dPtr->cache->ttls.insert(qMakePair(service, method), ttl);
+}
+
+void QGrpcCachingChannel::disableCaching(const QString &service, const QString &method)
+{
+    {
+        QMutexLocker locker(&dPtr->cache->mutex);
+        dPtr->cache->ttls.remove(qMakePair(service, method));
+    }
+    dPtr->cache->invalidate(service, method);
+}
+
+void QGrpcCachingChannel::setMaxSize(int size)
+{
+    QMutexLocker locker(&dPtr->cache->mutex);
+    dPtr->cache->cache.setMaxCost(size);
+}
+
+int QGrpcCachingChannel::maxSize() const
+{
+    QMutexLocker locker(&dPtr->cache->mutex);
+    return dPtr->cache->cache.maxCost();
+}
+
+void QGrpcCachingChannel::invalidate(const QString &service, const QString &method)
+{
+    dPtr->cache->invalidate(service, method);
+}
+
+void QGrpcCachingChannel::invalidate()
+{
+    QMutexLocker locker(&dPtr->cache->mutex);
+    dPtr->cache->cache.clear();
+}
+
+int QGrpcCachingChannel::hitCount() const
+{
+    QMutexLocker locker(&dPtr->cache->mutex);
+    return dPtr->cache->hits;
+}
@@ -0,0 +1,113 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QGrpcCachingChannel
+
+#include "qabstractgrpcchannel.h"
+
+#include <chrono>
+#include <memory>
+
+namespace QtProtobuf {
+
+struct QGrpcCachingChannelPrivate;
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcCachingChannel class caches responses of unary calls made using wrapped channel
+ * \details Responses are cached only for methods, that are enabled using enableCaching(). Caching should be
+ *          enabled only for idempotent methods, which response depends on arguments of call only. Cache entries
+ *          are identified by service, method and serialized arguments of call and keep raw response data, so
+ *          cached responses are deserialized by client as usual. Entry is dropped when it's expired or when cache
+ *          exceeds maxSize(), in that case least recently used entries are dropped first. Only successful
+ *          responses are cached. Streams are not affected by cache and passed to wrapped channel directly.
+ *          \code
+ *          auto channel = std::make_shared<QtProtobuf::QGrpcCachingChannel>(std::make_shared<QtProtobuf::QGrpcHttp2Channel>(...));
+ *          channel->enableCaching("qtprotobuf.example.ProfileService", "getProfile", std::chrono::seconds(30));
+ *          client->attachChannel(channel);
+ *          \endcode
+ */
+class Q_GRPC_EXPORT QGrpcCachingChannel final : public QAbstractGrpcChannel
+{
+public:
+    /*!
+     * \brief QGrpcCachingChannel constructs QGrpcCachingChannel
+     * \param channel channel, that is used to make calls, which responses are not found in cache
+     */
+    QGrpcCachingChannel(const std::shared_ptr<QAbstractGrpcChannel> &channel);
+    ~QGrpcCachingChannel();
+
+    QGrpcStatus call(const QString &method, const QString &service, const QByteArray &args, QByteArray &ret) override;
+    void call(const QString &method, const QString &service, const QByteArray &args, QtProtobuf::QGrpcAsyncReply *reply) override;
+    void callWithHandler(const QString &method, const QString &service, const QByteArray &args, const CallHandler &handler) override;
+    void subscribe(QGrpcStream *stream, const QString &service, QAbstractGrpcClient *client) override;
+    void openStream(QGrpcClientStream *stream, const QString &service, QAbstractGrpcClient *client) override;
+    std::shared_ptr<QAbstractProtobufSerializer> serializer() const override;
+
+    /*!
+     * \brief Returns true if wrapped channel is thread-safe, cache itself may be used from any thread
+     */
+    bool isThreadSafe() const override;
+
+    /*!
+     * \brief Enables caching of responses of \a service \a method, responses are kept in cache for \a ttl
+     */
+    void enableCaching(const QString &service, const QString &method, std::chrono::milliseconds ttl);
+
+    /*!
+     * \brief Disables caching of responses of \a service \a method and drops its cached responses
+     */
+    void disableCaching(const QString &service, const QString &method);
+
+    /*!
+     * \brief Sets maximum total size of cached responses in bytes. Default size is 4 MiB.
+     */
+    void setMaxSize(int size);
+
+    /*!
+     * \brief Returns maximum total size of cached responses in bytes
+     */
+    int maxSize() const;
+
+    /*!
+     * \brief Drops cached responses of \a service \a method, e.g. when data is known to be changed on server
+     */
+    void invalidate(const QString &service, const QString &method);
+
+    /*!
+     * \brief Drops all cached responses
+     */
+    void invalidate();
+
+    /*!
+     * \brief Returns number of calls, that are completed using cached response
+     */
+    int hitCount() const;
+
+private:
+    Q_DISABLE_COPY_MOVE(QGrpcCachingChannel)
+
+    std::unique_ptr<QGrpcCachingChannelPrivate> dPtr;
+};
+}
@@ -0,0 +1,216 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qgrpccallbatch.h"
+
+#include <QThread>
+
+#include <algorithm>
+#include <deque>
+
+#include "qtprotobuflogging.h"
+
+namespace QtProtobuf {
+
+//! \private
+struct QGrpcCallBatchPrivate {
+    QGrpcCallBatchPrivate(int _maxInFlight) : maxInFlight(std::max(1, _maxInFlight)) {}
+
+    //! \brief Returns total number of queued calls
+    int queued() const {
+        size_t count = 0;
+        for (const auto &queue : queues) {
+            count += queue.size();
+        }
+        return static_cast<int>(count);
+    }
+
+    //! \brief Returns queue of highest priority that has calls, or nullptr if no calls are queued
+    std::deque<QGrpcCallBatch::Call> *nextQueue() {
+        for (int priority = QGrpcCallOptions::HighPriority; priority >= QGrpcCallOptions::LowPriority; --priority) {
+            if (!queues[priority].empty()) {
+                return &queues[priority];
+            }
+        }
+        return nullptr;
+    }
+
+    //Queues are indexed by QGrpcCallOptions::Priority
+    std::deque<QGrpcCallBatch::Call> queues[QGrpcCallOptions::HighPriority + 1];
+    int maxInFlight;
+    int maxQueued = 0;
+    int inFlight = 0;
+    int completed = 0;
+    int failed = 0;
+    bool queueFull = false;
+    bool closed = false;
+    bool dispatching = false;
+};
+
+}
+
+using namespace QtProtobuf;
+
+QGrpcCallBatch::QGrpcCallBatch(int maxInFlight, QObject *parent) : QObject(parent)
+  , dPtr(std::make_unique<QGrpcCallBatchPrivate>(maxInFlight))
+{
+}
+
+QGrpcCallBatch::~QGrpcCallBatch()
+{
+    if (dPtr->queued() > 0) {
+        qProtoWarning() << "QGrpcCallBatch is destroyed with" << dPtr->queued() << "calls not started";
+    }
+}
+
+bool QGrpcCallBatch::add(const Call &call, QGrpcCallOptions::Priority priority)
+{
+    if (dPtr->closed) {
+        qProtoWarning() << "Unable to add call to closed QGrpcCallBatch";
+        return false;
+    }
+
+    if (dPtr->maxQueued > 0 && dPtr->queued() >= dPtr->maxQueued) {
+        dPtr->queueFull = true;
+        return false;
+    }
+
+    dPtr->queues[priority].push_back(call);
+    dispatch();
+    return true;
+}
+
+void QGrpcCallBatch::close()
+{
+    if (dPtr->closed) {
+        return;
+    }
+
+    dPtr->closed = true;
+    if (dPtr->inFlight == 0 && dPtr->queued() == 0) {
+        emit finished();
+    }
+}
+
+void QGrpcCallBatch::dispatch()
+{
+    //Calls that are completed immediately don't recurse into dispatch, but are handled by this loop
+    if (dPtr->dispatching) {
+        return;
+    }
+
+    dPtr->dispatching = true;
+    std::deque<Call> *queue = nullptr;
+    while (dPtr->inFlight < dPtr->maxInFlight && (queue = dPtr->nextQueue()) != nullptr) {
+        Call call = std::move(queue->front());
+        queue->pop_front();
+        ++dPtr->inFlight;
+
+        QPointer<QGrpcCallBatch> batch(this);
+        std::shared_ptr<bool> completed(new bool(false));
+        call([batch, completed](const QGrpcStatus &status) {
+            if (*completed) {
+                qProtoWarning() << "Completion of QGrpcCallBatch call is reported more than once";
+                return;
+            }
+            *completed = true;
+
+            if (batch.isNull()) {
+                return;
+            }
+
+            if (batch->thread() == QThread::currentThread()) {
+                batch->complete(status);
+            } else {
+                QMetaObject::invokeMethod(batch.data(), [batch, status] {
+                    if (!batch.isNull()) {
+                        batch->complete(status);
+                    }
+                }, Qt::QueuedConnection);
+            }
+        });
+    }
+    dPtr->dispatching = false;
+
+    if (dPtr->queueFull && (dPtr->maxQueued <= 0 || dPtr->queued() < dPtr->maxQueued)) {
+        dPtr->queueFull = false;
+        emit queueAvailable();
+    }
+
+    if (dPtr->closed && dPtr->inFlight == 0 && dPtr->queued() == 0) {
+        emit finished();
+    }
+}
+
+void QGrpcCallBatch::complete(const QGrpcStatus &status)
+{
+    --dPtr->inFlight;
+    ++dPtr->completed;
+    if (status.code() != QGrpcStatus::Ok) {
+        ++dPtr->failed;
+    }
+    dispatch();
+}
+
+void QGrpcCallBatch::setMaxInFlight(int maxInFlight)
+{
+    dPtr->maxInFlight = std::max(1, maxInFlight);
+    dispatch();
+}
+
+int QGrpcCallBatch::maxInFlight() const
+{
+    return dPtr->maxInFlight;
+}
+
+void QGrpcCallBatch::setMaxQueued(int maxQueued)
+{
+    dPtr->maxQueued = std::max(0, maxQueued);
+}
+
+int QGrpcCallBatch::maxQueued() const
+{
+    return dPtr->maxQueued;
+}
+
+int QGrpcCallBatch::inFlightCount() const
+{
+    return dPtr->inFlight;
+}
+
+int QGrpcCallBatch::queuedCount() const
+{
+    return dPtr->queued();
+}
+
+int QGrpcCallBatch::completedCount() const
+{
+    return dPtr->completed;
+}
+
+int QGrpcCallBatch::failedCount() const
+{
+    return dPtr->failed;
+}
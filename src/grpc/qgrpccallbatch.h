@@ -0,0 +1,186 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QGrpcCallBatch
+
+#include <QObject>
+#include <QPointer>
+#include <QLatin1String>
+
+#include <functional>
+#include <memory>
+
+#include "qgrpccalloptions.h"
+#include "qgrpcstatus.h"
+#include "qtgrpcglobal.h"
+
+namespace QtProtobuf {
+
+struct QGrpcCallBatchPrivate;
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcCallBatch class dispatches queued unary calls with bounded number of calls in flight
+ * \details Calls added to batch are started in order they are added, but no more than maxInFlight() calls are
+ *          in progress at the same time. Rest of calls wait in queue of batch. Queue may be limited using
+ *          setMaxQueued(), calls are not accepted by add() while queue is full and queueAvailable() signal is
+ *          emitted once queue has free space again. Queued calls of higher priority are started first, so
+ *          latency sensitive calls don't wait behind background calls of the same batch. After close() is
+ *          called, finished() signal is emitted when all added calls are completed.
+ *          \code
+ *          QtProtobuf::QGrpcCallBatch batch(16);
+ *          for (const auto &request : requests) {
+ *              batch.add(client, &TestServiceClient::testMethod, request, [](const QtProtobuf::QGrpcStatus &status, SimpleStringMessage &&reply) {
+ *                  ...
+ *              });
+ *          }
+ *          batch.close();
+ *          \endcode
+ *          Batch should live in thread of calls it dispatches.
+ */
+class Q_GRPC_EXPORT QGrpcCallBatch final : public QObject
+{
+    Q_OBJECT
+public:
+    /*!
+     * \brief Function invoked when call is completed with status of the call
+     */
+    using CompletionHandler = std::function<void(const QGrpcStatus &status)>;
+
+    /*!
+     * \brief Function that starts call and invokes given completion handler once, when call is completed
+     */
+    using Call = std::function<void(const CompletionHandler &done)>;
+
+    /*!
+     * \brief Constructs batch
+     * \param maxInFlight maximum number of calls in progress at the same time
+     * \param parent parent object
+     */
+    QGrpcCallBatch(int maxInFlight, QObject *parent = nullptr);
+    ~QGrpcCallBatch();
+
+    /*!
+     * \brief Adds \a call with \a priority to batch
+     * \details Call is started before queued calls of lower priority and after queued calls of the same or
+     *          higher priority.
+     * \return false if queue of batch is full or batch is closed, \a call is not added in this case
+     */
+    bool add(const Call &call, QGrpcCallOptions::Priority priority = QGrpcCallOptions::NormalPriority);
+
+    /*!
+     * \brief Adds call of unary \a method of \a client with argument \a arg to batch
+     * \details \a method is callback-based overload of generated method, e.g. &TestServiceClient::testMethod.
+     *          \a callback is invoked with status of call and returned message when call is completed.
+     *          Call is queued with \a priority.
+     * \return false if queue of batch is full or batch is closed, call is not added in this case
+     */
+    template<typename C, typename A, typename R>
+    bool add(C *client, void (C::*method)(const A &, const std::function<void(const QGrpcStatus &, R &&)> &), const A &arg,
+             const typename std::common_type<std::function<void(const QGrpcStatus &, R &&)>>::type &callback = {},
+             QGrpcCallOptions::Priority priority = QGrpcCallOptions::NormalPriority) {
+        QPointer<C> clientPtr(client);
+        return add([clientPtr, method, arg, callback](const CompletionHandler &done) {
+            if (clientPtr.isNull()) {
+                done({QGrpcStatus::Cancelled, QLatin1String("Client is destroyed before call is started")});
+                return;
+            }
+
+            (clientPtr.data()->*method)(arg, [callback, done](const QGrpcStatus &status, R &&message) {
+                if (callback) {
+                    callback(status, std::move(message));
+                }
+                done(status);
+            });
+        }, priority);
+    }
+
+    /*!
+     * \brief Closes batch, no calls are accepted after this. finished() signal is emitted when all added calls are
+     *        completed.
+     */
+    void close();
+
+    /*!
+     * \brief Sets maximum number of calls in progress at the same time
+     */
+    void setMaxInFlight(int maxInFlight);
+
+    /*!
+     * \brief Returns maximum number of calls in progress at the same time
+     */
+    int maxInFlight() const;
+
+    /*!
+     * \brief Sets maximum number of calls waiting in queue of batch, zero means unlimited queue. Unlimited by default.
+     */
+    void setMaxQueued(int maxQueued);
+
+    /*!
+     * \brief Returns maximum number of calls waiting in queue of batch
+     */
+    int maxQueued() const;
+
+    /*!
+     * \brief Returns number of calls in progress
+     */
+    int inFlightCount() const;
+
+    /*!
+     * \brief Returns number of calls waiting in queue of batch
+     */
+    int queuedCount() const;
+
+    /*!
+     * \brief Returns number of completed calls
+     */
+    int completedCount() const;
+
+    /*!
+     * \brief Returns number of calls completed with status other than QGrpcStatus::Ok
+     */
+    int failedCount() const;
+
+signals:
+    /*!
+     * \brief The signal is emitted when queue of batch has free space after it was full
+     */
+    void queueAvailable();
+
+    /*!
+     * \brief The signal is emitted when batch is closed and all its calls are completed
+     */
+    void finished();
+
+private:
+    Q_DISABLE_COPY_MOVE(QGrpcCallBatch)
+
+    void dispatch();
+    void complete(const QGrpcStatus &status);
+
+    std::unique_ptr<QGrpcCallBatchPrivate> dPtr;
+};
+
+}
@@ -0,0 +1,128 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qgrpccalloptions.h"
+
+namespace QtProtobuf {
+//! \private
+class QGrpcCallOptionsPrivate {
+public:
+    std::chrono::milliseconds m_deadline = std::chrono::milliseconds::zero();
+    bool m_hasDeadline = false;
+    bool m_waitForReady = false;
+    bool m_hasWaitForReady = false;
+    QGrpcCallOptions::Priority m_priority = QGrpcCallOptions::NormalPriority;
+    QGrpcMetadata m_metadata;
+};
+
+QGrpcCallOptions::QGrpcCallOptions() : dPtr(std::make_unique<QGrpcCallOptionsPrivate>())
+{}
+
+QGrpcCallOptions::~QGrpcCallOptions()
+{}
+
+QGrpcCallOptions::QGrpcCallOptions(const QGrpcCallOptions &other) : dPtr(std::make_unique<QGrpcCallOptionsPrivate>(*other.dPtr))
+{}
+
+QGrpcCallOptions &QGrpcCallOptions::operator =(const QGrpcCallOptions &other)
+{
+    *dPtr = *other.dPtr;
+    return *this;
+}
+
+QGrpcCallOptions::QGrpcCallOptions(QGrpcCallOptions &&other) : dPtr(std::move(other.dPtr))
+{
+}
+
+QGrpcCallOptions &QGrpcCallOptions::operator =(QGrpcCallOptions &&other)
+{
+    dPtr = std::move(other.dPtr);
+    return *this;
+}
+
+void QGrpcCallOptions::setDeadline(std::chrono::milliseconds deadline)
+{
+    dPtr->m_deadline = deadline;
+    dPtr->m_hasDeadline = true;
+}
+
+std::chrono::milliseconds QGrpcCallOptions::deadline() const
+{
+    return dPtr->m_deadline;
+}
+
+bool QGrpcCallOptions::hasDeadline() const
+{
+    return dPtr->m_hasDeadline;
+}
+
+void QGrpcCallOptions::setWaitForReady(bool waitForReady)
+{
+    dPtr->m_waitForReady = waitForReady;
+    dPtr->m_hasWaitForReady = true;
+}
+
+bool QGrpcCallOptions::waitForReady() const
+{
+    return dPtr->m_waitForReady;
+}
+
+bool QGrpcCallOptions::hasWaitForReady() const
+{
+    return dPtr->m_hasWaitForReady;
+}
+
+void QGrpcCallOptions::setPriority(Priority priority)
+{
+    dPtr->m_priority = priority;
+}
+
+QGrpcCallOptions::Priority QGrpcCallOptions::priority() const
+{
+    return dPtr->m_priority;
+}
+
+void QGrpcCallOptions::addMetadata(const QByteArray &name, const QByteArray &value)
+{
+    dPtr->m_metadata.append(qMakePair(name, value));
+}
+
+void QGrpcCallOptions::setMetadata(const QGrpcMetadata &metadata)
+{
+    dPtr->m_metadata = metadata;
+}
+
+const QGrpcMetadata &QGrpcCallOptions::metadata() const
+{
+    return dPtr->m_metadata;
+}
+
+bool QGrpcCallOptions::isEmpty() const
+{
+    return !dPtr->m_hasDeadline && !dPtr->m_hasWaitForReady && dPtr->m_priority == NormalPriority
+            && dPtr->m_metadata.isEmpty();
+}
+
+}
@@ -0,0 +1,150 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QGrpcCallOptions
+
+#include <QByteArray>
+#include <QList>
+#include <QPair>
+
+#include <chrono>
+#include <memory>
+
+#include "qtgrpcglobal.h"
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtGrpc
+ * \brief List of metadata entries, that are sent or received as headers of call. Names and values are kept
+ *        encoded, as they are transferred.
+ */
+using QGrpcMetadata = QList<QPair<QByteArray, QByteArray>>;
+
+class QGrpcCallOptionsPrivate;
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcCallOptions class contains options of single call, that override options of channel
+ * \details Options are passed to asynchronous call of generated client together with call argument:
+ *          \code
+ *          QtProtobuf::QGrpcCallOptions options;
+ *          options.addMetadata("x-trace-id", traceId);
+ *          options.setDeadline(std::chrono::seconds(1));
+ *          QtProtobuf::QGrpcAsyncReplyShared reply = client->testMethod(request, options);
+ *          \endcode
+ *          Metadata received from server is available using QGrpcAsyncReply::metadata().
+ */
+class Q_GRPC_EXPORT QGrpcCallOptions final
+{
+public:
+    /*!
+     * \brief Priority of call relatively to other calls of the same channel
+     */
+    enum Priority {
+        LowPriority,    //!< Background calls, e.g. bulk synchronization
+        NormalPriority, //!< Default priority of calls
+        HighPriority    //!< Latency sensitive calls, e.g. interactive lookups
+    };
+
+    QGrpcCallOptions();
+    ~QGrpcCallOptions();
+
+    QGrpcCallOptions(const QGrpcCallOptions &other);
+    QGrpcCallOptions &operator =(const QGrpcCallOptions &other);
+
+    QGrpcCallOptions(QGrpcCallOptions &&other);
+    QGrpcCallOptions &operator =(QGrpcCallOptions &&other);
+
+    /*!
+     * \brief Sets deadline of call, that overrides deadline of channel. Zero \a deadline disables deadline of call.
+     */
+    void setDeadline(std::chrono::milliseconds deadline);
+
+    /*!
+     * \brief Returns deadline of call
+     */
+    std::chrono::milliseconds deadline() const;
+
+    /*!
+     * \brief Returns true if deadline of call is set and deadline of channel is not used
+     */
+    bool hasDeadline() const;
+
+    /*!
+     * \brief Makes call to wait until channel is connected instead of failing when connection is not established
+     * \details Overrides wait-for-ready setting of channel. Option is supported by QGrpcChannel, other channels
+     *          ignore it.
+     */
+    void setWaitForReady(bool waitForReady);
+
+    /*!
+     * \brief Returns true if call waits until channel is connected
+     */
+    bool waitForReady() const;
+
+    /*!
+     * \brief Returns true if wait-for-ready option of call is set and setting of channel is not used
+     */
+    bool hasWaitForReady() const;
+
+    /*!
+     * \brief Sets \a priority of call. Calls have QGrpcCallOptions::NormalPriority by default.
+     * \details QGrpcHttp2Channel sends priority of call as weight of HTTP/2 stream, so server and connection
+     *          serve high priority calls first. QGrpcCallBatch starts queued calls of higher priority first.
+     */
+    void setPriority(Priority priority);
+
+    /*!
+     * \brief Returns priority of call
+     */
+    Priority priority() const;
+
+    /*!
+     * \brief Adds metadata entry with \a name and \a value, that is sent as header of call
+     * \details \a name should be lowercase ASCII string, \a value is sent as is. Names that end with "-bin"
+     *          are used for binary values, that should be base64 encoded in advance.
+     */
+    void addMetadata(const QByteArray &name, const QByteArray &value);
+
+    /*!
+     * \brief Replaces metadata of call with \a metadata
+     */
+    void setMetadata(const QGrpcMetadata &metadata);
+
+    /*!
+     * \brief Returns metadata, that is sent as headers of call
+     */
+    const QGrpcMetadata &metadata() const;
+
+    /*!
+     * \brief Returns true if no option is set, so call is made with options of channel
+     */
+    bool isEmpty() const;
+
+private:
+    std::unique_ptr<QGrpcCallOptionsPrivate> dPtr;
+};
+}
@@ -26,27 +26,32 @@
 #include "qgrpcchannel.h"
 #include "qgrpcchannel_p.h"
 
-#include <QEventLoop>
 #include <QThread>
 
+#include <chrono>
+#include <cstring>
 #include <memory>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include <grpcpp/channel.h>
 #include <grpcpp/create_channel.h>
 #include <grpcpp/impl/codegen/byte_buffer.h>
+#include <grpcpp/impl/codegen/async_stream.h>
+#include <grpcpp/impl/codegen/async_unary_call.h>
 #include <grpcpp/impl/codegen/client_unary_call.h>
+#include <grpcpp/impl/codegen/completion_queue.h>
 #include <grpcpp/impl/codegen/rpc_method.h>
 #include <grpcpp/impl/codegen/slice.h>
 #include <grpcpp/impl/codegen/status.h>
-#include <grpcpp/impl/codegen/sync_stream.h>
 #include <grpcpp/security/credentials.h>
 
 #include "qabstractgrpccredentials.h"
 #include "qgrpcasyncreply.h"
 #include "qgrpcstatus.h"
 #include "qgrpcstream.h"
+#include "qgrpcclientstream.h"
 #include "qabstractgrpcclient.h"
 #include "qgrpccredentials.h"
 #include "qprotobufserializerregistry_p.h"
@@ -54,170 +59,480 @@
 
 using namespace QtProtobuf;
 
+namespace  {
+//Completion queues are polled by small fixed number of threads, that is shared by all calls of channel
+const int MaxPollingThreads = 4;
+//Reading of stream is paused, when thread of stream didn't take this number of messages yet
+const size_t MaxReadAheadMessages = 256;
+}
+
 namespace QtProtobuf {
 
-static inline grpc::Status parseByteBuffer(const grpc::ByteBuffer &buffer, QByteArray &data)
+QGrpcChannelQueuePool::QGrpcChannelQueuePool(int threadCount)
 {
-    std::vector<grpc::Slice> slices;
-    auto status = buffer.Dump(&slices);
+    for (int i = 0; i < threadCount; i++) {
+        m_queues.push_back(std::make_unique<grpc::CompletionQueue>());
+        grpc::CompletionQueue *queue = m_queues.back().get();
+        QThread *thread = QThread::create([queue]() {
+            void *tag = nullptr;
+            bool ok = false;
+            while (queue->Next(&tag, &ok)) {
+                QGrpcChannelOperation::complete(static_cast<QGrpcChannelOperation::Tag *>(tag), ok);
+            }
+        });
+        thread->start();
+        m_threads.push_back(thread);
+    }
+}
 
-    if (!status.ok())
-        return status;
+QGrpcChannelQueuePool::~QGrpcChannelQueuePool()
+{
+    for (auto &queue : m_queues) {
+        queue->Shutdown();
+    }
 
-    for (auto slice : slices) {
-        data.append(QByteArray((const char *)slice.begin(), slice.size()));
+    for (auto thread : m_threads) {
+        thread->wait();
+        delete thread;
     }
+}
 
-    return grpc::Status::OK;
+grpc::CompletionQueue *QGrpcChannelQueuePool::queue()
+{
+    //Operations may be started from any thread
+    return m_queues[m_next++ % m_queues.size()].get();
 }
 
-static inline void parseQByteArray(const QByteArray &bytearray, grpc::ByteBuffer &buffer)
+QGrpcChannelMethod::QGrpcChannelMethod(const QString &service, const QString &method, grpc::internal::RpcMethod::RpcType type,
+                                       const std::shared_ptr<grpc::Channel> &channel) :
+    name(QByteArray('/' + service.toUtf8() + '/' + method.toUtf8()).toStdString())
+  //Registered method lets gRPC core prepare call path once instead of per call
+  , rpcMethod(name.c_str(), type, channel)
 {
-    grpc::Slice slice(bytearray.data(), bytearray.size());
-    grpc::ByteBuffer tmp(&slice, 1);
-    buffer.Swap(&tmp);
 }
 
-QGrpcChannelStream::QGrpcChannelStream(grpc::Channel *channel, const QString &method, const QByteArray &data, QObject *parent) : QObject(parent)
+QGrpcChannelOperation::QGrpcChannelOperation(const std::shared_ptr<QGrpcChannelQueuePool> &pool, const std::shared_ptr<QGrpcChannelMethod> &method, QObject *parent) : QObject(parent)
+  , m_pool(pool)
+  , m_queue(pool->queue())
+  , m_method(method)
 {
-    grpc::ByteBuffer request;
-    parseQByteArray(data, request);
+}
 
-    reader = grpc::internal::ClientReaderFactory<grpc::ByteBuffer>::Create(channel,
-        grpc::internal::RpcMethod(method.toStdString().c_str(), grpc::internal::RpcMethod::SERVER_STREAMING),
-        &context, request);
+QGrpcChannelOperation::~QGrpcChannelOperation()
+{
+}
 
-    thread = QThread::create([this](){
-        grpc::ByteBuffer response;
-        grpc::Status status;
+void QGrpcChannelOperation::cancel()
+{
+    qProtoDebug() << "Operation" << m_method->name.c_str() << "cancelled";
+    context.TryCancel();
+}
 
-        while (reader->Read(&response)) {
-            QByteArray data;
-            status = parseByteBuffer(response, data);
+void QGrpcChannelOperation::applyOptions(const QGrpcChannelContextOptions &channelOptions, const QGrpcCallOptions *options, bool unary)
+{
+    setupContext(context, channelOptions, options, unary);
+}
 
-            if (!status.ok()) {
-                this->status = {
-                    (QGrpcStatus::StatusCode) status.error_code(),
-                    status.error_message().c_str()
-                };
+void QGrpcChannelOperation::setupContext(grpc::ClientContext &context, const QGrpcChannelContextOptions &channelOptions,
+                                         const QGrpcCallOptions *options, bool unary)
+{
+    std::chrono::milliseconds deadline(unary ? channelOptions.deadline.load() : 0);
+    bool waitForReady = channelOptions.waitForReady;
+    if (options != nullptr) {
+        for (const auto &entry : options->metadata()) {
+            context.AddMetadata(entry.first.toStdString(), entry.second.toStdString());
+        }
+        if (options->hasDeadline()) {
+            deadline = options->deadline();
+        }
+        if (options->hasWaitForReady()) {
+            waitForReady = options->waitForReady();
+        }
+    }
 
-                return; // exit thread
-            }
+    if (deadline.count() > 0) {
+        context.set_deadline(std::chrono::system_clock::now() + deadline);
+    }
 
-            emit this->dataReady(data);
-        }
+    const auto compression = static_cast<grpc_compression_algorithm>(channelOptions.compression.load());
+    if (compression != GRPC_COMPRESS_NONE) {
+        context.set_compression_algorithm(compression);
+    }
 
-        status = reader->Finish();
+    if (waitForReady) {
+        context.set_wait_for_ready(true);
+    }
+}
 
-        this->status = {
-            (QGrpcStatus::StatusCode) status.error_code(),
-            status.error_message().c_str()
-        };
+QGrpcMetadata QGrpcChannelOperation::serverMetadata() const
+{
+    QGrpcMetadata metadata;
+    auto append = [&metadata](const std::multimap<grpc::string_ref, grpc::string_ref> &entries) {
+        for (const auto &entry : entries) {
+            metadata.append(qMakePair(QByteArray(entry.first.data(), static_cast<int>(entry.first.size())),
+                                      QByteArray(entry.second.data(), static_cast<int>(entry.second.size()))));
+        }
+    };
+    append(context.GetServerInitialMetadata());
+    append(context.GetServerTrailingMetadata());
+    return metadata;
+}
 
-        return; // exit thread
-    });
+void *QGrpcChannelOperation::tag(std::function<void(bool)> handler)
+{
+    QMutexLocker locker(&m_tagMutex);
+    ++m_pendingTags;
+    return new Tag{this, std::move(handler), false};
+}
 
-    connect(thread, &QThread::finished, this, &QGrpcChannelStream::finished);
+void *QGrpcChannelOperation::directTag(std::function<void(bool)> handler)
+{
+    QMutexLocker locker(&m_tagMutex);
+    ++m_pendingTags;
+    return new Tag{this, std::move(handler), true};
 }
 
-void QGrpcChannelStream::start()
+void QGrpcChannelOperation::post(std::function<void()> function)
 {
-    thread->start();
+    //Function is dropped together with event if operation is deleted before event is processed
+    QMetaObject::invokeMethod(this, std::move(function), Qt::QueuedConnection);
 }
 
-QGrpcChannelStream::~QGrpcChannelStream()
+void QGrpcChannelOperation::complete(Tag *tag, bool ok)
+{
+    QGrpcChannelOperation *operation = tag->operation;
+    if (tag->direct) {
+        tag->handler(ok);
+    } else {
+        operation->post([handler = std::move(tag->handler), ok]() {
+            handler(ok);
+        });
+    }
+    delete tag;
+
+    QMutexLocker locker(&operation->m_tagMutex);
+    --operation->m_pendingTags;
+    operation->m_tagsCompleted.wakeAll();
+}
+
+void QGrpcChannelOperation::waitForCompletions()
 {
     cancel();
-    thread->wait();
-    thread->deleteLater();
+    QMutexLocker locker(&m_tagMutex);
+    while (m_pendingTags > 0) {
+        m_tagsCompleted.wait(&m_tagMutex);
+    }
+}
 
-    if (reader != nullptr) {
-        delete reader;
+void QGrpcChannelOperation::setStatus(const grpc::Status &grpcStatus)
+{
+    status = toQGrpcStatus(grpcStatus);
+}
+
+QGrpcStatus QGrpcChannelOperation::toQGrpcStatus(const grpc::Status &grpcStatus)
+{
+    if (grpcStatus.ok()) {
+        return {};
     }
+
+    const std::string &message = grpcStatus.error_message();
+    return {
+        static_cast<QGrpcStatus::StatusCode>(grpcStatus.error_code()),
+        QString::fromUtf8(message.data(), static_cast<int>(message.size()))
+    };
 }
 
-void QGrpcChannelStream::cancel() {
-    // TODO: check thread safety
-    qProtoDebug() << "Stream thread terminated";
-    context.TryCancel();
+QGrpcChannelStreamBase::QGrpcChannelStreamBase(const std::shared_ptr<QGrpcChannelQueuePool> &pool, const std::shared_ptr<QGrpcChannelMethod> &method, QObject *parent) :
+    QGrpcChannelOperation(pool, method, parent)
+{
 }
 
-QGrpcChannelCall::QGrpcChannelCall(grpc::Channel *channel, const QString &method, const QByteArray &data, QObject *parent) : QObject(parent) {
-    grpc::ByteBuffer request;
-    parseQByteArray(data, request);
+void QGrpcChannelStreamBase::startReading(std::function<void(grpc::ByteBuffer *, void *)> read)
+{
+    m_read = std::move(read);
+    this->read();
+}
 
-    thread = QThread::create([this, request, channel, method](){
-        grpc::ByteBuffer response;
+void QGrpcChannelStreamBase::read()
+{
+    //Messages are collected by polling thread, so thread of stream is woken up once per batch of messages
+    m_read(&m_response, directTag([this](bool ok) {
         QByteArray data;
-        grpc::Status status;
+        if (ok) {
+            if (span) {
+                span->addEvent(QGrpcSpan::MessageReceived);
+            }
+            m_parseStatus = parseByteBuffer(m_response, data);
+            if (!m_parseStatus.ok()) {
+                cancel();
+                ok = false;
+            }
+        }
 
-        status = grpc::internal::BlockingUnaryCall(channel,
-            grpc::internal::RpcMethod(method.toStdString().c_str(), grpc::internal::RpcMethod::NORMAL_RPC),
-            &context, request, &response
-        );
+        if (!ok) {
+            post([this]() {
+                emit messagesReady();
+                readsFinished();
+            });
+            return;
+        }
 
-        if (!status.ok()) {
-            this->status = {
-                static_cast<QGrpcStatus::StatusCode>(status.error_code()),
-                status.error_message().c_str()
-            };
+        bool deliver = false;
+        bool readNext = false;
+        {
+            QMutexLocker locker(&m_messagesMutex);
+            m_messages.push_back(std::move(data));
+            deliver = !m_deliveryPosted;
+            m_deliveryPosted = true;
+            m_readPaused = m_messages.size() >= MaxReadAheadMessages;
+            readNext = !m_readPaused;
+        }
 
-            return; // exit thread
+        if (deliver) {
+            post([this]() {
+                emit messagesReady();
+            });
         }
 
-        status = parseByteBuffer(response, this->response);
+        if (readNext) {
+            this->read();
+        }
+    }));
+}
 
-        this->status = {
-            static_cast<QGrpcStatus::StatusCode>(status.error_code()),
-            status.error_message().c_str()
-        };
-    });
+std::deque<QByteArray> QGrpcChannelStreamBase::takeMessages()
+{
+    std::deque<QByteArray> messages;
+    bool readNext = false;
+    {
+        QMutexLocker locker(&m_messagesMutex);
+        messages.swap(m_messages);
+        m_deliveryPosted = false;
+        readNext = m_readPaused;
+        m_readPaused = false;
+    }
 
-    connect(thread, &QThread::finished, this, &QGrpcChannelCall::finished);
+    if (readNext) {
+        read();
+    }
+    return messages;
+}
+
+QGrpcChannelStream::QGrpcChannelStream(grpc::Channel *channel, const std::shared_ptr<QGrpcChannelQueuePool> &pool, const std::shared_ptr<QGrpcChannelMethod> &method,
+                                       const QByteArray &data, QObject *parent) : QGrpcChannelStreamBase(pool, method, parent)
+  , m_channel(channel)
+{
+    parseQByteArray(data, m_request);
+}
+
+void QGrpcChannelStream::start()
+{
+    reader = grpc::internal::ClientAsyncReaderFactory<grpc::ByteBuffer>::Create(m_channel, m_queue,
+        m_method->rpcMethod,
+        &context, m_request, true, tag([this](bool ok) {
+            if (ok) {
+                startReading([this](grpc::ByteBuffer *buffer, void *tag) {
+                    reader->Read(buffer, tag);
+                });
+            } else {
+                finish();
+            }
+        }));
+}
+
+void QGrpcChannelStream::readsFinished()
+{
+    finish();
+}
+
+void QGrpcChannelStream::finish()
+{
+    reader->Finish(&m_status, tag([this](bool) {
+        setStatus(m_parseStatus.ok() ? m_status : m_parseStatus);
+        emit finished();
+    }));
+}
+
+QGrpcChannelStream::~QGrpcChannelStream()
+{
+    waitForCompletions();
+}
+
+QGrpcChannelClientStream::QGrpcChannelClientStream(grpc::Channel *channel, const std::shared_ptr<QGrpcChannelQueuePool> &pool,
+                                                   const std::shared_ptr<QGrpcChannelMethod> &method, QObject *parent) : QGrpcChannelStreamBase(pool, method, parent)
+  , m_channel(channel)
+{
+}
+
+void QGrpcChannelClientStream::start()
+{
+    stream = grpc::internal::ClientAsyncReaderWriterFactory<grpc::ByteBuffer, grpc::ByteBuffer>::Create(m_channel, m_queue,
+        m_method->rpcMethod,
+        &context, true, tag([this](bool ok) {
+            if (!ok) {
+                m_readsDone = true;
+                finish();
+                return;
+            }
+
+            m_started = true;
+            startReading([this](grpc::ByteBuffer *buffer, void *tag) {
+                stream->Read(buffer, tag);
+            });
+            writeNext();
+        }));
+}
+
+void QGrpcChannelClientStream::write(const QByteArray &data)
+{
+    //Channel requests next message only after previous one is written, so single pending message is kept
+    m_pendingWrite = data;
+    m_hasPendingWrite = true;
+    writeNext();
+}
+
+void QGrpcChannelClientStream::writesDone()
+{
+    m_writesDoneRequested = true;
+    writeNext();
+}
+
+void QGrpcChannelClientStream::writeNext()
+{
+    if (!m_started || m_writeInFlight || m_writesDone || m_finishing) {
+        return;
+    }
+
+    if (m_hasPendingWrite) {
+        parseQByteArray(m_pendingWrite, m_writeBuffer);
+        m_pendingWrite.clear();
+        m_hasPendingWrite = false;
+        m_writeInFlight = true;
+        stream->Write(m_writeBuffer, tag([this](bool ok) {
+            m_writeInFlight = false;
+            if (!ok) {
+                //Stream is broken, status is received by Finish
+                m_writesDone = true;
+                finish();
+                return;
+            }
+            emit written();
+            writeNext();
+        }));
+    } else if (m_writesDoneRequested) {
+        m_writesDone = true;
+        m_writeInFlight = true;
+        stream->WritesDone(tag([this](bool) {
+            m_writeInFlight = false;
+            finish();
+        }));
+    }
+}
+
+void QGrpcChannelClientStream::readsFinished()
+{
+    m_readsDone = true;
+    finish();
+}
+
+void QGrpcChannelClientStream::finish()
+{
+    //Stream is finished once server closed it and no write operation is pending
+    if (!m_readsDone || m_writeInFlight || m_finishing) {
+        return;
+    }
+
+    m_finishing = true;
+    if (stream == nullptr || !m_started) {
+        setStatus(grpc::Status(grpc::StatusCode::UNAVAILABLE, "Unable to start stream"));
+        emit finished();
+        return;
+    }
+
+    stream->Finish(&m_status, tag([this](bool) {
+        setStatus(m_parseStatus.ok() ? m_status : m_parseStatus);
+        emit finished();
+    }));
+}
+
+QGrpcChannelClientStream::~QGrpcChannelClientStream()
+{
+    waitForCompletions();
+}
+
+QGrpcChannelCall::QGrpcChannelCall(grpc::Channel *channel, const std::shared_ptr<QGrpcChannelQueuePool> &pool, const std::shared_ptr<QGrpcChannelMethod> &method,
+                                   const QByteArray &data, QObject *parent) : QGrpcChannelOperation(pool, method, parent)
+  , m_channel(channel)
+{
+    parseQByteArray(data, m_request);
 }
 
 void QGrpcChannelCall::start()
 {
-    thread->start();
+    reader = grpc::internal::ClientAsyncResponseReaderFactory<grpc::ByteBuffer>::Create(m_channel, m_queue,
+        m_method->rpcMethod,
+        &context, m_request, true);
+    if (span) {
+        span->addEvent(QGrpcSpan::RequestSent);
+    }
+
+    //Response is received by polling thread and is handled in thread of call
+    reader->Finish(&m_response, &m_status, directTag([this](bool) {
+        if (span) {
+            span->addEvent(QGrpcSpan::MessageReceived);
+        }
+        post([this]() {
+            if (m_status.ok()) {
+                setStatus(parseByteBuffer(m_response, response));
+            } else {
+                setStatus(m_status);
+            }
+            emit finished();
+        });
+    }));
 }
 
 QGrpcChannelCall::~QGrpcChannelCall()
 {
-    cancel();
-    thread->wait();
-    thread->deleteLater();
+    waitForCompletions();
 }
 
-void QGrpcChannelCall::cancel()
+QGrpcChannelPrivate::QGrpcChannelPrivate(const QUrl &url, std::shared_ptr<grpc::ChannelCredentials> credentials, const grpc::ChannelArguments &arguments)
 {
-    // TODO: check thread safety
-    qProtoDebug() << "Call thread terminated";
-    context.TryCancel();
+    m_channel = grpc::CreateCustomChannel(url.toString().toStdString(), credentials, arguments);
+    m_pool = std::make_shared<QGrpcChannelQueuePool>(qBound(1, QThread::idealThreadCount(), MaxPollingThreads));
 }
 
-QGrpcChannelPrivate::QGrpcChannelPrivate(const QUrl &url, std::shared_ptr<grpc::ChannelCredentials> credentials)
+QGrpcChannelPrivate::~QGrpcChannelPrivate()
 {
-    m_channel = grpc::CreateChannel(url.toString().toStdString(), credentials);
 }
 
-QGrpcChannelPrivate::~QGrpcChannelPrivate()
+std::shared_ptr<QGrpcChannelMethod> QGrpcChannelPrivate::method(const QString &service, const QString &method, grpc::internal::RpcMethod::RpcType type)
 {
+    QMutexLocker locker(&m_methodsMutex);
+    std::shared_ptr<QGrpcChannelMethod> &cached = m_methods[qMakePair(service, method)];
+    if (!cached || cached->rpcMethod.method_type() != type) {
+        cached = std::make_shared<QGrpcChannelMethod>(service, method, type, m_channel);
+    }
+    return cached;
 }
 
 void QGrpcChannelPrivate::call(const QString &method, const QString &service, const QByteArray &args, QGrpcAsyncReply *reply)
 {
-    QString rpcName = QString("/%1/%2").arg(service).arg(method);
+    std::shared_ptr<QGrpcChannelMethod> rpcMethod = this->method(service, method, grpc::internal::RpcMethod::NORMAL_RPC);
 
     std::shared_ptr<QGrpcChannelCall> call;
     std::shared_ptr<QMetaObject::Connection> connection(new QMetaObject::Connection);
     std::shared_ptr<QMetaObject::Connection> abortConnection(new QMetaObject::Connection);
 
+    //Call is owned by connections only, so it's cancelled and released as soon as reply is aborted or destroyed
     call.reset(
-        new QGrpcChannelCall(m_channel.get(), rpcName, args, reply),
+        new QGrpcChannelCall(m_channel.get(), m_pool, rpcMethod, args),
         [](QGrpcChannelCall * c) { c->deleteLater(); }
     );
 
     *connection = QObject::connect(call.get(), &QGrpcChannelCall::finished, reply, [call, reply, connection, abortConnection](){
+        reply->setMetadata(call->serverMetadata());
         if (call->status.code() == QGrpcStatus::Ok) {
             reply->setData(call->response);
             reply->finished();
@@ -234,33 +549,50 @@ void QGrpcChannelPrivate::call(const QString &method, const QString &service, co
         if (status.code() == QGrpcStatus::Aborted) {
             QObject::disconnect(*connection);
             QObject::disconnect(*abortConnection);
+            //Call is cancelled right away, so server is notified and call is released without waiting for response
+            call->cancel();
         }
     });
 
+    call->applyOptions(m_contextOptions, &reply->options(), true);
+    call->span = reply->span();
     call->start();
 }
 
 QGrpcStatus QGrpcChannelPrivate::call(const QString &method, const QString &service, const QByteArray &args, QByteArray &ret)
 {
-    QEventLoop loop;
-
-    QString rpcName = QString("/%1/%2").arg(service).arg(method);
-    QGrpcChannelCall call(m_channel.get(), rpcName, args);
-
-    QObject::connect(&call, &QGrpcChannelCall::finished, &loop, &QEventLoop::quit);
+    //Call is performed by calling thread, neither event loop nor polling threads are involved
+    std::shared_ptr<QGrpcChannelMethod> rpcMethod = this->method(service, method, grpc::internal::RpcMethod::NORMAL_RPC);
+    grpc::ClientContext context;
+    QGrpcChannelOperation::setupContext(context, m_contextOptions, nullptr, true);
+    grpc::ByteBuffer request;
+    grpc::ByteBuffer response;
+    parseQByteArray(args, request);
 
-    call.start();
-    loop.exec();
+    grpc::Status status = grpc::internal::BlockingUnaryCall(m_channel.get(), rpcMethod->rpcMethod, &context, request, &response);
+    if (status.ok()) {
+        status = parseByteBuffer(response, ret);
+    }
+    return QGrpcChannelOperation::toQGrpcStatus(status);
+}
 
-    ret = call.response;
-    return call.status;
+void QGrpcChannelPrivate::callWithHandler(const QString &method, const QString &service, const QByteArray &args, const CallHandler &handler)
+{
+    //Call is the only QObject created for the call, it's owned by calling thread
+    QGrpcChannelCall *call = new QGrpcChannelCall(m_channel.get(), m_pool, this->method(service, method, grpc::internal::RpcMethod::NORMAL_RPC), args);
+    QObject::connect(call, &QGrpcChannelCall::finished, call, [call, handler]() {
+        handler(call->status, call->response);
+        call->deleteLater();
+    });
+    call->applyOptions(m_contextOptions, nullptr, true);
+    call->start();
 }
 
 void QGrpcChannelPrivate::subscribe(QGrpcStream *stream, const QString &service, QAbstractGrpcClient *client)
 {
     assert(stream != nullptr);
 
-    QString rpcName = QString("/%1/%2").arg(service).arg(stream->method());
+    std::shared_ptr<QGrpcChannelMethod> rpcMethod = method(service, stream->method(), grpc::internal::RpcMethod::SERVER_STREAMING);
 
     std::shared_ptr<QGrpcChannelStream> sub;
     std::shared_ptr<QMetaObject::Connection> abortConnection(new QMetaObject::Connection);
@@ -269,12 +601,24 @@ void QGrpcChannelPrivate::subscribe(QGrpcStream *stream, const QString &service,
     std::shared_ptr<QMetaObject::Connection> connection(new QMetaObject::Connection);
 
     sub.reset(
-        new QGrpcChannelStream(m_channel.get(), rpcName, stream->arg(), stream),
+        new QGrpcChannelStream(m_channel.get(), m_pool, rpcMethod, stream->arg(), stream),
         [](QGrpcChannelStream * sub) { sub->deleteLater(); }
     );
 
-    *readConnection = QObject::connect(sub.get(), &QGrpcChannelStream::dataReady, stream, [stream](const QByteArray &data) {
-        stream->handler(data);
+    *readConnection = QObject::connect(sub.get(), &QGrpcChannelStream::messagesReady, stream, [subPtr = sub.get(), stream]() {
+        std::deque<QByteArray> messages = subPtr->takeMessages();
+        if (messages.empty()) {
+            return;
+        }
+
+        if (stream->isLatestMessageOnly()) {
+            stream->handler(messages.back());
+            return;
+        }
+
+        for (const auto &data : messages) {
+            stream->handler(data);
+        }
     });
 
     *connection = QObject::connect(sub.get(), &QGrpcChannelStream::finished, stream, [sub, stream, readConnection, abortConnection, service, connection, clientConnection](){
@@ -313,11 +657,97 @@ void QGrpcChannelPrivate::subscribe(QGrpcStream *stream, const QString &service,
         sub->cancel();
     });
 
+    sub->applyOptions(m_contextOptions, nullptr, false);
+    sub->span = stream->span();
     sub->start();
 }
 
+void QGrpcChannelPrivate::openStream(QGrpcClientStream *stream, const QString &service, QAbstractGrpcClient *client)
+{
+    assert(stream != nullptr);
+
+    std::shared_ptr<QGrpcChannelMethod> rpcMethod = method(service, stream->method(), grpc::internal::RpcMethod::BIDI_STREAMING);
+
+    std::shared_ptr<QGrpcChannelClientStream> sub;
+    std::shared_ptr<std::vector<QMetaObject::Connection>> connections(new std::vector<QMetaObject::Connection>);
+    std::shared_ptr<bool> writeInFlight(new bool(false));
+    std::shared_ptr<bool> writesDoneSent(new bool(false));
+
+    sub.reset(
+        new QGrpcChannelClientStream(m_channel.get(), m_pool, rpcMethod, stream),
+        [](QGrpcChannelClientStream *sub) { sub->deleteLater(); }
+    );
+
+    auto disconnectAll = [connections]() {
+        for (auto &connection : *connections) {
+            QObject::disconnect(connection);
+        }
+    };
+
+    auto takeNextWrite = [sub, stream, writeInFlight, writesDoneSent]() {
+        if (*writeInFlight || *writesDoneSent) {
+            return;
+        }
+
+        if (stream->hasPendingWrites()) {
+            *writeInFlight = true;
+            sub->write(stream->takePendingWrite());
+        } else if (stream->isWritesDone()) {
+            *writesDoneSent = true;
+            sub->writesDone();
+        }
+    };
+
+    connections->push_back(QObject::connect(stream, &QGrpcClientStream::pendingWritesChanged, sub.get(), takeNextWrite));
+
+    connections->push_back(QObject::connect(sub.get(), &QGrpcChannelClientStream::written, stream, [writeInFlight, takeNextWrite]() {
+        *writeInFlight = false;
+        takeNextWrite();
+    }));
+
+    connections->push_back(QObject::connect(sub.get(), &QGrpcChannelClientStream::messagesReady, stream, [subPtr = sub.get(), stream]() {
+        for (const auto &data : subPtr->takeMessages()) {
+            stream->handler(data);
+        }
+    }));
+
+    connections->push_back(QObject::connect(sub.get(), &QGrpcChannelClientStream::finished, stream, [sub, stream, disconnectAll]() {
+        qProtoDebug() << "Client stream ended with server closing connection";
+        disconnectAll();
+
+        if (sub->status.code() == QGrpcStatus::Ok) {
+            stream->finished();
+        } else {
+            stream->error(sub->status);
+        }
+    }));
+
+    connections->push_back(QObject::connect(stream, &QGrpcClientStream::error, sub.get(), [sub, disconnectAll](const QGrpcStatus &status) {
+        if (status.code() == QGrpcStatus::Aborted) {
+            qProtoDebug() << "Client stream was aborted";
+            disconnectAll();
+            sub->cancel();
+        }
+    }));
+
+    connections->push_back(QObject::connect(client, &QAbstractGrpcClient::destroyed, sub.get(), [sub, disconnectAll]() {
+        qProtoDebug() << "Grpc client was destroyed";
+        disconnectAll();
+        sub->cancel();
+    }));
+
+    sub->applyOptions(m_contextOptions, nullptr, false);
+    sub->start();
+    takeNextWrite();
+}
+
 QGrpcChannel::QGrpcChannel(const QUrl &url, std::shared_ptr<grpc::ChannelCredentials> credentials) : QAbstractGrpcChannel()
-  , dPtr(std::make_unique<QGrpcChannelPrivate>(url, credentials))
+  , dPtr(std::make_unique<QGrpcChannelPrivate>(url, credentials, grpc::ChannelArguments()))
+{
+}
+
+QGrpcChannel::QGrpcChannel(const QUrl &url, std::shared_ptr<grpc::ChannelCredentials> credentials, const grpc::ChannelArguments &arguments) : QAbstractGrpcChannel()
+  , dPtr(std::make_unique<QGrpcChannelPrivate>(url, credentials, arguments))
 {
 }
 
@@ -335,15 +765,71 @@ void QGrpcChannel::call(const QString &method, const QString &service, const QBy
     dPtr->call(method, service, args, reply);
 }
 
+void QGrpcChannel::callWithHandler(const QString &method, const QString &service, const QByteArray &args, const CallHandler &handler)
+{
+    dPtr->callWithHandler(method, service, args, handler);
+}
+
 void QGrpcChannel::subscribe(QGrpcStream *stream, const QString &service, QAbstractGrpcClient *client)
 {
     dPtr->subscribe(stream, service, client);
 }
 
+void QGrpcChannel::openStream(QGrpcClientStream *stream, const QString &service, QAbstractGrpcClient *client)
+{
+    dPtr->openStream(stream, service, client);
+}
+
+bool QGrpcChannel::isThreadSafe() const
+{
+    return true;
+}
+
+void QGrpcChannel::setDefaultDeadline(std::chrono::milliseconds deadline)
+{
+    dPtr->m_contextOptions.deadline = deadline.count();
+}
+
+std::chrono::milliseconds QGrpcChannel::defaultDeadline() const
+{
+    return std::chrono::milliseconds(dPtr->m_contextOptions.deadline.load());
+}
+
+void QGrpcChannel::setDefaultCompression(grpc_compression_algorithm algorithm)
+{
+    dPtr->m_contextOptions.compression = algorithm;
+}
+
+grpc_compression_algorithm QGrpcChannel::defaultCompression() const
+{
+    return static_cast<grpc_compression_algorithm>(dPtr->m_contextOptions.compression.load());
+}
+
+void QGrpcChannel::setWaitForReady(bool waitForReady)
+{
+    dPtr->m_contextOptions.waitForReady = waitForReady;
+}
+
+bool QGrpcChannel::isWaitForReady() const
+{
+    return dPtr->m_contextOptions.waitForReady;
+}
+
 std::shared_ptr<QAbstractProtobufSerializer> QGrpcChannel::serializer() const
 {
-    //TODO: make selection based on credentials or channel settings
-    return QProtobufSerializerRegistry::instance().getSerializer("protobuf");
+    return dPtr->m_serializerPlugin.isEmpty() ? QProtobufSerializerRegistry::instance().getSerializer(dPtr->m_serializerId)
+                                              : QProtobufSerializerRegistry::instance().getSerializer(dPtr->m_serializerId, dPtr->m_serializerPlugin);
+}
+
+bool QGrpcChannel::setSerializer(const QString &id, const QString &plugin)
+{
+    if (QProtobufSerializerRegistry::instance().findSerializer(id, plugin) == nullptr) {
+        qProtoWarning() << "Serializer" << id << "of plugin" << plugin << "is not loaded, channel serializer is not changed";
+        return false;
+    }
+    dPtr->m_serializerId = id;
+    dPtr->m_serializerPlugin = plugin;
+    return true;
 }
 
 }
\ No newline at end of file
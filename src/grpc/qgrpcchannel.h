@@ -27,8 +27,11 @@
 
 #include <QUrl>
 
+#include <grpc/compression.h>
 #include <grpcpp/security/credentials.h>
+#include <grpcpp/support/channel_arguments.h>
 
+#include <chrono>
 #include <memory>
 
 #include "qabstractgrpcchannel.h"
@@ -50,17 +53,87 @@ class Q_GRPC_EXPORT QGrpcChannel final : public QAbstractGrpcChannel
 public:
     /*!
      * \brief QGrpcChannel constructs QGrpcChannel
-     * \param name uri used to establish channel connection
+     * \param name uri used to establish channel connection. Unix domain socket is used as transport for
+     *        "unix:///path/to/socket" uri, to avoid TCP overhead for services running on the same host.
      * \param credentials grpc credientials object
      */
     QGrpcChannel(const QUrl &name, std::shared_ptr<grpc::ChannelCredentials> credentials);
+
+    /*!
+     * \brief QGrpcChannel constructs QGrpcChannel tuned with \a arguments
+     * \details \a arguments are passed to grpc::CreateCustomChannel and configure connection of channel, e.g.:
+     *          \code
+     *          grpc::ChannelArguments arguments;
+     *          arguments.SetMaxReceiveMessageSize(64 * 1024 * 1024);
+     *          arguments.SetInt(GRPC_ARG_KEEPALIVE_TIME_MS, 10000);
+     *          arguments.SetLoadBalancingPolicyName("round_robin");
+     *          auto channel = std::make_shared<QtProtobuf::QGrpcChannel>(url, credentials, arguments);
+     *          \endcode
+     * \param name uri used to establish channel connection
+     * \param credentials grpc credientials object
+     * \param arguments grpc channel arguments
+     */
+    QGrpcChannel(const QUrl &name, std::shared_ptr<grpc::ChannelCredentials> credentials, const grpc::ChannelArguments &arguments);
     ~QGrpcChannel();
 
     QGrpcStatus call(const QString &method, const QString &service, const QByteArray &args, QByteArray &ret) override;
     void call(const QString &method, const QString &service, const QByteArray &args, QtProtobuf::QGrpcAsyncReply *reply) override;
+    void callWithHandler(const QString &method, const QString &service, const QByteArray &args, const CallHandler &handler) override;
     void subscribe(QGrpcStream *stream, const QString &service, QAbstractGrpcClient *client) override;
+    void openStream(QGrpcClientStream *stream, const QString &service, QAbstractGrpcClient *client) override;
     std::shared_ptr<QAbstractProtobufSerializer> serializer() const override;
 
+    /*!
+     * \brief Selects serializer of messages sent and received using channel. Protobuf serializer is used by default.
+     * \details Serializer is taken from \a plugin loaded by QProtobufSerializerRegistry, or from built-in serializers
+     *          if \a plugin is empty. Content type of calls is defined by gRPC library, so server has to expect
+     *          messages of selected format. Serializer is selected before clients are attached to channel.
+     * \return false if serializer is not found, serializer of channel is not changed in this case
+     */
+    bool setSerializer(const QString &id, const QString &plugin = QString());
+    /*!
+     * \brief Returns true. Synchronous call blocks calling thread, no event loop is involved. Completion of
+     *        asynchronous call is delivered to thread of QGrpcAsyncReply.
+     */
+    bool isThreadSafe() const override;
+
+    /*!
+     * \brief Sets deadline of unary calls made using channel. Calls have no deadline by default.
+     * \details Call that is not finished until deadline is aborted with QGrpcStatus::DeadlineExceeded status.
+     *          Deadline of QGrpcCallOptions overrides deadline of channel. Zero \a deadline disables deadline of calls.
+     *          Deadline is applied to calls started after the method call.
+     */
+    void setDefaultDeadline(std::chrono::milliseconds deadline);
+
+    /*!
+     * \brief Returns deadline of unary calls made using channel
+     */
+    std::chrono::milliseconds defaultDeadline() const;
+
+    /*!
+     * \brief Sets compression \a algorithm of messages sent by calls and streams of channel. Messages are
+     *        not compressed by default.
+     */
+    void setDefaultCompression(grpc_compression_algorithm algorithm);
+
+    /*!
+     * \brief Returns compression algorithm of messages sent using channel
+     */
+    grpc_compression_algorithm defaultCompression() const;
+
+    /*!
+     * \brief Makes calls and streams of channel to wait until channel is connected instead of failing
+     *        with QGrpcStatus::Unavailable status when connection is not established. Disabled by default.
+     * \details Waiting is bounded by deadline of call. QGrpcCallOptions::setWaitForReady() overrides channel
+     *          setting for single call.
+     */
+    void setWaitForReady(bool waitForReady);
+
+    /*!
+     * \brief Returns true if calls and streams of channel wait until channel is connected
+     */
+    bool isWaitForReady() const;
+
 private:
     Q_DISABLE_COPY_MOVE(QGrpcChannel)
 
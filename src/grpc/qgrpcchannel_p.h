@@ -22,86 +22,340 @@
  * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
  * DEALINGS IN THE SOFTWARE.
  */
-
-#include <QEventLoop>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
 #include <QThread>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include <grpc/compression.h>
 #include <grpcpp/channel.h>
+#include <grpcpp/impl/codegen/async_stream.h>
+#include <grpcpp/impl/codegen/async_unary_call.h>
 #include <grpcpp/impl/codegen/byte_buffer.h>
 #include <grpcpp/impl/codegen/client_context.h>
-#include <grpcpp/impl/codegen/sync_stream.h>
+#include <grpcpp/impl/codegen/completion_queue.h>
+#include <grpcpp/impl/codegen/rpc_method.h>
+#include <grpcpp/impl/codegen/slice.h>
 #include <grpcpp/security/credentials.h>
 
 #include "qabstractgrpccredentials.h"
 #include "qgrpcasyncreply.h"
+#include "qgrpccalloptions.h"
 #include "qgrpcstream.h"
+#include "qgrpcclientstream.h"
+#include "qgrpctracer.h"
 #include "qabstractgrpcclient.h"
 #include "qgrpccredentials.h"
 #include "qprotobufserializerregistry_p.h"
+#include "qprotobufbufferallocator.h"
 #include "qtprotobuflogging.h"
 
 namespace QtProtobuf {
 
+//Received message is copied once: slices are copied to array preallocated by buffer allocator. QByteArray of
+//Qt5 can't reference foreign memory with custom deleter, so slice data can't be shared.
+static inline grpc::Status parseByteBuffer(const grpc::ByteBuffer &buffer, QByteArray &data)
+{
+    std::vector<grpc::Slice> slices;
+    auto status = buffer.Dump(&slices);
+
+    if (!status.ok())
+        return status;
+
+    const int size = static_cast<int>(buffer.Length());
+    data = QProtobufBufferAllocator::current()->allocate(size);
+    data.resize(size);
+    char *dst = data.data();
+    for (const auto &slice : slices) {
+        memcpy(dst, slice.begin(), slice.size());
+        dst += slice.size();
+    }
+
+    return grpc::Status::OK;
+}
+
+//Sent message is not copied: slice references implicitly shared copy of bytearray, that is released
+//when gRPC doesn't need slice anymore
+static inline void parseQByteArray(const QByteArray &bytearray, grpc::ByteBuffer &buffer)
+{
+    QByteArray *sharedData = new QByteArray(bytearray);
+    grpc::Slice slice(const_cast<char *>(sharedData->constData()), static_cast<size_t>(sharedData->size()),
+                      [](void *userData) { delete static_cast<QByteArray *>(userData); }, sharedData);
+    grpc::ByteBuffer tmp(&slice, 1);
+    buffer.Swap(&tmp);
+}
+
+//! \private
+//! \brief Fixed pool of threads, that poll completion queues of channel operations
+class QGrpcChannelQueuePool {
+public:
+    QGrpcChannelQueuePool(int threadCount);
+    ~QGrpcChannelQueuePool();
+
+    //! \brief Returns completion queues in turn, to spread operations between polling threads
+    grpc::CompletionQueue *queue();
+
+private:
+    Q_DISABLE_COPY_MOVE(QGrpcChannelQueuePool)
+
+    std::vector<std::unique_ptr<grpc::CompletionQueue>> m_queues;
+    std::vector<QThread *> m_threads;
+    std::atomic<size_t> m_next{0};
+};
+
+//! \private
+//! \brief Method of channel, that is created once and reused by all operations that call it
+struct QGrpcChannelMethod {
+    QGrpcChannelMethod(const QString &service, const QString &method, grpc::internal::RpcMethod::RpcType type,
+                       const std::shared_ptr<grpc::Channel> &channel);
+
+    //! \brief Full name of method in "/service/method" form, storage of name used by rpcMethod
+    const std::string name;
+    const grpc::internal::RpcMethod rpcMethod;
+
+private:
+    Q_DISABLE_COPY_MOVE(QGrpcChannelMethod)
+};
+
+//! \private
+//! \brief Options of channel, that are applied to context of each operation. Options may be changed while
+//!        operations are started from other threads.
+struct QGrpcChannelContextOptions {
+    std::atomic<qint64> deadline{0};
+    std::atomic<int> compression{GRPC_COMPRESS_NONE};
+    std::atomic<bool> waitForReady{false};
+};
+
 //! \private
-class QGrpcChannelStream : public QObject {
+//! \brief Base of asynchronous operations, which completions are delivered to thread of operation
+class QGrpcChannelOperation : public QObject {
     //! \private
     Q_OBJECT;
 
 public:
-    QGrpcChannelStream(grpc::Channel *channel, const QString &method, const QByteArray &data, QObject *parent = nullptr);
-    ~QGrpcChannelStream();
+    QGrpcChannelOperation(const std::shared_ptr<QGrpcChannelQueuePool> &pool, const std::shared_ptr<QGrpcChannelMethod> &method, QObject *parent = nullptr);
+    ~QGrpcChannelOperation();
 
     void cancel();
+
+    //! \brief Applies \a channelOptions and \a options of call to context of operation, has to be called before
+    //!        operation is started. Deadline of channel is applied to \a unary calls only.
+    void applyOptions(const QGrpcChannelContextOptions &channelOptions, const QGrpcCallOptions *options, bool unary);
+
+    //! \brief Applies \a channelOptions and \a options of call to \a context
+    static void setupContext(grpc::ClientContext &context, const QGrpcChannelContextOptions &channelOptions,
+                             const QGrpcCallOptions *options, bool unary);
+
+    //! \brief Returns initial and trailing metadata received from server, has to be called after operation is finished
+    QGrpcMetadata serverMetadata() const;
+
+    //! \private
+    //! \brief Completion queue tag
+    struct Tag {
+        QGrpcChannelOperation *operation;
+        std::function<void(bool)> handler;
+        bool direct;
+    };
+
+    //! \brief Invokes handler of completed \a tag in thread of operation, called by polling thread
+    static void complete(Tag *tag, bool ok);
+
+    //! \brief Converts gRPC \a status to QGrpcStatus
+    static QGrpcStatus toQGrpcStatus(const grpc::Status &status);
+
+public:
+    QGrpcStatus status;
+    //! \brief Span of operation, events are recorded by polling thread as soon as messages are received
+    std::shared_ptr<QGrpcSpan> span;
+
+protected:
+    //! \brief Creates tag, which \a handler is invoked in thread of operation when operation is completed
+    void *tag(std::function<void(bool)> handler);
+
+    //! \brief Creates tag, which \a handler is invoked directly in polling thread when operation is completed
+    void *directTag(std::function<void(bool)> handler);
+
+    //! \brief Invokes \a function in thread of operation, may be called from any thread
+    void post(std::function<void()> function);
+
+    //! \brief Cancels operation and waits until all pending tags are completed. Has to be called by
+    //!        destructor of inherited class, because completion queue writes to members of operation.
+    void waitForCompletions();
+
+    void setStatus(const grpc::Status &status);
+
+    std::shared_ptr<QGrpcChannelQueuePool> m_pool;
+    grpc::CompletionQueue *m_queue;
+    std::shared_ptr<QGrpcChannelMethod> m_method;
+    grpc::ClientContext context;
+
+private:
+    QMutex m_tagMutex;
+    QWaitCondition m_tagsCompleted;
+    int m_pendingTags = 0;
+};
+
+//! \private
+//! \brief Base of streams, which messages are read ahead by polling thread and delivered to thread of stream in batches
+class QGrpcChannelStreamBase : public QGrpcChannelOperation {
+    //! \private
+    Q_OBJECT;
+
+public:
+    QGrpcChannelStreamBase(const std::shared_ptr<QGrpcChannelQueuePool> &pool, const std::shared_ptr<QGrpcChannelMethod> &method, QObject *parent = nullptr);
+
+    //! \brief Takes all messages received since last messagesReady() signal
+    std::deque<QByteArray> takeMessages();
+
+signals:
+    //! \brief Emitted once for batch of messages received in between event loop iterations
+    void messagesReady();
+
+protected:
+    //! \brief Starts reading of messages. \a read issues Read operation of stream with given buffer and tag.
+    void startReading(std::function<void(grpc::ByteBuffer *, void *)> read);
+
+    //! \brief Invoked in thread of stream after all received messages are delivered and server closed stream
+    virtual void readsFinished() = 0;
+
+    grpc::Status m_parseStatus;
+
+private:
+    void read();
+
+    std::function<void(grpc::ByteBuffer *, void *)> m_read;
+    grpc::ByteBuffer m_response;
+    QMutex m_messagesMutex;
+    std::deque<QByteArray> m_messages;
+    bool m_deliveryPosted = false;
+    bool m_readPaused = false;
+};
+
+//! \private
+class QGrpcChannelStream : public QGrpcChannelStreamBase {
+    //! \private
+    Q_OBJECT;
+
+public:
+    QGrpcChannelStream(grpc::Channel *channel, const std::shared_ptr<QGrpcChannelQueuePool> &pool, const std::shared_ptr<QGrpcChannelMethod> &method, const QByteArray &data, QObject *parent = nullptr);
+    ~QGrpcChannelStream();
+
     void start();
 
 signals:
-    void dataReady(const QByteArray &data);
     void finished();
 
+protected:
+    void readsFinished() override;
+
+private:
+    void finish();
+
+    grpc::Channel *m_channel;
+    grpc::ByteBuffer m_request;
+    grpc::Status m_status;
+    //Reader is allocated in arena of call and released by gRPC
+    grpc::ClientAsyncReader<grpc::ByteBuffer> *reader = nullptr;
+};
+
+//! \private
+class QGrpcChannelClientStream : public QGrpcChannelStreamBase {
+    //! \private
+    Q_OBJECT;
+
 public:
-    QGrpcStatus status;
+    QGrpcChannelClientStream(grpc::Channel *channel, const std::shared_ptr<QGrpcChannelQueuePool> &pool, const std::shared_ptr<QGrpcChannelMethod> &method, QObject *parent = nullptr);
+    ~QGrpcChannelClientStream();
+
+    void start();
+    void write(const QByteArray &data);
+    void writesDone();
+
+signals:
+    void written();
+    void finished();
+
+protected:
+    void readsFinished() override;
 
 private:
-    QThread *thread;
-    grpc::ClientContext context;
-    grpc::ClientReader<grpc::ByteBuffer> *reader = nullptr;
+    void writeNext();
+    void finish();
+
+    grpc::Channel *m_channel;
+    grpc::ByteBuffer m_writeBuffer;
+    grpc::Status m_status;
+    QByteArray m_pendingWrite;
+    bool m_hasPendingWrite = false;
+    bool m_writesDoneRequested = false;
+    bool m_started = false;
+    bool m_writeInFlight = false;
+    bool m_writesDone = false;
+    bool m_readsDone = false;
+    bool m_finishing = false;
+    //Stream is allocated in arena of call and released by gRPC
+    grpc::ClientAsyncReaderWriter<grpc::ByteBuffer, grpc::ByteBuffer> *stream = nullptr;
 };
 
 //! \private
-class QGrpcChannelCall : public QObject {
+class QGrpcChannelCall : public QGrpcChannelOperation {
     //! \private
     Q_OBJECT;
 
 public:
-    QGrpcChannelCall(grpc::Channel *channel, const QString &method, const QByteArray &data, QObject *parent = nullptr);
+    QGrpcChannelCall(grpc::Channel *channel, const std::shared_ptr<QGrpcChannelQueuePool> &pool, const std::shared_ptr<QGrpcChannelMethod> &method, const QByteArray &data, QObject *parent = nullptr);
     ~QGrpcChannelCall();
 
-    void cancel();
     void start();
 
 signals:
     void finished();
 
 public:
-    QGrpcStatus status;
     QByteArray response;
 
 private:
-    QThread *thread;
-    grpc::ClientContext context;
+    grpc::Channel *m_channel;
+    grpc::ByteBuffer m_request;
+    grpc::ByteBuffer m_response;
+    grpc::Status m_status;
+    //Reader is allocated in arena of call and released by gRPC
+    grpc::ClientAsyncResponseReader<grpc::ByteBuffer> *reader = nullptr;
 };
 
 //! \private
 struct QGrpcChannelPrivate {
     //! \private
     std::shared_ptr<grpc::Channel> m_channel;
+    std::shared_ptr<QGrpcChannelQueuePool> m_pool;
+    QString m_serializerId = QLatin1String("protobuf");
+    QString m_serializerPlugin;
+    QGrpcChannelContextOptions m_contextOptions;
 
-    QGrpcChannelPrivate(const QUrl &url, std::shared_ptr<grpc::ChannelCredentials> credentials);
+    QGrpcChannelPrivate(const QUrl &url, std::shared_ptr<grpc::ChannelCredentials> credentials, const grpc::ChannelArguments &arguments);
     ~QGrpcChannelPrivate();
 
+    //! \brief Returns cached method of \a service, creates it at first call
+    std::shared_ptr<QGrpcChannelMethod> method(const QString &service, const QString &method, grpc::internal::RpcMethod::RpcType type);
+
     void call(const QString &method, const QString &service, const QByteArray &args, QGrpcAsyncReply *reply);
     QGrpcStatus call(const QString &method, const QString &service, const QByteArray &args, QByteArray &ret);
+    void callWithHandler(const QString &method, const QString &service, const QByteArray &args, const CallHandler &handler);
     void subscribe(QGrpcStream *stream, const QString &service, QAbstractGrpcClient *client);
+    void openStream(QGrpcClientStream *stream, const QString &service, QAbstractGrpcClient *client);
+
+private:
+    QMutex m_methodsMutex;
+    QHash<QPair<QString, QString>, std::shared_ptr<QGrpcChannelMethod>> m_methods;
 };
 
 };
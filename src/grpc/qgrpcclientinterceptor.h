@@ -0,0 +1,105 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QGrpcClientInterceptor
+
+#include <QByteArray>
+#include <QString>
+
+#include <functional>
+
+#include "qgrpccalloptions.h"
+#include "qgrpcstatus.h"
+#include "qtgrpcglobal.h"
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcClientInterceptor class is base of interceptors, that observe or modify calls of QAbstractGrpcClient
+ * \details Interceptors are added to client using QAbstractGrpcClient::addInterceptor() and are invoked in order
+ *          they are added, the first one is the outermost. Every interceptor of unary call decides, whether the call
+ *          is passed to next interceptor and finally to channel, how many times and with what argument and options.
+ *          Responses are passed back through handlers given to next interceptors. This way interceptors implement
+ *          logging, retries, caching or refreshing of credentials without subclassing of channels.
+ *          \code{.cpp}
+ *          class RetryInterceptor : public QtProtobuf::QGrpcClientInterceptor {
+ *          public:
+ *              void interceptCall(const QString &service, const QString &method, const QByteArray &arg,
+ *                                 const QtProtobuf::QGrpcCallOptions &options, const ResponseHandler &handler,
+ *                                 const Next &next) override {
+ *                  next(arg, options, [=](const QtProtobuf::QGrpcStatus &status, const QByteArray &data,
+ *                                         const QtProtobuf::QGrpcMetadata &metadata) {
+ *                      if (status.code() == QtProtobuf::QGrpcStatus::Unavailable) {
+ *                          next(arg, options, handler);
+ *                      } else {
+ *                          handler(status, data, metadata);
+ *                      }
+ *                  });
+ *              }
+ *          };
+ *          \endcode
+ *          Serialized messages are passed as implicitly shared QByteArray, so they aren't copied unless interceptor
+ *          modifies them. Interceptors are invoked in thread, that makes call. Handlers have to be invoked in the same
+ *          thread. For synchronous calls next and handler have to be invoked before interceptCall() returns.
+ */
+class Q_GRPC_EXPORT QGrpcClientInterceptor
+{
+public:
+    //! \brief Receives status, serialized response message and metadata of call
+    using ResponseHandler = std::function<void(const QGrpcStatus &status, const QByteArray &data, const QGrpcMetadata &metadata)>;
+    //! \brief Passes call to next interceptor or to channel, may be invoked more than once to repeat call
+    using Next = std::function<void(const QByteArray &arg, const QGrpcCallOptions &options, const ResponseHandler &handler)>;
+
+    virtual ~QGrpcClientInterceptor();
+
+    /*!
+     * \brief Intercepts unary call of \p method of \p service with serialized argument \p arg
+     * \details Default implementation passes call to \p next as is. Metadata of \p options is sent only with
+     *          asynchronous calls, that return QGrpcAsyncReply. Metadata received from server is passed to
+     *          handler for the same calls only.
+     * \param[in] handler receives result of call, has to be invoked once
+     * \param[in] next passes call further
+     */
+    virtual void interceptCall(const QString &service, const QString &method, const QByteArray &arg,
+                               const QGrpcCallOptions &options, const ResponseHandler &handler, const Next &next);
+
+    /*!
+     * \brief Intercepts start of server stream or client stream of \p method of \p service
+     * \details \p arg is serialized argument of server stream and may be modified, it's empty for client
+     *          streams. Stream is not started and error is reported, if returned status is not QGrpcStatus::Ok.
+     *          Default implementation returns QGrpcStatus::Ok.
+     */
+    virtual QGrpcStatus interceptStream(const QString &service, const QString &method, QByteArray &arg);
+
+    /*!
+     * \brief Intercepts message \p data received by stream of \p method of \p service before it's passed to handlers
+     *        of stream
+     * \details \p data may be modified. Message is dropped if false is returned. Default implementation returns true.
+     */
+    virtual bool interceptStreamMessage(const QString &service, const QString &method, QByteArray &data);
+};
+
+}
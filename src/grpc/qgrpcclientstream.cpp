@@ -0,0 +1,90 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qgrpcclientstream.h"
+
+#include <qtprotobuflogging.h>
+#include <QThread>
+
+using namespace QtProtobuf;
+
+QGrpcClientStream::QGrpcClientStream(const std::shared_ptr<QAbstractGrpcChannel> &channel, const QString &method,
+                                     QAbstractGrpcClient *parent) : QGrpcAsyncOperationBase(channel, parent)
+  , m_method(method)
+{
+}
+
+bool QGrpcClientStream::writeData(const QByteArray &data)
+{
+    if (m_writesDone) {
+        qProtoWarning() << "Unable to write to" << m_method << "stream, writes are done";
+        return false;
+    }
+
+    //Empty queue accepts message of any size, otherwise stream would be blocked by big message forever
+    if (!m_pendingWrites.empty() && m_bytesToWrite + data.size() > m_writeBufferSize) {
+        m_writeBlocked = true;
+        return false;
+    }
+
+    m_pendingWrites.push_back(data);
+    m_bytesToWrite += data.size();
+    pendingWritesChanged();
+    return true;
+}
+
+void QGrpcClientStream::writesDone()
+{
+    if (m_writesDone) {
+        return;
+    }
+    m_writesDone = true;
+    pendingWritesChanged();
+}
+
+QByteArray QGrpcClientStream::takePendingWrite()
+{
+    if (m_pendingWrites.empty()) {
+        return {};
+    }
+
+    QByteArray data = std::move(m_pendingWrites.front());
+    m_pendingWrites.pop_front();
+    m_bytesToWrite -= data.size();
+    if (m_writeBlocked && m_bytesToWrite < m_writeBufferSize) {
+        m_writeBlocked = false;
+        readyWrite();
+    }
+    return data;
+}
+
+void QGrpcClientStream::cancel()
+{
+    if (thread() != QThread::currentThread()) {
+        QMetaObject::invokeMethod(this, [this](){m_channel->cancel(this);}, Qt::BlockingQueuedConnection);
+    } else {
+        m_channel->cancel(this);
+    }
+}
@@ -0,0 +1,180 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QGrpcClientStream
+
+#include <QByteArray>
+#include <QString>
+
+#include <deque>
+#include <memory>
+
+#include "qabstractgrpcchannel.h"
+#include "qabstractgrpcclient.h"
+#include "qgrpcasyncoperationbase_p.h"
+
+#include "qtgrpcglobal.h"
+
+namespace QtProtobuf {
+
+class QAbstractGrpcClient;
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcClientStream class is client side of client-streaming and bidirectional-streaming calls
+ * \details Messages written to stream are queued until channel is ready to send them. Queue size is limited by
+ *          writeBufferSize(), write() returns false if message doesn't fit the queue and readyWrite() signal is
+ *          emitted once channel took enough messages to continue writing. Messages received from server are
+ *          accessible using read() method when messageReceived() signal is emitted. finished() signal is emitted
+ *          when server closed stream with Ok status, error() signal is emitted otherwise.
+ */
+class Q_GRPC_EXPORT QGrpcClientStream final : public QGrpcAsyncOperationBase
+{
+    Q_OBJECT
+public:
+    /*!
+     * \brief Writes \a message to stream
+     * \return false if write buffer is full or writesDone() is already called, message is not sent in this case
+     */
+    template<typename T>
+    bool write(const T &message) {
+        return writeData(message.serialize(serializer()));
+    }
+
+    /*!
+     * \brief Writes serialized message \a data to stream
+     * \see write
+     */
+    bool writeData(const QByteArray &data);
+
+    /*!
+     * \brief Notifies server that client will not write messages anymore. Messages that are already written are still sent.
+     */
+    void writesDone();
+
+    /*!
+     * \brief Returns true if writesDone() was called for this stream
+     */
+    bool isWritesDone() const {
+        return m_writesDone;
+    }
+
+    /*!
+     * \brief Cancels this stream and try to abort call in channel
+     */
+    void cancel();
+
+    /*!
+     * \brief Returns method for this stream
+     */
+    QString method() const {
+        return m_method;
+    }
+
+    /*!
+     * \brief Returns size of messages in bytes, that are written but not taken by channel yet
+     */
+    qint64 bytesToWrite() const {
+        return m_bytesToWrite;
+    }
+
+    /*!
+     * \brief Sets limit of bytesToWrite(). Default limit is 4 MiB.
+     */
+    void setWriteBufferSize(qint64 size) {
+        m_writeBufferSize = size;
+    }
+
+    /*!
+     * \brief Returns limit of bytesToWrite()
+     */
+    qint64 writeBufferSize() const {
+        return m_writeBufferSize;
+    }
+
+    /*!
+     * \brief Returns true if there are messages that are written but not taken by channel yet
+     * \details Should be used by QAbstractGrpcChannel implementations.
+     */
+    bool hasPendingWrites() const {
+        return !m_pendingWrites.empty();
+    }
+
+    /*!
+     * \brief Takes next written message out of stream queue
+     * \details Should be used by QAbstractGrpcChannel implementations, when channel is ready to send
+     *          next message. Emits readyWrite() if queue had no room for messages before.
+     */
+    QByteArray takePendingWrite();
+
+    /*!
+     * \brief Invokes handlers of message received from server
+     * \details Should be used by QAbstractGrpcChannel implementations, to update data in stream and notify
+     *          clients about received messages.
+     */
+    void handler(const QByteArray &data) {
+        //Message is shared with interceptors, it's copied only if interceptor modifies it
+        QByteArray message(data);
+        if (!interceptMessage(message)) {
+            return;
+        }
+        setData(message);
+        messageReceived();
+    }
+
+signals:
+    /*!
+     * \brief The signal is emitted when stream received message from server
+     */
+    void messageReceived();
+
+    /*!
+     * \brief The signal is emitted when write buffer has room for messages again after write() failed
+     */
+    void readyWrite();
+
+    /*!
+     * \brief The signal is emitted when message is written to stream or writesDone() is called
+     * \details Should be used by QAbstractGrpcChannel implementations, to take pending messages.
+     */
+    void pendingWritesChanged();
+
+protected:
+    //! \private
+    QGrpcClientStream(const std::shared_ptr<QAbstractGrpcChannel> &channel, const QString &method, QAbstractGrpcClient *parent);
+    //! \private
+    virtual ~QGrpcClientStream() = default;
+
+private:
+    friend class QAbstractGrpcClient;
+    QString m_method;
+    std::deque<QByteArray> m_pendingWrites;
+    qint64 m_bytesToWrite = 0;
+    qint64 m_writeBufferSize = 4 * 1024 * 1024;
+    bool m_writesDone = false;
+    bool m_writeBlocked = false;
+};
+
+}
@@ -0,0 +1,233 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qgrpcconcurrencylimiter.h"
+
+#include <QAbstractEventDispatcher>
+#include <QElapsedTimer>
+#include <QLatin1String>
+#include <QMutex>
+#include <QThread>
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "qtprotobuflogging.h"
+
+namespace QtProtobuf {
+
+//! \private
+struct QGrpcConcurrencyLimiterPrivate {
+    QGrpcConcurrencyLimiterPrivate(int initialLimit, int _minLimit, int _maxLimit) : minLimit(std::max(1, _minLimit))
+      , maxLimit(std::max(minLimit, _maxLimit))
+      , limit(qBound(minLimit, initialLimit, maxLimit))
+    {}
+
+    //! \private
+    //! \brief Call waiting for free slot, it's started in thread that made the call
+    struct QueuedCall {
+        QThread *thread;
+        std::function<void()> start;
+    };
+
+    //! \brief Returns total number of queued calls, has to be called with mutex locked
+    int queued() const {
+        size_t count = 0;
+        for (const auto &queue : queues) {
+            count += queue.size();
+        }
+        return static_cast<int>(count);
+    }
+
+    //! \brief Returns true if call is admitted without waiting, has to be called with mutex locked
+    bool hasFreeSlot() const {
+        return inFlight < static_cast<int>(limit);
+    }
+
+    //! \brief Releases slot of completed call, adapts limit and takes calls, that are admitted to released slots
+    std::vector<QueuedCall> release(QGrpcStatus::StatusCode code, std::chrono::milliseconds latency) {
+        QMutexLocker locker(&mutex);
+        --inFlight;
+        const bool overloaded = code == QGrpcStatus::ResourceExhausted || code == QGrpcStatus::Unavailable
+                || code == QGrpcStatus::DeadlineExceeded
+                || (latencyThreshold.count() > 0 && latency > latencyThreshold);
+        if (overloaded) {
+            limit = std::max(static_cast<double>(minLimit), limit * backoffRatio);
+            qProtoDebug() << "Concurrency limit is decreased to" << static_cast<int>(limit);
+        } else if (code == QGrpcStatus::Ok) {
+            limit = std::min(static_cast<double>(maxLimit), limit + 1.0 / limit);
+        }
+
+        std::vector<QueuedCall> admitted;
+        for (int priority = QGrpcCallOptions::HighPriority; priority >= QGrpcCallOptions::LowPriority; --priority) {
+            auto &queue = queues[priority];
+            while (hasFreeSlot() && !queue.empty()) {
+                ++inFlight;
+                admitted.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+        }
+        return admitted;
+    }
+
+    const int minLimit;
+    const int maxLimit;
+    mutable QMutex mutex;
+    double limit;
+    std::chrono::milliseconds latencyThreshold = std::chrono::milliseconds::zero();
+    double backoffRatio = 0.9;
+    int maxQueued = 0;
+    int inFlight = 0;
+    qint64 rejected = 0;
+    //Queues are indexed by QGrpcCallOptions::Priority
+    std::deque<QueuedCall> queues[QGrpcCallOptions::HighPriority + 1];
+};
+
+}
+
+using namespace QtProtobuf;
+
+namespace {
+
+void startCall(const std::shared_ptr<QGrpcConcurrencyLimiterPrivate> &limiter, const QByteArray &arg, const QGrpcCallOptions &options,
+               const QGrpcClientInterceptor::ResponseHandler &handler, const QGrpcClientInterceptor::Next &next)
+{
+    QElapsedTimer timer;
+    timer.start();
+    next(arg, options, [limiter, handler, timer](const QGrpcStatus &status, const QByteArray &data, const QGrpcMetadata &metadata) {
+        const std::vector<QGrpcConcurrencyLimiterPrivate::QueuedCall> admitted =
+                limiter->release(status.code(), std::chrono::milliseconds(timer.elapsed()));
+        handler(status, data, metadata);
+
+        for (const auto &call : admitted) {
+            if (call.thread == QThread::currentThread()) {
+                call.start();
+                continue;
+            }
+            //Event dispatcher lives in thread of call, so queued call is started in that thread
+            QAbstractEventDispatcher *dispatcher = QAbstractEventDispatcher::instance(call.thread);
+            if (dispatcher != nullptr) {
+                QMetaObject::invokeMethod(dispatcher, call.start, Qt::QueuedConnection);
+            } else {
+                call.start();
+            }
+        }
+    });
+}
+
+}
+
+QGrpcConcurrencyLimiter::QGrpcConcurrencyLimiter(int initialLimit, int minLimit, int maxLimit) :
+    dPtr(std::make_shared<QGrpcConcurrencyLimiterPrivate>(initialLimit, minLimit, maxLimit))
+{
+}
+
+QGrpcConcurrencyLimiter::~QGrpcConcurrencyLimiter() = default;
+
+void QGrpcConcurrencyLimiter::setLatencyThreshold(std::chrono::milliseconds threshold)
+{
+    QMutexLocker locker(&dPtr->mutex);
+    dPtr->latencyThreshold = std::max(std::chrono::milliseconds::zero(), threshold);
+}
+
+std::chrono::milliseconds QGrpcConcurrencyLimiter::latencyThreshold() const
+{
+    QMutexLocker locker(&dPtr->mutex);
+    return dPtr->latencyThreshold;
+}
+
+void QGrpcConcurrencyLimiter::setBackoffRatio(double ratio)
+{
+    QMutexLocker locker(&dPtr->mutex);
+    dPtr->backoffRatio = qBound(0.1, ratio, 1.0);
+}
+
+double QGrpcConcurrencyLimiter::backoffRatio() const
+{
+    QMutexLocker locker(&dPtr->mutex);
+    return dPtr->backoffRatio;
+}
+
+void QGrpcConcurrencyLimiter::setMaxQueued(int maxQueued)
+{
+    QMutexLocker locker(&dPtr->mutex);
+    dPtr->maxQueued = std::max(0, maxQueued);
+}
+
+int QGrpcConcurrencyLimiter::maxQueued() const
+{
+    QMutexLocker locker(&dPtr->mutex);
+    return dPtr->maxQueued;
+}
+
+int QGrpcConcurrencyLimiter::limit() const
+{
+    QMutexLocker locker(&dPtr->mutex);
+    return static_cast<int>(dPtr->limit);
+}
+
+int QGrpcConcurrencyLimiter::inFlightCount() const
+{
+    QMutexLocker locker(&dPtr->mutex);
+    return dPtr->inFlight;
+}
+
+int QGrpcConcurrencyLimiter::queuedCount() const
+{
+    QMutexLocker locker(&dPtr->mutex);
+    return dPtr->queued();
+}
+
+qint64 QGrpcConcurrencyLimiter::rejectedCount() const
+{
+    QMutexLocker locker(&dPtr->mutex);
+    return dPtr->rejected;
+}
+
+void QGrpcConcurrencyLimiter::interceptCall(const QString &, const QString &method, const QByteArray &arg,
+                                            const QGrpcCallOptions &options, const ResponseHandler &handler, const Next &next)
+{
+    std::shared_ptr<QGrpcConcurrencyLimiterPrivate> limiter = dPtr;
+    {
+        QMutexLocker locker(&limiter->mutex);
+        if (!limiter->hasFreeSlot()) {
+            if (limiter->queued() >= limiter->maxQueued) {
+                ++limiter->rejected;
+                locker.unlock();
+                qProtoDebug() << "Call of" << method << "is rejected by concurrency limiter";
+                handler({QGrpcStatus::ResourceExhausted, QLatin1String("Concurrency limit of client is reached")}, {}, {});
+                return;
+            }
+
+            limiter->queues[options.priority()].push_back({QThread::currentThread(), [limiter, arg, options, handler, next] {
+                startCall(limiter, arg, options, handler, next);
+            }});
+            return;
+        }
+        ++limiter->inFlight;
+    }
+    startCall(limiter, arg, options, handler, next);
+}
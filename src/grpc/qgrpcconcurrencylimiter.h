@@ -0,0 +1,134 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QGrpcConcurrencyLimiter
+
+#include <chrono>
+#include <memory>
+
+#include "qgrpcclientinterceptor.h"
+#include "qtgrpcglobal.h"
+
+namespace QtProtobuf {
+
+struct QGrpcConcurrencyLimiterPrivate;
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcConcurrencyLimiter class limits number of unary calls in flight, adapting limit to load of server
+ * \details Limit is adjusted using additive increase/multiplicative decrease: every successful call increases
+ *          limit by 1/limit, so limit grows by one per round of calls; call failed with
+ *          QGrpcStatus::ResourceExhausted, QGrpcStatus::Unavailable or QGrpcStatus::DeadlineExceeded status, or
+ *          call slower than latencyThreshold() multiplies limit by backoffRatio(). Calls over limit wait in queue
+ *          of limiter, calls of higher QGrpcCallOptions::priority() are started first. Calls that don't fit queue
+ *          fail immediately with QGrpcStatus::ResourceExhausted status, so clients don't pile requests on server
+ *          that is already overloaded.
+ *          \code{.cpp}
+ *          auto limiter = std::make_shared<QtProtobuf::QGrpcConcurrencyLimiter>(20);
+ *          limiter->setLatencyThreshold(std::chrono::milliseconds(500));
+ *          limiter->setMaxQueued(100);
+ *          testClient.addInterceptor(limiter);
+ *          \endcode
+ *          Limiter may be added to several clients of the same server, to share limit between them.
+ *          \note Queued calls are started once other calls are completed, that never happens for synchronous
+ *                calls. Queue should be used with asynchronous calls only, synchronous calls over limit fail
+ *                if queue is disabled.
+ */
+class Q_GRPC_EXPORT QGrpcConcurrencyLimiter : public QGrpcClientInterceptor
+{
+public:
+    /*!
+     * \brief Constructs limiter
+     * \param initialLimit limit of calls in flight, that is used until it's adapted
+     * \param minLimit minimal limit, that is kept even if server is overloaded
+     * \param maxLimit maximal limit of calls in flight
+     */
+    QGrpcConcurrencyLimiter(int initialLimit = 20, int minLimit = 1, int maxLimit = 1000);
+    ~QGrpcConcurrencyLimiter() override;
+
+    /*!
+     * \brief Sets latency of call, that is considered as sign of overloaded server. Zero \a threshold, that is
+     *        default, makes limit to depend on statuses of calls only.
+     */
+    void setLatencyThreshold(std::chrono::milliseconds threshold);
+
+    /*!
+     * \brief Returns latency of call, that is considered as sign of overloaded server
+     */
+    std::chrono::milliseconds latencyThreshold() const;
+
+    /*!
+     * \brief Sets ratio, that limit is multiplied by when server is overloaded. \a ratio is bounded to
+     *        [0.1, 1.0] range, default ratio is 0.9.
+     */
+    void setBackoffRatio(double ratio);
+
+    /*!
+     * \brief Returns ratio, that limit is multiplied by when server is overloaded
+     */
+    double backoffRatio() const;
+
+    /*!
+     * \brief Sets maximum number of calls waiting for free slot. Zero, that is default, makes calls over limit
+     *        to fail immediately.
+     */
+    void setMaxQueued(int maxQueued);
+
+    /*!
+     * \brief Returns maximum number of calls waiting for free slot
+     */
+    int maxQueued() const;
+
+    /*!
+     * \brief Returns current limit of calls in flight
+     */
+    int limit() const;
+
+    /*!
+     * \brief Returns number of calls in flight
+     */
+    int inFlightCount() const;
+
+    /*!
+     * \brief Returns number of calls waiting for free slot
+     */
+    int queuedCount() const;
+
+    /*!
+     * \brief Returns number of calls failed by limiter with QGrpcStatus::ResourceExhausted status
+     */
+    qint64 rejectedCount() const;
+
+    void interceptCall(const QString &service, const QString &method, const QByteArray &arg,
+                       const QGrpcCallOptions &options, const ResponseHandler &handler, const Next &next) override;
+
+private:
+    Q_DISABLE_COPY_MOVE(QGrpcConcurrencyLimiter)
+
+    //Shared with handlers of calls in flight, which may outlive limiter
+    std::shared_ptr<QGrpcConcurrencyLimiterPrivate> dPtr;
+};
+
+}
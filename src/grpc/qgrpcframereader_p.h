@@ -0,0 +1,168 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QIODevice>
+#include <QNetworkReply>
+#include <QtEndian>
+
+#include <unordered_map>
+
+#include "qgrpcstatus.h"
+#include "qprotobufbufferallocator.h"
+#include "qtprotobuflogging.h"
+
+namespace QtProtobuf {
+
+/*!
+ * \private
+ * \brief Incremental parser of gRPC length-prefixed messages, that is used by HTTP/2 and gRPC-Web channels
+ * \details Frames are read from device directly to header and preallocated message payload, so received
+ *          bytes are copied once and completed message is handed out without copying
+ */
+struct QGrpcFrameReader {
+    enum Status {
+        NeedMoreData,
+        MessageReady,
+        InvalidFrame
+    };
+
+    //! \brief Bits of frame flags byte
+    enum Flag {
+        CompressedFlag = 0x01,
+        //gRPC-Web sends trailers as the last frame of response body
+        TrailersFlag = 0x80
+    };
+
+    static constexpr int HeaderSize = 5;
+
+    char header[HeaderSize];
+    int headerSize = 0;
+    QByteArray message;
+    //Size of message payload, negative while frame header is not received completely
+    int expectedSize = -1;
+    //Size of message payload that is already received
+    int receivedSize = 0;
+    //Compressed flag of the frame
+    bool compressed = false;
+    //Trailers flag of the frame
+    bool trailers = false;
+
+    Status read(QIODevice *device) {
+        if (expectedSize < 0) {
+            const qint64 headerBytes = device->read(header + headerSize, HeaderSize - headerSize);
+            if (headerBytes < 0) {
+                return InvalidFrame;
+            }
+            headerSize += headerBytes;
+            if (headerSize < HeaderSize) {
+                return NeedMoreData;
+            }
+            headerSize = 0;
+            const quint8 flags = static_cast<quint8>(header[0]);
+            compressed = (flags & CompressedFlag) != 0;
+            trailers = (flags & TrailersFlag) != 0;
+            expectedSize = qFromBigEndian<qint32>(header + 1);
+            if (expectedSize < 0) {
+                qProtoWarning() << "Invalid message size received" << expectedSize;
+                expectedSize = -1;
+                return InvalidFrame;
+            }
+            message = QProtobufBufferAllocator::current()->allocate(expectedSize);
+            message.resize(expectedSize);
+            receivedSize = 0;
+        }
+
+        const qint64 payloadBytes = device->read(message.data() + receivedSize, expectedSize - receivedSize);
+        if (payloadBytes < 0) {
+            return InvalidFrame;
+        }
+        receivedSize += payloadBytes;
+        qProtoDebug() << "Proceed frame: " << payloadBytes << " message: " << receivedSize << " capacity: " << expectedSize;
+        if (receivedSize < expectedSize) {
+            return NeedMoreData;
+        }
+        expectedSize = -1;
+        return MessageReady;
+    }
+
+    QByteArray takeMessage() {
+        QByteArray result;
+        result.swap(message);
+        return result;
+    }
+
+    //! \brief Returns true if no frame is received partially
+    bool isComplete() const {
+        return expectedSize < 0 && headerSize == 0;
+    }
+};
+
+/*!
+ * \private
+ * \brief Returns gRPC status of failed network request
+ * \details This QNetworkReply::NetworkError -> QGrpcStatus::StatusCode mapping should be kept in sync with original
+ *          <a href="https://github.com/grpc/grpc/blob/master/doc/statuscodes.md">gRPC status codes</a>
+ */
+inline QGrpcStatus::StatusCode grpcStatusOfNetworkError(QNetworkReply::NetworkError error) {
+    static const std::unordered_map<QNetworkReply::NetworkError, QGrpcStatus::StatusCode> StatusCodeMap = {
+                                                                { QNetworkReply::ConnectionRefusedError, QGrpcStatus::Unavailable },
+                                                                { QNetworkReply::RemoteHostClosedError, QGrpcStatus::Unavailable },
+                                                                { QNetworkReply::HostNotFoundError, QGrpcStatus::Unavailable },
+                                                                { QNetworkReply::TimeoutError, QGrpcStatus::DeadlineExceeded },
+                                                                { QNetworkReply::OperationCanceledError, QGrpcStatus::Unavailable },
+                                                                { QNetworkReply::SslHandshakeFailedError, QGrpcStatus::PermissionDenied },
+                                                                { QNetworkReply::TemporaryNetworkFailureError, QGrpcStatus::Unknown },
+                                                                { QNetworkReply::NetworkSessionFailedError, QGrpcStatus::Unavailable },
+                                                                { QNetworkReply::BackgroundRequestNotAllowedError, QGrpcStatus::Unknown },
+                                                                { QNetworkReply::TooManyRedirectsError, QGrpcStatus::Unavailable },
+                                                                { QNetworkReply::InsecureRedirectError, QGrpcStatus::PermissionDenied },
+                                                                { QNetworkReply::UnknownNetworkError, QGrpcStatus::Unknown },
+                                                                { QNetworkReply::ProxyConnectionRefusedError, QGrpcStatus::Unavailable },
+                                                                { QNetworkReply::ProxyConnectionClosedError, QGrpcStatus::Unavailable },
+                                                                { QNetworkReply::ProxyNotFoundError, QGrpcStatus::Unavailable },
+                                                                { QNetworkReply::ProxyTimeoutError, QGrpcStatus::DeadlineExceeded },
+                                                                { QNetworkReply::ProxyAuthenticationRequiredError, QGrpcStatus::Unauthenticated },
+                                                                { QNetworkReply::UnknownProxyError, QGrpcStatus::Unknown },
+                                                                { QNetworkReply::ContentAccessDenied, QGrpcStatus::PermissionDenied },
+                                                                { QNetworkReply::ContentOperationNotPermittedError, QGrpcStatus::PermissionDenied },
+                                                                { QNetworkReply::ContentNotFoundError, QGrpcStatus::NotFound },
+                                                                { QNetworkReply::AuthenticationRequiredError, QGrpcStatus::PermissionDenied },
+                                                                { QNetworkReply::ContentReSendError, QGrpcStatus::DataLoss },
+                                                                { QNetworkReply::ContentConflictError, QGrpcStatus::InvalidArgument },
+                                                                { QNetworkReply::ContentGoneError, QGrpcStatus::DataLoss },
+                                                                { QNetworkReply::UnknownContentError, QGrpcStatus::Unknown },
+                                                                { QNetworkReply::ProtocolUnknownError, QGrpcStatus::Unknown },
+                                                                { QNetworkReply::ProtocolInvalidOperationError, QGrpcStatus::Unimplemented },
+                                                                { QNetworkReply::ProtocolFailure, QGrpcStatus::Unknown },
+                                                                { QNetworkReply::InternalServerError, QGrpcStatus::Internal },
+                                                                { QNetworkReply::OperationNotImplementedError, QGrpcStatus::Unimplemented },
+                                                                { QNetworkReply::ServiceUnavailableError, QGrpcStatus::Unavailable },
+                                                                { QNetworkReply::UnknownServerError, QGrpcStatus::Unknown }};
+    return StatusCodeMap.at(error);
+}
+
+}
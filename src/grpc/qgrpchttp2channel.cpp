@@ -30,112 +30,670 @@
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QEventLoop>
+#include <QPointer>
+#include <QSemaphore>
+#include <QThread>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QtEndian>
 #include <QMetaObject>
+#include <QIODevice>
+#include <QMutex>
+#include <QSslConfiguration>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+#include <QHttp2Configuration>
+#endif
 
 #include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cstring>
 
 #include "qgrpcasyncreply.h"
 #include "qgrpcstream.h"
+#include "qgrpcclientstream.h"
 #include "qabstractgrpcclient.h"
 #include "qgrpccredentials.h"
+#include "qgrpcframereader_p.h"
+#include "qgrpcstreamqueue_p.h"
 #include "qprotobufserializerregistry_p.h"
 #include "qtprotobuflogging.h"
 
 #include <qglobal.h>
 
+#ifdef QT_GRPC_ZLIB
+#include <zlib.h>
+#endif
+
 using namespace QtProtobuf;
 
 namespace  {
 
-/*!
- * This QNetworkReply::NetworkError -> QGrpcStatus::StatusCode mapping should be kept in sync with original
- * <a href="https://github.com/grpc/grpc/blob/master/doc/statuscodes.md">gRPC status codes</a>
- */
-const static std::unordered_map<QNetworkReply::NetworkError, QGrpcStatus::StatusCode> StatusCodeMap = {
-                                                                { QNetworkReply::ConnectionRefusedError, QGrpcStatus::Unavailable },
-                                                                { QNetworkReply::RemoteHostClosedError, QGrpcStatus::Unavailable },
-                                                                { QNetworkReply::HostNotFoundError, QGrpcStatus::Unavailable },
-                                                                { QNetworkReply::TimeoutError, QGrpcStatus::DeadlineExceeded },
-                                                                { QNetworkReply::OperationCanceledError, QGrpcStatus::Unavailable },
-                                                                { QNetworkReply::SslHandshakeFailedError, QGrpcStatus::PermissionDenied },
-                                                                { QNetworkReply::TemporaryNetworkFailureError, QGrpcStatus::Unknown },
-                                                                { QNetworkReply::NetworkSessionFailedError, QGrpcStatus::Unavailable },
-                                                                { QNetworkReply::BackgroundRequestNotAllowedError, QGrpcStatus::Unknown },
-                                                                { QNetworkReply::TooManyRedirectsError, QGrpcStatus::Unavailable },
-                                                                { QNetworkReply::InsecureRedirectError, QGrpcStatus::PermissionDenied },
-                                                                { QNetworkReply::UnknownNetworkError, QGrpcStatus::Unknown },
-                                                                { QNetworkReply::ProxyConnectionRefusedError, QGrpcStatus::Unavailable },
-                                                                { QNetworkReply::ProxyConnectionClosedError, QGrpcStatus::Unavailable },
-                                                                { QNetworkReply::ProxyNotFoundError, QGrpcStatus::Unavailable },
-                                                                { QNetworkReply::ProxyTimeoutError, QGrpcStatus::DeadlineExceeded },
-                                                                { QNetworkReply::ProxyAuthenticationRequiredError, QGrpcStatus::Unauthenticated },
-                                                                { QNetworkReply::UnknownProxyError, QGrpcStatus::Unknown },
-                                                                { QNetworkReply::ContentAccessDenied, QGrpcStatus::PermissionDenied },
-                                                                { QNetworkReply::ContentOperationNotPermittedError, QGrpcStatus::PermissionDenied },
-                                                                { QNetworkReply::ContentNotFoundError, QGrpcStatus::NotFound },
-                                                                { QNetworkReply::AuthenticationRequiredError, QGrpcStatus::PermissionDenied },
-                                                                { QNetworkReply::ContentReSendError, QGrpcStatus::DataLoss },
-                                                                { QNetworkReply::ContentConflictError, QGrpcStatus::InvalidArgument },
-                                                                { QNetworkReply::ContentGoneError, QGrpcStatus::DataLoss },
-                                                                { QNetworkReply::UnknownContentError, QGrpcStatus::Unknown },
-                                                                { QNetworkReply::ProtocolUnknownError, QGrpcStatus::Unknown },
-                                                                { QNetworkReply::ProtocolInvalidOperationError, QGrpcStatus::Unimplemented },
-                                                                { QNetworkReply::ProtocolFailure, QGrpcStatus::Unknown },
-                                                                { QNetworkReply::InternalServerError, QGrpcStatus::Internal },
-                                                                { QNetworkReply::OperationNotImplementedError, QGrpcStatus::Unimplemented },
-                                                                { QNetworkReply::ServiceUnavailableError, QGrpcStatus::Unavailable },
-                                                                { QNetworkReply::UnknownServerError, QGrpcStatus::Unknown }};
-
+const char *GrpcContentType = "application/grpc";
+const char *ContentTypeHeader = "content-type";
+const char *ProtobufSerializerId = "protobuf";
 const char *GrpcAcceptEncodingHeader = "grpc-accept-encoding";
 const char *AcceptEncodingHeader = "accept-encoding";
 const char *TEHeader = "te";
 const char *GrpcStatusHeader = "grpc-status";
 const char *GrpcStatusMessage = "grpc-message";
-const int GrpcMessageSizeHeaderSize = 5;
+const char *GrpcTimeoutHeader = "grpc-timeout";
+const char *GrpcEncodingHeader = "grpc-encoding";
+const char *DeadlineExceededProperty = "_q_grpcDeadlineExceeded";
+const char *KeepaliveTimeoutProperty = "_q_grpcKeepaliveTimeout";
+//Keepalive probe is call of method that doesn't exist, any gRPC reply proves that connection is alive
+const char *KeepaliveProbeService = "grpc.keepalive.Keepalive";
+const char *KeepaliveProbeMethod = "Ping";
+//grpc-timeout value is limited by 8 digits
+const qint64 GrpcTimeoutMaxValue = 99999999;
+const std::chrono::milliseconds DefaultDeadline(6000);
+const int GrpcMessageSizeHeaderSize = QGrpcFrameReader::HeaderSize;
+const int DefaultCompressionThreshold = 1024;
+//Uncompressed messages starting from this size are not copied to request body, allocation of frame buffer is
+//cheaper than device for smaller ones
+const int FramedDeviceThreshold = 64 * 1024;
+const std::chrono::milliseconds DefaultKeepaliveTimeout(20000);
+const std::chrono::milliseconds KeepaliveCheckInterval(1000);
+//Initial window size defined by HTTP/2 specification, auto-tuning starts from it
+const int DefaultHttp2WindowSize = 65535;
+const int MaxAutoTunedWindowSize = 16 * 1024 * 1024;
+const qint64 DefaultStreamReadBufferSize = 4 * 1024 * 1024;
+
+//Returns content type of calls, which messages are serialized by serializer \a id. Protobuf messages are sent
+//with plain gRPC content type, since it's understood by every server.
+QByteArray serializerContentType(const QString &id)
+{
+    return id == QLatin1String(ProtobufSerializerId) ? QByteArray(GrpcContentType)
+                                                     : QByteArray(GrpcContentType) + '+' + id.toLatin1();
+}
+
+//Returns message format of gRPC \a contentType, e.g. "json" for "application/grpc+json". Protobuf format is
+//returned as empty string, parameters of content type are ignored.
+QByteArray contentTypeFormat(const QByteArray &contentType)
+{
+    QByteArray type = contentType;
+    const int parametersIndex = type.indexOf(';');
+    if (parametersIndex >= 0) {
+        type.truncate(parametersIndex);
+    }
+    type = type.trimmed().toLower().mid(static_cast<int>(qstrlen(GrpcContentType)));
+    if (type.startsWith('+')) {
+        type.remove(0, 1);
+    }
+    return type == "proto" ? QByteArray() : type;
+}
+
+//Server or gateway may answer with message format other than requested one, such reply can't be deserialized.
+//Replies that are not gRPC at all, e.g. error pages of proxies, are left to status handling.
+bool isContentTypeAccepted(QNetworkReply *networkReply)
+{
+    const QByteArray contentType = networkReply->rawHeader(ContentTypeHeader);
+    if (!contentType.trimmed().toLower().startsWith(GrpcContentType)) {
+        return true;
+    }
+    return contentTypeFormat(contentType)
+            == contentTypeFormat(networkReply->request().header(QNetworkRequest::ContentTypeHeader).toByteArray());
+}
+
+//Request body that consists of single uncompressed gRPC frame. Frame header is read from device itself and
+//message is read from implicitly shared buffer, so message is never copied to separate body buffer.
+class FramedMessageDevice final : public QIODevice
+{
+public:
+    FramedMessageDevice(const QByteArray &message) : m_message(message) {
+        m_header[0] = 0;
+        qToBigEndian<qint32>(message.size(), m_header + 1);
+        open(QIODevice::ReadOnly);
+    }
+
+    qint64 size() const override {
+        return GrpcMessageSizeHeaderSize + m_message.size();
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override {
+        qint64 position = pos();
+        qint64 read = 0;
+        if (position < GrpcMessageSizeHeaderSize) {
+            read = std::min<qint64>(maxSize, GrpcMessageSizeHeaderSize - position);
+            memcpy(data, m_header + position, static_cast<size_t>(read));
+            position += read;
+        }
+        const qint64 messageRead = std::min<qint64>(maxSize - read, size() - position);
+        if (messageRead > 0) {
+            memcpy(data + read, m_message.constData() + position - GrpcMessageSizeHeaderSize, static_cast<size_t>(messageRead));
+            read += messageRead;
+        }
+        return read;
+    }
+
+    qint64 writeData(const char *, qint64) override {
+        return -1;
+    }
+
+private:
+    char m_header[GrpcMessageSizeHeaderSize];
+    const QByteArray m_message;
+};
+
+std::shared_ptr<QNetworkAccessManager> createNetworkAccessManager()
+{
+    return {new QNetworkAccessManager, [](QNetworkAccessManager *manager) { manager->deleteLater(); }};
+}
+
+//Endpoint and settings, that are fixed when HTTP/2 connection is established. QNetworkAccessManager caches
+//connections by host and port only, so settings are part of key too.
+struct SharedManagerKey {
+    QThread *thread;
+    QString scheme;
+    QString host;
+    int port;
+    QSslConfiguration sslConfiguration;
+    int streamWindowSize;
+    int sessionWindowSize;
+    int maxFrameSize;
+    //Position of connection in pool of channel
+    size_t slot;
+
+    bool operator ==(const SharedManagerKey &other) const {
+        return thread == other.thread && port == other.port && slot == other.slot
+                && streamWindowSize == other.streamWindowSize && sessionWindowSize == other.sessionWindowSize
+                && maxFrameSize == other.maxFrameSize && host == other.host && scheme == other.scheme
+                && sslConfiguration == other.sslConfiguration;
+    }
+};
+
+//Returns network access manager shared by all channels with the same \a key. Manager is destroyed when last
+//channel, that uses it, releases it.
+std::shared_ptr<QNetworkAccessManager> acquireSharedManager(const SharedManagerKey &key)
+{
+    static QMutex mutex;
+    static std::vector<std::pair<SharedManagerKey, std::weak_ptr<QNetworkAccessManager>>> managers;
+
+    QMutexLocker locker(&mutex);
+    managers.erase(std::remove_if(managers.begin(), managers.end(), [](const std::pair<SharedManagerKey, std::weak_ptr<QNetworkAccessManager>> &entry) {
+        return entry.second.expired();
+    }), managers.end());
+
+    for (const auto &entry : managers) {
+        if (entry.first == key) {
+            if (std::shared_ptr<QNetworkAccessManager> manager = entry.second.lock()) {
+                return manager;
+            }
+        }
+    }
+
+    std::shared_ptr<QNetworkAccessManager> manager = createNetworkAccessManager();
+    managers.emplace_back(key, manager);
+    return manager;
+}
+
+#ifdef QT_GRPC_ZLIB
+const char *GrpcAcceptEncodings = "identity,deflate,gzip";
+#else
+const char *GrpcAcceptEncodings = "identity";
+#endif
+
+const char *compressionName(QGrpcHttp2Channel::CompressionAlgorithm algorithm)
+{
+    switch (algorithm) {
+    case QGrpcHttp2Channel::DeflateCompression:
+        return "deflate";
+    case QGrpcHttp2Channel::GzipCompression:
+        return "gzip";
+    default:
+        break;
+    }
+    return "identity";
+}
+
+#ifdef QT_GRPC_ZLIB
+//zlib window bits for algorithm, gzip wrapper is selected by adding 16
+int zlibWindowBits(QGrpcHttp2Channel::CompressionAlgorithm algorithm)
+{
+    return algorithm == QGrpcHttp2Channel::GzipCompression ? MAX_WBITS + 16 : MAX_WBITS;
+}
+
+//Appends compressed data to result
+bool compressMessage(const QByteArray &data, QGrpcHttp2Channel::CompressionAlgorithm algorithm, QByteArray &result)
+{
+    z_stream stream = {};
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, zlibWindowBits(algorithm), 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+
+    const int offset = result.size();
+    result.resize(offset + static_cast<int>(deflateBound(&stream, static_cast<uLong>(data.size()))));
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef *>(result.data() + offset);
+    stream.avail_out = static_cast<uInt>(result.size() - offset);
+    const int status = deflate(&stream, Z_FINISH);
+    deflateEnd(&stream);
+    result.resize(offset + static_cast<int>(stream.total_out));
+    return status == Z_STREAM_END;
+}
+
+bool decompressMessage(const QByteArray &data, QGrpcHttp2Channel::CompressionAlgorithm algorithm, QByteArray &result)
+{
+    z_stream stream = {};
+    if (inflateInit2(&stream, zlibWindowBits(algorithm)) != Z_OK) {
+        return false;
+    }
+
+    result.resize(std::max(data.size() * 4, 256));
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    int status = Z_OK;
+    while (status == Z_OK) {
+        if (stream.total_out == static_cast<uLong>(result.size())) {
+            result.resize(result.size() * 2);
+        }
+        stream.next_out = reinterpret_cast<Bytef *>(result.data() + stream.total_out);
+        stream.avail_out = static_cast<uInt>(result.size() - stream.total_out);
+        status = inflate(&stream, Z_NO_FLUSH);
+    }
+    inflateEnd(&stream);
+    result.resize(static_cast<int>(stream.total_out));
+    return status == Z_STREAM_END;
+}
+#endif
 }
 
 namespace QtProtobuf {
 //! \private
 struct QGrpcHttp2ChannelPrivate {
+    using FrameReader = QGrpcFrameReader;
+
     //! \private
-    struct ExpectedData {
-        int expectedSize;
-        QByteArray container;
+    //! \brief Reply of unary call, that is decoded while it's still arriving
+    struct UnaryReply {
+        FrameReader reader;
+        QByteArray message;
+        int messageCount = 0;
+        bool invalid = false;
+        bool compressed = false;
+
+        void read(QIODevice *device) {
+            while (!invalid && device->bytesAvailable() > 0) {
+                FrameReader::Status status = reader.read(device);
+                if (status == FrameReader::InvalidFrame) {
+                    invalid = true;
+                } else if (status == FrameReader::MessageReady) {
+                    compressed |= reader.compressed;
+                    if (++messageCount == 1) {
+                        message = reader.takeMessage();
+                    }
+                } else {
+                    break;
+                }
+            }
+        }
+    };
+
+    //! \private
+    //! \brief HTTP/2 connection of channel
+    //! \details Every QNetworkAccessManager keeps own connection cache, so calls made using different managers
+    //!          are multiplexed to different HTTP/2 connections
+    struct Connection {
+        Connection(const std::shared_ptr<QNetworkAccessManager> &_manager) : manager(_manager) {}
+        std::shared_ptr<QNetworkAccessManager> manager;
+        std::unordered_set<QNetworkReply *> replies;
+        QElapsedTimer lastActivity;
+        QNetworkReply *keepaliveProbe = nullptr;
+        bool idle = false;
     };
 
     QUrl url;
-    QNetworkAccessManager nm;
+    //Connections are shared with replies made using them, so manager outlives its replies when pool is shrunk
+    std::vector<std::shared_ptr<Connection>> connections;
     std::unique_ptr<QAbstractGrpcCredentials> credentials;
     QSslConfiguration sslConfig;
-    std::unordered_map<QNetworkReply *, ExpectedData> activeStreamReplies;
+    std::unordered_map<QNetworkReply *, FrameReader> activeStreamReplies;
     QObject lambdaContext;
+    //Thread that channel is created in, objects of channel return to it when I/O thread is stopped
+    QThread *ownerThread = QThread::currentThread();
+    //Dedicated thread of network I/O, nullptr if network I/O is made in thread of channel owner
+    std::unique_ptr<QThread> ioThread;
+
+    std::chrono::milliseconds defaultDeadline = DefaultDeadline;
+    std::unordered_map<QString, std::chrono::milliseconds> methodDeadlines;
+    QGrpcHttp2Channel::CompressionAlgorithm defaultCompression = QGrpcHttp2Channel::NoCompression;
+    std::unordered_map<QString, QGrpcHttp2Channel::CompressionAlgorithm> methodCompressions;
+    int compressionThreshold = DefaultCompressionThreshold;
+    QString serializerId = QLatin1String(ProtobufSerializerId);
+    QString serializerPlugin;
+    QByteArray contentType = GrpcContentType;
+    QGrpcCredentialMap cachedCallCredentials;
+    //! \private
+    //! \brief Prepared request and settings of method calls
+    struct CallTemplate {
+        QNetworkRequest request;
+        QGrpcHttp2Channel::CompressionAlgorithm compression;
+        std::chrono::milliseconds deadline;
+    };
+    std::unordered_map<QString, CallTemplate> requestTemplates;
+    //Deadlines of all unary calls are tracked by single timer, that is armed for the earliest one
+    using DeadlineQueue = std::multimap<qint64, QNetworkReply *>;
+    DeadlineQueue deadlines;
+    std::unordered_map<QNetworkReply *, DeadlineQueue::iterator> replyDeadlines;
+    QTimer deadlineTimer;
+    QElapsedTimer deadlineClock;
+    std::chrono::milliseconds keepaliveInterval = std::chrono::milliseconds::zero();
+    std::chrono::milliseconds keepaliveTimeout = DefaultKeepaliveTimeout;
+    std::chrono::milliseconds idleTimeout = std::chrono::milliseconds::zero();
+    QTimer keepaliveTimer;
+    int streamWindowSize = 0;
+    int sessionWindowSize = 0;
+    qint64 streamReadBufferSize = DefaultStreamReadBufferSize;
+    bool connectionSharing = false;
+    int maxFrameSize = 0;
+    bool windowAutoTuning = false;
+    //Window size selected by auto-tuning, bandwidth-delay product is estimated from replies
+    int autoTunedWindowSize = DefaultHttp2WindowSize;
+    qint64 minRoundTripTime = -1;
+
+    static QString methodKey(const QString &method, const QString &service) {
+        return service + "/" + method;
+    }
+
+    std::chrono::milliseconds deadline(const QString &method, const QString &service) const {
+        auto it = methodDeadlines.find(methodKey(method, service));
+        return it != methodDeadlines.end() ? it->second : defaultDeadline;
+    }
+
+    QGrpcHttp2Channel::CompressionAlgorithm compression(const QString &method, const QString &service) const {
+        auto it = methodCompressions.find(methodKey(method, service));
+        return it != methodCompressions.end() ? it->second : defaultCompression;
+    }
+
+    //Returns true if message of \a size is compressed by \a algorithm
+    bool isCompressed(int size, QGrpcHttp2Channel::CompressionAlgorithm algorithm) const {
+#ifdef QT_GRPC_ZLIB
+        return algorithm != QGrpcHttp2Channel::NoCompression && size >= compressionThreshold;
+#else
+        Q_UNUSED(size)
+        Q_UNUSED(algorithm)
+        return false;
+#endif
+    }
+
+    //Appends gRPC frame of args message to buffer, compressed if it's not less than threshold
+    void appendFrame(const QByteArray &args, QGrpcHttp2Channel::CompressionAlgorithm algorithm, QByteArray &buffer) const {
+        const int headerOffset = buffer.size();
+        buffer.append(GrpcMessageSizeHeaderSize, '\0');
+#ifdef QT_GRPC_ZLIB
+        if (isCompressed(args.size(), algorithm)) {
+            if (compressMessage(args, algorithm, buffer)) {
+                buffer[headerOffset] = 1;
+                qToBigEndian<qint32>(buffer.size() - headerOffset - GrpcMessageSizeHeaderSize, buffer.data() + headerOffset + 1);
+                return;
+            }
+            qProtoWarning() << "Unable to compress message, it's sent uncompressed";
+            buffer.resize(headerOffset + GrpcMessageSizeHeaderSize);
+        }
+#else
+        Q_UNUSED(algorithm)
+#endif
+        qToBigEndian<qint32>(args.size(), buffer.data() + headerOffset + 1);
+        buffer.append(args);
+    }
+
+    //Reads messages of client stream reply and finishes stream when reply is finished
+    void startClientStream(QGrpcClientStream *stream, QNetworkReply *networkReply, QAbstractGrpcClient *client);
+
+    //Reads received messages of stream reply and passes them to handler
+    void readStreamFrames(QNetworkReply *networkReply, const std::function<void(const QByteArray &)> &handler) {
+        if (!isContentTypeAccepted(networkReply)) {
+            qProtoWarning() << "Stream messages of unexpected content type are skipped:" << networkReply->rawHeader(ContentTypeHeader);
+            networkReply->readAll();
+            return;
+        }
+
+        FrameReader &reader = activeStreamReplies[networkReply];
+        qProtoDebug() << "RECV" << networkReply->bytesAvailable();
+
+        while (networkReply->bytesAvailable() > 0) {
+            FrameReader::Status status = reader.read(networkReply);
+            if (status == FrameReader::InvalidFrame) {
+                //Rest of received data can't be framed
+                networkReply->readAll();
+                break;
+            }
+            if (status == FrameReader::NeedMoreData) {
+                break;
+            }
+            QByteArray message = reader.takeMessage();
+            QGrpcStatus::StatusCode statusCode = QGrpcStatus::Ok;
+            if (reader.compressed && !decompressFrame(networkReply, message, statusCode)) {
+                qProtoWarning() << "Compressed stream message is skipped";
+                continue;
+            }
+            handler(message);
+            //Message that is not kept by handler is recycled for next frames
+            QProtobufBufferAllocator::current()->release(std::move(message));
+            if (activeStreamReplies.count(networkReply) == 0) {
+                //Stream is finished by handler
+                return;
+            }
+        }
+    }
+
+    //Decompresses message of compressed frame according to grpc-encoding header of reply
+    static bool decompressFrame(QNetworkReply *networkReply, QByteArray &message, QGrpcStatus::StatusCode &statusCode) {
+        const QByteArray encoding = networkReply->rawHeader(GrpcEncodingHeader);
+#ifdef QT_GRPC_ZLIB
+        QGrpcHttp2Channel::CompressionAlgorithm algorithm = QGrpcHttp2Channel::NoCompression;
+        if (encoding == compressionName(QGrpcHttp2Channel::GzipCompression)) {
+            algorithm = QGrpcHttp2Channel::GzipCompression;
+        } else if (encoding == compressionName(QGrpcHttp2Channel::DeflateCompression)) {
+            algorithm = QGrpcHttp2Channel::DeflateCompression;
+        }
+
+        if (algorithm != QGrpcHttp2Channel::NoCompression) {
+            QByteArray result;
+            if (!decompressMessage(message, algorithm, result)) {
+                qProtoWarning() << "Unable to decompress message, encoding:" << encoding;
+                statusCode = QGrpcStatus::Internal;
+                return false;
+            }
+            message.swap(result);
+            QProtobufBufferAllocator::current()->release(std::move(result));
+            return true;
+        }
+#endif
+        qProtoWarning() << "Compressed message encoding is not supported:" << encoding;
+        statusCode = QGrpcStatus::Unimplemented;
+        return false;
+    }
+
+    static QByteArray grpcTimeout(std::chrono::milliseconds deadline) {
+        qint64 value = deadline.count();
+        if (value <= GrpcTimeoutMaxValue) {
+            return QByteArray::number(value) + 'm';
+        }
+        value = std::min<qint64>(value / 1000, GrpcTimeoutMaxValue);
+        return QByteArray::number(value) + 'S';
+    }
+
+    void addDeadline(QNetworkReply *networkReply, std::chrono::milliseconds deadline) {
+        if (!deadlineClock.isValid()) {
+            deadlineClock.start();
+        }
+        const qint64 expiry = deadlineClock.elapsed() + deadline.count();
+        auto it = deadlines.insert({expiry, networkReply});
+        replyDeadlines[networkReply] = it;
+        if (it == deadlines.begin()) {
+            armDeadlineTimer();
+        }
+
+        QObject::connect(networkReply, &QNetworkReply::finished, &lambdaContext, [this, networkReply] {
+            removeDeadline(networkReply);
+        });
+        QObject::connect(networkReply, &QObject::destroyed, &lambdaContext, [this, networkReply] {
+            removeDeadline(networkReply);
+        });
+    }
+
+    void removeDeadline(QNetworkReply *networkReply) {
+        auto it = replyDeadlines.find(networkReply);
+        if (it == replyDeadlines.end()) {
+            return;
+        }
+        const bool isEarliest = it->second == deadlines.begin();
+        deadlines.erase(it->second);
+        replyDeadlines.erase(it);
+        if (isEarliest) {
+            armDeadlineTimer();
+        }
+    }
+
+    void armDeadlineTimer() {
+        if (deadlines.empty()) {
+            deadlineTimer.stop();
+            return;
+        }
+        const qint64 timeout = std::max<qint64>(0, deadlines.begin()->first - deadlineClock.elapsed());
+        deadlineTimer.start(static_cast<int>(std::min<qint64>(timeout, std::numeric_limits<int>::max())));
+    }
+
+    void processDeadlines() {
+        const qint64 now = deadlineClock.elapsed();
+        std::vector<QNetworkReply *> expired;
+        auto it = deadlines.begin();
+        while (it != deadlines.end() && it->first <= now) {
+            expired.push_back(it->second);
+            replyDeadlines.erase(it->second);
+            it = deadlines.erase(it);
+        }
+        armDeadlineTimer();
+
+        for (QNetworkReply *networkReply : expired) {
+            networkReply->setProperty(DeadlineExceededProperty, true);
+            abortNetworkReply(networkReply);
+        }
+    }
+
+    //! \brief Returns prepared request of \a method call
+    //! \details Requests are prepared once per method and are rebuilt only if call credentials or channel
+    //!          settings are changed. Method is either stream or unary, so \a stream is not part of key.
+    const CallTemplate &requestTemplate(const QString &method, const QString &service, bool stream) {
+        QGrpcCredentialMap callCredentials = credentials->callCredentials();
+        if (callCredentials != cachedCallCredentials) {
+            //All prepared requests contain outdated credentials
+            cachedCallCredentials = callCredentials;
+            requestTemplates.clear();
+        }
+
+        const QString key = methodKey(method, service);
+        auto it = requestTemplates.find(key);
+        if (it != requestTemplates.end()) {
+            return it->second;
+        }
 
-    QNetworkReply *post(const QString &method, const QString &service, const QByteArray &args, bool stream = false) {
         QUrl callUrl = url;
-        callUrl.setPath("/" + service + "/" + method);
+        callUrl.setPath("/" + key);
 
         qProtoDebug() << "Service call url: " << callUrl;
         QNetworkRequest request(callUrl);
-        request.setHeader(QNetworkRequest::ContentTypeHeader, "application/grpc");
-        request.setRawHeader(GrpcAcceptEncodingHeader, "identity,deflate,gzip");
+        request.setHeader(QNetworkRequest::ContentTypeHeader, contentType);
+        request.setRawHeader(GrpcAcceptEncodingHeader, GrpcAcceptEncodings);
+        const QGrpcHttp2Channel::CompressionAlgorithm callCompression = compression(method, service);
+        if (callCompression != QGrpcHttp2Channel::NoCompression) {
+            request.setRawHeader(GrpcEncodingHeader, compressionName(callCompression));
+        }
         request.setRawHeader(AcceptEncodingHeader, "identity,gzip");
         request.setRawHeader(TEHeader, "trailers");
+        const std::chrono::milliseconds callDeadline = stream ? std::chrono::milliseconds::zero() : deadline(method, service);
+        if (callDeadline.count() > 0) {
+            request.setRawHeader(GrpcTimeoutHeader, grpcTimeout(callDeadline));
+        }
         request.setSslConfiguration(sslConfig);
-        QGrpcCredentialMap callCredentials = credentials->callCredentials();
         for (auto i = callCredentials.begin(); i != callCredentials.end(); ++i) {
-            request.setRawHeader(i.key().data(), i.value().toString().toUtf8());
+            request.setRawHeader(i.key().data(), qGrpcCredentialHeaderValue(i.value()));
         }
 
         request.setAttribute(QNetworkRequest::Http2DirectAttribute, true);
+        applyHttp2Configuration(request);
+        return requestTemplates.emplace(key, CallTemplate{request, callCompression, callDeadline}).first->second;
+    }
+
+    QNetworkReply *post(const QString &method, const QString &service, const QByteArray &args, bool stream = false,
+                        const QGrpcCallOptions &options = {}) {
+        const CallTemplate &callTemplate = requestTemplate(method, service, stream);
+        if (options.isEmpty()) {
+            return postMessage(callTemplate, args);
+        }
+
+        //Prepared request is copied only for calls with own options
+        CallTemplate callOptionsTemplate = callTemplate;
+        for (const auto &entry : options.metadata()) {
+            callOptionsTemplate.request.setRawHeader(entry.first, entry.second);
+        }
+        if (options.hasDeadline()) {
+            callOptionsTemplate.deadline = options.deadline();
+            //Null value removes header
+            callOptionsTemplate.request.setRawHeader(GrpcTimeoutHeader, options.deadline().count() > 0 ? grpcTimeout(options.deadline()) : QByteArray());
+        }
+        //Priority of request is sent as weight of HTTP/2 stream
+        switch (options.priority()) {
+        case QGrpcCallOptions::LowPriority:
+            callOptionsTemplate.request.setPriority(QNetworkRequest::LowPriority);
+            break;
+        case QGrpcCallOptions::HighPriority:
+            callOptionsTemplate.request.setPriority(QNetworkRequest::HighPriority);
+            break;
+        case QGrpcCallOptions::NormalPriority:
+            break;
+        }
+        return postMessage(callOptionsTemplate, args);
+    }
+
+    //Sends request with body that consists of single args message
+    QNetworkReply *postMessage(const CallTemplate &callTemplate, const QByteArray &args) {
+        if (args.size() < FramedDeviceThreshold || isCompressed(args.size(), callTemplate.compression)) {
+            QByteArray msg = QProtobufBufferAllocator::current()->allocate(GrpcMessageSizeHeaderSize + args.size());
+            appendFrame(args, callTemplate.compression, msg);
+            return postFrames(callTemplate, msg);
+        }
+
+        //Device has known size and random access, so network layer reads body from it without buffering
+        qProtoDebug() << "SEND: " << GrpcMessageSizeHeaderSize + args.size();
+        FramedMessageDevice *body = new FramedMessageDevice(args);
+        QNetworkRequest request = callTemplate.request;
+        request.setHeader(QNetworkRequest::ContentLengthHeader, body->size());
+        request.setAttribute(QNetworkRequest::DoNotBufferUploadDataAttribute, true);
+        std::shared_ptr<Connection> connection = leastLoadedConnection();
+        QNetworkReply *networkReply = connection->manager->post(request, body);
+        body->setParent(networkReply);
+        return trackReply(connection, callTemplate, networkReply);
+    }
 
-        QByteArray msg(GrpcMessageSizeHeaderSize, '\0');
-        *reinterpret_cast<int *>(msg.data() + 1) = qToBigEndian(args.size());
-        msg += args;
+    //Sends request with body that consists of already framed messages
+    QNetworkReply *postFrames(const CallTemplate &callTemplate, const QByteArray &msg) {
         qProtoDebug() << "SEND: " << msg.size();
+        std::shared_ptr<Connection> connection = leastLoadedConnection();
+        return trackReply(connection, callTemplate, connection->manager->post(callTemplate.request, msg));
+    }
 
-        QNetworkReply *networkReply = nm.post(request, msg);
+    //Tracks activity of connection by \a networkReply just posted to it and applies deadline of call
+    QNetworkReply *trackReply(const std::shared_ptr<Connection> &connection, const CallTemplate &callTemplate, QNetworkReply *networkReply) {
+        const std::chrono::milliseconds callDeadline = callTemplate.deadline;
+        connection->replies.insert(networkReply);
+        connection->lastActivity.start();
+        connection->idle = false;
+        QObject::connect(networkReply, &QNetworkReply::readyRead, &lambdaContext, [connection] {
+            connection->lastActivity.start();
+        });
+        QObject::connect(networkReply, &QNetworkReply::finished, &lambdaContext, [this, connection, networkReply] {
+            connection->replies.erase(networkReply);
+            connection->lastActivity.start();
+            storeSessionTicket(networkReply);
+        });
 
         QObject::connect(networkReply, &QNetworkReply::sslErrors, [networkReply](const QList<QSslError> &errors) {
            qProtoCritical() << errors;
@@ -144,59 +702,770 @@ struct QGrpcHttp2ChannelPrivate {
            QGrpcHttp2ChannelPrivate::abortNetworkReply(networkReply);
         });
 
-        if (!stream) {
-            //TODO: Add configurable timeout logic
-            QTimer::singleShot(6000, networkReply, [networkReply]() {
-                QGrpcHttp2ChannelPrivate::abortNetworkReply(networkReply);
-            });
-        }
-        return networkReply;
-    }
+        if (callDeadline.count() > 0) {
+            addDeadline(networkReply, callDeadline);
+        }
+        sampleBandwidthDelayProduct(networkReply);
+        return networkReply;
+    }
+
+    //! \brief Returns stream receive window size, that is announced to server
+    int effectiveStreamWindowSize() const {
+        if (windowAutoTuning) {
+            return std::max(autoTunedWindowSize, streamWindowSize);
+        }
+        return streamWindowSize;
+    }
+
+    void applyHttp2Configuration(QNetworkRequest &request) const {
+        const int streamWindow = effectiveStreamWindowSize();
+        if (streamWindow <= 0 && sessionWindowSize <= 0 && maxFrameSize <= 0) {
+            return;
+        }
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+        QHttp2Configuration configuration = request.http2Configuration();
+        if (streamWindow > 0) {
+            configuration.setStreamReceiveWindowSize(static_cast<unsigned>(streamWindow));
+        }
+        //Session window has to fit windows of concurrent streams
+        const int sessionWindow = windowAutoTuning ? std::max(sessionWindowSize, streamWindow) : sessionWindowSize;
+        if (sessionWindow > 0) {
+            configuration.setSessionReceiveWindowSize(static_cast<unsigned>(sessionWindow));
+        }
+        if (maxFrameSize > 0 && !configuration.setMaxFrameSize(static_cast<unsigned>(maxFrameSize))) {
+            qProtoWarning() << "Invalid HTTP/2 max frame size" << maxFrameSize;
+        }
+        request.setHttp2Configuration(configuration);
+#else
+        Q_UNUSED(request)
+        qProtoWarning() << "HTTP/2 flow control settings require Qt 5.14 or higher";
+#endif
+    }
+
+    //! \brief Applies changed HTTP/2 settings. Settings are sent to server when connection is established,
+    //!        so connections are replaced, calls in progress are finished using previous connections.
+    void resetHttp2Configuration() {
+        requestTemplates.clear();
+        for (size_t i = 0; i < connections.size(); ++i) {
+            connections[i] = createConnection(i);
+        }
+    }
+
+    std::shared_ptr<Connection> createConnection(size_t slot) const {
+        if (!connectionSharing) {
+            return std::make_shared<Connection>(createNetworkAccessManager());
+        }
+        //Session ticket is updated by every connection, so it doesn't distinguish endpoints
+        QSslConfiguration endpointSslConfig = sslConfig;
+        endpointSslConfig.setSessionTicket({});
+        return std::make_shared<Connection>(acquireSharedManager({lambdaContext.thread(), url.scheme(), url.host(),
+                                                                  url.port(url.scheme() == QLatin1String("https") ? 443 : 80),
+                                                                  endpointSslConfig, effectiveStreamWindowSize(), sessionWindowSize,
+                                                                  maxFrameSize, slot}));
+    }
+
+    //! \brief Keeps TLS session ticket of \a networkReply, so new connections resume session instead of full handshake
+    void storeSessionTicket(QNetworkReply *networkReply) {
+        if (url.scheme() != QLatin1String("https")) {
+            return;
+        }
+
+        const QByteArray ticket = networkReply->sslConfiguration().sessionTicket();
+        if (!ticket.isEmpty() && ticket != sslConfig.sessionTicket()) {
+            sslConfig.setSessionTicket(ticket);
+            //Prepared requests hold previous ticket
+            requestTemplates.clear();
+        }
+    }
+
+    //! \brief Establishes connections that have no calls, using request to method that doesn't exist
+    void connectAhead() {
+        for (const auto &connection : connections) {
+            if (!connection->replies.empty() || connection->keepaliveProbe != nullptr) {
+                continue;
+            }
+
+            const CallTemplate &probeTemplate = requestTemplate(KeepaliveProbeMethod, KeepaliveProbeService, true);
+            QByteArray msg;
+            appendFrame({}, QGrpcHttp2Channel::NoCompression, msg);
+            QNetworkReply *probe = connection->manager->post(probeTemplate.request, msg);
+            connection->idle = false;
+            QObject::connect(probe, &QNetworkReply::finished, &lambdaContext, [this, connection, probe] {
+                probe->deleteLater();
+                connection->lastActivity.start();
+                storeSessionTicket(probe);
+            });
+        }
+    }
+
+    //! \brief Samples bandwidth-delay product of \a networkReply, if auto-tuning is enabled
+    //! \details Time to first byte of reply approximates round trip time. Bytes received during round trip
+    //!          time after first byte approximate bandwidth-delay product. Window is doubled when sample
+    //!          exceeds 2/3 of current window, like it's done by BDP estimator of grpc-core.
+    void sampleBandwidthDelayProduct(QNetworkReply *networkReply) {
+        if (!windowAutoTuning) {
+            return;
+        }
+
+        struct Sample {
+            QElapsedTimer timer;
+            qint64 firstByteTime = -1;
+            qint64 firstBytes = 0;
+            bool done = false;
+        };
+        auto sample = std::make_shared<Sample>();
+        sample->timer.start();
+        QObject::connect(networkReply, &QNetworkReply::downloadProgress, &lambdaContext, [this, sample](qint64 received) {
+            if (sample->done) {
+                return;
+            }
+
+            const qint64 elapsed = sample->timer.elapsed();
+            if (sample->firstByteTime < 0) {
+                sample->firstByteTime = elapsed;
+                sample->firstBytes = received;
+                minRoundTripTime = minRoundTripTime < 0 ? elapsed : std::min(minRoundTripTime, elapsed);
+                return;
+            }
+
+            if (elapsed - sample->firstByteTime < std::max<qint64>(minRoundTripTime, 1)) {
+                return;
+            }
+
+            sample->done = true;
+            const qint64 bandwidthDelayProduct = received - sample->firstBytes;
+            if (bandwidthDelayProduct * 3 > autoTunedWindowSize * 2 && autoTunedWindowSize < MaxAutoTunedWindowSize) {
+                autoTunedWindowSize = std::min(autoTunedWindowSize * 2, MaxAutoTunedWindowSize);
+                qProtoDebug() << "HTTP/2 receive window is increased to" << autoTunedWindowSize;
+                resetHttp2Configuration();
+            }
+        });
+    }
+
+    std::shared_ptr<Connection> leastLoadedConnection() const {
+        return *std::min_element(connections.begin(), connections.end(), [](const std::shared_ptr<Connection> &a,
+                                 const std::shared_ptr<Connection> &b) {
+            return a->replies.size() < b->replies.size();
+        });
+    }
+
+    void setConnectionCount(int count) {
+        count = std::max(count, 1);
+        connections.resize(count);
+        for (size_t i = 0; i < connections.size(); ++i) {
+            if (!connections[i]) {
+                connections[i] = createConnection(i);
+            }
+        }
+    }
+
+    void updateKeepaliveTimer() {
+        std::chrono::milliseconds interval = KeepaliveCheckInterval;
+        for (auto timeout : {keepaliveInterval, idleTimeout}) {
+            if (timeout.count() > 0) {
+                interval = std::min(interval, timeout);
+            }
+        }
+
+        if (keepaliveInterval.count() > 0 || idleTimeout.count() > 0) {
+            keepaliveTimer.start(static_cast<int>(interval.count()));
+        } else {
+            keepaliveTimer.stop();
+        }
+    }
+
+    //Probes connections with active calls, that are silent for keepalive interval, and closes idle connections
+    void processKeepalive() {
+        for (auto &connection : connections) {
+            if (!connection->lastActivity.isValid() || connection->keepaliveProbe != nullptr) {
+                continue;
+            }
+
+            const qint64 silence = connection->lastActivity.elapsed();
+            if (!connection->replies.empty()) {
+                if (keepaliveInterval.count() > 0 && silence >= keepaliveInterval.count()) {
+                    sendKeepaliveProbe(connection);
+                }
+            } else if (idleTimeout.count() > 0 && !connection->idle && silence >= idleTimeout.count()
+                       && connection->manager.use_count() == 1) {
+                //Shared connection may be used by other channels, it's closed with its last channel
+                qProtoDebug() << "Idle connection is closed";
+                connection->idle = true;
+                connection->manager->clearConnectionCache();
+            }
+        }
+    }
+
+    void sendKeepaliveProbe(const std::shared_ptr<Connection> &connection) {
+        const CallTemplate &probeTemplate = requestTemplate(KeepaliveProbeMethod, KeepaliveProbeService, true);
+        QByteArray msg;
+        appendFrame({}, QGrpcHttp2Channel::NoCompression, msg);
+        QNetworkReply *probe = connection->manager->post(probeTemplate.request, msg);
+        connection->keepaliveProbe = probe;
+
+        QTimer::singleShot(static_cast<int>(keepaliveTimeout.count()), probe, [probe] {
+            probe->setProperty(KeepaliveTimeoutProperty, true);
+            probe->abort();
+        });
+
+        QObject::connect(probe, &QNetworkReply::finished, &lambdaContext, [connection, probe] {
+            connection->keepaliveProbe = nullptr;
+            probe->deleteLater();
+
+            //Network and proxy errors mean that connection is broken, content and protocol errors come from server
+            const QNetworkReply::NetworkError error = probe->error();
+            if (!probe->property(KeepaliveTimeoutProperty).toBool()
+                    && (error == QNetworkReply::NoError || error >= QNetworkReply::ContentAccessDenied)) {
+                connection->lastActivity.start();
+                return;
+            }
+
+            qProtoWarning() << "Keepalive probe failed, calls of broken connection are aborted";
+            const std::unordered_set<QNetworkReply *> replies = connection->replies;
+            for (QNetworkReply *networkReply : replies) {
+                networkReply->abort();
+            }
+            connection->manager->clearConnectionCache();
+        });
+    }
+
+    static void abortNetworkReply(QNetworkReply *networkReply) {
+        if (networkReply->isRunning()) {
+            networkReply->abort();
+        } else {
+            networkReply->deleteLater();
+        }
+    }
+
+    static QByteArray processReply(QNetworkReply *networkReply, UnaryReply &reply, QGrpcStatus::StatusCode &statusCode) {
+        //Check if no network error occured
+        if (networkReply->error() != QNetworkReply::NoError) {
+            statusCode = networkReply->property(DeadlineExceededProperty).toBool() ? QGrpcStatus::DeadlineExceeded
+                                                                                    : grpcStatusOfNetworkError(networkReply->error());
+            return {};
+        }
+
+        //Check if server answer with error
+        statusCode = static_cast<QGrpcStatus::StatusCode>(networkReply->rawHeader(GrpcStatusHeader).toInt());
+        if (statusCode != QGrpcStatus::StatusCode::Ok) {
+            return {};
+        }
+
+        if (!isContentTypeAccepted(networkReply)) {
+            qProtoWarning() << "Unary reply of unexpected content type received:" << networkReply->rawHeader(ContentTypeHeader);
+            statusCode = QGrpcStatus::Internal;
+            return {};
+        }
+
+        //Frames that are not read while reply was arriving
+        reply.read(networkReply);
+        if (reply.invalid || !reply.reader.isComplete() || reply.messageCount != 1) {
+            qProtoWarning() << "Invalid unary reply received, messages:" << reply.messageCount;
+            statusCode = QGrpcStatus::Internal;
+            return {};
+        }
+
+        if (reply.compressed && !decompressFrame(networkReply, reply.message, statusCode)) {
+            return {};
+        }
+
+        return std::move(reply.message);
+    }
+
+    void call(const QString &method, const QString &service, const QByteArray &args, const QPointer<QGrpcAsyncReply> &reply,
+              const QGrpcCallOptions &options, const std::shared_ptr<QGrpcSpan> &span) {
+        //Reply could be destroyed, while call was passed to thread of channel
+        if (reply.isNull()) {
+            return;
+        }
+
+        QNetworkReply *networkReply = post(method, service, args, false, options);
+        if (span) {
+            span->addEvent(QGrpcSpan::RequestSent);
+        }
+
+        //Network reply is handled in thread of channel, that could differ from thread of reply
+        std::shared_ptr<UnaryReply> unaryReply(new UnaryReply);
+        QObject::connect(networkReply, &QNetworkReply::readyRead, networkReply, [networkReply, unaryReply, span, firstRead = true]() mutable {
+            if (span && firstRead) {
+                span->addEvent(QGrpcSpan::FirstByteReceived);
+            }
+            firstRead = false;
+            unaryReply->read(networkReply);
+        });
+
+        std::shared_ptr<QMetaObject::Connection> connection(new QMetaObject::Connection);
+        std::shared_ptr<QMetaObject::Connection> abortConnection(new QMetaObject::Connection);
+        std::shared_ptr<QMetaObject::Connection> destroyedConnection(new QMetaObject::Connection);
+        *connection = QObject::connect(networkReply, &QNetworkReply::finished, networkReply, [reply, networkReply, unaryReply, connection, abortConnection, destroyedConnection, span]() {
+            QGrpcStatus::StatusCode grpcStatus = QGrpcStatus::StatusCode::Unknown;
+            QByteArray data = processReply(networkReply, *unaryReply, grpcStatus);
+            if (span) {
+                span->addEvent(QGrpcSpan::MessageReceived);
+            }
+            if (*connection) {
+                QObject::disconnect(*connection);
+            }
+            if (*abortConnection) {
+                QObject::disconnect(*abortConnection);
+            }
+            if (*destroyedConnection) {
+                QObject::disconnect(*destroyedConnection);
+            }
+
+            qProtoDebug() << "RECV: " << data;
+            finishReply(reply, data, {grpcStatus, QString::fromUtf8(networkReply->rawHeader(GrpcStatusMessage))}, networkReply->rawHeaderPairs());
+            networkReply->deleteLater();
+        });
+
+        //Network request is aborted, when reply is aborted or abandoned, so HTTP/2 stream of call is reset and server
+        //is notified about cancellation
+        auto abortCall = [networkReply, connection, abortConnection, destroyedConnection] {
+            QObject::disconnect(*connection);
+            QObject::disconnect(*abortConnection);
+            QObject::disconnect(*destroyedConnection);
+            QGrpcHttp2ChannelPrivate::abortNetworkReply(networkReply);
+            networkReply->deleteLater();
+        };
+
+        *abortConnection = QObject::connect(reply.data(), &QGrpcAsyncReply::error, networkReply, [abortCall] (const QGrpcStatus &status) {
+            if (status.code() == QGrpcStatus::Aborted) {
+                qProtoDebug() << "Call aborted, network request is cancelled";
+                abortCall();
+            }
+        });
+
+        *destroyedConnection = QObject::connect(reply.data(), &QObject::destroyed, networkReply, [abortCall] {
+            qProtoDebug() << "Reply destroyed before call is finished, network request is cancelled";
+            abortCall();
+        });
+    }
+
+    //! \private
+    //! \brief State of call with handler, the only allocation made for the call besides network reply
+    struct HandlerCall {
+        UnaryReply reply;
+        CallHandler handler;
+    };
+
+    void callWithHandler(const QString &method, const QString &service, const QByteArray &args, const CallHandler &handler) {
+        QNetworkReply *networkReply = post(method, service, args);
+        std::shared_ptr<HandlerCall> call(new HandlerCall{{}, handler});
+        //Connections are released together with network reply
+        QObject::connect(networkReply, &QNetworkReply::readyRead, networkReply, [networkReply, call] {
+            call->reply.read(networkReply);
+        });
+        QObject::connect(networkReply, &QNetworkReply::finished, networkReply, [networkReply, call] {
+            QGrpcStatus::StatusCode grpcStatus = QGrpcStatus::StatusCode::Unknown;
+            QByteArray data = processReply(networkReply, call->reply, grpcStatus);
+            call->handler({grpcStatus, QString::fromUtf8(networkReply->rawHeader(GrpcStatusMessage))}, data);
+            networkReply->deleteLater();
+        });
+    }
+
+    //Delivers result of asynchronous call to \a reply in its thread
+    static void finishReply(const QPointer<QGrpcAsyncReply> &reply, const QByteArray &data, const QGrpcStatus &status,
+                            const QGrpcMetadata &metadata) {
+        auto deliver = [reply, data, status, metadata] {
+            if (reply.isNull()) {
+                return;
+            }
+
+            //Trailers are received by QNetworkReply as headers, so both reach reply as single list
+            reply->setMetadata(metadata);
+
+            if (status.code() == QGrpcStatus::StatusCode::Ok) {
+                reply->setData(data);
+                reply->finished();
+            } else {
+                reply->setData({});
+                reply->error(status);
+            }
+        };
+
+        if (reply.isNull()) {
+            return;
+        }
+
+        if (reply->thread() == QThread::currentThread()) {
+            deliver();
+        } else {
+            QMetaObject::invokeMethod(reply.data(), deliver, Qt::QueuedConnection);
+        }
+    }
+
+    //Collects result of finished synchronous call and releases \a networkReply
+    static QGrpcStatus finishCall(QNetworkReply *networkReply, UnaryReply &reply, QByteArray &ret) {
+        QGrpcStatus::StatusCode grpcStatus = QGrpcStatus::StatusCode::Unknown;
+        ret = processReply(networkReply, reply, grpcStatus);
+
+        networkReply->deleteLater();
+        qProtoDebug() << __func__ << "RECV: " << ret.toHex() << "grpcStatus" << grpcStatus;
+        return {grpcStatus, QString::fromUtf8(networkReply->rawHeader(GrpcStatusMessage))};
+    }
+
+    //! \private
+    //! \brief Network side of stream, that is handled in I/O thread, while stream is handled in its own thread
+    struct IoStream {
+        IoStream(const std::shared_ptr<QGrpcStreamQueue> &_queue) : queue(_queue) {}
+        std::shared_ptr<QGrpcStreamQueue> queue;
+        //Accessed in I/O thread only
+        QNetworkReply *networkReply = nullptr;
+    };
+
+    //Runs \a task in thread that objects of channel live in, calling thread is blocked until task is done
+    void runInChannelThread(const std::function<void()> &task) {
+        if (QThread::currentThread() == lambdaContext.thread()) {
+            task();
+        } else {
+            QMetaObject::invokeMethod(&lambdaContext, task, Qt::BlockingQueuedConnection);
+        }
+    }
+
+    //Changes settings of channel in I/O thread if it's started, since connections, timers and prepared requests
+    //are used there
+    void configure(const std::function<void()> &task) {
+        if (ioThread) {
+            runInChannelThread(task);
+        } else {
+            task();
+        }
+    }
+
+    void moveObjectsToThread(QThread *thread) {
+        lambdaContext.moveToThread(thread);
+        deadlineTimer.moveToThread(thread);
+        keepaliveTimer.moveToThread(thread);
+    }
+
+    void startIoThread() {
+        const int count = static_cast<int>(connections.size());
+        ioThread.reset(new QThread);
+        ioThread->setObjectName(QLatin1String("QGrpcHttp2Channel I/O"));
+        ioThread->start();
+        //Network access managers can't be moved to other thread, so connections are created again in I/O thread
+        connections.clear();
+        moveObjectsToThread(ioThread.get());
+        runInChannelThread([this, count] {
+            setConnectionCount(count);
+        });
+    }
+
+    void stopIoThread() {
+        runInChannelThread([this] {
+            //Calls in progress are aborted, so their replies and streams are notified before I/O thread is stopped
+            for (const auto &connection : connections) {
+                const std::unordered_set<QNetworkReply *> replies = connection->replies;
+                for (QNetworkReply *networkReply : replies) {
+                    abortNetworkReply(networkReply);
+                }
+            }
+            connections.clear();
+            activeStreamReplies.clear();
+            moveObjectsToThread(ownerThread);
+        });
+        //Managers, that are released by connections, are deleted when thread is finished
+        ioThread->quit();
+        ioThread->wait();
+        ioThread.reset();
+    }
+
+    //Reads messages of stream \a networkReply to queue in I/O thread and closes queue with final status of stream
+    void readIoStream(const std::shared_ptr<IoStream> &ioStream, QNetworkReply *networkReply, bool clientStream) {
+        ioStream->networkReply = networkReply;
+        //Bounded buffer stops reading from server, when messages are not consumed in time
+        networkReply->setReadBufferSize(streamReadBufferSize);
+        QObject::connect(networkReply, &QNetworkReply::readyRead, networkReply, [this, ioStream, networkReply] {
+            readStreamFrames(networkReply, [&ioStream](const QByteArray &message) {
+                ioStream->queue->push(message);
+            });
+        });
+
+        QObject::connect(networkReply, &QNetworkReply::finished, networkReply, [this, ioStream, networkReply, clientStream] {
+            QGrpcStatus::StatusCode statusCode = QGrpcStatus::Ok;
+            QString statusMessage;
+            if (networkReply->error() != QNetworkReply::NoError) {
+                statusCode = grpcStatusOfNetworkError(networkReply->error());
+                statusMessage = clientStream ? QString::fromUtf8(networkReply->rawHeader(GrpcStatusMessage))
+                                             : networkReply->errorString();
+            } else {
+                readStreamFrames(networkReply, [&ioStream](const QByteArray &message) {
+                    ioStream->queue->push(message);
+                });
+                //Status of server stream is taken from network layer only, like it's done in thread of channel owner
+                if (clientStream) {
+                    statusCode = static_cast<QGrpcStatus::StatusCode>(networkReply->rawHeader(GrpcStatusHeader).toInt());
+                    statusMessage = QString::fromUtf8(networkReply->rawHeader(GrpcStatusMessage));
+                }
+            }
+            activeStreamReplies.erase(networkReply);
+            ioStream->networkReply = nullptr;
+            networkReply->deleteLater();
+            ioStream->queue->close({statusCode, statusMessage});
+        });
+    }
+
+    //Aborts network reply of stream, that is cancelled in its thread
+    void abortIoStream(const std::shared_ptr<IoStream> &ioStream) {
+        QNetworkReply *networkReply = ioStream->networkReply;
+        if (networkReply == nullptr) {
+            return;
+        }
+        ioStream->networkReply = nullptr;
+        //Final status isn't delivered to cancelled stream
+        QObject::disconnect(networkReply, nullptr, networkReply, nullptr);
+        activeStreamReplies.erase(networkReply);
+        abortNetworkReply(networkReply);
+        networkReply->deleteLater();
+    }
+
+    //Posts abort of \a ioStream to I/O thread, stream could be already finished there
+    void postAbort(const std::weak_ptr<IoStream> &ioStream) {
+        QMetaObject::invokeMethod(&lambdaContext, [this, ioStream] {
+            if (std::shared_ptr<IoStream> stream = ioStream.lock()) {
+                abortIoStream(stream);
+            }
+        }, Qt::QueuedConnection);
+    }
+
+    //Makes server stream call in I/O thread, messages are delivered to \a stream in its thread
+    void subscribeInIoThread(QGrpcStream *stream, const QString &service, QAbstractGrpcClient *client);
+
+    //Makes client stream call in I/O thread, when writes are done
+    void openStreamInIoThread(QGrpcClientStream *stream, const QString &service, QAbstractGrpcClient *client);
+
+    QGrpcHttp2ChannelPrivate(const QUrl &_url, std::unique_ptr<QAbstractGrpcCredentials> _credentials)
+        : url(_url)
+        , credentials(std::move(_credentials))
+    {
+        if (url.scheme() == "https") {
+            if (!credentials->channelCredentials().contains(QLatin1String(SslConfigCredential))) {
+                throw std::invalid_argument("Https connection requested but not ssl configuration provided.");
+            }
+            sslConfig = credentials->channelCredentials().value(QLatin1String(SslConfigCredential)).value<QSslConfiguration>();
+            //Session tickets are kept by channel and reused by reconnects
+            sslConfig.setSslOption(QSsl::SslOptionDisableSessionTickets, false);
+            sslConfig.setSslOption(QSsl::SslOptionDisableSessionSharing, false);
+            sslConfig.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+        } else if (url.scheme().isEmpty()) {
+            url.setScheme("http");
+        }
+
+        setConnectionCount(1);
+        deadlineTimer.setSingleShot(true);
+        QObject::connect(&deadlineTimer, &QTimer::timeout, &lambdaContext, [this] {
+            processDeadlines();
+        });
+        QObject::connect(&keepaliveTimer, &QTimer::timeout, &lambdaContext, [this] {
+            processKeepalive();
+        });
+    }
+
+};
+
+}
+
+void QGrpcHttp2ChannelPrivate::startClientStream(QGrpcClientStream *stream, QNetworkReply *networkReply, QAbstractGrpcClient *client)
+{
+    networkReply->setReadBufferSize(streamReadBufferSize);
+    std::shared_ptr<QMetaObject::Connection> readConnection(new QMetaObject::Connection);
+    std::shared_ptr<QMetaObject::Connection> finishConnection(new QMetaObject::Connection);
+    std::shared_ptr<QMetaObject::Connection> abortConnection(new QMetaObject::Connection);
+    std::shared_ptr<QMetaObject::Connection> clientConnection(new QMetaObject::Connection);
+    auto disconnectAll = [readConnection, finishConnection, abortConnection, clientConnection]() {
+        QObject::disconnect(*readConnection);
+        QObject::disconnect(*finishConnection);
+        QObject::disconnect(*abortConnection);
+        QObject::disconnect(*clientConnection);
+    };
+
+    *readConnection = QObject::connect(networkReply, &QNetworkReply::readyRead, stream, [this, networkReply, stream]() {
+        readStreamFrames(networkReply, [stream](const QByteArray &message) {
+            stream->handler(message);
+        });
+    });
+
+    *finishConnection = QObject::connect(networkReply, &QNetworkReply::finished, stream, [this, networkReply, stream, disconnectAll]() {
+        disconnectAll();
+        QGrpcStatus::StatusCode statusCode = QGrpcStatus::Ok;
+        if (networkReply->error() != QNetworkReply::NoError) {
+            statusCode = grpcStatusOfNetworkError(networkReply->error());
+        } else {
+            readStreamFrames(networkReply, [stream](const QByteArray &message) {
+                stream->handler(message);
+            });
+            statusCode = static_cast<QGrpcStatus::StatusCode>(networkReply->rawHeader(GrpcStatusHeader).toInt());
+        }
+        const QString statusMessage = QString::fromUtf8(networkReply->rawHeader(GrpcStatusMessage));
+        activeStreamReplies.erase(networkReply);
+        networkReply->deleteLater();
+
+        if (statusCode == QGrpcStatus::Ok) {
+            stream->finished();
+        } else {
+            stream->error({statusCode, statusMessage});
+        }
+    });
+
+    *abortConnection = QObject::connect(stream, &QGrpcClientStream::error, networkReply, [this, networkReply, disconnectAll](const QGrpcStatus &status) {
+        if (status.code() == QGrpcStatus::Aborted) {
+            disconnectAll();
+            activeStreamReplies.erase(networkReply);
+            QGrpcHttp2ChannelPrivate::abortNetworkReply(networkReply);
+            networkReply->deleteLater();
+        }
+    });
+
+    *clientConnection = QObject::connect(client, &QAbstractGrpcClient::destroyed, networkReply, [this, networkReply, disconnectAll]() {
+        disconnectAll();
+        activeStreamReplies.erase(networkReply);
+        QGrpcHttp2ChannelPrivate::abortNetworkReply(networkReply);
+        networkReply->deleteLater();
+    });
+}
+
+void QGrpcHttp2ChannelPrivate::subscribeInIoThread(QGrpcStream *stream, const QString &service, QAbstractGrpcClient *client)
+{
+    //Queue is deleted in thread of stream after all its queued signals are delivered there
+    std::shared_ptr<QGrpcStreamQueue> queue(new QGrpcStreamQueue, [](QGrpcStreamQueue *queue) { queue->deleteLater(); });
+    std::shared_ptr<IoStream> ioStream(new IoStream(queue));
+    std::weak_ptr<IoStream> weakStream = ioStream;
+    std::shared_ptr<QGrpcSpan> span = stream->span();
+    if (span) {
+        span->addEvent(QGrpcSpan::RequestSent);
+    }
+
+    //Connections of stream are released together with queue
+    QGrpcStreamQueue *queuePtr = queue.get();
+    auto firstRead = std::make_shared<bool>(true);
+    auto deliver = [stream, queuePtr, span, firstRead] {
+        std::vector<QByteArray> messages = queuePtr->takeMessages();
+        if (messages.empty() || queuePtr->isCancelled()) {
+            return;
+        }
+
+        if (span) {
+            if (*firstRead) {
+                span->addEvent(QGrpcSpan::FirstByteReceived);
+            }
+            for (size_t i = 0; i < messages.size(); ++i) {
+                span->addEvent(QGrpcSpan::MessageReceived);
+            }
+        }
+        *firstRead = false;
+
+        //Only the last of messages received at once is delivered
+        if (stream->isLatestMessageOnly()) {
+            stream->handler(messages.back());
+            return;
+        }
+
+        for (const QByteArray &message : messages) {
+            stream->handler(message);
+            //Handler may cancel stream
+            if (queuePtr->isCancelled()) {
+                return;
+            }
+        }
+    };
+    QObject::connect(queuePtr, &QGrpcStreamQueue::messagesReady, stream, deliver);
+
+    QObject::connect(queuePtr, &QGrpcStreamQueue::closed, stream, [stream, queuePtr, deliver, service] {
+        deliver();
+        if (queuePtr->isCancelled()) {
+            return;
+        }
+        queuePtr->cancel();
+
+        const QGrpcStatus status = queuePtr->status();
+        qProtoWarning() << stream->method() << "call" << service << "stream finished: " << status.message();
+        if (status.code() != QGrpcStatus::Ok) {
+            stream->error(QGrpcStatus{status.code(), QString("%1 call %2 stream failed: %3").arg(service).arg(stream->method()).arg(status.message())});
+        }
+    });
+
+    QObject::connect(stream, &QGrpcStream::finished, queuePtr, [this, queuePtr, weakStream] {
+        queuePtr->cancel();
+        postAbort(weakStream);
+    });
+
+    QObject::connect(client, &QAbstractGrpcClient::destroyed, queuePtr, [this, queuePtr, weakStream] {
+        queuePtr->cancel();
+        postAbort(weakStream);
+    });
+
+    QMetaObject::invokeMethod(&lambdaContext, [this, ioStream, method = stream->method(), service, arg = stream->arg()] {
+        readIoStream(ioStream, post(method, service, arg, true), false);
+    }, Qt::QueuedConnection);
+}
+
+void QGrpcHttp2ChannelPrivate::openStreamInIoThread(QGrpcClientStream *stream, const QString &service, QAbstractGrpcClient *client)
+{
+    std::shared_ptr<QGrpcStreamQueue> queue(new QGrpcStreamQueue, [](QGrpcStreamQueue *queue) { queue->deleteLater(); });
+    std::shared_ptr<IoStream> ioStream(new IoStream(queue));
+    std::weak_ptr<IoStream> weakStream = ioStream;
+    QGrpcStreamQueue *queuePtr = queue.get();
 
-    static void abortNetworkReply(QNetworkReply *networkReply) {
-        if (networkReply->isRunning()) {
-            networkReply->abort();
-        } else {
-            networkReply->deleteLater();
+    auto deliver = [stream, queuePtr] {
+        for (const QByteArray &message : queuePtr->takeMessages()) {
+            if (queuePtr->isCancelled()) {
+                return;
+            }
+            stream->handler(message);
         }
-    }
+    };
+    QObject::connect(queuePtr, &QGrpcStreamQueue::messagesReady, stream, deliver);
 
-    static QByteArray processReply(QNetworkReply *networkReply, QGrpcStatus::StatusCode &statusCode) {
-        //Check if no network error occured
-        if (networkReply->error() != QNetworkReply::NoError) {
-            statusCode = StatusCodeMap.at(networkReply->error());
-            return {};
+    QObject::connect(queuePtr, &QGrpcStreamQueue::closed, stream, [stream, queuePtr, deliver] {
+        deliver();
+        if (queuePtr->isCancelled()) {
+            return;
         }
+        queuePtr->cancel();
 
-        //Check if server answer with error
-        statusCode = static_cast<QGrpcStatus::StatusCode>(networkReply->rawHeader(GrpcStatusHeader).toInt());
-        if (statusCode != QGrpcStatus::StatusCode::Ok) {
-            return {};
+        const QGrpcStatus status = queuePtr->status();
+        if (status.code() == QGrpcStatus::Ok) {
+            stream->finished();
+        } else {
+            stream->error(status);
         }
+    });
 
-        //Message size doesn't matter for now
-        return networkReply->readAll().mid(GrpcMessageSizeHeaderSize);
-    }
+    //Messages are framed in I/O thread, since prepared request of method is used there
+    std::shared_ptr<std::vector<QByteArray>> messages(new std::vector<QByteArray>);
+    std::shared_ptr<QMetaObject::Connection> writeConnection(new QMetaObject::Connection);
+    const QString method = stream->method();
+    *writeConnection = QObject::connect(stream, &QGrpcClientStream::pendingWritesChanged, queuePtr, [this, stream, service, method, messages, writeConnection, ioStream] {
+        while (stream->hasPendingWrites()) {
+            messages->push_back(stream->takePendingWrite());
+        }
+        if (!stream->isWritesDone()) {
+            return;
+        }
 
-    QGrpcHttp2ChannelPrivate(const QUrl &_url, std::unique_ptr<QAbstractGrpcCredentials> _credentials)
-        : url(_url)
-        , credentials(std::move(_credentials))
-    {
-        if (url.scheme() == "https") {
-            if (!credentials->channelCredentials().contains(QLatin1String(SslConfigCredential))) {
-                throw std::invalid_argument("Https connection requested but not ssl configuration provided.");
+        QObject::disconnect(*writeConnection);
+        QMetaObject::invokeMethod(&lambdaContext, [this, ioStream, method, service, writes = std::move(*messages)] {
+            const CallTemplate &callTemplate = requestTemplate(method, service, true);
+            QByteArray body;
+            for (const QByteArray &message : writes) {
+                appendFrame(message, callTemplate.compression, body);
             }
-            sslConfig = credentials->channelCredentials().value(QLatin1String(SslConfigCredential)).value<QSslConfiguration>();
-        } else if (url.scheme().isEmpty()) {
-            url.setScheme("http");
-        }
-    }
+            readIoStream(ioStream, postFrames(callTemplate, body), true);
+        }, Qt::QueuedConnection);
+    });
 
-    static int getExpectedDataSize(const QByteArray &container) {
-        return qFromBigEndian(*reinterpret_cast<const int *>(container.data() + 1)) + GrpcMessageSizeHeaderSize;
-    }
-};
+    QObject::connect(stream, &QGrpcClientStream::error, queuePtr, [this, queuePtr, weakStream, writeConnection](const QGrpcStatus &status) {
+        if (status.code() == QGrpcStatus::Aborted) {
+            QObject::disconnect(*writeConnection);
+            queuePtr->cancel();
+            postAbort(weakStream);
+        }
+    });
 
+    QObject::connect(client, &QAbstractGrpcClient::destroyed, queuePtr, [this, queuePtr, weakStream] {
+        queuePtr->cancel();
+        postAbort(weakStream);
+    });
 }
 
 QGrpcHttp2Channel::QGrpcHttp2Channel(const QUrl &url, std::unique_ptr<QAbstractGrpcCredentials> credentials) : QAbstractGrpcChannel()
@@ -206,13 +1475,48 @@ QGrpcHttp2Channel::QGrpcHttp2Channel(const QUrl &url, std::unique_ptr<QAbstractG
 
 QGrpcHttp2Channel::~QGrpcHttp2Channel()
 {
+    if (dPtr->ioThread) {
+        dPtr->stopIoThread();
+    }
 }
 
 QGrpcStatus QGrpcHttp2Channel::call(const QString &method, const QString &service, const QByteArray &args, QByteArray &ret)
 {
+    if (QThread::currentThread() != dPtr->lambdaContext.thread()) {
+        //Network access manager lives in thread of channel. Calling thread is blocked
+        //until call is completed there, without spinning of nested event loop.
+        QSemaphore completed;
+        QGrpcStatus status;
+        QMetaObject::invokeMethod(&dPtr->lambdaContext, [&] {
+            QNetworkReply *networkReply = dPtr->post(method, service, args);
+            std::shared_ptr<QGrpcHttp2ChannelPrivate::UnaryReply> unaryReply(new QGrpcHttp2ChannelPrivate::UnaryReply);
+            QObject::connect(networkReply, &QNetworkReply::readyRead, &dPtr->lambdaContext, [networkReply, unaryReply] {
+                unaryReply->read(networkReply);
+            });
+
+            auto finish = [networkReply, unaryReply, &status, &ret, &completed] {
+                status = QGrpcHttp2ChannelPrivate::finishCall(networkReply, *unaryReply, ret);
+                completed.release();
+            };
+
+            if (networkReply->isFinished()) {
+                finish();
+            } else {
+                QObject::connect(networkReply, &QNetworkReply::finished, &dPtr->lambdaContext, finish);
+            }
+        }, Qt::QueuedConnection);
+        completed.acquire();
+        return status;
+    }
+
+    //Called in thread of channel, so the only way to wait for network reply is nested event loop
     QEventLoop loop;
 
     QNetworkReply *networkReply = dPtr->post(method, service, args);
+    QGrpcHttp2ChannelPrivate::UnaryReply unaryReply;
+    QObject::connect(networkReply, &QNetworkReply::readyRead, &loop, [networkReply, &unaryReply] {
+        unaryReply.read(networkReply);
+    });
     QObject::connect(networkReply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
 
     //If reply was finished in same stack it doesn't make sense to start event loop
@@ -220,100 +1524,92 @@ QGrpcStatus QGrpcHttp2Channel::call(const QString &method, const QString &servic
         loop.exec();
     }
 
-    QGrpcStatus::StatusCode grpcStatus = QGrpcStatus::StatusCode::Unknown;
-    ret = dPtr->processReply(networkReply, grpcStatus);
+    return QGrpcHttp2ChannelPrivate::finishCall(networkReply, unaryReply, ret);
+}
 
-    networkReply->deleteLater();
-    qProtoDebug() << __func__ << "RECV: " << ret.toHex() << "grpcStatus" << grpcStatus;
-    return {grpcStatus, QString::fromUtf8(networkReply->rawHeader(GrpcStatusMessage))};
+bool QGrpcHttp2Channel::isThreadSafe() const
+{
+    return true;
 }
 
 void QGrpcHttp2Channel::call(const QString &method, const QString &service, const QByteArray &args, QGrpcAsyncReply *reply)
 {
     assert(reply != nullptr);
-    QNetworkReply *networkReply = dPtr->post(method, service, args);
-
-    std::shared_ptr<QMetaObject::Connection> connection(new QMetaObject::Connection);
-    std::shared_ptr<QMetaObject::Connection> abortConnection(new QMetaObject::Connection);
-    *connection = QObject::connect(networkReply, &QNetworkReply::finished, reply, [reply, networkReply, connection, abortConnection]() {
-        QGrpcStatus::StatusCode grpcStatus = QGrpcStatus::StatusCode::Unknown;
-        QByteArray data = QGrpcHttp2ChannelPrivate::processReply(networkReply, grpcStatus);
-        if (*connection) {
-            QObject::disconnect(*connection);
-        }
-        if (*abortConnection) {
-            QObject::disconnect(*abortConnection);
-        }
-
-        qProtoDebug() << "RECV: " << data;
-        if (QGrpcStatus::StatusCode::Ok == grpcStatus) {
-            reply->setData(data);
-            reply->finished();
-        } else {
-            reply->setData({});
-            reply->error({grpcStatus, QString::fromUtf8(networkReply->rawHeader(GrpcStatusMessage))});
-        }
-        networkReply->deleteLater();
-    });
+    QPointer<QGrpcAsyncReply> replyPtr(reply);
+    //Options and span are taken in thread of reply, they are not changed after call is started
+    const QGrpcCallOptions options = reply->options();
+    const std::shared_ptr<QGrpcSpan> span = reply->span();
+    if (QThread::currentThread() != dPtr->lambdaContext.thread()) {
+        //Network request is made in thread of channel, reply receives result in own thread
+        QMetaObject::invokeMethod(&dPtr->lambdaContext, [this, method, service, args, replyPtr, options, span] {
+            dPtr->call(method, service, args, replyPtr, options, span);
+        }, Qt::QueuedConnection);
+        return;
+    }
+    dPtr->call(method, service, args, replyPtr, options, span);
+}
 
-    *abortConnection = QObject::connect(reply, &QGrpcAsyncReply::error, networkReply, [networkReply, connection, abortConnection] (const QGrpcStatus &status) {
-        if (status.code() == QGrpcStatus::Aborted) {
-            if (*connection) {
-                QObject::disconnect(*connection);
-            }
-            if (*abortConnection) {
-                QObject::disconnect(*abortConnection);
-            }
-            networkReply->deleteLater();
-        }
-    });
+void QGrpcHttp2Channel::callWithHandler(const QString &method, const QString &service, const QByteArray &args, const CallHandler &handler)
+{
+    if (QThread::currentThread() != dPtr->lambdaContext.thread()) {
+        QMetaObject::invokeMethod(&dPtr->lambdaContext, [this, method, service, args, handler] {
+            dPtr->callWithHandler(method, service, args, handler);
+        }, Qt::QueuedConnection);
+        return;
+    }
+    dPtr->callWithHandler(method, service, args, handler);
 }
 
 void QGrpcHttp2Channel::subscribe(QGrpcStream *stream, const QString &service, QAbstractGrpcClient *client)
 {
     assert(stream != nullptr);
+    if (dPtr->ioThread) {
+        dPtr->subscribeInIoThread(stream, service, client);
+        return;
+    }
+
     QNetworkReply *networkReply = dPtr->post(stream->method(), service, stream->arg(), true);
+    //Bounded buffer stops reading from server, when messages are not consumed in time
+    networkReply->setReadBufferSize(dPtr->streamReadBufferSize);
+    //Stream is handled in its own thread, so span is used by stream and channel sequentially
+    std::shared_ptr<QGrpcSpan> span = stream->span();
+    if (span) {
+        span->addEvent(QGrpcSpan::RequestSent);
+    }
 
     std::shared_ptr<QMetaObject::Connection> finishConnection(new QMetaObject::Connection);
     std::shared_ptr<QMetaObject::Connection> abortConnection(new QMetaObject::Connection);
     std::shared_ptr<QMetaObject::Connection> readConnection(new QMetaObject::Connection);
-    *readConnection = QObject::connect(networkReply, &QNetworkReply::readyRead, stream, [networkReply, stream, this]() {
-        auto replyIt = dPtr->activeStreamReplies.find(networkReply);
-
-        QByteArray data = networkReply->readAll();
-        qProtoDebug() << "RECV" << data.size();
-
-        if (replyIt == dPtr->activeStreamReplies.end()) {
-            qProtoDebug() << data.toHex();
-            int expectedDataSize = QGrpcHttp2ChannelPrivate::getExpectedDataSize(data);
-            qProtoDebug() << "First chunk received: " << data.size() << " expectedDataSize: " << expectedDataSize;
-
-            if (expectedDataSize == 0) {
-                stream->handler(QByteArray());
-                return;
-            }
-
-            QGrpcHttp2ChannelPrivate::ExpectedData dataContainer{expectedDataSize, QByteArray{}};
-            replyIt = dPtr->activeStreamReplies.insert({networkReply, dataContainer}).first;
+    *readConnection = QObject::connect(networkReply, &QNetworkReply::readyRead, stream, [networkReply, stream, span, firstRead = true, this]() mutable {
+        if (span && firstRead) {
+            span->addEvent(QGrpcSpan::FirstByteReceived);
         }
+        firstRead = false;
 
-        QGrpcHttp2ChannelPrivate::ExpectedData &dataContainer = replyIt->second;
-        dataContainer.container.append(data);
-
-        qProtoDebug() << "Proceed chunk: " << data.size() << " dataContainer: " << dataContainer.container.size() << " capacity: " << dataContainer.expectedSize;
-        while (dataContainer.container.size() >= dataContainer.expectedSize && !networkReply->isFinished()) {
-            qProtoDebug() << "Full data received: " << data.size() << " dataContainer: " << dataContainer.container.size() << " capacity: " << dataContainer.expectedSize;
-            stream->handler(dataContainer.container.mid(GrpcMessageSizeHeaderSize, dataContainer.expectedSize - GrpcMessageSizeHeaderSize));
-            dataContainer.container.remove(0, dataContainer.expectedSize);
-            if (dataContainer.container.size() > GrpcMessageSizeHeaderSize) {
-                dataContainer.expectedSize = QGrpcHttp2ChannelPrivate::getExpectedDataSize(dataContainer.container);
-            } else if (dataContainer.container.size() > 0) {
-                qProtoWarning() << "Invalid container size received, size header is less than 5 bytes";
-            }
+        if (!stream->isLatestMessageOnly()) {
+            dPtr->readStreamFrames(networkReply, [stream, &span](const QByteArray &message) {
+                if (span) {
+                    span->addEvent(QGrpcSpan::MessageReceived);
+                }
+                stream->handler(message);
+            });
+            return;
         }
 
-        if (dataContainer.container.size() < GrpcMessageSizeHeaderSize || networkReply->isFinished()) {
-            dPtr->activeStreamReplies.erase(replyIt);
+        //Only the last of messages received at once is delivered
+        QByteArray latestMessage;
+        bool received = false;
+        dPtr->readStreamFrames(networkReply, [&latestMessage, &received, &span](const QByteArray &message) {
+            if (span) {
+                span->addEvent(QGrpcSpan::MessageReceived);
+            }
+            //Dropped message is recycled
+            QProtobufBufferAllocator::current()->release(std::move(latestMessage));
+            latestMessage = message;
+            received = true;
+        });
+        if (received) {
+            stream->handler(latestMessage);
         }
     });
 
@@ -332,7 +1628,7 @@ void QGrpcHttp2Channel::subscribe(QGrpcStream *stream, const QString &service, Q
         networkReply->deleteLater();
     });
 
-    *finishConnection = QObject::connect(networkReply, &QNetworkReply::finished, stream, [stream, service, networkReply, abortConnection, readConnection, finishConnection, client, this]() {
+    *finishConnection = QObject::connect(networkReply, &QNetworkReply::finished, stream, [stream, service, networkReply, abortConnection, readConnection, finishConnection, this]() {
         QString errorString = networkReply->errorString();
         QNetworkReply::NetworkError networkError = networkReply->error();
         if (*readConnection) {
@@ -347,20 +1643,16 @@ void QGrpcHttp2Channel::subscribe(QGrpcStream *stream, const QString &service, Q
         networkReply->deleteLater();
         qProtoWarning() << stream->method() << "call" << service << "stream finished: " << errorString;
         switch (networkError) {
-        case QNetworkReply::RemoteHostClosedError:
-            qProtoDebug() << "Remote server closed connection. Reconnect silently";
-            subscribe(stream, service, client);
-            break;
         case QNetworkReply::NoError:
             //Reply closed without error
             break;
         default:
-            stream->error(QGrpcStatus{StatusCodeMap.at(networkError), QString("%1 call %2 stream failed: %3").arg(service).arg(stream->method()).arg(errorString)});
+            stream->error(QGrpcStatus{grpcStatusOfNetworkError(networkError), QString("%1 call %2 stream failed: %3").arg(service).arg(stream->method()).arg(errorString)});
             break;
         }
     });
 
-    *abortConnection = QObject::connect(stream, &QGrpcStream::finished, networkReply, [networkReply, finishConnection, abortConnection, readConnection] {
+    *abortConnection = QObject::connect(stream, &QGrpcStream::finished, networkReply, [networkReply, finishConnection, abortConnection, readConnection, this] {
         if (*finishConnection) {
             QObject::disconnect(*finishConnection);
         }
@@ -370,13 +1662,338 @@ void QGrpcHttp2Channel::subscribe(QGrpcStream *stream, const QString &service, Q
         if (*abortConnection) {
             QObject::disconnect(*abortConnection);
         }
+        dPtr->activeStreamReplies.erase(networkReply);
         QGrpcHttp2ChannelPrivate::abortNetworkReply(networkReply);
         networkReply->deleteLater();
     });
 }
 
+void QGrpcHttp2Channel::setDefaultDeadline(std::chrono::milliseconds deadline)
+{
+    dPtr->configure([&] {
+        dPtr->defaultDeadline = deadline;
+        dPtr->requestTemplates.clear();
+    });
+}
+
+std::chrono::milliseconds QGrpcHttp2Channel::defaultDeadline() const
+{
+    return dPtr->defaultDeadline;
+}
+
+void QGrpcHttp2Channel::setMethodDeadline(const QString &service, const QString &method, std::chrono::milliseconds deadline)
+{
+    dPtr->configure([&] {
+        dPtr->methodDeadlines[QGrpcHttp2ChannelPrivate::methodKey(method, service)] = deadline;
+        dPtr->requestTemplates.clear();
+    });
+}
+
+void QGrpcHttp2Channel::resetMethodDeadline(const QString &service, const QString &method)
+{
+    dPtr->configure([&] {
+        dPtr->methodDeadlines.erase(QGrpcHttp2ChannelPrivate::methodKey(method, service));
+        dPtr->requestTemplates.clear();
+    });
+}
+
+void QGrpcHttp2Channel::openStream(QGrpcClientStream *stream, const QString &service, QAbstractGrpcClient *client)
+{
+    assert(stream != nullptr);
+    if (dPtr->ioThread) {
+        dPtr->openStreamInIoThread(stream, service, client);
+        return;
+    }
+
+    //QNetworkAccessManager sends request body at once, so written messages are framed to single body, that is sent
+    //when writes are done
+    std::shared_ptr<QByteArray> body(new QByteArray);
+    std::shared_ptr<QMetaObject::Connection> writeConnection(new QMetaObject::Connection);
+    std::shared_ptr<QMetaObject::Connection> cancelConnection(new QMetaObject::Connection);
+    const QString method = stream->method();
+    *writeConnection = QObject::connect(stream, &QGrpcClientStream::pendingWritesChanged, stream, [this, stream, service, method, client, body, writeConnection, cancelConnection]() {
+        const QGrpcHttp2ChannelPrivate::CallTemplate &callTemplate = dPtr->requestTemplate(method, service, true);
+        while (stream->hasPendingWrites()) {
+            dPtr->appendFrame(stream->takePendingWrite(), callTemplate.compression, *body);
+        }
+        if (!stream->isWritesDone()) {
+            return;
+        }
+
+        QObject::disconnect(*writeConnection);
+        QObject::disconnect(*cancelConnection);
+        dPtr->startClientStream(stream, dPtr->postFrames(callTemplate, *body), client);
+        body->clear();
+    });
+
+    *cancelConnection = QObject::connect(stream, &QGrpcClientStream::error, stream, [writeConnection, cancelConnection](const QGrpcStatus &) {
+        QObject::disconnect(*writeConnection);
+        QObject::disconnect(*cancelConnection);
+    });
+}
+
+bool QGrpcHttp2Channel::isCompressionSupported()
+{
+#ifdef QT_GRPC_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+void QGrpcHttp2Channel::setDefaultCompression(CompressionAlgorithm algorithm)
+{
+    if (algorithm != NoCompression && !isCompressionSupported()) {
+        qProtoWarning() << "Compression is not supported, messages are sent uncompressed";
+        return;
+    }
+    dPtr->configure([&] {
+        dPtr->defaultCompression = algorithm;
+        dPtr->requestTemplates.clear();
+    });
+}
+
+QGrpcHttp2Channel::CompressionAlgorithm QGrpcHttp2Channel::defaultCompression() const
+{
+    return dPtr->defaultCompression;
+}
+
+void QGrpcHttp2Channel::setMethodCompression(const QString &service, const QString &method, CompressionAlgorithm algorithm)
+{
+    if (algorithm != NoCompression && !isCompressionSupported()) {
+        qProtoWarning() << "Compression is not supported, messages are sent uncompressed";
+        return;
+    }
+    dPtr->configure([&] {
+        dPtr->methodCompressions[QGrpcHttp2ChannelPrivate::methodKey(method, service)] = algorithm;
+        dPtr->requestTemplates.clear();
+    });
+}
+
+void QGrpcHttp2Channel::resetMethodCompression(const QString &service, const QString &method)
+{
+    dPtr->configure([&] {
+        dPtr->methodCompressions.erase(QGrpcHttp2ChannelPrivate::methodKey(method, service));
+        dPtr->requestTemplates.clear();
+    });
+}
+
+void QGrpcHttp2Channel::setCompressionThreshold(int size)
+{
+    dPtr->configure([&] {
+        dPtr->compressionThreshold = size;
+    });
+}
+
+int QGrpcHttp2Channel::compressionThreshold() const
+{
+    return dPtr->compressionThreshold;
+}
+
+void QGrpcHttp2Channel::setConnectionCount(int count)
+{
+    dPtr->configure([&] {
+        dPtr->setConnectionCount(count);
+    });
+}
+
+int QGrpcHttp2Channel::connectionCount() const
+{
+    return static_cast<int>(dPtr->connections.size());
+}
+
+void QGrpcHttp2Channel::connectAhead()
+{
+    if (QThread::currentThread() != dPtr->lambdaContext.thread()) {
+        QMetaObject::invokeMethod(&dPtr->lambdaContext, [this] {
+            dPtr->connectAhead();
+        }, Qt::QueuedConnection);
+        return;
+    }
+    dPtr->connectAhead();
+}
+
+void QGrpcHttp2Channel::setConnectionSharingEnabled(bool enabled)
+{
+    dPtr->configure([&] {
+        if (dPtr->connectionSharing == enabled) {
+            return;
+        }
+        dPtr->connectionSharing = enabled;
+        dPtr->resetHttp2Configuration();
+    });
+}
+
+bool QGrpcHttp2Channel::isConnectionSharingEnabled() const
+{
+    return dPtr->connectionSharing;
+}
+
+void QGrpcHttp2Channel::setKeepaliveInterval(std::chrono::milliseconds interval)
+{
+    dPtr->configure([&] {
+        dPtr->keepaliveInterval = interval;
+        dPtr->updateKeepaliveTimer();
+    });
+}
+
+std::chrono::milliseconds QGrpcHttp2Channel::keepaliveInterval() const
+{
+    return dPtr->keepaliveInterval;
+}
+
+void QGrpcHttp2Channel::setKeepaliveTimeout(std::chrono::milliseconds timeout)
+{
+    dPtr->configure([&] {
+        dPtr->keepaliveTimeout = timeout;
+    });
+}
+
+std::chrono::milliseconds QGrpcHttp2Channel::keepaliveTimeout() const
+{
+    return dPtr->keepaliveTimeout;
+}
+
+void QGrpcHttp2Channel::setIdleTimeout(std::chrono::milliseconds timeout)
+{
+    dPtr->configure([&] {
+        dPtr->idleTimeout = timeout;
+        dPtr->updateKeepaliveTimer();
+    });
+}
+
+std::chrono::milliseconds QGrpcHttp2Channel::idleTimeout() const
+{
+    return dPtr->idleTimeout;
+}
+
+void QGrpcHttp2Channel::setStreamReadBufferSize(qint64 size)
+{
+    dPtr->configure([&] {
+        dPtr->streamReadBufferSize = std::max<qint64>(0, size);
+    });
+}
+
+qint64 QGrpcHttp2Channel::streamReadBufferSize() const
+{
+    return dPtr->streamReadBufferSize;
+}
+
+void QGrpcHttp2Channel::setStreamReceiveWindowSize(int size)
+{
+    dPtr->configure([&] {
+        dPtr->streamWindowSize = size;
+        dPtr->resetHttp2Configuration();
+    });
+}
+
+int QGrpcHttp2Channel::streamReceiveWindowSize() const
+{
+    return dPtr->streamWindowSize;
+}
+
+void QGrpcHttp2Channel::setSessionReceiveWindowSize(int size)
+{
+    dPtr->configure([&] {
+        dPtr->sessionWindowSize = size;
+        dPtr->resetHttp2Configuration();
+    });
+}
+
+int QGrpcHttp2Channel::sessionReceiveWindowSize() const
+{
+    return dPtr->sessionWindowSize;
+}
+
+void QGrpcHttp2Channel::setMaxFrameSize(int size)
+{
+    dPtr->configure([&] {
+        dPtr->maxFrameSize = size;
+        dPtr->resetHttp2Configuration();
+    });
+}
+
+int QGrpcHttp2Channel::maxFrameSize() const
+{
+    return dPtr->maxFrameSize;
+}
+
+void QGrpcHttp2Channel::setWindowAutoTuningEnabled(bool enabled)
+{
+    dPtr->configure([&] {
+        if (dPtr->windowAutoTuning == enabled) {
+            return;
+        }
+        dPtr->windowAutoTuning = enabled;
+        dPtr->autoTunedWindowSize = DefaultHttp2WindowSize;
+        dPtr->minRoundTripTime = -1;
+        dPtr->resetHttp2Configuration();
+    });
+}
+
+bool QGrpcHttp2Channel::isWindowAutoTuningEnabled() const
+{
+    return dPtr->windowAutoTuning;
+}
+
+int QGrpcHttp2Channel::autoTunedWindowSize() const
+{
+    return dPtr->effectiveStreamWindowSize();
+}
+
+void QGrpcHttp2Channel::setIoThreadEnabled(bool enabled)
+{
+    if (enabled == isIoThreadEnabled()) {
+        return;
+    }
+
+    if (QThread::currentThread() != dPtr->ownerThread) {
+        qProtoWarning() << "I/O thread of channel is enabled or disabled in thread, that channel is created in";
+        return;
+    }
+
+    if (enabled) {
+        dPtr->startIoThread();
+        return;
+    }
+
+    const int count = connectionCount();
+    dPtr->stopIoThread();
+    dPtr->setConnectionCount(count);
+}
+
+bool QGrpcHttp2Channel::isIoThreadEnabled() const
+{
+    return dPtr->ioThread != nullptr;
+}
+
 std::shared_ptr<QAbstractProtobufSerializer> QGrpcHttp2Channel::serializer() const
 {
-    //TODO: make selection based on credentials or channel settings
-    return QProtobufSerializerRegistry::instance().getSerializer("protobuf");
+    return dPtr->serializerPlugin.isEmpty() ? QProtobufSerializerRegistry::instance().getSerializer(dPtr->serializerId)
+                                            : QProtobufSerializerRegistry::instance().getSerializer(dPtr->serializerId, dPtr->serializerPlugin);
+}
+
+bool QGrpcHttp2Channel::setSerializer(const QString &id, const QString &plugin)
+{
+    if (QProtobufSerializerRegistry::instance().findSerializer(id, plugin) == nullptr) {
+        qProtoWarning() << "Serializer" << id << "of plugin" << plugin << "is not loaded, channel serializer is not changed";
+        return false;
+    }
+    dPtr->configure([&] {
+        dPtr->serializerId = id;
+        dPtr->serializerPlugin = plugin;
+        dPtr->contentType = serializerContentType(id);
+        dPtr->requestTemplates.clear();
+    });
+    return true;
+}
+
+QString QGrpcHttp2Channel::serializerId() const
+{
+    return dPtr->serializerId;
+}
+
+QByteArray QGrpcHttp2Channel::contentType() const
+{
+    return dPtr->contentType;
 }
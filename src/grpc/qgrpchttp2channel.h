@@ -28,11 +28,13 @@
 #include "qabstractgrpcchannel.h"
 
 #include <QUrl>
+#include <chrono>
 #include <memory>
 
 namespace QtProtobuf {
 
 class QAbstractGrpcCredentials;
+class QGrpcClientStream;
 struct QGrpcHttp2ChannelPrivate;
 /*!
  * \ingroup QtGrpc
@@ -47,6 +49,15 @@ struct QGrpcHttp2ChannelPrivate;
 class Q_GRPC_EXPORT QGrpcHttp2Channel final : public QAbstractGrpcChannel
 {
 public:
+    /*!
+     * \brief Compression algorithms of messages sent using channel
+     */
+    enum CompressionAlgorithm {
+        NoCompression,      //!< Messages are sent uncompressed
+        DeflateCompression, //!< Messages are compressed using deflate algorithm
+        GzipCompression     //!< Messages are compressed using gzip algorithm
+    };
+
     /*!
      * \brief QGrpcHttp2Channel constructs QGrpcHttp2Channel
      * \param url http/https url used to establish channel connection
@@ -57,8 +68,272 @@ public:
 
     QGrpcStatus call(const QString &method, const QString &service, const QByteArray &args, QByteArray &ret) override;
     void call(const QString &method, const QString &service, const QByteArray &args, QtProtobuf::QGrpcAsyncReply *reply) override;
+    /*!
+     * \brief Calls \p method asynchronously and passes result of call to \p handler
+     * \details Network request is made in thread of channel, \p handler is invoked in thread of channel as well.
+     */
+    void callWithHandler(const QString &method, const QString &service, const QByteArray &args, const CallHandler &handler) override;
     void subscribe(QGrpcStream *stream, const QString &service, QAbstractGrpcClient *client) override;
+    /*!
+     * \brief Opens client-streaming or bidirectional-streaming call
+     * \details QNetworkAccessManager sends request body at once, so messages written to \a stream are sent together
+     *          when QGrpcClientStream::writesDone() is called. Messages of server are received while they arrive.
+     */
+    void openStream(QGrpcClientStream *stream, const QString &service, QAbstractGrpcClient *client) override;
     std::shared_ptr<QAbstractProtobufSerializer> serializer() const override;
+    /*!
+     * \brief Returns true. Network requests are always made in thread of channel. Synchronous call made from other
+     *        thread blocks calling thread until call is completed, synchronous call made in thread of channel spins nested
+     *        event loop. Result of asynchronous call is delivered to thread of QGrpcAsyncReply.
+     */
+    bool isThreadSafe() const override;
+
+    /*!
+     * \brief Sets deadline of unary calls made using channel. Default deadline is 6 seconds.
+     * \details Deadline is sent to server in grpc-timeout header. Call that is not finished until deadline is aborted
+     *          with QGrpcStatus::DeadlineExceeded status. Zero \a deadline disables deadline of calls.
+     *          Deadline is applied to calls started after the method call.
+     */
+    void setDefaultDeadline(std::chrono::milliseconds deadline);
+
+    /*!
+     * \brief Returns deadline of unary calls made using channel
+     */
+    std::chrono::milliseconds defaultDeadline() const;
+
+    /*!
+     * \brief Sets deadline of \a method calls of \a service, that overrides default deadline of channel
+     * \param service Full name of service, e.g. "qtprotobufnamespace.tests.TestService"
+     * \param method Method name, as it's declared in protobuf service
+     * \param deadline Deadline of method calls, zero \a deadline disables deadline
+     */
+    void setMethodDeadline(const QString &service, const QString &method, std::chrono::milliseconds deadline);
+
+    /*!
+     * \brief Makes \a method calls of \a service to use default deadline of channel
+     */
+    void resetMethodDeadline(const QString &service, const QString &method);
+
+    /*!
+     * \brief Returns true if QtGrpc is built with zlib and messages compression is supported
+     * \details Compressed messages received from server are decompressed if compression is supported
+     */
+    static bool isCompressionSupported();
+
+    /*!
+     * \brief Sets compression algorithm of messages sent using channel. Messages are not compressed by default.
+     * \details Server is notified about compression in grpc-encoding header. Messages smaller than
+     *          compressionThreshold() are sent uncompressed.
+     */
+    void setDefaultCompression(CompressionAlgorithm algorithm);
+
+    /*!
+     * \brief Returns compression algorithm of messages sent using channel
+     */
+    CompressionAlgorithm defaultCompression() const;
+
+    /*!
+     * \brief Sets compression algorithm of \a method messages of \a service, that overrides default compression of channel
+     */
+    void setMethodCompression(const QString &service, const QString &method, CompressionAlgorithm algorithm);
+
+    /*!
+     * \brief Makes \a method messages of \a service to use default compression of channel
+     */
+    void resetMethodCompression(const QString &service, const QString &method);
+
+    /*!
+     * \brief Sets minimal size of message in bytes, that is compressed. Default threshold is 1024 bytes.
+     */
+    void setCompressionThreshold(int size);
+
+    /*!
+     * \brief Returns minimal size of message in bytes, that is compressed
+     */
+    int compressionThreshold() const;
+
+    /*!
+     * \brief Selects serializer of messages sent and received using channel. Protobuf serializer is used by default.
+     * \details Serializer is taken from \a plugin loaded by QProtobufSerializerRegistry, or from built-in serializers
+     *          if \a plugin is empty, e.g. "json" serializer may be used with grpc-web gateways. Calls are sent with
+     *          "application/grpc+<id>" content type, protobuf messages are sent with "application/grpc" one.
+     *          Replies of other message format are not deserialized and fail with QGrpcStatus::Internal status.
+     *          Clients take serializer of channel when channel is attached, so serializer is selected before that.
+     * \return false if serializer is not found, serializer of channel is not changed in this case
+     */
+    bool setSerializer(const QString &id, const QString &plugin = QString());
+
+    /*!
+     * \brief Returns identifier of serializer used by channel
+     */
+    QString serializerId() const;
+
+    /*!
+     * \brief Returns content type of calls made using channel
+     */
+    QByteArray contentType() const;
+
+    /*!
+     * \brief Sets number of HTTP/2 connections, that are used by channel. Channel uses single connection by default.
+     * \details Every call is made using connection with least number of active calls. Calls started before
+     *          the method call are finished using their connections. \a count less than 1 is treated as 1.
+     *          Multiple connections help to avoid limit of concurrent streams per connection and head-of-line
+     *          blocking, when lots of streams are active.
+     */
+    void setConnectionCount(int count);
+
+    /*!
+     * \brief Returns number of HTTP/2 connections, that are used by channel
+     */
+    int connectionCount() const;
+
+    /*!
+     * \brief Starts establishing connections of channel ahead of first call
+     * \details DNS lookup, TCP and TLS handshakes and HTTP/2 preface are made by request, that is sent to method
+     *          that doesn't exist, so the first call doesn't wait for them. Connections that have calls in progress
+     *          are not affected. Secure channels keep TLS session tickets received by connections, so reconnects
+     *          resume TLS sessions instead of making full handshakes.
+     */
+    void connectAhead();
+
+    /*!
+     * \brief Enables sharing of HTTP/2 connections with other channels. Sharing is disabled by default.
+     * \details Channels of the same thread, that target the same host and port with equal TLS configuration and
+     *          HTTP/2 settings, make calls using common connections, so they share handshakes and congestion
+     *          windows. Connection is closed when the last channel, that uses it, is destroyed. Idle timeout
+     *          doesn't close shared connection while other channels use it.
+     */
+    void setConnectionSharingEnabled(bool enabled);
+
+    /*!
+     * \brief Returns true if channel shares HTTP/2 connections with other channels
+     */
+    bool isConnectionSharingEnabled() const;
+
+    /*!
+     * \brief Sets interval of connection keepalive. Keepalive is disabled by default.
+     * \details QNetworkAccessManager doesn't provide access to HTTP/2 PING frames, so connection that has active
+     *          calls, but didn't receive data for \a interval, is probed with gRPC request sent using the same
+     *          connection. Calls of connection are aborted with QGrpcStatus::Unavailable status if probe is not
+     *          answered during keepaliveTimeout(). Zero \a interval disables keepalive.
+     */
+    void setKeepaliveInterval(std::chrono::milliseconds interval);
+
+    /*!
+     * \brief Returns interval of connection keepalive
+     */
+    std::chrono::milliseconds keepaliveInterval() const;
+
+    /*!
+     * \brief Sets time, that keepalive probe is waited for. Default timeout is 20 seconds.
+     */
+    void setKeepaliveTimeout(std::chrono::milliseconds timeout);
+
+    /*!
+     * \brief Returns time, that keepalive probe is waited for
+     */
+    std::chrono::milliseconds keepaliveTimeout() const;
+
+    /*!
+     * \brief Sets time, after that connection without active calls is closed. Idle connections are kept open by default.
+     * \details Connection is established again by next call. Zero \a timeout disables closing of idle connections.
+     */
+    void setIdleTimeout(std::chrono::milliseconds timeout);
+
+    /*!
+     * \brief Returns time, after that connection without active calls is closed
+     */
+    std::chrono::milliseconds idleTimeout() const;
+
+    /*!
+     * \brief Sets limit of data in bytes, that is received for every stream but not read by channel yet. Default
+     *        limit is 4 MiB, zero \a size means unlimited buffer.
+     * \details When stream consumer is slow, e.g. its thread is busy, network layer stops reading stream once buffer
+     *          is full. Server is blocked by HTTP/2 flow control then, instead of buffering growing amount of data
+     *          on client. Reading is resumed when received messages are taken by channel. Limit is applied to
+     *          streams started after the call.
+     */
+    void setStreamReadBufferSize(qint64 size);
+
+    /*!
+     * \brief Returns limit of received but not read data of every stream
+     */
+    qint64 streamReadBufferSize() const;
+
+    /*!
+     * \brief Sets HTTP/2 receive window size of every stream in bytes. Zero \a size keeps default of Qt.
+     * \details Large window allows server to send more data without waiting for window updates, that is required
+     *          to utilize links with high bandwidth-delay product. Settings of HTTP/2 flow control are sent when
+     *          connection is established, so connections of channel are reestablished by next calls.
+     *          \note HTTP/2 flow control settings require Qt 5.14 or higher and are ignored otherwise.
+     */
+    void setStreamReceiveWindowSize(int size);
+
+    /*!
+     * \brief Returns HTTP/2 receive window size of every stream
+     */
+    int streamReceiveWindowSize() const;
+
+    /*!
+     * \brief Sets HTTP/2 receive window size of connection in bytes, that is shared by all streams of connection.
+     *        Zero \a size keeps default of Qt.
+     */
+    void setSessionReceiveWindowSize(int size);
+
+    /*!
+     * \brief Returns HTTP/2 receive window size of connection
+     */
+    int sessionReceiveWindowSize() const;
+
+    /*!
+     * \brief Sets maximum size of HTTP/2 frame payload in bytes, that channel accepts. Valid sizes are in range
+     *        [16384, 16777215]. Zero \a size keeps default of Qt.
+     */
+    void setMaxFrameSize(int size);
+
+    /*!
+     * \brief Returns maximum size of HTTP/2 frame payload, that channel accepts
+     */
+    int maxFrameSize() const;
+
+    /*!
+     * \brief Enables auto-tuning of HTTP/2 stream receive window. Auto-tuning is disabled by default.
+     * \details Channel estimates bandwidth-delay product of link from bytes received in round trip time after
+     *          first byte of reply. Window is doubled up to 16 MiB, when estimation exceeds 2/3 of window.
+     *          streamReceiveWindowSize() is used as minimal window size.
+     */
+    void setWindowAutoTuningEnabled(bool enabled);
+
+    /*!
+     * \brief Returns true if auto-tuning of HTTP/2 stream receive window is enabled
+     */
+    bool isWindowAutoTuningEnabled() const;
+
+    /*!
+     * \brief Returns HTTP/2 stream receive window size, that is used for new connections. Zero size means
+     *        default of Qt.
+     */
+    int autoTunedWindowSize() const;
+
+    /*!
+     * \brief Enables dedicated I/O thread of channel. Disabled by default.
+     * \details Network requests, reassembly of gRPC frames, deadlines and keepalive are handled in own thread of
+     *          channel instead of thread, that channel is created in, so network throughput of channel doesn't depend
+     *          on load of that thread, e.g. GUI thread. Stream messages are framed in I/O thread and passed to thread of
+     *          stream through lock-free queue, messages received in between event loop iterations of stream thread
+     *          are delivered in single batch. Results of asynchronous calls are delivered to thread of reply,
+     *          synchronous calls block calling thread without nested event loop. Handlers of callWithHandler() are
+     *          invoked in I/O thread. Connections of channel are created again in I/O thread, so connections are not
+     *          shared with channels of other threads.
+     *          The method is called in thread, that channel is created in, before channel is attached to clients.
+     *          Calls in progress are aborted when I/O thread is disabled.
+     */
+    void setIoThreadEnabled(bool enabled);
+
+    /*!
+     * \brief Returns true if channel makes network I/O in dedicated thread
+     */
+    bool isIoThreadEnabled() const;
 private:
     Q_DISABLE_COPY_MOVE(QGrpcHttp2Channel)
 
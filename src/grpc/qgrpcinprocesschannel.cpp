@@ -0,0 +1,157 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qgrpcinprocesschannel.h"
+
+#include <QHash>
+#include <QPair>
+#include <QPointer>
+#include <QReadWriteLock>
+#include <QTimer>
+
+#include "qgrpcasyncreply.h"
+#include "qgrpcstream.h"
+#include "qprotobufserializerregistry_p.h"
+#include "qtprotobuflogging.h"
+
+using namespace QtProtobuf;
+
+namespace QtProtobuf {
+
+//! \private
+struct QGrpcInProcessChannelPrivate {
+    //! \brief Returns handler of \a method of \a service, returns empty handler if method is not registered
+    QGrpcInProcessChannel::MethodHandler handler(const QString &service, const QString &method) const {
+        QReadLocker locker(&lock);
+        return handlers.value(qMakePair(service, method));
+    }
+
+    QGrpcStatus call(const QString &method, const QString &service, const QByteArray &args, QByteArray &ret) const {
+        QGrpcInProcessChannel::MethodHandler methodHandler = handler(service, method);
+        if (!methodHandler) {
+            qProtoWarning() << "Method" << method << "of service" << service << "is not registered in in-process channel";
+            return {QGrpcStatus::Unimplemented, QString("%1 method of %2 service is not implemented").arg(method).arg(service)};
+        }
+        return methodHandler(args, ret);
+    }
+
+    mutable QReadWriteLock lock;
+    QHash<QPair<QString, QString>, QGrpcInProcessChannel::MethodHandler> handlers;
+};
+
+}
+
+QGrpcInProcessChannel::QGrpcInProcessChannel() : QAbstractGrpcChannel()
+  , dPtr(std::make_unique<QGrpcInProcessChannelPrivate>())
+{
+}
+
+QGrpcInProcessChannel::~QGrpcInProcessChannel()
+{
+}
+
+QGrpcStatus QGrpcInProcessChannel::call(const QString &method, const QString &service, const QByteArray &args, QByteArray &ret)
+{
+    return dPtr->call(method, service, args, ret);
+}
+
+void QGrpcInProcessChannel::call(const QString &method, const QString &service, const QByteArray &args, QGrpcAsyncReply *reply)
+{
+    assert(reply != nullptr);
+    QGrpcInProcessChannelPrivate *d = dPtr.get();
+    QPointer<QGrpcAsyncReply> replyPtr(reply);
+    //Call is handled asynchronously, like call made using network channel. Channel is kept alive by reply.
+    QMetaObject::invokeMethod(reply, [d, replyPtr, method, service, args] {
+        //Reply is aborted before call is handled
+        if (replyPtr.isNull() || replyPtr->future().isFinished()) {
+            return;
+        }
+
+        QByteArray ret;
+        QGrpcStatus status = d->call(method, service, args, ret);
+        if (replyPtr.isNull() || replyPtr->future().isFinished()) {
+            return;
+        }
+
+        replyPtr->setData(ret);
+        if (status.code() == QGrpcStatus::Ok) {
+            replyPtr->finished();
+        } else {
+            replyPtr->error(status);
+        }
+    }, Qt::QueuedConnection);
+}
+
+void QGrpcInProcessChannel::callWithHandler(const QString &method, const QString &service, const QByteArray &args, const CallHandler &handler)
+{
+    QByteArray ret;
+    QGrpcStatus status = dPtr->call(method, service, args, ret);
+    //Result is delivered asynchronously, like result of call made using network channel
+    QTimer::singleShot(0, [handler, status, ret] {
+        handler(status, ret);
+    });
+}
+
+void QGrpcInProcessChannel::subscribe(QGrpcStream *stream, const QString &service, QAbstractGrpcClient *)
+{
+    assert(stream != nullptr);
+    qProtoWarning() << "Server streams are not supported by in-process channel, stream" << stream->method() << "of" << service << "failed";
+    //Error is reported asynchronously, when client is able to handle stream signals
+    QMetaObject::invokeMethod(stream, [stream] {
+        stream->error({QGrpcStatus::StatusCode::Unimplemented, QLatin1String("Server streams are not supported by in-process channel")});
+    }, Qt::QueuedConnection);
+}
+
+std::shared_ptr<QAbstractProtobufSerializer> QGrpcInProcessChannel::serializer() const
+{
+    return QProtobufSerializerRegistry::instance().getSerializer("protobuf");
+}
+
+bool QGrpcInProcessChannel::isThreadSafe() const
+{
+    return true;
+}
+
+void QGrpcInProcessChannel::registerMethod(const QString &service, const QString &method, const MethodHandler &handler)
+{
+    QWriteLocker locker(&dPtr->lock);
+    dPtr->handlers.insert(qMakePair(service, method), handler);
+}
+
+void QGrpcInProcessChannel::registerService(QAbstractGrpcService *service)
+{
+    assert(service != nullptr);
+    for (const QString &method : service->methods()) {
+        registerMethod(service->serviceName(), method, [service, method](const QByteArray &args, QByteArray &ret) {
+            return service->handle(method, args, ret);
+        });
+    }
+}
+
+void QGrpcInProcessChannel::unregisterMethod(const QString &service, const QString &method)
+{
+    QWriteLocker locker(&dPtr->lock);
+    dPtr->handlers.remove(qMakePair(service, method));
+}
@@ -0,0 +1,125 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QGrpcInProcessChannel
+
+#include "qabstractgrpcchannel.h"
+#include "qabstractgrpcclient.h"
+#include "qabstractgrpcservice.h"
+
+#include <functional>
+#include <memory>
+
+namespace QtProtobuf {
+
+struct QGrpcInProcessChannelPrivate;
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcInProcessChannel class passes calls directly to service implementation, that lives in the same process
+ * \details QGrpcInProcessChannel doesn't use any network transport. Serialized arguments of call are passed to handler
+ *          registered for method using registerMethod(), serialized result of handler is returned to client. Handlers
+ *          are invoked in thread, that makes call. Asynchronous calls are handled at next iteration of event loop of
+ *          QGrpcAsyncReply thread. Handlers may be invoked concurrently, if calls are made from different threads.
+ *          Implementation of generated server class could be registered using registerService(). Calls of methods,
+ *          that have no registered handler, fail with QGrpcStatus::Unimplemented status.
+ *          Server and client streams are not supported by channel.
+ *
+ *          \code
+ *          auto channel = std::make_shared<QGrpcInProcessChannel>();
+ *          channel->registerMethod<SimpleStringMessage, SimpleStringMessage>("qtprotobufnamespace.tests.TestService", "testMethod",
+ *              [](const SimpleStringMessage &arg, SimpleStringMessage &ret) {
+ *                  ret.setTestFieldString(arg.testFieldString());
+ *                  return QGrpcStatus{QGrpcStatus::Ok};
+ *              });
+ *          testClient.attachChannel(channel);
+ *          \endcode
+ */
+class Q_GRPC_EXPORT QGrpcInProcessChannel final : public QAbstractGrpcChannel
+{
+public:
+    /*!
+     * \brief Handler of method, that receives serialized argument message \p args and writes serialized result of call to \p ret
+     */
+    using MethodHandler = QAbstractGrpcService::MethodHandler;
+
+    /*!
+     * \brief QGrpcInProcessChannel constructs QGrpcInProcessChannel without registered methods
+     */
+    QGrpcInProcessChannel();
+    ~QGrpcInProcessChannel();
+
+    QGrpcStatus call(const QString &method, const QString &service, const QByteArray &args, QByteArray &ret) override;
+    void call(const QString &method, const QString &service, const QByteArray &args, QtProtobuf::QGrpcAsyncReply *reply) override;
+    void callWithHandler(const QString &method, const QString &service, const QByteArray &args, const CallHandler &handler) override;
+    void subscribe(QGrpcStream *stream, const QString &service, QAbstractGrpcClient *client) override;
+    std::shared_ptr<QAbstractProtobufSerializer> serializer() const override;
+    bool isThreadSafe() const override;
+
+    /*!
+     * \brief Registers \p handler of \p method of \p service. Previously registered handler of method is replaced.
+     *        \note Handler has to be thread-safe, if calls are made from multiple threads.
+     */
+    void registerMethod(const QString &service, const QString &method, const MethodHandler &handler);
+
+    /*!
+     * \brief Registers \p handler of \p method of \p service, that receives deserialized argument message and fills
+     *        returned message. Messages are serialized using serializer() of channel.
+     */
+    template<typename A, typename R>
+    void registerMethod(const QString &service, const QString &method, const std::function<QGrpcStatus(const A &, R &)> &handler) {
+        std::shared_ptr<QAbstractProtobufSerializer> serializer = this->serializer();
+        registerMethod(service, method, [serializer, handler](const QByteArray &args, QByteArray &ret) -> QGrpcStatus {
+            A arg;
+            QGrpcStatus status = QAbstractGrpcClient::deserializeMessage(serializer.get(), arg, args);
+            if (status.code() != QGrpcStatus::Ok) {
+                return status;
+            }
+
+            R result;
+            status = handler(arg, result);
+            if (status.code() == QGrpcStatus::Ok) {
+                ret = result.serialize(serializer.get());
+            }
+            return status;
+        });
+    }
+
+    /*!
+     * \brief Registers all methods of \p service, e.g. implementation of generated server class. Service has to
+     *        outlive channel.
+     */
+    void registerService(QAbstractGrpcService *service);
+
+    /*!
+     * \brief Removes handler of \p method of \p service
+     */
+    void unregisterMethod(const QString &service, const QString &method);
+
+private:
+    Q_DISABLE_COPY_MOVE(QGrpcInProcessChannel)
+
+    std::unique_ptr<QGrpcInProcessChannelPrivate> dPtr;
+};
+}
@@ -0,0 +1,260 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qgrpcmetrics.h"
+
+#include <QHash>
+#include <QMetaEnum>
+#include <QReadWriteLock>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace QtProtobuf;
+
+namespace  {
+const std::array<qint64, QGrpcMethodMetrics::LatencyBucketCount - 1> LatencyBucketBounds = {
+    100, 250, 500,
+    1000, 2500, 5000,
+    10000, 25000, 50000,
+    100000, 250000, 500000,
+    1000000, 2500000, 5000000,
+    10000000
+};
+
+const int StatusCodeCount = 17;
+
+//! \brief Escapes label value according to Prometheus text format
+QByteArray escapeLabel(const QString &value)
+{
+    QByteArray escaped = value.toUtf8();
+    escaped.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    return escaped;
+}
+}
+
+namespace QtProtobuf {
+
+//! \private
+struct QGrpcMetricsPrivate {
+    mutable QReadWriteLock lock;
+    QHash<QPair<QString, QString>, std::shared_ptr<QGrpcMethodMetrics>> methods;
+};
+
+}
+
+QGrpcMethodMetrics::QGrpcMethodMetrics(const QString &service, const QString &method) : m_service(service)
+  , m_method(method)
+{
+    for (auto &bucket : m_latencyBuckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    for (auto &status : m_statuses) {
+        status.store(0, std::memory_order_relaxed);
+    }
+}
+
+void QGrpcMethodMetrics::callStarted(qint64 requestBytes)
+{
+    m_calls.fetch_add(1, std::memory_order_relaxed);
+    m_inFlight.fetch_add(1, std::memory_order_relaxed);
+    m_requestBytes.fetch_add(static_cast<quint64>(std::max<qint64>(requestBytes, 0)), std::memory_order_relaxed);
+}
+
+void QGrpcMethodMetrics::callFinished(QGrpcStatus::StatusCode code, std::chrono::microseconds latency, qint64 responseBytes)
+{
+    m_inFlight.fetch_sub(1, std::memory_order_relaxed);
+    m_responseBytes.fetch_add(static_cast<quint64>(std::max<qint64>(responseBytes, 0)), std::memory_order_relaxed);
+    if (code >= 0 && code < StatusCodeCount) {
+        m_statuses[code].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const qint64 value = std::max<qint64>(latency.count(), 0);
+    m_latencySum.fetch_add(static_cast<quint64>(value), std::memory_order_relaxed);
+    const size_t bucket = std::lower_bound(LatencyBucketBounds.begin(), LatencyBucketBounds.end(), value) - LatencyBucketBounds.begin();
+    m_latencyBuckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void QGrpcMethodMetrics::streamMessageReceived(qint64 bytes)
+{
+    m_streamMessages.fetch_add(1, std::memory_order_relaxed);
+    m_responseBytes.fetch_add(static_cast<quint64>(std::max<qint64>(bytes, 0)), std::memory_order_relaxed);
+}
+
+quint64 QGrpcMethodMetrics::statusCount(QGrpcStatus::StatusCode code) const
+{
+    if (code < 0 || code >= StatusCodeCount) {
+        return 0;
+    }
+    return m_statuses[code].load(std::memory_order_relaxed);
+}
+
+std::vector<quint64> QGrpcMethodMetrics::latencyBuckets() const
+{
+    std::vector<quint64> buckets;
+    buckets.reserve(LatencyBucketCount);
+    for (const auto &bucket : m_latencyBuckets) {
+        buckets.push_back(bucket.load(std::memory_order_relaxed));
+    }
+    return buckets;
+}
+
+std::vector<std::chrono::microseconds> QGrpcMethodMetrics::latencyBucketBounds()
+{
+    std::vector<std::chrono::microseconds> bounds;
+    bounds.reserve(LatencyBucketBounds.size());
+    for (qint64 bound : LatencyBucketBounds) {
+        bounds.push_back(std::chrono::microseconds(bound));
+    }
+    return bounds;
+}
+
+std::chrono::microseconds QGrpcMethodMetrics::latencyPercentile(double percentile) const
+{
+    const std::vector<quint64> buckets = latencyBuckets();
+    quint64 total = 0;
+    for (quint64 count : buckets) {
+        total += count;
+    }
+    if (total == 0) {
+        return std::chrono::microseconds::zero();
+    }
+
+    const double rank = std::ceil(total * std::min(std::max(percentile, 0.0), 100.0) / 100.0);
+    quint64 accumulated = 0;
+    for (size_t i = 0; i < LatencyBucketBounds.size(); i++) {
+        accumulated += buckets[i];
+        if (accumulated >= rank) {
+            return std::chrono::microseconds(LatencyBucketBounds[i]);
+        }
+    }
+    //Percentile is in the last unbounded bucket
+    return std::chrono::microseconds(LatencyBucketBounds.back());
+}
+
+QGrpcMetrics::QGrpcMetrics() : dPtr(std::make_unique<QGrpcMetricsPrivate>())
+{
+}
+
+QGrpcMetrics::~QGrpcMetrics()
+{
+}
+
+QGrpcMethodMetrics *QGrpcMetrics::method(const QString &service, const QString &method)
+{
+    const QPair<QString, QString> key(service, method);
+    {
+        QReadLocker locker(&dPtr->lock);
+        auto it = dPtr->methods.constFind(key);
+        if (it != dPtr->methods.constEnd()) {
+            return it.value().get();
+        }
+    }
+
+    QWriteLocker locker(&dPtr->lock);
+    std::shared_ptr<QGrpcMethodMetrics> &metrics = dPtr->methods[key];
+    //Metrics could be created by other thread while lock was released
+    if (!metrics) {
+        metrics = std::make_shared<QGrpcMethodMetrics>(service, method);
+    }
+    return metrics.get();
+}
+
+QList<QGrpcMethodMetrics *> QGrpcMetrics::methods() const
+{
+    QList<QGrpcMethodMetrics *> result;
+    QReadLocker locker(&dPtr->lock);
+    for (const auto &metrics : dPtr->methods) {
+        result.append(metrics.get());
+    }
+    return result;
+}
+
+QByteArray QGrpcMetrics::toPrometheus() const
+{
+    QList<QGrpcMethodMetrics *> allMethods = methods();
+    std::sort(allMethods.begin(), allMethods.end(), [](const QGrpcMethodMetrics *a, const QGrpcMethodMetrics *b) {
+        return qMakePair(a->service(), a->method()) < qMakePair(b->service(), b->method());
+    });
+
+    auto labels = [](const QGrpcMethodMetrics *metrics) -> QByteArray {
+        return "grpc_service=\"" + escapeLabel(metrics->service()) + "\",grpc_method=\"" + escapeLabel(metrics->method()) + "\"";
+    };
+
+    const QMetaEnum codes = QMetaEnum::fromType<QGrpcStatus::StatusCode>();
+    QByteArray result;
+    result.append("# TYPE qtgrpc_client_started_total counter\n");
+    for (const QGrpcMethodMetrics *metrics : allMethods) {
+        result.append("qtgrpc_client_started_total{" + labels(metrics) + "} " + QByteArray::number(metrics->callCount()) + "\n");
+    }
+
+    result.append("# TYPE qtgrpc_client_handled_total counter\n");
+    for (const QGrpcMethodMetrics *metrics : allMethods) {
+        for (int i = 0; i < codes.keyCount(); i++) {
+            auto code = static_cast<QGrpcStatus::StatusCode>(codes.value(i));
+            const quint64 count = metrics->statusCount(code);
+            if (count > 0) {
+                result.append("qtgrpc_client_handled_total{" + labels(metrics) + ",grpc_code=\"" + codes.key(i) + "\"} "
+                              + QByteArray::number(count) + "\n");
+            }
+        }
+    }
+
+    result.append("# TYPE qtgrpc_client_in_flight gauge\n");
+    for (const QGrpcMethodMetrics *metrics : allMethods) {
+        result.append("qtgrpc_client_in_flight{" + labels(metrics) + "} " + QByteArray::number(metrics->inFlightCount()) + "\n");
+    }
+
+    result.append("# TYPE qtgrpc_client_request_bytes_total counter\n");
+    for (const QGrpcMethodMetrics *metrics : allMethods) {
+        result.append("qtgrpc_client_request_bytes_total{" + labels(metrics) + "} " + QByteArray::number(metrics->requestBytes()) + "\n");
+    }
+
+    result.append("# TYPE qtgrpc_client_response_bytes_total counter\n");
+    for (const QGrpcMethodMetrics *metrics : allMethods) {
+        result.append("qtgrpc_client_response_bytes_total{" + labels(metrics) + "} " + QByteArray::number(metrics->responseBytes()) + "\n");
+    }
+
+    result.append("# TYPE qtgrpc_client_stream_messages_total counter\n");
+    for (const QGrpcMethodMetrics *metrics : allMethods) {
+        result.append("qtgrpc_client_stream_messages_total{" + labels(metrics) + "} " + QByteArray::number(metrics->streamMessageCount()) + "\n");
+    }
+
+    result.append("# TYPE qtgrpc_client_handling_seconds histogram\n");
+    for (const QGrpcMethodMetrics *metrics : allMethods) {
+        const std::vector<quint64> buckets = metrics->latencyBuckets();
+        quint64 accumulated = 0;
+        for (size_t i = 0; i < buckets.size(); i++) {
+            accumulated += buckets[i];
+            const QByteArray bound = i < LatencyBucketBounds.size() ? QByteArray::number(LatencyBucketBounds[i] / 1000000.0) : QByteArray("+Inf");
+            result.append("qtgrpc_client_handling_seconds_bucket{" + labels(metrics) + ",le=\"" + bound + "\"} "
+                          + QByteArray::number(accumulated) + "\n");
+        }
+        result.append("qtgrpc_client_handling_seconds_sum{" + labels(metrics) + "} "
+                      + QByteArray::number(metrics->latencySum().count() / 1000000.0) + "\n");
+        result.append("qtgrpc_client_handling_seconds_count{" + labels(metrics) + "} " + QByteArray::number(accumulated) + "\n");
+    }
+    return result;
+}
@@ -0,0 +1,212 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QGrpcMetrics
+
+#include <QList>
+#include <QPair>
+#include <QString>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "qgrpcstatus.h"
+#include "qtgrpcglobal.h"
+
+namespace QtProtobuf {
+
+struct QGrpcMetricsPrivate;
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcMethodMetrics class contains metrics of calls of single method of service
+ * \details All counters are updated using atomic operations without locks, so metrics may be recorded
+ *          and read from any thread. Latency of calls is recorded to histogram with fixed exponential buckets.
+ *          Latency of streams is time from stream start to its completion.
+ */
+class Q_GRPC_EXPORT QGrpcMethodMetrics final
+{
+public:
+    //! \brief Number of latency histogram buckets, last bucket counts calls slower than the largest bound
+    static constexpr int LatencyBucketCount = 17;
+
+    QGrpcMethodMetrics(const QString &service, const QString &method);
+
+    /*!
+     * \brief Returns full name of service of method
+     */
+    QString service() const {
+        return m_service;
+    }
+
+    /*!
+     * \brief Returns name of method
+     */
+    QString method() const {
+        return m_method;
+    }
+
+    /*!
+     * \brief Records start of call with serialized argument message of \p requestBytes size
+     */
+    void callStarted(qint64 requestBytes);
+
+    /*!
+     * \brief Records completion of call with \p code, that took \p latency and received \p responseBytes
+     */
+    void callFinished(QGrpcStatus::StatusCode code, std::chrono::microseconds latency, qint64 responseBytes);
+
+    /*!
+     * \brief Records message of \p bytes size, that is received by stream
+     */
+    void streamMessageReceived(qint64 bytes);
+
+    /*!
+     * \brief Returns number of started calls
+     */
+    quint64 callCount() const {
+        return m_calls.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Returns number of calls, that are finished with \p code
+     */
+    quint64 statusCount(QGrpcStatus::StatusCode code) const;
+
+    /*!
+     * \brief Returns number of calls, that are started, but not finished yet
+     */
+    qint64 inFlightCount() const {
+        return m_inFlight.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Returns total size of serialized argument messages in bytes
+     */
+    quint64 requestBytes() const {
+        return m_requestBytes.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Returns total size of received messages in bytes
+     */
+    quint64 responseBytes() const {
+        return m_responseBytes.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Returns number of messages received by streams. Rate of messages is counted by sampling this
+     *        value periodically.
+     */
+    quint64 streamMessageCount() const {
+        return m_streamMessages.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Returns number of calls in every latency bucket. Buckets are not cumulative.
+     */
+    std::vector<quint64> latencyBuckets() const;
+
+    /*!
+     * \brief Returns upper bounds of latency buckets, except the last bucket that has no bound
+     */
+    static std::vector<std::chrono::microseconds> latencyBucketBounds();
+
+    /*!
+     * \brief Returns sum of latencies of finished calls
+     */
+    std::chrono::microseconds latencySum() const {
+        return std::chrono::microseconds(m_latencySum.load(std::memory_order_relaxed));
+    }
+
+    /*!
+     * \brief Returns approximate latency \p percentile in range [0, 100], that is upper bound of histogram
+     *        bucket, that contains percentile. Returns zero if no calls are finished.
+     */
+    std::chrono::microseconds latencyPercentile(double percentile) const;
+
+private:
+    Q_DISABLE_COPY_MOVE(QGrpcMethodMetrics)
+
+    const QString m_service;
+    const QString m_method;
+    std::atomic<quint64> m_calls{0};
+    std::atomic<qint64> m_inFlight{0};
+    std::atomic<quint64> m_requestBytes{0};
+    std::atomic<quint64> m_responseBytes{0};
+    std::atomic<quint64> m_streamMessages{0};
+    std::atomic<quint64> m_latencySum{0};
+    std::array<std::atomic<quint64>, LatencyBucketCount> m_latencyBuckets;
+    //Status codes are in range [0, 16]
+    std::array<std::atomic<quint64>, 17> m_statuses;
+};
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcMetrics class collects metrics of calls per method of service
+ * \details Metrics are recorded by QAbstractGrpcClient, that metrics are assigned to using
+ *          QAbstractGrpcClient::setMetrics(). Single QGrpcMetrics may be shared by multiple clients, e.g. all
+ *          clients of channel.
+ *
+ *          \code
+ *          auto metrics = std::make_shared<QGrpcMetrics>();
+ *          testClient.setMetrics(metrics);
+ *          ...
+ *          qDebug() << metrics->method("qtprotobufnamespace.tests.TestService", "testMethod")->latencyPercentile(99).count();
+ *          QByteArray exported = metrics->toPrometheus();
+ *          \endcode
+ */
+class Q_GRPC_EXPORT QGrpcMetrics final
+{
+public:
+    QGrpcMetrics();
+    ~QGrpcMetrics();
+
+    /*!
+     * \brief Returns metrics of \p method of \p service. Metrics are created at first access and are valid
+     *        until QGrpcMetrics is destroyed.
+     */
+    QGrpcMethodMetrics *method(const QString &service, const QString &method);
+
+    /*!
+     * \brief Returns metrics of all methods, that are called
+     */
+    QList<QGrpcMethodMetrics *> methods() const;
+
+    /*!
+     * \brief Exports metrics in Prometheus text exposition format
+     */
+    QByteArray toPrometheus() const;
+
+private:
+    Q_DISABLE_COPY_MOVE(QGrpcMetrics)
+
+    std::unique_ptr<QGrpcMetricsPrivate> dPtr;
+};
+
+}
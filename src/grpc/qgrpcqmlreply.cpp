@@ -0,0 +1,142 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qgrpcqmlreply.h"
+
+#include <QHash>
+#include <QList>
+#include <QJSEngine>
+#include <QQmlEngine>
+#include <QTimer>
+
+namespace QtProtobuf {
+
+//! \private
+//! \brief Pool and delivery queue of replies, replies are used from QML thread only
+struct QGrpcQmlReplyPool {
+    ~QGrpcQmlReplyPool() {
+        for (const auto &replies : unused) {
+            qDeleteAll(replies);
+        }
+    }
+
+    QHash<const QMetaObject *, QList<QGrpcQmlReply *>> unused;
+    QList<QGrpcQmlReply *> finished;
+};
+
+}
+
+using namespace QtProtobuf;
+
+namespace {
+QGrpcQmlReplyPool &replyPool()
+{
+    static QGrpcQmlReplyPool pool;
+    return pool;
+}
+}
+
+QGrpcQmlReply::QGrpcQmlReply(const QMetaObject *type, QObject *result) : QObject()
+  , m_type(type)
+  , m_result(result)
+  , m_active(false)
+{
+    m_result->setParent(this);
+    QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
+    QQmlEngine::setObjectOwnership(m_result, QQmlEngine::CppOwnership);
+}
+
+QGrpcQmlReply::~QGrpcQmlReply() = default;
+
+QGrpcQmlReply *QGrpcQmlReply::acquire(const QMetaObject *type, QObject *(*createResult)())
+{
+    QGrpcQmlReply *reply = nullptr;
+    QList<QGrpcQmlReply *> &unused = replyPool().unused[type];
+    if (unused.isEmpty()) {
+        reply = new QGrpcQmlReply(type, createResult());
+    } else {
+        reply = unused.takeLast();
+    }
+    reply->m_active = true;
+    return reply;
+}
+
+void QGrpcQmlReply::then(const QJSValue &callback, const QJSValue &errorCallback)
+{
+    m_callback = callback;
+    m_errorCallback = errorCallback;
+}
+
+void QGrpcQmlReply::finish(const QGrpcStatus &status)
+{
+    //Reply might receive both error and finished notifications, only first one is delivered
+    if (!m_active) {
+        return;
+    }
+
+    m_active = false;
+    m_status = status;
+    QList<QGrpcQmlReply *> &finished = replyPool().finished;
+    if (finished.isEmpty()) {
+        QTimer::singleShot(0, &QGrpcQmlReply::deliverFinished);
+    }
+    finished.append(this);
+}
+
+void QGrpcQmlReply::deliverFinished()
+{
+    const QList<QGrpcQmlReply *> finished = replyPool().finished;
+    replyPool().finished.clear();
+    for (QGrpcQmlReply *reply : finished) {
+        reply->deliver();
+        reply->release();
+    }
+}
+
+void QGrpcQmlReply::deliver()
+{
+    const bool ok = m_status.code() == QGrpcStatus::Ok;
+    QJSValue callback = ok ? m_callback : m_errorCallback;
+    QJSEngine *engine = qjsEngine(this);
+    if (!callback.isCallable() || engine == nullptr) {
+        return;
+    }
+
+    callback.call(QJSValueList{ok ? engine->toScriptValue(m_result) : engine->toScriptValue(m_status)});
+}
+
+void QGrpcQmlReply::release()
+{
+    m_callback = QJSValue();
+    m_errorCallback = QJSValue();
+    m_status = QGrpcStatus();
+
+    QList<QGrpcQmlReply *> &unused = replyPool().unused[m_type];
+    if (unused.count() >= MaxPooledReplies) {
+        deleteLater();
+        return;
+    }
+    unused.append(this);
+}
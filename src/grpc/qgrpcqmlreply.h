@@ -0,0 +1,103 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QGrpcQmlReply
+
+#include <QObject>
+#include <QJSValue>
+
+#include "qgrpcstatus.h"
+#include "qtgrpcglobal.h"
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcQmlReply class is promise-like reply of unary calls made from QML
+ *
+ * \details Reply objects and result messages are taken from pool of result type and returned back once result is
+ *          delivered, so frequent calls don't allocate new objects and don't produce garbage for JS engine. Results
+ *          of calls finished within one event loop iteration are delivered together.
+ *          \code
+ *          TestServiceClient.testMethodReply(request).then(function(result) {
+ *              label.text = result.testFieldString
+ *          }, function(status) {
+ *              console.log("Call failed: " + status.message)
+ *          })
+ *          \endcode
+ * \note Reply and result are reused once callbacks return. Copy required data from result inside callback and
+ *       don't keep references to reply or result.
+ */
+class Q_GRPC_EXPORT QGrpcQmlReply final : public QObject
+{
+    Q_OBJECT
+public:
+    enum {
+        MaxPooledReplies = 32 //!< Maximum number of unused replies kept in pool of each result type
+    };
+
+    /*!
+     * \brief Sets \a callback called with received message and \a errorCallback called with QGrpcStatus if call failed
+     */
+    Q_INVOKABLE void then(const QJSValue &callback, const QJSValue &errorCallback = QJSValue());
+
+    //! \private
+    //! \brief Takes reply with result of type \p T from pool
+    template<typename T>
+    static QGrpcQmlReply *acquire() {
+        return acquire(&T::staticMetaObject, []() -> QObject * { return new T; });
+    }
+
+    //! \private
+    template<typename T>
+    T *result() const {
+        return static_cast<T *>(m_result);
+    }
+
+    //! \private
+    //! \brief Schedules delivery of call result with \p status
+    void finish(const QGrpcStatus &status);
+
+private:
+    QGrpcQmlReply(const QMetaObject *type, QObject *result);
+    ~QGrpcQmlReply();
+    Q_DISABLE_COPY_MOVE(QGrpcQmlReply)
+
+    static QGrpcQmlReply *acquire(const QMetaObject *type, QObject *(*createResult)());
+    static void deliverFinished();
+    void deliver();
+    void release();
+
+    friend struct QGrpcQmlReplyPool;
+
+    const QMetaObject *m_type;
+    QObject *m_result;
+    QJSValue m_callback;
+    QJSValue m_errorCallback;
+    QGrpcStatus m_status;
+    bool m_active;
+};
+
+}
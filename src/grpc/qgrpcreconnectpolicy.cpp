@@ -0,0 +1,101 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qgrpcreconnectpolicy.h"
+
+#include <QRandomGenerator>
+
+#include <algorithm>
+#include <cmath>
+
+namespace QtProtobuf {
+
+//! \private
+struct QGrpcReconnectPolicyPrivate {
+    QGrpcReconnectPolicyPrivate(std::chrono::milliseconds _initialBackoff, std::chrono::milliseconds _maxBackoff,
+                                double _multiplier, double _jitter, int _maxAttempts) : initialBackoff(_initialBackoff)
+      , maxBackoff(_maxBackoff)
+      , multiplier(_multiplier)
+      , jitter(std::min(std::max(_jitter, 0.0), 1.0))
+      , maxAttempts(_maxAttempts)
+    {}
+
+    std::chrono::milliseconds initialBackoff;
+    std::chrono::milliseconds maxBackoff;
+    double multiplier;
+    double jitter;
+    int maxAttempts;
+};
+
+}
+
+using namespace QtProtobuf;
+
+QGrpcReconnectPolicy::QGrpcReconnectPolicy(std::chrono::milliseconds initialBackoff, std::chrono::milliseconds maxBackoff,
+                                           double multiplier, double jitter, int maxAttempts) :
+    dPtr(std::make_unique<QGrpcReconnectPolicyPrivate>(initialBackoff, maxBackoff, multiplier, jitter, maxAttempts))
+{
+}
+
+QGrpcReconnectPolicy::~QGrpcReconnectPolicy() = default;
+
+bool QGrpcReconnectPolicy::reconnectDelay(int attempt, const QGrpcStatus &, std::chrono::milliseconds &delay) const
+{
+    if (dPtr->maxAttempts > 0 && attempt > dPtr->maxAttempts) {
+        return false;
+    }
+
+    double backoff = dPtr->initialBackoff.count() * std::pow(dPtr->multiplier, std::max(attempt - 1, 0));
+    backoff = std::min(backoff, static_cast<double>(dPtr->maxBackoff.count()));
+    //Random factor is in range [1 - jitter, 1 + jitter]
+    backoff *= 1.0 + dPtr->jitter * (2.0 * QRandomGenerator::global()->generateDouble() - 1.0);
+    delay = std::chrono::milliseconds(static_cast<std::chrono::milliseconds::rep>(std::max(backoff, 0.0)));
+    return true;
+}
+
+std::chrono::milliseconds QGrpcReconnectPolicy::initialBackoff() const
+{
+    return dPtr->initialBackoff;
+}
+
+std::chrono::milliseconds QGrpcReconnectPolicy::maxBackoff() const
+{
+    return dPtr->maxBackoff;
+}
+
+double QGrpcReconnectPolicy::multiplier() const
+{
+    return dPtr->multiplier;
+}
+
+double QGrpcReconnectPolicy::jitter() const
+{
+    return dPtr->jitter;
+}
+
+int QGrpcReconnectPolicy::maxAttempts() const
+{
+    return dPtr->maxAttempts;
+}
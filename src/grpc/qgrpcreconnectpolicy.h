@@ -0,0 +1,106 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QGrpcReconnectPolicy
+
+#include <chrono>
+#include <memory>
+
+#include "qgrpcstatus.h"
+#include "qtgrpcglobal.h"
+
+namespace QtProtobuf {
+
+struct QGrpcReconnectPolicyPrivate;
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcReconnectPolicy class defines when and how often failed server streams are restored
+ * \details Default policy implements exponential backoff: delay before \a attempt reconnection is
+ *          initialBackoff() * multiplier()^(attempt - 1), but not more than maxBackoff(). Delay is randomized
+ *          by jitter() part of it, so clients that lost connection at the same time don't reconnect in lockstep.
+ *          Stream is not restored after maxAttempts() failed reconnections in a row. Counter of attempts is reset
+ *          when stream receives message from server.
+ *          Inherit QGrpcReconnectPolicy and override reconnectDelay() to implement custom policy.
+ *          Policy is set for channel using QAbstractGrpcChannel::setReconnectPolicy() and may be overridden for
+ *          particular stream using QGrpcStream::setReconnectPolicy().
+ */
+class Q_GRPC_EXPORT QGrpcReconnectPolicy
+{
+public:
+    /*!
+     * \brief Constructs reconnect policy
+     * \param initialBackoff delay before first reconnection
+     * \param maxBackoff upper limit of delay before reconnection
+     * \param multiplier factor the delay is multiplied with after every failed reconnection
+     * \param jitter part of delay that delay is randomly increased or decreased by, in range [0, 1]
+     * \param maxAttempts number of reconnections in a row, zero means unlimited number
+     */
+    QGrpcReconnectPolicy(std::chrono::milliseconds initialBackoff = std::chrono::milliseconds(1000),
+                         std::chrono::milliseconds maxBackoff = std::chrono::milliseconds(120000),
+                         double multiplier = 1.6, double jitter = 0.2, int maxAttempts = 0);
+    virtual ~QGrpcReconnectPolicy();
+
+    /*!
+     * \brief Decides if stream failed with \a status is restored and calculates \a delay before reconnection
+     * \param attempt number of reconnection in a row, starts from 1
+     * \param status status that stream failed with
+     * \param delay delay before reconnection
+     * \return false if stream shouldn't be restored
+     */
+    virtual bool reconnectDelay(int attempt, const QGrpcStatus &status, std::chrono::milliseconds &delay) const;
+
+    /*!
+     * \brief Returns delay before first reconnection
+     */
+    std::chrono::milliseconds initialBackoff() const;
+
+    /*!
+     * \brief Returns upper limit of delay before reconnection
+     */
+    std::chrono::milliseconds maxBackoff() const;
+
+    /*!
+     * \brief Returns factor the delay is multiplied with after every failed reconnection
+     */
+    double multiplier() const;
+
+    /*!
+     * \brief Returns part of delay that delay is randomly increased or decreased by
+     */
+    double jitter() const;
+
+    /*!
+     * \brief Returns number of reconnections in a row, zero means unlimited number
+     */
+    int maxAttempts() const;
+
+private:
+    Q_DISABLE_COPY_MOVE(QGrpcReconnectPolicy)
+
+    std::unique_ptr<QGrpcReconnectPolicyPrivate> dPtr;
+};
+
+}
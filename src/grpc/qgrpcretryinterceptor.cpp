@@ -0,0 +1,251 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qgrpcretryinterceptor.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QThread>
+#include <QTimer>
+
+#include "qgrpcmetrics.h"
+#include "qtprotobuflogging.h"
+
+namespace QtProtobuf {
+
+//! \private
+struct QGrpcRetryInterceptorPrivate {
+    QGrpcRetryInterceptorPrivate(const std::shared_ptr<QGrpcRetryBudget> &_budget) : budget(_budget ? _budget : std::make_shared<QGrpcRetryBudget>())
+      , metrics(std::make_shared<QGrpcMetrics>())
+    {}
+
+    const std::shared_ptr<QGrpcRetryBudget> budget;
+    const std::shared_ptr<QGrpcMetrics> metrics;
+    mutable QMutex mutex;
+    QHash<QPair<QString, QString>, std::shared_ptr<QGrpcRetryPolicy>> policies;
+    std::shared_ptr<QGrpcRetryPolicy> defaultPolicy;
+};
+
+//! \private
+//! \brief State of single call, shared by all its attempts
+struct QGrpcRetriedCall {
+    std::shared_ptr<QGrpcRetryPolicy> policy;
+    std::shared_ptr<QGrpcRetryBudget> budget;
+    //Shares ownership of metrics collection of interceptor, that may be destroyed while call is pending
+    std::shared_ptr<QGrpcMethodMetrics> metrics;
+    QByteArray arg;
+    QGrpcCallOptions options;
+    QGrpcClientInterceptor::ResponseHandler handler;
+    QGrpcClientInterceptor::Next next;
+    int attempts = 0;
+    int pending = 0;
+    bool completed = false;
+    //Set if the first attempt is completed before next returns, e.g. for synchronous calls
+    bool synchronous = false;
+    bool dispatching = false;
+
+    void complete(const QGrpcStatus &status, const QByteArray &data, const QGrpcMetadata &metadata) {
+        completed = true;
+        //Handler and continuation may hold the call, so cycle is broken here
+        QGrpcClientInterceptor::ResponseHandler callHandler = std::move(handler);
+        next = nullptr;
+        callHandler(status, data, metadata);
+    }
+};
+
+}
+
+using namespace QtProtobuf;
+
+namespace {
+
+void startAttempt(const std::shared_ptr<QGrpcRetriedCall> &call);
+
+void handleAttempt(const std::shared_ptr<QGrpcRetriedCall> &call, const QGrpcStatus &status, const QByteArray &data, const QGrpcMetadata &metadata)
+{
+    if (call->completed) {
+        return;
+    }
+
+    if (status.code() == QGrpcStatus::Ok) {
+        call->budget->recordSuccess();
+        call->complete(status, data, metadata);
+        return;
+    }
+
+    if (!call->policy->isRetryable(status.code())) {
+        call->complete(status, data, metadata);
+        return;
+    }
+
+    call->budget->recordFailure();
+    //Hedged attempts are still pending, the last of them reports failure
+    if (call->pending > 0) {
+        return;
+    }
+
+    std::chrono::milliseconds delay(0);
+    if (!call->policy->retryDelay(call->attempts, status, delay) || !call->budget->isRetryAllowed()) {
+        call->complete(status, data, metadata);
+        return;
+    }
+
+    qProtoDebug() << "Attempt" << call->attempts << "failed with" << status.code() << "retry in" << delay.count() << "ms";
+    if (call->synchronous) {
+        QThread::msleep(static_cast<unsigned long>(delay.count()));
+        startAttempt(call);
+    } else {
+        QTimer::singleShot(static_cast<int>(delay.count()), [call] {
+            if (!call->completed && call->pending == 0) {
+                startAttempt(call);
+            }
+        });
+    }
+}
+
+std::chrono::milliseconds hedgingDelay(const QGrpcRetriedCall &call)
+{
+    std::chrono::milliseconds delay = call.policy->hedgingDelay();
+    if (delay.count() == 0) {
+        //Hedging doesn't start until latencies of method are known
+        delay = std::chrono::duration_cast<std::chrono::milliseconds>(call.metrics->latencyPercentile(call.policy->hedgingPercentile())
+                                                                      + std::chrono::microseconds(999));
+    }
+    return delay;
+}
+
+void scheduleHedging(const std::shared_ptr<QGrpcRetriedCall> &call)
+{
+    if (!call->policy->isHedgingEnabled() || call->attempts >= call->policy->maxAttempts()) {
+        return;
+    }
+
+    const std::chrono::milliseconds delay = hedgingDelay(*call);
+    if (delay.count() == 0) {
+        return;
+    }
+
+    QTimer::singleShot(static_cast<int>(delay.count()), [call] {
+        if (call->completed || call->pending == 0 || call->attempts >= call->policy->maxAttempts()
+                || !call->budget->isRetryAllowed()) {
+            return;
+        }
+        qProtoDebug() << "Hedged attempt" << call->attempts + 1 << "is sent";
+        startAttempt(call);
+    });
+}
+
+void startAttempt(const std::shared_ptr<QGrpcRetriedCall> &call)
+{
+    ++call->attempts;
+    ++call->pending;
+    const std::shared_ptr<QGrpcMethodMetrics> metrics = call->metrics;
+    metrics->callStarted(call->arg.size());
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool first = call->attempts == 1;
+    call->dispatching = first;
+    //Continuation is released once call is completed, that may happen while it's still running
+    const QGrpcClientInterceptor::Next next = call->next;
+    next(call->arg, call->options, [call, metrics, timer, first](const QGrpcStatus &status, const QByteArray &data, const QGrpcMetadata &metadata) {
+        --call->pending;
+        metrics->callFinished(status.code(), std::chrono::microseconds(timer.nsecsElapsed() / 1000), data.size());
+        if (first && call->dispatching) {
+            call->synchronous = true;
+        }
+        handleAttempt(call, status, data, metadata);
+    });
+    if (first) {
+        call->dispatching = false;
+    }
+
+    if (!call->completed && !call->synchronous && call->pending > 0) {
+        scheduleHedging(call);
+    }
+}
+
+}
+
+QGrpcRetryInterceptor::QGrpcRetryInterceptor(const std::shared_ptr<QGrpcRetryBudget> &budget) :
+    dPtr(std::make_unique<QGrpcRetryInterceptorPrivate>(budget))
+{
+}
+
+QGrpcRetryInterceptor::~QGrpcRetryInterceptor() = default;
+
+void QGrpcRetryInterceptor::setRetryPolicy(const QString &service, const QString &method, const std::shared_ptr<QGrpcRetryPolicy> &policy)
+{
+    QMutexLocker locker(&dPtr->mutex);
+    if (policy) {
+        dPtr->policies.insert(qMakePair(service, method), policy);
+    } else {
+        dPtr->policies.remove(qMakePair(service, method));
+    }
+}
+
+void QGrpcRetryInterceptor::setDefaultRetryPolicy(const std::shared_ptr<QGrpcRetryPolicy> &policy)
+{
+    QMutexLocker locker(&dPtr->mutex);
+    dPtr->defaultPolicy = policy;
+}
+
+std::shared_ptr<QGrpcRetryPolicy> QGrpcRetryInterceptor::retryPolicy(const QString &service, const QString &method) const
+{
+    QMutexLocker locker(&dPtr->mutex);
+    return dPtr->policies.value(qMakePair(service, method), dPtr->defaultPolicy);
+}
+
+std::shared_ptr<QGrpcRetryBudget> QGrpcRetryInterceptor::budget() const
+{
+    return dPtr->budget;
+}
+
+std::shared_ptr<QGrpcMetrics> QGrpcRetryInterceptor::metrics() const
+{
+    return dPtr->metrics;
+}
+
+void QGrpcRetryInterceptor::interceptCall(const QString &service, const QString &method, const QByteArray &arg,
+                                          const QGrpcCallOptions &options, const ResponseHandler &handler, const Next &next)
+{
+    std::shared_ptr<QGrpcRetryPolicy> policy = retryPolicy(service, method);
+    if (!policy) {
+        next(arg, options, handler);
+        return;
+    }
+
+    auto call = std::make_shared<QGrpcRetriedCall>();
+    call->policy = policy;
+    call->budget = dPtr->budget;
+    call->metrics = std::shared_ptr<QGrpcMethodMetrics>(dPtr->metrics, dPtr->metrics->method(service, method));
+    call->arg = arg;
+    call->options = options;
+    call->handler = handler;
+    call->next = next;
+    startAttempt(call);
+}
@@ -0,0 +1,102 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QGrpcRetryInterceptor
+
+#include <QString>
+
+#include <memory>
+
+#include "qgrpcclientinterceptor.h"
+#include "qgrpcretrypolicy.h"
+#include "qtgrpcglobal.h"
+
+namespace QtProtobuf {
+
+class QGrpcMetrics;
+struct QGrpcRetryInterceptorPrivate;
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcRetryInterceptor class retries and hedges unary calls according to QGrpcRetryPolicy
+ * \details Retry policy is set per method or as default policy for all methods, calls of methods without policy
+ *          are passed as is. All retries and hedged attempts are limited by QGrpcRetryBudget shared by methods.
+ *          Response of the first successful attempt, or the first attempt failed with not retryable status is
+ *          passed to caller, attempts that are still pending are cancelled.
+ *          \code{.cpp}
+ *          auto retry = std::make_shared<QtProtobuf::QGrpcRetryInterceptor>();
+ *          auto policy = std::make_shared<QtProtobuf::QGrpcRetryPolicy>(3);
+ *          policy->setHedgingEnabled(true);
+ *          retry->setRetryPolicy("qtprotobufnamespace.tests.TestService", "testMethod", policy);
+ *          testClient.addInterceptor(retry);
+ *          \endcode
+ *          Synchronous calls, and calls which first attempt is completed before interceptor returns, are retried
+ *          with blocking delays in calling thread and are never hedged. Other calls are retried using timers, so
+ *          calling thread has to run event loop.
+ */
+class Q_GRPC_EXPORT QGrpcRetryInterceptor : public QGrpcClientInterceptor
+{
+public:
+    /*!
+     * \brief Constructs interceptor, that limits retries with \a budget
+     */
+    QGrpcRetryInterceptor(const std::shared_ptr<QGrpcRetryBudget> &budget = std::make_shared<QGrpcRetryBudget>());
+    ~QGrpcRetryInterceptor() override;
+
+    /*!
+     * \brief Sets retry \a policy of calls of \a method of \a service. nullptr removes policy of method.
+     */
+    void setRetryPolicy(const QString &service, const QString &method, const std::shared_ptr<QGrpcRetryPolicy> &policy);
+
+    /*!
+     * \brief Sets retry \a policy of methods, that have no own policy. nullptr disables retries of such methods.
+     */
+    void setDefaultRetryPolicy(const std::shared_ptr<QGrpcRetryPolicy> &policy);
+
+    /*!
+     * \brief Returns retry policy applied to calls of \a method of \a service, or nullptr if calls aren't retried
+     */
+    std::shared_ptr<QGrpcRetryPolicy> retryPolicy(const QString &service, const QString &method) const;
+
+    /*!
+     * \brief Returns budget that limits retries and hedged attempts
+     */
+    std::shared_ptr<QGrpcRetryBudget> budget() const;
+
+    /*!
+     * \brief Returns latencies of attempts per method, that are used to estimate hedging delays
+     */
+    std::shared_ptr<QGrpcMetrics> metrics() const;
+
+    void interceptCall(const QString &service, const QString &method, const QByteArray &arg,
+                       const QGrpcCallOptions &options, const ResponseHandler &handler, const Next &next) override;
+
+private:
+    Q_DISABLE_COPY_MOVE(QGrpcRetryInterceptor)
+
+    std::unique_ptr<QGrpcRetryInterceptorPrivate> dPtr;
+};
+
+}
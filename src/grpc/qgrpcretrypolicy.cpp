@@ -0,0 +1,142 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qgrpcretrypolicy.h"
+
+#include "qgrpcreconnectpolicy.h"
+
+#include <algorithm>
+
+namespace QtProtobuf {
+
+//! \private
+struct QGrpcRetryPolicyPrivate {
+    QGrpcRetryPolicyPrivate(int _maxAttempts, const QList<QGrpcStatus::StatusCode> &_retryableCodes,
+                            std::chrono::milliseconds initialBackoff, std::chrono::milliseconds maxBackoff,
+                            double multiplier, double jitter) : maxAttempts(std::max(_maxAttempts, 1))
+      , retryableCodes(_retryableCodes)
+      , backoff(initialBackoff, maxBackoff, multiplier, jitter)
+    {}
+
+    const int maxAttempts;
+    const QList<QGrpcStatus::StatusCode> retryableCodes;
+    //Delays of retries are calculated the same way as delays of stream reconnections
+    const QGrpcReconnectPolicy backoff;
+    bool hedgingEnabled = false;
+    std::chrono::milliseconds hedgingDelay{0};
+    double hedgingPercentile = 95.0;
+};
+
+}
+
+using namespace QtProtobuf;
+
+QGrpcRetryPolicy::QGrpcRetryPolicy(int maxAttempts, const QList<QGrpcStatus::StatusCode> &retryableCodes,
+                                   std::chrono::milliseconds initialBackoff, std::chrono::milliseconds maxBackoff,
+                                   double multiplier, double jitter) :
+    dPtr(std::make_unique<QGrpcRetryPolicyPrivate>(maxAttempts, retryableCodes, initialBackoff, maxBackoff, multiplier, jitter))
+{
+}
+
+QGrpcRetryPolicy::~QGrpcRetryPolicy() = default;
+
+bool QGrpcRetryPolicy::retryDelay(int attempt, const QGrpcStatus &status, std::chrono::milliseconds &delay) const
+{
+    if (attempt >= dPtr->maxAttempts || !isRetryable(status.code())) {
+        return false;
+    }
+    return dPtr->backoff.reconnectDelay(attempt, status, delay);
+}
+
+bool QGrpcRetryPolicy::isRetryable(QGrpcStatus::StatusCode code) const
+{
+    return dPtr->retryableCodes.contains(code);
+}
+
+int QGrpcRetryPolicy::maxAttempts() const
+{
+    return dPtr->maxAttempts;
+}
+
+QList<QGrpcStatus::StatusCode> QGrpcRetryPolicy::retryableCodes() const
+{
+    return dPtr->retryableCodes;
+}
+
+void QGrpcRetryPolicy::setHedgingEnabled(bool enabled, std::chrono::milliseconds delay)
+{
+    dPtr->hedgingEnabled = enabled;
+    dPtr->hedgingDelay = std::max(delay, std::chrono::milliseconds(0));
+}
+
+bool QGrpcRetryPolicy::isHedgingEnabled() const
+{
+    return dPtr->hedgingEnabled;
+}
+
+std::chrono::milliseconds QGrpcRetryPolicy::hedgingDelay() const
+{
+    return dPtr->hedgingDelay;
+}
+
+void QGrpcRetryPolicy::setHedgingPercentile(double percentile)
+{
+    dPtr->hedgingPercentile = std::min(std::max(percentile, 1.0), 99.9);
+}
+
+double QGrpcRetryPolicy::hedgingPercentile() const
+{
+    return dPtr->hedgingPercentile;
+}
+
+QGrpcRetryBudget::QGrpcRetryBudget(double maxTokens, double tokenRatio) : m_maxTokens(std::max(maxTokens, 1.0))
+  , m_tokenRatio(std::max(tokenRatio, 0.0))
+  , m_tokens(m_maxTokens)
+{
+}
+
+bool QGrpcRetryBudget::isRetryAllowed() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_tokens > m_maxTokens / 2.0;
+}
+
+void QGrpcRetryBudget::recordSuccess()
+{
+    QMutexLocker locker(&m_mutex);
+    m_tokens = std::min(m_tokens + m_tokenRatio, m_maxTokens);
+}
+
+void QGrpcRetryBudget::recordFailure()
+{
+    QMutexLocker locker(&m_mutex);
+    m_tokens = std::max(m_tokens - 1.0, 0.0);
+}
+
+double QGrpcRetryBudget::tokens() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_tokens;
+}
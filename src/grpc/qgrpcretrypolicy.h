@@ -0,0 +1,189 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QGrpcRetryPolicy
+
+#include <QList>
+#include <QMutex>
+
+#include <chrono>
+#include <memory>
+
+#include "qgrpcstatus.h"
+#include "qtgrpcglobal.h"
+
+namespace QtProtobuf {
+
+struct QGrpcRetryPolicyPrivate;
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcRetryPolicy class describes retries and hedging of unary calls
+ * \details Failed attempt of call is retried, if it's failed with one of retryable status codes and number of attempts
+ *          doesn't exceed maxAttempts(). Delay before retry grows exponentially, like delay before reconnection of
+ *          stream in QGrpcReconnectPolicy.
+ *
+ *          If hedging is enabled, next attempt is sent while previous one is still pending, once hedging delay
+ *          elapsed. The first successful response is taken and pending attempts are cancelled. Hedging delay is
+ *          either fixed, or is estimated as percentile of latencies of method observed so far.
+ *          Retry policy is applied by QGrpcRetryInterceptor. Use it only for idempotent methods.
+ */
+class Q_GRPC_EXPORT QGrpcRetryPolicy
+{
+public:
+    /*!
+     * \brief Constructs retry policy
+     * \param maxAttempts number of attempts including the first one
+     * \param retryableCodes status codes, which failed attempts are retried
+     * \param initialBackoff delay before first retry
+     * \param maxBackoff upper limit of delay before retry
+     * \param multiplier factor the delay is multiplied with after every failed attempt
+     * \param jitter part of delay that delay is randomly increased or decreased by, in range [0, 1]
+     */
+    QGrpcRetryPolicy(int maxAttempts = 3,
+                     const QList<QGrpcStatus::StatusCode> &retryableCodes = {QGrpcStatus::Unavailable},
+                     std::chrono::milliseconds initialBackoff = std::chrono::milliseconds(100),
+                     std::chrono::milliseconds maxBackoff = std::chrono::milliseconds(1000),
+                     double multiplier = 2.0, double jitter = 0.2);
+    virtual ~QGrpcRetryPolicy();
+
+    /*!
+     * \brief Decides if attempt failed with \a status is retried and calculates \a delay before retry
+     * \param attempt number of failed attempt, starts from 1
+     * \param status status that attempt failed with
+     * \param delay delay before retry
+     * \return false if call shouldn't be retried
+     */
+    virtual bool retryDelay(int attempt, const QGrpcStatus &status, std::chrono::milliseconds &delay) const;
+
+    /*!
+     * \brief Returns true if attempt failed with \a code may be retried
+     */
+    bool isRetryable(QGrpcStatus::StatusCode code) const;
+
+    /*!
+     * \brief Returns number of attempts including the first one
+     */
+    int maxAttempts() const;
+
+    /*!
+     * \brief Returns status codes, which failed attempts are retried
+     */
+    QList<QGrpcStatus::StatusCode> retryableCodes() const;
+
+    /*!
+     * \brief Enables hedging of calls. Disabled by default.
+     * \param delay delay after previous attempt, when next attempt is sent. Zero delay means that delay is
+     *        estimated as hedgingPercentile() of latencies of method.
+     */
+    void setHedgingEnabled(bool enabled, std::chrono::milliseconds delay = std::chrono::milliseconds(0));
+
+    /*!
+     * \brief Returns true if hedging is enabled
+     */
+    bool isHedgingEnabled() const;
+
+    /*!
+     * \brief Returns fixed hedging delay, zero if delay is estimated from latencies of method
+     */
+    std::chrono::milliseconds hedgingDelay() const;
+
+    /*!
+     * \brief Sets percentile in range (0, 100) of latencies of method, that is used as estimated hedging delay.
+     *        Default percentile is 95.
+     */
+    void setHedgingPercentile(double percentile);
+
+    /*!
+     * \brief Returns percentile of latencies of method, that is used as estimated hedging delay
+     */
+    double hedgingPercentile() const;
+
+private:
+    Q_DISABLE_COPY_MOVE(QGrpcRetryPolicy)
+
+    std::unique_ptr<QGrpcRetryPolicyPrivate> dPtr;
+};
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcRetryBudget class limits retries and hedged attempts, to prevent retry storms
+ * \details Budget is token bucket, that is filled by successful calls and drained by failed attempts, like
+ *          retry throttling of gRPC. Every failed attempt takes one token, every successful call returns
+ *          tokenRatio() tokens. Retries and hedged attempts are allowed while number of tokens is above half of
+ *          maxTokens(). Budget may be shared by several methods and clients and is thread-safe.
+ */
+class Q_GRPC_EXPORT QGrpcRetryBudget final
+{
+public:
+    /*!
+     * \brief Constructs full budget of \a maxTokens, successful calls return \a tokenRatio tokens
+     */
+    QGrpcRetryBudget(double maxTokens = 10.0, double tokenRatio = 0.1);
+
+    /*!
+     * \brief Returns true if retry or hedged attempt may be sent
+     */
+    bool isRetryAllowed() const;
+
+    /*!
+     * \brief Records successful call
+     */
+    void recordSuccess();
+
+    /*!
+     * \brief Records failed attempt, that status is retryable
+     */
+    void recordFailure();
+
+    /*!
+     * \brief Returns current number of tokens
+     */
+    double tokens() const;
+
+    /*!
+     * \brief Returns maximum number of tokens
+     */
+    double maxTokens() const {
+        return m_maxTokens;
+    }
+
+    /*!
+     * \brief Returns number of tokens, that are returned by successful call
+     */
+    double tokenRatio() const {
+        return m_tokenRatio;
+    }
+
+private:
+    Q_DISABLE_COPY_MOVE(QGrpcRetryBudget)
+
+    const double m_maxTokens;
+    const double m_tokenRatio;
+    mutable QMutex m_mutex;
+    double m_tokens;
+};
+
+}
@@ -0,0 +1,237 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qgrpcserver.h"
+#include "qgrpcchannel_p.h"
+
+#include <QHash>
+#include <QThread>
+
+#include <algorithm>
+
+#include <grpcpp/generic/async_generic_service.h>
+#include <grpcpp/impl/codegen/server_context.h>
+#include <grpcpp/server.h>
+#include <grpcpp/server_builder.h>
+
+#include "qabstractgrpcservice.h"
+#include "qtprotobuflogging.h"
+
+using namespace QtProtobuf;
+
+namespace QtProtobuf {
+
+//! \private
+struct QGrpcServerPrivate {
+    //! \brief Invokes method of service, which full name is \a name in "/service/method" form
+    QGrpcStatus handle(const std::string &name, const QByteArray &args, QByteArray &ret) const {
+        QString fullName = QString::fromStdString(name);
+        int separator = fullName.lastIndexOf('/');
+        QString service = fullName.mid(1, separator - 1);
+        QString method = fullName.mid(separator + 1);
+
+        //Services are added before server is started, so they are accessed without lock
+        QAbstractGrpcService *implementation = services.value(service, nullptr);
+        if (implementation == nullptr) {
+            qProtoWarning() << "Service" << service << "is not implemented by server";
+            return {QGrpcStatus::Unimplemented, QString("%1 service is not implemented").arg(service)};
+        }
+        return implementation->handle(method, args, ret);
+    }
+
+    int workerCount = 0;
+    QHash<QString, QAbstractGrpcService *> services;
+    grpc::AsyncGenericService genericService;
+    std::unique_ptr<grpc::Server> server;
+    std::vector<std::unique_ptr<grpc::ServerCompletionQueue>> queues;
+    std::vector<QThread *> workers;
+};
+
+//! \private
+//! \brief Unary call accepted by server, that is used as completion queue tag for all its operations
+class QGrpcServerCall {
+public:
+    QGrpcServerCall(QGrpcServerPrivate *server, grpc::ServerCompletionQueue *queue) : m_server(server)
+      , m_queue(queue)
+      , m_stream(&m_context)
+    {
+        m_server->genericService.RequestCall(&m_context, &m_stream, m_queue, m_queue, this);
+    }
+
+    //! \brief Continues call after previous operation is completed, invoked by worker thread
+    void proceed(bool ok) {
+        switch (m_state) {
+        case Requested:
+            //Queue is shut down
+            if (!ok) {
+                delete this;
+                return;
+            }
+            //Next call is accepted while this call is handled
+            new QGrpcServerCall(m_server, m_queue);
+            m_state = Reading;
+            m_stream.Read(&m_request, this);
+            break;
+        case Reading:
+            m_state = Finishing;
+            if (!ok) {
+                m_stream.Finish(grpc::Status(grpc::StatusCode::INTERNAL, "Request message is not received"), this);
+                return;
+            }
+            handle();
+            break;
+        case Finishing:
+            delete this;
+            break;
+        }
+    }
+
+private:
+    Q_DISABLE_COPY_MOVE(QGrpcServerCall)
+
+    enum State {
+        Requested,
+        Reading,
+        Finishing
+    };
+
+    void handle() {
+        QByteArray args;
+        grpc::Status parseStatus = parseByteBuffer(m_request, args);
+        if (!parseStatus.ok()) {
+            m_stream.Finish(parseStatus, this);
+            return;
+        }
+
+        QByteArray ret;
+        QGrpcStatus status = m_server->handle(m_context.method(), args, ret);
+        if (status.code() != QGrpcStatus::Ok) {
+            m_stream.Finish(grpc::Status(static_cast<grpc::StatusCode>(status.code()), status.message().toStdString()), this);
+            return;
+        }
+
+        parseQByteArray(ret, m_response);
+        m_stream.WriteAndFinish(m_response, grpc::WriteOptions(), grpc::Status::OK, this);
+    }
+
+    QGrpcServerPrivate *m_server;
+    grpc::ServerCompletionQueue *m_queue;
+    grpc::GenericServerContext m_context;
+    grpc::GenericServerAsyncReaderWriter m_stream;
+    grpc::ByteBuffer m_request;
+    grpc::ByteBuffer m_response;
+    State m_state = Requested;
+};
+
+}
+
+QGrpcServer::QGrpcServer(int workerCount) : dPtr(std::make_unique<QGrpcServerPrivate>())
+{
+    dPtr->workerCount = workerCount > 0 ? workerCount : std::max(1, QThread::idealThreadCount());
+}
+
+QGrpcServer::~QGrpcServer()
+{
+    shutdown();
+}
+
+void QGrpcServer::addService(QAbstractGrpcService *service)
+{
+    assert(service != nullptr);
+    if (isRunning()) {
+        qProtoWarning() << "Service" << service->serviceName() << "is not added, because server is already started";
+        return;
+    }
+    dPtr->services.insert(service->serviceName(), service);
+}
+
+bool QGrpcServer::start(const QString &address, const std::shared_ptr<grpc::ServerCredentials> &credentials)
+{
+    if (isRunning()) {
+        qProtoWarning() << "Server is already started";
+        return false;
+    }
+
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort(address.toStdString(), credentials);
+    builder.RegisterAsyncGenericService(&dPtr->genericService);
+    for (int i = 0; i < dPtr->workerCount; i++) {
+        dPtr->queues.push_back(builder.AddCompletionQueue());
+    }
+
+    dPtr->server = builder.BuildAndStart();
+    if (!dPtr->server) {
+        qProtoCritical() << "Unable to start server on" << address;
+        dPtr->queues.clear();
+        return false;
+    }
+
+    for (auto &queue : dPtr->queues) {
+        grpc::ServerCompletionQueue *queuePtr = queue.get();
+        //Every worker accepts calls to own queue, so calls are spread between workers
+        new QGrpcServerCall(dPtr.get(), queuePtr);
+        QThread *worker = QThread::create([queuePtr]() {
+            void *tag = nullptr;
+            bool ok = false;
+            while (queuePtr->Next(&tag, &ok)) {
+                static_cast<QGrpcServerCall *>(tag)->proceed(ok);
+            }
+        });
+        worker->start();
+        dPtr->workers.push_back(worker);
+    }
+    return true;
+}
+
+void QGrpcServer::shutdown()
+{
+    if (!isRunning()) {
+        return;
+    }
+
+    //Calls in progress are completed by workers, pending accepts are completed with failure
+    dPtr->server->Shutdown();
+    for (auto &queue : dPtr->queues) {
+        queue->Shutdown();
+    }
+
+    for (auto worker : dPtr->workers) {
+        worker->wait();
+        delete worker;
+    }
+    dPtr->workers.clear();
+    dPtr->server.reset();
+    dPtr->queues.clear();
+}
+
+bool QGrpcServer::isRunning() const
+{
+    return dPtr->server != nullptr;
+}
+
+int QGrpcServer::workerCount() const
+{
+    return dPtr->workerCount;
+}
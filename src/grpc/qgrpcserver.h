@@ -0,0 +1,109 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QGrpcServer
+
+#include <QString>
+
+#include <grpcpp/security/server_credentials.h>
+
+#include <memory>
+
+#include "qtgrpcglobal.h"
+
+namespace QtProtobuf {
+
+class QAbstractGrpcService;
+struct QGrpcServerPrivate;
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcServer class hosts implementations of generated server classes using gRPC-cpp native api
+ * \details Server accepts calls asynchronously using completion queues, that are polled by pool of worker
+ *          threads. Methods of services are invoked in worker threads, serialized messages are passed between
+ *          gRPC and QtProtobuf without extra copies. Only unary methods are served.
+ *
+ *          \code
+ *          class TestServiceImpl : public TestServiceServer {
+ *              QGrpcStatus testMethod(const SimpleStringMessage &arg, SimpleStringMessage &ret) override {
+ *                  ret.setTestFieldString(arg.testFieldString());
+ *                  return QGrpcStatus{QGrpcStatus::Ok};
+ *              }
+ *          };
+ *
+ *          TestServiceImpl service;
+ *          QGrpcServer server;
+ *          server.addService(&service);
+ *          server.start("localhost:50051", grpc::InsecureServerCredentials());
+ *          \endcode
+ */
+class Q_GRPC_EXPORT QGrpcServer final
+{
+public:
+    /*!
+     * \brief QGrpcServer constructs QGrpcServer
+     * \param workerCount number of worker threads, that handle calls. Non-positive \p workerCount selects
+     *        number of threads according to number of CPU cores.
+     */
+    QGrpcServer(int workerCount = 0);
+    /*!
+     * \brief Destroys server, server is shut down if it's running
+     */
+    ~QGrpcServer();
+
+    /*!
+     * \brief Adds \p service to server. Services have to be added before server is started and have to
+     *        outlive server.
+     */
+    void addService(QAbstractGrpcService *service);
+
+    /*!
+     * \brief Starts server listening on \p address, e.g. "0.0.0.0:50051" or "unix:///tmp/test.sock"
+     * \return true if server is started
+     */
+    bool start(const QString &address, const std::shared_ptr<grpc::ServerCredentials> &credentials);
+
+    /*!
+     * \brief Stops accepting new calls, waits until calls in progress are completed and stops worker threads
+     */
+    void shutdown();
+
+    /*!
+     * \brief Returns true if server is started and not shut down
+     */
+    bool isRunning() const;
+
+    /*!
+     * \brief Returns number of worker threads, that handle calls
+     */
+    int workerCount() const;
+
+private:
+    Q_DISABLE_COPY_MOVE(QGrpcServer)
+
+    std::unique_ptr<QGrpcServerPrivate> dPtr;
+};
+
+}
@@ -47,6 +47,18 @@ void QGrpcStream::addHandler(const StreamHandler &handler)
     }
 }
 
+void QGrpcStream::prepareResume()
+{
+    if (m_resumeHandler) {
+        m_arg = m_resumeHandler(m_arg, data());
+    }
+}
+
+std::shared_ptr<QGrpcReconnectPolicy> QGrpcStream::reconnectPolicy() const
+{
+    return m_reconnectPolicy ? m_reconnectPolicy : m_channel->reconnectPolicy();
+}
+
 void QGrpcStream::cancel()
 {
     if (thread() != QThread::currentThread()) {
@@ -27,7 +27,9 @@
 
 #include <functional>
 #include <QMutex>
+#include <QHash>
 #include <memory>
+#include <deque>
 
 #include "qabstractgrpcchannel.h"
 #include "qabstractgrpcclient.h"
@@ -47,6 +49,13 @@ class Q_GRPC_EXPORT QGrpcStream final : public QGrpcAsyncOperationBase
 {
     Q_OBJECT
 public:
+    /*!
+     * \brief Returns serialized argument of stream, that is used to restore stream after error
+     * \param arg serialized argument, that stream was subscribed with last time
+     * \param lastMessage serialized message, that was received last, or empty array if no messages were received
+     */
+    using ResumeHandler = std::function<QByteArray(const QByteArray &arg, const QByteArray &lastMessage)>;
+
     /*!
      * \brief Cancels this stream and try to abort call in channel
      */
@@ -73,13 +82,87 @@ public:
      *          to update data in stream and notify clients about stream updates.
      */
     void handler(const QByteArray& data) {
-        setData(data);
-        for (auto handler : m_handlers) {
-            handler(data);
+        m_reconnectAttempts = 0;
+        traceEvent(QGrpcSpan::MessageDelivered);
+        //Message is shared with interceptors, it's copied only if interceptor modifies it
+        QByteArray message(data);
+        if (!interceptMessage(message)) {
+            return;
+        }
+        setData(message);
+        //Handlers are accessed by index, because handler may subscribe to this stream again and add new handler
+        for (size_t i = 0; i < m_handlers.size(); ++i) {
+            m_handlers[i](message);
         }
+        m_decodedMessages.clear();
         messageReceived();
     }
 
+    /*!
+     * \brief Sets policy of stream reconnection, that overrides reconnect policy of channel
+     * \param[in] policy reconnect policy, nullptr resets stream to use policy of channel
+     */
+    void setReconnectPolicy(const std::shared_ptr<QGrpcReconnectPolicy> &policy) {
+        m_reconnectPolicy = policy;
+    }
+
+    /*!
+     * \brief Returns policy of stream reconnection, that is used for this stream
+     */
+    std::shared_ptr<QGrpcReconnectPolicy> reconnectPolicy() const;
+
+    /*!
+     * \brief Sets \a handler, that updates argument of stream before stream is restored after error
+     * \details By default stream is restored with the same argument, so server sends its full state again.
+     *          Handler lets client to ask server for updates since last received message, e.g. using sequence
+     *          number or resume token of the message. Stream is still identified by its original argument, when
+     *          client merges subscriptions.
+     */
+    void setResumeHandler(const ResumeHandler &handler) {
+        m_resumeHandler = handler;
+    }
+
+    /*!
+     * \brief Sets \a handler, that updates deserialized argument of stream using deserialized message received
+     *        last, before stream is restored after error
+     * \details \a lastMessage is default constructed message, if no messages were received.
+     *          \code
+     *          stream->setResumeHandler<StateRequest, StateUpdate>([](StateRequest &request, const StateUpdate &lastUpdate) {
+     *              request.setSinceSequence(lastUpdate.sequence());
+     *          });
+     *          \endcode
+     */
+    template<typename A, typename M>
+    void setResumeHandler(const std::function<void(A &arg, const M &lastMessage)> &handler) {
+        m_resumeHandler = [this, handler](const QByteArray &arg, const QByteArray &lastMessage) {
+            A resumeArg;
+            M message;
+            if (deserialize(&resumeArg, arg).code() != QGrpcStatus::Ok
+                    || (!lastMessage.isEmpty() && deserialize(&message, lastMessage).code() != QGrpcStatus::Ok)) {
+                return arg;
+            }
+            handler(resumeArg, message);
+            return resumeArg.serialize(serializer());
+        };
+    }
+
+    /*!
+     * \brief Enables delivery of latest message only. Disabled by default.
+     * \details When enabled, only the last one of messages, that are received by channel in between event loop
+     *          iterations, is delivered to stream handlers. Intermediate messages are dropped. Useful for streams
+     *          of state updates with high rate, when only recent state matters.
+     */
+    void setLatestMessageOnly(bool enabled) {
+        m_latestMessageOnly = enabled;
+    }
+
+    /*!
+     * \brief Returns true if only latest message is delivered to stream handlers
+     */
+    bool isLatestMessageOnly() const {
+        return m_latestMessageOnly;
+    }
+
 signals:
     /*!
      * \brief The signal is emitted when stream received updated value from server
@@ -103,9 +186,20 @@ protected:
 
 private:
     friend class QAbstractGrpcClient;
+
+    //! \private
+    //! \brief Updates argument of stream using resume handler, called before stream is restored
+    void prepareResume();
+
     QString m_method;
     QByteArray m_arg;
-    std::vector<StreamHandler> m_handlers;
+    ResumeHandler m_resumeHandler;
+    std::deque<StreamHandler> m_handlers;
+    //Messages decoded from current update by type, shared by handlers of stream
+    QHash<int, QGrpcDecodedStreamMessage> m_decodedMessages;
+    std::shared_ptr<QGrpcReconnectPolicy> m_reconnectPolicy;
+    int m_reconnectAttempts = 0;
+    bool m_latestMessageOnly = false;
 };
 
 }
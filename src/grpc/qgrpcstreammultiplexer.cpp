@@ -0,0 +1,152 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qgrpcstreammultiplexer.h"
+
+#include <QHash>
+
+#include <vector>
+
+#include "qgrpcstream.h"
+#include "qgrpcclientstream.h"
+#include "qtprotobuflogging.h"
+
+namespace QtProtobuf {
+
+//! \private
+struct QGrpcStreamMultiplexerPrivate {
+    QGrpcStreamMultiplexerPrivate(const QGrpcStreamMultiplexer::TopicExtractor &_topicOf,
+                                  const QGrpcStreamMultiplexer::ControlMessageBuilder &_controlMessage) : topicOf(_topicOf)
+      , controlMessage(_controlMessage) {}
+
+    QGrpcStreamMultiplexer::TopicExtractor topicOf;
+    QGrpcStreamMultiplexer::ControlMessageBuilder controlMessage;
+    QGrpcClientStreamShared clientStream;
+    QGrpcStreamShared serverStream;
+    //Topics are looked up once per message, so dispatch cost doesn't depend on number of topics
+    QHash<QByteArray, std::vector<StreamHandler>> handlers;
+    quint64 received = 0;
+};
+
+}
+
+using namespace QtProtobuf;
+
+QGrpcStreamMultiplexer::QGrpcStreamMultiplexer(const QGrpcClientStreamShared &stream, const TopicExtractor &topicOf,
+                                               const ControlMessageBuilder &controlMessage, QObject *parent) : QObject(parent)
+  , dPtr(std::make_unique<QGrpcStreamMultiplexerPrivate>(topicOf, controlMessage))
+{
+    dPtr->clientStream = stream;
+    attach(stream);
+}
+
+QGrpcStreamMultiplexer::QGrpcStreamMultiplexer(const QGrpcStreamShared &stream, const TopicExtractor &topicOf, QObject *parent) : QObject(parent)
+  , dPtr(std::make_unique<QGrpcStreamMultiplexerPrivate>(topicOf, nullptr))
+{
+    dPtr->serverStream = stream;
+    attach(stream);
+}
+
+QGrpcStreamMultiplexer::~QGrpcStreamMultiplexer() = default;
+
+template<typename S>
+void QGrpcStreamMultiplexer::attach(const std::shared_ptr<S> &stream)
+{
+    if (stream == nullptr) {
+        qProtoWarning() << "QGrpcStreamMultiplexer is attached to null stream";
+        return;
+    }
+
+    S *streamPtr = stream.get();
+    connect(streamPtr, &S::messageReceived, this, [this, streamPtr]() {
+        dispatch(streamPtr->data());
+    });
+    connect(streamPtr, &S::finished, this, &QGrpcStreamMultiplexer::finished);
+    connect(streamPtr, &S::error, this, &QGrpcStreamMultiplexer::error);
+}
+
+bool QGrpcStreamMultiplexer::subscribe(const QByteArray &topic, const StreamHandler &handler)
+{
+    if (!handler) {
+        qProtoWarning() << "Unable to subscribe topic" << topic << "with empty handler";
+        return false;
+    }
+
+    auto it = dPtr->handlers.find(topic);
+    if (it == dPtr->handlers.end()) {
+        if (dPtr->clientStream != nullptr && dPtr->controlMessage
+                && !dPtr->clientStream->writeData(dPtr->controlMessage(topic, true))) {
+            qProtoWarning() << "Unable to write subscription of topic" << topic << "to stream" << dPtr->clientStream->method();
+            return false;
+        }
+        it = dPtr->handlers.insert(topic, {});
+    }
+    it->push_back(handler);
+    return true;
+}
+
+void QGrpcStreamMultiplexer::unsubscribe(const QByteArray &topic)
+{
+    if (dPtr->handlers.remove(topic) == 0) {
+        return;
+    }
+
+    if (dPtr->clientStream != nullptr && dPtr->controlMessage
+            && !dPtr->clientStream->writeData(dPtr->controlMessage(topic, false))) {
+        qProtoWarning() << "Unable to write unsubscription of topic" << topic << "to stream" << dPtr->clientStream->method();
+    }
+}
+
+bool QGrpcStreamMultiplexer::isSubscribed(const QByteArray &topic) const
+{
+    return dPtr->handlers.contains(topic);
+}
+
+QList<QByteArray> QGrpcStreamMultiplexer::topics() const
+{
+    return dPtr->handlers.keys();
+}
+
+quint64 QGrpcStreamMultiplexer::receivedCount() const
+{
+    return dPtr->received;
+}
+
+void QGrpcStreamMultiplexer::dispatch(const QByteArray &data)
+{
+    ++dPtr->received;
+    const QByteArray topic = dPtr->topicOf(data);
+    auto it = dPtr->handlers.constFind(topic);
+    if (it == dPtr->handlers.constEnd()) {
+        unhandledMessage(topic);
+        return;
+    }
+
+    //Handlers are copied, because handler may subscribe or unsubscribe topics
+    const std::vector<StreamHandler> handlers = it.value();
+    for (const auto &handler : handlers) {
+        handler(data);
+    }
+}
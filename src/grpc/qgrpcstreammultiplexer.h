@@ -0,0 +1,157 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QGrpcStreamMultiplexer
+
+#include <QObject>
+#include <QByteArray>
+#include <QList>
+
+#include <functional>
+#include <memory>
+
+#include "qabstractgrpcclient.h"
+#include "qgrpcstatus.h"
+#include "qtgrpcglobal.h"
+
+namespace QtProtobuf {
+
+struct QGrpcStreamMultiplexerPrivate;
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcStreamMultiplexer class delivers messages of many logical subscriptions, that share single stream,
+ *        to handlers of their topics
+ * \details Server sends messages of all topics, that client is subscribed to, using single stream. Each message
+ *          carries identifier of its topic, that is extracted from serialized message by topic extractor function.
+ *          Messages are delivered to handlers subscribed to extracted topic, so number of streams, connections and
+ *          headers doesn't depend on number of topics.
+ *
+ *          If multiplexer is attached to bidirectional stream, first subscription to topic and unsubscription from
+ *          it write control messages, built by control message builder, to the stream. Set of topics of server
+ *          stream is defined by argument of the stream, handlers only select messages of topics locally.
+ *          \code
+ *          auto stream = client->streamTopics();
+ *          QtProtobuf::QGrpcStreamMultiplexer multiplexer(stream, [](const QByteArray &data) {
+ *              return TopicUpdate::fromSerialized(data).topicId().toUtf8();
+ *          }, [](const QByteArray &topic, bool subscribed) {
+ *              return TopicControl{QString::fromUtf8(topic), subscribed}.serialize(&serializer);
+ *          });
+ *          multiplexer.subscribe("sensor/42", [](const QByteArray &data) {
+ *              ...
+ *          });
+ *          \endcode
+ *          Multiplexer should live in thread of stream it's attached to.
+ */
+class Q_GRPC_EXPORT QGrpcStreamMultiplexer final : public QObject
+{
+    Q_OBJECT
+public:
+    /*!
+     * \brief Function that returns topic of serialized message received from stream
+     */
+    using TopicExtractor = std::function<QByteArray(const QByteArray &data)>;
+
+    /*!
+     * \brief Function that returns serialized control message, that subscribes stream to \a topic if \a subscribed
+     *        is true or unsubscribes stream from \a topic otherwise
+     */
+    using ControlMessageBuilder = std::function<QByteArray(const QByteArray &topic, bool subscribed)>;
+
+    /*!
+     * \brief Constructs multiplexer of bidirectional \a stream
+     * \param topicOf function that extracts topic of received messages
+     * \param controlMessage function that builds messages written to stream when topics are subscribed and unsubscribed
+     */
+    QGrpcStreamMultiplexer(const QGrpcClientStreamShared &stream, const TopicExtractor &topicOf,
+                           const ControlMessageBuilder &controlMessage, QObject *parent = nullptr);
+
+    /*!
+     * \brief Constructs multiplexer of server \a stream
+     * \param topicOf function that extracts topic of received messages
+     */
+    QGrpcStreamMultiplexer(const QGrpcStreamShared &stream, const TopicExtractor &topicOf, QObject *parent = nullptr);
+    ~QGrpcStreamMultiplexer();
+
+    /*!
+     * \brief Adds \a handler of messages of \a topic
+     * \details First handler of topic writes subscription control message to bidirectional stream.
+     * \return false if control message couldn't be written, handler is not added in this case
+     */
+    bool subscribe(const QByteArray &topic, const StreamHandler &handler);
+
+    /*!
+     * \brief Removes all handlers of \a topic and writes unsubscription control message to bidirectional stream
+     */
+    void unsubscribe(const QByteArray &topic);
+
+    /*!
+     * \brief Returns true if \a topic has handlers
+     */
+    bool isSubscribed(const QByteArray &topic) const;
+
+    /*!
+     * \brief Returns topics that have handlers
+     */
+    QList<QByteArray> topics() const;
+
+    /*!
+     * \brief Returns number of messages received from stream, including messages of topics without handlers
+     */
+    quint64 receivedCount() const;
+
+    /*!
+     * \brief Delivers serialized message \a data to handlers of its topic
+     * \details Messages received from attached stream are dispatched automatically. Method may be used to
+     *          demultiplex messages received other way, e.g. from stream created by application.
+     */
+    void dispatch(const QByteArray &data);
+
+signals:
+    /*!
+     * \brief The signal is emitted when message of \a topic without handlers is received
+     */
+    void unhandledMessage(const QByteArray &topic);
+
+    /*!
+     * \brief The signal is emitted when attached stream is closed by server with Ok status
+     */
+    void finished();
+
+    /*!
+     * \brief The signal is emitted when attached stream is finished with \a status other than Ok
+     */
+    void error(const QtProtobuf::QGrpcStatus &status);
+
+private:
+    Q_DISABLE_COPY_MOVE(QGrpcStreamMultiplexer)
+
+    template<typename S>
+    void attach(const std::shared_ptr<S> &stream);
+
+    std::unique_ptr<QGrpcStreamMultiplexerPrivate> dPtr;
+};
+
+}
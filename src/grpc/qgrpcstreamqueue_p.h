@@ -0,0 +1,125 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QObject>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "qgrpcstatus.h"
+
+namespace QtProtobuf {
+
+/*!
+ * \private
+ * \brief Queue of stream messages, that are received by I/O thread of channel and delivered to thread of stream
+ * \details Single I/O thread pushes messages and single stream thread takes them, so queue is lock-free list
+ *          that is taken by consumer at once. messagesReady() is emitted only for message pushed to empty queue,
+ *          so messages received in between event loop iterations of stream thread are delivered in single batch.
+ */
+class QGrpcStreamQueue : public QObject
+{
+    //! \private
+    Q_OBJECT
+
+public:
+    QGrpcStreamQueue() = default;
+    ~QGrpcStreamQueue() {
+        takeMessages();
+    }
+
+    //! \brief Appends \a message to queue and notifies thread of stream if queue was empty
+    void push(const QByteArray &message) {
+        Node *expected = m_head.load(std::memory_order_relaxed);
+        Node *node = new Node{message, expected};
+        //Node may be taken and deleted by thread of stream right after it's published, so it's not touched after that
+        while (!m_head.compare_exchange_weak(expected, node, std::memory_order_release, std::memory_order_relaxed)) {
+            node->next = expected;
+        }
+        if (expected == nullptr) {
+            messagesReady();
+        }
+    }
+
+    //! \brief Takes all queued messages in order they were pushed
+    std::vector<QByteArray> takeMessages() {
+        std::vector<QByteArray> messages;
+        Node *node = m_head.exchange(nullptr, std::memory_order_acquire);
+        while (node != nullptr) {
+            messages.push_back(std::move(node->message));
+            Node *next = node->next;
+            delete node;
+            node = next;
+        }
+        std::reverse(messages.begin(), messages.end());
+        return messages;
+    }
+
+    //! \brief Stores final \a status of stream and notifies thread of stream, that no more messages are pushed
+    void close(const QGrpcStatus &status) {
+        //Status is published to thread of stream by queued signal
+        m_status = status;
+        closed();
+    }
+
+    //! \brief Returns final status of stream, valid when closed() signal is received
+    QGrpcStatus status() const {
+        return m_status;
+    }
+
+    //! \brief Stops delivery of messages, that are still queued, when stream is cancelled in its thread
+    void cancel() {
+        m_cancelled = true;
+    }
+
+    //! \brief Returns true if stream is cancelled
+    bool isCancelled() const {
+        return m_cancelled;
+    }
+
+signals:
+    //! \brief Emitted by I/O thread when message is pushed to empty queue
+    void messagesReady();
+    //! \brief Emitted by I/O thread when network reply of stream is finished
+    void closed();
+
+private:
+    struct Node {
+        QByteArray message;
+        Node *next;
+    };
+
+    //Messages are linked in reverse order of pushing
+    std::atomic<Node *> m_head{nullptr};
+    QGrpcStatus m_status;
+    //Accessed in thread of stream only
+    bool m_cancelled = false;
+};
+
+}
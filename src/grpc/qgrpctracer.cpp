@@ -0,0 +1,143 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qgrpctracer.h"
+
+#include <QRandomGenerator>
+
+#include <algorithm>
+
+using namespace QtProtobuf;
+
+namespace  {
+const int TraceIdSize = 16;
+const int SpanIdSize = 8;
+const int TraceparentSize = 55;
+
+QByteArray randomId(int size)
+{
+    QByteArray id(size, Qt::Uninitialized);
+    //All-zero identifiers are invalid, so they are generated again
+    do {
+        for (int i = 0; i < size; ++i) {
+            id[i] = static_cast<char>(QRandomGenerator::global()->bounded(256));
+        }
+    } while (std::all_of(id.begin(), id.end(), [](char c) { return c == 0; }));
+    return id;
+}
+
+bool isLowerHex(const QByteArray &value)
+{
+    return std::all_of(value.begin(), value.end(), [](char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+    });
+}
+}
+
+const QByteArray QGrpcTraceContext::TraceparentKey("traceparent");
+
+QGrpcSpan::~QGrpcSpan()
+{}
+
+QGrpcTracer::~QGrpcTracer()
+{}
+
+QGrpcTraceContext::QGrpcTraceContext(const QByteArray &traceId, const QByteArray &spanId, bool sampled) :
+    m_traceId(traceId)
+  , m_spanId(spanId)
+  , m_sampled(sampled)
+{
+}
+
+QGrpcTraceContext QGrpcTraceContext::generate()
+{
+    return {randomId(TraceIdSize), randomId(SpanIdSize), true};
+}
+
+QGrpcTraceContext QGrpcTraceContext::child() const
+{
+    if (!isValid()) {
+        return generate();
+    }
+    return {m_traceId, randomId(SpanIdSize), m_sampled};
+}
+
+QGrpcTraceContext QGrpcTraceContext::fromTraceparent(const QByteArray &traceparent)
+{
+    //Only version 00 is supported, that has fixed size
+    if (traceparent.size() != TraceparentSize || !traceparent.startsWith("00-")
+            || traceparent.at(35) != '-' || traceparent.at(52) != '-') {
+        return {};
+    }
+
+    const QByteArray traceId = traceparent.mid(3, TraceIdSize * 2);
+    const QByteArray spanId = traceparent.mid(36, SpanIdSize * 2);
+    const QByteArray flags = traceparent.mid(53, 2);
+    if (!isLowerHex(traceId) || !isLowerHex(spanId) || !isLowerHex(flags)) {
+        return {};
+    }
+
+    QGrpcTraceContext context(QByteArray::fromHex(traceId), QByteArray::fromHex(spanId),
+                              (flags.toInt(nullptr, 16) & 0x01) != 0);
+    return context.isValid() ? context : QGrpcTraceContext{};
+}
+
+QGrpcTraceContext QGrpcTraceContext::fromMetadata(const QGrpcMetadata &metadata)
+{
+    for (const auto &entry : metadata) {
+        if (entry.first == TraceparentKey) {
+            return fromTraceparent(entry.second);
+        }
+    }
+    return {};
+}
+
+QByteArray QGrpcTraceContext::toTraceparent() const
+{
+    if (!isValid()) {
+        return {};
+    }
+    return QByteArray("00-") + m_traceId.toHex() + '-' + m_spanId.toHex() + (m_sampled ? "-01" : "-00");
+}
+
+void QGrpcTraceContext::inject(QGrpcMetadata &metadata) const
+{
+    metadata.erase(std::remove_if(metadata.begin(), metadata.end(), [](const QPair<QByteArray, QByteArray> &entry) {
+        return entry.first == TraceparentKey;
+    }), metadata.end());
+
+    if (isValid()) {
+        metadata.append(qMakePair(TraceparentKey, toTraceparent()));
+    }
+}
+
+bool QGrpcTraceContext::isValid() const
+{
+    auto isZero = [](const QByteArray &id) {
+        return std::all_of(id.begin(), id.end(), [](char c) { return c == 0; });
+    };
+    return m_traceId.size() == TraceIdSize && m_spanId.size() == SpanIdSize
+            && !isZero(m_traceId) && !isZero(m_spanId);
+}
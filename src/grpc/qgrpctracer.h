@@ -0,0 +1,195 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QGrpcTracer
+
+#include <QByteArray>
+#include <QString>
+
+#include <memory>
+
+#include "qgrpccalloptions.h"
+#include "qgrpcstatus.h"
+#include "qtgrpcglobal.h"
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcSpan class is interface of span, that records events of single call or stream
+ * \details Span is created by QGrpcTracer, when call is started, and is kept alive by QGrpcAsyncReply or QGrpcStream
+ *          of call. Events split latency of call into parts:
+ *          - network: from start of span to MessageReceived, RequestSent marks the moment when request is passed
+ *            to transport
+ *          - queueing on event loop: from MessageReceived, reported by thread of channel, to MessageDelivered,
+ *            reported by thread of client
+ *          - decoding: from DeserializationStarted to DeserializationFinished
+ *
+ *          Events reported by channel are invoked from thread of channel, so implementation should be thread-safe.
+ *          Response message is deserialized when it's read by receiver of QGrpcAsyncReply::finished() signal, so
+ *          deserialization events of unary calls may be reported after finish().
+ */
+class Q_GRPC_EXPORT QGrpcSpan
+{
+public:
+    enum Event {
+        RequestSent,            //!< Request is passed to transport by channel
+        FirstByteReceived,      //!< First bytes of response are received by channel
+        MessageReceived,        //!< Whole response message is received by channel
+        MessageDelivered,       //!< Message is delivered to reply or stream in thread of client
+        DeserializationStarted, //!< Deserialization of received message is started
+        DeserializationFinished //!< Deserialization of received message is finished
+    };
+
+    virtual ~QGrpcSpan();
+
+    /*!
+     * \brief Records \p event of call
+     */
+    virtual void addEvent(Event event) = 0;
+
+    /*!
+     * \brief Records completion of call with \p status. For streams it's invoked when stream is finished or isn't
+     *        restored after error.
+     */
+    virtual void finish(const QGrpcStatus &status) = 0;
+};
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcTracer class is interface of tracer, that creates spans of calls made by QAbstractGrpcClient
+ * \details Tracer is set to client using QAbstractGrpcClient::setTracer(). Trace context of call is propagated to
+ *          server by the tracer, that adds it to metadata of call, e.g. using QGrpcTraceContext::inject().
+ *          \code{.cpp}
+ *          class Tracer : public QtProtobuf::QGrpcTracer {
+ *          public:
+ *              std::shared_ptr<QtProtobuf::QGrpcSpan> startSpan(const QString &service, const QString &method,
+ *                                                              QtProtobuf::QGrpcMetadata &metadata) override {
+ *                  QtProtobuf::QGrpcTraceContext context = currentContext().child();
+ *                  context.inject(metadata);
+ *                  return std::make_shared<Span>(context, service, method);
+ *              }
+ *          };
+ *          \endcode
+ */
+class Q_GRPC_EXPORT QGrpcTracer
+{
+public:
+    virtual ~QGrpcTracer();
+
+    /*!
+     * \brief Starts span of call of \p method of \p service
+     * \details Invoked in thread, that makes call, before call is passed to channel. Entries added to \p metadata
+     *          are sent with asynchronous unary calls; channels don't send metadata of other calls.
+     * \return span of call or nullptr if call isn't traced
+     */
+    virtual std::shared_ptr<QGrpcSpan> startSpan(const QString &service, const QString &method, QGrpcMetadata &metadata) = 0;
+};
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcTraceContext class is trace context in W3C Trace Context format
+ * \details Context is transferred in "traceparent" metadata entry in form of
+ *          "00-<32 hex digits of trace id>-<16 hex digits of span id>-<2 hex digits of flags>".
+ */
+class Q_GRPC_EXPORT QGrpcTraceContext final
+{
+public:
+    //! \brief Name of metadata entry, that contains trace context
+    static const QByteArray TraceparentKey;
+
+    /*!
+     * \brief Constructs invalid trace context
+     */
+    QGrpcTraceContext() = default;
+
+    /*!
+     * \brief Constructs trace context with 16 bytes \p traceId and 8 bytes \p spanId
+     */
+    QGrpcTraceContext(const QByteArray &traceId, const QByteArray &spanId, bool sampled = true);
+
+    /*!
+     * \brief Generates context of new trace with random identifiers
+     */
+    static QGrpcTraceContext generate();
+
+    /*!
+     * \brief Returns context of the same trace with new random span identifier
+     */
+    QGrpcTraceContext child() const;
+
+    /*!
+     * \brief Parses context from \p traceparent value, returns invalid context if \p traceparent is malformed
+     */
+    static QGrpcTraceContext fromTraceparent(const QByteArray &traceparent);
+
+    /*!
+     * \brief Returns context from "traceparent" entry of \p metadata or invalid context if it is missing
+     */
+    static QGrpcTraceContext fromMetadata(const QGrpcMetadata &metadata);
+
+    /*!
+     * \brief Returns context formatted as value of "traceparent" entry
+     */
+    QByteArray toTraceparent() const;
+
+    /*!
+     * \brief Replaces "traceparent" entry of \p metadata with this context
+     */
+    void inject(QGrpcMetadata &metadata) const;
+
+    /*!
+     * \brief Returns true if trace and span identifiers have valid size and are not zero
+     */
+    bool isValid() const;
+
+    /*!
+     * \brief Returns raw trace identifier
+     */
+    QByteArray traceId() const {
+        return m_traceId;
+    }
+
+    /*!
+     * \brief Returns raw span identifier
+     */
+    QByteArray spanId() const {
+        return m_spanId;
+    }
+
+    /*!
+     * \brief Returns true if trace is sampled
+     */
+    bool isSampled() const {
+        return m_sampled;
+    }
+
+private:
+    QByteArray m_traceId;
+    QByteArray m_spanId;
+    bool m_sampled = false;
+};
+
+}
@@ -0,0 +1,516 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qgrpcuploadqueue.h"
+
+#include <QBuffer>
+#include <QFile>
+#include <QPointer>
+#include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+#include <list>
+
+#include "qprotobufdelimitedstream.h"
+#include "qprotobufserializer.h"
+#include "qtprotobuflogging.h"
+
+namespace {
+//Log is compacted when at least this number of bytes is sent, unless it's the half of log
+const qint64 CompactionSize = 1024 * 1024;
+//Maximum size of varint encoded message size
+const int MaxSizePrefixLength = 5;
+}
+
+namespace QtProtobuf {
+
+//! \private
+struct QGrpcUploadQueuePrivate {
+    //! \private
+    //! \brief Batch in flight or waiting for retry, identified by logical offsets of its messages in log
+    struct Batch {
+        qint64 begin;
+        qint64 end;
+        int count;
+        int attempts;
+        bool ready;
+    };
+
+    QGrpcUploadQueuePrivate(const QGrpcUploadQueue::Sender &_sender) : sender(_sender)
+      , memoryDevice(&memoryLog)
+      , retryPolicy(std::make_shared<QGrpcReconnectPolicy>())
+    {}
+
+    void openMemory() {
+        memoryDevice.open(QIODevice::ReadWrite);
+        device = &memoryDevice;
+        stream = std::make_unique<QProtobufDelimitedStream>(device, &serializer);
+    }
+
+    bool openFile(const QString &fileName) {
+        file.setFileName(fileName);
+        //Messages are written directly to file, so mapped file always has all written messages
+        if (!file.open(QIODevice::ReadWrite | QIODevice::Unbuffered)) {
+            qProtoWarning() << "Unable to open upload queue file" << fileName << ":" << file.errorString();
+            return false;
+        }
+        device = &file;
+        stream = std::make_unique<QProtobufDelimitedStream>(device, &serializer);
+
+        //Messages left by previous run are sent first, incomplete message written at termination is dropped
+        qint64 size = 0;
+        const char *data = map(size);
+        qint64 position = 0;
+        qint64 record = 0;
+        while ((record = recordSize(data, size, position)) > 0) {
+            position += record;
+            ++queued;
+        }
+        unmap(data);
+        if (position < size) {
+            qProtoWarning() << "Upload queue file" << fileName << "has incomplete message, it's dropped";
+            file.resize(position);
+        }
+        file.seek(position);
+        logEnd = position;
+        unread = queued;
+        return true;
+    }
+
+    //! \brief Returns size of message at \a position with its size prefix, or -1 if message is incomplete
+    static qint64 recordSize(const char *data, qint64 size, qint64 position) {
+        quint64 messageSize = 0;
+        int prefixLength = 0;
+        while (position + prefixLength < size && prefixLength < MaxSizePrefixLength) {
+            const quint8 byte = static_cast<quint8>(data[position + prefixLength]);
+            messageSize |= static_cast<quint64>(byte & 0x7f) << (7 * prefixLength);
+            ++prefixLength;
+            if ((byte & 0x80) == 0) {
+                const qint64 record = prefixLength + static_cast<qint64>(messageSize);
+                return position + record <= size ? record : -1;
+            }
+        }
+        return -1;
+    }
+
+    //! \brief Returns size of \a dataSize bytes message with its size prefix
+    static qint64 recordSize(int dataSize) {
+        qint64 prefixLength = 1;
+        for (quint32 value = static_cast<quint32>(dataSize); value >= 0x80; value >>= 7) {
+            ++prefixLength;
+        }
+        return prefixLength + dataSize;
+    }
+
+    //! \brief Returns data of log and its \a size, file log is mapped to memory
+    const char *map(qint64 &size) {
+        stream->flush();
+        if (device == &memoryDevice) {
+            size = memoryLog.size();
+            return memoryLog.constData();
+        }
+
+        size = file.size();
+        if (size == 0) {
+            return nullptr;
+        }
+        const char *data = reinterpret_cast<const char *>(file.map(0, size));
+        if (data == nullptr) {
+            qProtoWarning() << "Unable to map upload queue file:" << file.errorString();
+            size = 0;
+        }
+        return data;
+    }
+
+    void unmap(const char *data) {
+        if (device == &file && data != nullptr) {
+            file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(data)));
+        }
+    }
+
+    //! \brief Returns serialized messages of \a batch
+    QByteArray payload(const Batch &batch) {
+        qint64 size = 0;
+        const char *data = map(size);
+        QByteArray result;
+        if (batch.end - base <= size) {
+            result = QByteArray(data + (batch.begin - base), static_cast<int>(batch.end - batch.begin));
+        }
+        unmap(data);
+        return result;
+    }
+
+    //! \brief Returns offset of the first message, that is not sent yet
+    qint64 committed() const {
+        qint64 offset = readOffset;
+        for (const auto &batch : batches) {
+            offset = std::min(offset, batch.begin);
+        }
+        return offset;
+    }
+
+    //! \brief Removes sent messages from log. Log is compacted if enough messages are sent, or if \a force is true.
+    void compact(bool force) {
+        const qint64 offset = committed();
+        const qint64 discarded = offset - base;
+        if (discarded <= 0 || (!force && offset != logEnd && discarded < std::max(CompactionSize, (logEnd - base) / 2))) {
+            return;
+        }
+
+        if (device == &memoryDevice) {
+            stream->flush();
+            memoryLog.remove(0, static_cast<int>(discarded));
+            memoryDevice.seek(memoryLog.size());
+        } else {
+            qint64 size = 0;
+            const char *data = map(size);
+            const QByteArray tail = offset != logEnd ? QByteArray(data + discarded, static_cast<int>(size - discarded)) : QByteArray();
+            unmap(data);
+            file.seek(0);
+            file.write(tail);
+            file.resize(tail.size());
+            file.seek(tail.size());
+        }
+        base = offset;
+    }
+
+    QGrpcUploadQueue::Sender sender;
+    QProtobufSerializer serializer;
+    QByteArray memoryLog;
+    QBuffer memoryDevice;
+    QFile file;
+    QIODevice *device = nullptr;
+    std::unique_ptr<QProtobufDelimitedStream> stream;
+    //Offsets are logical, message at offset is at offset - base of device
+    qint64 base = 0;
+    qint64 logEnd = 0;
+    //Offset of the first message, that is not taken to batch
+    qint64 readOffset = 0;
+    int queued = 0;
+    int unread = 0;
+    int inFlight = 0;
+    qint64 sent = 0;
+    std::list<Batch> batches;
+    QTimer *delayTimer = nullptr;
+    bool delayElapsed = false;
+    bool dispatching = false;
+    int maxBatchSize = 64 * 1024;
+    int maxBatchCount = 500;
+    int maxInFlight = 2;
+    qint64 maxQueuedSize = 0;
+    std::shared_ptr<QGrpcReconnectPolicy> retryPolicy;
+};
+
+}
+
+using namespace QtProtobuf;
+
+QGrpcUploadQueue::QGrpcUploadQueue(const Sender &sender, QObject *parent) : QObject(parent)
+  , dPtr(std::make_unique<QGrpcUploadQueuePrivate>(sender))
+{
+    dPtr->openMemory();
+    dPtr->delayTimer = new QTimer(this);
+    dPtr->delayTimer->setSingleShot(true);
+    dPtr->delayTimer->setInterval(1000);
+    connect(dPtr->delayTimer, &QTimer::timeout, this, [this] {
+        dPtr->delayElapsed = true;
+        dispatch();
+    });
+}
+
+QGrpcUploadQueue::QGrpcUploadQueue(const Sender &sender, const QString &fileName, QObject *parent) : QObject(parent)
+  , dPtr(std::make_unique<QGrpcUploadQueuePrivate>(sender))
+{
+    dPtr->delayTimer = new QTimer(this);
+    dPtr->delayTimer->setSingleShot(true);
+    dPtr->delayTimer->setInterval(1000);
+    connect(dPtr->delayTimer, &QTimer::timeout, this, [this] {
+        dPtr->delayElapsed = true;
+        dispatch();
+    });
+
+    if (dPtr->openFile(fileName) && dPtr->unread > 0) {
+        qProtoDebug() << "Upload queue has" << dPtr->unread << "messages left by previous run";
+        dPtr->delayTimer->start();
+    }
+}
+
+QGrpcUploadQueue::~QGrpcUploadQueue()
+{
+    if (dPtr->device != nullptr) {
+        //Sent messages are removed, so they are not sent again by the next run
+        dPtr->compact(true);
+    }
+}
+
+bool QGrpcUploadQueue::isValid() const
+{
+    return dPtr->device != nullptr && !dPtr->stream->hasError();
+}
+
+QAbstractProtobufSerializer *QGrpcUploadQueue::serializer() const
+{
+    return &dPtr->serializer;
+}
+
+bool QGrpcUploadQueue::enqueueData(const QByteArray &data)
+{
+    if (!isValid()) {
+        qProtoWarning() << "Unable to add message to invalid upload queue";
+        return false;
+    }
+
+    const qint64 recordSize = QGrpcUploadQueuePrivate::recordSize(data.size());
+    if (dPtr->maxQueuedSize > 0 && dPtr->logEnd - dPtr->committed() + recordSize > dPtr->maxQueuedSize) {
+        return false;
+    }
+
+    if (!dPtr->stream->writeMessageData(data)) {
+        return false;
+    }
+    dPtr->logEnd += recordSize;
+    ++dPtr->queued;
+    ++dPtr->unread;
+    dispatch();
+    return true;
+}
+
+void QGrpcUploadQueue::flush()
+{
+    dPtr->delayElapsed = true;
+    dispatch();
+}
+
+void QGrpcUploadQueue::dispatch()
+{
+    //Batches that are completed immediately don't recurse into dispatch, but are handled by this loop
+    if (dPtr->dispatching) {
+        return;
+    }
+
+    dPtr->dispatching = true;
+    while (dPtr->inFlight < dPtr->maxInFlight) {
+        //Batches waiting for retry are sent before new batches
+        auto batch = std::find_if(dPtr->batches.begin(), dPtr->batches.end(), [](const QGrpcUploadQueuePrivate::Batch &batch) {
+            return batch.ready;
+        });
+
+        if (batch == dPtr->batches.end()) {
+            if (dPtr->unread == 0 || (!dPtr->delayElapsed && dPtr->unread < dPtr->maxBatchCount
+                                      && dPtr->logEnd - dPtr->readOffset < dPtr->maxBatchSize)) {
+                break;
+            }
+
+            qint64 size = 0;
+            const char *data = dPtr->map(size);
+            const qint64 begin = dPtr->readOffset - dPtr->base;
+            qint64 position = begin;
+            int count = 0;
+            while (count < dPtr->maxBatchCount) {
+                const qint64 record = QGrpcUploadQueuePrivate::recordSize(data, size, position);
+                if (record < 0 || (count > 0 && position + record - begin > dPtr->maxBatchSize)) {
+                    break;
+                }
+                position += record;
+                ++count;
+            }
+            dPtr->unmap(data);
+
+            if (count == 0) {
+                qProtoWarning() << "Upload queue log is corrupted," << dPtr->unread << "messages are dropped";
+                dPtr->queued -= dPtr->unread;
+                dPtr->unread = 0;
+                dPtr->readOffset = dPtr->logEnd;
+                break;
+            }
+
+            batch = dPtr->batches.insert(dPtr->batches.end(), QGrpcUploadQueuePrivate::Batch{dPtr->readOffset, dPtr->base + position, count, 0, false});
+            dPtr->readOffset = batch->end;
+            dPtr->unread -= count;
+        }
+
+        batch->ready = false;
+        ++dPtr->inFlight;
+        const qint64 begin = batch->begin;
+        QPointer<QGrpcUploadQueue> queue(this);
+        std::shared_ptr<bool> completed(new bool(false));
+        dPtr->sender(dPtr->payload(*batch), batch->count, [queue, completed, begin](const QGrpcStatus &status) {
+            if (*completed) {
+                qProtoWarning() << "Completion of QGrpcUploadQueue batch is reported more than once";
+                return;
+            }
+            *completed = true;
+
+            if (queue.isNull()) {
+                return;
+            }
+
+            if (queue->thread() == QThread::currentThread()) {
+                queue->complete(begin, status);
+            } else {
+                QMetaObject::invokeMethod(queue.data(), [queue, begin, status] {
+                    if (!queue.isNull()) {
+                        queue->complete(begin, status);
+                    }
+                }, Qt::QueuedConnection);
+            }
+        });
+    }
+    dPtr->dispatching = false;
+
+    if (dPtr->unread == 0) {
+        dPtr->delayElapsed = false;
+        dPtr->delayTimer->stop();
+    } else if (!dPtr->delayElapsed && !dPtr->delayTimer->isActive()) {
+        dPtr->delayTimer->start();
+    }
+}
+
+void QGrpcUploadQueue::complete(qint64 begin, const QGrpcStatus &status)
+{
+    auto batch = std::find_if(dPtr->batches.begin(), dPtr->batches.end(), [begin](const QGrpcUploadQueuePrivate::Batch &batch) {
+        return batch.begin == begin;
+    });
+    if (batch == dPtr->batches.end()) {
+        return;
+    }
+
+    --dPtr->inFlight;
+    const int count = batch->count;
+    if (status.code() == QGrpcStatus::Ok) {
+        dPtr->queued -= count;
+        dPtr->sent += count;
+        dPtr->batches.erase(batch);
+        emit batchSent(count);
+    } else {
+        std::chrono::milliseconds delay(0);
+        if (dPtr->retryPolicy && dPtr->retryPolicy->reconnectDelay(++batch->attempts, status, delay)) {
+            qProtoDebug() << "Upload of" << count << "messages failed with" << status.code() << "retry in" << delay.count() << "ms";
+            QTimer::singleShot(static_cast<int>(delay.count()), this, [this, begin] {
+                for (auto &batch : dPtr->batches) {
+                    if (batch.begin == begin) {
+                        batch.ready = true;
+                    }
+                }
+                dispatch();
+            });
+        } else {
+            qProtoWarning() << "Upload of" << count << "messages failed with" << status.code() << "messages are dropped";
+            dPtr->queued -= count;
+            dPtr->batches.erase(batch);
+            emit batchDropped(status, count);
+        }
+    }
+
+    dPtr->compact(false);
+    dispatch();
+    if (dPtr->queued == 0 && dPtr->inFlight == 0) {
+        emit drained();
+    }
+}
+
+void QGrpcUploadQueue::setMaxBatchSize(int size)
+{
+    dPtr->maxBatchSize = std::max(1, size);
+    dispatch();
+}
+
+int QGrpcUploadQueue::maxBatchSize() const
+{
+    return dPtr->maxBatchSize;
+}
+
+void QGrpcUploadQueue::setMaxBatchCount(int count)
+{
+    dPtr->maxBatchCount = std::max(1, count);
+    dispatch();
+}
+
+int QGrpcUploadQueue::maxBatchCount() const
+{
+    return dPtr->maxBatchCount;
+}
+
+void QGrpcUploadQueue::setMaxBatchDelay(std::chrono::milliseconds delay)
+{
+    dPtr->delayTimer->setInterval(static_cast<int>(std::max(std::chrono::milliseconds::zero(), delay).count()));
+}
+
+std::chrono::milliseconds QGrpcUploadQueue::maxBatchDelay() const
+{
+    return std::chrono::milliseconds(dPtr->delayTimer->interval());
+}
+
+void QGrpcUploadQueue::setMaxInFlight(int maxInFlight)
+{
+    dPtr->maxInFlight = std::max(1, maxInFlight);
+    dispatch();
+}
+
+int QGrpcUploadQueue::maxInFlight() const
+{
+    return dPtr->maxInFlight;
+}
+
+void QGrpcUploadQueue::setMaxQueuedSize(qint64 size)
+{
+    dPtr->maxQueuedSize = std::max(qint64(0), size);
+}
+
+qint64 QGrpcUploadQueue::maxQueuedSize() const
+{
+    return dPtr->maxQueuedSize;
+}
+
+void QGrpcUploadQueue::setRetryPolicy(const std::shared_ptr<QGrpcReconnectPolicy> &policy)
+{
+    dPtr->retryPolicy = policy;
+}
+
+std::shared_ptr<QGrpcReconnectPolicy> QGrpcUploadQueue::retryPolicy() const
+{
+    return dPtr->retryPolicy;
+}
+
+int QGrpcUploadQueue::queuedCount() const
+{
+    return dPtr->queued;
+}
+
+qint64 QGrpcUploadQueue::queuedSize() const
+{
+    return dPtr->logEnd - dPtr->committed();
+}
+
+int QGrpcUploadQueue::inFlightCount() const
+{
+    return dPtr->inFlight;
+}
+
+qint64 QGrpcUploadQueue::sentCount() const
+{
+    return dPtr->sent;
+}
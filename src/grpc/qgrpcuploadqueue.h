@@ -0,0 +1,233 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QGrpcUploadQueue
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+#include "qabstractprotobufserializer.h"
+#include "qgrpcreconnectpolicy.h"
+#include "qgrpcstatus.h"
+#include "qtgrpcglobal.h"
+
+namespace QtProtobuf {
+
+struct QGrpcUploadQueuePrivate;
+
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcUploadQueue class stores messages and forwards them to server in batches
+ * \details Messages are serialized and appended to log of queue, that is kept in memory or in file. File log
+ *          keeps messages, that are not sent yet, between runs of application, e.g. when device is offline.
+ *          Queued messages are sent in batches using sender function. Batch is sent as soon as it has
+ *          maxBatchCount() messages or maxBatchSize() bytes, smaller batch is sent after maxBatchDelay() since
+ *          its first message was queued. No more than maxInFlight() batches are sent at the same time. Failed
+ *          batch is sent again after delay defined by retryPolicy(), batch is dropped if policy doesn't allow
+ *          more attempts.
+ *
+ *          Batch contains messages, each one is prefixed with its size encoded as varint. This is the format
+ *          of QProtobufDelimitedStream and QAbstractProtobufSerializer::serializeBatch(), so server or sender
+ *          may read batch using QAbstractProtobufSerializer::deserializeBatch().
+ *          \code
+ *          QtProtobuf::QGrpcUploadQueue queue([&client](const QByteArray &batch, int, const QtProtobuf::QGrpcUploadQueue::CompletionHandler &done) {
+ *              UploadRequest request;
+ *              request.setRecords(batch);
+ *              client.upload(request, [done](const QtProtobuf::QGrpcStatus &status, UploadReply &&) {
+ *                  done(status);
+ *              });
+ *          }, QStringLiteral("telemetry.log"));
+ *          queue.enqueue(record);
+ *          \endcode
+ *          Messages are delivered at least once: messages of batch, that was sent but not yet removed from file
+ *          log when application was terminated, are sent again after restart. Queue should live in thread of
+ *          sender, completion handler may be invoked from any thread.
+ */
+class Q_GRPC_EXPORT QGrpcUploadQueue final : public QObject
+{
+    Q_OBJECT
+public:
+    /*!
+     * \brief Function invoked when batch is sent with status of the call
+     */
+    using CompletionHandler = std::function<void(const QGrpcStatus &status)>;
+
+    /*!
+     * \brief Function that sends serialized \a batch of \a count messages and invokes \a done once, when it's sent
+     */
+    using Sender = std::function<void(const QByteArray &batch, int count, const CompletionHandler &done)>;
+
+    /*!
+     * \brief Constructs queue, that keeps messages in memory
+     */
+    QGrpcUploadQueue(const Sender &sender, QObject *parent = nullptr);
+
+    /*!
+     * \brief Constructs queue, that keeps messages in file \a fileName
+     * \details Messages left in file by previous run are sent first. File is memory-mapped when batches are
+     *          taken from it, so messages are not read to memory until they are sent.
+     */
+    QGrpcUploadQueue(const Sender &sender, const QString &fileName, QObject *parent = nullptr);
+    ~QGrpcUploadQueue();
+
+    /*!
+     * \brief Returns false if file of queue can't be opened or written, messages are not accepted in this case
+     */
+    bool isValid() const;
+
+    /*!
+     * \brief Serializes \a message and appends it to queue
+     * \return false if queue is full or invalid, message is not queued in this case
+     */
+    template<typename T>
+    bool enqueue(const T &message) {
+        return enqueueData(serializer()->serialize<T>(&message));
+    }
+
+    /*!
+     * \brief Appends serialized message \a data to queue
+     * \return false if queue is full or invalid, message is not queued in this case
+     */
+    bool enqueueData(const QByteArray &data);
+
+    /*!
+     * \brief Sends queued messages without waiting for batches to be filled
+     */
+    void flush();
+
+    /*!
+     * \brief Sets maximum size of batch in bytes. Batch always has at least one message. Default size is 64 KiB.
+     */
+    void setMaxBatchSize(int size);
+
+    /*!
+     * \brief Returns maximum size of batch in bytes
+     */
+    int maxBatchSize() const;
+
+    /*!
+     * \brief Sets maximum number of messages in batch. Default number is 500.
+     */
+    void setMaxBatchCount(int count);
+
+    /*!
+     * \brief Returns maximum number of messages in batch
+     */
+    int maxBatchCount() const;
+
+    /*!
+     * \brief Sets time, that message waits for batch to be filled. Default delay is 1 second.
+     */
+    void setMaxBatchDelay(std::chrono::milliseconds delay);
+
+    /*!
+     * \brief Returns time, that message waits for batch to be filled
+     */
+    std::chrono::milliseconds maxBatchDelay() const;
+
+    /*!
+     * \brief Sets maximum number of batches sent at the same time. Default number is 2.
+     */
+    void setMaxInFlight(int maxInFlight);
+
+    /*!
+     * \brief Returns maximum number of batches sent at the same time
+     */
+    int maxInFlight() const;
+
+    /*!
+     * \brief Sets maximum size of queued messages in bytes, zero means unlimited queue. Unlimited by default.
+     */
+    void setMaxQueuedSize(qint64 size);
+
+    /*!
+     * \brief Returns maximum size of queued messages in bytes
+     */
+    qint64 maxQueuedSize() const;
+
+    /*!
+     * \brief Sets \a policy of retries of failed batches. nullptr disables retries. Default policy retries
+     *        with exponential backoff without limit of attempts.
+     */
+    void setRetryPolicy(const std::shared_ptr<QGrpcReconnectPolicy> &policy);
+
+    /*!
+     * \brief Returns policy of retries of failed batches
+     */
+    std::shared_ptr<QGrpcReconnectPolicy> retryPolicy() const;
+
+    /*!
+     * \brief Returns number of messages, that are not sent yet
+     */
+    int queuedCount() const;
+
+    /*!
+     * \brief Returns size of log in bytes, that keeps messages, which are not sent yet
+     */
+    qint64 queuedSize() const;
+
+    /*!
+     * \brief Returns number of batches in flight
+     */
+    int inFlightCount() const;
+
+    /*!
+     * \brief Returns number of sent messages
+     */
+    qint64 sentCount() const;
+
+signals:
+    /*!
+     * \brief The signal is emitted when batch of \a count messages is sent
+     */
+    void batchSent(int count);
+
+    /*!
+     * \brief The signal is emitted when batch of \a count messages is dropped, because it failed with \a status
+     *        and retry policy doesn't allow more attempts
+     */
+    void batchDropped(const QtProtobuf::QGrpcStatus &status, int count);
+
+    /*!
+     * \brief The signal is emitted when all queued messages are sent
+     */
+    void drained();
+
+private:
+    Q_DISABLE_COPY_MOVE(QGrpcUploadQueue)
+
+    QAbstractProtobufSerializer *serializer() const;
+    void dispatch();
+    void complete(qint64 begin, const QGrpcStatus &status);
+
+    std::unique_ptr<QGrpcUploadQueuePrivate> dPtr;
+};
+
+}
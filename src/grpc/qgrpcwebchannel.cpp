@@ -0,0 +1,537 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qgrpcwebchannel.h"
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QEventLoop>
+#include <QPointer>
+#include <QTimer>
+
+#include <unordered_map>
+#include <algorithm>
+#include <limits>
+
+#include "qgrpcasyncreply.h"
+#include "qgrpcstream.h"
+#include "qabstractgrpcclient.h"
+#include "qgrpccredentials.h"
+#include "qgrpcframereader_p.h"
+#include "qprotobufserializerregistry_p.h"
+#include "qtprotobuflogging.h"
+
+using namespace QtProtobuf;
+
+namespace  {
+
+const char *GrpcWebContentType = "application/grpc-web";
+const char *ProtobufSerializerId = "protobuf";
+const char *ContentTypeHeader = "content-type";
+const char *AcceptHeader = "accept";
+const char *GrpcWebHeader = "x-grpc-web";
+const char *UserAgentHeader = "x-user-agent";
+const char *UserAgent = "grpc-web-qt";
+const char *GrpcAcceptEncodingHeader = "grpc-accept-encoding";
+const char *GrpcStatusHeader = "grpc-status";
+const char *GrpcStatusMessage = "grpc-message";
+const char *GrpcTimeoutHeader = "grpc-timeout";
+const char *DeadlineExceededProperty = "_q_grpcDeadlineExceeded";
+//grpc-timeout value is limited by 8 digits
+const qint64 GrpcTimeoutMaxValue = 99999999;
+const std::chrono::milliseconds DefaultDeadline(6000);
+
+//gRPC-Web has no default message format, so protobuf one is named explicitly
+QByteArray serializerContentType(const QString &id)
+{
+    return QByteArray(GrpcWebContentType) + '+' + (id == QLatin1String(ProtobufSerializerId) ? QByteArray("proto") : id.toLatin1());
+}
+
+//Returns message format of gRPC-Web \a contentType, protobuf format is returned as "proto"
+QByteArray contentTypeFormat(const QByteArray &contentType)
+{
+    QByteArray type = contentType;
+    const int parametersIndex = type.indexOf(';');
+    if (parametersIndex >= 0) {
+        type.truncate(parametersIndex);
+    }
+    type = type.trimmed().toLower().mid(static_cast<int>(qstrlen(GrpcWebContentType)));
+    if (type.startsWith('+')) {
+        type.remove(0, 1);
+    }
+    return type.isEmpty() ? QByteArray("proto") : type;
+}
+
+//Replies that are not gRPC-Web at all, e.g. error pages of proxies, are left to status handling
+bool isContentTypeAccepted(QNetworkReply *networkReply)
+{
+    const QByteArray contentType = networkReply->rawHeader(ContentTypeHeader);
+    if (!contentType.trimmed().toLower().startsWith(GrpcWebContentType)) {
+        return true;
+    }
+    return contentTypeFormat(contentType)
+            == contentTypeFormat(networkReply->request().header(QNetworkRequest::ContentTypeHeader).toByteArray());
+}
+}
+
+namespace QtProtobuf {
+//! \private
+struct QGrpcWebChannelPrivate {
+    //! \private
+    //! \brief gRPC-Web response, that is decoded while it's still arriving
+    struct WebReply {
+        QGrpcFrameReader reader;
+        //Trailers frame, received at the end of response body
+        QGrpcMetadata trailers;
+        bool trailersReceived = false;
+        bool invalid = false;
+
+        //! \brief Reads received frames and passes messages to \a handler. Reading is stopped, if reply is aborted
+        //!        by handler.
+        template<typename Handler>
+        void read(QIODevice *device, Handler handler) {
+            while (!invalid && device->isOpen() && device->bytesAvailable() > 0) {
+                const QGrpcFrameReader::Status status = reader.read(device);
+                if (status == QGrpcFrameReader::NeedMoreData) {
+                    break;
+                }
+                if (status == QGrpcFrameReader::InvalidFrame || trailersReceived) {
+                    qProtoWarning() << "Invalid gRPC-Web frame received";
+                    invalid = true;
+                    break;
+                }
+                if (reader.trailers) {
+                    parseTrailers(reader.takeMessage());
+                    continue;
+                }
+                if (reader.compressed) {
+                    qProtoWarning() << "Compressed gRPC-Web messages are not supported";
+                    invalid = true;
+                    break;
+                }
+                handler(reader.takeMessage());
+            }
+        }
+
+        //Trailers are encoded like HTTP/1.1 header fields, names are lowercase
+        void parseTrailers(const QByteArray &block) {
+            trailersReceived = true;
+            for (const QByteArray &line : block.split('\n')) {
+                const int separatorIndex = line.indexOf(':');
+                if (separatorIndex > 0) {
+                    trailers.append({line.left(separatorIndex).trimmed().toLower(), line.mid(separatorIndex + 1).trimmed()});
+                }
+            }
+        }
+
+        QByteArray trailer(const char *name) const {
+            for (const auto &entry : trailers) {
+                if (entry.first == name) {
+                    return entry.second;
+                }
+            }
+            return {};
+        }
+
+        //! \brief Returns status of finished \a networkReply
+        //! \details Status is sent in trailers frame, but proxy sends it in headers if there is no response body
+        QGrpcStatus status(QNetworkReply *networkReply) const {
+            if (networkReply->error() != QNetworkReply::NoError) {
+                return {networkReply->property(DeadlineExceededProperty).toBool() ? QGrpcStatus::DeadlineExceeded
+                                                                                  : grpcStatusOfNetworkError(networkReply->error()),
+                        networkReply->errorString()};
+            }
+
+            if (invalid || !reader.isComplete()) {
+                return {QGrpcStatus::Internal, QLatin1String("Invalid gRPC-Web response received")};
+            }
+
+            if (!isContentTypeAccepted(networkReply)) {
+                qProtoWarning() << "gRPC-Web reply of unexpected content type received:" << networkReply->rawHeader(ContentTypeHeader);
+                return {QGrpcStatus::Internal, QLatin1String("Unexpected content type of gRPC-Web response")};
+            }
+
+            const bool trailersOnly = !trailersReceived && networkReply->hasRawHeader(GrpcStatusHeader);
+            const QByteArray statusCode = trailersOnly ? networkReply->rawHeader(GrpcStatusHeader) : trailer(GrpcStatusHeader);
+            if (statusCode.isEmpty()) {
+                return {QGrpcStatus::Internal, QLatin1String("gRPC-Web response has no status")};
+            }
+            const QByteArray statusMessage = trailersOnly ? networkReply->rawHeader(GrpcStatusMessage) : trailer(GrpcStatusMessage);
+            return {static_cast<QGrpcStatus::StatusCode>(statusCode.toInt()),
+                    QString::fromUtf8(QByteArray::fromPercentEncoding(statusMessage))};
+        }
+
+        QGrpcMetadata metadata(QNetworkReply *networkReply) const {
+            return networkReply->rawHeaderPairs() + trailers;
+        }
+    };
+
+    //! \private
+    //! \brief Unary call reply, only the first message is kept
+    struct UnaryReply : WebReply {
+        QByteArray message;
+        int messageCount = 0;
+
+        void read(QIODevice *device) {
+            WebReply::read(device, [this](QByteArray &&received) {
+                if (++messageCount == 1) {
+                    message = std::move(received);
+                }
+            });
+        }
+
+        QGrpcStatus finish(QNetworkReply *networkReply) {
+            read(networkReply);
+            QGrpcStatus result = status(networkReply);
+            if (result.code() == QGrpcStatus::Ok && messageCount != 1) {
+                qProtoWarning() << "Invalid unary reply received, messages:" << messageCount;
+                result = {QGrpcStatus::Internal, QLatin1String("Invalid number of messages in unary reply")};
+            }
+            if (result.code() != QGrpcStatus::Ok) {
+                message.clear();
+            }
+            return result;
+        }
+    };
+
+    QUrl url;
+    std::unique_ptr<QAbstractGrpcCredentials> credentials;
+    QSslConfiguration sslConfig;
+    QNetworkAccessManager manager;
+    QObject lambdaContext;
+    std::chrono::milliseconds defaultDeadline = DefaultDeadline;
+    QString serializerId = QLatin1String(ProtobufSerializerId);
+    QString serializerPlugin;
+    QByteArray contentType = serializerContentType(serializerId);
+
+    static QByteArray grpcTimeout(std::chrono::milliseconds deadline) {
+        qint64 value = deadline.count();
+        if (value <= GrpcTimeoutMaxValue) {
+            return QByteArray::number(value) + 'm';
+        }
+        value = std::min<qint64>(value / 1000, GrpcTimeoutMaxValue);
+        return QByteArray::number(value) + 'S';
+    }
+
+    QNetworkReply *post(const QString &method, const QString &service, const QByteArray &args, bool stream = false) {
+        QUrl callUrl = url;
+        callUrl.setPath(url.path() + "/" + service + "/" + method);
+        qProtoDebug() << "Service call url: " << callUrl;
+
+        QNetworkRequest request(callUrl);
+        request.setHeader(QNetworkRequest::ContentTypeHeader, contentType);
+        request.setRawHeader(AcceptHeader, contentType);
+        request.setRawHeader(GrpcWebHeader, "1");
+        request.setRawHeader(UserAgentHeader, UserAgent);
+        request.setRawHeader(GrpcAcceptEncodingHeader, "identity");
+        const std::chrono::milliseconds callDeadline = stream ? std::chrono::milliseconds::zero() : defaultDeadline;
+        if (callDeadline.count() > 0) {
+            request.setRawHeader(GrpcTimeoutHeader, grpcTimeout(callDeadline));
+        }
+        if (url.scheme() == "https") {
+            request.setSslConfiguration(sslConfig);
+        }
+        const QGrpcCredentialMap callCredentials = credentials->callCredentials();
+        for (auto i = callCredentials.begin(); i != callCredentials.end(); ++i) {
+            request.setRawHeader(i.key().data(), qGrpcCredentialHeaderValue(i.value()));
+        }
+
+        //Message is framed in place, body is the only copy of serialized message
+        QByteArray msg = QProtobufBufferAllocator::current()->allocate(QGrpcFrameReader::HeaderSize + args.size());
+        msg.resize(QGrpcFrameReader::HeaderSize + args.size());
+        msg[0] = 0;
+        qToBigEndian<qint32>(args.size(), msg.data() + 1);
+        std::copy(args.constBegin(), args.constEnd(), msg.begin() + QGrpcFrameReader::HeaderSize);
+        qProtoDebug() << "SEND: " << msg.size();
+
+        QNetworkReply *networkReply = manager.post(request, msg);
+        QObject::connect(networkReply, &QNetworkReply::sslErrors, [networkReply](const QList<QSslError> &errors) {
+           qProtoCritical() << errors;
+           QGrpcWebChannelPrivate::abortNetworkReply(networkReply);
+        });
+
+        if (callDeadline.count() > 0) {
+            QTimer::singleShot(static_cast<int>(std::min<qint64>(callDeadline.count(), std::numeric_limits<int>::max())),
+                               networkReply, [networkReply] {
+                networkReply->setProperty(DeadlineExceededProperty, true);
+                abortNetworkReply(networkReply);
+            });
+        }
+        return networkReply;
+    }
+
+    static void abortNetworkReply(QNetworkReply *networkReply) {
+        if (networkReply->isRunning()) {
+            networkReply->abort();
+        }
+    }
+
+    void call(const QString &method, const QString &service, const QByteArray &args, QGrpcAsyncReply *reply) {
+        QNetworkReply *networkReply = post(method, service, args);
+        QPointer<QGrpcAsyncReply> replyPtr(reply);
+        std::shared_ptr<UnaryReply> unaryReply(new UnaryReply);
+        QObject::connect(networkReply, &QNetworkReply::readyRead, networkReply, [networkReply, unaryReply] {
+            unaryReply->read(networkReply);
+        });
+
+        std::shared_ptr<QMetaObject::Connection> abortConnection(new QMetaObject::Connection);
+        std::shared_ptr<QMetaObject::Connection> destroyedConnection(new QMetaObject::Connection);
+        QObject::connect(networkReply, &QNetworkReply::finished, networkReply, [replyPtr, networkReply, unaryReply, abortConnection, destroyedConnection] {
+            QObject::disconnect(*abortConnection);
+            QObject::disconnect(*destroyedConnection);
+            const QGrpcStatus status = unaryReply->finish(networkReply);
+            networkReply->deleteLater();
+            if (replyPtr.isNull()) {
+                return;
+            }
+
+            replyPtr->setMetadata(unaryReply->metadata(networkReply));
+            if (status.code() == QGrpcStatus::Ok) {
+                replyPtr->setData(unaryReply->message);
+                replyPtr->finished();
+            } else {
+                replyPtr->setData({});
+                replyPtr->error(status);
+            }
+        });
+
+        //Request is aborted, when reply is aborted or abandoned, so proxy cancels call
+        *abortConnection = QObject::connect(reply, &QGrpcAsyncReply::error, networkReply, [networkReply](const QGrpcStatus &status) {
+            if (status.code() == QGrpcStatus::Aborted) {
+                abortNetworkReply(networkReply);
+            }
+        });
+        *destroyedConnection = QObject::connect(reply, &QObject::destroyed, networkReply, [networkReply] {
+            abortNetworkReply(networkReply);
+        });
+    }
+
+    QGrpcWebChannelPrivate(const QUrl &_url, std::unique_ptr<QAbstractGrpcCredentials> _credentials)
+        : url(_url)
+        , credentials(std::move(_credentials))
+    {
+        if (url.scheme() == "https") {
+            if (!credentials->channelCredentials().contains(QLatin1String(SslConfigCredential))) {
+                throw std::invalid_argument("Https connection requested but not ssl configuration provided.");
+            }
+            sslConfig = credentials->channelCredentials().value(QLatin1String(SslConfigCredential)).value<QSslConfiguration>();
+        } else if (url.scheme().isEmpty()) {
+            url.setScheme("http");
+        }
+
+        //Trailing slash of proxy path prefix is removed, method path is appended to it
+        QString path = url.path();
+        while (path.endsWith('/')) {
+            path.chop(1);
+        }
+        url.setPath(path);
+    }
+};
+}
+
+QGrpcWebChannel::QGrpcWebChannel(const QUrl &url, std::unique_ptr<QAbstractGrpcCredentials> credentials) : QAbstractGrpcChannel()
+  , dPtr(std::make_unique<QGrpcWebChannelPrivate>(url, std::move(credentials)))
+{
+}
+
+QGrpcWebChannel::~QGrpcWebChannel()
+{
+}
+
+QGrpcStatus QGrpcWebChannel::call(const QString &method, const QString &service, const QByteArray &args, QByteArray &ret)
+{
+    QEventLoop loop;
+
+    QNetworkReply *networkReply = dPtr->post(method, service, args);
+    QGrpcWebChannelPrivate::UnaryReply unaryReply;
+    QObject::connect(networkReply, &QNetworkReply::readyRead, &loop, [networkReply, &unaryReply] {
+        unaryReply.read(networkReply);
+    });
+    QObject::connect(networkReply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
+
+    //If reply was finished in same stack it doesn't make sense to start event loop
+    if (!networkReply->isFinished()) {
+        loop.exec();
+    }
+
+    const QGrpcStatus status = unaryReply.finish(networkReply);
+    ret = std::move(unaryReply.message);
+    networkReply->deleteLater();
+    qProtoDebug() << __func__ << "RECV: " << ret.toHex() << "grpcStatus" << status.code();
+    return status;
+}
+
+void QGrpcWebChannel::call(const QString &method, const QString &service, const QByteArray &args, QGrpcAsyncReply *reply)
+{
+    assert(reply != nullptr);
+    dPtr->call(method, service, args, reply);
+}
+
+void QGrpcWebChannel::callWithHandler(const QString &method, const QString &service, const QByteArray &args, const CallHandler &handler)
+{
+    QNetworkReply *networkReply = dPtr->post(method, service, args);
+    std::shared_ptr<QGrpcWebChannelPrivate::UnaryReply> unaryReply(new QGrpcWebChannelPrivate::UnaryReply);
+    QObject::connect(networkReply, &QNetworkReply::readyRead, networkReply, [networkReply, unaryReply] {
+        unaryReply->read(networkReply);
+    });
+    QObject::connect(networkReply, &QNetworkReply::finished, networkReply, [networkReply, unaryReply, handler] {
+        const QGrpcStatus status = unaryReply->finish(networkReply);
+        handler(status, unaryReply->message);
+        networkReply->deleteLater();
+    });
+}
+
+void QGrpcWebChannel::subscribe(QGrpcStream *stream, const QString &service, QAbstractGrpcClient *client)
+{
+    assert(stream != nullptr);
+    QNetworkReply *networkReply = dPtr->post(stream->method(), service, stream->arg(), true);
+    std::shared_ptr<QGrpcSpan> span = stream->span();
+    if (span) {
+        span->addEvent(QGrpcSpan::RequestSent);
+    }
+
+    std::shared_ptr<QGrpcWebChannelPrivate::WebReply> webReply(new QGrpcWebChannelPrivate::WebReply);
+    std::shared_ptr<QMetaObject::Connection> finishConnection(new QMetaObject::Connection);
+    std::shared_ptr<QMetaObject::Connection> abortConnection(new QMetaObject::Connection);
+    std::shared_ptr<QMetaObject::Connection> readConnection(new QMetaObject::Connection);
+    std::shared_ptr<QMetaObject::Connection> clientConnection(new QMetaObject::Connection);
+    auto disconnectAll = [finishConnection, abortConnection, readConnection, clientConnection] {
+        QObject::disconnect(*finishConnection);
+        QObject::disconnect(*abortConnection);
+        QObject::disconnect(*readConnection);
+        QObject::disconnect(*clientConnection);
+    };
+
+    //Messages are delivered while response body is still arriving
+    auto readMessages = [networkReply, stream, webReply, span] {
+        if (!isContentTypeAccepted(networkReply)) {
+            //Reply is failed, when it's finished
+            return;
+        }
+
+        if (!stream->isLatestMessageOnly()) {
+            webReply->read(networkReply, [stream, &span](QByteArray &&message) {
+                if (span) {
+                    span->addEvent(QGrpcSpan::MessageReceived);
+                }
+                stream->handler(message);
+                //Message that is not kept by stream is recycled for next frames
+                QProtobufBufferAllocator::current()->release(std::move(message));
+            });
+            return;
+        }
+
+        //Only the last of messages received at once is delivered
+        QByteArray latestMessage;
+        bool received = false;
+        webReply->read(networkReply, [&latestMessage, &received, &span](QByteArray &&message) {
+            if (span) {
+                span->addEvent(QGrpcSpan::MessageReceived);
+            }
+            //Dropped message is recycled
+            QProtobufBufferAllocator::current()->release(std::move(latestMessage));
+            latestMessage = std::move(message);
+            received = true;
+        });
+        if (received) {
+            stream->handler(latestMessage);
+        }
+    };
+
+    *readConnection = QObject::connect(networkReply, &QNetworkReply::readyRead, stream, [span, readMessages, firstRead = true]() mutable {
+        if (span && firstRead) {
+            span->addEvent(QGrpcSpan::FirstByteReceived);
+        }
+        firstRead = false;
+        readMessages();
+    });
+
+    *finishConnection = QObject::connect(networkReply, &QNetworkReply::finished, stream, [networkReply, stream, webReply, readMessages, disconnectAll] {
+        disconnectAll();
+        if (networkReply->error() == QNetworkReply::NoError) {
+            readMessages();
+        }
+        const QGrpcStatus status = webReply->status(networkReply);
+        networkReply->deleteLater();
+
+        if (status.code() == QGrpcStatus::Ok) {
+            stream->finished();
+        } else {
+            stream->error(status);
+        }
+    });
+
+    //Stream is finished by cancel()
+    *abortConnection = QObject::connect(stream, &QGrpcStream::finished, networkReply, [networkReply, disconnectAll] {
+        disconnectAll();
+        QGrpcWebChannelPrivate::abortNetworkReply(networkReply);
+        networkReply->deleteLater();
+    });
+
+    *clientConnection = QObject::connect(client, &QAbstractGrpcClient::destroyed, networkReply, [networkReply, disconnectAll] {
+        disconnectAll();
+        QGrpcWebChannelPrivate::abortNetworkReply(networkReply);
+        networkReply->deleteLater();
+    });
+}
+
+std::shared_ptr<QAbstractProtobufSerializer> QGrpcWebChannel::serializer() const
+{
+    return dPtr->serializerPlugin.isEmpty() ? QProtobufSerializerRegistry::instance().getSerializer(dPtr->serializerId)
+                                            : QProtobufSerializerRegistry::instance().getSerializer(dPtr->serializerId, dPtr->serializerPlugin);
+}
+
+void QGrpcWebChannel::setDefaultDeadline(std::chrono::milliseconds deadline)
+{
+    dPtr->defaultDeadline = deadline;
+}
+
+std::chrono::milliseconds QGrpcWebChannel::defaultDeadline() const
+{
+    return dPtr->defaultDeadline;
+}
+
+bool QGrpcWebChannel::setSerializer(const QString &id, const QString &plugin)
+{
+    if (QProtobufSerializerRegistry::instance().findSerializer(id, plugin) == nullptr) {
+        qProtoWarning() << "Serializer" << id << "of plugin" << plugin << "is not loaded, channel serializer is not changed";
+        return false;
+    }
+    dPtr->serializerId = id;
+    dPtr->serializerPlugin = plugin;
+    dPtr->contentType = serializerContentType(id);
+    return true;
+}
+
+QString QGrpcWebChannel::serializerId() const
+{
+    return dPtr->serializerId;
+}
+
+QByteArray QGrpcWebChannel::contentType() const
+{
+    return dPtr->contentType;
+}
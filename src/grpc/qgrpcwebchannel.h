@@ -0,0 +1,107 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QGrpcWebChannel
+
+#include "qabstractgrpcchannel.h"
+
+#include <QUrl>
+#include <chrono>
+#include <memory>
+
+namespace QtProtobuf {
+
+class QAbstractGrpcCredentials;
+struct QGrpcWebChannelPrivate;
+/*!
+ * \ingroup QtGrpc
+ * \brief The QGrpcWebChannel class is gRPC-Web implementation of QAbstractGrpcChannel interface
+ * \details QGrpcWebChannel makes calls using binary gRPC-Web protocol, that is translated to gRPC by proxy, e.g.
+ *          Envoy with grpc_web filter. Unlike QGrpcHttp2Channel it doesn't require HTTP/2 connection, so it's
+ *          usable where HTTP/2 can't be enforced, e.g. in Qt for WebAssembly applications.
+ *          Messages of reply are read while reply is still arriving, server stream messages are delivered as soon
+ *          as they're received. Trailers of reply are sent by proxy as the last frame of response body, they are
+ *          passed to QGrpcAsyncReply metadata together with response headers.
+ *          gRPC-Web doesn't support client-streaming and bidirectional-streaming calls, such calls fail with
+ *          QGrpcStatus::Unimplemented status. Messages are sent and received uncompressed.
+ *          Channel credentials and call credentials are used the same way as by QGrpcHttp2Channel.
+ */
+class Q_GRPC_EXPORT QGrpcWebChannel final : public QAbstractGrpcChannel
+{
+public:
+    /*!
+     * \brief QGrpcWebChannel constructs QGrpcWebChannel
+     * \param url http/https url of gRPC-Web proxy
+     * \param credentials call/channel credentials pair
+     */
+    QGrpcWebChannel(const QUrl &url, std::unique_ptr<QAbstractGrpcCredentials> credentials);
+    ~QGrpcWebChannel();
+
+    /*!
+     * \details Call made in thread of channel spins nested event loop, that requires asyncify in WebAssembly builds.
+     */
+    QGrpcStatus call(const QString &method, const QString &service, const QByteArray &args, QByteArray &ret) override;
+    void call(const QString &method, const QString &service, const QByteArray &args, QtProtobuf::QGrpcAsyncReply *reply) override;
+    void callWithHandler(const QString &method, const QString &service, const QByteArray &args, const CallHandler &handler) override;
+    void subscribe(QGrpcStream *stream, const QString &service, QAbstractGrpcClient *client) override;
+    std::shared_ptr<QAbstractProtobufSerializer> serializer() const override;
+
+    /*!
+     * \brief Sets deadline of unary calls made using channel. Default deadline is 6 seconds.
+     * \details Deadline is sent to proxy in grpc-timeout header. Call that is not finished until deadline is aborted
+     *          with QGrpcStatus::DeadlineExceeded status. Zero \a deadline disables deadline of calls.
+     */
+    void setDefaultDeadline(std::chrono::milliseconds deadline);
+
+    /*!
+     * \brief Returns deadline of unary calls made using channel
+     */
+    std::chrono::milliseconds defaultDeadline() const;
+
+    /*!
+     * \brief Selects serializer of messages sent and received using channel. Protobuf serializer is used by default.
+     * \details Calls are sent with "application/grpc-web+<id>" content type. Replies of other message format fail
+     *          with QGrpcStatus::Internal status. Serializer is selected before channel is attached to clients.
+     * \return false if serializer is not found, serializer of channel is not changed in this case
+     * \see QGrpcHttp2Channel::setSerializer
+     */
+    bool setSerializer(const QString &id, const QString &plugin = QString());
+
+    /*!
+     * \brief Returns identifier of serializer used by channel
+     */
+    QString serializerId() const;
+
+    /*!
+     * \brief Returns content type of calls made using channel
+     */
+    QByteArray contentType() const;
+
+private:
+    Q_DISABLE_COPY_MOVE(QGrpcWebChannel)
+
+    std::unique_ptr<QGrpcWebChannelPrivate> dPtr;
+};
+}
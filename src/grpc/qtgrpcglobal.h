@@ -68,6 +68,8 @@
 namespace QtProtobuf {
 class QGrpcAsyncReply;
 class QGrpcStream;
+class QGrpcClientStream;
 using QGrpcAsyncReplyShared = std::shared_ptr<QGrpcAsyncReply>;
 using QGrpcStreamShared = std::shared_ptr<QGrpcStream>;
+using QGrpcClientStreamShared = std::shared_ptr<QGrpcClientStream>;
 }
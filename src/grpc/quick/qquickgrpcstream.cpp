@@ -29,13 +29,23 @@
 #include <QGrpcStream>
 #include <QJSEngine>
 #include <QQmlEngine>
+#include <QHash>
 
 using namespace QtProtobuf;
 
 QQuickGrpcStream::QQuickGrpcStream(QObject *parent) : QObject(parent)
   , m_enabled(false)
   , m_returnValue(nullptr)
+  , m_throttleInterval(0)
+  , m_latestOnly(false)
+  , m_messagePending(false)
 {
+    m_throttleTimer.setSingleShot(true);
+    connect(&m_throttleTimer, &QTimer::timeout, this, [this]() {
+        if (m_messagePending) {
+            deliverMessage();
+        }
+    });
 }
 
 QQuickGrpcStream::~QQuickGrpcStream()
@@ -54,11 +64,8 @@ void QQuickGrpcStream::updateStream()
         m_stream.reset();
     }
 
-    if (m_returnValue != nullptr) {
-        m_returnValue->deleteLater(); //TODO: probably need to take care about return value cleanup other way. It's just reminder about weak memory management.
-        m_returnValue = nullptr;
-        returnValueChanged();
-    }
+    m_throttleTimer.stop();
+    m_messagePending = false;
 
     if (m_client.isNull() || m_method.isEmpty() || !m_enabled || m_argument.isNull()) {
         return;
@@ -69,19 +76,62 @@ void QQuickGrpcStream::updateStream()
     }
 }
 
-bool QQuickGrpcStream::subscribe()
-{
-    QString uppercaseMethodName = m_method;
-    uppercaseMethodName.replace(0, 1, m_method[0].toUpper());
-    const QMetaObject *metaObject = m_client->metaObject();
+namespace {
+
+struct StreamMethod {
     QMetaMethod method;
+    const QMetaObject *argumentMetaObject = nullptr;
+    bool returnPointerTypeValid = false;
+    const char *returnClassName = nullptr;
+    int returnMetaType = QMetaType::UnknownType;
+};
+
+//Method lookup is cached per client type and method name. GrpcStream is used from QML thread only, so cache is not guarded.
+StreamMethod resolveStreamMethod(const QMetaObject *metaObject, const QString &methodName)
+{
+    static QHash<QPair<const QMetaObject *, QString>, StreamMethod> cache;
+    const auto key = qMakePair(metaObject, methodName);
+    auto it = cache.constFind(key);
+    if (it != cache.constEnd()) {
+        return *it;
+    }
+
+    QString uppercaseMethodName = methodName;
+    uppercaseMethodName.replace(0, 1, methodName[0].toUpper());
+    const QByteArray qmlMethodName = QString("qmlSubscribe%1_p").arg(uppercaseMethodName).toLatin1();
+
+    StreamMethod result;
     for (int i = 0; i < metaObject->methodCount(); i++) {
-        if (QString("qmlSubscribe%1_p").arg(uppercaseMethodName) == metaObject->method(i).name()) {
-            method = metaObject->method(i);
+        if (qmlMethodName == metaObject->method(i).name()) {
+            result.method = metaObject->method(i);
             break;
         }
     }
 
+    if (result.method.isValid() && result.method.parameterCount() >= 2) {
+        result.argumentMetaObject = QMetaType(result.method.parameterType(0)).metaObject();
+        QMetaType returnPointerType(result.method.parameterType(1));
+        result.returnPointerTypeValid = returnPointerType.isValid();
+        if (result.returnPointerTypeValid && returnPointerType.metaObject() != nullptr) {
+            result.returnClassName = returnPointerType.metaObject()->className();
+            result.returnMetaType = QMetaType::type(result.returnClassName);
+        }
+    }
+
+    //Types might be registered later, so unresolved methods are looked up again next time
+    if (result.returnMetaType != QMetaType::UnknownType) {
+        cache.insert(key, result);
+    }
+    return result;
+}
+
+}
+
+bool QQuickGrpcStream::subscribe()
+{
+    const StreamMethod streamMethod = resolveStreamMethod(m_client->metaObject(), m_method);
+    const QMetaMethod &method = streamMethod.method;
+
     QString errorString;
     if (!method.isValid()) {
         errorString = m_method + "is not either server or bidirectional stream.";
@@ -97,57 +147,46 @@ bool QQuickGrpcStream::subscribe()
         return false;
     }
 
-    QMetaType argumentPointerMetaType(method.parameterType(0));
-    if (argumentPointerMetaType.metaObject() != m_argument->metaObject()) {
+    if (streamMethod.argumentMetaObject != m_argument->metaObject()) {
         errorString = QString("Unable to call ") + method.name() + ". Argument type mismatch: '" + method.parameterTypes().at(0) + "' expected, '" + m_argument->metaObject()->className() + "' provided";
         qProtoWarning() << errorString;
         error({QGrpcStatus::InvalidArgument, errorString});
         return false;
     }
 
-    QMetaType argumentMetaType(QMetaType::type(m_argument->metaObject()->className()));
-    if (!argumentMetaType.isValid()) {
-        errorString = QString("Argument of type '") + m_argument->metaObject()->className() + "' is not registred in metatype system";
-        qProtoWarning() << errorString;
-        error({QGrpcStatus::InvalidArgument, errorString});
-        return false;
-    }
-
-    QObject *argument = reinterpret_cast<QObject*>(argumentMetaType.create(m_argument));
-    if (argument == nullptr) {
-        errorString = "Unable to create argument copy. Unknown metatype system error";
-        qProtoWarning() << errorString;
-        error({QGrpcStatus::InvalidArgument, errorString});
-        return false;
-    }
-    argument->deleteLater(); //TODO: probably need to take care about temporary argument value cleanup other way. It's just reminder about weak memory management.
+    //Argument is serialized synchronously by subscribe call, so it's passed without copying
+    QObject *argument = m_argument.data();
 
-    QMetaType returnPointerType(method.parameterType(1));
-    if (!returnPointerType.isValid()) {
+    if (!streamMethod.returnPointerTypeValid) {
         errorString = QString("Return type argument of type '") + method.parameterTypes().at(1) + "' is not registred in metatype system";
         qProtoWarning() << errorString;
         error({QGrpcStatus::InvalidArgument, errorString});
         return false;
     }
 
-    QMetaType returnMetaType(QMetaType::type(returnPointerType.metaObject()->className()));
+    QMetaType returnMetaType(streamMethod.returnMetaType);
     if (!returnMetaType.isValid()) {
-        errorString = QString("Unable to allocate return value. '") + returnPointerType.metaObject()->className() + "' is not registred in metatype system";
+        errorString = QString("Unable to allocate return value. '") + streamMethod.returnClassName + "' is not registred in metatype system";
         qProtoWarning() << errorString;
         error({QGrpcStatus::InvalidArgument, errorString});
         return false;
     }
 
-    m_returnValue = reinterpret_cast<QObject*>(returnMetaType.create());
-    qmlEngine(this)->setObjectOwnership(m_returnValue, QQmlEngine::CppOwnership);
-
-    returnValueChanged();
+    //Return value is kept while stream is re-initialized with the same return type, messages are deserialized into it in place
+    if (m_returnValue == nullptr || qstrcmp(m_returnValue->metaObject()->className(), streamMethod.returnClassName) != 0) {
+        if (m_returnValue != nullptr) {
+            m_returnValue->deleteLater();
+        }
+        m_returnValue = reinterpret_cast<QObject*>(returnMetaType.create());
+        returnValueChanged();
 
-    if (m_returnValue == nullptr) {
-        errorString = "Unable to allocate return value. Unknown metatype system error";
-        qProtoWarning() << errorString;
-        error({QGrpcStatus::Unknown, errorString});
-        return false;
+        if (m_returnValue == nullptr) {
+            errorString = "Unable to allocate return value. Unknown metatype system error";
+            qProtoWarning() << errorString;
+            error({QGrpcStatus::Unknown, errorString});
+            return false;
+        }
+        qmlEngine(this)->setObjectOwnership(m_returnValue, QQmlEngine::CppOwnership);
     }
 
     QGrpcStreamShared stream = nullptr;
@@ -164,13 +203,40 @@ bool QQuickGrpcStream::subscribe()
 
     m_stream = stream;
 
-    connect(m_stream.get(), &QGrpcStream::messageReceived, this, [this](){
-        messageReceived(qjsEngine(this)->toScriptValue(m_returnValue));
-    });
+    connect(m_stream.get(), &QGrpcStream::messageReceived, this, &QQuickGrpcStream::onMessageReceived);
 
     connect(m_stream.get(), &QGrpcStream::error, this, &QQuickGrpcStream::error);//TODO: Probably it's good idea to disable stream here
 
-    connect(m_stream.get(), &QGrpcStream::finished, this, [this](){ m_stream.reset(); setEnabled(false); });
+    connect(m_stream.get(), &QGrpcStream::finished, this, [this](){
+        if (m_messagePending) {
+            m_messagePending = false;
+            messageReceived(qjsEngine(this)->toScriptValue(m_returnValue));
+        }
+        m_stream.reset();
+        setEnabled(false);
+    });
 
     return true;
 }
+
+void QQuickGrpcStream::onMessageReceived()
+{
+    if (m_throttleInterval <= 0 && !m_latestOnly) {
+        messageReceived(qjsEngine(this)->toScriptValue(m_returnValue));
+        return;
+    }
+
+    //Return value is updated in place, so pending message is always the latest one
+    if (m_throttleTimer.isActive()) {
+        m_messagePending = true;
+        return;
+    }
+    deliverMessage();
+}
+
+void QQuickGrpcStream::deliverMessage()
+{
+    m_messagePending = false;
+    m_throttleTimer.start(m_throttleInterval);
+    messageReceived(qjsEngine(this)->toScriptValue(m_returnValue));
+}
@@ -26,6 +26,7 @@
 #pragma once
 
 #include <QObject>
+#include <QTimer>
 #include <QAbstractGrpcClient>
 #include <QGrpcStatus>
 
@@ -56,7 +57,18 @@
  * \details Pointer to argument that will be used for stream.
  *
  * \subsubsection returnValue QObject *returnValue
- * \details Value returned by the stream (Note that it is the same "return" object passed by the "updated" signal)
+ * \details Value returned by the stream (Note that it is the same "return" object passed by the "updated" signal).
+ * Object is kept when stream is re-initialized with the same return type and each received message is deserialized
+ * into it in place, reusing its nested objects.
+ *
+ * \subsubsection throttleInterval int throttleInterval
+ * \details Minimal interval in milliseconds between two messageReceived signals. Messages received within interval are
+ * coalesced and only the latest one is delivered when interval elapses. Pending message is delivered before stream finishes.
+ * 0 by default, that means no throttling.
+ *
+ * \subsubsection latestOnly bool latestOnly
+ * \details If set to 'true' messages received within one event loop iteration are coalesced and only the latest one is delivered.
+ * Useful for high-rate streams, where handling of each message in QML is not required. 'false' by default.
  *
  * \subsection Signals
  * \subsubsection updated messageReceived(ReturnType value)
@@ -101,6 +113,8 @@ class QQuickGrpcStream : public QObject
     Q_PROPERTY(QString method READ method WRITE setMethod NOTIFY methodChanged)
     Q_PROPERTY(QObject *argument READ argument WRITE setArgument NOTIFY argumentChanged)
     Q_PROPERTY(QObject *returnValue READ returnValue NOTIFY returnValueChanged)
+    Q_PROPERTY(int throttleInterval READ throttleInterval WRITE setThrottleInterval NOTIFY throttleIntervalChanged)
+    Q_PROPERTY(bool latestOnly READ latestOnly WRITE setLatestOnly NOTIFY latestOnlyChanged)
 
 public:
     QQuickGrpcStream(QObject *parent = nullptr);
@@ -126,6 +140,14 @@ public:
         return m_returnValue;
     }
 
+    int throttleInterval() const {
+        return m_throttleInterval;
+    }
+
+    bool latestOnly() const {
+        return m_latestOnly;
+    }
+
     void setClient(QAbstractGrpcClient *client) {
         if (m_client == client) {
             return;
@@ -166,6 +188,25 @@ public:
         updateStream();
     }
 
+    void setThrottleInterval(int throttleInterval) {
+        throttleInterval = qMax(0, throttleInterval);
+        if (m_throttleInterval == throttleInterval) {
+            return;
+        }
+
+        m_throttleInterval = throttleInterval;
+        emit throttleIntervalChanged();
+    }
+
+    void setLatestOnly(bool latestOnly) {
+        if (m_latestOnly == latestOnly) {
+            return;
+        }
+
+        m_latestOnly = latestOnly;
+        emit latestOnlyChanged();
+    }
+
 signals:
     void messageReceived(const QJSValue &value);
     void error(const QtProtobuf::QGrpcStatus &status);
@@ -175,16 +216,24 @@ signals:
     void enabledChanged();
     void argumentChanged();
     void returnValueChanged();
+    void throttleIntervalChanged();
+    void latestOnlyChanged();
 
 private:
     void updateStream();
     bool subscribe();
+    void onMessageReceived();
+    void deliverMessage();
     QPointer<QAbstractGrpcClient> m_client;
     bool m_enabled;
     QString m_method;
     QPointer<QObject> m_argument;
     std::shared_ptr<QGrpcStream> m_stream;
     QObject *m_returnValue;
+    int m_throttleInterval;
+    bool m_latestOnly;
+    bool m_messagePending;
+    QTimer m_throttleTimer;
 };
 
 }
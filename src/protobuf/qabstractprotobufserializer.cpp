@@ -26,44 +26,28 @@
 #include <QMetaProperty>
 #include <QVariant>
 #include <QMetaObject>
-#include <QMutex>
-#include <QSemaphore>
+#include <QIODevice>
 
 #include "qabstractprotobufserializer.h"
+#include "qprotobufdispatchtable_p.h"
+#include "qprotobuffieldplan_p.h"
 
 using namespace QtProtobuf;
 
 namespace  {
 
-const int MaximumSimultaniousThreads = 64;
 /*!
  * \private
  * \brief The HandlersRegistry is container to store mapping between metatype identifier and serialization handlers.
  */
 struct HandlersRegistry {
-
-    HandlersRegistry() : m_readLock(MaximumSimultaniousThreads) {
-
+    void registerHandler(int userType, const QtProtobufPrivate::SerializationHandler &handlers) {
+        m_registry.insert(userType, handlers);
     }
 
-    void registerHandler(int userType, const QtProtobufPrivate::SerializationHandler &handlers) {
-        QMutexLocker locker(&m_writeLock);
-        QSemaphoreReleaser releaser(m_readLock, MaximumSimultaniousThreads);
-        m_readLock.acquire(MaximumSimultaniousThreads);
-        m_registry[userType] = handlers;
-    }
-
-    QtProtobufPrivate::SerializationHandler findHandler(int userType) {
-        auto handler = empty;
-        QMutexLocker locker(&m_writeLock);
-        QSemaphoreReleaser releaser(m_readLock, 1);
-        m_readLock.acquire();
-        locker.unlock();
-        auto it = m_registry.find(userType);
-        if (it != m_registry.end()) {
-            handler = it->second;
-        }
-        return handler;
+    const QtProtobufPrivate::SerializationHandler &findHandler(int userType) {
+        const QtProtobufPrivate::SerializationHandler *handler = m_registry.find(userType);
+        return handler != nullptr ? *handler : empty;
     }
 
     static HandlersRegistry &instance() {
@@ -71,13 +55,11 @@ struct HandlersRegistry {
         return _instance;
     }
 private:
-    QSemaphore m_readLock;
-    QMutex m_writeLock;
-    std::unordered_map<int/*metatypeid*/, QtProtobufPrivate::SerializationHandler> m_registry;
-    static QtProtobufPrivate::SerializationHandler empty;
+    QtProtobufPrivate::DispatchTable<QtProtobufPrivate::SerializationHandler> m_registry;
+    static const QtProtobufPrivate::SerializationHandler empty;
 };
 
-QtProtobufPrivate::SerializationHandler HandlersRegistry::empty{};
+const QtProtobufPrivate::SerializationHandler HandlersRegistry::empty{};
 }
 
 void QtProtobufPrivate::registerHandler(int userType, const QtProtobufPrivate::SerializationHandler &handlers)
@@ -85,7 +67,256 @@ void QtProtobufPrivate::registerHandler(int userType, const QtProtobufPrivate::S
     HandlersRegistry::instance().registerHandler(userType, handlers);
 }
 
-QtProtobufPrivate::SerializationHandler QtProtobufPrivate::findHandler(int userType)
+const QtProtobufPrivate::SerializationHandler &QtProtobufPrivate::findHandler(int userType)
 {
     return HandlersRegistry::instance().findHandler(userType);
 }
+
+namespace {
+//Lists recycled by MessageReuseScope, storage is kept between scopes, so steady state doesn't allocate
+struct RecycledList {
+    QVariant list;
+    int next;//Position of next element to reuse, -1 if list is exhausted
+};
+thread_local int messageReuseDepth = 0;
+thread_local std::vector<RecycledList> recycledLists;
+}
+
+QtProtobufPrivate::MessageReuseScope::MessageReuseScope()
+{
+    ++messageReuseDepth;
+}
+
+QtProtobufPrivate::MessageReuseScope::~MessageReuseScope()
+{
+    if (--messageReuseDepth == 0) {
+        recycledLists.clear();
+    }
+}
+
+bool QtProtobufPrivate::MessageReuseScope::isActive()
+{
+    return messageReuseDepth > 0;
+}
+
+void QtProtobufPrivate::MessageReuseScope::recycleLists(QObject *object, const QProtobufMetaObject &metaObject)
+{
+    if (messageReuseDepth == 0) {
+        return;
+    }
+
+    for (const auto &field : metaObject.fieldPlan().fields) {
+        //Lists of value types are registered with message meta-object too, but they are never taken back
+        const SerializationHandler &handler = findHandler(field.userType);
+        if (handler.type == ListHandler && handler.metaObject != nullptr) {
+            recycledLists.push_back({field.metaProperty.read(object), 0});
+        }
+    }
+}
+
+const QVariant *QtProtobufPrivate::MessageReuseScope::findRecycled(int listType, int *&next)
+{
+    for (auto &recycled : recycledLists) {
+        if (recycled.next >= 0 && recycled.list.userType() == listType) {
+            next = &recycled.next;
+            return &recycled.list;
+        }
+    }
+    return nullptr;
+}
+
+namespace {
+thread_local quint64 senderSchemaFingerprint = 0;
+}
+
+QtProtobufPrivate::SchemaFingerprintScope::SchemaFingerprintScope(quint64 senderFingerprint) : m_previous(senderSchemaFingerprint)
+{
+    senderSchemaFingerprint = senderFingerprint;
+}
+
+QtProtobufPrivate::SchemaFingerprintScope::~SchemaFingerprintScope()
+{
+    senderSchemaFingerprint = m_previous;
+}
+
+quint64 QtProtobufPrivate::SchemaFingerprintScope::current()
+{
+    return senderSchemaFingerprint;
+}
+
+namespace {
+thread_local bool collectDeserializationErrors = false;
+thread_local DeserializationError currentDeserializationError = NoDeserializationError;
+
+void appendVarint(QByteArray &buffer, uint32_t value)
+{
+    while (value >= 0x80) {
+        buffer.append(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    buffer.append(static_cast<char>(value));
+}
+
+//Returns false if data ends in the middle of varint
+bool readVarint(const QByteArray &data, int &position, uint32_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 35 && position < data.size(); shift += 7) {
+        const uint8_t byte = static_cast<uint8_t>(data.at(position++));
+        value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+}
+
+void QtProtobufPrivate::reportDeserializationError(DeserializationError error, const char *message)
+{
+#ifndef QT_PROTOBUF_NO_EXCEPTIONS
+    if (!collectDeserializationErrors) {
+        if (error == UnexpectedEndOfStreamError) {
+            throw std::out_of_range(message);
+        }
+        throw std::invalid_argument(message);
+    }
+#endif
+    qProtoWarning() << message;
+    if (currentDeserializationError == NoDeserializationError) {
+        currentDeserializationError = error;
+    }
+}
+
+DeserializationError QtProtobufPrivate::deserializationError()
+{
+    return currentDeserializationError;
+}
+
+QtProtobufPrivate::DeserializationErrorScope::DeserializationErrorScope() : m_wasCollecting(collectDeserializationErrors)
+  , m_previousError(currentDeserializationError)
+{
+    collectDeserializationErrors = true;
+    currentDeserializationError = NoDeserializationError;
+}
+
+QtProtobufPrivate::DeserializationErrorScope::~DeserializationErrorScope()
+{
+    //Outer scope is interested in first error happened inside of nested one
+    if (!m_wasCollecting || m_previousError != NoDeserializationError) {
+        currentDeserializationError = m_previousError;
+    }
+    collectDeserializationErrors = m_wasCollecting;
+}
+
+DeserializationError QtProtobufPrivate::DeserializationErrorScope::error() const
+{
+    return currentDeserializationError;
+}
+
+bool QAbstractProtobufSerializer::serializeMessageTo(const QObject *object, const QProtobufMetaObject &metaObject, QIODevice *device) const
+{
+    const QByteArray result = serializeMessage(object, metaObject);
+    return device->write(result) == result.size();
+}
+
+QByteArray QAbstractProtobufSerializer::serializeMessages(const std::vector<const QObject *> &objects, const QProtobufMetaObject &metaObject) const
+{
+    QByteArray result;
+    for (const QObject *object : objects) {
+        const QByteArray message = serializeMessage(object, metaObject);
+        appendVarint(result, static_cast<uint32_t>(message.size()));
+        result.append(message);
+    }
+    return result;
+}
+
+QByteArray QAbstractProtobufSerializer::serializeMessageFields(const QObject *object, const QProtobufMetaObject &metaObject,
+                                                               const quint32 *fields) const
+{
+    Q_UNUSED(fields)
+    return serializeMessage(object, metaObject);
+}
+
+QByteArray QAbstractProtobufSerializer::serializeMessageDelta(const QObject *object, const QProtobufMetaObject &metaObject) const
+{
+    const quint32 *dirtyFields = metaObject.dirtyFieldsOf(object);
+
+    //Field numbers are listed in property ordering, same as bits of dirty fields
+    QByteArray fieldNumbers;
+    size_t index = 0;
+    for (const auto &field : metaObject.propertyOrdering) {
+        if (dirtyFields == nullptr || (dirtyFields[index / 32] & (quint32(1) << (index % 32))) != 0) {
+            appendVarint(fieldNumbers, static_cast<uint32_t>(field.first));
+        }
+        ++index;
+    }
+
+    QByteArray result;
+    appendVarint(result, static_cast<uint32_t>(fieldNumbers.size()));
+    result.append(fieldNumbers);
+    if (!fieldNumbers.isEmpty()) {
+        result.append(dirtyFields != nullptr ? serializeMessageFields(object, metaObject, dirtyFields)
+                                             : serializeMessage(object, metaObject));
+    }
+    return result;
+}
+
+bool QAbstractProtobufSerializer::deserializeMessageDelta(QObject *object, const QProtobufMetaObject &metaObject, const QByteArray &data,
+                                                          QProtobufFieldMask &fields) const
+{
+    int position = 0;
+    QByteArray fieldNumbers;
+    if (!QtProtobufPrivate::readDelimitedMessage(data, position, fieldNumbers)) {
+        return QtProtobufPrivate::deserializationError() == NoDeserializationError;
+    }
+
+    int fieldPosition = 0;
+    while (fieldPosition < fieldNumbers.size()) {
+        uint32_t fieldNumber = 0;
+        if (!readVarint(fieldNumbers, fieldPosition, fieldNumber) || fieldNumber == 0 || fieldNumber > 536870911) {
+            QtProtobufPrivate::reportDeserializationError(InvalidFormatError, "Invalid field number in message delta");
+            return false;
+        }
+        fields.add(static_cast<int>(fieldNumber));
+    }
+
+    deserializeMessage(object, metaObject, QByteArray::fromRawData(data.constData() + position, data.size() - position));
+    return QtProtobufPrivate::deserializationError() == NoDeserializationError;
+}
+
+bool QtProtobufPrivate::readDelimitedMessage(const QByteArray &data, int &position, QByteArray &message)
+{
+    if (position >= data.size()) {
+        return false;
+    }
+
+    //Size of message is uint32 varint, that takes 5 bytes at most
+    uint64_t size = 0;
+    int shift = 0;
+    while (true) {
+        if (position >= data.size()) {
+            reportDeserializationError(UnexpectedEndOfStreamError, "Unexpected end of data in message size");
+            return false;
+        }
+        if (shift > 28) {
+            reportDeserializationError(InvalidFormatError, "Message size is too long");
+            return false;
+        }
+        const uint8_t byte = static_cast<uint8_t>(data.at(position++));
+        size |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        shift += 7;
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+
+    if (size > static_cast<uint64_t>(data.size() - position)) {
+        reportDeserializationError(UnexpectedEndOfStreamError, "Message is truncated");
+        return false;
+    }
+
+    message = QByteArray::fromRawData(data.constData() + position, static_cast<int>(size));
+    position += static_cast<int>(size);
+    return true;
+}
@@ -28,17 +28,118 @@
 #include <QObject>
 #include <QVariant>
 #include <QMetaObject>
+#include <QSignalBlocker>
+#include <QSharedPointer>
 
 #include <unordered_map>
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "qtprotobuftypes.h"
 #include "qtprotobuflogging.h"
 #include "qprotobufselfcheckiterator.h"
+#include "qprotobufarena.h"
+#include "qprotobuffieldmask.h"
+#include "qprotobufserializerstatistics.h"
 
 #include "qtprotobufglobal.h"
 
+QT_FORWARD_DECLARE_CLASS(QIODevice)
+
+namespace QtProtobuf {
+class QProtobufMetaObject;
+}
+
+namespace QtProtobufPrivate {
+/*!
+ * \private
+ * \brief Reads view to the next varint length-prefixed message in \a data starting from \a position
+ *
+ * \details \a position is moved to the next message. Invalid prefix is reported as deserialization error.
+ * \return false if there is no more messages in \a data or if prefix is invalid
+ */
+extern Q_PROTOBUF_EXPORT bool readDelimitedMessage(const QByteArray &data, int &position, QByteArray &message);
+
+/*!
+ * \private
+ * \brief Registers generated message type T with types of its fields, unless it's already registered
+ */
+template<typename T>
+auto ensureTypesRegistered(int) -> decltype(T::ensureTypesRegistered()) {
+    T::ensureTypesRegistered();
+}
+
+//! \private Manually written message types are registered by user
+template<typename T>
+void ensureTypesRegistered(long) {}
+
+/*!
+ * \private
+ * \brief The MessageReuseScope class enables reuse of elements of repeated message fields deserialized in current
+ *        thread while scope is alive
+ *
+ * \details Lists of messages are recycled before message is cleared. Deserializer of list takes elements of
+ *          recycled list of the same type instead of allocation of new ones, so messages of the same shape are
+ *          deserialized without allocations. Elements that were not reused are released when outermost scope ends.
+ */
+class Q_PROTOBUF_EXPORT MessageReuseScope
+{
+public:
+    MessageReuseScope();
+    ~MessageReuseScope();
+
+    //! \brief Returns true if scope is alive in current thread
+    static bool isActive();
+
+    /*!
+     * \brief Keeps lists of messages stored in \a object to be reused by deserializer
+     * \note Fields of message types are not visited, to not materialize them. Nested messages are
+     *       reused by clear of parent anyway.
+     */
+    static void recycleLists(QObject *object, const QtProtobuf::QProtobufMetaObject &metaObject);
+
+    //! \brief Returns recycled element of list of type V or nullptr if there is nothing to reuse
+    template<typename V>
+    static QSharedPointer<V> takeRecycled() {
+        const int listType = qMetaTypeId<QList<QSharedPointer<V>>>();
+        int *next = nullptr;
+        while (const QVariant *recycled = findRecycled(listType, next)) {
+            const auto &list = *static_cast<const QList<QSharedPointer<V>> *>(recycled->constData());
+            if (*next < list.size()) {
+                return list.at((*next)++);
+            }
+            *next = -1;//List is exhausted
+        }
+        return {};
+    }
+private:
+    Q_DISABLE_COPY_MOVE(MessageReuseScope)
+    //Returns recycled list of \a listType that is not exhausted yet and position of its next element
+    static const QVariant *findRecycled(int listType, int *&next);
+};
+
+/*!
+ * \private
+ * \brief The SchemaFingerprintScope class sets schema fingerprint of sender of messages deserialized in current
+ *        thread while scope is alive
+ *
+ * \details Messages which schema fingerprint matches the sender's one are decoded by generated ordered deserializer.
+ */
+class Q_PROTOBUF_EXPORT SchemaFingerprintScope
+{
+public:
+    explicit SchemaFingerprintScope(quint64 senderFingerprint);
+    ~SchemaFingerprintScope();
+
+    //! \brief Returns fingerprint of the innermost scope alive in current thread, 0 if there is no scope
+    static quint64 current();
+private:
+    Q_DISABLE_COPY_MOVE(SchemaFingerprintScope)
+    quint64 m_previous;
+};
+}
+
 namespace QtProtobuf {
 
 class QProtobufMetaProperty;
@@ -82,7 +183,81 @@ public:
     QByteArray serialize(const QObject *object) {
         Q_ASSERT(object != nullptr);
         qProtoDebug() << T::staticMetaObject.className() << "serialize";
-        return serializeMessage(object, T::protobufMetaObject);
+        QtProtobufPrivate::ensureTypesRegistered<T>(0);
+        QtProtobufPrivate::StatisticsScope statistics(T::staticMetaObject.className(),
+                                                      QtProtobufPrivate::StatisticsScope::Serialize);
+        QByteArray result = serializeMessage(object, T::protobufMetaObject);
+        statistics.setOutputBytes(result.size());
+        return result;
+    }
+
+    /*!
+     * \brief Serialization of a registered qtproto message object into \a device
+     *
+     * \details Serializers that support streaming write message to \a device by chunks, so serialized message
+     *          is never resident in memory entirely.
+     *
+     * \param[in] object Pointer to QObject containing message to be serialized
+     * \param[in] device Opened for writing device where serialized message is written
+     * \result true if whole message was written to \a device
+     */
+    template<typename T>
+    bool serializeTo(const QObject *object, QIODevice *device) {
+        Q_ASSERT(object != nullptr);
+        Q_ASSERT(device != nullptr);
+        qProtoDebug() << T::staticMetaObject.className() << "serializeTo";
+        QtProtobufPrivate::ensureTypesRegistered<T>(0);
+        return serializeMessageTo(object, T::protobufMetaObject, device);
+    }
+
+    /*!
+     * \brief Serialization of multiple registered qtproto message objects of the same type into byte-array
+     *
+     * \details Messages are written back-to-back, each one is prefixed with its size encoded as varint. Serializers
+     *          may prepare serialization once for all messages and allocate resulting byte-array once.
+     *
+     * \param[in] messages Messages to be serialized
+     * \result serialized messages bytes
+     * \see deserializeBatch
+     */
+    template<typename T>
+    QByteArray serializeBatch(const QList<T *> &messages) {
+        qProtoDebug() << T::staticMetaObject.className() << "serializeBatch" << messages.count();
+        QtProtobufPrivate::ensureTypesRegistered<T>(0);
+        std::vector<const QObject *> objects;
+        objects.reserve(messages.count());
+        for (const T *message : messages) {
+            Q_ASSERT(message != nullptr);
+            objects.push_back(message);
+        }
+        return serializeMessages(objects, T::protobufMetaObject);
+    }
+
+    /*!
+     * \brief Deserialization of byte-array created by serializeBatch into list of qtproto message objects
+     *
+     * \details Messages are created in current arena, if any. Deserialization is stopped at first invalid message.
+     *
+     * \param[in] data Bytes with serialized messages
+     * \result deserialized messages
+     */
+    template<typename T>
+    QList<QSharedPointer<T>> deserializeBatch(const QByteArray &data) {
+        qProtoDebug() << T::staticMetaObject.className() << "deserializeBatch";
+        QtProtobufPrivate::ensureTypesRegistered<T>(0);
+        QList<QSharedPointer<T>> result;
+        int position = 0;
+        QByteArray messageData;
+        while (QtProtobufPrivate::deserializationError() == NoDeserializationError
+               && QtProtobufPrivate::readDelimitedMessage(data, position, messageData)) {
+            QSharedPointer<T> message = QtProtobufPrivate::createSharedMessage<T>();
+            {
+                const QSignalBlocker blocker(message.data());
+                deserializeMessage(message.data(), T::protobufMetaObject, messageData);
+            }
+            result.append(message);
+        }
+        return result;
     }
 
     /*!
@@ -98,16 +273,313 @@ public:
     void deserialize(T *object, const QByteArray &data) {
         Q_ASSERT(object != nullptr);
         qProtoDebug() << T::staticMetaObject.className() << "deserialize";
+        QtProtobufPrivate::ensureTypesRegistered<T>(0);
+        QtProtobufPrivate::StatisticsScope statistics(T::staticMetaObject.className(),
+                                                      QtProtobufPrivate::StatisticsScope::Deserialize, data.size());
         //Initialize default object first and make copy aferwards, it's necessary to set default
-        //values of properties that was not stored in data.
+        //values of properties that was not stored in data. Change signals are emitted by assignment
+        //to \a object only, so they are blocked for intermediate object.
         T newValue;
+        newValue.blockSignals(true);
+#ifndef QT_PROTOBUF_NO_EXCEPTIONS
         try {
             deserializeMessage(&newValue, T::protobufMetaObject, data);
         } catch(...) {
-            *object = newValue;
+            statistics.errorOccurred();
+            *object = std::move(newValue);
             throw;
         }
-        *object = newValue;
+#else
+        {
+            QtProtobufPrivate::DeserializationErrorScope scope;
+            deserializeMessage(&newValue, T::protobufMetaObject, data);
+            if (scope.error() != NoDeserializationError) {
+                statistics.errorOccurred();
+            }
+        }
+#endif
+        *object = std::move(newValue);
+    }
+
+    /*!
+     * \brief Deserialization of a byte-array directly into a registered qtproto message object
+     *
+     * \details Unlike deserialize(), \a object is not reset, fields that are not stored in \a data keep their values.
+     *          Use it with default constructed objects to decode message without intermediate instance and copy.
+     *          In case of error \a object contains fields that were deserialized before error happened.
+     *
+     * \param[out] object Pointer to default constructed object where message is deserialized
+     * \param[in] data Bytes with serialized message
+     */
+    template<typename T>
+    void deserializeInPlace(T *object, const QByteArray &data) {
+        Q_ASSERT(object != nullptr);
+        qProtoDebug() << T::staticMetaObject.className() << "deserializeInPlace";
+        QtProtobufPrivate::ensureTypesRegistered<T>(0);
+        QtProtobufPrivate::StatisticsScope statistics(T::staticMetaObject.className(),
+                                                      QtProtobufPrivate::StatisticsScope::Deserialize, data.size());
+#ifndef QT_PROTOBUF_NO_EXCEPTIONS
+        try {
+            deserializeMessage(object, T::protobufMetaObject, data);
+        } catch(...) {
+            statistics.errorOccurred();
+            throw;
+        }
+#else
+        QtProtobufPrivate::DeserializationErrorScope scope;
+        deserializeMessage(object, T::protobufMetaObject, data);
+        if (scope.error() != NoDeserializationError) {
+            statistics.errorOccurred();
+        }
+#endif
+    }
+
+    /*!
+     * \brief Deserialization of a byte-array into a registered qtproto message object, reusing objects that
+     *        \a object holds already
+     *
+     * \details \a object is cleared and \a data is deserialized into it in place. Nested messages are kept by clear,
+     *          elements of repeated message fields are taken from previous content of \a object, so a long-living
+     *          object that receives messages of the same shape, e.g. return value of stream, reaches state where
+     *          no message objects are allocated. Unlike deserialize(), change signals are emitted by \a object
+     *          and reused elements during deserialization.
+     *
+     * \param[out] object Pointer to object where message is deserialized
+     * \param[in] data Bytes with serialized message
+     */
+    template<typename T>
+    void deserializeReusing(T *object, const QByteArray &data) {
+        Q_ASSERT(object != nullptr);
+        QtProtobufPrivate::ensureTypesRegistered<T>(0);
+        QtProtobufPrivate::MessageReuseScope reuseScope;
+        QtProtobufPrivate::MessageReuseScope::recycleLists(object, T::protobufMetaObject);
+        object->clear();
+        deserializeInPlace(object, data);
+    }
+
+    /*!
+     * \brief Serialization of value type generated with VALUE option into byte-array
+     *
+     * \details Value is serialized using meta-object of its message type, so wire format is the same as for
+     *          message. Code that doesn't use QML may keep messages as value types and avoid QObject instances
+     *          everywhere except serialization.
+     *
+     * \param[in] value Value to be serialized
+     * \result serialized message bytes
+     */
+    template<typename V>
+    QByteArray serializeValue(const V &value) {
+        typename V::Message message;
+        value.copyTo(message);
+        return serialize<typename V::Message>(&message);
+    }
+
+    /*!
+     * \brief Deserialization of a byte-array into value type generated with VALUE option
+     *
+     * \details \a value is replaced even if \a data contains fields of message partially, same as in deserialize().
+     *
+     * \param[out] value Pointer to value where result of deserialization should be injected
+     * \param[in] data Bytes with serialized message
+     */
+    template<typename V>
+    void deserializeValue(V *value, const QByteArray &data) {
+        Q_ASSERT(value != nullptr);
+        typename V::Message message;
+#ifndef QT_PROTOBUF_NO_EXCEPTIONS
+        try {
+            deserializeInPlace(&message, data);
+        } catch(...) {
+            *value = V(message);
+            throw;
+        }
+#else
+        deserializeInPlace(&message, data);
+#endif
+        *value = V(message);
+    }
+
+    /*!
+     * \brief Merges a byte-array into existing registered qtproto message object
+     *
+     * \details Only fields that are stored in \a data are written to \a object, the rest keep their values.
+     *          Values are written using property setters, so NOTIFY signals are emitted only for fields
+     *          which values are changed. Nested message fields are merged recursively, repeated and map fields
+     *          that are stored in \a data replace existing values.
+     *
+     * \param[out] object Pointer to object where message is merged
+     * \param[in] data Bytes with serialized message
+     */
+    template<typename T>
+    void merge(T *object, const QByteArray &data) {
+        Q_ASSERT(object != nullptr);
+        qProtoDebug() << T::staticMetaObject.className() << "merge";
+        QtProtobufPrivate::ensureTypesRegistered<T>(0);
+        QtProtobufPrivate::StatisticsScope statistics(T::staticMetaObject.className(),
+                                                      QtProtobufPrivate::StatisticsScope::Deserialize, data.size());
+#ifndef QT_PROTOBUF_NO_EXCEPTIONS
+        try {
+            mergeMessage(object, T::protobufMetaObject, data);
+        } catch(...) {
+            statistics.errorOccurred();
+            throw;
+        }
+#else
+        QtProtobufPrivate::DeserializationErrorScope scope;
+        mergeMessage(object, T::protobufMetaObject, data);
+        if (scope.error() != NoDeserializationError) {
+            statistics.errorOccurred();
+        }
+#endif
+    }
+
+    /*!
+     * \brief Deserialization of fields listed in \a fieldMask from a byte-array into a registered qtproto message object
+     *
+     * \details Fields that are not in \a fieldMask keep default values, their bytes are skipped without decoding.
+     *
+     * \param[out] object Pointer to memory where result of deserialization should be injected
+     * \param[in] data Bytes with serialized message
+     * \param[in] fieldMask Numbers of fields to be deserialized
+     */
+    template<typename T>
+    void deserialize(T *object, const QByteArray &data, const QProtobufFieldMask &fieldMask) {
+        Q_ASSERT(object != nullptr);
+        qProtoDebug() << T::staticMetaObject.className() << "deserialize with field mask";
+        QtProtobufPrivate::ensureTypesRegistered<T>(0);
+        QtProtobufPrivate::StatisticsScope statistics(T::staticMetaObject.className(),
+                                                      QtProtobufPrivate::StatisticsScope::Deserialize, data.size());
+        T newValue;
+#ifndef QT_PROTOBUF_NO_EXCEPTIONS
+        try {
+            deserializeMessageFields(&newValue, T::protobufMetaObject, data, fieldMask);
+        } catch(...) {
+            statistics.errorOccurred();
+            *object = std::move(newValue);
+            throw;
+        }
+#else
+        {
+            QtProtobufPrivate::DeserializationErrorScope scope;
+            deserializeMessageFields(&newValue, T::protobufMetaObject, data, fieldMask);
+            if (scope.error() != NoDeserializationError) {
+                statistics.errorOccurred();
+            }
+        }
+#endif
+        *object = std::move(newValue);
+    }
+
+    /*!
+     * \brief Deserialization of a byte-array into a registered qtproto message object using \a arena
+     *
+     * \details Elements of repeated message fields are allocated in \a arena. \a arena must outlive
+     *          \a object and all message pointers received from it.
+     *
+     * \see QProtobufArena
+     */
+    template<typename T>
+    void deserialize(T *object, const QByteArray &data, QProtobufArena *arena) {
+        QtProtobufPrivate::ArenaScope scope(arena);
+        deserialize(object, data);
+    }
+
+    /*!
+     * \brief Deserialization of a byte-array produced by sender that uses schema with \a senderSchemaFingerprint
+     *
+     * \details Messages generated with FINGERPRINT option, which T::protobufMetaObject.schemaFingerprint matches
+     *          \a senderSchemaFingerprint, are decoded by generated deserializer that expects fields in field number
+     *          order and doesn't look fields up. Fields in other order are still decoded correctly, at usual cost.
+     *          Works as deserialize() otherwise.
+     */
+    template<typename T>
+    void deserializeFromPeer(T *object, const QByteArray &data, quint64 senderSchemaFingerprint) {
+        QtProtobufPrivate::SchemaFingerprintScope scope(senderSchemaFingerprint);
+        deserialize(object, data);
+    }
+
+    /*!
+     * \brief Deserialization of a byte-array into a registered qtproto message object without exceptions
+     *
+     * \details Works like deserialize(), but errors are returned instead of thrown. In case of error \a object
+     *          contains fields that were deserialized before error happened.
+     *
+     * \param[out] object Pointer to memory where result of deserialization should be injected
+     * \param[in] data Bytes with serialized message
+     * \result QtProtobuf::NoDeserializationError if deserialization succeeded, first happened error otherwise
+     */
+    template<typename T>
+    QtProtobuf::DeserializationError tryDeserialize(T *object, const QByteArray &data) {
+        Q_ASSERT(object != nullptr);
+        qProtoDebug() << T::staticMetaObject.className() << "tryDeserialize";
+        QtProtobufPrivate::ensureTypesRegistered<T>(0);
+        QtProtobufPrivate::StatisticsScope statistics(T::staticMetaObject.className(),
+                                                      QtProtobufPrivate::StatisticsScope::Deserialize, data.size());
+        T newValue;
+        QtProtobufPrivate::DeserializationErrorScope scope;
+        deserializeMessage(&newValue, T::protobufMetaObject, data);
+        if (scope.error() != NoDeserializationError) {
+            statistics.errorOccurred();
+        }
+        *object = std::move(newValue);
+        return scope.error();
+    }
+
+    /*!
+     * \brief Serialization of fields of a registered qtproto message object changed since last markClean() call
+     *
+     * \details Delta consists of size-prefixed list of varint encoded numbers of changed fields, followed by
+     *          changed fields serialized by this serializer. Fields changed to default values are listed as well,
+     *          so they are reset when delta is applied using mergeDelta(). Messages that don't track changes
+     *          list all fields. Nested messages and containers modified through references returned by getters
+     *          are not tracked, use setters to change them.
+     *
+     * \param[in] object Pointer to QObject containing message
+     * \result serialized delta bytes
+     */
+    template<typename T>
+    QByteArray serializeDelta(const QObject *object) {
+        Q_ASSERT(object != nullptr);
+        qProtoDebug() << T::staticMetaObject.className() << "serializeDelta";
+        QtProtobufPrivate::ensureTypesRegistered<T>(0);
+        return serializeMessageDelta(object, T::protobufMetaObject);
+    }
+
+    /*!
+     * \brief Applies delta created by serializeDelta() to a registered qtproto message object
+     *
+     * \details Only fields listed in delta are assigned, using setters. So change signals are emitted for
+     *          fields which values actually differ. \a object is not changed if delta is invalid.
+     *
+     * \param[out] object Pointer to message object that receives changed fields
+     * \param[in] data Delta bytes
+     */
+    template<typename T>
+    void mergeDelta(T *object, const QByteArray &data) {
+        Q_ASSERT(object != nullptr);
+        qProtoDebug() << T::staticMetaObject.className() << "mergeDelta";
+        QtProtobufPrivate::ensureTypesRegistered<T>(0);
+        T delta;
+        QProtobufFieldMask fields;
+#ifdef QT_PROTOBUF_NO_EXCEPTIONS
+        QtProtobufPrivate::DeserializationErrorScope scope;
+#endif
+        if (deserializeMessageDelta(&delta, T::protobufMetaObject, data, fields)) {
+            object->mergeFields(delta, fields);
+        }
+    }
+
+    /*!
+     * \brief Calculates size of a registered qtproto message object serialized by this serializer
+     *
+     * \param[in] object Pointer to QObject containing message
+     * \result size of serialized message in bytes
+     */
+    template<typename T>
+    int byteSize(const QObject *object) {
+        Q_ASSERT(object != nullptr);
+        QtProtobufPrivate::ensureTypesRegistered<T>(0);
+        return messageSize(object, T::protobufMetaObject);
     }
 
     virtual ~QAbstractProtobufSerializer() = default;
@@ -121,6 +593,41 @@ public:
      */
     virtual QByteArray serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject) const = 0;
 
+    /*!
+     * \brief Serializes \a object to \a device
+     * \details Default implementation serializes \a object to byte-array and writes it to \a device at once.
+     *          Serializers that able to write message by parts should reimplement this method.
+     * \return true if whole message was written to \a device
+     */
+    virtual bool serializeMessageTo(const QObject *object, const QProtobufMetaObject &metaObject, QIODevice *device) const;
+
+    /*!
+     * \brief Serializes \a objects of the same type, each one prefixed with its size encoded as varint
+     * \details Default implementation serializes \a objects one by one.
+     */
+    virtual QByteArray serializeMessages(const std::vector<const QObject *> &objects, const QProtobufMetaObject &metaObject) const;
+
+    /*!
+     * \brief Serializes fields of \a object marked in \a fields words
+     * \details \a fields are indexed as QProtobufFieldPresence bits. Default implementation serializes all fields.
+     *          Serializers that are able to write selected fields only should reimplement it.
+     */
+    virtual QByteArray serializeMessageFields(const QObject *object, const QProtobufMetaObject &metaObject, const quint32 *fields) const;
+
+    /*!
+     * \brief Serializes fields of \a object changed since last markClean() call
+     * \see serializeDelta
+     */
+    QByteArray serializeMessageDelta(const QObject *object, const QProtobufMetaObject &metaObject) const;
+
+    /*!
+     * \brief Deserializes delta created by serializeMessageDelta() from \a data into \a object
+     * \details Numbers of fields listed in delta are added to \a fields.
+     * \return true if delta was deserialized without errors
+     */
+    bool deserializeMessageDelta(QObject *object, const QProtobufMetaObject &metaObject, const QByteArray &data,
+                                 QProtobufFieldMask &fields) const;
+
     /*!
      * \brief serializeMessage
      * \param object
@@ -130,6 +637,40 @@ public:
      */
     virtual void deserializeMessage(QObject *object, const QProtobufMetaObject &metaObject, const QByteArray &data) const = 0;
 
+    /*!
+     * \brief Deserializes fields of \a metaObject listed in \a fieldMask from \a data into \a object
+     *
+     * \details Default implementation deserializes all fields. Serializers that are able to skip fields without
+     *          decoding them should reimplement it.
+     */
+    virtual void deserializeMessageFields(QObject *object, const QProtobufMetaObject &metaObject, const QByteArray &data,
+                                          const QProtobufFieldMask &fieldMask) const {
+        Q_UNUSED(fieldMask)
+        deserializeMessage(object, metaObject, data);
+    }
+
+    /*!
+     * \brief Merges \a data into \a object
+     *
+     * \details Default implementation deserializes \a data into \a object without reset. Serializers that
+     *          accumulate repeated fields should reimplement it to replace received repeated fields.
+     */
+    virtual void mergeMessage(QObject *object, const QProtobufMetaObject &metaObject, const QByteArray &data) const {
+        deserializeMessage(object, metaObject, data);
+    }
+
+    /*!
+     * \brief messageSize Calculates size of serialized \a object
+     * \details Default implementation serializes \a object to find out its size. Serializers that able to
+     *          calculate size without serialization should reimplement this method.
+     * \param[in] object Pointer to object to be serialized
+     * \param[in] metaObject Protobuf meta object information for given \a object
+     * \return Size of serialized message in bytes
+     */
+    virtual int messageSize(const QObject *object, const QProtobufMetaObject &metaObject) const {
+        return serializeMessage(object, metaObject).size();
+    }
+
     /*!
      * \brief serializeObject Serializes complete \a object according given \a propertyOrdering and \a metaObject
      *        information
@@ -140,6 +681,31 @@ public:
      */
     virtual QByteArray serializeObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty) const = 0;
 
+    /*!
+     * \brief serializeObjectTo Serializes complete \a object and appends result to the end of \a buffer
+     * \details Default implementation appends result of serializeObject. Serializers that able to write directly
+     *          to the output buffer should reimplement this method to avoid intermediate copies.
+     * \param[in] object Pointer to object to be serialized
+     * \param[in] metaObject Protobuf meta object information for given \a object
+     * \param[in] metaProperty Information about property to be serialized
+     * \param[out] buffer Buffer where serialized data is appended
+     */
+    virtual void serializeObjectTo(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty, QByteArray &buffer) const {
+        buffer.append(serializeObject(object, metaObject, metaProperty));
+    }
+
+    /*!
+     * \brief objectSize Calculates size of \a object serialized as property described by \a metaProperty
+     * \details Default implementation serializes \a object to find out its size.
+     * \param[in] object Pointer to object to be serialized
+     * \param[in] metaObject Protobuf meta object information for given \a object
+     * \param[in] metaProperty Information about property to be serialized
+     * \return Size of serialized property in bytes
+     */
+    virtual int objectSize(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty) const {
+        return serializeObject(object, metaObject, metaProperty).size();
+    }
+
     /*!
      * \brief deserializeObject Deserializes buffer to an \a object
      * \param[out] object Pointer to pre-allocated object
@@ -170,6 +736,34 @@ public:
      */
     virtual QByteArray serializeListObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty) const = 0;
 
+    /*!
+     * \brief serializeListObjectTo Serializes \a object as a part of list property and appends result to the end of \a buffer
+     * \details Default implementation appends result of serializeListObject.
+     * \param[in] object Pointer to object that will be serialized
+     * \param[in] metaObject Protobuf meta object information for given \a object
+     * \param[in] metaProperty Information about property to be serialized
+     * \param[out] buffer Buffer where serialized data is appended
+     */
+    virtual void serializeListObjectTo(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty, QByteArray &buffer) const {
+        buffer.append(serializeListObject(object, metaObject, metaProperty));
+    }
+
+    /*!
+     * \brief serializeListObjectsTo Serializes \a objects of list property and appends result to the end of \a buffer
+     * \details Called for long lists instead of serializeListObjectTo for each element. Default implementation
+     *          calls serializeListObjectTo for each of \a objects in order.
+     * \param[in] objects Pointers to objects that will be serialized
+     * \param[in] metaObject Protobuf meta object information for given \a objects
+     * \param[in] metaProperty Information about property to be serialized
+     * \param[out] buffer Buffer where serialized data is appended
+     */
+    virtual void serializeListObjectsTo(const std::vector<const QObject *> &objects, const QProtobufMetaObject &metaObject,
+                                        const QProtobufMetaProperty &metaProperty, QByteArray &buffer) const {
+        for (const QObject *object : objects) {
+            serializeListObjectTo(object, metaObject, metaProperty, buffer);
+        }
+    }
+
     /*!
      * \brief serializeListEnd Method called at the end of object list serialization
      * \param[in] buffer Buffer at and of list serialization
@@ -212,6 +806,30 @@ public:
      */
     virtual QByteArray serializeMapPair(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty) const = 0;
 
+    /*!
+     * \brief serializeMapPairTo Serializes QMap pair of \a key and \a value and appends result to the end of \a buffer
+     * \details Default implementation appends result of serializeMapPair.
+     * \param[in] key Map key
+     * \param[in] value Map value for given \a key
+     * \param[in] metaProperty Information about property to be serialized
+     * \param[out] buffer Buffer where serialized data is appended
+     */
+    virtual void serializeMapPairTo(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty, QByteArray &buffer) const {
+        buffer.append(serializeMapPair(key, value, metaProperty));
+    }
+
+    /*!
+     * \brief mapPairSize Calculates size of QMap pair of \a key and \a value serialized by serializeMapPair
+     * \details Default implementation serializes the pair to find out its size.
+     * \param[in] key Map key
+     * \param[in] value Map value for given \a key
+     * \param[in] metaProperty Information about property to be serialized
+     * \return Size of serialized pair in bytes
+     */
+    virtual int mapPairSize(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty) const {
+        return serializeMapPair(key, value, metaProperty).size();
+    }
+
     /*!
      * \brief serializeMapEnd Method called at the end of map serialization
      * \param[in] buffer Buffer at and of list serialization
@@ -287,21 +905,40 @@ template<typename T>
 static void qRegisterProtobufType() {
     T::registerTypes();
     QtProtobufPrivate::registerHandler(qMetaTypeId<T *>(), { QtProtobufPrivate::serializeObject<T>,
-            QtProtobufPrivate::deserializeObject<T>, QtProtobufPrivate::ObjectHandler });
+            QtProtobufPrivate::deserializeObject<T>, QtProtobufPrivate::ObjectHandler, QtProtobufPrivate::objectSize<T>,
+            &T::protobufMetaObject });
     QtProtobufPrivate::registerHandler(qMetaTypeId<QList<QSharedPointer<T>>>(), { QtProtobufPrivate::serializeList<T>,
-            QtProtobufPrivate::deserializeList<T>, QtProtobufPrivate::ListHandler });
+            QtProtobufPrivate::deserializeList<T>, QtProtobufPrivate::ListHandler, QtProtobufPrivate::listSize<T>,
+            &T::protobufMetaObject, 0, QtProtobufPrivate::reserveList<T> });
+}
+
+/*!
+ * \brief Registers serializers for vector of value type V in QtProtobuf global serializers registry
+ * \private
+ * \details Value type V is generated gadget that stores fields of message V::Message inline.
+ *          Elements are converted to V::Message when they are serialized and deserialized.
+ */
+template<typename V>
+inline void qRegisterProtobufValueType() {
+    QtProtobufPrivate::registerHandler(qMetaTypeId<QVector<V>>(), { QtProtobufPrivate::serializeValueList<V>,
+            QtProtobufPrivate::deserializeValueList<V>, QtProtobufPrivate::ListHandler, nullptr,
+            &V::Message::protobufMetaObject, 0, QtProtobufPrivate::reserveValueList<V> });
 }
 
 /*!
  * \brief Registers serializers for type QMap<K, V> in QtProtobuf global serializers registry
  * \private
- * \details generates default serializers for QMap<K, V>.
+ * \details generates default serializers for QMap<K, V>. Maps of basic keys and values also get wire format
+ *          handlers, that are used by QProtobufSerializer instead of per-entry serialization through QVariant.
  */
 template<typename K, typename V,
          typename std::enable_if_t<!std::is_base_of<QObject, V>::value, int> = 0>
 inline void qRegisterProtobufMapType() {
-    QtProtobufPrivate::registerHandler(qMetaTypeId<QMap<K, V>>(), { QtProtobufPrivate::serializeMap<K, V>,
-    QtProtobufPrivate::deserializeMap<K, V>, QtProtobufPrivate::MapHandler });
+    QtProtobufPrivate::SerializationHandler handler{ QtProtobufPrivate::serializeMap<K, V>,
+    QtProtobufPrivate::deserializeMap<K, V>, QtProtobufPrivate::MapHandler, QtProtobufPrivate::mapSize<K, V>,
+    nullptr, 0, nullptr, nullptr, nullptr, nullptr, nullptr };
+    QtProtobufPrivate::setWireMapHandlers<K, V>(handler);
+    QtProtobufPrivate::registerHandler(qMetaTypeId<QMap<K, V>>(), handler);
 }
 
 /*!
@@ -314,20 +951,61 @@ template<typename K, typename V,
          typename std::enable_if_t<std::is_base_of<QObject, V>::value, int> = 0>
 inline void qRegisterProtobufMapType() {
     QtProtobufPrivate::registerHandler(qMetaTypeId<QMap<K, QSharedPointer<V>>>(), { QtProtobufPrivate::serializeMap<K, V>,
-    QtProtobufPrivate::deserializeMap<K, V>, QtProtobufPrivate::MapHandler });
+    QtProtobufPrivate::deserializeMap<K, V>, QtProtobufPrivate::MapHandler, QtProtobufPrivate::mapSize<K, V>,
+    &V::protobufMetaObject, qMetaTypeId<K>() });
+}
+
+/*!
+ * \brief Registers serializers for type QHash<K, V> in QtProtobuf global serializers registry
+ * \private
+ * \details generates default serializers for QHash<K, V>, that is used for map fields of messages generated with
+ *          QHASH option. Space for received entries is reserved in advance.
+ */
+template<typename K, typename V,
+         typename std::enable_if_t<!std::is_base_of<QObject, V>::value, int> = 0>
+inline void qRegisterProtobufHashType() {
+    QtProtobufPrivate::SerializationHandler handler{ QtProtobufPrivate::serializeMap<K, V, QHash>,
+    QtProtobufPrivate::deserializeMap<K, V, QHash>, QtProtobufPrivate::MapHandler, QtProtobufPrivate::mapSize<K, V, QHash>,
+    nullptr, 0, QtProtobufPrivate::reserveHash<QHash<K, V>>, nullptr, nullptr, nullptr, nullptr };
+    QtProtobufPrivate::setWireMapHandlers<K, V, QHash>(handler);
+    QtProtobufPrivate::registerHandler(qMetaTypeId<QHash<K, V>>(), handler);
+}
+
+/*!
+ * \brief Registers serializers for type QHash<K, V> in QtProtobuf global serializers registry
+ * \private
+ * \details generates default serializers for QHash<K, V>. Specialization for V type
+ *          inherited of QObject.
+ */
+template<typename K, typename V,
+         typename std::enable_if_t<std::is_base_of<QObject, V>::value, int> = 0>
+inline void qRegisterProtobufHashType() {
+    QtProtobufPrivate::registerHandler(qMetaTypeId<QHash<K, QSharedPointer<V>>>(), { QtProtobufPrivate::serializeMap<K, V, QHash>,
+    QtProtobufPrivate::deserializeMap<K, V, QHash>, QtProtobufPrivate::MapHandler, QtProtobufPrivate::mapSize<K, V, QHash>,
+    &V::protobufMetaObject, qMetaTypeId<K>(), QtProtobufPrivate::reserveHash<QHash<K, QSharedPointer<V>>> });
 }
 
 
 /*!
  * \brief Registers serializers for enumeration type in QtProtobuf global serializers registry
  * \private
- * \details generates default serializers for enumeration and QList of enumerations.
+ * \details generates default serializers for enumeration and QList of enumerations. Wire format handlers are
+ *          registered as well, so QProtobufSerializer encodes values directly, without conversion to int64 lists.
+ *          Lists of enumerations are decoded from both packed and non-packed encodings.
  */
 template<typename T,
          typename std::enable_if_t<std::is_enum<T>::value, int> = 0>
 inline void qRegisterProtobufEnumType() {
-    QtProtobufPrivate::registerHandler(qMetaTypeId<T>(), { QtProtobufPrivate::serializeEnum<T>,
-                                                           QtProtobufPrivate::deserializeEnum<T>, QtProtobufPrivate::ObjectHandler });
-    QtProtobufPrivate::registerHandler(qMetaTypeId<QList<T>>(), { QtProtobufPrivate::serializeEnumList<T>,
-                                                           QtProtobufPrivate::deserializeEnumList<T>, QtProtobufPrivate::ListHandler });
+    QtProtobufPrivate::SerializationHandler handler{ QtProtobufPrivate::serializeEnum<T>,
+                                                     QtProtobufPrivate::deserializeEnum<T>, QtProtobufPrivate::ObjectHandler,
+                                                     nullptr, nullptr, 0, nullptr, nullptr, nullptr, nullptr, nullptr };
+    QtProtobufPrivate::setWireHandlers<T>(handler);
+    QtProtobufPrivate::registerHandler(qMetaTypeId<T>(), handler);
+
+    QtProtobufPrivate::SerializationHandler listHandler{ QtProtobufPrivate::serializeEnumList<T>,
+                                                         QtProtobufPrivate::deserializeEnumList<T>, QtProtobufPrivate::ListHandler,
+                                                         nullptr, nullptr, 0, nullptr, nullptr, nullptr, nullptr,
+                                                         QtProtobufPrivate::deserializeWireListElement<T> };
+    QtProtobufPrivate::setWireHandlers<QList<T>>(listHandler);
+    QtProtobufPrivate::registerHandler(qMetaTypeId<QList<T>>(), listHandler);
 }
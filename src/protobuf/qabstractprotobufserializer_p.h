@@ -27,30 +27,62 @@
 
 #include <QObject>
 #include <QVariant>
+#include <QVector>
+#include <QMap>
+#include <QHash>
 #include <QMetaObject>
 #include <QMetaEnum>
+#include <QSignalBlocker>
 
 #include <functional>
+#include <vector>
 
 #include "qtprotobuftypes.h"
 #include "qtprotobuflogging.h"
+#include "qprotobufarena.h"
 #include "qtprotobufglobal.h"
+#include "qprotobufwireformat.h"
 
 namespace QtProtobuf {
     class QAbstractProtobufSerializer;
     class QProtobufSelfcheckIterator;
     class QProtobufMetaProperty;
+    class QProtobufMetaObject;
 }
 
 namespace QtProtobufPrivate {
 //! \private
 constexpr int NotUsedFieldIndex = -1;
+//Minimum number of elements in repeated message field that are passed to serializer at once
+constexpr int ListObjectsBatchSize = 1024;
 
-using Serializer = std::function<void(const QtProtobuf::QAbstractProtobufSerializer *, const QVariant &, const QtProtobuf::QProtobufMetaProperty &, QByteArray &)>;
+using Serializer = void(*)(const QtProtobuf::QAbstractProtobufSerializer *, const QVariant &, const QtProtobuf::QProtobufMetaProperty &, QByteArray &);
 /*!
  * \brief Deserializer is interface function for deserialize method
  */
-using Deserializer = std::function<void(const QtProtobuf::QAbstractProtobufSerializer *, QtProtobuf::QProtobufSelfcheckIterator &, QVariant &)>;
+using Deserializer = void(*)(const QtProtobuf::QAbstractProtobufSerializer *, QtProtobuf::QProtobufSelfcheckIterator &, QVariant &);
+/*!
+ * \brief Sizer is interface function that calculates size of serialized property including its header
+ */
+using Sizer = int(*)(const QtProtobuf::QAbstractProtobufSerializer *, const QVariant &, const QtProtobuf::QProtobufMetaProperty &);
+/*!
+ * \brief Reserver is interface function that reserves space for number of elements in list stored in QVariant
+ */
+using Reserver = void(*)(QVariant &, int);
+/*!
+ * \brief WireSerializer is interface function that writes value stored in QVariant in protobuf wire format
+ *        directly, without boxing of map entries or list elements
+ */
+using WireSerializer = void(*)(const QVariant &, int, QByteArray &);
+/*!
+ * \brief WireDeserializer is interface function that reads value, list elements or map entry in protobuf wire
+ *        format to value stored in QVariant
+ */
+using WireDeserializer = void(*)(QtProtobuf::QProtobufSelfcheckIterator &, QVariant &);
+/*!
+ * \brief WireSizer is interface function that calculates size of value written by WireSerializer
+ */
+using WireSizer = int(*)(const QVariant &, int);
 
 enum HandlerType {
     ObjectHandler,
@@ -66,9 +98,23 @@ struct SerializationHandler {
     Serializer serializer; /*!< serializer assigned to class */
     Deserializer deserializer;/*!< deserializer assigned to class */
     HandlerType type;/*!< Serialization WireType */
+    Sizer sizer;/*!< optional size calculator assigned to class */
+    const QtProtobuf::QProtobufMetaObject *metaObject;/*!< message type of object, of list elements or of map values, nullptr if it's not a message */
+    int mapKeyType;/*!< metatype identifier of map key, set for maps of messages only */
+    Reserver reserve;/*!< optional preallocation of list elements, for lists of messages */
+    WireSerializer wireSerializer;/*!< optional typed wire format serializer, for maps of basic types, enumerations and native well-known types */
+    WireDeserializer wireDeserializer;/*!< optional typed wire format deserializer, for maps of basic types, enumerations and native well-known types */
+    WireSizer wireSizer;/*!< optional typed wire format size calculator, for maps of basic types, enumerations and native well-known types */
+    WireDeserializer wireElementDeserializer;/*!< optional deserializer of single non-packed list element, for lists of enumerations */
 };
 
-extern Q_PROTOBUF_EXPORT SerializationHandler findHandler(int userType);
+/*!
+ * \private
+ * \brief Looks up serialization handlers registered for \a userType
+ * \details Lookup doesn't lock or allocate. Returned reference stays valid until program exit, empty
+ *          handler is returned if nothing is registered for \a userType
+ */
+extern Q_PROTOBUF_EXPORT const SerializationHandler &findHandler(int userType);
 extern Q_PROTOBUF_EXPORT void registerHandler(int userType, const SerializationHandler &handlers);
 
 /*!
@@ -79,7 +125,7 @@ template <typename T,
           typename std::enable_if_t<std::is_base_of<QObject, T>::value, int> = 0>
 void serializeObject(const QtProtobuf::QAbstractProtobufSerializer *serializer, const QVariant &value, const QtProtobuf::QProtobufMetaProperty &metaProperty, QByteArray &buffer) {
     Q_ASSERT_X(serializer != nullptr, "QAbstractProtobufSerializer", "Serializer is null");
-    buffer.append(serializer->serializeObject(value.value<T *>(), T::protobufMetaObject, metaProperty));
+    serializer->serializeObjectTo(value.value<T *>(), T::protobufMetaObject, metaProperty, buffer);
 }
 
 /*!
@@ -95,12 +141,26 @@ void serializeList(const QtProtobuf::QAbstractProtobufSerializer *serializer, co
     qProtoDebug() << __func__ << "listValue.count" << list.count();
 
     buffer.append(serializer->serializeListBegin(metaProperty));
-    for (auto &value : list) {
-        if (!value) {
-            qProtoWarning() << "Null pointer in list";
-            continue;
+    if (list.count() >= ListObjectsBatchSize) {
+        //Long lists are passed at once, so serializer may process them in parallel
+        std::vector<const QObject *> objects;
+        objects.reserve(list.count());
+        for (auto &value : list) {
+            if (!value) {
+                qProtoWarning() << "Null pointer in list";
+                continue;
+            }
+            objects.push_back(value.data());
+        }
+        serializer->serializeListObjectsTo(objects, V::protobufMetaObject, metaProperty, buffer);
+    } else {
+        for (auto &value : list) {
+            if (!value) {
+                qProtoWarning() << "Null pointer in list";
+                continue;
+            }
+            serializer->serializeListObjectTo(value.data(), V::protobufMetaObject, metaProperty, buffer);
         }
-        buffer.append(serializer->serializeListObject(value.data(), V::protobufMetaObject, metaProperty));
     }
     buffer.append(serializer->serializeListEnd(buffer, metaProperty));
 }
@@ -109,15 +169,15 @@ void serializeList(const QtProtobuf::QAbstractProtobufSerializer *serializer, co
  * \private
  * \brief default serializer template for map of key K, value V
  */
-template<typename K, typename V,
+template<typename K, typename V, template<typename, typename> class M = QMap,
          typename std::enable_if_t<!std::is_base_of<QObject, V>::value, int> = 0>
 void serializeMap(const QtProtobuf::QAbstractProtobufSerializer *serializer, const QVariant &value, const QtProtobuf::QProtobufMetaProperty &metaProperty, QByteArray &buffer) {
     Q_ASSERT_X(serializer != nullptr, "QAbstractProtobufSerializer", "Serializer is null");
-    QMap<K,V> mapValue = value.value<QMap<K,V>>();
+    const M<K, V> mapValue = value.value<M<K, V>>();
     buffer.append(serializer->serializeMapBegin(metaProperty));
-    for (auto it = mapValue.constBegin(); it != mapValue.constEnd(); it++) {
-        buffer.append(serializer->serializeMapPair(QVariant::fromValue<K>(it.key()), QVariant::fromValue<V>(it.value()), metaProperty));
-    }
+    forEachMapEntry(mapValue, [serializer, &metaProperty, &buffer](const K &key, const V &entryValue) {
+        serializer->serializeMapPairTo(QVariant::fromValue<K>(key), QVariant::fromValue<V>(entryValue), metaProperty, buffer);
+    });
     buffer.append(serializer->serializeMapEnd(buffer, metaProperty));
 }
 
@@ -125,19 +185,19 @@ void serializeMap(const QtProtobuf::QAbstractProtobufSerializer *serializer, con
  * \private
  * \brief default serializer template for map of type key K, value V. Specialization for V inherited of QObject
  */
-template<typename K, typename V,
+template<typename K, typename V, template<typename, typename> class M = QMap,
          typename std::enable_if_t<std::is_base_of<QObject, V>::value, int> = 0>
 void serializeMap(const QtProtobuf::QAbstractProtobufSerializer *serializer, const QVariant &value, const QtProtobuf::QProtobufMetaProperty &metaProperty, QByteArray &buffer) {
     Q_ASSERT_X(serializer != nullptr, "QAbstractProtobufSerializer", "Serializer is null");
-    QMap<K, QSharedPointer<V>> mapValue = value.value<QMap<K, QSharedPointer<V>>>();
+    const M<K, QSharedPointer<V>> mapValue = value.value<M<K, QSharedPointer<V>>>();
     buffer.append(serializer->serializeMapBegin(metaProperty));
-    for (auto it = mapValue.constBegin(); it != mapValue.constEnd(); it++) {
-        if (it.value().isNull()) {
-            qProtoWarning() << __func__ << "Trying to serialize map value that contains nullptr";
-            continue;
+    forEachMapEntry(mapValue, [serializer, &metaProperty, &buffer](const K &key, const QSharedPointer<V> &entryValue) {
+        if (entryValue.isNull()) {
+            qProtoWarning() << "serializeMap" << "Trying to serialize map value that contains nullptr";
+            return;
         }
-        buffer.append(serializer->serializeMapPair(QVariant::fromValue<K>(it.key()), QVariant::fromValue<V *>(it.value().data()), metaProperty));
-    }
+        serializer->serializeMapPairTo(QVariant::fromValue<K>(key), QVariant::fromValue<V *>(entryValue.data()), metaProperty, buffer);
+    });
     buffer.append(serializer->serializeMapEnd(buffer, metaProperty));
 }
 
@@ -167,6 +227,68 @@ void serializeEnumList(const QtProtobuf::QAbstractProtobufSerializer *serializer
     buffer.append(serializer->serializeEnumList(intList, QMetaEnum::fromType<T>(), metaProperty));
 }
 
+/*!
+ * \private
+ * \brief default size calculator template for type T inherited of QObject
+ */
+template <typename T,
+          typename std::enable_if_t<std::is_base_of<QObject, T>::value, int> = 0>
+int objectSize(const QtProtobuf::QAbstractProtobufSerializer *serializer, const QVariant &value, const QtProtobuf::QProtobufMetaProperty &metaProperty) {
+    Q_ASSERT_X(serializer != nullptr, "QAbstractProtobufSerializer", "Serializer is null");
+    return serializer->objectSize(value.value<T *>(), T::protobufMetaObject, metaProperty);
+}
+
+/*!
+ * \private
+ * \brief default size calculator template for list of type T objects inherited of QObject
+ */
+template<typename V,
+         typename std::enable_if_t<std::is_base_of<QObject, V>::value, int> = 0>
+int listSize(const QtProtobuf::QAbstractProtobufSerializer *serializer, const QVariant &listValue, const QtProtobuf::QProtobufMetaProperty &metaProperty) {
+    Q_ASSERT_X(serializer != nullptr, "QAbstractProtobufSerializer", "Serializer is null");
+    int size = 0;
+    for (auto &value : listValue.value<QList<QSharedPointer<V>>>()) {
+        if (value) {
+            size += serializer->objectSize(value.data(), V::protobufMetaObject, metaProperty);
+        }
+    }
+    return size;
+}
+
+/*!
+ * \private
+ * \brief default size calculator template for map of key K, value V
+ */
+template<typename K, typename V, template<typename, typename> class M = QMap,
+         typename std::enable_if_t<!std::is_base_of<QObject, V>::value, int> = 0>
+int mapSize(const QtProtobuf::QAbstractProtobufSerializer *serializer, const QVariant &value, const QtProtobuf::QProtobufMetaProperty &metaProperty) {
+    Q_ASSERT_X(serializer != nullptr, "QAbstractProtobufSerializer", "Serializer is null");
+    int size = 0;
+    const M<K, V> mapValue = value.value<M<K, V>>();
+    for (auto it = mapValue.constBegin(); it != mapValue.constEnd(); it++) {
+        size += serializer->mapPairSize(QVariant::fromValue<K>(it.key()), QVariant::fromValue<V>(it.value()), metaProperty);
+    }
+    return size;
+}
+
+/*!
+ * \private
+ * \brief default size calculator template for map of type key K, value V. Specialization for V inherited of QObject
+ */
+template<typename K, typename V, template<typename, typename> class M = QMap,
+         typename std::enable_if_t<std::is_base_of<QObject, V>::value, int> = 0>
+int mapSize(const QtProtobuf::QAbstractProtobufSerializer *serializer, const QVariant &value, const QtProtobuf::QProtobufMetaProperty &metaProperty) {
+    Q_ASSERT_X(serializer != nullptr, "QAbstractProtobufSerializer", "Serializer is null");
+    int size = 0;
+    const M<K, QSharedPointer<V>> mapValue = value.value<M<K, QSharedPointer<V>>>();
+    for (auto it = mapValue.constBegin(); it != mapValue.constEnd(); it++) {
+        if (!it.value().isNull()) {
+            size += serializer->mapPairSize(QVariant::fromValue<K>(it.key()), QVariant::fromValue<V *>(it.value().data()), metaProperty);
+        }
+    }
+    return size;
+}
+
 /*!
  * \private
  * \brief default deserializer template for type T inherited of QObject
@@ -175,11 +297,119 @@ template <typename T,
           typename std::enable_if_t<std::is_base_of<QObject, T>::value, int> = 0>
 void deserializeObject(const QtProtobuf::QAbstractProtobufSerializer *serializer, QtProtobuf::QProtobufSelfcheckIterator &it, QVariant &to) {
     Q_ASSERT_X(serializer != nullptr, "QAbstractProtobufSerializer", "Serializer is null");
-    T *value = new T;
-    serializer->deserializeObject(value, T::protobufMetaObject, it);
+    //Message is merged to the existing object, so nested objects are reused instead of reallocation
+    T *value = to.userType() == qMetaTypeId<T *>() ? to.value<T *>() : nullptr;
+    if (value != nullptr) {
+        serializer->deserializeObject(value, T::protobufMetaObject, it);
+        return;
+    }
+    value = new T;
+    {
+        //Nobody is connected to new object yet, change signals are skipped while it's filled
+        const QSignalBlocker blocker(value);
+        serializer->deserializeObject(value, T::protobufMetaObject, it);
+    }
     to = QVariant::fromValue<T *>(value);
 }
 
+/*!
+ * \private
+ * \brief Returns reference to value of type \a T stored in \a variant
+ *
+ * \details Variant is reset to default value of \a T if it contains value of other type. Containers are
+ *          modified in place, so elements appended one by one don't detach it each time.
+ */
+template <typename T>
+T &variantValueRef(QVariant &variant) {
+    if (variant.userType() != qMetaTypeId<T>()) {
+        variant = QVariant::fromValue<T>(variant.value<T>());
+    }
+    return *static_cast<T *>(variant.data());
+}
+
+/*!
+ * \private
+ * \brief Checks if values of type \a T are written by QProtobufWireFormat directly, as map keys and values
+ */
+template <typename T>
+using IsWireFormatType = std::integral_constant<bool, std::is_same<T, float>::value
+                                                || std::is_same<T, double>::value
+                                                || std::is_same<T, QtProtobuf::int32>::value
+                                                || std::is_same<T, QtProtobuf::int64>::value
+                                                || std::is_same<T, QtProtobuf::uint32>::value
+                                                || std::is_same<T, QtProtobuf::uint64>::value
+                                                || std::is_same<T, QtProtobuf::sint32>::value
+                                                || std::is_same<T, QtProtobuf::sint64>::value
+                                                || std::is_same<T, QtProtobuf::fixed32>::value
+                                                || std::is_same<T, QtProtobuf::fixed64>::value
+                                                || std::is_same<T, QtProtobuf::sfixed32>::value
+                                                || std::is_same<T, QtProtobuf::sfixed64>::value
+                                                || std::is_same<T, bool>::value
+                                                || std::is_same<T, QString>::value
+                                                || std::is_same<T, QByteArray>::value
+                                                || std::is_enum<T>::value>;
+
+/*!
+ * \private
+ * \brief wire format serializer template for value of type T
+ */
+template<typename T>
+void serializeWireValue(const QVariant &value, int fieldNumber, QByteArray &buffer) {
+    QtProtobuf::QProtobufWireFormat::writeField(buffer, fieldNumber, *static_cast<const T *>(value.constData()));
+}
+
+/*!
+ * \private
+ * \brief wire format deserializer template for value of type T
+ */
+template<typename T>
+void deserializeWireValue(QtProtobuf::QProtobufSelfcheckIterator &it, QVariant &previous) {
+    QtProtobuf::QProtobufWireFormat::readField(it, variantValueRef<T>(previous));
+}
+
+/*!
+ * \private
+ * \brief wire format deserializer template for single non-packed element of list of type T
+ */
+template<typename T>
+void deserializeWireListElement(QtProtobuf::QProtobufSelfcheckIterator &it, QVariant &previous) {
+    QtProtobuf::QProtobufWireFormat::readRepeatedField(it, QtProtobuf::Varint, variantValueRef<QList<T>>(previous));
+}
+
+/*!
+ * \private
+ * \brief wire format size calculator template for value of type T
+ */
+template<typename T>
+int wireValueSize(const QVariant &value, int fieldNumber) {
+    return QtProtobuf::QProtobufWireFormat::fieldSize(fieldNumber, *static_cast<const T *>(value.constData()));
+}
+
+/*!
+ * \private
+ * \brief Assigns wire format handlers of type T to \a handler
+ */
+template<typename T>
+void setWireHandlers(SerializationHandler &handler) {
+    handler.wireSerializer = serializeWireValue<T>;
+    handler.wireDeserializer = deserializeWireValue<T>;
+    handler.wireSizer = wireValueSize<T>;
+}
+
+/*!
+ * \private
+ * \brief Assigns wire format handlers of map M<K, V> to \a handler if both K and V are basic types or enumerations
+ */
+template<typename K, typename V, template<typename, typename> class M = QMap,
+         typename std::enable_if_t<IsWireFormatType<K>::value && IsWireFormatType<V>::value, int> = 0>
+void setWireMapHandlers(SerializationHandler &handler) {
+    setWireHandlers<M<K, V>>(handler);
+}
+
+template<typename K, typename V, template<typename, typename> class M = QMap,
+         typename std::enable_if_t<!(IsWireFormatType<K>::value && IsWireFormatType<V>::value), int> = 0>
+void setWireMapHandlers(SerializationHandler &/*handler*/) {}
+
 /*!
  * \private
  * \brief default deserializer template for list of type T objects inherited of QObject
@@ -190,32 +420,109 @@ void deserializeList(const QtProtobuf::QAbstractProtobufSerializer *serializer,
     Q_ASSERT_X(serializer != nullptr, "QAbstractProtobufSerializer", "Serializer is null");
     qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
 
-    V *newValue = new V;
-    QList<QSharedPointer<V>> list = previous.value<QList<QSharedPointer<V>>>();
-    if (serializer->deserializeListObject(newValue, V::protobufMetaObject, it)) {
-        list.append(QSharedPointer<V>(newValue));
-        previous.setValue(list);
+    QSharedPointer<V> newValue = MessageReuseScope::isActive() ? MessageReuseScope::takeRecycled<V>() : QSharedPointer<V>();
+    if (!newValue.isNull()) {
+        //Recycled element may be used in QML already, so its change signals are not blocked
+        MessageReuseScope::recycleLists(newValue.data(), V::protobufMetaObject);
+        newValue->clear();
+        if (serializer->deserializeListObject(newValue.data(), V::protobufMetaObject, it)) {
+            variantValueRef<QList<QSharedPointer<V>>>(previous).append(newValue);
+        }
+        return;
+    }
+
+    newValue = createSharedMessage<V>();
+    const QSignalBlocker blocker(newValue.data());
+    if (serializer->deserializeListObject(newValue.data(), V::protobufMetaObject, it)) {
+        variantValueRef<QList<QSharedPointer<V>>>(previous).append(newValue);
+    }
+}
+
+/*!
+ * \private
+ * \brief default serializer template for list of value type V elements
+ * \details Elements are serialized using single message object of type V::Message. No size calculator is
+ *          provided for value lists on purpose: sizes of the temporary message must not be cached.
+ */
+template<typename V>
+void serializeValueList(const QtProtobuf::QAbstractProtobufSerializer *serializer, const QVariant &listValue, const QtProtobuf::QProtobufMetaProperty &metaProperty, QByteArray &buffer) {
+    Q_ASSERT_X(serializer != nullptr, "QAbstractProtobufSerializer", "Serializer is null");
+    //Elements are stored contiguously, so they are iterated without pointer indirection
+    const QVector<V> list = listValue.value<QVector<V>>();
+
+    qProtoDebug() << __func__ << "listValue.count" << list.count();
+
+    typename V::Message message;
+    buffer.append(serializer->serializeListBegin(metaProperty));
+    for (const auto &value : list) {
+        value.copyTo(message);
+        serializer->serializeListObjectTo(&message, V::Message::protobufMetaObject, metaProperty, buffer);
+    }
+    buffer.append(serializer->serializeListEnd(buffer, metaProperty));
+}
+
+/*!
+ * \private
+ * \brief default deserializer template for list of value type V elements
+ */
+template<typename V>
+void deserializeValueList(const QtProtobuf::QAbstractProtobufSerializer *serializer, QtProtobuf::QProtobufSelfcheckIterator &it, QVariant &previous) {
+    Q_ASSERT_X(serializer != nullptr, "QAbstractProtobufSerializer", "Serializer is null");
+    qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
+
+    typename V::Message message;
+    if (serializer->deserializeListObject(&message, V::Message::protobufMetaObject, it)) {
+        variantValueRef<QVector<V>>(previous).append(V(message));
     }
 }
 
+/*!
+ * \private
+ * \brief default reserver template for list of value type V elements
+ */
+template<typename V>
+void reserveValueList(QVariant &previous, int count) {
+    QVector<V> &list = variantValueRef<QVector<V>>(previous);
+    list.reserve(list.count() + count);
+}
+
+/*!
+ * \private
+ * \brief default reserver template for hash-based map of type T
+ */
+template <typename T>
+void reserveHash(QVariant &previous, int count) {
+    T &hash = variantValueRef<T>(previous);
+    hash.reserve(hash.count() + count);
+}
+
+/*!
+ * \private
+ * \brief default reserver template for list of type T objects inherited of QObject
+ */
+template <typename V,
+          typename std::enable_if_t<std::is_base_of<QObject, V>::value, int> = 0>
+void reserveList(QVariant &previous, int count) {
+    QList<QSharedPointer<V>> &list = variantValueRef<QList<QSharedPointer<V>>>(previous);
+    list.reserve(list.count() + count);
+}
+
 /*!
  * \private
  *
  * \brief default deserializer template for map of key K, value V
  */
-template <typename K, typename V,
+template <typename K, typename V, template<typename, typename> class M = QMap,
           typename std::enable_if_t<!std::is_base_of<QObject, V>::value, int> = 0>
 void deserializeMap(const QtProtobuf::QAbstractProtobufSerializer *serializer, QtProtobuf::QProtobufSelfcheckIterator &it, QVariant &previous) {
     Q_ASSERT_X(serializer != nullptr, "QAbstractProtobufSerializer", "Serializer is null");
     qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
 
-    QMap<K, V> out = previous.value<QMap<K, V>>();
     QVariant key = QVariant::fromValue<K>(K());
     QVariant value = QVariant::fromValue<V>(V());
 
     if (serializer->deserializeMapPair(key, value, it)) {
-        out[key.value<K>()] = value.value<V>();
-        previous = QVariant::fromValue<QMap<K, V>>(out);
+        variantValueRef<M<K, V>>(previous)[key.value<K>()] = value.value<V>();
     }
 }
 
@@ -225,19 +532,17 @@ void deserializeMap(const QtProtobuf::QAbstractProtobufSerializer *serializer, Q
  * \brief default deserializer template for map of type key K, value V. Specialization for V
  *        inherited of QObject
  */
-template <typename K, typename V,
+template <typename K, typename V, template<typename, typename> class M = QMap,
           typename std::enable_if_t<std::is_base_of<QObject, V>::value, int> = 0>
 void deserializeMap(const QtProtobuf::QAbstractProtobufSerializer *serializer, QtProtobuf::QProtobufSelfcheckIterator &it, QVariant &previous) {
     Q_ASSERT_X(serializer != nullptr, "QAbstractProtobufSerializer", "Serializer is null");
     qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
 
-    auto out = previous.value<QMap<K, QSharedPointer<V>>>();
     QVariant key = QVariant::fromValue<K>(K());
     QVariant value = QVariant::fromValue<V *>(nullptr);
 
     if (serializer->deserializeMapPair(key, value, it)) {
-        out[key.value<K>()] = QSharedPointer<V>(value.value<V *>());
-        previous = QVariant::fromValue<QMap<K, QSharedPointer<V>>>(out);
+        variantValueRef<M<K, QSharedPointer<V>>>(previous)[key.value<K>()] = QSharedPointer<V>(value.value<V *>());
     }
 }
 
@@ -266,10 +571,9 @@ void deserializeEnumList(const QtProtobuf::QAbstractProtobufSerializer *serializ
     Q_ASSERT_X(serializer != nullptr, "QAbstractProtobufSerializer", "Serializer is null");
     QList<QtProtobuf::int64> intList;
     serializer->deserializeEnumList(intList, QMetaEnum::fromType<T>(), it);
-    QList<T> enumList = previous.value<QList<T>>();
+    QList<T> &enumList = variantValueRef<QList<T>>(previous);
     for (auto intValue : intList) {
         enumList.append(static_cast<T>(intValue._t));
     }
-    previous = QVariant::fromValue<QList<T>>(enumList);
 }
 }
@@ -0,0 +1,87 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qprotobufarena.h"
+
+#include <algorithm>
+
+using namespace QtProtobuf;
+
+namespace {
+thread_local QProtobufArena *currentThreadArena = nullptr;
+}
+
+QProtobufArena::QProtobufArena(size_t blockSize) : m_blockSize(blockSize)
+  , m_spaceAllocated(0)
+  , m_current(nullptr)
+  , m_end(nullptr)
+  , m_liveObjects(0)
+{
+}
+
+QProtobufArena::~QProtobufArena()
+{
+    reset();
+}
+
+void *QProtobufArena::allocateBlock(size_t size, size_t alignment)
+{
+    //Oversized allocations get own block, so rest of current block is not wasted
+    const size_t requiredSize = size + alignment;
+    const size_t blockSize = std::max(m_blockSize, requiredSize);
+    m_blocks.emplace_back(new char[blockSize]);
+    m_spaceAllocated += blockSize;
+
+    char *block = m_blocks.back().get();
+    if (requiredSize <= m_blockSize) {
+        m_current = block;
+        m_end = block + blockSize;
+        return allocate(size, alignment);
+    }
+
+    const size_t offset = (alignment - (reinterpret_cast<std::uintptr_t>(block) % alignment)) % alignment;
+    return block + offset;
+}
+
+void QProtobufArena::reset()
+{
+    Q_ASSERT_X(m_liveObjects.loadAcquire() == 0, "QProtobufArena", "Arena is reset while objects allocated in it are alive");
+    m_blocks.clear();
+    m_spaceAllocated = 0;
+    m_current = nullptr;
+    m_end = nullptr;
+}
+
+QProtobufArena *QtProtobufPrivate::currentArena()
+{
+    return currentThreadArena;
+}
+
+QProtobufArena *QtProtobufPrivate::setCurrentArena(QProtobufArena *arena)
+{
+    QProtobufArena *previous = currentThreadArena;
+    currentThreadArena = arena;
+    return previous;
+}
@@ -0,0 +1,181 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufArena
+
+#include <QSharedPointer>
+#include <QAtomicInteger>
+
+#include "qtprotobufglobal.h"
+#include "qprotobufserializerstatistics.h"
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufArena class is memory pool for message objects created during deserialization
+ *
+ * \details Elements of repeated message fields deserialized with arena are allocated in memory blocks owned
+ *          by arena instead of separate heap allocations. Objects are destroyed when last QSharedPointer
+ *          pointing to them is released, but memory is returned to system at once by reset() or arena
+ *          destructor.
+ *
+ *          Arena must outlive all messages deserialized with it. Arena objects are not thread safe, single
+ *          arena should not be used for simultaneous deserializations from different threads.
+ *          \code
+ *          QProtobufArena arena;
+ *          RepeatedComplexMessage message;
+ *          serializer->deserialize(&message, data, &arena);
+ *          \endcode
+ *
+ * \see QAbstractProtobufSerializer::deserialize
+ */
+class Q_PROTOBUF_EXPORT QProtobufArena
+{
+public:
+    enum {
+        DefaultBlockSize = 8192
+    };
+
+    /*!
+     * \brief Constructs arena that allocates memory by blocks of \a blockSize bytes
+     */
+    explicit QProtobufArena(size_t blockSize = DefaultBlockSize);
+    ~QProtobufArena();
+
+    /*!
+     * \brief Allocates \a size bytes aligned to \a alignment
+     *
+     * \details Returned memory is valid until reset() is called or arena is destroyed
+     */
+    void *allocate(size_t size, size_t alignment) {
+        size_t offset = (alignment - (reinterpret_cast<std::uintptr_t>(m_current) % alignment)) % alignment;
+        if (m_current == nullptr || static_cast<size_t>(m_end - m_current) < offset + size) {
+            return allocateBlock(size, alignment);
+        }
+        void *result = m_current + offset;
+        m_current += offset + size;
+        return result;
+    }
+
+    /*!
+     * \brief Creates object of type \a T in arena memory
+     *
+     * \details Object is owned by returned shared pointer and destroyed in place when last reference is released
+     */
+    template<typename T>
+    QSharedPointer<T> createShared() {
+        T *object = new (allocate(sizeof(T), alignof(T))) T;
+        m_liveObjects.ref();
+        return QSharedPointer<T>(object, [this](T *value) {
+            value->~T();
+            m_liveObjects.deref();
+        });
+    }
+
+    /*!
+     * \brief Returns all memory allocated by arena to the system
+     *
+     * \details All objects created by arena must be destroyed before this call
+     */
+    void reset();
+
+    /*!
+     * \brief Returns number of bytes allocated by arena blocks
+     */
+    size_t spaceAllocated() const {
+        return m_spaceAllocated;
+    }
+
+    /*!
+     * \brief Returns number of objects created by arena that are still alive
+     */
+    int liveObjects() const {
+        return m_liveObjects.loadAcquire();
+    }
+
+private:
+    void *allocateBlock(size_t size, size_t alignment);
+
+    Q_DISABLE_COPY_MOVE(QProtobufArena)
+
+    size_t m_blockSize;
+    size_t m_spaceAllocated;
+    char *m_current;
+    char *m_end;
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    QAtomicInt m_liveObjects;
+};
+
+}
+
+namespace QtProtobufPrivate {
+
+/*!
+ * \private
+ * \brief Returns arena used by deserialization in current thread or nullptr
+ */
+extern Q_PROTOBUF_EXPORT QtProtobuf::QProtobufArena *currentArena();
+
+/*!
+ * \private
+ * \brief Sets arena used by deserialization in current thread and returns previous one
+ */
+extern Q_PROTOBUF_EXPORT QtProtobuf::QProtobufArena *setCurrentArena(QtProtobuf::QProtobufArena *arena);
+
+/*!
+ * \private
+ * \brief The ArenaScope class sets arena for deserializations in current thread while scope is alive
+ */
+class ArenaScope
+{
+public:
+    explicit ArenaScope(QtProtobuf::QProtobufArena *arena) : m_previous(setCurrentArena(arena)) {}
+    ~ArenaScope() {
+        setCurrentArena(m_previous);
+    }
+private:
+    Q_DISABLE_COPY_MOVE(ArenaScope)
+    QtProtobuf::QProtobufArena *m_previous;
+};
+
+/*!
+ * \private
+ * \brief Creates message object of type \a T in current arena, or in heap if no arena is used
+ */
+template<typename T>
+QSharedPointer<T> createSharedMessage() {
+    StatisticsScope::messageAllocated();
+    QtProtobuf::QProtobufArena *arena = currentArena();
+    return arena != nullptr ? arena->createShared<T>() : QSharedPointer<T>(new T);
+}
+
+}
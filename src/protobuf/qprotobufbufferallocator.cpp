@@ -0,0 +1,213 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qprotobufbufferallocator.h"
+
+#include <QAtomicPointer>
+#include <QAtomicInteger>
+
+#include <algorithm>
+#include <vector>
+
+using namespace QtProtobuf;
+
+namespace {
+
+//! \brief Allocator of plain heap buffers, released buffers are freed
+class HeapBufferAllocator final : public QProtobufBufferAllocator
+{
+public:
+    QByteArray allocate(int size) override {
+        QByteArray buffer;
+        buffer.reserve(size);
+        return buffer;
+    }
+
+    void release(QByteArray &&buffer) override {
+        buffer = QByteArray();
+    }
+};
+
+HeapBufferAllocator heapAllocator;
+QAtomicPointer<QProtobufBufferAllocator> defaultAllocator(&heapAllocator);
+thread_local QProtobufBufferAllocator *threadAllocator = nullptr;
+
+QAtomicInteger<quint64> nextPoolId(1);
+
+//! \brief Returns sizes of pool classes in ascending order, four classes per power of two
+const std::vector<int> &sizeClasses()
+{
+    static const std::vector<int> classes = [] {
+        std::vector<int> result;
+        for (int base = QProtobufBufferPool::MinBufferSize; base < QProtobufBufferPool::MaxBufferSize; base *= 2) {
+            for (int quarter = 0; quarter < 4; ++quarter) {
+                result.push_back(base + base / 4 * quarter);
+            }
+        }
+        result.push_back(QProtobufBufferPool::MaxBufferSize);
+        return result;
+    }();
+    return classes;
+}
+}
+
+namespace {
+//! \brief Released buffers of pool cached by thread, by size classes
+struct ThreadCache {
+    std::vector<std::vector<QByteArray>> buffers = std::vector<std::vector<QByteArray>>(sizeClasses().size());
+    qint64 cachedSize = 0;
+};
+
+struct ThreadCacheEntry {
+    quint64 poolId;
+    std::weak_ptr<const void> alive;
+    std::unique_ptr<ThreadCache> cache;
+};
+
+//! \brief Caches of pools used by thread, caches of destroyed pools are dropped at next lookup
+struct ThreadCaches {
+    ~ThreadCaches() {
+        destroyed = true;
+    }
+    std::vector<ThreadCacheEntry> entries;
+    //Pools that are destroyed after thread-local storage of thread, e.g. static ones, don't touch it
+    static thread_local bool destroyed;
+};
+thread_local bool ThreadCaches::destroyed = false;
+thread_local ThreadCaches threadCaches;
+
+ThreadCache &threadCache(quint64 poolId, const std::shared_ptr<const void> &alive)
+{
+    std::vector<ThreadCacheEntry> &entries = threadCaches.entries;
+    for (auto &entry : entries) {
+        if (entry.poolId == poolId) {
+            return *entry.cache;
+        }
+    }
+
+    //Pool is used by thread first time, caches of destroyed pools are dropped meanwhile
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [](const ThreadCacheEntry &entry) {
+        return entry.alive.expired();
+    }), entries.end());
+    entries.push_back({poolId, alive, std::make_unique<ThreadCache>()});
+    return *entries.back().cache;
+}
+}
+
+QProtobufBufferAllocator::~QProtobufBufferAllocator() = default;
+
+QProtobufBufferAllocator *QProtobufBufferAllocator::current()
+{
+    return threadAllocator != nullptr ? threadAllocator : defaultAllocator.loadAcquire();
+}
+
+void QProtobufBufferAllocator::setDefault(QProtobufBufferAllocator *allocator)
+{
+    defaultAllocator.storeRelease(allocator != nullptr ? allocator : &heapAllocator);
+}
+
+QProtobufBufferAllocator *QtProtobufPrivate::setThreadBufferAllocator(QProtobufBufferAllocator *allocator)
+{
+    QProtobufBufferAllocator *previous = threadAllocator;
+    threadAllocator = allocator;
+    return previous;
+}
+
+QProtobufBufferPool::QProtobufBufferPool(qint64 cacheSize) : m_cacheSize(cacheSize)
+  , m_id(nextPoolId.fetchAndAddRelaxed(1))
+  , m_alive(std::make_shared<char>())
+{
+}
+
+QProtobufBufferPool::~QProtobufBufferPool()
+{
+    if (ThreadCaches::destroyed) {
+        return;
+    }
+    std::vector<ThreadCacheEntry> &entries = threadCaches.entries;
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [this](const ThreadCacheEntry &entry) {
+        return entry.poolId == m_id;
+    }), entries.end());
+}
+
+QByteArray QProtobufBufferPool::allocate(int size)
+{
+    QByteArray buffer;
+    if (size > MaxBufferSize || ThreadCaches::destroyed) {
+        buffer.reserve(size);
+        return buffer;
+    }
+
+    const std::vector<int> &classes = sizeClasses();
+    const size_t sizeClass = static_cast<size_t>(std::lower_bound(classes.begin(), classes.end(), size) - classes.begin());
+    ThreadCache &cache = threadCache(m_id, m_alive);
+    std::vector<QByteArray> &buffers = cache.buffers[sizeClass];
+    if (!buffers.empty()) {
+        buffer = std::move(buffers.back());
+        buffers.pop_back();
+        cache.cachedSize -= buffer.capacity();
+        return buffer;
+    }
+
+    buffer.reserve(classes[sizeClass]);
+    return buffer;
+}
+
+void QProtobufBufferPool::release(QByteArray &&buffer)
+{
+    QByteArray released(std::move(buffer));
+    const int capacity = released.capacity();
+    if (capacity < MinBufferSize || capacity > MaxBufferSize || !released.isDetached() || ThreadCaches::destroyed) {
+        return;
+    }
+
+    //Buffer is filed under the largest class it's able to serve
+    const std::vector<int> &classes = sizeClasses();
+    const size_t sizeClass = static_cast<size_t>(std::upper_bound(classes.begin(), classes.end(), capacity) - classes.begin()) - 1;
+    ThreadCache &cache = threadCache(m_id, m_alive);
+    if (cache.cachedSize + capacity > m_cacheSize) {
+        return;
+    }
+
+    //Reserved capacity is kept, when buffer is emptied
+    released.reserve(capacity);
+    released.resize(0);
+    cache.buffers[sizeClass].push_back(std::move(released));
+    cache.cachedSize += capacity;
+}
+
+qint64 QProtobufBufferPool::cachedSize() const
+{
+    return threadCache(m_id, m_alive).cachedSize;
+}
+
+void QProtobufBufferPool::trim()
+{
+    ThreadCache &cache = threadCache(m_id, m_alive);
+    for (auto &buffers : cache.buffers) {
+        buffers.clear();
+    }
+    cache.cachedSize = 0;
+}
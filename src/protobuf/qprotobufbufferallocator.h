@@ -0,0 +1,165 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufBufferAllocator
+
+#include <QByteArray>
+
+#include "qtprotobufglobal.h"
+
+#include <memory>
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufBufferAllocator class is interface of allocator of serialization and network buffers
+ *
+ * \details Serializers allocate output buffers and channels allocate buffers of received messages and request
+ *          bodies using allocator returned by current(). Buffers that are no longer needed are given back
+ *          by release(). Buffer is released by its last user only when it's not shared, so implementation may
+ *          reuse storage of released buffer for next allocations.
+ *
+ *          By default buffers are allocated in heap and released buffers are freed. Allocator is selected for
+ *          whole application using setDefault() or for current thread using QtProtobufPrivate::BufferAllocatorScope.
+ *          \code
+ *          static QProtobufBufferPool pool;
+ *          QProtobufBufferAllocator::setDefault(&pool);
+ *          \endcode
+ *
+ * \see QProtobufBufferPool
+ */
+class Q_PROTOBUF_EXPORT QProtobufBufferAllocator
+{
+public:
+    virtual ~QProtobufBufferAllocator();
+
+    /*!
+     * \brief Returns empty buffer, that is able to hold at least \a size bytes without reallocation
+     */
+    virtual QByteArray allocate(int size) = 0;
+
+    /*!
+     * \brief Takes back \a buffer, that is no longer used by caller
+     *
+     * \details Buffer shared with other owners is only dereferenced, its storage may not be reused
+     */
+    virtual void release(QByteArray &&buffer) = 0;
+
+    /*!
+     * \brief Returns allocator of current thread, or default allocator if thread doesn't use own one
+     */
+    static QProtobufBufferAllocator *current();
+
+    /*!
+     * \brief Sets default allocator of application. nullptr restores heap allocator.
+     *
+     * \details Allocator is not owned and has to outlive all serializations and calls. Default allocator is
+     *          supposed to be set once, before serializers and channels are used.
+     */
+    static void setDefault(QProtobufBufferAllocator *allocator);
+};
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufBufferPool class is buffer allocator, that recycles released buffers by size classes
+ *
+ * \details Requested sizes are rounded up to size classes, that are spaced by quarters of powers of two,
+ *          so buffer of any class is reused for requests of the same class and at most quarter of buffer is
+ *          wasted. Released buffers are cached per thread, allocations and releases don't take locks.
+ *          Buffer released in other thread than it was allocated in is reused by allocations of that thread.
+ *
+ *          Steady flow of messages of varying sizes is served from the same set of buffers instead of
+ *          allocating and freeing storage of every message, that keeps heap of long running process from
+ *          fragmentation. Buffers smaller than MinBufferSize and larger than MaxBufferSize are not cached.
+ *          Cached buffers of each thread are limited by cacheSize bytes, buffers above the limit are freed.
+ *
+ *          Pool is thread safe. Caches of thread are freed when pool is destroyed in that thread, or when
+ *          thread is finished.
+ */
+class Q_PROTOBUF_EXPORT QProtobufBufferPool final : public QProtobufBufferAllocator
+{
+public:
+    enum {
+        MinBufferSize = 256,
+        MaxBufferSize = 4 * 1024 * 1024,
+        DefaultCacheSize = 16 * 1024 * 1024
+    };
+
+    /*!
+     * \brief Constructs pool, that caches up to \a cacheSize bytes of released buffers per thread
+     */
+    explicit QProtobufBufferPool(qint64 cacheSize = DefaultCacheSize);
+    ~QProtobufBufferPool();
+
+    QByteArray allocate(int size) override;
+    void release(QByteArray &&buffer) override;
+
+    /*!
+     * \brief Returns total capacity of buffers cached by current thread
+     */
+    qint64 cachedSize() const;
+
+    /*!
+     * \brief Frees buffers cached by current thread
+     */
+    void trim();
+
+private:
+    Q_DISABLE_COPY_MOVE(QProtobufBufferPool)
+
+    qint64 m_cacheSize;
+    quint64 m_id;
+    //Expires when pool is destroyed, so caches of destroyed pool are dropped by other threads
+    std::shared_ptr<const void> m_alive;
+};
+
+}
+
+namespace QtProtobufPrivate {
+
+/*!
+ * \private
+ * \brief Sets buffer allocator of current thread and returns previous one
+ */
+extern Q_PROTOBUF_EXPORT QtProtobuf::QProtobufBufferAllocator *setThreadBufferAllocator(QtProtobuf::QProtobufBufferAllocator *allocator);
+
+/*!
+ * \private
+ * \brief The BufferAllocatorScope class sets buffer allocator of current thread while scope is alive
+ */
+class BufferAllocatorScope
+{
+public:
+    explicit BufferAllocatorScope(QtProtobuf::QProtobufBufferAllocator *allocator) : m_previous(setThreadBufferAllocator(allocator)) {}
+    ~BufferAllocatorScope() {
+        setThreadBufferAllocator(m_previous);
+    }
+private:
+    Q_DISABLE_COPY_MOVE(BufferAllocatorScope)
+    QtProtobuf::QProtobufBufferAllocator *m_previous;
+};
+
+}
@@ -0,0 +1,299 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qprotobufcolumndecoder.h"
+
+#include "qprotobufmetaobject.h"
+#include "qprotobufselfcheckiterator.h"
+#include "qprotobufserializer_p.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace QtProtobuf;
+
+namespace {
+
+template<typename V>
+V readBasic(QProtobufSelfcheckIterator &it)
+{
+    V value{};
+    QProtobufSerializerPrivate::deserializeBasic<V>(it, value);
+    return value;
+}
+
+WireTypes wireTypeOf(FieldKind kind)
+{
+    switch (kind) {
+    case FieldKind::Fixed32:
+    case FieldKind::SFixed32:
+    case FieldKind::Float:
+        return Fixed32;
+    case FieldKind::Fixed64:
+    case FieldKind::SFixed64:
+    case FieldKind::Double:
+        return Fixed64;
+    case FieldKind::String:
+    case FieldKind::Bytes:
+        return LengthDelimited;
+    default:
+        break;
+    }
+    return Varint;
+}
+
+}
+
+QProtobufColumnDecoder::QProtobufColumnDecoder(const QProtobufMetaObject &rowType) : m_rowType(rowType)
+{
+}
+
+bool QProtobufColumnDecoder::bindColumn(int fieldNumber, ColumnType type, void *column)
+{
+    if (m_rowType.fieldDescriptors == nullptr || column == nullptr) {
+        return false;
+    }
+
+    const QProtobufFieldDescriptor *begin = m_rowType.fieldDescriptors;
+    const QProtobufFieldDescriptor *end = begin + m_rowType.propertyOrdering.size();
+    const QProtobufFieldDescriptor *field = std::find_if(begin, end, [fieldNumber](const QProtobufFieldDescriptor &descriptor) {
+        return descriptor.fieldNumber == fieldNumber;
+    });
+    if (field == end || field->repeated) {
+        return false;
+    }
+
+    ColumnType expectedType = UnsupportedColumn;
+    switch (field->kind) {
+    case FieldKind::Int32:
+    case FieldKind::SInt32:
+    case FieldKind::SFixed32:
+    case FieldKind::Enum:
+        expectedType = Int32Column;
+        break;
+    case FieldKind::Int64:
+    case FieldKind::SInt64:
+    case FieldKind::SFixed64:
+        expectedType = Int64Column;
+        break;
+    case FieldKind::UInt32:
+    case FieldKind::Fixed32:
+        expectedType = UInt32Column;
+        break;
+    case FieldKind::UInt64:
+    case FieldKind::Fixed64:
+        expectedType = UInt64Column;
+        break;
+    case FieldKind::Float:
+        expectedType = FloatColumn;
+        break;
+    case FieldKind::Double:
+        expectedType = DoubleColumn;
+        break;
+    case FieldKind::Bool:
+        expectedType = BoolColumn;
+        break;
+    case FieldKind::String:
+        expectedType = StringColumn;
+        break;
+    case FieldKind::Bytes:
+        expectedType = BytesColumn;
+        break;
+    default:
+        break;
+    }
+    if (expectedType == UnsupportedColumn || expectedType != type) {
+        return false;
+    }
+
+    //Field bound again is written to the last bound column
+    auto it = std::lower_bound(m_columns.begin(), m_columns.end(), fieldNumber, [](const Column &column, int number) {
+        return column.fieldNumber < number;
+    });
+    if (it != m_columns.end() && it->fieldNumber == fieldNumber) {
+        it->data = column;
+    } else {
+        m_columns.insert(it, Column{fieldNumber, field->kind, type, column});
+    }
+    return true;
+}
+
+int QProtobufColumnDecoder::fieldNumberOf(const char *protoName) const
+{
+    if (m_rowType.fieldDescriptors == nullptr || protoName == nullptr) {
+        return QtProtobufPrivate::NotUsedFieldIndex;
+    }
+    for (size_t i = 0; i < m_rowType.propertyOrdering.size(); ++i) {
+        if (std::strcmp(m_rowType.fieldDescriptors[i].protoName, protoName) == 0) {
+            return m_rowType.fieldDescriptors[i].fieldNumber;
+        }
+    }
+    return QtProtobufPrivate::NotUsedFieldIndex;
+}
+
+DeserializationError QProtobufColumnDecoder::decode(const QByteArray &data, int fieldNumber)
+{
+    QtProtobufPrivate::DeserializationErrorScope scope;
+    for (QProtobufSelfcheckIterator it(data); it != data.end()
+         && QtProtobufPrivate::deserializationError() == NoDeserializationError;) {
+        int number = QtProtobufPrivate::NotUsedFieldIndex;
+        WireTypes wireType = UnknownWireType;
+        if (!QProtobufSerializerPrivate::decodeHeader(it, number, wireType)) {
+            QtProtobufPrivate::reportDeserializationError(InvalidHeaderError, "Message received doesn't contains valid header byte. "
+                                                                              "Seems stream is broken");
+            break;
+        }
+        if (number != fieldNumber || wireType != LengthDelimited) {
+            QProtobufSerializerPrivate::skipSerializedFieldBytes(it, wireType);
+            continue;
+        }
+        const QByteArray row = QProtobufSerializerPrivate::deserializeLengthDelimitedView(it);
+        if (QtProtobufPrivate::deserializationError() == NoDeserializationError) {
+            parseRow(row.constData(), row.size());
+        }
+    }
+    return scope.error();
+}
+
+DeserializationError QProtobufColumnDecoder::decodeRow(const QByteArray &data)
+{
+    QtProtobufPrivate::DeserializationErrorScope scope;
+    parseRow(data.constData(), data.size());
+    return scope.error();
+}
+
+void QProtobufColumnDecoder::parseRow(const char *data, int size)
+{
+    //Row gets default values first, so columns stay aligned when fields are not received
+    for (const Column &column : m_columns) {
+        switch (column.type) {
+        case Int32Column:
+            static_cast<QVector<qint32> *>(column.data)->append(0);
+            break;
+        case Int64Column:
+            static_cast<QVector<qint64> *>(column.data)->append(0);
+            break;
+        case UInt32Column:
+            static_cast<QVector<quint32> *>(column.data)->append(0);
+            break;
+        case UInt64Column:
+            static_cast<QVector<quint64> *>(column.data)->append(0);
+            break;
+        case FloatColumn:
+            static_cast<QVector<float> *>(column.data)->append(0.0f);
+            break;
+        case DoubleColumn:
+            static_cast<QVector<double> *>(column.data)->append(0.0);
+            break;
+        case BoolColumn:
+            static_cast<QVector<bool> *>(column.data)->append(false);
+            break;
+        case StringColumn:
+            static_cast<QVector<QString> *>(column.data)->append(QString());
+            break;
+        case BytesColumn:
+            static_cast<QVector<QByteArray> *>(column.data)->append(QByteArray());
+            break;
+        default:
+            break;
+        }
+    }
+    ++m_rowCount;
+
+    const QByteArray row = QByteArray::fromRawData(data, size);
+    for (QProtobufSelfcheckIterator it(row); it != row.end()
+         && QtProtobufPrivate::deserializationError() == NoDeserializationError;) {
+        int fieldNumber = QtProtobufPrivate::NotUsedFieldIndex;
+        WireTypes wireType = UnknownWireType;
+        if (!QProtobufSerializerPrivate::decodeHeader(it, fieldNumber, wireType)) {
+            QtProtobufPrivate::reportDeserializationError(InvalidHeaderError, "Message received doesn't contains valid header byte. "
+                                                                              "Seems stream is broken");
+            return;
+        }
+
+        auto columnIt = std::lower_bound(m_columns.cbegin(), m_columns.cend(), fieldNumber, [](const Column &column, int number) {
+            return column.fieldNumber < number;
+        });
+        if (columnIt == m_columns.cend() || columnIt->fieldNumber != fieldNumber || wireType != wireTypeOf(columnIt->kind)) {
+            QProtobufSerializerPrivate::skipSerializedFieldBytes(it, wireType);
+            continue;
+        }
+
+        void *column = columnIt->data;
+        switch (columnIt->kind) {
+        case FieldKind::Int32:
+            static_cast<QVector<qint32> *>(column)->last() = readBasic<int32>(it)._t;
+            break;
+        case FieldKind::SInt32:
+            static_cast<QVector<qint32> *>(column)->last() = readBasic<int32_t>(it);
+            break;
+        case FieldKind::SFixed32:
+            static_cast<QVector<qint32> *>(column)->last() = readBasic<sfixed32>(it)._t;
+            break;
+        case FieldKind::Enum:
+            static_cast<QVector<qint32> *>(column)->last() = static_cast<qint32>(readBasic<int64>(it)._t);
+            break;
+        case FieldKind::Int64:
+            static_cast<QVector<qint64> *>(column)->last() = readBasic<int64>(it)._t;
+            break;
+        case FieldKind::SInt64:
+            static_cast<QVector<qint64> *>(column)->last() = readBasic<int64_t>(it);
+            break;
+        case FieldKind::SFixed64:
+            static_cast<QVector<qint64> *>(column)->last() = readBasic<sfixed64>(it)._t;
+            break;
+        case FieldKind::UInt32:
+            static_cast<QVector<quint32> *>(column)->last() = readBasic<uint32_t>(it);
+            break;
+        case FieldKind::Fixed32:
+            static_cast<QVector<quint32> *>(column)->last() = readBasic<fixed32>(it)._t;
+            break;
+        case FieldKind::UInt64:
+            static_cast<QVector<quint64> *>(column)->last() = readBasic<uint64_t>(it);
+            break;
+        case FieldKind::Fixed64:
+            static_cast<QVector<quint64> *>(column)->last() = readBasic<fixed64>(it)._t;
+            break;
+        case FieldKind::Float:
+            static_cast<QVector<float> *>(column)->last() = readBasic<float>(it);
+            break;
+        case FieldKind::Double:
+            static_cast<QVector<double> *>(column)->last() = readBasic<double>(it);
+            break;
+        case FieldKind::Bool:
+            static_cast<QVector<bool> *>(column)->last() = readBasic<uint64_t>(it) != 0;
+            break;
+        case FieldKind::String:
+            static_cast<QVector<QString> *>(column)->last() = readBasic<QString>(it);
+            break;
+        case FieldKind::Bytes:
+            static_cast<QVector<QByteArray> *>(column)->last() = readBasic<QByteArray>(it);
+            break;
+        default:
+            QProtobufSerializerPrivate::skipSerializedFieldBytes(it, wireType);
+            break;
+        }
+    }
+}
@@ -0,0 +1,152 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufColumnDecoder
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include <vector>
+
+#include "qtprotobufglobal.h"
+#include "qtprotobuftypes.h"
+
+namespace QtProtobuf {
+
+class QProtobufMetaObject;
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufColumnDecoder class decodes repeated message field to column vectors
+ *
+ * \details Each field of row message type may be bound to column vector. Rows of repeated field are decoded
+ *          directly to columns, without creation of row message objects. Fields that are not received in a row
+ *          get default value, so all columns have the same number of elements. Fields that are not bound are
+ *          skipped.
+ *          \code
+ *          QVector<qint64> timestamps;
+ *          QVector<double> values;
+ *          QProtobufColumnDecoder decoder(Sample::protobufMetaObject);
+ *          decoder.bind("ts", &timestamps);
+ *          decoder.bind("value", &values);
+ *          decoder.decode(data, 1);//Number of repeated Sample field of Batch message
+ *          \endcode
+ *
+ *          Singular fields of scalar, string and bytes types may be bound. Column element type depends on
+ *          field type:
+ *          - qint32 for int32, sint32, sfixed32 and enumeration fields
+ *          - qint64 for int64, sint64 and sfixed64 fields
+ *          - quint32 for uint32 and fixed32 fields, quint64 for uint64 and fixed64 fields
+ *          - float, double, bool, QString and QByteArray for float, double, bool, string and bytes fields
+ *
+ *          Row message type must be generated with field descriptor tables.
+ */
+class Q_PROTOBUF_EXPORT QProtobufColumnDecoder
+{
+public:
+    explicit QProtobufColumnDecoder(const QProtobufMetaObject &rowType);
+
+    /*!
+     * \brief Binds field with \a fieldNumber of row message type to \a column
+     *
+     * \details Decoded rows are appended to \a column, that must outlive decoder.
+     * \return false if there is no such field or its type doesn't match type of \a column elements
+     */
+    template<typename T>
+    bool bind(int fieldNumber, QVector<T> *column) {
+        return bindColumn(fieldNumber, ColumnTraits<T>::type, column);
+    }
+
+    /*!
+     * \brief Binds field with \a protoName of row message type to \a column
+     */
+    template<typename T>
+    bool bind(const char *protoName, QVector<T> *column) {
+        return bindColumn(fieldNumberOf(protoName), ColumnTraits<T>::type, column);
+    }
+
+    /*!
+     * \brief Decodes rows of repeated field with \a fieldNumber of serialized message \a data to bound columns
+     *
+     * \details Other fields of \a data are skipped. Rows decoded before error are kept in columns.
+     */
+    DeserializationError decode(const QByteArray &data, int fieldNumber);
+
+    /*!
+     * \brief Decodes serialized row message \a data to bound columns
+     */
+    DeserializationError decodeRow(const QByteArray &data);
+
+    /*!
+     * \brief Returns number of rows decoded since decoder is created
+     */
+    int rowCount() const {
+        return m_rowCount;
+    }
+
+private:
+    enum ColumnType {
+        Int32Column,
+        Int64Column,
+        UInt32Column,
+        UInt64Column,
+        FloatColumn,
+        DoubleColumn,
+        BoolColumn,
+        StringColumn,
+        BytesColumn,
+        UnsupportedColumn
+    };
+
+    template<typename T> struct ColumnTraits { static constexpr ColumnType type = UnsupportedColumn; };
+
+    struct Column {
+        int fieldNumber;
+        FieldKind kind;
+        ColumnType type;
+        void *data;
+    };
+
+    bool bindColumn(int fieldNumber, ColumnType type, void *column);
+    int fieldNumberOf(const char *protoName) const;
+    void parseRow(const char *data, int size);
+
+    const QProtobufMetaObject &m_rowType;
+    std::vector<Column> m_columns;//!< Sorted by field number
+    int m_rowCount = 0;
+};
+
+template<> struct QProtobufColumnDecoder::ColumnTraits<qint32> { static constexpr ColumnType type = Int32Column; };
+template<> struct QProtobufColumnDecoder::ColumnTraits<qint64> { static constexpr ColumnType type = Int64Column; };
+template<> struct QProtobufColumnDecoder::ColumnTraits<quint32> { static constexpr ColumnType type = UInt32Column; };
+template<> struct QProtobufColumnDecoder::ColumnTraits<quint64> { static constexpr ColumnType type = UInt64Column; };
+template<> struct QProtobufColumnDecoder::ColumnTraits<float> { static constexpr ColumnType type = FloatColumn; };
+template<> struct QProtobufColumnDecoder::ColumnTraits<double> { static constexpr ColumnType type = DoubleColumn; };
+template<> struct QProtobufColumnDecoder::ColumnTraits<bool> { static constexpr ColumnType type = BoolColumn; };
+template<> struct QProtobufColumnDecoder::ColumnTraits<QString> { static constexpr ColumnType type = StringColumn; };
+template<> struct QProtobufColumnDecoder::ColumnTraits<QByteArray> { static constexpr ColumnType type = BytesColumn; };
+
+}
@@ -0,0 +1,162 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qprotobufdelimitedstream.h"
+#include "qtprotobuflogging.h"
+
+#include <QIODevice>
+
+#include <algorithm>
+#include <limits>
+
+using namespace QtProtobuf;
+
+namespace {
+//Maximum size of varint encoded message size
+const int MaxSizePrefixLength = 5;
+}
+
+QProtobufDelimitedStream::QProtobufDelimitedStream(QIODevice *device, QAbstractProtobufSerializer *serializer) : m_device(device)
+  , m_serializer(serializer)
+  , m_readPosition(0)
+  , m_error(false)
+{
+    Q_ASSERT(m_device != nullptr);
+    Q_ASSERT(m_serializer != nullptr);
+    m_writeBuffer.reserve(BufferSize);
+}
+
+QProtobufDelimitedStream::~QProtobufDelimitedStream()
+{
+    flush();
+}
+
+bool QProtobufDelimitedStream::writeMessageData(const QByteArray &data)
+{
+    uint32_t size = static_cast<uint32_t>(data.size());
+    while (size >= 0x80) {
+        m_writeBuffer.append(static_cast<char>((size & 0x7f) | 0x80));
+        size >>= 7;
+    }
+    m_writeBuffer.append(static_cast<char>(size));
+    m_writeBuffer.append(data);
+
+    //Small messages are collected and written to device by single call
+    if (m_writeBuffer.size() >= BufferSize) {
+        return flush();
+    }
+    return true;
+}
+
+bool QProtobufDelimitedStream::flush()
+{
+    if (m_writeBuffer.isEmpty()) {
+        return true;
+    }
+
+    const qint64 written = m_device->write(m_writeBuffer);
+    const bool result = written == m_writeBuffer.size();
+    if (!result) {
+        qProtoWarning() << "Unable to write messages to device:" << m_device->errorString();
+        m_error = true;
+    }
+    //Reserved capacity is kept, so buffer is reused for the next messages
+    m_writeBuffer.resize(0);
+    return result;
+}
+
+bool QProtobufDelimitedStream::readMessageData(QByteArray &data)
+{
+    if (m_error) {
+        return false;
+    }
+
+    while (true) {
+        const char *begin = m_readBuffer.constData() + m_readPosition;
+        const int available = m_readBuffer.size() - m_readPosition;
+
+        uint64_t size = 0;
+        int prefixLength = 0;
+        bool prefixComplete = false;
+        while (prefixLength < available && prefixLength < MaxSizePrefixLength) {
+            const uint8_t byte = static_cast<uint8_t>(begin[prefixLength]);
+            size |= static_cast<uint64_t>(byte & 0x7f) << (7 * prefixLength);
+            ++prefixLength;
+            if ((byte & 0x80) == 0) {
+                prefixComplete = true;
+                break;
+            }
+        }
+
+        int requiredSize = available + 1;
+        if (prefixComplete) {
+            if (size > static_cast<uint64_t>(std::numeric_limits<int>::max() - prefixLength)) {
+                qProtoWarning() << "Invalid message size in stream" << size;
+                m_error = true;
+                return false;
+            }
+
+            requiredSize = prefixLength + static_cast<int>(size);
+            if (available >= requiredSize) {
+                data = QByteArray(begin + prefixLength, static_cast<int>(size));
+                m_readPosition += requiredSize;
+                return true;
+            }
+        } else if (prefixLength == MaxSizePrefixLength) {
+            qProtoWarning() << "Invalid message size prefix in stream";
+            m_error = true;
+            return false;
+        }
+
+        if (!fillReadBuffer(requiredSize)) {
+            if (available > 0 && !m_device->isSequential() && m_device->atEnd()) {
+                qProtoWarning() << "Last message in stream is truncated";
+                m_error = true;
+            }
+            return false;
+        }
+    }
+}
+
+bool QProtobufDelimitedStream::fillReadBuffer(int requiredSize)
+{
+    //Consumed messages are dropped once per read, instead of once per message
+    if (m_readPosition > 0) {
+        m_readBuffer.remove(0, m_readPosition);
+        m_readPosition = 0;
+    }
+
+    const int size = m_readBuffer.size();
+    const int readSize = std::max<int>(BufferSize, requiredSize - size);
+    m_readBuffer.resize(size + readSize);
+    const qint64 received = m_device->read(m_readBuffer.data() + size, readSize);
+    m_readBuffer.resize(size + static_cast<int>(std::max<qint64>(received, 0)));
+    if (received < 0) {
+        qProtoWarning() << "Unable to read messages from device:" << m_device->errorString();
+        m_error = true;
+        return false;
+    }
+    return received > 0;
+}
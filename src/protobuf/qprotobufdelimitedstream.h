@@ -0,0 +1,138 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufDelimitedStream
+
+#include <QByteArray>
+
+#include "qtprotobufglobal.h"
+#include "qabstractprotobufserializer.h"
+
+QT_FORWARD_DECLARE_CLASS(QIODevice)
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufDelimitedStream class reads and writes sequence of length-delimited messages
+ *
+ * \details Every message in the sequence is prefixed with its size encoded as varint. This is the same
+ *          format as used by writeDelimitedTo and parseDelimitedFrom functions of protobuf library.
+ *
+ *          Written messages are collected in internal buffer and written to device by chunks of
+ *          BufferSize bytes, call flush() to write collected messages immediately. Messages are read
+ *          from device by chunks of the same size into reusable buffer.
+ *          \code
+ *          QProtobufDelimitedStream stream(&file, &serializer);
+ *          for (const auto &record : records) {
+ *              stream.write(record);
+ *          }
+ *          stream.flush();
+ *          ...
+ *          Record record;
+ *          while (stream.read(&record)) {
+ *              ...
+ *          }
+ *          \endcode
+ *
+ *          Device and serializer must outlive the stream. Stream doesn't take ownership of them.
+ */
+class Q_PROTOBUF_EXPORT QProtobufDelimitedStream
+{
+public:
+    enum {
+        BufferSize = 64 * 1024 //!< Size of chunks that are written or read from device
+    };
+
+    QProtobufDelimitedStream(QIODevice *device, QAbstractProtobufSerializer *serializer);
+    /*!
+     * \brief Flushes messages that are not written to device yet
+     */
+    ~QProtobufDelimitedStream();
+
+    /*!
+     * \brief Appends \a message to the stream
+     * \return false if writing to device failed
+     */
+    template<typename T>
+    bool write(const T &message) {
+        return writeMessageData(m_serializer->serialize<T>(&message));
+    }
+
+    /*!
+     * \brief Reads next message from the stream to \a message
+     * \return false if there is no more complete messages in device or if data is not valid. Use hasError()
+     *         to distinguish these cases
+     */
+    template<typename T>
+    bool read(T *message) {
+        Q_ASSERT(message != nullptr);
+        QByteArray data;
+        if (!readMessageData(data)) {
+            return false;
+        }
+        m_serializer->deserialize<T>(message, data);
+        return true;
+    }
+
+    /*!
+     * \brief Appends already serialized message \a data to the stream
+     * \return false if writing to device failed
+     */
+    bool writeMessageData(const QByteArray &data);
+
+    /*!
+     * \brief Reads serialized data of next message in the stream to \a data
+     * \return false if there is no more complete messages in device or if data is not valid
+     */
+    bool readMessageData(QByteArray &data);
+
+    /*!
+     * \brief Writes collected messages to device
+     * \return false if writing to device failed
+     */
+    bool flush();
+
+    /*!
+     * \brief Returns true if invalid data was read or if writing to device failed
+     */
+    bool hasError() const {
+        return m_error;
+    }
+
+private:
+    Q_DISABLE_COPY_MOVE(QProtobufDelimitedStream)
+
+    bool fillReadBuffer(int requiredSize);
+
+    QIODevice *m_device;
+    QAbstractProtobufSerializer *m_serializer;
+    QByteArray m_writeBuffer;
+    QByteArray m_readBuffer;
+    int m_readPosition;
+    bool m_error;
+};
+
+}
@@ -0,0 +1,118 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufDispatchTable
+
+#include <QMutex>
+#include <QAtomicPointer>
+
+#include <list>
+#include <unordered_map>
+
+namespace QtProtobufPrivate {
+
+/*!
+ * \private
+ * \brief The DispatchTable class is flat, densely indexed table that maps metatype identifiers to handlers
+ *
+ * \details Metatype identifiers are small sequential integers, so values are published in two level table
+ * of atomic pointers indexed by metatype identifier. Insertion is serialized by mutex and never moves or
+ * frees published values, this allows lookups without locks and allocations. Values for metatype
+ * identifiers that don't fit table are stored in fallback map guarded by mutex.
+ */
+template <typename T>
+class DispatchTable
+{
+    Q_DISABLE_COPY_MOVE(DispatchTable)
+public:
+    DispatchTable() = default;
+    ~DispatchTable() {
+        for (auto &chunk : m_chunks) {
+            delete chunk.loadAcquire();
+        }
+    }
+
+    /*!
+     * \brief Looks up value assigned to \a userType
+     * \return pointer to value or nullptr if nothing is assigned to \a userType. Pointer stays valid
+     *         until table is destroyed.
+     */
+    const T *find(int userType) const {
+        if (!isDense(userType)) {
+            QMutexLocker locker(&m_writeLock);
+            auto it = m_overflow.find(userType);
+            return it != m_overflow.end() ? it->second : nullptr;
+        }
+
+        const Chunk *chunk = m_chunks[userType / ChunkSize].loadAcquire();
+        return chunk != nullptr ? chunk->values[userType % ChunkSize].loadAcquire() : nullptr;
+    }
+
+    /*!
+     * \brief Assigns \a value to \a userType
+     * \details Previously assigned value is kept alive, it still might be in use by concurrent reader.
+     * \return pointer to stored value
+     */
+    const T *insert(int userType, const T &value) {
+        QMutexLocker locker(&m_writeLock);
+        m_storage.push_back(value);
+        const T *stored = &m_storage.back();
+
+        if (!isDense(userType)) {
+            m_overflow[userType] = stored;
+            return stored;
+        }
+
+        auto &chunkPointer = m_chunks[userType / ChunkSize];
+        Chunk *chunk = chunkPointer.loadAcquire();
+        if (chunk == nullptr) {
+            chunk = new Chunk;
+            chunkPointer.storeRelease(chunk);
+        }
+        chunk->values[userType % ChunkSize].storeRelease(stored);
+        return stored;
+    }
+
+private:
+    enum {
+        ChunkSize = 256,
+        ChunkCount = 1024
+    };
+
+    struct Chunk {
+        QAtomicPointer<const T> values[ChunkSize];
+    };
+
+    static bool isDense(int userType) {
+        return userType >= 0 && userType < ChunkSize * ChunkCount;
+    }
+
+    mutable QMutex m_writeLock;
+    QAtomicPointer<Chunk> m_chunks[ChunkCount];
+    std::list<T> m_storage;
+    std::unordered_map<int/*metatypeid*/, const T *> m_overflow;
+};
+
+}
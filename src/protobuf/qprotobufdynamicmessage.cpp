@@ -0,0 +1,903 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qprotobufdynamicmessage.h"
+
+#include "qprotobufmetaobject.h"
+#include "qprotobufselfcheckiterator.h"
+#include "qprotobufserializer_p.h"
+#include "qprotobufwireformat.h"
+
+#include <algorithm>
+
+using namespace QtProtobuf;
+
+namespace {
+
+//Message types may be recursive, so nesting of received messages is limited
+const int MaxNestingDepth = 100;
+
+//Field types of google.protobuf.FieldDescriptorProto
+enum DescriptorFieldType {
+    TypeDouble = 1,
+    TypeFloat,
+    TypeInt64,
+    TypeUInt64,
+    TypeInt32,
+    TypeFixed64,
+    TypeFixed32,
+    TypeBool,
+    TypeString,
+    TypeGroup,
+    TypeMessage,
+    TypeBytes,
+    TypeUInt32,
+    TypeEnum,
+    TypeSFixed32,
+    TypeSFixed64,
+    TypeSInt32,
+    TypeSInt64
+};
+
+const int LabelRepeated = 3;
+
+bool kindFromDescriptorType(int type, FieldKind &kind)
+{
+    static const FieldKind kinds[] = {
+        FieldKind::Double, FieldKind::Float, FieldKind::Int64, FieldKind::UInt64, FieldKind::Int32,
+        FieldKind::Fixed64, FieldKind::Fixed32, FieldKind::Bool, FieldKind::String, FieldKind::Message,
+        FieldKind::Message, FieldKind::Bytes, FieldKind::UInt32, FieldKind::Enum, FieldKind::SFixed32,
+        FieldKind::SFixed64, FieldKind::SInt32, FieldKind::SInt64
+    };
+    if (type < TypeDouble || type > TypeSInt64 || type == TypeGroup) {
+        return false;
+    }
+    kind = kinds[type - TypeDouble];
+    return true;
+}
+
+WireTypes wireTypeOf(FieldKind kind)
+{
+    switch (kind) {
+    case FieldKind::Fixed32:
+    case FieldKind::SFixed32:
+    case FieldKind::Float:
+        return Fixed32;
+    case FieldKind::Fixed64:
+    case FieldKind::SFixed64:
+    case FieldKind::Double:
+        return Fixed64;
+    case FieldKind::String:
+    case FieldKind::Bytes:
+    case FieldKind::Message:
+    case FieldKind::Map:
+        return LengthDelimited;
+    default:
+        break;
+    }
+    return Varint;
+}
+
+bool isScalar(FieldKind kind)
+{
+    return wireTypeOf(kind) != LengthDelimited;
+}
+
+int storageTypeOf(FieldKind kind)
+{
+    switch (kind) {
+    case FieldKind::Int32:
+    case FieldKind::SInt32:
+    case FieldKind::SFixed32:
+    case FieldKind::Enum:
+        return QMetaType::Int;
+    case FieldKind::Int64:
+    case FieldKind::SInt64:
+    case FieldKind::SFixed64:
+        return QMetaType::LongLong;
+    case FieldKind::UInt32:
+    case FieldKind::Fixed32:
+        return QMetaType::UInt;
+    case FieldKind::UInt64:
+    case FieldKind::Fixed64:
+        return QMetaType::ULongLong;
+    case FieldKind::Float:
+        return QMetaType::Float;
+    case FieldKind::Double:
+        return QMetaType::Double;
+    case FieldKind::Bool:
+        return QMetaType::Bool;
+    case FieldKind::String:
+        return QMetaType::QString;
+    case FieldKind::Bytes:
+        return QMetaType::QByteArray;
+    default:
+        break;
+    }
+    return qMetaTypeId<QProtobufDynamicMessage>();
+}
+
+QVariant defaultValue(const QProtobufDynamicField &field)
+{
+    if (field.repeated) {
+        return QVariantList();
+    }
+    if (field.kind == FieldKind::Message) {
+        return QVariant::fromValue(QProtobufDynamicMessage(field.messageType));
+    }
+    return QVariant(storageTypeOf(field.kind), nullptr);
+}
+
+bool isDefault(const QVariant &value, FieldKind kind)
+{
+    switch (kind) {
+    case FieldKind::String:
+        return value.toString().isEmpty();
+    case FieldKind::Bytes:
+        return value.toByteArray().isEmpty();
+    case FieldKind::Float:
+    case FieldKind::Double:
+        return value.toDouble() == 0.0;
+    case FieldKind::Bool:
+        return !value.toBool();
+    case FieldKind::Message:
+        //Message fields are written if set
+        return false;
+    default:
+        break;
+    }
+    return value.toULongLong() == 0;
+}
+
+template<typename V>
+void appendFixed(const V &value, QByteArray &buffer)
+{
+    char encoded[sizeof(V)];
+    QProtobufSerializerPrivate::encodeFixed(value, encoded);
+    buffer.append(encoded, sizeof(V));
+}
+
+//Appends value without header, zero values are written as well, e.g. elements of non-packed lists
+void writeScalar(const QVariant &value, FieldKind kind, QByteArray &buffer)
+{
+    switch (kind) {
+    case FieldKind::Int32:
+    case FieldKind::Int64:
+    case FieldKind::Enum:
+        QProtobufSerializerPrivate::serializeVarintCommon<uint64_t>(static_cast<uint64_t>(value.toLongLong()), buffer);
+        break;
+    case FieldKind::UInt32:
+    case FieldKind::UInt64:
+        QProtobufSerializerPrivate::serializeVarintCommon<uint64_t>(value.toULongLong(), buffer);
+        break;
+    case FieldKind::Bool:
+        QProtobufSerializerPrivate::serializeVarintCommon<uint64_t>(value.toBool() ? 1 : 0, buffer);
+        break;
+    case FieldKind::SInt32: {
+        const int32_t signedValue = value.toInt();
+        QProtobufSerializerPrivate::serializeVarintCommon<uint32_t>((static_cast<uint32_t>(signedValue) << 1)
+                                                                    ^ static_cast<uint32_t>(signedValue >> 31), buffer);
+    }
+        break;
+    case FieldKind::SInt64: {
+        const int64_t signedValue = value.toLongLong();
+        QProtobufSerializerPrivate::serializeVarintCommon<uint64_t>((static_cast<uint64_t>(signedValue) << 1)
+                                                                    ^ static_cast<uint64_t>(signedValue >> 63), buffer);
+    }
+        break;
+    case FieldKind::Fixed32:
+        appendFixed(fixed32(value.toUInt()), buffer);
+        break;
+    case FieldKind::SFixed32:
+        appendFixed(sfixed32(value.toInt()), buffer);
+        break;
+    case FieldKind::Fixed64:
+        appendFixed(fixed64(value.toULongLong()), buffer);
+        break;
+    case FieldKind::SFixed64:
+        appendFixed(sfixed64(value.toLongLong()), buffer);
+        break;
+    case FieldKind::Float:
+        appendFixed(value.toFloat(), buffer);
+        break;
+    case FieldKind::Double:
+        appendFixed(value.toDouble(), buffer);
+        break;
+    case FieldKind::String:
+        QProtobufSerializerPrivate::serializeString(value.toString(), buffer);
+        break;
+    case FieldKind::Bytes:
+        QProtobufSerializerPrivate::serializeLengthDelimited(value.toByteArray(), buffer);
+        break;
+    default:
+        break;
+    }
+}
+
+template<typename V>
+V readBasic(QProtobufSelfcheckIterator &it)
+{
+    V value{};
+    QProtobufSerializerPrivate::deserializeBasic<V>(it, value);
+    return value;
+}
+
+QVariant readScalar(QProtobufSelfcheckIterator &it, FieldKind kind)
+{
+    switch (kind) {
+    case FieldKind::Int32:
+        return static_cast<int>(readBasic<int32>(it)._t);
+    case FieldKind::Int64:
+        return static_cast<qint64>(readBasic<int64>(it)._t);
+    case FieldKind::Enum:
+        return static_cast<int>(readBasic<int64>(it)._t);
+    case FieldKind::UInt32:
+        return readBasic<uint32_t>(it);
+    case FieldKind::UInt64:
+        return static_cast<quint64>(readBasic<uint64_t>(it));
+    case FieldKind::Bool:
+        return readBasic<uint64_t>(it) != 0;
+    case FieldKind::SInt32:
+        return readBasic<int32_t>(it);
+    case FieldKind::SInt64:
+        return static_cast<qint64>(readBasic<int64_t>(it));
+    case FieldKind::Fixed32:
+        return readBasic<fixed32>(it)._t;
+    case FieldKind::SFixed32:
+        return readBasic<sfixed32>(it)._t;
+    case FieldKind::Fixed64:
+        return static_cast<quint64>(readBasic<fixed64>(it)._t);
+    case FieldKind::SFixed64:
+        return static_cast<qint64>(readBasic<sfixed64>(it)._t);
+    case FieldKind::Float:
+        return readBasic<float>(it);
+    case FieldKind::Double:
+        return readBasic<double>(it);
+    case FieldKind::String:
+        return readBasic<QString>(it);
+    case FieldKind::Bytes:
+        return readBasic<QByteArray>(it);
+    default:
+        break;
+    }
+    return QVariant();
+}
+
+bool convertElement(const QProtobufDynamicField &field, QVariant &value)
+{
+    if (field.kind == FieldKind::Message) {
+        return field.messageType != nullptr && value.userType() == qMetaTypeId<QProtobufDynamicMessage>()
+                && value.value<QProtobufDynamicMessage>().descriptor() == field.messageType;
+    }
+    return value.convert(storageTypeOf(field.kind));
+}
+
+bool elementsEqual(const QVariant &a, const QVariant &b, FieldKind kind)
+{
+    if (kind == FieldKind::Message) {
+        return *static_cast<const QProtobufDynamicMessage *>(a.constData())
+                == *static_cast<const QProtobufDynamicMessage *>(b.constData());
+    }
+    return a == b;
+}
+
+QVariant toMapValue(const QVariant &value, const QProtobufDynamicField &field)
+{
+    if (field.kind != FieldKind::Message) {
+        return value;
+    }
+    if (!field.repeated) {
+        return static_cast<const QProtobufDynamicMessage *>(value.constData())->toVariantMap();
+    }
+    QVariantList result;
+    const QVariantList list = value.toList();
+    result.reserve(list.size());
+    for (const QVariant &element : list) {
+        result.append(static_cast<const QProtobufDynamicMessage *>(element.constData())->toVariantMap());
+    }
+    return result;
+}
+
+//Calls callback for each field of serialized descriptor message, fields that callback doesn't read are skipped
+template<typename F>
+bool readDescriptorFields(const QByteArray &data, F callback)
+{
+    for (QProtobufSelfcheckIterator it(data); it != data.end()
+         && QtProtobufPrivate::deserializationError() == NoDeserializationError;) {
+        int fieldNumber = 0;
+        WireTypes wireType = UnknownWireType;
+        QProtobufWireFormat::readFieldHeader(it, fieldNumber, wireType);
+        if (QtProtobufPrivate::deserializationError() != NoDeserializationError) {
+            break;
+        }
+        if (!callback(it, fieldNumber, wireType)) {
+            QProtobufSerializerPrivate::skipSerializedFieldBytes(it, wireType);
+        }
+    }
+    return QtProtobufPrivate::deserializationError() == NoDeserializationError;
+}
+
+QString defaultJsonName(const QString &name)
+{
+    QString result;
+    result.reserve(name.size());
+    bool capitalizeNext = false;
+    for (const QChar c : name) {
+        if (c == QLatin1Char('_')) {
+            capitalizeNext = true;
+        } else {
+            result.append(capitalizeNext ? c.toUpper() : c);
+            capitalizeNext = false;
+        }
+    }
+    return result;
+}
+
+}
+
+int QProtobufMessageDescriptor::indexOf(int fieldNumber) const
+{
+    auto it = std::lower_bound(m_fields.cbegin(), m_fields.cend(), fieldNumber, [](const QProtobufDynamicField &field, int number) {
+        return field.number < number;
+    });
+    return (it != m_fields.cend() && it->number == fieldNumber) ? static_cast<int>(it - m_fields.cbegin()) : -1;
+}
+
+int QProtobufMessageDescriptor::indexOf(const QString &name) const
+{
+    for (int i = 0; i < m_fields.size(); ++i) {
+        if (m_fields[i].name == name || m_fields[i].jsonName == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+QProtobufDescriptorPool::QProtobufDescriptorPool() = default;
+QProtobufDescriptorPool::~QProtobufDescriptorPool() = default;
+
+bool QProtobufDescriptorPool::addFileDescriptorSet(const QByteArray &data)
+{
+    QtProtobufPrivate::DeserializationErrorScope scope;
+    bool valid = true;
+    readDescriptorFields(data, [this, &valid](QProtobufSelfcheckIterator &it, int fieldNumber, WireTypes wireType) {
+        if (fieldNumber != 1 || wireType != LengthDelimited) {
+            return false;
+        }
+        QByteArray file;
+        QProtobufWireFormat::readField(it, file);
+
+        QString package;
+        QString syntax;
+        QList<QByteArray> messages;
+        const bool fileValid = readDescriptorFields(file, [&](QProtobufSelfcheckIterator &fileIt, int fileField, WireTypes fileWireType) {
+            if (fileWireType != LengthDelimited) {
+                return false;
+            }
+            switch (fileField) {
+            case 2:
+                QProtobufWireFormat::readField(fileIt, package);
+                return true;
+            case 4: {
+                QByteArray message;
+                QProtobufWireFormat::readField(fileIt, message);
+                messages.append(message);
+            }
+                return true;
+            case 12:
+                QProtobufWireFormat::readField(fileIt, syntax);
+                return true;
+            default:
+                break;
+            }
+            return false;
+        });
+
+        valid = valid && fileValid;
+        for (const QByteArray &message : qAsConst(messages)) {
+            valid = valid && addMessageProto(message, package, syntax == QLatin1String("proto3"));
+        }
+        return true;
+    });
+    resolveTypes();
+    return valid && scope.error() == NoDeserializationError;
+}
+
+bool QProtobufDescriptorPool::addMessageProto(const QByteArray &data, const QString &scope, bool proto3)
+{
+    QString name;
+    QList<QByteArray> fields;
+    QList<QByteArray> nestedTypes;
+    bool mapEntry = false;
+    if (!readDescriptorFields(data, [&](QProtobufSelfcheckIterator &it, int fieldNumber, WireTypes wireType) {
+        if (wireType != LengthDelimited) {
+            return false;
+        }
+        QByteArray value;
+        switch (fieldNumber) {
+        case 1:
+            QProtobufWireFormat::readField(it, name);
+            return true;
+        case 2:
+            QProtobufWireFormat::readField(it, value);
+            fields.append(value);
+            return true;
+        case 3:
+            QProtobufWireFormat::readField(it, value);
+            nestedTypes.append(value);
+            return true;
+        case 7:
+            //MessageOptions.map_entry
+            QProtobufWireFormat::readField(it, value);
+            readDescriptorFields(value, [&mapEntry](QProtobufSelfcheckIterator &optionIt, int option, WireTypes optionWireType) {
+                if (option != 7 || optionWireType != Varint) {
+                    return false;
+                }
+                QProtobufWireFormat::readField(optionIt, mapEntry);
+                return true;
+            });
+            return true;
+        default:
+            break;
+        }
+        return false;
+    })) {
+        return false;
+    }
+
+    const QString fullName = scope.isEmpty() ? name : scope + QLatin1Char('.') + name;
+    if (find(fullName) != nullptr) {
+        return true;
+    }
+    QProtobufMessageDescriptor *descriptor = insert(fullName);
+    descriptor->m_mapEntry = mapEntry;
+
+    for (const QByteArray &fieldData : qAsConst(fields)) {
+        QProtobufDynamicField field;
+        int32 number = 0;
+        int32 label = 0;
+        int32 type = 0;
+        bool hasPacked = false;
+        bool packed = false;
+        if (!readDescriptorFields(fieldData, [&](QProtobufSelfcheckIterator &it, int fieldNumber, WireTypes wireType) {
+            switch (fieldNumber) {
+            case 1:
+                if (wireType == LengthDelimited) {
+                    QProtobufWireFormat::readField(it, field.name);
+                    return true;
+                }
+                break;
+            case 3:
+            case 4:
+            case 5:
+                if (wireType == Varint) {
+                    QProtobufWireFormat::readField(it, fieldNumber == 3 ? number : (fieldNumber == 4 ? label : type));
+                    return true;
+                }
+                break;
+            case 6:
+                if (wireType == LengthDelimited) {
+                    QProtobufWireFormat::readField(it, field.typeName);
+                    return true;
+                }
+                break;
+            case 8:
+                if (wireType == LengthDelimited) {
+                    //FieldOptions.packed
+                    QByteArray options;
+                    QProtobufWireFormat::readField(it, options);
+                    readDescriptorFields(options, [&](QProtobufSelfcheckIterator &optionIt, int option, WireTypes optionWireType) {
+                        if (option != 2 || optionWireType != Varint) {
+                            return false;
+                        }
+                        QProtobufWireFormat::readField(optionIt, packed);
+                        hasPacked = true;
+                        return true;
+                    });
+                    return true;
+                }
+                break;
+            case 10:
+                if (wireType == LengthDelimited) {
+                    QProtobufWireFormat::readField(it, field.jsonName);
+                    return true;
+                }
+                break;
+            default:
+                break;
+            }
+            return false;
+        })) {
+            return false;
+        }
+
+        //Groups are not supported, they are kept as unknown fields
+        if (!kindFromDescriptorType(type, field.kind)) {
+            continue;
+        }
+        field.number = number;
+        field.repeated = label == LabelRepeated;
+        field.packed = field.repeated && isScalar(field.kind) && (hasPacked ? packed : proto3);
+        if (field.jsonName.isEmpty()) {
+            field.jsonName = defaultJsonName(field.name);
+        }
+        if (field.kind == FieldKind::Message) {
+            //Type names are fully qualified, starting with '.'
+            if (field.typeName.startsWith(QLatin1Char('.'))) {
+                field.typeName.remove(0, 1);
+            }
+        } else {
+            field.typeName.clear();
+        }
+        descriptor->m_fields.append(field);
+    }
+    std::stable_sort(descriptor->m_fields.begin(), descriptor->m_fields.end(), [](const QProtobufDynamicField &a,
+                                                                                  const QProtobufDynamicField &b) {
+        return a.number < b.number;
+    });
+
+    for (const QByteArray &nestedType : qAsConst(nestedTypes)) {
+        if (!addMessageProto(nestedType, fullName, proto3)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const QProtobufMessageDescriptor *QProtobufDescriptorPool::addMessageType(const QProtobufMetaObject &metaObject)
+{
+    const QString fullName = QString::fromLatin1(metaObject.staticMetaObject.className()).replace(QLatin1String("::"),
+                                                                                                   QLatin1String("."));
+    const QProtobufMessageDescriptor *existing = find(fullName);
+    if (existing != nullptr) {
+        return existing;
+    }
+    if (metaObject.fieldDescriptors == nullptr && metaObject.propertyOrdering.size() > 0) {
+        return nullptr;
+    }
+
+    //Descriptor is added before its fields, so recursive message types are resolved to it
+    QProtobufMessageDescriptor *descriptor = insert(fullName);
+    for (size_t i = 0; i < metaObject.propertyOrdering.size(); ++i) {
+        const QProtobufFieldDescriptor &fieldDescriptor = metaObject.fieldDescriptors[i];
+        if (fieldDescriptor.kind == FieldKind::Map) {
+            continue;
+        }
+
+        QProtobufDynamicField field;
+        if (fieldDescriptor.kind == FieldKind::Message) {
+            const QProtobufMessageDescriptor *messageType = fieldDescriptor.nestedType != nullptr
+                    ? addMessageType(*fieldDescriptor.nestedType) : nullptr;
+            if (messageType == nullptr) {
+                continue;
+            }
+            field.typeName = messageType->fullName();
+        }
+        field.number = fieldDescriptor.fieldNumber;
+        field.name = QString::fromLatin1(fieldDescriptor.protoName);
+        field.jsonName = QString::fromLatin1(fieldDescriptor.jsonName);
+        field.kind = fieldDescriptor.kind;
+        field.repeated = fieldDescriptor.repeated;
+        //Generated serializers write repeated scalar fields packed
+        field.packed = field.repeated && isScalar(field.kind);
+        descriptor->m_fields.append(field);
+    }
+    resolveTypes();
+    return descriptor;
+}
+
+const QProtobufMessageDescriptor *QProtobufDescriptorPool::find(const QString &fullName) const
+{
+    return m_index.value(fullName, nullptr);
+}
+
+QStringList QProtobufDescriptorPool::messageTypes() const
+{
+    QStringList result;
+    result.reserve(static_cast<int>(m_descriptors.size()));
+    for (const auto &descriptor : m_descriptors) {
+        result.append(descriptor->m_fullName);
+    }
+    return result;
+}
+
+QProtobufMessageDescriptor *QProtobufDescriptorPool::insert(const QString &fullName)
+{
+    m_descriptors.emplace_back(new QProtobufMessageDescriptor);
+    QProtobufMessageDescriptor *descriptor = m_descriptors.back().get();
+    descriptor->m_fullName = fullName;
+    m_index.insert(fullName, descriptor);
+    return descriptor;
+}
+
+void QProtobufDescriptorPool::resolveTypes()
+{
+    for (const auto &descriptor : m_descriptors) {
+        for (QProtobufDynamicField &field : descriptor->m_fields) {
+            if (field.messageType == nullptr && !field.typeName.isEmpty()) {
+                field.messageType = find(field.typeName);
+            }
+        }
+    }
+}
+
+QProtobufDynamicMessage::QProtobufDynamicMessage(const QProtobufMessageDescriptor *descriptor) : m_descriptor(descriptor)
+{
+}
+
+QVariant QProtobufDynamicMessage::value(int fieldNumber) const
+{
+    const int field = m_descriptor != nullptr ? m_descriptor->indexOf(fieldNumber) : -1;
+    if (field < 0) {
+        return QVariant();
+    }
+    const Value *stored = find(field);
+    return stored != nullptr ? stored->value : defaultValue(m_descriptor->fields()[field]);
+}
+
+QVariant QProtobufDynamicMessage::value(const QString &name) const
+{
+    const int field = m_descriptor != nullptr ? m_descriptor->indexOf(name) : -1;
+    return field >= 0 ? value(m_descriptor->fields()[field].number) : QVariant();
+}
+
+bool QProtobufDynamicMessage::setValue(int fieldNumber, const QVariant &value)
+{
+    const int field = m_descriptor != nullptr ? m_descriptor->indexOf(fieldNumber) : -1;
+    return field >= 0 && setFieldValue(field, value);
+}
+
+bool QProtobufDynamicMessage::setValue(const QString &name, const QVariant &value)
+{
+    const int field = m_descriptor != nullptr ? m_descriptor->indexOf(name) : -1;
+    return field >= 0 && setFieldValue(field, value);
+}
+
+bool QProtobufDynamicMessage::hasValue(int fieldNumber) const
+{
+    const int field = m_descriptor != nullptr ? m_descriptor->indexOf(fieldNumber) : -1;
+    return field >= 0 && find(field) != nullptr;
+}
+
+void QProtobufDynamicMessage::clearValue(int fieldNumber)
+{
+    const int field = m_descriptor != nullptr ? m_descriptor->indexOf(fieldNumber) : -1;
+    const Value *stored = field >= 0 ? find(field) : nullptr;
+    if (stored != nullptr) {
+        m_values.remove(static_cast<int>(stored - m_values.constData()));
+    }
+}
+
+void QProtobufDynamicMessage::clear()
+{
+    m_values.clear();
+    m_unknownFields.clear();
+}
+
+QByteArray QProtobufDynamicMessage::serialize() const
+{
+    QByteArray result;
+    serializeTo(result);
+    return result;
+}
+
+DeserializationError QProtobufDynamicMessage::deserialize(const QByteArray &data)
+{
+    QtProtobufPrivate::DeserializationErrorScope scope;
+    clear();
+    parse(data, 0);
+    return scope.error();
+}
+
+QVariantMap QProtobufDynamicMessage::toVariantMap() const
+{
+    QVariantMap result;
+    for (const Value &stored : m_values) {
+        const QProtobufDynamicField &field = m_descriptor->fields()[stored.field];
+        result.insert(field.name, toMapValue(stored.value, field));
+    }
+    return result;
+}
+
+bool QProtobufDynamicMessage::operator ==(const QProtobufDynamicMessage &other) const
+{
+    if (m_descriptor != other.m_descriptor || m_unknownFields != other.m_unknownFields
+            || m_values.size() != other.m_values.size()) {
+        return false;
+    }
+    for (int i = 0; i < m_values.size(); ++i) {
+        if (m_values[i].field != other.m_values[i].field) {
+            return false;
+        }
+        const QProtobufDynamicField &field = m_descriptor->fields()[m_values[i].field];
+        if (!field.repeated) {
+            if (!elementsEqual(m_values[i].value, other.m_values[i].value, field.kind)) {
+                return false;
+            }
+            continue;
+        }
+        const QVariantList list = m_values[i].value.toList();
+        const QVariantList otherList = other.m_values[i].value.toList();
+        if (list.size() != otherList.size()) {
+            return false;
+        }
+        for (int j = 0; j < list.size(); ++j) {
+            if (!elementsEqual(list[j], otherList[j], field.kind)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+const QProtobufDynamicMessage::Value *QProtobufDynamicMessage::find(int field) const
+{
+    auto it = std::lower_bound(m_values.cbegin(), m_values.cend(), field, [](const Value &value, int position) {
+        return value.field < position;
+    });
+    return (it != m_values.cend() && it->field == field) ? &(*it) : nullptr;
+}
+
+QVariant &QProtobufDynamicMessage::slot(int field)
+{
+    auto it = std::lower_bound(m_values.begin(), m_values.end(), field, [](const Value &value, int position) {
+        return value.field < position;
+    });
+    if (it == m_values.end() || it->field != field) {
+        it = m_values.insert(it, Value{field, defaultValue(m_descriptor->fields()[field])});
+    }
+    return it->value;
+}
+
+bool QProtobufDynamicMessage::setFieldValue(int field, const QVariant &value)
+{
+    const QProtobufDynamicField &fieldInfo = m_descriptor->fields()[field];
+    QVariant converted = value;
+    if (fieldInfo.repeated) {
+        if (!value.canConvert<QVariantList>()) {
+            return false;
+        }
+        QVariantList list = value.toList();
+        for (QVariant &element : list) {
+            if (!convertElement(fieldInfo, element)) {
+                return false;
+            }
+        }
+        converted = list;
+    } else if (!convertElement(fieldInfo, converted)) {
+        return false;
+    }
+    slot(field) = converted;
+    return true;
+}
+
+void QProtobufDynamicMessage::serializeTo(QByteArray &buffer) const
+{
+    auto writeElement = [&buffer](const QProtobufDynamicField &field, const QVariant &element) {
+        const WireTypes wireType = wireTypeOf(field.kind);
+        QProtobufSerializerPrivate::encodeHeader(field.number, wireType, buffer);
+        if (field.kind == FieldKind::Message) {
+            const int sizePosition = QProtobufSerializerPrivate::beginLengthDelimited(buffer);
+            static_cast<const QProtobufDynamicMessage *>(element.constData())->serializeTo(buffer);
+            QProtobufSerializerPrivate::endLengthDelimited(buffer, sizePosition);
+            return;
+        }
+        writeScalar(element, field.kind, buffer);
+    };
+
+    //Values are sorted by field position, so fields are written in field number order
+    for (const Value &stored : m_values) {
+        const QProtobufDynamicField &field = m_descriptor->fields()[stored.field];
+        if (!field.repeated) {
+            if (!isDefault(stored.value, field.kind)) {
+                writeElement(field, stored.value);
+            }
+            continue;
+        }
+
+        const QVariantList list = stored.value.toList();
+        if (list.isEmpty()) {
+            continue;
+        }
+        if (field.packed) {
+            QProtobufSerializerPrivate::encodeHeader(field.number, LengthDelimited, buffer);
+            const int sizePosition = QProtobufSerializerPrivate::beginLengthDelimited(buffer);
+            for (const QVariant &element : list) {
+                writeScalar(element, field.kind, buffer);
+            }
+            QProtobufSerializerPrivate::endLengthDelimited(buffer, sizePosition);
+            continue;
+        }
+        for (const QVariant &element : list) {
+            writeElement(field, element);
+        }
+    }
+    buffer.append(m_unknownFields);
+}
+
+void QProtobufDynamicMessage::parse(const QByteArray &data, int depth)
+{
+    if (depth > MaxNestingDepth) {
+        QtProtobufPrivate::reportDeserializationError(LimitExceededError, "Nesting depth of dynamic message exceeds limit");
+        return;
+    }
+
+    for (QProtobufSelfcheckIterator it(data); it != data.end()
+         && QtProtobufPrivate::deserializationError() == NoDeserializationError;) {
+        const char *fieldBegin = it.data();
+        int fieldNumber = QtProtobufPrivate::NotUsedFieldIndex;
+        WireTypes wireType = UnknownWireType;
+        if (!QProtobufSerializerPrivate::decodeHeader(it, fieldNumber, wireType)) {
+            QtProtobufPrivate::reportDeserializationError(InvalidHeaderError, "Message received doesn't contains valid header byte. "
+                                                                              "Seems stream is broken");
+            return;
+        }
+
+        const int position = m_descriptor != nullptr ? m_descriptor->indexOf(fieldNumber) : -1;
+        const QProtobufDynamicField *field = position >= 0 ? &m_descriptor->fields()[position] : nullptr;
+        const bool known = field != nullptr && (field->kind != FieldKind::Message || field->messageType != nullptr);
+        const bool isPackedList = known && field->repeated && isScalar(field->kind) && wireType == LengthDelimited;
+        if (!known || (!isPackedList && wireType != wireTypeOf(field->kind))) {
+            QProtobufSerializerPrivate::skipSerializedFieldBytes(it, wireType);
+            if (QtProtobufPrivate::deserializationError() == NoDeserializationError) {
+                m_unknownFields.append(fieldBegin, static_cast<int>(it.data() - fieldBegin));
+            }
+            continue;
+        }
+
+        QVariant &value = slot(position);
+        if (field->kind == FieldKind::Message) {
+            const QByteArray payload = QProtobufSerializerPrivate::deserializeLengthDelimitedView(it);
+            if (QtProtobufPrivate::deserializationError() != NoDeserializationError) {
+                return;
+            }
+            if (field->repeated) {
+                QProtobufDynamicMessage element(field->messageType);
+                element.parse(payload, depth + 1);
+                static_cast<QVariantList *>(value.data())->append(QVariant::fromValue(element));
+            } else {
+                //Message received more than once is merged
+                static_cast<QProtobufDynamicMessage *>(value.data())->parse(payload, depth + 1);
+            }
+            continue;
+        }
+
+        if (!field->repeated) {
+            value = readScalar(it, field->kind);
+            continue;
+        }
+
+        QVariantList *list = static_cast<QVariantList *>(value.data());
+        if (!isPackedList) {
+            list->append(readScalar(it, field->kind));
+            continue;
+        }
+        const int size = QProtobufWireFormat::readLength(it);
+        const QProtobufSelfcheckIterator last = it + size;
+        while (it != last && QtProtobufPrivate::deserializationError() == NoDeserializationError) {
+            list->append(readScalar(it, field->kind));
+        }
+    }
+}
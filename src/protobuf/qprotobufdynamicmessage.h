@@ -0,0 +1,273 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufDynamicMessage
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+#include <memory>
+#include <vector>
+
+#include "qtprotobufglobal.h"
+#include "qtprotobuftypes.h"
+
+namespace QtProtobuf {
+
+class QProtobufMetaObject;
+class QProtobufMessageDescriptor;
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufDynamicField struct describes field of message type loaded at runtime
+ *
+ * \details Map fields are described as repeated fields of message type, that has isMapEntry() set.
+ */
+struct QProtobufDynamicField {
+    int number = 0;
+    QString name;
+    QString jsonName;
+    FieldKind kind = FieldKind::Int32;
+    bool repeated = false;
+    bool packed = false;                                     //!< Repeated scalar field is written packed
+    QString typeName;                                        //!< Full name of message type of field, empty for other fields
+    const QProtobufMessageDescriptor *messageType = nullptr; //!< Resolved message type, nullptr until the type is loaded
+};
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufMessageDescriptor class describes message type loaded to QProtobufDescriptorPool
+ */
+class Q_PROTOBUF_EXPORT QProtobufMessageDescriptor
+{
+public:
+    /*!
+     * \brief Returns full name of message type including package, e.g. "qtprotobuf.tests.SimpleIntMessage"
+     */
+    QString fullName() const {
+        return m_fullName;
+    }
+
+    /*!
+     * \brief Returns fields of message type in field number order
+     */
+    const QVector<QProtobufDynamicField> &fields() const {
+        return m_fields;
+    }
+
+    /*!
+     * \brief Returns true if message type is entry of map field, that has key field 1 and value field 2
+     */
+    bool isMapEntry() const {
+        return m_mapEntry;
+    }
+
+    /*!
+     * \brief Returns position of field with \a fieldNumber in fields(), or -1 if there is no such field
+     */
+    int indexOf(int fieldNumber) const;
+
+    /*!
+     * \brief Returns position of field with proto or json \a name in fields(), or -1 if there is no such field
+     */
+    int indexOf(const QString &name) const;
+
+private:
+    friend class QProtobufDescriptorPool;
+    QProtobufMessageDescriptor() = default;
+
+    QString m_fullName;
+    QVector<QProtobufDynamicField> m_fields;
+    bool m_mapEntry = false;
+};
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufDescriptorPool class holds message types loaded at runtime
+ *
+ * \details Message types are loaded from serialized google.protobuf.FileDescriptorSet, e.g. produced by
+ *          `protoc --descriptor_set_out`, or from tables of messages generated by qtprotobufgen. Loaded
+ *          types are used by QProtobufDynamicMessage, so tools may process messages of any schema without
+ *          generated code compiled in.
+ *          \code
+ *          QProtobufDescriptorPool pool;
+ *          pool.addFileDescriptorSet(descriptorSetData);
+ *          QProtobufDynamicMessage message(pool.find("example.Event"));
+ *          message.deserialize(data);
+ *          qDebug() << message.toVariantMap();
+ *          \endcode
+ *
+ *          Fields of types that are loaded later are resolved when the types are added. Pool must outlive
+ *          all messages that use its descriptors.
+ */
+class Q_PROTOBUF_EXPORT QProtobufDescriptorPool
+{
+public:
+    QProtobufDescriptorPool();
+    ~QProtobufDescriptorPool();
+
+    /*!
+     * \brief Loads message types of all files of serialized FileDescriptorSet \a data
+     *
+     * \details Groups are not supported, group fields are kept as unknown fields of dynamic messages.
+     * \return false if \a data is not valid FileDescriptorSet, types loaded before error are kept
+     */
+    bool addFileDescriptorSet(const QByteArray &data);
+
+    /*!
+     * \brief Loads message type of generated \a metaObject and types of its message fields
+     *
+     * \details Message types generated without field descriptor tables can't be loaded. Map fields and message
+     *          fields of types without descriptor tables are not loaded, they are kept as unknown fields of
+     *          dynamic messages.
+     * \return loaded descriptor, or nullptr if message type has no field descriptor table
+     */
+    const QProtobufMessageDescriptor *addMessageType(const QProtobufMetaObject &metaObject);
+
+    /*!
+     * \brief Returns message type with \a fullName, or nullptr if it's not loaded
+     */
+    const QProtobufMessageDescriptor *find(const QString &fullName) const;
+
+    /*!
+     * \brief Returns full names of all loaded message types
+     */
+    QStringList messageTypes() const;
+
+private:
+    Q_DISABLE_COPY_MOVE(QProtobufDescriptorPool)
+
+    QProtobufMessageDescriptor *insert(const QString &fullName);
+    bool addMessageProto(const QByteArray &data, const QString &scope, bool proto3);
+    void resolveTypes();
+
+    std::vector<std::unique_ptr<QProtobufMessageDescriptor>> m_descriptors;
+    QHash<QString, QProtobufMessageDescriptor *> m_index;
+};
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufDynamicMessage class is message of type described by QProtobufMessageDescriptor
+ *
+ * \details Only fields that are set are stored. Field values are stored as QVariant:
+ *          - int, qint64, uint and quint64 for 32 and 64 bit integral fields of signed and unsigned types
+ *          - int for enumerations, float, double and bool for other scalar fields
+ *          - QString and QByteArray for string and bytes fields
+ *          - QProtobufDynamicMessage for message fields
+ *          - QVariantList of element values for repeated fields
+ *
+ *          Values that equal to default are not serialized, same as QProtobufSerializer does. Unknown fields are
+ *          kept and serialized as is, so received messages are forwarded without loss.
+ */
+class Q_PROTOBUF_EXPORT QProtobufDynamicMessage
+{
+public:
+    QProtobufDynamicMessage() = default;
+    explicit QProtobufDynamicMessage(const QProtobufMessageDescriptor *descriptor);
+
+    /*!
+     * \brief Returns message type, or nullptr for default-constructed message
+     */
+    const QProtobufMessageDescriptor *descriptor() const {
+        return m_descriptor;
+    }
+
+    bool isValid() const {
+        return m_descriptor != nullptr;
+    }
+
+    /*!
+     * \brief Returns value of field with \a fieldNumber, or default value if field is not set
+     *
+     * \details Invalid QVariant is returned if there is no such field.
+     */
+    QVariant value(int fieldNumber) const;
+    QVariant value(const QString &name) const;
+
+    /*!
+     * \brief Sets \a value of field with \a fieldNumber
+     *
+     * \details \a value is converted to type of field, message values must have type of field.
+     * \return false if there is no such field or value can't be converted
+     */
+    bool setValue(int fieldNumber, const QVariant &value);
+    bool setValue(const QString &name, const QVariant &value);
+
+    /*!
+     * \brief Returns true if field with \a fieldNumber was set or received
+     */
+    bool hasValue(int fieldNumber) const;
+    void clearValue(int fieldNumber);
+    void clear();
+
+    /*!
+     * \brief Returns received fields that are not described by message type, with their headers
+     */
+    QByteArray unknownFields() const {
+        return m_unknownFields;
+    }
+
+    QByteArray serialize() const;
+
+    /*!
+     * \brief Replaces content of message with fields decoded from \a data
+     * \return error that occurred, message content is undefined if error is returned
+     */
+    DeserializationError deserialize(const QByteArray &data);
+
+    /*!
+     * \brief Returns values of set fields by proto field names, nested messages are converted to QVariantMap
+     */
+    QVariantMap toVariantMap() const;
+
+    bool operator ==(const QProtobufDynamicMessage &other) const;
+    bool operator !=(const QProtobufDynamicMessage &other) const {
+        return !(*this == other);
+    }
+
+private:
+    struct Value {
+        int field;//!< Position of field in descriptor fields
+        QVariant value;
+    };
+
+    const Value *find(int field) const;
+    QVariant &slot(int field);
+    bool setFieldValue(int field, const QVariant &value);
+    void serializeTo(QByteArray &buffer) const;
+    void parse(const QByteArray &data, int depth);
+
+    const QProtobufMessageDescriptor *m_descriptor = nullptr;
+    QVector<Value> m_values;//!< Set fields, sorted by position of field
+    QByteArray m_unknownFields;
+};
+
+}
+
+Q_DECLARE_METATYPE(QtProtobuf::QProtobufDynamicMessage)
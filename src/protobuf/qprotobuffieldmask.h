@@ -0,0 +1,99 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufFieldMask
+
+#include "qtprotobufglobal.h"
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <initializer_list>
+#include <vector>
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufFieldMask class is set of field numbers that should be deserialized
+ *
+ * \details Fields of message that are not in mask are skipped without being decoded. Mask is applied to top-level
+ *          message only, nested messages of fields in mask are deserialized completely. Field numbers could be
+ *          taken from QtProtobufFieldEnum generated with FIELDENUM option.
+ *          \code
+ *          serializer->deserialize(&event, data, {Event::IdProtoFieldNumber, Event::TimestampProtoFieldNumber});
+ *          \endcode
+ *
+ * \see QAbstractProtobufSerializer::deserialize
+ */
+class QProtobufFieldMask
+{
+public:
+    QProtobufFieldMask() : m_lowFields{0, 0} {}
+    QProtobufFieldMask(std::initializer_list<int> fieldNumbers) : m_lowFields{0, 0} {
+        for (int fieldNumber : fieldNumbers) {
+            add(fieldNumber);
+        }
+    }
+
+    /*!
+     * \brief Adds \a fieldNumber to mask
+     */
+    void add(int fieldNumber) {
+        Q_ASSERT_X(fieldNumber > 0, "QProtobufFieldMask", "Field number is out of range");
+        if (fieldNumber < LowFieldsLimit) {
+            m_lowFields[fieldNumber / 64] |= quint64(1) << (fieldNumber % 64);
+            return;
+        }
+        auto it = std::lower_bound(m_highFields.begin(), m_highFields.end(), fieldNumber);
+        if (it == m_highFields.end() || *it != fieldNumber) {
+            m_highFields.insert(it, fieldNumber);
+        }
+    }
+
+    /*!
+     * \brief Returns true if \a fieldNumber is in mask
+     */
+    bool contains(int fieldNumber) const {
+        if (fieldNumber < LowFieldsLimit) {
+            return fieldNumber > 0 && (m_lowFields[fieldNumber / 64] & (quint64(1) << (fieldNumber % 64))) != 0;
+        }
+        return std::binary_search(m_highFields.begin(), m_highFields.end(), fieldNumber);
+    }
+
+    bool isEmpty() const {
+        return m_lowFields[0] == 0 && m_lowFields[1] == 0 && m_highFields.empty();
+    }
+
+private:
+    //Field numbers below limit are stored in bit set, it covers fields of most messages
+    enum {
+        LowFieldsLimit = 128
+    };
+    quint64 m_lowFields[2];
+    std::vector<int> m_highFields;
+};
+
+}
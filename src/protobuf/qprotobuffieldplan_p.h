@@ -0,0 +1,128 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufFieldPlan
+
+#include <vector>
+
+#include <QHash>
+#include <QtAlgorithms>
+
+#include "qtprotobuftypes.h"
+#include "qprotobufmetaproperty.h"
+#include "qprotobufserializer_p.h"
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobuf
+ * \private
+ * \brief The QProtobufFieldPlanEntry struct contains data of message field resolved once per message type
+ */
+struct QProtobufFieldPlanEntry {
+    QProtobufFieldPlanEntry(int _fieldNumber, int _userType, const QProtobufMetaProperty &_metaProperty,
+                            const PropertyOrderingInfo &_orderingInfo,
+                            const QProtobufSerializerPrivate::SerializationHandlers *_handlers,
+                            const QProtobufFieldDescriptor *_descriptor = nullptr) : fieldNumber(_fieldNumber)
+      , userType(_userType)
+      , metaProperty(_metaProperty)
+      , orderingInfo(_orderingInfo)
+      , handlers(_handlers)
+      , descriptor(_descriptor)
+      , jsonKey(QByteArray("\"") + _orderingInfo.jsonName.toUtf8() + "\":")
+      , protoJsonKey(_orderingInfo.protoName != nullptr ? QByteArray("\"") + _orderingInfo.protoName + "\":" : jsonKey) {}
+
+    int fieldNumber;
+    int userType; //!< Metatype identifier of property at the moment when plan was built
+    QProtobufMetaProperty metaProperty;
+    const PropertyOrderingInfo &orderingInfo; //!< Property index, json name and precomputed field header
+    const QProtobufSerializerPrivate::SerializationHandlers *handlers; //!< nullptr if type was not registered when plan was built
+    const QProtobufFieldDescriptor *descriptor; //!< Generated descriptor of field, nullptr if message type has no descriptors
+    QByteArray jsonKey; //!< Quoted UTF-8 json name followed by colon, ready to be copied to json output
+    QByteArray protoJsonKey; //!< Same as jsonKey, but with original proto name if it's known
+};
+
+/*!
+ * \ingroup QtProtobuf
+ * \private
+ * \brief The QProtobufFieldPlan struct is immutable set of resolved fields of message type
+ *
+ * \details Fields are stored in the same order as in QProtobufPropertyOrdering, so position of field
+ *          in plan matches position of field in property ordering.
+ */
+struct QProtobufFieldPlan {
+    std::vector<QProtobufFieldPlanEntry> fields;
+    QHash<QByteArray, int> jsonIndex; //!< Position of field in plan by UTF-8 json name and by original proto name
+    bool internsStrings = false; //!< Message has fields, that are marked for string interning
+
+    /*!
+     * \brief Looks up field by json property \a name of \a size bytes
+     * \return nullptr if message type has no field with such name
+     */
+    const QProtobufFieldPlanEntry *findJsonField(const char *name, int size) const {
+        auto it = jsonIndex.constFind(QByteArray::fromRawData(name, size));
+        return it != jsonIndex.constEnd() ? &fields[static_cast<size_t>(it.value())] : nullptr;
+    }
+
+    /*!
+     * \brief Returns true if \a field has explicit presence and is marked in \a presence words
+     * \details Such fields are serialized even if they hold default value
+     */
+    bool isExplicitlySet(const QProtobufFieldPlanEntry &field, const quint32 *presence) const {
+        if (presence == nullptr || field.descriptor == nullptr || !field.descriptor->explicitPresence) {
+            return false;
+        }
+        const size_t index = static_cast<size_t>(&field - fields.data());
+        return (presence[index / 32] & (quint32(1) << (index % 32))) != 0;
+    }
+
+    /*!
+     * \brief Calls \a visitor for fields marked in \a presence words, in field number order
+     * \details All fields are visited if \a presence is nullptr
+     * \see QProtobufFieldPresence
+     */
+    template<typename Visitor>
+    void forEachPresentField(const quint32 *presence, Visitor visitor) const {
+        if (presence == nullptr) {
+            for (const auto &field : fields) {
+                visitor(field);
+            }
+            return;
+        }
+
+        const size_t count = fields.size();
+        for (size_t word = 0; word * 32 < count; ++word) {
+            for (quint32 bits = presence[word]; bits != 0; bits &= bits - 1) {
+                const size_t index = word * 32 + qCountTrailingZeroBits(bits);
+                if (index >= count) {
+                    break;
+                }
+                visitor(fields[index]);
+            }
+        }
+    }
+};
+
+}
@@ -0,0 +1,136 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufFieldPresence
+
+#include "qtprotobufglobal.h"
+
+#include <QtGlobal>
+
+#include <initializer_list>
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufFieldPresence class is bit set of message fields that could hold non-default values
+ *
+ * \details Generated messages keep one bit per field, indexed by position of field in field number order.
+ *          Bit is set by field setter and is cleared by message clear(), or when other member of the same
+ *          oneof becomes active, so set bits are superset of fields that hold non-default values. Repeated,
+ *          map and message fields could be modified by reference, their bits are always set, except message
+ *          members of oneof. Serializers visit fields with set bits only.
+ *          Same bit set marks fields changed since last markClean() call, see QAbstractProtobufSerializer::serializeDelta.
+ *          \a WordCount is number of 32-bit words required to store bits of all message fields.
+ */
+template<int WordCount>
+class QProtobufFieldPresence
+{
+public:
+    QProtobufFieldPresence() : m_words{} {}
+    QProtobufFieldPresence(std::initializer_list<quint32> words) : m_words{} {
+        Q_ASSERT_X(static_cast<int>(words.size()) <= WordCount, "QProtobufFieldPresence", "Too many presence words");
+        int i = 0;
+        for (quint32 word : words) {
+            m_words[i++] = word;
+        }
+    }
+
+    /*!
+     * \brief Marks field at \a index as possibly set
+     */
+    void set(int index) {
+        m_words[index / 32] |= quint32(1) << (index % 32);
+    }
+
+    /*!
+     * \brief Marks field at \a index as holding default value
+     */
+    void reset(int index) {
+        m_words[index / 32] &= ~(quint32(1) << (index % 32));
+    }
+
+    /*!
+     * \brief Returns true if field at \a index is possibly set
+     */
+    bool test(int index) const {
+        return (m_words[index / 32] & (quint32(1) << (index % 32))) != 0;
+    }
+
+    /*!
+     * \brief Returns raw presence words, field with index N is stored in bit N % 32 of word N / 32
+     */
+    const quint32 *words() const {
+        return m_words;
+    }
+
+private:
+    quint32 m_words[WordCount];
+};
+
+/*!
+ * \private
+ * \brief Returns revision that was never returned before in this process
+ */
+extern Q_PROTOBUF_EXPORT quint64 nextMessageRevision();
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufDirtyFields class is bit set of message fields changed since last markClean() call
+ *
+ * \details Besides the bits, keeps revision of message that is changed every time a bit is set, so message
+ *          content may be compared with content it had earlier without comparing the fields. Revisions are unique
+ *          within the process, so new message never gets revision of other message.
+ */
+template<int WordCount>
+class QProtobufDirtyFields : public QProtobufFieldPresence<WordCount>
+{
+public:
+    QProtobufDirtyFields() : m_revision(nextMessageRevision()) {}
+
+    /*!
+     * \brief Marks field at \a index as changed
+     */
+    void set(int index) {
+        QProtobufFieldPresence<WordCount>::set(index);
+        m_revision = nextMessageRevision();
+    }
+
+    /*!
+     * \brief Changes revision without marking any field, e.g. when unknown fields of message are changed
+     */
+    void touch() {
+        m_revision = nextMessageRevision();
+    }
+
+    quint64 revision() const {
+        return m_revision;
+    }
+
+private:
+    quint64 m_revision;
+};
+
+}
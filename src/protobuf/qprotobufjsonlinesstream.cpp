@@ -0,0 +1,133 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qprotobufjsonlinesstream.h"
+#include "qtprotobuflogging.h"
+
+#include <QIODevice>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace QtProtobuf;
+
+QProtobufJsonLinesStream::QProtobufJsonLinesStream(QIODevice *device, QProtobufJsonSerializer *serializer) : m_device(device)
+  , m_serializer(serializer)
+  , m_readPosition(0)
+  , m_error(false)
+{
+    Q_ASSERT(m_device != nullptr);
+    Q_ASSERT(m_serializer != nullptr);
+    m_writeBuffer.reserve(BufferSize);
+}
+
+QProtobufJsonLinesStream::QProtobufJsonLinesStream(const QByteArray &data, QProtobufJsonSerializer *serializer) : m_device(nullptr)
+  , m_serializer(serializer)
+  , m_readBuffer(data)
+  , m_readPosition(0)
+  , m_error(false)
+{
+    Q_ASSERT(m_serializer != nullptr);
+}
+
+QProtobufJsonLinesStream::~QProtobufJsonLinesStream()
+{
+    flush();
+}
+
+bool QProtobufJsonLinesStream::flush()
+{
+    if (m_writeBuffer.isEmpty()) {
+        return !m_error;
+    }
+
+    const qint64 written = m_device->write(m_writeBuffer);
+    const bool result = written == m_writeBuffer.size();
+    if (!result) {
+        qProtoWarning() << "Unable to write messages to device:" << m_device->errorString();
+        m_error = true;
+    }
+    //Reserved capacity is kept, so buffer is reused for the next messages
+    m_writeBuffer.resize(0);
+    return result;
+}
+
+bool QProtobufJsonLinesStream::nextLine(const char *&line, int &size)
+{
+    //Number of bytes after read position that are known not to contain new line
+    int searched = 0;
+    while (true) {
+        const char *begin = m_readBuffer.constData() + m_readPosition;
+        const int available = m_readBuffer.size() - m_readPosition;
+
+        const char *end = static_cast<const char *>(memchr(begin + searched, '\n', available - searched));
+        if (end == nullptr) {
+            searched = available;
+            if (!m_error && fillReadBuffer()) {
+                continue;
+            }
+            if (available == 0) {
+                return false;
+            }
+            //Last line is not terminated
+            end = begin + available;
+        }
+
+        m_readPosition += static_cast<int>(end - begin) + (end < begin + available ? 1 : 0);
+        searched = 0;
+        size = static_cast<int>(end - begin);
+        if (size > 0 && begin[size - 1] == '\r') {
+            --size;
+        }
+        if (size > 0) {
+            line = begin;
+            return true;
+        }
+    }
+}
+
+bool QProtobufJsonLinesStream::fillReadBuffer()
+{
+    if (m_device == nullptr) {
+        return false;
+    }
+
+    //Consumed lines are dropped once per read, instead of once per line
+    if (m_readPosition > 0) {
+        m_readBuffer.remove(0, m_readPosition);
+        m_readPosition = 0;
+    }
+
+    const int size = m_readBuffer.size();
+    m_readBuffer.resize(size + BufferSize);
+    const qint64 received = m_device->read(m_readBuffer.data() + size, BufferSize);
+    m_readBuffer.resize(size + static_cast<int>(std::max<qint64>(received, 0)));
+    if (received < 0) {
+        qProtoWarning() << "Unable to read messages from device:" << m_device->errorString();
+        m_error = true;
+        return false;
+    }
+    return received > 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufJsonLinesStream
+
+#include <QByteArray>
+
+#include "qtprotobufglobal.h"
+#include "qprotobufjsonserializer.h"
+
+QT_FORWARD_DECLARE_CLASS(QIODevice)
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufJsonLinesStream class reads and writes sequence of JSON messages separated by new lines
+ *
+ * \details Every message is written as single line of JSON, that is known as JSON lines or NDJSON. Messages
+ *          are serialized directly to internal buffer, that is written to device by chunks of BufferSize
+ *          bytes, call flush() to write collected messages immediately. Lines are read from device by chunks
+ *          of the same size into reusable buffer and deserialized without intermediate copies. Empty lines
+ *          are skipped, "\r\n" line endings are accepted.
+ *          \code
+ *          QProtobufJsonLinesStream stream(&file, &serializer);
+ *          for (const auto &event : events) {
+ *              stream.write(event);
+ *          }
+ *          stream.flush();
+ *          ...
+ *          Event event;
+ *          while (stream.read(&event)) {
+ *              ...
+ *          }
+ *          \endcode
+ *
+ *          Stream may also read messages from byte-array, e.g. from data of QProtobufMappedFile. In this case
+ *          lines are deserialized in place and stream is read-only.
+ *
+ *          Device, data and serializer must outlive the stream. Stream doesn't take ownership of them.
+ */
+class Q_PROTOBUF_EXPORT QProtobufJsonLinesStream
+{
+public:
+    enum {
+        BufferSize = 64 * 1024 //!< Size of chunks that are written or read from device
+    };
+
+    QProtobufJsonLinesStream(QIODevice *device, QProtobufJsonSerializer *serializer);
+    /*!
+     * \brief Constructs read-only stream of messages stored in \a data
+     */
+    QProtobufJsonLinesStream(const QByteArray &data, QProtobufJsonSerializer *serializer);
+    /*!
+     * \brief Flushes messages that are not written to device yet
+     */
+    ~QProtobufJsonLinesStream();
+
+    /*!
+     * \brief Appends \a message to the stream
+     * \return false if writing to device failed
+     */
+    template<typename T>
+    bool write(const T &message) {
+        if (m_device == nullptr) {
+            qProtoWarning() << "Unable to write messages to read-only stream";
+            return false;
+        }
+        m_serializer->serializeMessageAppend(&message, T::protobufMetaObject, m_writeBuffer);
+        m_writeBuffer.append('\n');
+
+        //Small messages are collected and written to device by single call
+        if (m_writeBuffer.size() >= BufferSize) {
+            return flush();
+        }
+        return !m_error;
+    }
+
+    /*!
+     * \brief Reads next message from the stream to \a message
+     *
+     * \details \a message is cleared and reused, so its nested messages and containers aren't reallocated
+     *          for each line.
+     * \return false if there is no more messages in the stream
+     */
+    template<typename T>
+    bool read(T *message) {
+        Q_ASSERT(message != nullptr);
+        const char *line = nullptr;
+        int size = 0;
+        if (!nextLine(line, size)) {
+            return false;
+        }
+        message->clear();
+        m_serializer->deserializeMessageData(message, T::protobufMetaObject, line, size);
+        return true;
+    }
+
+    /*!
+     * \brief Writes collected messages to device
+     * \return false if writing to device failed
+     */
+    bool flush();
+
+    /*!
+     * \brief Returns true if reading or writing to device failed
+     */
+    bool hasError() const {
+        return m_error;
+    }
+
+private:
+    Q_DISABLE_COPY_MOVE(QProtobufJsonLinesStream)
+
+    bool nextLine(const char *&line, int &size);
+    bool fillReadBuffer();
+
+    QIODevice *m_device;
+    QProtobufJsonSerializer *m_serializer;
+    QByteArray m_writeBuffer;
+    QByteArray m_readBuffer;
+    int m_readPosition;
+    bool m_error;
+};
+
+}
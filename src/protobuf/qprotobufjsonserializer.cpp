@@ -24,15 +24,596 @@
  */
 
 #include "qprotobufjsonserializer.h"
+#include "qprotobufserializer.h"
 #include "qprotobufmetaobject.h"
 #include "qprotobufmetaproperty.h"
+#include "qprotobufbufferallocator.h"
 #include "qtprotobuflogging.h"
+#include "qprotobufdispatchtable_p.h"
+#include "qprotobuffieldplan_p.h"
+#include "qprotobufjsontokenizer_p.h"
+#include "qprotobufnumberformat_p.h"
+#include "qprotobufutf8_p.h"
 
-#include <microjson.h>
-
+#include <QHash>
+#include <QIODevice>
 #include <QMetaProperty>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 using namespace QtProtobuf;
+using QtProtobufPrivate::QProtobufJsonTokenizer;
+
+namespace {
+
+/*!
+ * \private
+ * \brief Appends decimal representation of \a value to \a buffer without intermediate QString
+ */
+void appendDecimal(QByteArray &buffer, quint64 value)
+{
+    char digits[20];
+    int position = sizeof(digits);
+    do {
+        digits[--position] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    buffer.append(digits + position, static_cast<int>(sizeof(digits)) - position);
+}
+
+void appendDecimal(QByteArray &buffer, qint64 value)
+{
+    if (value < 0) {
+        buffer.append('-');
+        //Negation in unsigned arithmetic keeps minimal int64 value representable
+        appendDecimal(buffer, ~static_cast<quint64>(value) + 1);
+        return;
+    }
+    appendDecimal(buffer, static_cast<quint64>(value));
+}
+
+template<typename V>
+void appendInteger(QByteArray &buffer, V value)
+{
+    using Wide = typename std::conditional<std::is_signed<V>::value, qint64, quint64>::type;
+    appendDecimal(buffer, static_cast<Wide>(value));
+}
+
+/*!
+ * \private
+ * \brief Returns position of first character of \a data at or after \a position that must be escaped in json
+ *        string, or \a size if there is no such character
+ * \details Characters are checked 16 at a time when SSE2 or AArch64 NEON instructions are available
+ */
+int findEscapedCharacter(const char *data, int size, int position)
+{
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i lastControl = _mm_set1_epi8(0x1F);
+    for (; position + 16 <= size; position += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + position));
+        const __m128i matches = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                                             _mm_cmpeq_epi8(_mm_max_epu8(chunk, lastControl), lastControl));
+        const int mask = _mm_movemask_epi8(matches);
+        if (mask != 0) {
+            return position + static_cast<int>(qCountTrailingZeroBits(static_cast<quint32>(mask)));
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t firstPrintable = vdupq_n_u8(0x20);
+    for (; position + 16 <= size; position += 16) {
+        const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t *>(data + position));
+        const uint8x16_t matches = vorrq_u8(vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, backslash)),
+                                            vcltq_u8(chunk, firstPrintable));
+        if (vmaxvq_u8(matches) != 0) {
+            break;//Exact position is found by loop below
+        }
+    }
+#endif
+    for (; position < size; ++position) {
+        const auto character = static_cast<unsigned char>(data[position]);
+        if (character == '"' || character == '\\' || character < 0x20) {
+            return position;
+        }
+    }
+    return size;
+}
+
+/*!
+ * \private
+ * \brief Appends shortest representation of \a value that is parsed back exactly to \a buffer
+ * \details NaN and infinite values are written as quoted strings, as specified by protobuf json mapping
+ */
+template<typename T>
+void appendFloatingPoint(QByteArray &buffer, T value)
+{
+    if (std::isnan(value)) {
+        buffer.append("\"NaN\"");
+    } else if (std::isinf(value)) {
+        buffer.append(value > 0 ? "\"Infinity\"" : "\"-Infinity\"");
+    } else {
+        char digits[QtProtobufPrivate::ShortestFormatBufferSize];
+        buffer.append(digits, QtProtobufPrivate::formatShortest(value, digits));
+    }
+}
+
+/*!
+ * \private
+ * \brief Appends \a utf8 string to \a buffer as quoted json string
+ * \details Runs of characters that don't need escaping are copied at once
+ */
+void appendString(QByteArray &buffer, const QByteArray &utf8)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    const char *data = utf8.constData();
+    const int size = utf8.size();
+
+    buffer.append('"');
+    int begin = 0;
+    while (begin < size) {
+        const int position = findEscapedCharacter(data, size, begin);
+        buffer.append(data + begin, position - begin);
+        if (position == size) {
+            break;
+        }
+
+        const char character = data[position];
+        switch (character) {
+        case '"':
+            buffer.append("\\\"");
+            break;
+        case '\\':
+            buffer.append("\\\\");
+            break;
+        case '\b':
+            buffer.append("\\b");
+            break;
+        case '\f':
+            buffer.append("\\f");
+            break;
+        case '\n':
+            buffer.append("\\n");
+            break;
+        case '\r':
+            buffer.append("\\r");
+            break;
+        case '\t':
+            buffer.append("\\t");
+            break;
+        default:
+            buffer.append("\\u00");
+            buffer.append(hexDigits[(character >> 4) & 0x0F]);
+            buffer.append(hexDigits[character & 0x0F]);
+            break;
+        }
+        begin = position + 1;
+    }
+    buffer.append('"');
+}
+
+/*!
+ * \private
+ * \brief Appends \a value to \a buffer as quoted json string
+ * \details UTF-8 representation is encoded to thread-local scratch buffer, that keeps its capacity between calls
+ */
+void appendString(QByteArray &buffer, const QString &value)
+{
+    QByteArray &utf8 = QtProtobufPrivate::scratchBuffer();
+    QtProtobufPrivate::appendUtf8(value, utf8);
+    appendString(buffer, utf8);
+}
+
+bool readHex4(const char *data, const char *end, uint &value)
+{
+    if (end - data < 4) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        const char character = data[i];
+        value <<= 4;
+        if (character >= '0' && character <= '9') {
+            value |= static_cast<uint>(character - '0');
+        } else if (character >= 'a' && character <= 'f') {
+            value |= static_cast<uint>(character - 'a' + 10);
+        } else if (character >= 'A' && character <= 'F') {
+            value |= static_cast<uint>(character - 'A' + 10);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void appendUtf8(QByteArray &buffer, uint codePoint)
+{
+    if (codePoint < 0x80) {
+        buffer.append(static_cast<char>(codePoint));
+    } else if (codePoint < 0x800) {
+        buffer.append(static_cast<char>(0xC0 | (codePoint >> 6)));
+        buffer.append(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+        buffer.append(static_cast<char>(0xE0 | (codePoint >> 12)));
+        buffer.append(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        buffer.append(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else {
+        buffer.append(static_cast<char>(0xF0 | (codePoint >> 18)));
+        buffer.append(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        buffer.append(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        buffer.append(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+/*!
+ * \private
+ * \brief Appends character of escape sequence that starts at \a escape to \a buffer
+ * \return pointer to first character after escape sequence. Malformed sequences are copied as is.
+ */
+const char *unescapeSequence(const char *escape, const char *end, QByteArray &buffer)
+{
+    if (end - escape < 2) {
+        buffer.append('\\');
+        return end;
+    }
+
+    switch (escape[1]) {
+    case '"':
+    case '\\':
+    case '/':
+        buffer.append(escape[1]);
+        return escape + 2;
+    case 'b':
+        buffer.append('\b');
+        return escape + 2;
+    case 'f':
+        buffer.append('\f');
+        return escape + 2;
+    case 'n':
+        buffer.append('\n');
+        return escape + 2;
+    case 'r':
+        buffer.append('\r');
+        return escape + 2;
+    case 't':
+        buffer.append('\t');
+        return escape + 2;
+    case 'u':
+        break;
+    default:
+        buffer.append(escape, 2);
+        return escape + 2;
+    }
+
+    uint codePoint = 0;
+    if (!readHex4(escape + 2, end, codePoint)) {
+        buffer.append(escape, 2);
+        return escape + 2;
+    }
+
+    const char *next = escape + 6;
+    uint lowSurrogate = 0;
+    if (codePoint >= 0xD800 && codePoint < 0xDC00 && end - next >= 6 && next[0] == '\\' && next[1] == 'u'
+            && readHex4(next + 2, end, lowSurrogate) && lowSurrogate >= 0xDC00 && lowSurrogate < 0xE000) {
+        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+        next += 6;
+    }
+    appendUtf8(buffer, codePoint);
+    return next;
+}
+
+/*!
+ * \private
+ * \brief Returns json string \a data with escape sequences replaced by characters they represent
+ * \details Backslashes are located using memchr, that is vectorized by standard library on most platforms.
+ *          \a data is returned as is if it contains no escape sequences.
+ */
+QByteArray unescapeString(const QByteArray &data)
+{
+    const char *begin = data.constData();
+    const char *end = begin + data.size();
+    auto escape = static_cast<const char *>(memchr(begin, '\\', static_cast<size_t>(data.size())));
+    if (escape == nullptr) {
+        return data;
+    }
+
+    QByteArray result;
+    result.reserve(data.size());
+    while (escape != nullptr) {
+        result.append(begin, static_cast<int>(escape - begin));
+        begin = unescapeSequence(escape, end, result);
+        escape = static_cast<const char *>(memchr(begin, '\\', static_cast<size_t>(end - begin)));
+    }
+    result.append(begin, static_cast<int>(end - begin));
+    return result;
+}
+
+/*!
+ * \private
+ * \brief Appends base64 encoded \a data to \a buffer
+ * \details Output is written in place to the end of \a buffer, without intermediate byte array
+ */
+void appendBase64(QByteArray &buffer, const QByteArray &data)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const auto input = reinterpret_cast<const uchar *>(data.constData());
+    const int size = data.size();
+    const int offset = buffer.size();
+    buffer.resize(offset + (size + 2) / 3 * 4);
+    char *output = buffer.data() + offset;
+
+    int i = 0;
+    for (; i + 3 <= size; i += 3) {
+        const uint triple = (static_cast<uint>(input[i]) << 16) | (static_cast<uint>(input[i + 1]) << 8) | input[i + 2];
+        output[0] = alphabet[triple >> 18];
+        output[1] = alphabet[(triple >> 12) & 0x3F];
+        output[2] = alphabet[(triple >> 6) & 0x3F];
+        output[3] = alphabet[triple & 0x3F];
+        output += 4;
+    }
+
+    if (i < size) {
+        const bool hasSecond = i + 1 < size;
+        const uint triple = (static_cast<uint>(input[i]) << 16) | (hasSecond ? static_cast<uint>(input[i + 1]) << 8 : 0);
+        output[0] = alphabet[triple >> 18];
+        output[1] = alphabet[(triple >> 12) & 0x3F];
+        output[2] = hasSecond ? alphabet[(triple >> 6) & 0x3F] : '=';
+        output[3] = '=';
+    }
+}
+
+/*!
+ * \private
+ * \brief Decodes base64 \a data, both standard and URL-safe alphabets are accepted
+ * \details Like QByteArray::fromBase64 decoder skips characters that are not part of alphabet and stops at
+ *          padding. Groups of four valid characters are decoded without per character checks.
+ */
+QByteArray decodeBase64(const QByteArray &data)
+{
+    struct DecodingTable {
+        signed char values[256];
+    };
+    static const DecodingTable table = [] {
+        DecodingTable newTable;
+        std::fill(std::begin(newTable.values), std::end(newTable.values), static_cast<signed char>(-1));
+        const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (int i = 0; i < 64; ++i) {
+            newTable.values[static_cast<uchar>(alphabet[i])] = static_cast<signed char>(i);
+        }
+        newTable.values[static_cast<uchar>('-')] = 62;
+        newTable.values[static_cast<uchar>('_')] = 63;
+        return newTable;
+    }();
+
+    const auto input = reinterpret_cast<const uchar *>(data.constData());
+    const int size = data.size();
+    QByteArray result;
+    result.resize((size + 3) / 4 * 3);
+    auto output = reinterpret_cast<uchar *>(result.data());
+
+    int i = 0;
+    for (; i + 4 <= size; i += 4) {
+        const int a = table.values[input[i]];
+        const int b = table.values[input[i + 1]];
+        const int c = table.values[input[i + 2]];
+        const int d = table.values[input[i + 3]];
+        if ((a | b | c | d) < 0) {
+            break;//Padding or characters out of alphabet are handled below
+        }
+        const uint quad = (static_cast<uint>(a) << 18) | (static_cast<uint>(b) << 12) | (static_cast<uint>(c) << 6) | static_cast<uint>(d);
+        output[0] = static_cast<uchar>(quad >> 16);
+        output[1] = static_cast<uchar>(quad >> 8);
+        output[2] = static_cast<uchar>(quad);
+        output += 3;
+    }
+
+    uint accumulator = 0;
+    int bits = 0;
+    for (; i < size && input[i] != '='; ++i) {
+        const int value = table.values[input[i]];
+        if (value < 0) {
+            continue;
+        }
+        accumulator = (accumulator << 6) | static_cast<uint>(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            *output++ = static_cast<uchar>(accumulator >> bits);
+            accumulator &= (1u << bits) - 1;
+        }
+    }
+
+    result.resize(static_cast<int>(output - reinterpret_cast<const uchar *>(result.constData())));
+    return result;
+}
+
+/*!
+ * \private
+ * \brief Replaces trailing comma in \a buffer with \a closing character or appends it if list is empty
+ */
+void closeList(QByteArray &buffer, char closing)
+{
+    if (buffer.endsWith(',')) {
+        buffer[buffer.size() - 1] = closing;
+    } else {
+        buffer.append(closing);
+    }
+}
+
+/*!
+ * \private
+ * \brief The EnumNames struct holds name and value lookup tables of enumeration
+ *
+ * \details Tables are built once per enumeration in each thread, so names and values are not searched by linear
+ *          QMetaEnum scans for each serialized value.
+ */
+struct EnumNames {
+    QHash<int64_t, QByteArray> names;
+    QHash<QByteArray, int> values;
+};
+
+/*!
+ * \private
+ * \brief Returns lookup tables of \a metaEnum
+ */
+const EnumNames &enumNames(const QMetaEnum &metaEnum)
+{
+    //Name of enumeration is stored in static meta-object data, so its address identifies enumeration
+    thread_local QHash<const void *, EnumNames> cache;
+    auto it = cache.find(metaEnum.name());
+    if (it != cache.end()) {
+        return *it;
+    }
+
+    EnumNames &table = cache[metaEnum.name()];
+    for (int i = 0; i < metaEnum.keyCount(); ++i) {
+        //First key of aliased values is used for serialization, same as QMetaEnum::valueToKey does
+        if (!table.names.contains(metaEnum.value(i))) {
+            table.names.insert(metaEnum.value(i), QByteArray(metaEnum.key(i)));
+        }
+        table.values.insert(QByteArray(metaEnum.key(i)), metaEnum.value(i));
+    }
+    return table;
+}
+
+/*!
+ * \private
+ * \brief Returns name of enumeration \a value of \a metaEnum, empty if \a value is unknown
+ */
+QByteArray enumKey(const QMetaEnum &metaEnum, int64_t value)
+{
+    return enumNames(metaEnum).names.value(value);
+}
+
+/*!
+ * \private
+ * \brief Converts enumeration key or its integer value stored in \a size bytes of \a data to value of \a metaEnum
+ * \return -1 if key is neither known name nor integer
+ */
+int enumValue(const QMetaEnum &metaEnum, const char *data, int size)
+{
+    const EnumNames &table = enumNames(metaEnum);
+    auto it = table.values.constFind(QByteArray::fromRawData(data, size));
+    if (it != table.values.constEnd()) {
+        return *it;
+    }
+
+    //Scoped names are resolved by meta-enum, key is copied to get zero-terminated string
+    const QByteArray key(data, size);
+    bool ok = false;
+    int value = metaEnum.keyToValue(key.constData(), &ok);
+    if (!ok) {
+        const int number = key.toInt(&ok);
+        if (ok) {
+            value = number;
+        }
+    }
+    return value;
+}
+
+/*!
+ * \private
+ * \brief Destination of streaming serialization that is in progress in current thread
+ *
+ * \details Only \a buffer is flushed to \a device, temporary buffers used to serialize parts of the message
+ *          are kept as is.
+ */
+struct StreamSink {
+    QIODevice *device;
+    QByteArray *buffer;
+    qint64 flushed;
+    bool failed;
+};
+thread_local StreamSink *currentStreamSink = nullptr;
+
+//Size of serialized data collected before it's written to device
+enum { StreamChunkSize = 64 * 1024 };
+
+/*!
+ * \private
+ * \brief The StreamSinkScope class makes \a sink current for the lifetime of the scope
+ */
+class StreamSinkScope
+{
+public:
+    StreamSinkScope(StreamSink *sink) : m_previous(currentStreamSink) {
+        currentStreamSink = sink;
+    }
+    ~StreamSinkScope() {
+        currentStreamSink = m_previous;
+    }
+private:
+    Q_DISABLE_COPY_MOVE(StreamSinkScope)
+    StreamSink *m_previous;
+};
+
+/*!
+ * \private
+ * \brief Writes \a buffer to device of current stream sink once it collected enough data
+ *
+ * \details Must be called only before next field, list element or map pair is appended: at this point
+ *          \a buffer never ends with separator that may be removed when list is closed.
+ */
+void flushStreamChunk(QByteArray &buffer)
+{
+    if (currentStreamSink == nullptr || currentStreamSink->buffer != &buffer
+            || buffer.size() < StreamChunkSize) {
+        return;
+    }
+
+    if (!currentStreamSink->failed && currentStreamSink->device->write(buffer) != buffer.size()) {
+        qProtoWarning() << "Unable to write serialized message to device:" << currentStreamSink->device->errorString();
+        currentStreamSink->failed = true;
+    }
+    currentStreamSink->flushed += buffer.size();
+    //Reserved capacity is kept, so buffer is reused for the next chunk
+    buffer.resize(0);
+}
+
+/*!
+ * \private
+ * \brief Returns number of bytes of \a buffer, that were already written to device of current stream sink
+ */
+qint64 flushedSize(const QByteArray &buffer)
+{
+    return currentStreamSink != nullptr && currentStreamSink->buffer == &buffer ? currentStreamSink->flushed : 0;
+}
+
+/*!
+ * \private
+ * \brief Checks if json value at the end of \a buffer starting at \a valueStart is default value of any field type
+ */
+bool isDefaultJsonValue(const QByteArray &buffer, int valueStart)
+{
+    const char *value = buffer.constData() + valueStart;
+    switch (buffer.size() - valueStart) {
+    case 1:
+        return value[0] == '0';
+    case 2:
+        return (value[0] == '"' && value[1] == '"')
+                || (value[0] == '[' && value[1] == ']')
+                || (value[0] == '{' && value[1] == '}');
+    case 5:
+        return memcmp(value, "false", 5) == 0;
+    default:
+        break;
+    }
+    return false;
+}
+
+}
 
 namespace QtProtobuf {
 
@@ -41,207 +622,243 @@ class QProtobufJsonSerializerPrivate final
 {
     Q_DISABLE_COPY_MOVE(QProtobufJsonSerializerPrivate)
 public:
-    using Serializer = std::function<QByteArray(const QVariant&)>;
-    using Deserializer = std::function<QVariant(QByteArray, microjson::JsonType, bool &)>;
+    using Serializer = void(*)(const QVariant &, QByteArray &);
+    using Deserializer = QVariant(*)(const QByteArray &, QProtobufJsonTokenizer::TokenType, bool &);
 
     struct SerializationHandlers {
-        Serializer serializer; /*!< serializer assigned to class */
+        Serializer serializer; /*!< serializer assigned to class, appends value to buffer */
         Deserializer deserializer;/*!< deserializer assigned to class */
+        const QtProtobufPrivate::SerializationHandler *complexHandler;/*!< handler of message, list, map or enum type */
     };
 
-    using SerializerRegistry = std::unordered_map<int/*metatypeid*/, SerializationHandlers>;
+    using SerializerRegistry = QtProtobufPrivate::DispatchTable<SerializationHandlers>;
+
+    template<typename T, typename V>
+    static void serializeInteger(const QVariant &propertyValue, QByteArray &buffer) {
+        appendInteger<V>(buffer, propertyValue.value<T>());
+    }
 
-    static QByteArray serializeFloat(const QVariant &propertyValue) {
+    static void serializeFloat(const QVariant &propertyValue, QByteArray &buffer) {
         bool ok = false;
         float value = propertyValue.toFloat(&ok);
         if (!ok) {
-            return QByteArray("NaN");
+            buffer.append("NaN");
+            return;
         }
-        return QString::number(static_cast<double>(value), 'g').toUtf8();
+        appendFloatingPoint(buffer, value);
     }
 
-    static QByteArray serializeString(const QVariant &propertyValue) {
-        return QString("\"%1\"").arg(propertyValue.toString()).toUtf8() ;
+    static void serializeDouble(const QVariant &propertyValue, QByteArray &buffer) {
+        appendFloatingPoint(buffer, propertyValue.toDouble());
     }
 
-    static QByteArray serializeBytes(const QVariant &propertyValue) {
-        return QByteArray("\"") + propertyValue.toByteArray().toBase64() + "\"";
+    static void serializeString(const QVariant &propertyValue, QByteArray &buffer) {
+        appendString(buffer, *static_cast<const QString *>(propertyValue.constData()));
     }
 
-    template<typename L>
-    static QByteArray serializeList(const QVariant &propertyValue) {
+    static void serializeUtf8String(const QVariant &propertyValue, QByteArray &buffer) {
+        appendString(buffer, *static_cast<const QtProtobuf::utf8string *>(propertyValue.constData()));
+    }
+
+    static void serializeBytes(const QVariant &propertyValue, QByteArray &buffer) {
+        buffer.append('"');
+        appendBase64(buffer, propertyValue.toByteArray());
+        buffer.append('"');
+    }
+
+    template<typename L, typename V>
+    static void serializeList(const QVariant &propertyValue, QByteArray &buffer) {
         L listValue = propertyValue.value<L>();
-        QByteArray result("[");
+        buffer.append('[');
         for (auto value : listValue) {
-            result += QString::number(value).toUtf8() + ",";
-        }
-        if (listValue.size() > 0) {
-            result.resize(result.size() - 1);//Remove trailing `,`
+            appendInteger<V>(buffer, value);
+            buffer.append(',');
         }
-        result += "]";
-        return result;
+        closeList(buffer, ']');
     }
 
-    static QByteArray serializeDoubleList(const QVariant &propertyValue) {
-        DoubleList listValue = propertyValue.value<DoubleList>();
-        QByteArray result("[");
+    template<typename L>
+    static void serializeFloatingPointList(const QVariant &propertyValue, QByteArray &buffer) {
+        L listValue = propertyValue.value<L>();
+        buffer.append('[');
         for (auto value : listValue) {
-            result += QString::number(value, 'g').toUtf8() + ",";
+            appendFloatingPoint(buffer, value);
+            buffer.append(',');
         }
-        if (listValue.size() > 0) {
-            result.resize(result.size() - 1);//Remove trailing `,`
-        }
-        result += "]";
-        return result;
+        closeList(buffer, ']');
     }
 
-    static QByteArray serializeStringList(const QVariant &propertyValue) {
+    static void serializeStringList(const QVariant &propertyValue, QByteArray &buffer) {
         QStringList listValue = propertyValue.value<QStringList>();
-        QByteArray result("[");
-        for (auto value : listValue) {
-            result += QByteArray("\"") + value.toUtf8() + "\",";
-        }
-        if (listValue.size() > 0) {
-            result.resize(result.size() - 1);//Remove trailing `,`
+        buffer.append('[');
+        for (const auto &value : listValue) {
+            appendString(buffer, value);
+            buffer.append(',');
         }
-        result += "]";
-        return result;
+        closeList(buffer, ']');
     }
 
-    static QByteArray serializeBytesList(const QVariant &propertyValue) {
+    static void serializeBytesList(const QVariant &propertyValue, QByteArray &buffer) {
         QByteArrayList listValue = propertyValue.value<QByteArrayList>();
-        QByteArray result("[");
-        for (auto value : listValue) {
-            result += QByteArray("\"") + value.toBase64() + "\",";
-        }
-        if (listValue.size() > 0) {
-            result.resize(result.size() - 1);//Remove trailing `,`
+        buffer.append('[');
+        for (const auto &value : listValue) {
+            buffer.append('"');
+            appendBase64(buffer, value);
+            buffer.append("\",");
         }
-        result += "]";
-        return result;
+        closeList(buffer, ']');
     }
 
     QProtobufJsonSerializerPrivate(QProtobufJsonSerializer *q) : qPtr(q) {
-        if (handlers.empty()) {
-            handlers[qMetaTypeId<QtProtobuf::int32>()] = {{}, QProtobufJsonSerializerPrivate::deserializeInt32};
-            handlers[qMetaTypeId<QtProtobuf::sfixed32>()] = {{}, QProtobufJsonSerializerPrivate::deserializeInt32};
-            handlers[qMetaTypeId<QtProtobuf::sint32>()] = {{}, QProtobufJsonSerializerPrivate::deserializeInt32};
-            handlers[qMetaTypeId<QtProtobuf::sint64>()] = {{}, QProtobufJsonSerializerPrivate::deserializeInt64};
-            handlers[qMetaTypeId<QtProtobuf::int64>()] = {{}, QProtobufJsonSerializerPrivate::deserializeInt64};
-            handlers[qMetaTypeId<QtProtobuf::sfixed64>()] = {{}, QProtobufJsonSerializerPrivate::deserializeInt64};
-            handlers[qMetaTypeId<QtProtobuf::uint32>()] = {{}, QProtobufJsonSerializerPrivate::deserializeUInt32};
-            handlers[qMetaTypeId<QtProtobuf::fixed32>()] = {{}, QProtobufJsonSerializerPrivate::deserializeUInt32};
-            handlers[qMetaTypeId<QtProtobuf::uint64>()] = {{}, QProtobufJsonSerializerPrivate::deserializeUInt64};
-            handlers[qMetaTypeId<QtProtobuf::fixed64>()] = {{}, QProtobufJsonSerializerPrivate::deserializeUInt64};
-            handlers[qMetaTypeId<bool>()] = {{}, QProtobufJsonSerializerPrivate::deserializeBool};
-            handlers[QMetaType::Float] = {QProtobufJsonSerializerPrivate::serializeFloat, QProtobufJsonSerializerPrivate::deserializeFloat};
-            handlers[QMetaType::Double] = {{}, QProtobufJsonSerializerPrivate::deserializeDouble};
-            handlers[QMetaType::QString] = {QProtobufJsonSerializerPrivate::serializeString, QProtobufJsonSerializerPrivate::deserializeString};
-            handlers[QMetaType::QByteArray] = {QProtobufJsonSerializerPrivate::serializeBytes, QProtobufJsonSerializerPrivate::deserializeByteArray};
-            handlers[qMetaTypeId<QtProtobuf::int32List>()] = {QProtobufJsonSerializerPrivate::serializeList<QtProtobuf::int32List>, QProtobufJsonSerializerPrivate::deserializeList<QtProtobuf::int32>};
-            handlers[qMetaTypeId<QtProtobuf::int64List>()] = {QProtobufJsonSerializerPrivate::serializeList<QtProtobuf::int64List>, QProtobufJsonSerializerPrivate::deserializeList<QtProtobuf::int64>};
-            handlers[qMetaTypeId<QtProtobuf::sint32List>()] = {QProtobufJsonSerializerPrivate::serializeList<QtProtobuf::sint32List>, QProtobufJsonSerializerPrivate::deserializeList<QtProtobuf::sint32>};
-            handlers[qMetaTypeId<QtProtobuf::sint64List>()] = {QProtobufJsonSerializerPrivate::serializeList<QtProtobuf::sint64List>, QProtobufJsonSerializerPrivate::deserializeList<QtProtobuf::sint64>};
-            handlers[qMetaTypeId<QtProtobuf::uint32List>()] = {QProtobufJsonSerializerPrivate::serializeList<QtProtobuf::uint32List>, QProtobufJsonSerializerPrivate::deserializeList<QtProtobuf::uint32>};
-            handlers[qMetaTypeId<QtProtobuf::uint64List>()] = {QProtobufJsonSerializerPrivate::serializeList<QtProtobuf::uint64List>, QProtobufJsonSerializerPrivate::deserializeList<QtProtobuf::uint64>};
-            handlers[qMetaTypeId<QtProtobuf::fixed32List>()] = {QProtobufJsonSerializerPrivate::serializeList<QtProtobuf::fixed32List>, QProtobufJsonSerializerPrivate::deserializeList<QtProtobuf::fixed32>};
-            handlers[qMetaTypeId<QtProtobuf::fixed64List>()] = {QProtobufJsonSerializerPrivate::serializeList<QtProtobuf::fixed64List>, QProtobufJsonSerializerPrivate::deserializeList<QtProtobuf::fixed64>};
-            handlers[qMetaTypeId<QtProtobuf::sfixed32List>()] = {QProtobufJsonSerializerPrivate::serializeList<QtProtobuf::sfixed32List>, QProtobufJsonSerializerPrivate::deserializeList<QtProtobuf::sfixed32>};
-            handlers[qMetaTypeId<QtProtobuf::sfixed64List>()] = {QProtobufJsonSerializerPrivate::serializeList<QtProtobuf::sfixed64List>, QProtobufJsonSerializerPrivate::deserializeList<QtProtobuf::sfixed64>};
-            handlers[qMetaTypeId<QtProtobuf::FloatList>()] = {QProtobufJsonSerializerPrivate::serializeList<QtProtobuf::FloatList>, QProtobufJsonSerializerPrivate::deserializeList<float>};
-            handlers[qMetaTypeId<QtProtobuf::DoubleList>()] = {QProtobufJsonSerializerPrivate::serializeDoubleList, QProtobufJsonSerializerPrivate::deserializeList<double>};
-            handlers[qMetaTypeId<QStringList>()] = {QProtobufJsonSerializerPrivate::serializeStringList, QProtobufJsonSerializerPrivate::deserializeStringList};
-            handlers[qMetaTypeId<QByteArrayList>()] = {QProtobufJsonSerializerPrivate::serializeBytesList, QProtobufJsonSerializerPrivate::deserializeList<QByteArray>};
-        }
+        //Basic handlers are registered once, when first serializer is created
+        static const bool basicHandlersRegistered = [] {
+            handlers().insert(qMetaTypeId<QtProtobuf::int32>(), {QProtobufJsonSerializerPrivate::serializeInteger<QtProtobuf::int32, int32_t>, QProtobufJsonSerializerPrivate::deserializeInt32, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::sfixed32>(), {QProtobufJsonSerializerPrivate::serializeInteger<QtProtobuf::sfixed32, int32_t>, QProtobufJsonSerializerPrivate::deserializeInt32, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::sint32>(), {QProtobufJsonSerializerPrivate::serializeInteger<QtProtobuf::sint32, int32_t>, QProtobufJsonSerializerPrivate::deserializeInt32, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::sint64>(), {QProtobufJsonSerializerPrivate::serializeInteger<QtProtobuf::sint64, int64_t>, QProtobufJsonSerializerPrivate::deserializeInt64, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::int64>(), {QProtobufJsonSerializerPrivate::serializeInteger<QtProtobuf::int64, int64_t>, QProtobufJsonSerializerPrivate::deserializeInt64, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::sfixed64>(), {QProtobufJsonSerializerPrivate::serializeInteger<QtProtobuf::sfixed64, int64_t>, QProtobufJsonSerializerPrivate::deserializeInt64, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::uint32>(), {QProtobufJsonSerializerPrivate::serializeInteger<QtProtobuf::uint32, uint32_t>, QProtobufJsonSerializerPrivate::deserializeUInt32, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::fixed32>(), {QProtobufJsonSerializerPrivate::serializeInteger<QtProtobuf::fixed32, uint32_t>, QProtobufJsonSerializerPrivate::deserializeUInt32, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::uint64>(), {QProtobufJsonSerializerPrivate::serializeInteger<QtProtobuf::uint64, uint64_t>, QProtobufJsonSerializerPrivate::deserializeUInt64, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::fixed64>(), {QProtobufJsonSerializerPrivate::serializeInteger<QtProtobuf::fixed64, uint64_t>, QProtobufJsonSerializerPrivate::deserializeUInt64, nullptr});
+            handlers().insert(qMetaTypeId<bool>(), {nullptr, QProtobufJsonSerializerPrivate::deserializeBool, nullptr});
+            handlers().insert(QMetaType::Float, {QProtobufJsonSerializerPrivate::serializeFloat, QProtobufJsonSerializerPrivate::deserializeFloat, nullptr});
+            handlers().insert(QMetaType::Double, {QProtobufJsonSerializerPrivate::serializeDouble, QProtobufJsonSerializerPrivate::deserializeDouble, nullptr});
+            handlers().insert(QMetaType::QString, {QProtobufJsonSerializerPrivate::serializeString, QProtobufJsonSerializerPrivate::deserializeString, nullptr});
+            handlers().insert(QMetaType::QByteArray, {QProtobufJsonSerializerPrivate::serializeBytes, QProtobufJsonSerializerPrivate::deserializeByteArray, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::utf8string>(), {QProtobufJsonSerializerPrivate::serializeUtf8String, QProtobufJsonSerializerPrivate::deserializeUtf8String, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::int32List>(), {QProtobufJsonSerializerPrivate::serializeList<QtProtobuf::int32List, int32_t>, QProtobufJsonSerializerPrivate::deserializeList<QtProtobuf::int32>, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::int64List>(), {QProtobufJsonSerializerPrivate::serializeList<QtProtobuf::int64List, int64_t>, QProtobufJsonSerializerPrivate::deserializeList<QtProtobuf::int64>, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::sint32List>(), {QProtobufJsonSerializerPrivate::serializeList<QtProtobuf::sint32List, int32_t>, QProtobufJsonSerializerPrivate::deserializeList<QtProtobuf::sint32>, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::sint64List>(), {QProtobufJsonSerializerPrivate::serializeList<QtProtobuf::sint64List, int64_t>, QProtobufJsonSerializerPrivate::deserializeList<QtProtobuf::sint64>, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::uint32List>(), {QProtobufJsonSerializerPrivate::serializeList<QtProtobuf::uint32List, uint32_t>, QProtobufJsonSerializerPrivate::deserializeList<QtProtobuf::uint32>, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::uint64List>(), {QProtobufJsonSerializerPrivate::serializeList<QtProtobuf::uint64List, uint64_t>, QProtobufJsonSerializerPrivate::deserializeList<QtProtobuf::uint64>, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::fixed32List>(), {QProtobufJsonSerializerPrivate::serializeList<QtProtobuf::fixed32List, uint32_t>, QProtobufJsonSerializerPrivate::deserializeList<QtProtobuf::fixed32>, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::fixed64List>(), {QProtobufJsonSerializerPrivate::serializeList<QtProtobuf::fixed64List, uint64_t>, QProtobufJsonSerializerPrivate::deserializeList<QtProtobuf::fixed64>, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::sfixed32List>(), {QProtobufJsonSerializerPrivate::serializeList<QtProtobuf::sfixed32List, int32_t>, QProtobufJsonSerializerPrivate::deserializeList<QtProtobuf::sfixed32>, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::sfixed64List>(), {QProtobufJsonSerializerPrivate::serializeList<QtProtobuf::sfixed64List, int64_t>, QProtobufJsonSerializerPrivate::deserializeList<QtProtobuf::sfixed64>, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::FloatList>(), {QProtobufJsonSerializerPrivate::serializeFloatingPointList<QtProtobuf::FloatList>, QProtobufJsonSerializerPrivate::deserializeList<float>, nullptr});
+            handlers().insert(qMetaTypeId<QtProtobuf::DoubleList>(), {QProtobufJsonSerializerPrivate::serializeFloatingPointList<QtProtobuf::DoubleList>, QProtobufJsonSerializerPrivate::deserializeList<double>, nullptr});
+            handlers().insert(qMetaTypeId<QStringList>(), {QProtobufJsonSerializerPrivate::serializeStringList, QProtobufJsonSerializerPrivate::deserializeStringList, nullptr});
+            handlers().insert(qMetaTypeId<QByteArrayList>(), {QProtobufJsonSerializerPrivate::serializeBytesList, QProtobufJsonSerializerPrivate::deserializeList<QByteArray>, nullptr});
+            return true;
+        }();
+        Q_UNUSED(basicHandlersRegistered)
     }
     ~QProtobufJsonSerializerPrivate() = default;
 
-    QByteArray serializeValue(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty) {
-        QByteArray buffer;
+    void serializeValue(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty, QByteArray &buffer) {
         auto userType = propertyValue.userType();
-        auto value = QtProtobufPrivate::findHandler(userType);
-        if (value.serializer) {
-            value.serializer(qPtr, propertyValue, metaProperty, buffer);
+        const SerializationHandlers *typeHandlers = findHandlers(userType);
+        if (typeHandlers != nullptr && typeHandlers->complexHandler != nullptr
+                && typeHandlers->complexHandler->serializer != nullptr) {
+            typeHandlers->complexHandler->serializer(qPtr, propertyValue, metaProperty, buffer);
+        } else if (typeHandlers != nullptr && typeHandlers->serializer != nullptr) {
+            typeHandlers->serializer(propertyValue, buffer);
         } else {
-            auto handler = handlers.find(userType);
-            if (handler != handlers.end() && handler->second.serializer) {
-                buffer += handler->second.serializer(propertyValue);
-            } else {
-                buffer += propertyValue.toString().toUtf8();
-            }
+            QtProtobufPrivate::appendUtf8(propertyValue.toString(), buffer);
         }
-        return buffer;
     }
 
-    QByteArray serializeProperty(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty) {
-        return QByteArray("\"") + metaProperty.jsonPropertyName().toUtf8() + "\":" + serializeValue(propertyValue, metaProperty);
+    void serializeObject(const QObject *object, const QProtobufMetaObject &metaObject, QByteArray &buffer) {
+        //Fields that were never set are written only if default values are not omitted
+        serializeFields(object, metaObject, omitDefaultValues ? metaObject.presenceOf(object) : nullptr, buffer);
+    }
+
+    void serializeFields(const QObject *object, const QProtobufMetaObject &metaObject, const quint32 *fields, QByteArray &buffer) {
+        buffer.append('{');
+        const QProtobufFieldPlan &plan = metaObject.fieldPlan();
+        const quint32 *presence = metaObject.presenceOf(object);
+        plan.forEachPresentField(fields, [&](const QProtobufFieldPlanEntry &field) {
+            Q_ASSERT_X(field.fieldNumber < 536870912 && field.fieldNumber > 0, "", "fieldIndex is out of range");
+            const QVariant &propertyValue = field.metaProperty.read(object);
+            //Optional fields that are set are written even with default value
+            const bool omitDefaultValue = omitDefaultValues && !plan.isExplicitlySet(field, presence);
+            if (omitDefaultValue && (QMetaType::typeFlags(field.userType) & QMetaType::IsEnumeration)
+                    && propertyValue.toLongLong() == 0) {
+                return;
+            }
+
+            flushStreamChunk(buffer);
+            const int fieldStart = buffer.size();
+            const qint64 flushed = flushedSize(buffer);
+            const QByteArray &key = protoFieldNames ? field.protoJsonKey : field.jsonKey;
+            buffer.append(key);
+            serializeValue(propertyValue, field.metaProperty, buffer);
+            //Default values are recognized by serialized form, field is dropped if it wasn't flushed yet
+            if (omitDefaultValue && flushedSize(buffer) == flushed
+                    && isDefaultJsonValue(buffer, fieldStart + key.size())) {
+                buffer.resize(fieldStart);
+                return;
+            }
+            buffer.append(',');
+        });
+        closeList(buffer, '}');
     }
 
     QByteArray serializeObject(const QObject *object, const QProtobufMetaObject &metaObject) {
-        QByteArray result = "{";
-        for (const auto &field : metaObject.propertyOrdering) {
-            int propertyIndex = field.second;
-            int fieldIndex = field.first;
-            Q_ASSERT_X(fieldIndex < 536870912 && fieldIndex > 0, "", "fieldIndex is out of range");
-            QMetaProperty metaProperty = metaObject.staticMetaObject.property(propertyIndex);
-            const char *propertyName = metaProperty.name();
-            const QVariant &propertyValue = object->property(propertyName);
-            result.append(serializeProperty(propertyValue, QProtobufMetaProperty(metaProperty,
-                                                                                 fieldIndex,
-                                                                                 field.second)));
-            result.append(",");
-        }
-        result.resize(result.size() - 1);//Remove trailing `,`
-        result.append("}");
-        return result;
+        QByteArray buffer = QProtobufBufferAllocator::current()->allocate(0);
+        serializeObject(object, metaObject, buffer);
+        return buffer;
     }
 
-    static QVariant deserializeInt32(const QByteArray &data, microjson::JsonType type, bool &ok) {
+    static QVariant deserializeInt32(const QByteArray &data, QProtobufJsonTokenizer::TokenType type, bool &ok) {
         auto val = data.toInt(&ok);
-        ok |= type == microjson::JsonNumberType;
+        ok |= type == QProtobufJsonTokenizer::NumberToken;
         return QVariant::fromValue(val);
     }
 
-    static QVariant deserializeUInt32(const QByteArray &data, microjson::JsonType type, bool &ok) {
+    static QVariant deserializeUInt32(const QByteArray &data, QProtobufJsonTokenizer::TokenType type, bool &ok) {
         auto val = data.toUInt(&ok);
-        ok |= type == microjson::JsonNumberType;
+        ok |= type == QProtobufJsonTokenizer::NumberToken;
         return QVariant::fromValue(val);
     }
 
-    static QVariant deserializeInt64(const QByteArray &data, microjson::JsonType type, bool &ok) {
+    static QVariant deserializeInt64(const QByteArray &data, QProtobufJsonTokenizer::TokenType type, bool &ok) {
         auto val = data.toLongLong(&ok);
-        ok |= type == microjson::JsonNumberType;
+        ok |= type == QProtobufJsonTokenizer::NumberToken;
         return QVariant::fromValue(val);
     }
 
-    static QVariant deserializeUInt64(const QByteArray &data, microjson::JsonType type, bool &ok) {
+    static QVariant deserializeUInt64(const QByteArray &data, QProtobufJsonTokenizer::TokenType type, bool &ok) {
         auto val = data.toULongLong(&ok);
-        ok |= type == microjson::JsonNumberType;
+        ok |= type == QProtobufJsonTokenizer::NumberToken;
         return QVariant::fromValue(val);
     }
 
-    static QVariant deserializeFloat(const QByteArray &data, microjson::JsonType type, bool &ok) {
+    static QVariant deserializeFloat(const QByteArray &data, QProtobufJsonTokenizer::TokenType type, bool &ok) {
         if (data == "NaN" || data == "Infinity" || data == "-Infinity") {
             ok = true;
             return QVariant();
         }
-        auto val = data.toFloat(&ok);
-        ok |= type == microjson::JsonNumberType;
+        float val = 0;
+        if (QtProtobufPrivate::parseFloatingPoint(data.constData(), data.size(), val)) {
+            ok = true;
+        } else {
+            val = data.toFloat(&ok);
+        }
+        ok |= type == QProtobufJsonTokenizer::NumberToken;
         return QVariant::fromValue(val);
     }
 
-    static QVariant deserializeDouble(const QByteArray &data, microjson::JsonType type, bool &ok) {
+    static QVariant deserializeDouble(const QByteArray &data, QProtobufJsonTokenizer::TokenType type, bool &ok) {
         if (data == "NaN" || data == "Infinity" || data == "-Infinity") {
             ok = true;
             return QVariant();
         }
-        auto val = data.toDouble(&ok);
-        ok |= type == microjson::JsonNumberType;
+        double val = 0;
+        if (QtProtobufPrivate::parseFloatingPoint(data.constData(), data.size(), val)) {
+            ok = true;
+        } else {
+            val = data.toDouble(&ok);
+        }
+        ok |= type == QProtobufJsonTokenizer::NumberToken;
         return QVariant::fromValue(val);
     }
 
-    static QVariant deserializeBool(const QByteArray &data, microjson::JsonType type, bool &ok) {
-        if (type == microjson::JsonBoolType) {
+    static QVariant deserializeBool(const QByteArray &data, QProtobufJsonTokenizer::TokenType type, bool &ok) {
+        if (type == QProtobufJsonTokenizer::BoolToken) {
             ok = true;
             return QVariant::fromValue(data == "true");
         }
@@ -250,20 +867,30 @@ public:
         return QVariant();
     }
 
-    static QVariant deserializeString(const QByteArray &data, microjson::JsonType type, bool &ok) {
-        if (type == microjson::JsonStringType) {
+    static QVariant deserializeString(const QByteArray &data, QProtobufJsonTokenizer::TokenType type, bool &ok) {
+        if (type == QProtobufJsonTokenizer::StringToken) {
             ok = true;
-            return QVariant::fromValue(QString::fromUtf8(data).replace("\\\"", "\""));
+            return QVariant::fromValue(QString::fromUtf8(unescapeString(data)));
         }
 
         ok = false;
         return QVariant();
     }
 
-    static QVariant deserializeByteArray(const QByteArray &data, microjson::JsonType type, bool &ok) {
-        if (type == microjson::JsonStringType) {
+    static QVariant deserializeUtf8String(const QByteArray &data, QProtobufJsonTokenizer::TokenType type, bool &ok) {
+        if (type == QProtobufJsonTokenizer::StringToken) {
             ok = true;
-            return QVariant::fromValue(QByteArray::fromBase64(data));
+            return QVariant::fromValue(QtProtobuf::utf8string(unescapeString(data)));
+        }
+
+        ok = false;
+        return QVariant();
+    }
+
+    static QVariant deserializeByteArray(const QByteArray &data, QProtobufJsonTokenizer::TokenType type, bool &ok) {
+        if (type == QProtobufJsonTokenizer::StringToken) {
+            ok = true;
+            return QVariant::fromValue(decodeBase64(unescapeString(data)));
         }
 
         ok = false;
@@ -271,100 +898,403 @@ public:
     }
 
     template<typename T>
-    static QVariant deserializeList(const QByteArray &data, microjson::JsonType type, bool &ok) {
-        if (type != microjson::JsonArrayType) {
+    static QVariant deserializeList(const QByteArray &data, QProtobufJsonTokenizer::TokenType type, bool &ok) {
+        if (type != QProtobufJsonTokenizer::ArrayToken) {
             ok = false;
             return QVariant();
         }
 
         ok = true;
         QList<T> list;
-        auto arrayValues = microjson::parseJsonArray(data.data(), static_cast<size_t>(data.size()));
-        auto handler = handlers.find(qMetaTypeId<T>());
-        if (handler == handlers.end() || !handler->second.deserializer) {
+        list.reserve(QProtobufJsonTokenizer::itemCount(data.constData(), data.size()));
+        const SerializationHandlers *handler = handlers().find(qMetaTypeId<T>());
+        if (handler == nullptr || handler->deserializer == nullptr) {
             qProtoWarning() << "Unable to deserialize simple type list. Could not find desrializer for type" << qMetaTypeId<T>();
             return QVariant::fromValue(list);
         }
 
-        for (auto &arrayValue : arrayValues) {
+        QProtobufJsonTokenizer tokenizer(data.constData(), data.size());
+        tokenizer.enter('[');
+        QProtobufJsonTokenizer::Token element;
+        while (tokenizer.nextElement(element)) {
             bool valueOk = false;
-            QVariant newValue = handler->second.deserializer(QByteArray::fromStdString(arrayValue.value), arrayValue.type, valueOk);
+            QVariant newValue = handler->deserializer(element.bytes(), element.type, valueOk);
             list.append(newValue.value<T>());
         }
         return QVariant::fromValue(list);
     }
 
-    static QVariant deserializeStringList(const QByteArray &data, microjson::JsonType type, bool &ok) {
-        if (type != microjson::JsonArrayType) {
+    static QVariant deserializeStringList(const QByteArray &data, QProtobufJsonTokenizer::TokenType type, bool &ok) {
+        if (type != QProtobufJsonTokenizer::ArrayToken) {
             ok = false;
             return QVariant();
         }
 
         ok = true;
         QStringList list;
-        auto arrayValues = microjson::parseJsonArray(data.data(), static_cast<size_t>(data.size()));
-        for (auto &arrayValue : arrayValues) {
-            bool valueOk = false;
-            QVariant newValue = deserializeString(QByteArray::fromStdString(arrayValue.value), arrayValue.type, valueOk);
-            list.append(newValue.value<QString>());
+        list.reserve(QProtobufJsonTokenizer::itemCount(data.constData(), data.size()));
+        QProtobufJsonTokenizer tokenizer(data.constData(), data.size());
+        tokenizer.enter('[');
+        QProtobufJsonTokenizer::Token element;
+        while (tokenizer.nextElement(element)) {
+            list.append(element.type == QProtobufJsonTokenizer::StringToken ? QString::fromUtf8(unescapeString(element.bytes()))
+                                                                            : QString());
         }
         return QVariant::fromValue(list);
     }
 
-    QVariant deserializeValue(int type, const QByteArray &data, microjson::JsonType jsonType, bool &ok) {
+    /*!
+     * \brief Decodes \a token of parsed json to value of \a type
+     *
+     * \details Messages, lists and maps are decoded over bytes of \a token, so nested values are neither
+     *          copied nor parsed again.
+     */
+    QVariant deserializeValue(int type, const QProtobufJsonTokenizer::Token &token, bool &ok) {
         QVariant newValue;
-        auto handler = QtProtobufPrivate::findHandler(type);
-        if (handler.deserializer) {
-            QtProtobuf::QProtobufSelfcheckIterator it(data);
-            QtProtobuf::QProtobufSelfcheckIterator last = it;
-            last += it.size();
-            while (it != last) {
-                ok = true;
-                handler.deserializer(qPtr, it, newValue);
-                qDebug() << "newValue" << newValue;
+        const SerializationHandlers *typeHandlers = findHandlers(type);
+        if (typeHandlers == nullptr) {
+            return newValue;
+        }
+
+        if (typeHandlers->complexHandler != nullptr) {
+            const auto &handler = *(typeHandlers->complexHandler);
+            if (handler.deserializer == nullptr) {
+                return newValue;
             }
-        } else {
-            auto handler = handlers.find(type);
-            if (handler != handlers.end() && handler->second.deserializer) {
-                newValue = handler->second.deserializer(data, jsonType, ok);
+            //Lists of messages and hash maps are allocated once, elements are counted without tokenizing them
+            if (handler.reserve != nullptr && (token.type == QProtobufJsonTokenizer::ArrayToken
+                                               || (token.type == QProtobufJsonTokenizer::ObjectToken
+                                                   && handler.type == QtProtobufPrivate::MapHandler))) {
+                handler.reserve(newValue, QProtobufJsonTokenizer::itemCount(token.data, token.size));
+            }
+            QtProtobuf::QProtobufSelfcheckIterator it(token.data, token.size);
+            ok = true;
+            while (it.size() > 0 && QtProtobufPrivate::deserializationError() == QtProtobuf::NoDeserializationError) {
+                handler.deserializer(qPtr, it, newValue);
             }
+        } else if (typeHandlers->deserializer != nullptr) {
+            newValue = typeHandlers->deserializer(token.bytes(), token.type, ok);
         }
         return newValue;
     }
 
     void deserializeObject(QObject *object, const QProtobufMetaObject &metaObject, const char *data, int size) {
-        microjson::JsonObject obj = microjson::parseJsonObject(data, static_cast<size_t>(size));
-
-        for (auto &property : obj) {
-            auto name = property.first;
-            auto it = std::find_if(metaObject.propertyOrdering.begin(),
-                                   metaObject.propertyOrdering.end(),
-                                   [&name](const auto &val)->bool {
-                return val.second == QString::fromStdString(name);
-            });
-            if (it != metaObject.propertyOrdering.end()) {
-                QMetaProperty metaProperty = metaObject.staticMetaObject.property(it->second);
-                auto userType = metaProperty.userType();
-                QByteArray rawValue = QByteArray::fromStdString(property.second.value);
-                if (rawValue == "null" && property.second.type == microjson::JsonObjectType) {
+        QProtobufJsonTokenizer tokenizer(data, size);
+        if (!tokenizer.enter('{')) {
+            return;
+        }
+
+        const QProtobufFieldPlan &plan = metaObject.fieldPlan();
+        QProtobufJsonTokenizer::Token name;
+        QProtobufJsonTokenizer::Token rawValue;
+        while (tokenizer.nextProperty(name, rawValue)) {
+            const QProtobufFieldPlanEntry *field = plan.findJsonField(name.data, name.size);
+            if (field != nullptr) {
+                const QMetaProperty &metaProperty = field->metaProperty;
+                auto userType = field->userType;
+                if (rawValue.type == QProtobufJsonTokenizer::NullToken) {
                     metaProperty.write(object, QVariant());
                     continue;
                 }
                 bool ok = false;
-                QVariant value = deserializeValue(userType, rawValue, property.second.type, ok);
+                QVariant value = deserializeValue(userType, rawValue, ok);
                 if (ok) {
                     metaProperty.write(object, value);
                 }
             }
         }
     }
+    /*!
+     * \brief Writes json representation of message of \a metaObject type, serialized by QProtobufSerializer
+     *        to \a data, to the end of \a buffer
+     *
+     * \details Values of basic, enumeration and basic map fields are decoded to QVariant and written by the
+     *          same functions as values read from message properties. Payloads of message fields are collected
+     *          as views and transcoded recursively, so message objects are never created.
+     */
+    void transcodeFromBinary(const QProtobufMetaObject &metaObject, const QByteArray &data, QByteArray &buffer) {
+        const auto &fields = metaObject.fieldPlan().fields;
+        std::vector<QVariant> values(fields.size());
+        std::vector<QByteArrayList> payloads(fields.size());
+
+        QProtobufSelfcheckIterator it(data);
+        while (it.size() > 0 && QtProtobufPrivate::deserializationError() == NoDeserializationError) {
+            int fieldNumber = QtProtobufPrivate::NotUsedFieldIndex;
+            WireTypes wireType = UnknownWireType;
+            if (!QProtobufSerializerPrivate::decodeHeader(it, fieldNumber, wireType)) {
+                QtProtobufPrivate::reportDeserializationError(InvalidHeaderError, "Message received doesn't contains valid header byte. "
+                                                                                  "Seems stream is broken");
+                break;
+            }
+
+            auto propertyNumberIt = metaObject.propertyOrdering.find(fieldNumber);
+            if (propertyNumberIt == std::end(metaObject.propertyOrdering)) {
+                QProtobufSerializerPrivate::skipSerializedFieldBytes(it, wireType);
+                QtProtobufPrivate::StatisticsScope::unknownFieldSkipped();
+                continue;
+            }
+            const size_t fieldPosition = static_cast<size_t>(propertyNumberIt - metaObject.propertyOrdering.begin());
+            const auto &field = fields[fieldPosition];
+
+            if (QtProtobufPrivate::findHandler(field.userType).metaObject != nullptr) {
+                payloads[fieldPosition].append(QProtobufSerializerPrivate::deserializeLengthDelimitedView(it));
+                continue;
+            }
+
+            const QProtobufSerializerPrivate::SerializationHandlers *wireHandlers = field.handlers != nullptr ? field.handlers
+                                                                                    : QProtobufSerializerPrivate::findHandlers(field.userType);
+            if (wireHandlers == nullptr
+                    || (wireHandlers->complexHandler != nullptr && wireHandlers->complexHandler->deserializer == nullptr)) {
+                QtProtobufPrivate::reportDeserializationError(NoDeserializerError, "No deserializer registered for type of received field");
+                break;
+            }
+
+            QVariant &value = values[fieldPosition];
+            if (!value.isValid()) {
+                value = QVariant(field.userType, nullptr);
+            }
+            if (wireHandlers->complexHandler == nullptr) {
+                wireHandlers->deserializer(it, value);
+            } else {
+                wireHandlers->complexHandler->deserializer(&wireSerializer, it, value);
+            }
+        }
+
+        buffer.append('{');
+        for (size_t i = 0; i < fields.size(); ++i) {
+            const auto &field = fields[i];
+            if (values[i].isValid()) {
+                buffer.append(protoFieldNames ? field.protoJsonKey : field.jsonKey);
+                serializeValue(values[i], field.metaProperty, buffer);
+                buffer.append(',');
+            } else if (!payloads[i].isEmpty()) {
+                buffer.append(protoFieldNames ? field.protoJsonKey : field.jsonKey);
+                transcodeMessageFromBinary(QtProtobufPrivate::findHandler(field.userType), payloads[i], buffer);
+                buffer.append(',');
+            }
+        }
+        closeList(buffer, '}');
+    }
+
+    /*!
+     * \brief Writes json representation of message, message list or map of messages field received as \a payloads
+     */
+    void transcodeMessageFromBinary(const QtProtobufPrivate::SerializationHandler &handler, const QByteArrayList &payloads,
+                                    QByteArray &buffer) {
+        switch (handler.type) {
+        case QtProtobufPrivate::ObjectHandler:
+            //Repeated occurrences of message field are merged, same as concatenated messages
+            transcodeFromBinary(*handler.metaObject, payloads.count() == 1 ? payloads.first() : payloads.join(), buffer);
+            break;
+        case QtProtobufPrivate::ListHandler:
+            buffer.append('[');
+            for (const auto &payload : payloads) {
+                transcodeFromBinary(*handler.metaObject, payload, buffer);
+                buffer.append(',');
+            }
+            closeList(buffer, ']');
+            break;
+        case QtProtobufPrivate::MapHandler:
+            buffer.append('{');
+            for (const auto &payload : payloads) {
+                QVariant key(handler.mapKeyType, nullptr);
+                QByteArray value;
+                if (!readBinaryMapEntry(payload, key, value)) {
+                    break;
+                }
+                appendString(buffer, key.toString());
+                buffer.append(':');
+                transcodeFromBinary(*handler.metaObject, value, buffer);
+                buffer.append(',');
+            }
+            closeList(buffer, '}');
+            break;
+        }
+    }
+
+    /*!
+     * \brief Reads basic \a key and view to \a value message payload from map entry \a payload
+     */
+    static bool readBinaryMapEntry(const QByteArray &payload, QVariant &key, QByteArray &value) {
+        QProtobufSelfcheckIterator it(payload);
+        while (it.size() > 0 && QtProtobufPrivate::deserializationError() == NoDeserializationError) {
+            int fieldNumber = QtProtobufPrivate::NotUsedFieldIndex;
+            WireTypes wireType = UnknownWireType;
+            if (!QProtobufSerializerPrivate::decodeHeader(it, fieldNumber, wireType)) {
+                QtProtobufPrivate::reportDeserializationError(InvalidHeaderError, "Map entry doesn't contains valid header byte");
+                return false;
+            }
+            if (fieldNumber == 1) {
+                //Only simple types are supported as keys
+                const QProtobufSerializerPrivate::SerializationHandlers *keyHandlers = QProtobufSerializerPrivate::findHandlers(key.userType());
+                if (keyHandlers == nullptr || keyHandlers->complexHandler != nullptr) {
+                    QtProtobufPrivate::reportDeserializationError(NoDeserializerError, "Only basic types are supported as map keys");
+                    return false;
+                }
+                keyHandlers->deserializer(it, key);
+            } else if (fieldNumber == 2 && wireType == LengthDelimited) {
+                value = QProtobufSerializerPrivate::deserializeLengthDelimitedView(it);
+            } else {
+                QProtobufSerializerPrivate::skipSerializedFieldBytes(it, wireType);
+            }
+        }
+        return QtProtobufPrivate::deserializationError() == NoDeserializationError;
+    }
+
+    /*!
+     * \brief Writes message of \a metaObject type, stored as json in \a size bytes at \a data, in
+     *        QProtobufSerializer format to the end of \a buffer
+     *
+     * \details Fields are written in order of json properties. Message fields are transcoded recursively, so
+     *          message objects are never created.
+     */
+    void transcodeToBinary(const QProtobufMetaObject &metaObject, const char *data, int size, QByteArray &buffer) {
+        QProtobufJsonTokenizer tokenizer(data, size);
+        if (!tokenizer.enter('{')) {
+            return;
+        }
+
+        const QProtobufFieldPlan &plan = metaObject.fieldPlan();
+        QProtobufJsonTokenizer::Token name;
+        QProtobufJsonTokenizer::Token rawValue;
+        while (tokenizer.nextProperty(name, rawValue)) {
+            const QProtobufFieldPlanEntry *field = plan.findJsonField(name.data, name.size);
+            if (field == nullptr || rawValue.type == QProtobufJsonTokenizer::NullToken) {
+                continue;
+            }
+
+            const QtProtobufPrivate::SerializationHandler &handler = QtProtobufPrivate::findHandler(field->userType);
+            if (handler.metaObject != nullptr) {
+                transcodeMessageToBinary(handler, field->fieldNumber, rawValue, buffer);
+                continue;
+            }
+
+            bool ok = false;
+            QVariant value = deserializeValue(field->userType, rawValue, ok);
+            if (ok && value.isValid()) {
+                writeBinaryValue(value, field->userType, field->fieldNumber, &field->metaProperty, buffer);
+            }
+        }
+    }
+
+    /*!
+     * \brief Writes message, message list or map of messages field with \a fieldNumber stored as json \a rawValue
+     */
+    void transcodeMessageToBinary(const QtProtobufPrivate::SerializationHandler &handler, int fieldNumber,
+                                  const QProtobufJsonTokenizer::Token &rawValue, QByteArray &buffer) {
+        QByteArray payload;
+        switch (handler.type) {
+        case QtProtobufPrivate::ObjectHandler:
+            transcodeToBinary(*handler.metaObject, rawValue.data, rawValue.size, payload);
+            writeLengthDelimited(fieldNumber, payload, buffer);
+            break;
+        case QtProtobufPrivate::ListHandler: {
+            QProtobufJsonTokenizer tokenizer(rawValue.data, rawValue.size);
+            tokenizer.enter('[');
+            QProtobufJsonTokenizer::Token element;
+            while (tokenizer.nextElement(element)) {
+                payload.resize(0);
+                transcodeToBinary(*handler.metaObject, element.data, element.size, payload);
+                writeLengthDelimited(fieldNumber, payload, buffer);
+            }
+            break;
+        }
+        case QtProtobufPrivate::MapHandler: {
+            QProtobufJsonTokenizer tokenizer(rawValue.data, rawValue.size);
+            tokenizer.enter('{');
+            QProtobufJsonTokenizer::Token key;
+            QProtobufJsonTokenizer::Token value;
+            QByteArray valuePayload;
+            while (tokenizer.nextProperty(key, value)) {
+                bool ok = false;
+                key.type = QProtobufJsonTokenizer::StringToken;
+                QVariant keyValue = deserializeValue(handler.mapKeyType, key, ok);
+                if (!ok) {
+                    continue;
+                }
+                payload.resize(0);
+                writeBinaryValue(keyValue, handler.mapKeyType, 1, nullptr, payload);
+                valuePayload.resize(0);
+                if (value.type != QProtobufJsonTokenizer::NullToken) {
+                    transcodeToBinary(*handler.metaObject, value.data, value.size, valuePayload);
+                }
+                writeLengthDelimited(2, valuePayload, payload);
+                writeLengthDelimited(fieldNumber, payload, buffer);
+            }
+            break;
+        }
+        }
+    }
+
+    /*!
+     * \brief Writes \a value of field with \a fieldNumber and \a userType type in QProtobufSerializer format
+     * \details Values of complex types are written by their registered serializers, when \a metaProperty is set
+     */
+    void writeBinaryValue(QVariant &value, int userType, int fieldNumber, const QProtobufMetaProperty *metaProperty,
+                          QByteArray &buffer) {
+        //Json deserializers return underlying types of protobuf integers
+        if (value.userType() != userType) {
+            value.convert(userType);
+        }
+        const QProtobufSerializerPrivate::SerializationHandlers *wireHandlers = QProtobufSerializerPrivate::findHandlers(userType);
+        if (wireHandlers == nullptr) {
+            qProtoCritical() << "No serializer registered for type" << QMetaType::typeName(userType) << "field is skipped";
+            return;
+        }
+
+        if (wireHandlers->complexHandler == nullptr) {
+            int fieldIndex = fieldNumber;
+            //Header is written in advance and dropped if serializer decides that field shouldn't be sent
+            const int headerPosition = buffer.size();
+            if (wireHandlers->type != UnknownWireType) {
+                QProtobufSerializerPrivate::encodeHeader(fieldIndex, wireHandlers->type, buffer);
+            }
+            wireHandlers->serializer(value, fieldIndex, buffer);
+            if (fieldIndex == QtProtobufPrivate::NotUsedFieldIndex && wireHandlers->type != UnknownWireType) {
+                buffer.resize(headerPosition);
+            }
+        } else if (wireHandlers->complexHandler->serializer != nullptr && metaProperty != nullptr) {
+            wireHandlers->complexHandler->serializer(&wireSerializer, value, *metaProperty, buffer);
+        }
+    }
+
+    static void writeLengthDelimited(int fieldNumber, const QByteArray &payload, QByteArray &buffer) {
+        QProtobufSerializerPrivate::encodeHeader(fieldNumber, LengthDelimited, buffer);
+        QProtobufSerializerPrivate::serializeLengthDelimited(payload, buffer);
+    }
+
 private:
-    static SerializerRegistry handlers;
+    static SerializerRegistry &handlers() {
+        static SerializerRegistry _handlers;
+        return _handlers;
+    }
+
+    /*!
+     * \brief Looks up handlers of \a userType in dispatch table
+     * \details Handlers of complex types are resolved from QtProtobuf global serializers registry at first use
+     */
+    static const SerializationHandlers *findHandlers(int userType) {
+        const SerializationHandlers *typeHandlers = handlers().find(userType);
+        if (typeHandlers != nullptr) {
+            return typeHandlers;
+        }
+
+        const auto &complexHandler = QtProtobufPrivate::findHandler(userType);
+        if (complexHandler.serializer == nullptr && complexHandler.deserializer == nullptr) {
+            //Type is not registered yet, lookup result is not cached
+            return nullptr;
+        }
+        return handlers().insert(userType, {nullptr, nullptr, &complexHandler});
+    }
+
     QProtobufJsonSerializer *qPtr;
+    //Serializer of binary format used by transcoding, its complex handlers call virtual methods of serializer
+    QProtobufSerializer wireSerializer;
+    bool omitDefaultValues = false;
+    bool protoFieldNames = false;
+    bool enumsAsIntegers = false;
 };
 
-QProtobufJsonSerializerPrivate::SerializerRegistry QProtobufJsonSerializerPrivate::handlers = {};
-
 }
 
 QProtobufJsonSerializer::QProtobufJsonSerializer() : dPtr(new QProtobufJsonSerializerPrivate(this))
@@ -373,22 +1303,105 @@ QProtobufJsonSerializer::QProtobufJsonSerializer() : dPtr(new QProtobufJsonSeria
 
 QProtobufJsonSerializer::~QProtobufJsonSerializer() = default;
 
+void QProtobufJsonSerializer::setOmitDefaultValuesEnabled(bool enabled)
+{
+    dPtr->omitDefaultValues = enabled;
+}
+
+bool QProtobufJsonSerializer::isOmitDefaultValuesEnabled() const
+{
+    return dPtr->omitDefaultValues;
+}
+
+void QProtobufJsonSerializer::setProtoFieldNamesEnabled(bool enabled)
+{
+    dPtr->protoFieldNames = enabled;
+}
+
+bool QProtobufJsonSerializer::isProtoFieldNamesEnabled() const
+{
+    return dPtr->protoFieldNames;
+}
+
+void QProtobufJsonSerializer::setEnumsAsIntegersEnabled(bool enabled)
+{
+    dPtr->enumsAsIntegers = enabled;
+}
+
+bool QProtobufJsonSerializer::isEnumsAsIntegersEnabled() const
+{
+    return dPtr->enumsAsIntegers;
+}
+
 
 QByteArray QProtobufJsonSerializer::serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject) const
 {
     return dPtr->serializeObject(object, metaObject);
 }
 
+bool QProtobufJsonSerializer::serializeMessageTo(const QObject *object, const QProtobufMetaObject &metaObject, QIODevice *device) const
+{
+    QProtobufBufferAllocator *allocator = QProtobufBufferAllocator::current();
+    QByteArray buffer = allocator->allocate(StreamChunkSize);
+    StreamSink sink{device, &buffer, 0, false};
+    {
+        StreamSinkScope sinkScope(&sink);
+        dPtr->serializeObject(object, metaObject, buffer);
+    }
+
+    if (!sink.failed && !buffer.isEmpty() && device->write(buffer) != buffer.size()) {
+        sink.failed = true;
+    }
+    allocator->release(std::move(buffer));
+    return !sink.failed;
+}
+
+QByteArray QProtobufJsonSerializer::serializeMessageFields(const QObject *object, const QProtobufMetaObject &metaObject, const quint32 *fields) const
+{
+    QByteArray result;
+    dPtr->serializeFields(object, metaObject, fields, result);
+    return result;
+}
+
 void QProtobufJsonSerializer::deserializeMessage(QObject *object, const QProtobufMetaObject &metaObject, const QByteArray &data) const
 {
     dPtr->deserializeObject(object, metaObject, data.data(), data.size());
 }
 
+QByteArray QProtobufJsonSerializer::transcodeFromBinary(const QProtobufMetaObject &metaObject, const QByteArray &data) const
+{
+    QByteArray result;
+    dPtr->transcodeFromBinary(metaObject, data, result);
+    return result;
+}
+
+QByteArray QProtobufJsonSerializer::transcodeToBinary(const QProtobufMetaObject &metaObject, const QByteArray &json) const
+{
+    QByteArray result;
+    dPtr->transcodeToBinary(metaObject, json.constData(), json.size(), result);
+    return result;
+}
+
+void QProtobufJsonSerializer::serializeMessageAppend(const QObject *object, const QProtobufMetaObject &metaObject, QByteArray &buffer) const
+{
+    dPtr->serializeObject(object, metaObject, buffer);
+}
+
+void QProtobufJsonSerializer::deserializeMessageData(QObject *object, const QProtobufMetaObject &metaObject, const char *data, int size) const
+{
+    dPtr->deserializeObject(object, metaObject, data, size);
+}
+
 QByteArray QProtobufJsonSerializer::serializeObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &/*metaProperty*/) const
 {
     return dPtr->serializeObject(object, metaObject);
 }
 
+void QProtobufJsonSerializer::serializeObjectTo(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &/*metaProperty*/, QByteArray &buffer) const
+{
+    dPtr->serializeObject(object, metaObject, buffer);
+}
+
 void QProtobufJsonSerializer::deserializeObject(QObject *object, const QProtobufMetaObject &metaObject, QProtobufSelfcheckIterator &it) const
 {
     dPtr->deserializeObject(object, metaObject, it.data(), it.size());
@@ -402,12 +1415,22 @@ QByteArray QProtobufJsonSerializer::serializeListBegin(const QProtobufMetaProper
 
 QByteArray QProtobufJsonSerializer::serializeListObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &/*metaProperty*/) const
 {
-    return dPtr->serializeObject(object, metaObject) + ",";
+    QByteArray buffer;
+    dPtr->serializeObject(object, metaObject, buffer);
+    buffer.append(',');
+    return buffer;
+}
+
+void QProtobufJsonSerializer::serializeListObjectTo(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &/*metaProperty*/, QByteArray &buffer) const
+{
+    flushStreamChunk(buffer);
+    dPtr->serializeObject(object, metaObject, buffer);
+    buffer.append(',');
 }
 
 QByteArray QProtobufJsonSerializer::serializeListEnd(QByteArray &buffer, const QProtobufMetaProperty &/*metaProperty*/) const
 {
-    if (buffer[buffer.size() - 1] == ',') {
+    if (buffer.endsWith(',')) {
         buffer.resize(buffer.size() - 1);
     }
     return {"]"};
@@ -415,20 +1438,17 @@ QByteArray QProtobufJsonSerializer::serializeListEnd(QByteArray &buffer, const Q
 
 bool QProtobufJsonSerializer::deserializeListObject(QObject *object, const QProtobufMetaObject &metaObject, QProtobufSelfcheckIterator &it) const
 {
-    if (*it == '[') {
-        qDebug() << "Begin of list";
-        ++it;
-    }
+    //Iterator points to beginning of list at first call and to the end of previous element at next calls
+    QProtobufJsonTokenizer tokenizer(it.data(), it.size());
+    tokenizer.enter('[');
 
-    size_t i = 0;
-    microjson::JsonProperty property;
-    if (microjson::extractValue(it.data(), static_cast<size_t>(it.size()), i, ']', property)) {
-        dPtr->deserializeObject(object, metaObject, it.data() + property.valueBegin, property.valueSize());
-    } else {
+    QProtobufJsonTokenizer::Token element;
+    if (!tokenizer.nextElement(element)) {
         it += it.size();
         return false;
     }
-    it += i;
+    dPtr->deserializeObject(object, metaObject, element.data, element.size);
+    it += tokenizer.position();
     return true;
 }
 
@@ -438,12 +1458,26 @@ QByteArray QProtobufJsonSerializer::serializeMapBegin(const QProtobufMetaPropert
 }
 QByteArray QProtobufJsonSerializer::serializeMapPair(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty) const
 {
-    return QByteArray("\"") + key.toString().toUtf8() + "\":" + dPtr->serializeValue(value, metaProperty) + ",";
+    QByteArray buffer;
+    appendString(buffer, key.toString());
+    buffer.append(':');
+    dPtr->serializeValue(value, metaProperty, buffer);
+    buffer.append(',');
+    return buffer;
+}
+
+void QProtobufJsonSerializer::serializeMapPairTo(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty, QByteArray &buffer) const
+{
+    flushStreamChunk(buffer);
+    appendString(buffer, key.toString());
+    buffer.append(':');
+    dPtr->serializeValue(value, metaProperty, buffer);
+    buffer.append(',');
 }
 
 QByteArray QProtobufJsonSerializer::serializeMapEnd(QByteArray &buffer, const QProtobufMetaProperty &/*metaProperty*/) const
 {
-    if (buffer[buffer.size() - 1] == ',') {
+    if (buffer.endsWith(',')) {
         buffer.resize(buffer.size() - 1);
     }
     return {"}"};
@@ -451,42 +1485,52 @@ QByteArray QProtobufJsonSerializer::serializeMapEnd(QByteArray &buffer, const QP
 
 bool QProtobufJsonSerializer::deserializeMapPair(QVariant &key, QVariant &value, QProtobufSelfcheckIterator &it) const
 {
-    if (*it == '{') {
-        qDebug() << "Begin of map";
-        ++it;
-    }
+    //Iterator points to beginning of map at first call and to the end of previous pair at next calls
+    QProtobufJsonTokenizer tokenizer(it.data(), it.size());
+    tokenizer.enter('{');
 
-    size_t i = 0;
-    microjson::JsonProperty property;
-    if (microjson::extractProperty(it.data(), static_cast<size_t>(it.size()), i, '}', property)) {
-        bool ok = false;
-        key = dPtr->deserializeValue(key.userType(), QByteArray(it.data() + property.nameBegin, property.nameSize()), microjson::JsonStringType, ok);
-        if (!ok) {
-            key = QVariant();
-        }
-        value = dPtr->deserializeValue(value.userType(), QByteArray(it.data() + property.valueBegin, property.valueSize()), property.type, ok);
-        if (!ok) {
-            value = QVariant();
-        }
-    } else {
+    QProtobufJsonTokenizer::Token name;
+    QProtobufJsonTokenizer::Token rawValue;
+    if (!tokenizer.nextProperty(name, rawValue)) {
         it += it.size();
         return false;
     }
-    it += i;
+
+    bool ok = false;
+    name.type = QProtobufJsonTokenizer::StringToken;
+    key = dPtr->deserializeValue(key.userType(), name, ok);
+    if (!ok) {
+        key = QVariant();
+    }
+    value = dPtr->deserializeValue(value.userType(), rawValue, ok);
+    if (!ok) {
+        value = QVariant();
+    }
+    it += tokenizer.position();
     return true;
 }
 
 QByteArray QProtobufJsonSerializer::serializeEnum(int64 value, const QMetaEnum &metaEnum, const QtProtobuf::QProtobufMetaProperty &/*metaProperty*/) const
 {
-    return QByteArray("\"") + metaEnum.key(static_cast<int>(value)) + "\"";
+    if (dPtr->enumsAsIntegers) {
+        QByteArray result;
+        appendInteger<int64_t>(result, value);
+        return result;
+    }
+    return QByteArray("\"") + enumKey(metaEnum, value) + "\"";
 }
 
 QByteArray QProtobufJsonSerializer::serializeEnumList(const QList<int64> &values, const QMetaEnum &metaEnum, const QtProtobuf::QProtobufMetaProperty &/*metaProperty*/) const
 {
     QByteArray result = "[";
     for (auto value : values) {
+        if (dPtr->enumsAsIntegers) {
+            appendInteger<int64_t>(result, value);
+            result.append(',');
+            continue;
+        }
         result.append("\"");
-        result.append(metaEnum.key(static_cast<int>(value)));
+        result.append(enumKey(metaEnum, value));
         result.append("\",");
     }
     if (values.size() > 0) {
@@ -498,19 +1542,22 @@ QByteArray QProtobufJsonSerializer::serializeEnumList(const QList<int64> &values
 
 void QProtobufJsonSerializer::deserializeEnum(int64 &value, const QMetaEnum &metaEnum, QProtobufSelfcheckIterator &it) const
 {
-    value = metaEnum.keyToValue(it.data());
+    value = enumValue(metaEnum, it.data(), it.size());
     it += it.size();
 }
 
 void QProtobufJsonSerializer::deserializeEnumList(QList<int64> &value, const QMetaEnum &metaEnum, QProtobufSelfcheckIterator &it) const
 {
-    auto arrayValues = microjson::parseJsonArray(it.data(), static_cast<size_t>(it.size()));
+    value.reserve(value.size() + QProtobufJsonTokenizer::itemCount(it.data(), it.size()));
+    QProtobufJsonTokenizer tokenizer(it.data(), it.size());
+    tokenizer.enter('[');
 
-    for (auto &arrayValue : arrayValues) {
-        if (arrayValue.value == "null") {
+    QProtobufJsonTokenizer::Token element;
+    while (tokenizer.nextElement(element)) {
+        if (element.type == QProtobufJsonTokenizer::NullToken) {
             value.append(metaEnum.value(0));
         } else {
-             value.append(metaEnum.keyToValue(arrayValue.value.c_str()));
+            value.append(enumValue(metaEnum, element.data, element.size));
         }
     }
 
@@ -32,6 +32,7 @@
 
 namespace QtProtobuf {
 class QProtobufJsonSerializerPrivate;
+class QProtobufJsonLinesStream;
 /*!
 *  \ingroup QtProtobuf
  * \brief The QProtobufJsonSerializer class
@@ -42,21 +43,86 @@ public:
     QProtobufJsonSerializer();
     ~QProtobufJsonSerializer();
 
+    /*!
+     * \brief Enables omission of fields that have default values
+     *
+     * \details When enabled, zero numbers, false booleans, enumerations with value 0, empty strings and bytes,
+     *          empty repeated fields, maps and nested messages without any written fields are not written.
+     *          Deserialized message is the same in both cases. Disabled by default.
+     */
+    void setOmitDefaultValuesEnabled(bool enabled);
+    bool isOmitDefaultValuesEnabled() const;
+
+    /*!
+     * \brief Enables writing of original field names from .proto files instead of lowerCamelCase json names
+     *
+     * \details Both names are accepted by deserializer regardless of this option. Disabled by default.
+     */
+    void setProtoFieldNamesEnabled(bool enabled);
+    bool isProtoFieldNamesEnabled() const;
+
+    /*!
+     * \brief Enables writing of enumeration values as integers instead of names
+     *
+     * \details Both forms are accepted by deserializer regardless of this option. Disabled by default.
+     */
+    void setEnumsAsIntegersEnabled(bool enabled);
+    bool isEnumsAsIntegersEnabled() const;
+
+    /*!
+     * \brief Converts message of type T serialized by QProtobufSerializer to json
+     *
+     * \details Binary data is decoded by fields of T and written to json directly, message objects are not
+     *          created. Only fields that are present in \a data are written, options of this serializer are
+     *          applied to result. Errors are reported the same way as by QProtobufSerializer deserialization.
+     *
+     * \param[in] data Bytes with message serialized by QProtobufSerializer
+     * \result json representation of message
+     */
+    template<typename T>
+    QByteArray transcodeFromBinary(const QByteArray &data) const {
+        qProtoDebug() << T::staticMetaObject.className() << "transcodeFromBinary";
+#ifdef QT_PROTOBUF_NO_EXCEPTIONS
+        QtProtobufPrivate::DeserializationErrorScope scope;
+#endif
+        return transcodeFromBinary(T::protobufMetaObject, data);
+    }
+
+    /*!
+     * \brief Converts json representation of message of type T to QProtobufSerializer format
+     *
+     * \details Json is decoded by fields of T and written to binary format directly, message objects are not
+     *          created. Fields are written in order of json properties.
+     *
+     * \param[in] json Json representation of message
+     * \result message bytes in QProtobufSerializer format
+     */
+    template<typename T>
+    QByteArray transcodeToBinary(const QByteArray &json) const {
+        qProtoDebug() << T::staticMetaObject.className() << "transcodeToBinary";
+        return transcodeToBinary(T::protobufMetaObject, json);
+    }
+
 protected:
     QByteArray serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject) const  override;
+    bool serializeMessageTo(const QObject *object, const QProtobufMetaObject &metaObject, QIODevice *device) const override;
+    QByteArray serializeMessageFields(const QObject *object, const QProtobufMetaObject &metaObject, const quint32 *fields) const override;
     void deserializeMessage(QObject *object, const QProtobufMetaObject &metaObject, const QByteArray &data) const override;
 
     QByteArray serializeObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty) const override;
+    void serializeObjectTo(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty, QByteArray &buffer) const override;
     void deserializeObject(QObject *object, const QProtobufMetaObject &metaObject, QProtobufSelfcheckIterator &it) const override;
 
     QByteArray serializeListBegin(const QProtobufMetaProperty &metaProperty) const override;
     QByteArray serializeListObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty) const override;
+    void serializeListObjectTo(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty, QByteArray &buffer) const override;
     QByteArray serializeListEnd(QByteArray &buffer, const QProtobufMetaProperty &metaProperty) const override;
 
     bool deserializeListObject(QObject *object, const QProtobufMetaObject &metaObject, QProtobufSelfcheckIterator &it) const override;
 
     QByteArray serializeMapBegin(const QProtobufMetaProperty &metaProperty) const override;
     QByteArray serializeMapPair(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty) const override;
+    void serializeMapPairTo(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty, QByteArray &buffer) const override;
     QByteArray serializeMapEnd(QByteArray &buffer, const QProtobufMetaProperty &metaProperty) const override;
 
     bool deserializeMapPair(QVariant &key, QVariant &value, QProtobufSelfcheckIterator &it) const override;
@@ -67,6 +133,20 @@ protected:
     void deserializeEnum(int64 &value, const QMetaEnum &metaEnum, QProtobufSelfcheckIterator &it) const override;
     void deserializeEnumList(QList<int64> &value, const QMetaEnum &metaEnum, QProtobufSelfcheckIterator &it) const override;
 private:
+    friend class QProtobufJsonLinesStream;
+
+    QByteArray transcodeFromBinary(const QProtobufMetaObject &metaObject, const QByteArray &data) const;
+    QByteArray transcodeToBinary(const QProtobufMetaObject &metaObject, const QByteArray &json) const;
+
+    /*!
+     * \brief Serializes \a object and appends result to the end of \a buffer
+     */
+    void serializeMessageAppend(const QObject *object, const QProtobufMetaObject &metaObject, QByteArray &buffer) const;
+    /*!
+     * \brief Deserializes \a object from \a size bytes of JSON stored at \a data, \a data is not copied
+     */
+    void deserializeMessageData(QObject *object, const QProtobufMetaObject &metaObject, const char *data, int size) const;
+
     std::unique_ptr<QProtobufJsonSerializerPrivate> dPtr;
 };
 
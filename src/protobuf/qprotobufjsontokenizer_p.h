@@ -0,0 +1,336 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufJsonTokenizer
+
+#include <QByteArray>
+
+namespace QtProtobufPrivate {
+
+/*!
+ * \private
+ * \brief The QProtobufJsonTokenizer class is single pass pull tokenizer of json text
+ *
+ * \details Tokenizer doesn't copy or unescape anything: every token is view to original buffer, that
+ * must outlive tokenizer and tokens. Strings are returned without enclosing quotes, objects and arrays
+ * are returned with enclosing brackets, so they might be passed to next tokenizer as is. Nested values
+ * are only scanned for their bounds, no tokens are produced for them until they are tokenized
+ * explicitly.
+ */
+class QProtobufJsonTokenizer
+{
+public:
+    enum TokenType {
+        InvalidToken,
+        NullToken,
+        BoolToken,
+        NumberToken,
+        StringToken,
+        ObjectToken,
+        ArrayToken
+    };
+
+    struct Token {
+        TokenType type = InvalidToken;
+        const char *data = nullptr;
+        int size = 0;
+
+        /*!
+         * \brief Returns view of token, valid while original buffer is alive
+         */
+        QByteArray bytes() const { return QByteArray::fromRawData(data, size); }
+    };
+
+    QProtobufJsonTokenizer(const char *data, int size) : m_data(data)
+      , m_size(size)
+      , m_position(0)
+      , m_error(false) {}
+
+    /*!
+     * \brief Consumes \a opening bracket if it is next non-whitespace character
+     */
+    bool enter(char opening) {
+        skipWhitespace();
+        if (m_position < m_size && m_data[m_position] == opening) {
+            ++m_position;
+            return true;
+        }
+        return false;
+    }
+
+    /*!
+     * \brief Reads next property of object into \a name and \a value
+     * \return false when closing bracket of object is consumed, end of data is reached or data is malformed
+     */
+    bool nextProperty(Token &name, Token &value) {
+        if (!nextItem('}')) {
+            return false;
+        }
+
+        if (m_data[m_position] != '"' || !readString(name)) {
+            return fail();
+        }
+
+        skipWhitespace();
+        if (m_position >= m_size || m_data[m_position] != ':') {
+            return fail();
+        }
+        ++m_position;
+
+        skipWhitespace();
+        return readValue(value) || fail();
+    }
+
+    /*!
+     * \brief Reads next element of array into \a value
+     * \return false when closing bracket of array is consumed, end of data is reached or data is malformed
+     */
+    bool nextElement(Token &value) {
+        if (!nextItem(']')) {
+            return false;
+        }
+        return readValue(value) || fail();
+    }
+
+    /*!
+     * \brief Returns offset of first not consumed byte
+     */
+    int position() const { return m_position; }
+
+    bool hasError() const { return m_error; }
+
+    /*!
+     * \brief Returns number of elements of array or properties of object, stored with enclosing brackets in
+     *        \a size bytes at \a data
+     *
+     * \details Separators of top level are counted, nested values are only scanned for their bounds, so
+     *          containers may be allocated once before the items are tokenized.
+     */
+    static int itemCount(const char *data, int size) {
+        int separators = 0;
+        int depth = 0;
+        bool hasItems = false;
+        for (int position = 0; position < size; ++position) {
+            switch (data[position]) {
+            case '"':
+                position = stringEnd(data, size, position);
+                if (position < 0) {
+                    return separators;
+                }
+                --position;
+                hasItems = true;
+                break;
+            case '{':
+            case '[':
+                hasItems |= depth > 0;
+                ++depth;
+                break;
+            case '}':
+            case ']':
+                --depth;
+                break;
+            case ',':
+                separators += depth == 1 ? 1 : 0;
+                break;
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+                break;
+            default:
+                hasItems = true;
+                break;
+            }
+        }
+        return hasItems ? separators + 1 : 0;
+    }
+
+private:
+    bool fail() {
+        m_error = true;
+        m_position = m_size;
+        return false;
+    }
+
+    void skipWhitespace() {
+        while (m_position < m_size) {
+            switch (m_data[m_position]) {
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+                ++m_position;
+                break;
+            default:
+                return;
+            }
+        }
+    }
+
+    //Skips separator and positions tokenizer at the start of next item of object or array
+    bool nextItem(char closing) {
+        skipWhitespace();
+        if (m_position < m_size && m_data[m_position] == ',') {
+            ++m_position;
+            skipWhitespace();
+        }
+
+        if (m_position >= m_size || m_error) {
+            return false;
+        }
+
+        if (m_data[m_position] == closing) {
+            ++m_position;
+            return false;
+        }
+        return true;
+    }
+
+    //Returns position after closing quote of string that starts at position, or -1 if string is not terminated
+    static int stringEnd(const char *data, int size, int position) {
+        for (++position; position < size; ++position) {
+            if (data[position] == '\\') {
+                ++position;
+            } else if (data[position] == '"') {
+                return position + 1;
+            }
+        }
+        return -1;
+    }
+
+    int stringEnd(int position) const {
+        return stringEnd(m_data, m_size, position);
+    }
+
+    bool readString(Token &token) {
+        int end = stringEnd(m_position);
+        if (end < 0) {
+            return false;
+        }
+        token.type = StringToken;
+        token.data = m_data + m_position + 1;
+        token.size = end - m_position - 2;
+        m_position = end;
+        return true;
+    }
+
+    bool readNested(Token &token, TokenType type) {
+        int depth = 0;
+        int position = m_position;
+        while (position < m_size) {
+            switch (m_data[position]) {
+            case '"':
+                position = stringEnd(position);
+                if (position < 0) {
+                    return false;
+                }
+                continue;
+            case '{':
+            case '[':
+                ++depth;
+                break;
+            case '}':
+            case ']':
+                --depth;
+                break;
+            default:
+                break;
+            }
+            ++position;
+            if (depth == 0) {
+                token.type = type;
+                token.data = m_data + m_position;
+                token.size = position - m_position;
+                m_position = position;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool readLiteral(Token &token, TokenType type, const char *literal, int size) {
+        if (m_size - m_position < size || qstrncmp(m_data + m_position, literal, static_cast<uint>(size)) != 0) {
+            return false;
+        }
+        token.type = type;
+        token.data = m_data + m_position;
+        token.size = size;
+        m_position += size;
+        return true;
+    }
+
+    bool readNumber(Token &token) {
+        int position = m_position;
+        while (position < m_size) {
+            const char character = m_data[position];
+            if ((character < '0' || character > '9') && character != '-' && character != '+'
+                    && character != '.' && character != 'e' && character != 'E') {
+                break;
+            }
+            ++position;
+        }
+        token.type = NumberToken;
+        token.data = m_data + m_position;
+        token.size = position - m_position;
+        m_position = position;
+        return true;
+    }
+
+    bool readValue(Token &token) {
+        if (m_position >= m_size) {
+            return false;
+        }
+
+        switch (m_data[m_position]) {
+        case '"':
+            return readString(token);
+        case '{':
+            return readNested(token, ObjectToken);
+        case '[':
+            return readNested(token, ArrayToken);
+        case 't':
+            return readLiteral(token, BoolToken, "true", 4);
+        case 'f':
+            return readLiteral(token, BoolToken, "false", 5);
+        case 'n':
+            return readLiteral(token, NullToken, "null", 4);
+        default:
+            break;
+        }
+
+        const char character = m_data[m_position];
+        if (character == '-' || (character >= '0' && character <= '9')) {
+            return readNumber(token);
+        }
+        return false;
+    }
+
+    const char *m_data;
+    int m_size;
+    int m_position;
+    bool m_error;
+};
+
+}
@@ -26,7 +26,10 @@
 #pragma once //QProtobufLazyMessagePointer
 
 #include "qtprotobufglobal.h"
+#include "qprotobufspaceused.h"
 #include <QObject>
+#include <QByteArray>
+#include <QSignalBlocker>
 #if defined(QT_QML_LIB) // TODO: Check how detect this in Qt6
 #  include <QQmlEngine>
 #endif
@@ -34,6 +37,30 @@
 #include <memory>
 #include <type_traits>
 
+namespace QtProtobuf {
+class QProtobufMetaObject;
+}
+
+namespace QtProtobufPrivate {
+/*!
+ * \private
+ * \brief Parses \a payload stored by lazy message pointer to \a object
+ *
+ * \details Errors don't throw, malformed payload leaves fields that were parsed before error.
+ */
+extern Q_PROTOBUF_EXPORT void deserializeLazyMessage(QObject *object, const QtProtobuf::QProtobufMetaObject &metaObject,
+                                                     const QByteArray &payload);
+}
+
+/*!
+ * \private
+ * \brief The QProtobufLazyMessagePointer class holds message field value
+ *
+ * \details Message object is allocated at first access. If serialized payload is set by deserializer in lazy
+ *          messages mode, the payload is parsed at first access as well. Lazy allocation and parsing are not
+ *          thread safe. Read-only access using constRef() and comparison don't allocate message object,
+ *          shared default instance of \a T is used if message is not set.
+ */
 template <typename T>
 class QProtobufLazyMessagePointer {//TODO: final?
 public:
@@ -45,31 +72,42 @@ public:
     }
 
     typename std::add_lvalue_reference<T>::type operator *() const {
-        if (m_ptr == nullptr) {
-            m_ptr.reset(new T);
-        }
-        return *m_ptr;
+        return *materialize();
     }
 
-    T *operator->() const noexcept {
-        if (m_ptr == nullptr) {
-            m_ptr.reset(new T);
-        }
-        m_ptr.operator->();
+    T *operator->() const {
+        return materialize();
     }
 
     T *get() const {
-        if (m_ptr == nullptr) {
-            m_ptr.reset(new T);
+        return materialize();
+    }
+
+    /*!
+     * \brief Provides message for read-only access
+     *
+     * \details If message is not set, shared default instance of \a T is returned and no object is allocated.
+     *          Returned reference is not updated when message is set afterwards.
+     */
+    const T &constRef() const {
+        if (m_ptr == nullptr && m_payload.isNull()) {
+            return defaultInstance();
         }
-        return m_ptr.get();
+        return *materialize();
+    }
+
+    /*!
+     * \brief Shared immutable instance of \a T with default field values
+     */
+    static const T &defaultInstance() {
+        static const T instance;
+        return instance;
     }
 
     bool operator ==(const QProtobufLazyMessagePointer &other) const {
-        return (m_ptr == nullptr && other.m_ptr == nullptr)
-                || (other.m_ptr == nullptr && *m_ptr == T{})
-                || (m_ptr == nullptr && *other.m_ptr == T{})
-                || (m_ptr != nullptr && other.m_ptr != nullptr && *m_ptr == *other.m_ptr);
+        const T &value = constRef();
+        const T &otherValue = other.constRef();
+        return &value == &otherValue || value == otherValue;
     }
 
     bool operator !=(const QProtobufLazyMessagePointer &other) const {
@@ -85,18 +123,101 @@ public:
         });
 
         m_ptr.reset(p);
+        m_payload = QByteArray();
     }
 
-    QProtobufLazyMessagePointer(QProtobufLazyMessagePointer &&other) : m_ptr(std::move(other.m_ptr)) {}
+    /*!
+     * \brief Replaces value with message serialized in \a payload
+     *
+     * \details \a payload is parsed at first access to message
+     */
+    void setLazyPayload(const QByteArray &payload) {
+        checkAndRelease();
+        QObject::disconnect(m_destroyed);
+        m_ptr.reset();
+        m_payload = payload;
+    }
+
+    /*!
+     * \brief Copies unparsed payload of \a other without parsing it
+     *
+     * \return true if \a other holds unparsed payload and it was copied, false otherwise
+     */
+    bool copyLazyPayload(const QProtobufLazyMessagePointer &other) {
+        if (other.m_ptr != nullptr || other.m_payload.isNull()) {
+            return false;
+        }
+        setLazyPayload(other.m_payload);
+        return true;
+    }
+
+    /*!
+     * \brief Initializes empty pointer with copy of message held by \a other
+     *
+     * \details Unparsed payload is shared with \a other, materialized message is copy constructed. Message
+     *          is not allocated if \a other holds no message.
+     */
+    void copyMessage(const QProtobufLazyMessagePointer &other) {
+        if (copyLazyPayload(other) || other.m_ptr == nullptr) {
+            return;
+        }
+        reset(new T(*other.m_ptr));
+    }
+
+    /*!
+     * \brief Resets message to default values
+     *
+     * \details Unparsed payload is dropped. Materialized message object is kept and cleared, so it is reused
+     *          by next deserialization.
+     */
+    void clearMessage() {
+        m_payload = QByteArray();
+        if (m_ptr != nullptr) {
+            m_ptr->clear();
+        }
+    }
+
+    QProtobufLazyMessagePointer(QProtobufLazyMessagePointer &&other) : m_ptr(std::move(other.m_ptr))
+      , m_payload(std::move(other.m_payload)) {}
     QProtobufLazyMessagePointer &operator =(QProtobufLazyMessagePointer &&other) {
         m_ptr = std::move(other.m_ptr);
+        m_payload = std::move(other.m_payload);
+        return *this;
+    }
+
+    /*!
+     * \brief Returns heap bytes owned by pointer: unparsed payload and message object with memory it owns
+     *
+     * \details Message is neither allocated nor parsed by the call
+     */
+    size_t spaceUsed() const {
+        return QtProtobuf::spaceUsedOf(m_payload) + (m_ptr != nullptr ? m_ptr->spaceUsed() : 0);
     }
 
     explicit operator bool() const noexcept {
-        return m_ptr.operator bool();
+        return m_ptr.operator bool() || !m_payload.isNull();
     }
 
 private:
+    T *materialize() const {
+        if (m_ptr == nullptr) {
+            m_ptr.reset(new T);
+            parsePayload();
+        }
+        return m_ptr.get();
+    }
+
+    void parsePayload() const {
+        if (m_payload.isNull()) {
+            return;
+        }
+        //Payload is dropped before parsing, so nested access during parsing doesn't start it again
+        QByteArray payload;
+        payload.swap(m_payload);
+        const QSignalBlocker blocker(m_ptr.get());
+        QtProtobufPrivate::deserializeLazyMessage(m_ptr.get(), T::protobufMetaObject, payload);
+    }
+
     void checkAndRelease() const {
 #if defined(QT_QML_LIB)
         bool qmlCheck = QQmlEngine::objectOwnership(m_ptr.get()) == QQmlEngine::JavaScriptOwnership;
@@ -113,4 +234,5 @@ private:
     QProtobufLazyMessagePointer &operator =(const QProtobufLazyMessagePointer&) = delete;
     mutable std::unique_ptr<T> m_ptr;
     mutable QMetaObject::Connection m_destroyed;
+    mutable QByteArray m_payload;
 };
@@ -0,0 +1,78 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qprotobufmappedfile.h"
+
+#include <limits>
+
+using namespace QtProtobuf;
+
+QProtobufMappedFile::QProtobufMappedFile(const QString &fileName) : m_file(fileName)
+  , m_data(nullptr)
+  , m_size(0)
+  , m_valid(false)
+{
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_errorString = m_file.errorString();
+        return;
+    }
+
+    const qint64 fileSize = m_file.size();
+    if (fileSize > std::numeric_limits<int>::max()) {
+        m_errorString = QString("File %1 is too large to be mapped").arg(fileName);
+        m_file.close();
+        return;
+    }
+
+    if (fileSize == 0) {
+        //Empty files can't be mapped, but empty message is valid
+        m_valid = true;
+        return;
+    }
+
+    m_data = m_file.map(0, fileSize);
+    if (m_data == nullptr) {
+        m_errorString = m_file.errorString();
+        m_file.close();
+        return;
+    }
+    m_size = static_cast<int>(fileSize);
+    m_valid = true;
+}
+
+QProtobufMappedFile::~QProtobufMappedFile()
+{
+    if (m_data != nullptr) {
+        m_file.unmap(m_data);
+    }
+}
+
+QByteArray QProtobufMappedFile::data() const
+{
+    if (m_data == nullptr) {
+        return QByteArray();
+    }
+    return QByteArray::fromRawData(reinterpret_cast<const char *>(m_data), m_size);
+}
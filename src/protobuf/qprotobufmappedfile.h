@@ -0,0 +1,107 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufMappedFile
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+#include "qtprotobufglobal.h"
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufMappedFile class maps file with serialized message to memory for read-only access
+ *
+ * \details data() returns view of the mapped file, that may be deserialized without reading the file to
+ *          memory. When zero-copy bytes mode of QProtobufSerializer is enabled, bytes fields of deserialized
+ *          messages reference mapped pages directly, and only pages that are accessed are read from disk.
+ *          Strings are always decoded to QString.
+ *
+ *          Mapping is released when QProtobufMappedFile is destroyed, so it must outlive all messages
+ *          deserialized from it and all bytes received from such messages. Hold it by QSharedPointer
+ *          next to the messages if the lifetime is not scoped.
+ *          \code
+ *          QProtobufMappedFile file("catalog.bin");
+ *          if (!file.isValid()) {
+ *              qWarning() << file.errorString();
+ *              return;
+ *          }
+ *          serializer.setZeroCopyBytesEnabled(true);
+ *          Catalog catalog;
+ *          catalog.deserialize(&serializer, file.data());
+ *          \endcode
+ *
+ *          Files that are larger than maximum size of QByteArray can't be mapped.
+ *
+ * \see QProtobufSerializer::setZeroCopyBytesEnabled
+ */
+class Q_PROTOBUF_EXPORT QProtobufMappedFile
+{
+public:
+    explicit QProtobufMappedFile(const QString &fileName);
+    ~QProtobufMappedFile();
+
+    /*!
+     * \brief Returns true if file is mapped
+     */
+    bool isValid() const {
+        return m_valid;
+    }
+
+    /*!
+     * \brief Returns the reason why file is not mapped
+     */
+    QString errorString() const {
+        return m_errorString;
+    }
+
+    /*!
+     * \brief Returns view of the mapped file, or empty byte-array if file is not mapped
+     *
+     * \details Returned byte-array doesn't own mapped memory. Don't use it after QProtobufMappedFile is destroyed.
+     */
+    QByteArray data() const;
+
+    /*!
+     * \brief Returns size of the mapped file in bytes
+     */
+    int size() const {
+        return m_size;
+    }
+
+private:
+    Q_DISABLE_COPY_MOVE(QProtobufMappedFile)
+
+    QFile m_file;
+    uchar *m_data;
+    int m_size;
+    bool m_valid;
+    QString m_errorString;
+};
+
+}
@@ -24,9 +24,150 @@
  */
 
 #include "qprotobufmetaobject.h"
+#include "qprotobuffieldplan_p.h"
+#include "qprotobuffieldmask.h"
+#include "qprotobuffieldpresence.h"
+
+#include <atomic>
+
 using namespace QtProtobuf;
-QProtobufMetaObject::QProtobufMetaObject(const QMetaObject &_staticMetaObject, const QProtobufPropertyOrdering &_propertyOrdering)
+QProtobufMetaObject::QProtobufMetaObject(const QMetaObject &_staticMetaObject, const QProtobufPropertyOrdering &_propertyOrdering,
+                                         DirectSerializer _directSerializer, DirectDeserializer _directDeserializer,
+                                         UnknownFieldsAccessor _unknownFields, PresenceAccessor _presence,
+                                         PresenceAccessor _dirtyFields, const QProtobufFieldDescriptor *_fieldDescriptors,
+                                         quint64 _schemaFingerprint, DirectDeserializer _orderedDeserializer,
+                                         RevisionAccessor _revision)
     : staticMetaObject(_staticMetaObject)
     , propertyOrdering(_propertyOrdering)
+    , directSerializer(_directSerializer)
+    , directDeserializer(_directDeserializer)
+    , unknownFields(_unknownFields)
+    , presence(_presence)
+    , dirtyFields(_dirtyFields)
+    , fieldDescriptors(_fieldDescriptors)
+    , schemaFingerprint(_schemaFingerprint)
+    , orderedDeserializer(_orderedDeserializer)
+    , revision(_revision)
+    , m_fieldPlan(nullptr)
+{
+}
+
+QProtobufMetaObject::QProtobufMetaObject(const QProtobufMetaObject &other)
+    : staticMetaObject(other.staticMetaObject)
+    , propertyOrdering(other.propertyOrdering)
+    , directSerializer(other.directSerializer)
+    , directDeserializer(other.directDeserializer)
+    , unknownFields(other.unknownFields)
+    , presence(other.presence)
+    , dirtyFields(other.dirtyFields)
+    , fieldDescriptors(other.fieldDescriptors)
+    , schemaFingerprint(other.schemaFingerprint)
+    , orderedDeserializer(other.orderedDeserializer)
+    , revision(other.revision)
+    , m_fieldPlan(nullptr)
+{
+}
+
+QProtobufMetaObject::~QProtobufMetaObject()
+{
+    delete m_fieldPlan.loadAcquire();
+}
+
+quint64 QtProtobuf::nextMessageRevision()
+{
+    //Revision 0 is never returned, it means that message doesn't track revisions
+    static std::atomic<quint64> lastRevision(0);
+    return lastRevision.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+const QProtobufFieldPlan &QProtobufMetaObject::fieldPlan() const
+{
+    const QProtobufFieldPlan *plan = m_fieldPlan.loadAcquire();
+    if (plan != nullptr) {
+        return *plan;
+    }
+
+    //Basic handlers might be not registered yet if no QProtobufSerializer was created
+    QProtobufSerializerPrivate::registerBasicHandlers();
+
+    auto newPlan = new QProtobufFieldPlan;
+    newPlan->fields.reserve(propertyOrdering.size());
+    for (const auto &field : propertyOrdering) {
+        QMetaProperty metaProperty = staticMetaObject.property(field.second.qtProperty);
+        //Generated descriptors resolve metatype without lookup of property type name
+        const QProtobufFieldDescriptor *descriptor = nullptr;
+        if (fieldDescriptors != nullptr) {
+            descriptor = &fieldDescriptors[newPlan->fields.size()];
+            Q_ASSERT_X(descriptor->fieldNumber == field.first, "QProtobufMetaObject", "Field descriptors don't match property ordering");
+        }
+        const int userType = descriptor != nullptr ? descriptor->metaType() : metaProperty.userType();
+        newPlan->fields.emplace_back(field.first, userType, QProtobufMetaProperty(metaProperty, field.first, field.second.jsonName),
+                                     field.second, QProtobufSerializerPrivate::findHandlers(userType), descriptor);
+        newPlan->internsStrings = newPlan->internsStrings || (descriptor != nullptr && descriptor->internStrings);
+        newPlan->jsonIndex.insert(field.second.jsonName.toUtf8(), static_cast<int>(newPlan->fields.size()) - 1);
+    }
+
+    //Original proto names are accepted as well, but never shadow json names
+    for (size_t i = 0; i < newPlan->fields.size(); ++i) {
+        const char *protoName = newPlan->fields[i].orderingInfo.protoName;
+        if (protoName != nullptr && !newPlan->jsonIndex.contains(protoName)) {
+            newPlan->jsonIndex.insert(QByteArray(protoName), static_cast<int>(i));
+        }
+    }
+
+    //Plan could be built concurrently by other thread, first published plan wins
+    if (!m_fieldPlan.testAndSetOrdered(nullptr, newPlan, plan)) {
+        delete newPlan;
+        return *plan;
+    }
+    return *newPlan;
+}
+
+namespace {
+//Message properties are pointers owned by message, writing them would share ownership,
+//so fields of message types are handled by generated code
+template<typename Visitor>
+void forEachValueField(const QProtobufMetaObject &metaObject, const QProtobufFieldMask *fields, Visitor visitor)
+{
+    for (const auto &field : metaObject.fieldPlan().fields) {
+        if (fields != nullptr && !fields->contains(field.fieldNumber)) {
+            continue;
+        }
+        if (QMetaType::typeFlags(field.userType) & QMetaType::PointerToQObject) {
+            continue;
+        }
+        visitor(field);
+    }
+}
+}
+
+void QtProtobuf::copyMessageFields(QObject *target, const QObject *source, const QProtobufMetaObject &metaObject)
+{
+    Q_ASSERT_X(target != nullptr && source != nullptr, "copyMessageFields", "Message is null");
+    forEachValueField(metaObject, nullptr, [&](const QProtobufFieldPlanEntry &field) {
+        field.metaProperty.write(target, field.metaProperty.read(source));
+    });
+    if (metaObject.unknownFields != nullptr) {
+        *metaObject.unknownFields(target) = *metaObject.unknownFields(const_cast<QObject *>(source));
+    }
+}
+
+void QtProtobuf::mergeMessageFields(QObject *target, const QObject *source, const QProtobufMetaObject &metaObject,
+                                    const QProtobufFieldMask &fields)
+{
+    Q_ASSERT_X(target != nullptr && source != nullptr, "mergeMessageFields", "Message is null");
+    forEachValueField(metaObject, &fields, [&](const QProtobufFieldPlanEntry &field) {
+        field.metaProperty.write(target, field.metaProperty.read(source));
+    });
+}
+
+void QtProtobuf::clearMessageFields(QObject *object, const QProtobufMetaObject &metaObject)
 {
+    Q_ASSERT_X(object != nullptr, "clearMessageFields", "Message is null");
+    forEachValueField(metaObject, nullptr, [&](const QProtobufFieldPlanEntry &field) {
+        field.metaProperty.write(object, QVariant(field.userType, nullptr));
+    });
+    if (metaObject.unknownFields != nullptr) {
+        metaObject.unknownFields(object)->clear();
+    }
 }
@@ -29,8 +29,12 @@
 #include "qtprotobuftypes.h"
 
 #include <QMetaObject>
+#include <QByteArray>
+#include <QAtomicPointer>
 namespace QtProtobuf {
 
+struct QProtobufFieldPlan;
+
 /*!
  * \ingroup QtProtobuf
  * \private
@@ -39,11 +43,88 @@ namespace QtProtobuf {
 class Q_PROTOBUF_EXPORT QProtobufMetaObject
 {
 public:
-    QProtobufMetaObject(const QMetaObject &staticMetaObject, const QProtobufPropertyOrdering &propertyOrdering);
+    /*!
+     * \brief DirectSerializer is generated function that appends serialized message to buffer without
+     *        meta-object system involved
+     */
+    using DirectSerializer = void(*)(const QObject *, QByteArray &);
+    /*!
+     * \brief DirectDeserializer is generated function that fills message with data without meta-object
+     *        system involved
+     */
+    using DirectDeserializer = void(*)(QObject *, const QByteArray &);
+    /*!
+     * \brief UnknownFieldsAccessor is generated function that returns raw bytes of unknown fields stored in message
+     */
+    using UnknownFieldsAccessor = QByteArray *(*)(QObject *);
+    /*!
+     * \brief PresenceAccessor is generated function that returns field presence words of message
+     * \see QProtobufFieldPresence
+     */
+    using PresenceAccessor = const quint32 *(*)(const QObject *);
+    /*!
+     * \brief RevisionAccessor is generated function that returns revision of message
+     * \see QProtobufDirtyFields
+     */
+    using RevisionAccessor = quint64 (*)(const QObject *);
+
+    QProtobufMetaObject(const QMetaObject &staticMetaObject, const QProtobufPropertyOrdering &propertyOrdering,
+                        DirectSerializer directSerializer = nullptr, DirectDeserializer directDeserializer = nullptr,
+                        UnknownFieldsAccessor unknownFields = nullptr, PresenceAccessor presence = nullptr,
+                        PresenceAccessor dirtyFields = nullptr, const QProtobufFieldDescriptor *fieldDescriptors = nullptr,
+                        quint64 schemaFingerprint = 0, DirectDeserializer orderedDeserializer = nullptr,
+                        RevisionAccessor revision = nullptr);
+    QProtobufMetaObject(const QProtobufMetaObject &other);
+    ~QProtobufMetaObject();
+
+    /*!
+     * \brief Returns resolved fields of message type
+     * \details Plan is built at first call and shared by all serializers
+     */
+    const QProtobufFieldPlan &fieldPlan() const;
+
+    /*!
+     * \brief Returns field presence words of \a object, or nullptr if message type doesn't track field presence
+     */
+    const quint32 *presenceOf(const QObject *object) const {
+        return presence != nullptr ? presence(object) : nullptr;
+    }
+
+    /*!
+     * \brief Returns words of fields changed in \a object since last markClean() call,
+     *        or nullptr if message type doesn't track changes
+     */
+    const quint32 *dirtyFieldsOf(const QObject *object) const {
+        return dirtyFields != nullptr ? dirtyFields(object) : nullptr;
+    }
+
+    /*!
+     * \brief Returns revision of \a object, that is changed by every change of message fields,
+     *        or 0 if message type doesn't track revisions
+     */
+    quint64 revisionOf(const QObject *object) const {
+        return revision != nullptr ? revision(object) : 0;
+    }
+
     const QMetaObject &staticMetaObject;
     const QProtobufPropertyOrdering &propertyOrdering;
+    const DirectSerializer directSerializer;
+    const DirectDeserializer directDeserializer;
+    const UnknownFieldsAccessor unknownFields;
+    const PresenceAccessor presence;
+    const PresenceAccessor dirtyFields;
+    const QProtobufFieldDescriptor *const fieldDescriptors; //!< Generated field table in field number order, nullptr if not generated
+    const quint64 schemaFingerprint; //!< Hash of message fields layout, 0 if not generated
+    /*!
+     * \brief Generated deserializer that expects fields in field number order, as they are written by serializers
+     *        of the same schema. Fields in other order are decoded by directDeserializer. nullptr if not generated.
+     */
+    const DirectDeserializer orderedDeserializer;
+    const RevisionAccessor revision; //!< Generated accessor of message revision, nullptr if not generated
 private:
     QProtobufMetaObject();
+    QProtobufMetaObject &operator=(const QProtobufMetaObject &) = delete;
+    mutable QAtomicPointer<const QProtobufFieldPlan> m_fieldPlan;
 };
 
 }
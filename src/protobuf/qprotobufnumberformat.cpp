@@ -0,0 +1,494 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qprotobufnumberformat_p.h"
+
+#include <QtAlgorithms>
+
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+//! \private Floating point number with 64-bit significand and binary exponent: f * 2^e
+struct DiyFp {
+    DiyFp() : f(0), e(0) {}
+    DiyFp(uint64_t _f, int _e) : f(_f), e(_e) {}
+
+    DiyFp operator -(const DiyFp &other) const {
+        return DiyFp(f - other.f, e);
+    }
+
+    //Upper 64 bits of 128-bit product, rounded to nearest
+    DiyFp operator *(const DiyFp &other) const {
+        const uint64_t mask32 = 0xFFFFFFFFu;
+        const uint64_t a = f >> 32;
+        const uint64_t b = f & mask32;
+        const uint64_t c = other.f >> 32;
+        const uint64_t d = other.f & mask32;
+        const uint64_t ac = a * c;
+        const uint64_t bc = b * c;
+        const uint64_t ad = a * d;
+        const uint64_t bd = b * d;
+        uint64_t middle = (bd >> 32) + (ad & mask32) + (bc & mask32);
+        middle += uint64_t(1) << 31;
+        return DiyFp(ac + (ad >> 32) + (bc >> 32) + (middle >> 32), e + other.e + 64);
+    }
+
+    DiyFp normalized() const {
+        const int shift = static_cast<int>(qCountLeadingZeroBits(static_cast<quint64>(f)));
+        return DiyFp(f << shift, e - shift);
+    }
+
+    uint64_t f;
+    int e;
+};
+
+/*!
+ * \private
+ * \brief Normalized boundaries of rounding interval of floating point value \a v
+ * \details \a lowerBoundaryIsCloser is true when \a v is power of two and previous representable value is
+ *          twice closer than next one
+ */
+void normalizedBoundaries(const DiyFp &v, bool lowerBoundaryIsCloser, DiyFp &minus, DiyFp &plus)
+{
+    plus = DiyFp((v.f << 1) + 1, v.e - 1).normalized();
+    minus = lowerBoundaryIsCloser ? DiyFp((v.f << 2) - 1, v.e - 2) : DiyFp((v.f << 1) - 1, v.e - 1);
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+}
+
+//Normalized powers of ten 1e-348, 1e-340, ..., 1e340
+const DiyFp CachedPowers[] = {
+    DiyFp(0xfa8fd5a0081c0288ULL, -1220),
+    DiyFp(0xbaaee17fa23ebf76ULL, -1193),
+    DiyFp(0x8b16fb203055ac76ULL, -1166),
+    DiyFp(0xcf42894a5dce35eaULL, -1140),
+    DiyFp(0x9a6bb0aa55653b2dULL, -1113),
+    DiyFp(0xe61acf033d1a45dfULL, -1087),
+    DiyFp(0xab70fe17c79ac6caULL, -1060),
+    DiyFp(0xff77b1fcbebcdc4fULL, -1034),
+    DiyFp(0xbe5691ef416bd60cULL, -1007),
+    DiyFp(0x8dd01fad907ffc3cULL, -980),
+    DiyFp(0xd3515c2831559a83ULL, -954),
+    DiyFp(0x9d71ac8fada6c9b5ULL, -927),
+    DiyFp(0xea9c227723ee8bcbULL, -901),
+    DiyFp(0xaecc49914078536dULL, -874),
+    DiyFp(0x823c12795db6ce57ULL, -847),
+    DiyFp(0xc21094364dfb5637ULL, -821),
+    DiyFp(0x9096ea6f3848984fULL, -794),
+    DiyFp(0xd77485cb25823ac7ULL, -768),
+    DiyFp(0xa086cfcd97bf97f4ULL, -741),
+    DiyFp(0xef340a98172aace5ULL, -715),
+    DiyFp(0xb23867fb2a35b28eULL, -688),
+    DiyFp(0x84c8d4dfd2c63f3bULL, -661),
+    DiyFp(0xc5dd44271ad3cdbaULL, -635),
+    DiyFp(0x936b9fcebb25c996ULL, -608),
+    DiyFp(0xdbac6c247d62a584ULL, -582),
+    DiyFp(0xa3ab66580d5fdaf6ULL, -555),
+    DiyFp(0xf3e2f893dec3f126ULL, -529),
+    DiyFp(0xb5b5ada8aaff80b8ULL, -502),
+    DiyFp(0x87625f056c7c4a8bULL, -475),
+    DiyFp(0xc9bcff6034c13053ULL, -449),
+    DiyFp(0x964e858c91ba2655ULL, -422),
+    DiyFp(0xdff9772470297ebdULL, -396),
+    DiyFp(0xa6dfbd9fb8e5b88fULL, -369),
+    DiyFp(0xf8a95fcf88747d94ULL, -343),
+    DiyFp(0xb94470938fa89bcfULL, -316),
+    DiyFp(0x8a08f0f8bf0f156bULL, -289),
+    DiyFp(0xcdb02555653131b6ULL, -263),
+    DiyFp(0x993fe2c6d07b7facULL, -236),
+    DiyFp(0xe45c10c42a2b3b06ULL, -210),
+    DiyFp(0xaa242499697392d3ULL, -183),
+    DiyFp(0xfd87b5f28300ca0eULL, -157),
+    DiyFp(0xbce5086492111aebULL, -130),
+    DiyFp(0x8cbccc096f5088ccULL, -103),
+    DiyFp(0xd1b71758e219652cULL, -77),
+    DiyFp(0x9c40000000000000ULL, -50),
+    DiyFp(0xe8d4a51000000000ULL, -24),
+    DiyFp(0xad78ebc5ac620000ULL, 3),
+    DiyFp(0x813f3978f8940984ULL, 30),
+    DiyFp(0xc097ce7bc90715b3ULL, 56),
+    DiyFp(0x8f7e32ce7bea5c70ULL, 83),
+    DiyFp(0xd5d238a4abe98068ULL, 109),
+    DiyFp(0x9f4f2726179a2245ULL, 136),
+    DiyFp(0xed63a231d4c4fb27ULL, 162),
+    DiyFp(0xb0de65388cc8ada8ULL, 189),
+    DiyFp(0x83c7088e1aab65dbULL, 216),
+    DiyFp(0xc45d1df942711d9aULL, 242),
+    DiyFp(0x924d692ca61be758ULL, 269),
+    DiyFp(0xda01ee641a708deaULL, 295),
+    DiyFp(0xa26da3999aef774aULL, 322),
+    DiyFp(0xf209787bb47d6b85ULL, 348),
+    DiyFp(0xb454e4a179dd1877ULL, 375),
+    DiyFp(0x865b86925b9bc5c2ULL, 402),
+    DiyFp(0xc83553c5c8965d3dULL, 428),
+    DiyFp(0x952ab45cfa97a0b3ULL, 455),
+    DiyFp(0xde469fbd99a05fe3ULL, 481),
+    DiyFp(0xa59bc234db398c25ULL, 508),
+    DiyFp(0xf6c69a72a3989f5cULL, 534),
+    DiyFp(0xb7dcbf5354e9beceULL, 561),
+    DiyFp(0x88fcf317f22241e2ULL, 588),
+    DiyFp(0xcc20ce9bd35c78a5ULL, 614),
+    DiyFp(0x98165af37b2153dfULL, 641),
+    DiyFp(0xe2a0b5dc971f303aULL, 667),
+    DiyFp(0xa8d9d1535ce3b396ULL, 694),
+    DiyFp(0xfb9b7cd9a4a7443cULL, 720),
+    DiyFp(0xbb764c4ca7a44410ULL, 747),
+    DiyFp(0x8bab8eefb6409c1aULL, 774),
+    DiyFp(0xd01fef10a657842cULL, 800),
+    DiyFp(0x9b10a4e5e9913129ULL, 827),
+    DiyFp(0xe7109bfba19c0c9dULL, 853),
+    DiyFp(0xac2820d9623bf429ULL, 880),
+    DiyFp(0x80444b5e7aa7cf85ULL, 907),
+    DiyFp(0xbf21e44003acdd2dULL, 933),
+    DiyFp(0x8e679c2f5e44ff8fULL, 960),
+    DiyFp(0xd433179d9c8cb841ULL, 986),
+    DiyFp(0x9e19db92b4e31ba9ULL, 1013),
+    DiyFp(0xeb96bf6ebadf77d9ULL, 1039),
+    DiyFp(0xaf87023b9bf0ee6bULL, 1066),
+};
+
+DiyFp cachedPower(int e, int &decimalExponent)
+{
+    //Smallest power of ten that moves product of binary exponent e to [-60, -32] range
+    const double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int k = static_cast<int>(dk);
+    if (dk - k > 0.0) {
+        ++k;
+    }
+    const unsigned index = static_cast<unsigned>((k >> 3) + 1);
+    decimalExponent = -(-348 + static_cast<int>(index << 3));
+    return CachedPowers[index];
+}
+
+const uint64_t Pow10[] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+    10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull,
+    1000000000000000ull, 10000000000000000ull, 100000000000000000ull, 1000000000000000000ull,
+    10000000000000000000ull
+};
+
+int countDecimalDigits(uint32_t n)
+{
+    int count = 1;
+    while (count < 10 && n >= Pow10[count]) {
+        ++count;
+    }
+    return count;
+}
+
+void grisuRound(char *buffer, int length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance)
+{
+    while (rest < distance && delta - rest >= tenKappa
+           && (rest + tenKappa < distance || distance - rest > rest + tenKappa - distance)) {
+        --buffer[length - 1];
+        rest += tenKappa;
+    }
+}
+
+void generateDigits(const DiyFp &w, const DiyFp &upper, uint64_t delta, char *buffer, int &length, int &decimalExponent)
+{
+    const DiyFp one(uint64_t(1) << -upper.e, upper.e);
+    const uint64_t distance = (upper - w).f;
+    uint32_t integral = static_cast<uint32_t>(upper.f >> -one.e);
+    uint64_t fractional = upper.f & (one.f - 1);
+    int kappa = countDecimalDigits(integral);
+    length = 0;
+
+    while (kappa > 0) {
+        const uint32_t divisor = static_cast<uint32_t>(Pow10[kappa - 1]);
+        const uint32_t digit = integral / divisor;
+        integral %= divisor;
+        if (digit != 0 || length != 0) {
+            buffer[length++] = static_cast<char>('0' + digit);
+        }
+        --kappa;
+        const uint64_t rest = (static_cast<uint64_t>(integral) << -one.e) + fractional;
+        if (rest <= delta) {
+            decimalExponent += kappa;
+            grisuRound(buffer, length, delta, rest, Pow10[kappa] << -one.e, distance);
+            return;
+        }
+    }
+
+    while (true) {
+        fractional *= 10;
+        delta *= 10;
+        const char digit = static_cast<char>(fractional >> -one.e);
+        if (digit != 0 || length != 0) {
+            buffer[length++] = static_cast<char>('0' + digit);
+        }
+        fractional &= one.f - 1;
+        --kappa;
+        if (fractional < delta) {
+            decimalExponent += kappa;
+            const int index = -kappa;
+            grisuRound(buffer, length, delta, fractional, one.f, index < 20 ? distance * Pow10[index] : 0);
+            return;
+        }
+    }
+}
+
+void grisu2(const DiyFp &v, bool lowerBoundaryIsCloser, char *buffer, int &length, int &decimalExponent)
+{
+    DiyFp minus;
+    DiyFp plus;
+    normalizedBoundaries(v, lowerBoundaryIsCloser, minus, plus);
+
+    const DiyFp power = cachedPower(plus.e, decimalExponent);
+    const DiyFp w = v.normalized() * power;
+    DiyFp upper = plus * power;
+    DiyFp lower = minus * power;
+    ++lower.f;
+    --upper.f;
+    generateDigits(w, upper, upper.f - lower.f, buffer, length, decimalExponent);
+}
+
+int writeExponent(int exponent, char *buffer)
+{
+    char *it = buffer;
+    *it++ = 'e';
+    if (exponent < 0) {
+        *it++ = '-';
+        exponent = -exponent;
+    } else {
+        *it++ = '+';
+    }
+    if (exponent >= 100) {
+        *it++ = static_cast<char>('0' + exponent / 100);
+        exponent %= 100;
+        *it++ = static_cast<char>('0' + exponent / 10);
+    } else if (exponent >= 10) {
+        *it++ = static_cast<char>('0' + exponent / 10);
+    }
+    *it++ = static_cast<char>('0' + exponent % 10);
+    return static_cast<int>(it - buffer);
+}
+
+//Lays out \a length digits of number digits * 10^decimalExponent that are stored at the beginning of \a buffer
+int prettify(char *buffer, int length, int decimalExponent)
+{
+    const int pointPosition = length + decimalExponent;
+    if (decimalExponent >= 0 && pointPosition <= 21) {
+        //Integer: 1234e7 -> 12340000000
+        memset(buffer + length, '0', static_cast<size_t>(decimalExponent));
+        return pointPosition;
+    }
+
+    if (pointPosition > 0 && pointPosition <= 21) {
+        //Decimal point inside of digits: 1234e-2 -> 12.34
+        memmove(buffer + pointPosition + 1, buffer + pointPosition, static_cast<size_t>(length - pointPosition));
+        buffer[pointPosition] = '.';
+        return length + 1;
+    }
+
+    if (pointPosition > -6 && pointPosition <= 0) {
+        //Leading zeros: 1234e-6 -> 0.001234
+        const int offset = 2 - pointPosition;
+        memmove(buffer + offset, buffer, static_cast<size_t>(length));
+        buffer[0] = '0';
+        buffer[1] = '.';
+        memset(buffer + 2, '0', static_cast<size_t>(-pointPosition));
+        return length + offset;
+    }
+
+    if (length == 1) {
+        //Single digit exponential: 1e30
+        return 1 + writeExponent(pointPosition - 1, buffer + 1);
+    }
+
+    //Exponential: 1234e30 -> 1.234e+33
+    memmove(buffer + 2, buffer + 1, static_cast<size_t>(length - 1));
+    buffer[1] = '.';
+    return length + 1 + writeExponent(pointPosition - 1, buffer + length + 1);
+}
+
+int formatDigits(bool negative, const DiyFp &v, bool lowerBoundaryIsCloser, char *buffer)
+{
+    //Negative zero is written as 0, like in ECMAScript
+    if (v.f == 0) {
+        buffer[0] = '0';
+        return 1;
+    }
+
+    char *it = buffer;
+    if (negative) {
+        *it++ = '-';
+    }
+
+    int length = 0;
+    int decimalExponent = 0;
+    grisu2(v, lowerBoundaryIsCloser, it, length, decimalExponent);
+    return static_cast<int>(it - buffer) + prettify(it, length, decimalExponent);
+}
+
+/*!
+ * \private
+ * \brief Significant digits and decimal exponent of json number
+ */
+struct DecimalNumber {
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    bool negative = false;
+};
+
+bool parseDecimal(const char *data, int size, DecimalNumber &number)
+{
+    const char *it = data;
+    const char *end = data + size;
+    if (it != end && *it == '-') {
+        number.negative = true;
+        ++it;
+    }
+
+    int significantDigits = 0;
+    bool hasDigits = false;
+    for (; it != end && *it >= '0' && *it <= '9'; ++it) {
+        hasDigits = true;
+        if (number.mantissa == 0 && *it == '0') {
+            continue;
+        }
+        if (++significantDigits > 19) {
+            return false;
+        }
+        number.mantissa = number.mantissa * 10 + static_cast<uint64_t>(*it - '0');
+    }
+
+    if (it != end && *it == '.') {
+        for (++it; it != end && *it >= '0' && *it <= '9'; ++it) {
+            hasDigits = true;
+            --number.exponent;
+            if (number.mantissa == 0 && *it == '0') {
+                continue;
+            }
+            if (++significantDigits > 19) {
+                return false;
+            }
+            number.mantissa = number.mantissa * 10 + static_cast<uint64_t>(*it - '0');
+        }
+    }
+
+    if (!hasDigits) {
+        return false;
+    }
+
+    if (it != end && (*it == 'e' || *it == 'E')) {
+        ++it;
+        bool negativeExponent = false;
+        if (it != end && (*it == '-' || *it == '+')) {
+            negativeExponent = *it == '-';
+            ++it;
+        }
+        if (it == end) {
+            return false;
+        }
+        int exponent = 0;
+        for (; it != end && *it >= '0' && *it <= '9'; ++it) {
+            if (exponent > 10000) {
+                return false;
+            }
+            exponent = exponent * 10 + (*it - '0');
+        }
+        number.exponent += negativeExponent ? -exponent : exponent;
+    }
+
+    return it == end;
+}
+
+}
+
+namespace QtProtobufPrivate {
+
+int formatShortest(double value, char *buffer)
+{
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    const int biasedExponent = static_cast<int>((bits >> 52) & 0x7FF);
+    const uint64_t significand = bits & ((uint64_t(1) << 52) - 1);
+    const DiyFp v = biasedExponent != 0 ? DiyFp(significand | (uint64_t(1) << 52), biasedExponent - 1075)
+                                        : DiyFp(significand, -1074);
+    return formatDigits((bits >> 63) != 0, v, biasedExponent > 1 && significand == 0, buffer);
+}
+
+int formatShortest(float value, char *buffer)
+{
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    const int biasedExponent = static_cast<int>((bits >> 23) & 0xFF);
+    const uint32_t significand = bits & ((uint32_t(1) << 23) - 1);
+    const DiyFp v = biasedExponent != 0 ? DiyFp(significand | (uint32_t(1) << 23), biasedExponent - 150)
+                                        : DiyFp(significand, -149);
+    return formatDigits((bits >> 31) != 0, v, biasedExponent > 1 && significand == 0, buffer);
+}
+
+bool parseFloatingPoint(const char *data, int size, double &value)
+{
+    static const double exactPowers[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    DecimalNumber number;
+    if (!parseDecimal(data, size, number)) {
+        return false;
+    }
+
+    double result = 0.0;
+    if (number.mantissa != 0) {
+        if (number.mantissa > (uint64_t(1) << 53) || number.exponent < -22 || number.exponent > 22) {
+            return false;
+        }
+        result = static_cast<double>(number.mantissa);
+        result = number.exponent < 0 ? result / exactPowers[-number.exponent] : result * exactPowers[number.exponent];
+    }
+    value = number.negative ? -result : result;
+    return true;
+}
+
+bool parseFloatingPoint(const char *data, int size, float &value)
+{
+    static const float exactPowers[] = {
+        1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+    };
+
+    DecimalNumber number;
+    if (!parseDecimal(data, size, number)) {
+        return false;
+    }
+
+    float result = 0.0f;
+    if (number.mantissa != 0) {
+        if (number.mantissa > (uint64_t(1) << 24) || number.exponent < -10 || number.exponent > 10) {
+            return false;
+        }
+        result = static_cast<float>(number.mantissa);
+        result = number.exponent < 0 ? result / exactPowers[-number.exponent] : result * exactPowers[number.exponent];
+    }
+    value = number.negative ? -result : result;
+    return true;
+}
+
+}
@@ -0,0 +1,77 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufNumberFormat
+
+#include <QtGlobal>
+
+namespace QtProtobufPrivate {
+
+enum {
+    ShortestFormatBufferSize = 32 //!< Size of buffer that fits any number produced by formatShortest
+};
+
+/*!
+ * \private
+ * \brief Writes shortest decimal representation of \a value that is parsed back to the same double to \a buffer
+ *
+ * \details Digits are generated using Grisu2 algorithm, that produces shortest representation for vast
+ *          majority of values and representation that is parsed back exactly for all values. Representation
+ *          doesn't depend on current locale and follows ECMAScript number to string conversion: decimal notation is used for absolute values in
+ *          range [1e-6, 1e21), exponential notation is used otherwise. \a buffer must have at least
+ *          ShortestFormatBufferSize bytes. Result is not null-terminated. Negative zero is written as 0.
+ *          NaN and infinite values are not supported.
+ * \return number of bytes written to \a buffer
+ */
+int formatShortest(double value, char *buffer);
+
+/*!
+ * \private
+ * \brief Writes shortest decimal representation of \a value that is parsed back to the same float to \a buffer
+ *
+ * \see formatShortest(double, char *)
+ */
+int formatShortest(float value, char *buffer);
+
+/*!
+ * \private
+ * \brief Parses json number of \a size bytes from \a data to \a value
+ *
+ * \details Only fast path is implemented: numbers with up to 19 significant digits that are exactly
+ *          representable after single multiplication or division by power of ten.
+ * \return false if \a data is not a number or number requires slow exact conversion, \a value is left
+ *         unchanged in this case
+ */
+bool parseFloatingPoint(const char *data, int size, double &value);
+
+/*!
+ * \private
+ * \brief Parses json number of \a size bytes from \a data to \a value
+ *
+ * \see parseFloatingPoint(const char *, int, double &)
+ */
+bool parseFloatingPoint(const char *data, int size, float &value);
+
+}
@@ -29,6 +29,81 @@
 #include "qprotobufmetaobject.h"
 #include <unordered_map>
 
+namespace QtProtobufPrivate {
+/*!
+ * \private
+ * \brief Removes all elements of \a value, keeping allocated memory if possible
+ */
+inline void clearKeepingCapacity(QString &value) {
+    value.resize(0);
+}
+
+//! \private
+inline void clearKeepingCapacity(QByteArray &value) {
+    //Capacity is kept only if it's reserved explicitly
+    value.reserve(value.capacity());
+    value.resize(0);
+}
+
+//! \private
+template<typename T>
+void clearKeepingCapacity(QList<T> &value) {
+    value.erase(value.begin(), value.end());
+}
+
+//! \private
+template<typename K, typename V>
+void clearKeepingCapacity(QMap<K, V> &value) {
+    value.clear();
+}
+
+//! \private
+template<typename K, typename V>
+void clearKeepingCapacity(QHash<K, V> &value) {
+    value.clear();
+}
+}
+
+namespace QtProtobuf {
+/*!
+ * \ingroup QtProtobuf
+ * \brief Calculates hash of message \a object
+ *
+ * \details Hash is calculated over message serialized to protobuf wire format, so equal messages have equal hashes.
+ *          Unknown fields are not taken into account. Is used by qHash functions of autogenerated messages.
+ */
+Q_PROTOBUF_EXPORT uint qHashMessage(const QObject *object, const QProtobufMetaObject &metaObject, uint seed = 0);
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief Copies fields and unknown fields of \a source message to \a target message of the same type
+ *
+ * \details Fields are copied through meta-object properties, in field number order, so change signals are emitted
+ *          same way as for generated setters. Fields of message types are skipped, they are copied by generated code.
+ *          Is used by copy assignment operators of messages generated with COMPACT option.
+ */
+Q_PROTOBUF_EXPORT void copyMessageFields(QObject *target, const QObject *source, const QProtobufMetaObject &metaObject);
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief Copies fields of \a source message that are in \a fields mask to \a target message of the same type
+ *
+ * \details Fields of message types are skipped, they are merged by generated code.
+ *          Is used by mergeFields functions of messages generated with COMPACT option.
+ */
+Q_PROTOBUF_EXPORT void mergeMessageFields(QObject *target, const QObject *source, const QProtobufMetaObject &metaObject,
+                                          const QProtobufFieldMask &fields);
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief Resets fields of \a object to default values and drops its unknown fields
+ *
+ * \details Fields of message types are skipped, they are cleared by generated code.
+ *          Is used by clear functions of messages generated with COMPACT option.
+ */
+Q_PROTOBUF_EXPORT void clearMessageFields(QObject *object, const QProtobufMetaObject &metaObject);
+}
+
 /*!
  * \defgroup QtProtobuf
  * \brief Qt framework wrappers and bindings for protobuf objects
@@ -44,16 +119,20 @@
     public:\
         QByteArray serialize(QtProtobuf::QAbstractProtobufSerializer *serializer) const { Q_ASSERT_X(serializer != nullptr, "QProtobufObject", "Serializer is null"); return serializer->serialize<T>(this); }\
         void deserialize(QtProtobuf::QAbstractProtobufSerializer *serializer, const QByteArray &array) { Q_ASSERT_X(serializer != nullptr, "QProtobufObject", "Serializer is null"); serializer->deserialize<T>(this, array); }\
+        void merge(QtProtobuf::QAbstractProtobufSerializer *serializer, const QByteArray &array) { Q_ASSERT_X(serializer != nullptr, "QProtobufObject", "Serializer is null"); serializer->merge<T>(this, array); }\
+        int byteSize(QtProtobuf::QAbstractProtobufSerializer *serializer) const { Q_ASSERT_X(serializer != nullptr, "QProtobufObject", "Serializer is null"); return serializer->byteSize<T>(this); }\
     private:
 
 /*!
  * \ingroup QtProtobuf
  * \def Q_PROTOBUF_OBJECT
- *      Declares propertyOrdering for type T inherited of QObject. Is part of autogenerated by qtprogobufgenerator classes
+ *      Declares propertyOrdering, field descriptors and protobuf meta-object for type T inherited of QObject.
+ *      Is part of autogenerated by qtprogobufgenerator classes
  */
 
 #define Q_PROTOBUF_OBJECT\
     public:\
         static const QtProtobuf::QProtobufPropertyOrdering propertyOrdering;\
+        static const QtProtobuf::QProtobufFieldDescriptor protobufFieldDescriptors[];\
         static const QtProtobuf::QProtobufMetaObject protobufMetaObject;\
     private:
@@ -0,0 +1,106 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qprotobufrepeatedfieldmodel.h"
+
+#include <QQmlEngine>
+
+using namespace QtProtobuf;
+
+namespace {
+const QByteArray ModelDataRole("modelData");
+}
+
+QProtobufRepeatedFieldModelBase::QProtobufRepeatedFieldModelBase(QObject *parent) : QAbstractListModel(parent)
+{
+}
+
+QProtobufRepeatedFieldModelBase::~QProtobufRepeatedFieldModelBase() = default;
+
+int QProtobufRepeatedFieldModelBase::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : count();
+}
+
+QVariant QProtobufRepeatedFieldModelBase::data(const QModelIndex &index, int role) const
+{
+    const int row = index.row();
+    if (row < 0 || row >= count()) {
+        return QVariant();
+    }
+
+    QObject *item = itemAt(row);
+    const QByteArray roleName = roleNames().value(role);
+    if (roleName.isEmpty()) {
+        return QVariant();
+    }
+
+    if (roleName == ModelDataRole) {
+        return QVariant::fromValue(item);
+    }
+    return item->property(roleName.constData());
+}
+
+QHash<int, QByteArray> QProtobufRepeatedFieldModelBase::roleNames() const
+{
+    if (m_roleNames.isEmpty()) {
+        const QMetaObject *metaObject = itemMetaObject();
+        //Property 0 is objectName of QObject
+        for (int i = 1; i < metaObject->propertyCount(); i++) {
+            m_roleNames.insert(Qt::UserRole + i, metaObject->property(i).name());
+        }
+        m_roleNames.insert(Qt::UserRole + metaObject->propertyCount(), ModelDataRole);
+    }
+    return m_roleNames;
+}
+
+QObject *QProtobufRepeatedFieldModelBase::get(int row) const
+{
+    if (row < 0 || row >= count()) {
+        return nullptr;
+    }
+    return itemAt(row);
+}
+
+QString QProtobufRepeatedFieldModelBase::keyProperty() const
+{
+    return QString::fromLatin1(m_keyProperty);
+}
+
+void QProtobufRepeatedFieldModelBase::setKeyProperty(const QString &keyProperty)
+{
+    const QByteArray latin1KeyProperty = keyProperty.toLatin1();
+    if (m_keyProperty == latin1KeyProperty) {
+        return;
+    }
+
+    m_keyProperty = latin1KeyProperty;
+    emit keyPropertyChanged();
+}
+
+void QProtobufRepeatedFieldModelBase::adoptItem(QObject *item)
+{
+    QQmlEngine::setObjectOwnership(item, QQmlEngine::CppOwnership);
+}
@@ -0,0 +1,217 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufRepeatedFieldModel
+
+#include <QAbstractListModel>
+#include <QSharedPointer>
+#include <QList>
+
+#include "qtprotobufglobal.h"
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufRepeatedFieldModelBase class is non-template part of QProtobufRepeatedFieldModel
+ *
+ * \details Provides item roles and QML-visible properties of model. Every property of item message is available
+ *          as role with the same name, item itself is available as "modelData" role.
+ */
+class Q_PROTOBUF_EXPORT QProtobufRepeatedFieldModelBase : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(QString keyProperty READ keyProperty WRITE setKeyProperty NOTIFY keyPropertyChanged)
+
+public:
+    explicit QProtobufRepeatedFieldModelBase(QObject *parent = nullptr);
+    ~QProtobufRepeatedFieldModelBase() override;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    /*!
+     * \brief Returns number of items in model
+     */
+    virtual int count() const = 0;
+
+    /*!
+     * \brief Returns item at \a row or nullptr if \a row is out of range
+     */
+    Q_INVOKABLE QObject *get(int row) const;
+
+    /*!
+     * \brief Name of property that identifies items between updates
+     * \details If key property is empty, items are identified by equality of messages. In this case changed
+     *          items are removed and inserted again instead of being updated in place.
+     */
+    QString keyProperty() const;
+    void setKeyProperty(const QString &keyProperty);
+
+signals:
+    void countChanged();
+    void keyPropertyChanged();
+
+protected:
+    //! \private
+    virtual QObject *itemAt(int row) const = 0;
+    //! \private
+    virtual const QMetaObject *itemMetaObject() const = 0;
+    //! \private
+    static void adoptItem(QObject *item);
+
+    QByteArray m_keyProperty;
+
+private:
+    mutable QHash<int, QByteArray> m_roleNames;
+};
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufRepeatedFieldModel class is list model for repeated message fields
+ *
+ * \details Unlike QQmlListProperty that is reset each time field is updated, model compares new field content with
+ *          items it holds and emits minimal set of rowsInserted, rowsRemoved, rowsMoved and dataChanged signals, so
+ *          views keep delegates of items that are not changed. Items are stored in model and updated in place, pointers
+ *          to items stay valid while items are present in model.
+ *          \code
+ *          QProtobufRepeatedFieldModel<Sensor> model;
+ *          model.setKeyProperty("id");
+ *          connect(stream.get(), &QGrpcStream::messageReceived, [&model, reply]() {
+ *              model.update(reply->sensors());
+ *          });
+ *          \endcode
+ */
+template<typename T>
+class QProtobufRepeatedFieldModel : public QProtobufRepeatedFieldModelBase
+{
+public:
+    explicit QProtobufRepeatedFieldModel(QObject *parent = nullptr) : QProtobufRepeatedFieldModelBase(parent) {}
+
+    int count() const override {
+        return m_items.count();
+    }
+
+    /*!
+     * \brief Returns items stored in model
+     */
+    const QList<QSharedPointer<T>> &items() const {
+        return m_items;
+    }
+
+    /*!
+     * \brief Updates model to content of \a items
+     * \details Items are copied to model storage, so \a items might be changed or released after call
+     */
+    void update(const QList<QSharedPointer<T>> &items) {
+        const int oldCount = m_items.count();
+        int row = 0;
+        while (row < items.count()) {
+            const T &item = *items.at(row);
+            if (row < m_items.count()) {
+                if (isSameItem(*m_items.at(row), item)) {
+                    updateRow(row, item);
+                    ++row;
+                    continue;
+                }
+
+                if (indexOf(items, row + 1, *m_items.at(row)) < 0) {
+                    beginRemoveRows(QModelIndex(), row, row);
+                    m_items.removeAt(row);
+                    endRemoveRows();
+                    continue;
+                }
+            }
+
+            const int existingRow = indexOf(m_items, row + 1, item);
+            if (existingRow >= 0) {
+                beginMoveRows(QModelIndex(), existingRow, existingRow, QModelIndex(), row);
+                m_items.move(existingRow, row);
+                endMoveRows();
+                updateRow(row, item);
+            } else {
+                beginInsertRows(QModelIndex(), row, row);
+                QSharedPointer<T> copy(new T(item));
+                adoptItem(copy.data());
+                m_items.insert(row, copy);
+                endInsertRows();
+            }
+            ++row;
+        }
+
+        if (m_items.count() > items.count()) {
+            beginRemoveRows(QModelIndex(), items.count(), m_items.count() - 1);
+            m_items.erase(m_items.begin() + items.count(), m_items.end());
+            endRemoveRows();
+        }
+
+        if (oldCount != m_items.count()) {
+            emit countChanged();
+        }
+    }
+
+protected:
+    //! \private
+    QObject *itemAt(int row) const override {
+        return m_items.at(row).data();
+    }
+
+    //! \private
+    const QMetaObject *itemMetaObject() const override {
+        return &T::staticMetaObject;
+    }
+
+private:
+    bool isSameItem(const T &first, const T &second) const {
+        if (m_keyProperty.isEmpty()) {
+            return first == second;
+        }
+        return first.property(m_keyProperty.constData()) == second.property(m_keyProperty.constData());
+    }
+
+    int indexOf(const QList<QSharedPointer<T>> &list, int from, const T &item) const {
+        for (int i = from; i < list.count(); i++) {
+            if (isSameItem(*list.at(i), item)) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    void updateRow(int row, const T &item) {
+        T &current = *m_items.at(row);
+        if (current != item) {
+            current = item;
+            const QModelIndex changedIndex = index(row);
+            emit dataChanged(changedIndex, changedIndex);
+        }
+    }
+
+    QList<QSharedPointer<T>> m_items;
+};
+
+}
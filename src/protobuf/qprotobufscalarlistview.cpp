@@ -0,0 +1,63 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qprotobufscalarlistview.h"
+
+#include <QQmlEngine>
+
+using namespace QtProtobuf;
+
+QProtobufScalarListView::~QProtobufScalarListView() = default;
+
+void QProtobufScalarListView::init()
+{
+    //View is owned by message, QML engine must not destroy it
+    QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
+}
+
+double QProtobufScalarListView::at(int index) const
+{
+    if (index < 0 || index >= count()) {
+        return 0.0;
+    }
+    double value = 0.0;
+    m_copy(m_list, index, 1, &value);
+    return value;
+}
+
+QByteArray QProtobufScalarListView::toArrayBuffer(int from, int count) const
+{
+    const int size = this->count();
+    if (from < 0 || from > size) {
+        return QByteArray();
+    }
+    if (count < 0 || count > size - from) {
+        count = size - from;
+    }
+
+    QByteArray buffer(count * static_cast<int>(sizeof(double)), Qt::Uninitialized);
+    m_copy(m_list, from, count, reinterpret_cast<double *>(buffer.data()));
+    return buffer;
+}
@@ -0,0 +1,115 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufScalarListView
+
+#include <QObject>
+#include <QByteArray>
+#include <QList>
+
+#include "qtprotobufglobal.h"
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufScalarListView class is read-only view to repeated numeric field of message
+ *
+ * \details View reads elements from storage of message field, so QML code that accesses count or single elements
+ *          doesn't convert whole list to JavaScript array, as property of list type does at each read. Elements are
+ *          returned as JavaScript numbers, values of 64-bit integers that don't fit double are rounded. toArrayBuffer()
+ *          returns elements as contiguous doubles, that are used by Float64Array without per-element conversion:
+ *          \code
+ *          Canvas {
+ *              property var points: new Float64Array(series.valuesView.toArrayBuffer())
+ *              Connections {
+ *                  target: series.valuesView
+ *                  onChanged: points = new Float64Array(series.valuesView.toArrayBuffer())
+ *              }
+ *          }
+ *          \endcode
+ *          Views are generated for repeated numeric fields by SCALAR_VIEWS generator option. View is owned by message,
+ *          changed() is emitted when field is updated by setter.
+ */
+class Q_PROTOBUF_EXPORT QProtobufScalarListView : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY changed)
+
+public:
+    template<typename T>
+    QProtobufScalarListView(const QList<T> *list, QObject *parent) : QObject(parent)
+      , m_list(list)
+      , m_count(&listCount<T>)
+      , m_copy(&listCopy<T>) {
+        init();
+    }
+    ~QProtobufScalarListView() override;
+
+    /*!
+     * \brief Returns number of elements in field
+     */
+    int count() const {
+        return m_count(m_list);
+    }
+
+    /*!
+     * \brief Returns element at \a index, or 0 if \a index is out of range
+     */
+    Q_INVOKABLE double at(int index) const;
+
+    /*!
+     * \brief Returns \a count elements starting from \a from as contiguous doubles in host byte order,
+     *        all elements that follow \a from if \a count is negative
+     * \details QByteArray is available as ArrayBuffer in QML
+     */
+    Q_INVOKABLE QByteArray toArrayBuffer(int from = 0, int count = -1) const;
+
+signals:
+    void changed();
+
+private:
+    Q_DISABLE_COPY_MOVE(QProtobufScalarListView)
+    void init();
+
+    template<typename T>
+    static int listCount(const void *list) {
+        return static_cast<const QList<T> *>(list)->count();
+    }
+
+    template<typename T>
+    static void listCopy(const void *list, int from, int count, double *out) {
+        const QList<T> &elements = *static_cast<const QList<T> *>(list);
+        for (int i = 0; i < count; i++) {
+            out[i] = static_cast<double>(elements.at(from + i));
+        }
+    }
+
+    const void *m_list;
+    int (*m_count)(const void *);
+    void (*m_copy)(const void *, int, int, double *);
+};
+
+}
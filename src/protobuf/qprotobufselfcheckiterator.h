@@ -27,14 +27,59 @@
 #include <stdexcept>
 
 #include "qtprotobufglobal.h"
+#include "qtprotobuftypes.h"
 
 #pragma once //QProtobufSelfcheckIterator
 
+namespace QtProtobufPrivate {
+
+/*!
+ * \private
+ * \brief Reports \a error that happened during deserialization
+ *
+ * \details Throws std::out_of_range for QtProtobuf::UnexpectedEndOfStreamError and std::invalid_argument for
+ *          other errors. If DeserializationErrorScope is active in current thread, or QtProtobuf is built with
+ *          QT_PROTOBUF_NO_EXCEPTIONS, first error is stored and may be received using deserializationError().
+ *          Caller should stop deserialization and return safe value in this case.
+ */
+extern Q_PROTOBUF_EXPORT void reportDeserializationError(QtProtobuf::DeserializationError error, const char *message);
+
+/*!
+ * \private
+ * \brief Returns first error stored since current thread entered DeserializationErrorScope
+ */
+extern Q_PROTOBUF_EXPORT QtProtobuf::DeserializationError deserializationError();
+
+/*!
+ * \private
+ * \brief The DeserializationErrorScope class switches deserializers of current thread to status based error
+ *        reporting while scope is alive
+ *
+ * \details Nested scopes propagate their first error to outer scope.
+ */
+class Q_PROTOBUF_EXPORT DeserializationErrorScope
+{
+public:
+    DeserializationErrorScope();
+    ~DeserializationErrorScope();
+
+    QtProtobuf::DeserializationError error() const;
+private:
+    Q_DISABLE_COPY_MOVE(DeserializationErrorScope)
+    bool m_wasCollecting;
+    QtProtobuf::DeserializationError m_previousError;
+};
+
+}
+
 namespace QtProtobuf {
 
 /*!
  * \ingroup QtProtobuf
  * \brief The QProtobufSelfcheckIterator class
+ *
+ * \details Iterator never points outside of container: every move is checked before iterator is changed,
+ *          so copies of valid iterator are valid without any extra checks.
  */
 class Q_PROTOBUF_EXPORT QProtobufSelfcheckIterator
 {
@@ -43,13 +88,16 @@ public:
       , m_containerSize(container.size())
       , m_it(container.begin()) {}
 
-    QProtobufSelfcheckIterator(const QProtobufSelfcheckIterator &other) : m_sizeLeft(other.m_sizeLeft)
-      , m_containerSize(other.m_containerSize)
-      , m_it(other.m_it) {
-        if (m_sizeLeft > m_containerSize || m_sizeLeft < 0) {
-            throw std::out_of_range("Container is less than required fields number. Deserialization failed");
-        }
-    }
+    /*!
+     * \brief Constructs iterator over \a size bytes at \a data
+     *
+     * \details Bytes are not copied and must stay alive while iterator is used.
+     */
+    QProtobufSelfcheckIterator(const char *data, int size) : m_sizeLeft(size)
+      , m_containerSize(size)
+      , m_it(data) {}
+
+    QProtobufSelfcheckIterator(const QProtobufSelfcheckIterator &other) = default;
 
     explicit operator QByteArray::const_iterator&() { return m_it; }
     explicit operator QByteArray::const_iterator() const { return m_it; }
@@ -57,53 +105,53 @@ public:
     char operator *() { return *m_it; }
 
     QProtobufSelfcheckIterator &operator ++() {
-        --m_sizeLeft;
-        if (m_sizeLeft < 0) {
-            throw std::out_of_range("Container is less than required fields number. Deserialization failed");
+        if (m_sizeLeft < 1) {
+            reportOutOfRange();
+            return *this;
         }
+        --m_sizeLeft;
         ++m_it;
         return *this;
     }
 
     QProtobufSelfcheckIterator &operator --() {
-        ++m_sizeLeft;
-        if (m_sizeLeft > m_containerSize) {
-            throw std::out_of_range("Container is less than required fields number. Deserialization failed");
+        if (m_sizeLeft >= m_containerSize) {
+            reportOutOfRange();
+            return *this;
         }
+        ++m_sizeLeft;
         --m_it;
         return *this;
     }
 
     QProtobufSelfcheckIterator &operator +=(int count) {
-        m_sizeLeft -= count;
-        if (m_sizeLeft < 0) {
-            throw std::out_of_range("Container is less than required fields number. Deserialization failed");
+        if (count > m_sizeLeft || count < m_sizeLeft - m_containerSize) {
+            reportOutOfRange();
+            if (count > 0) {
+                advanceUnchecked(m_sizeLeft);//Keep stream consistent: nothing is left to read
+            }
+            return *this;
         }
-        m_it += count;
+        advanceUnchecked(count);
         return *this;
     }
 
     QProtobufSelfcheckIterator &operator -=(int count) {
-        m_sizeLeft += count;
-        if (m_sizeLeft > m_containerSize) {
-            throw std::out_of_range("Container is less than required fields number. Deserialization failed");
-        }
-        m_it -= count;
-        return *this;
+        return *this += -count;
     }
 
-    QProtobufSelfcheckIterator &operator =(const QProtobufSelfcheckIterator &other) {
-        if (this == &other) {
-            return *this;
-        }
+    QProtobufSelfcheckIterator &operator =(const QProtobufSelfcheckIterator &other) = default;
 
-        m_containerSize = other.m_containerSize;
-        m_sizeLeft = other.m_sizeLeft;
-        if (m_sizeLeft > m_containerSize || m_sizeLeft < 0) {
-            throw std::out_of_range("Container is less than required fields number. Deserialization failed");
-        }
-        m_it = other.m_it;
-        return *this;
+    /*!
+     * \brief Moves iterator forward by \a count bytes without bounds check
+     *
+     * \details Is used by decoders that validated remaining size() once for the whole field.
+     *          \a count must not exceed size().
+     */
+    void advanceUnchecked(int count) {
+        Q_ASSERT(count <= m_sizeLeft);
+        m_sizeLeft -= count;
+        m_it += count;
     }
 
     bool operator ==(const QProtobufSelfcheckIterator &other) const {
@@ -130,6 +178,11 @@ public:
         return m_sizeLeft;
     }
 private:
+    static void reportOutOfRange() {
+        QtProtobufPrivate::reportDeserializationError(UnexpectedEndOfStreamError,
+                                                      "Container is less than required fields number. Deserialization failed");
+    }
+
     int m_sizeLeft;
     int m_containerSize;
     QByteArray::const_iterator m_it;
@@ -25,51 +25,447 @@
 
 #include "qprotobufserializer.h"
 #include "qprotobufserializer_p.h"
+#include "qprotobuffieldplan_p.h"
 
 #include "qprotobufmetaproperty.h"
 #include "qprotobufmetaobject.h"
+#include "qprotobufobject.h"
+#include "qprotobufbufferallocator.h"
+
+#include <QIODevice>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QSignalBlocker>
+#include <QHash>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 
 using namespace QtProtobuf;
 
+namespace {
+//Size cache of serialization that is in progress in current thread
+thread_local QProtobufSerializerPrivate::SizeCache *currentSizeCache = nullptr;
+
+/*!
+ * \private
+ * \brief The SizeCacheScope class makes \a cache current for the lifetime of the scope
+ */
+class SizeCacheScope
+{
+public:
+    SizeCacheScope(QProtobufSerializerPrivate::SizeCache *cache) : m_previous(currentSizeCache) {
+        currentSizeCache = cache;
+    }
+    ~SizeCacheScope() {
+        currentSizeCache = m_previous;
+    }
+private:
+    Q_DISABLE_COPY_MOVE(SizeCacheScope)
+    QProtobufSerializerPrivate::SizeCache *m_previous;
+};
+
+/*!
+ * \private
+ * \brief Destination of streaming serialization that is in progress in current thread
+ *
+ * \details Only \a buffer is flushed to \a device, temporary buffers used to serialize parts of the message
+ *          are kept as is. While \a pendingSizes is not zero, \a buffer contains positions that will be
+ *          patched later and can't be flushed.
+ */
+struct StreamSink {
+    QIODevice *device;
+    QByteArray *buffer;
+    int pendingSizes;
+    bool failed;
+};
+thread_local StreamSink *currentStreamSink = nullptr;
+
+/*!
+ * \private
+ * \brief The StreamSinkScope class makes \a sink current for the lifetime of the scope
+ */
+class StreamSinkScope
+{
+public:
+    StreamSinkScope(StreamSink *sink) : m_previous(currentStreamSink) {
+        currentStreamSink = sink;
+    }
+    ~StreamSinkScope() {
+        currentStreamSink = m_previous;
+    }
+private:
+    Q_DISABLE_COPY_MOVE(StreamSinkScope)
+    StreamSink *m_previous;
+};
+
+/*!
+ * \private
+ * \brief Nested messages written while message is serialized with encode cache enabled
+ *
+ * \details Message is not stored to cache if any of nested messages doesn't track its revision.
+ */
+struct EncodeCacheCollector {
+    std::vector<std::pair<const QObject *, quint64>> nested;
+    bool cacheable = true;
+};
+thread_local EncodeCacheCollector *currentEncodeCollector = nullptr;
+
+/*!
+ * \private
+ * \brief The EncodeCollectorScope class makes \a collector current for the lifetime of the scope
+ */
+class EncodeCollectorScope
+{
+public:
+    EncodeCollectorScope(EncodeCacheCollector *collector) : m_previous(currentEncodeCollector) {
+        currentEncodeCollector = collector;
+    }
+    ~EncodeCollectorScope() {
+        currentEncodeCollector = m_previous;
+    }
+private:
+    Q_DISABLE_COPY_MOVE(EncodeCollectorScope)
+    EncodeCacheCollector *m_previous;
+};
+
+//Minimum number of entries of encode cache, that are checked for destroyed messages
+const size_t EncodeCacheMinimumSweepSize = 64;
+
+//Set in threads that serialize part of repeated field in parallel, nested lists are serialized sequentially
+thread_local bool parallelListWorker = false;
+//Minimum number of list elements serialized by single thread
+const int ParallelListMinimumChunkSize = 256;
+
+/*!
+ * \private
+ * \brief The ListChunkTask class serializes range of repeated field elements to separate buffer
+ */
+class ListChunkTask : public QRunnable
+{
+public:
+    ListChunkTask(const QAbstractProtobufSerializer *serializer, const QObject *const *begin, const QObject *const *end,
+                  const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty, QSemaphore *finished) : m_serializer(serializer)
+      , m_begin(begin)
+      , m_end(end)
+      , m_metaObject(metaObject)
+      , m_metaProperty(metaProperty)
+      , m_finished(finished)
+      , m_deterministic(QtProtobufPrivate::isDeterministicSerialization()) {
+        setAutoDelete(false);
+    }
+
+    void run() override {
+        QtProtobufPrivate::DeterministicSerializationScope deterministicScope(m_deterministic);
+        const bool wasWorker = parallelListWorker;
+        parallelListWorker = true;
+        for (const QObject *const *it = m_begin; it != m_end; ++it) {
+            m_serializer->serializeListObjectTo(*it, m_metaObject, m_metaProperty, m_buffer);
+        }
+        parallelListWorker = wasWorker;
+        m_finished->release();
+    }
+
+    const QByteArray &buffer() const {
+        return m_buffer;
+    }
+
+private:
+    Q_DISABLE_COPY_MOVE(ListChunkTask)
+    const QAbstractProtobufSerializer *m_serializer;
+    const QObject *const *m_begin;
+    const QObject *const *m_end;
+    const QProtobufMetaObject &m_metaObject;
+    const QProtobufMetaProperty &m_metaProperty;
+    QSemaphore *m_finished;
+    QByteArray m_buffer;
+    bool m_deterministic;
+};
+
+/*!
+ * \private
+ * \brief The DeserializationModeScope class applies serializer options to deserialization in current thread
+ *        for the lifetime of the scope
+ */
+class DeserializationModeScope
+{
+public:
+    /*!
+     * \details Elements of message are taken from \a sharedElementBudget if it's set, e.g. when elements of
+     *          repeated fields are decoded by several threads. New budget is created otherwise.
+     */
+    DeserializationModeScope(const QProtobufSerializerPrivate *serializer, std::atomic<int> *sharedElementBudget = nullptr)
+      : m_previousZeroCopyBytes(QProtobufSerializerPrivate::zeroCopyBytes)
+      , m_previousLazyMessages(QProtobufSerializerPrivate::lazyMessages)
+      , m_previousPreserveUnknownFields(QProtobufSerializerPrivate::preserveUnknownFields)
+      , m_previousStringInternTable(QProtobufSerializerPrivate::stringInternTable)
+      , m_previousRecursionDepthLimit(QProtobufSerializerPrivate::recursionDepthLimit)
+      , m_previousElementCountLimit(QProtobufSerializerPrivate::elementCountLimit)
+      , m_previousElementBudget(QProtobufSerializerPrivate::elementBudget)
+      , m_elementBudget(serializer->maxTotalElementCount) {
+        QProtobufSerializerPrivate::zeroCopyBytes = serializer->zeroCopyBytesEnabled;
+        QProtobufSerializerPrivate::lazyMessages = serializer->lazyMessagesEnabled;
+        QProtobufSerializerPrivate::preserveUnknownFields = serializer->preserveUnknownFieldsEnabled;
+        QProtobufSerializerPrivate::stringInternTable = serializer->stringInterningEnabled ? &m_stringInternTable : nullptr;
+        QProtobufSerializerPrivate::recursionDepthLimit = serializer->maxRecursionDepth;
+        QProtobufSerializerPrivate::elementCountLimit = serializer->maxElementCount;
+        if (sharedElementBudget != nullptr) {
+            QProtobufSerializerPrivate::elementBudget = sharedElementBudget;
+        } else {
+            QProtobufSerializerPrivate::elementBudget = serializer->maxTotalElementCount > 0 ? &m_elementBudget : nullptr;
+        }
+    }
+    ~DeserializationModeScope() {
+        QProtobufSerializerPrivate::zeroCopyBytes = m_previousZeroCopyBytes;
+        QProtobufSerializerPrivate::lazyMessages = m_previousLazyMessages;
+        QProtobufSerializerPrivate::preserveUnknownFields = m_previousPreserveUnknownFields;
+        QProtobufSerializerPrivate::stringInternTable = m_previousStringInternTable;
+        QProtobufSerializerPrivate::recursionDepthLimit = m_previousRecursionDepthLimit;
+        QProtobufSerializerPrivate::elementCountLimit = m_previousElementCountLimit;
+        QProtobufSerializerPrivate::elementBudget = m_previousElementBudget;
+    }
+private:
+    Q_DISABLE_COPY_MOVE(DeserializationModeScope)
+    bool m_previousZeroCopyBytes;
+    bool m_previousLazyMessages;
+    bool m_previousPreserveUnknownFields;
+    QProtobufSerializerPrivate::StringInternTable *m_previousStringInternTable;
+    int m_previousRecursionDepthLimit;
+    int m_previousElementCountLimit;
+    std::atomic<int> *m_previousElementBudget;
+    std::atomic<int> m_elementBudget;
+    QProtobufSerializerPrivate::StringInternTable m_stringInternTable;
+};
+
+/*!
+ * \private
+ * \brief The RecursionDepthScope class sets nesting depth of message deserialized in current thread
+ *        for the lifetime of the scope
+ */
+class RecursionDepthScope
+{
+public:
+    RecursionDepthScope(int depth) : m_previous(QProtobufSerializerPrivate::recursionDepth) {
+        QProtobufSerializerPrivate::recursionDepth = depth;
+    }
+    ~RecursionDepthScope() {
+        QProtobufSerializerPrivate::recursionDepth = m_previous;
+    }
+private:
+    Q_DISABLE_COPY_MOVE(RecursionDepthScope)
+    int m_previous;
+};
+
+//Reports LimitExceededError if top-level message \a data exceeds size limit of \a serializer
+bool checkMessageSize(const QProtobufSerializerPrivate *serializer, const QByteArray &data)
+{
+    if (serializer->maxMessageSize > 0 && data.size() > serializer->maxMessageSize) {
+        QtProtobufPrivate::reportDeserializationError(LimitExceededError, "Message exceeds size limit. Deserialization failed");
+        return false;
+    }
+    return true;
+}
+
+//Minimum interval between warnings about skipped unknown fields, in milliseconds
+const qint64 UnknownFieldsWarningInterval = 1000;
+
+/*!
+ * \private
+ * \brief Records unknown field skipped by deserialization and reports skipped fields in single warning
+ *
+ * \details Warnings are written not more often than once per UnknownFieldsWarningInterval, each warning
+ *          contains totals of fields skipped since previous one. Nothing is counted if warnings are disabled.
+ */
+void warnUnknownFieldSkipped(int fieldNumber, WireTypes wireType, int bytesCount)
+{
+    static std::atomic<int> skippedFields{0};
+    static std::atomic<qint64> skippedBytes{0};
+    static std::atomic<qint64> lastWarningTime{-UnknownFieldsWarningInterval};
+    if (!qtprotobuflog().isWarningEnabled()) {
+        return;
+    }
+
+    skippedFields.fetch_add(1, std::memory_order_relaxed);
+    skippedBytes.fetch_add(bytesCount, std::memory_order_relaxed);
+    const qint64 now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    qint64 lastTime = lastWarningTime.load(std::memory_order_relaxed);
+    if (now - lastTime < UnknownFieldsWarningInterval
+            || !lastWarningTime.compare_exchange_strong(lastTime, now, std::memory_order_relaxed)) {
+        return;
+    }
+    qProtoWarning() << "Messages received contain unexpected/optional fields. Skipped"
+                    << skippedFields.exchange(0, std::memory_order_relaxed) << "fields,"
+                    << skippedBytes.exchange(0, std::memory_order_relaxed) << "bytes since previous warning."
+                    << "Last skipped field number:" << fieldNumber << ", WireType:" << wireType;
+}
+
+/*!
+ * \private
+ * \brief Element of repeated message field which decoding is deferred to be done in parallel
+ */
+struct DeferredMessage {
+    QObject *object;
+    const QProtobufMetaObject *metaObject;
+    QByteArray data;
+    int recursionDepth;
+};
+using DeferredMessages = std::vector<DeferredMessage>;
+//Elements of repeated message fields collected by parallel deserialization that is in progress in current thread
+thread_local DeferredMessages *currentDeferredMessages = nullptr;
+//Minimum size of message that is deserialized in parallel
+const int ParallelDecodeMinimumSize = 64 * 1024;
+//Minimum number of list elements deserialized by single thread
+const int ParallelDecodeMinimumChunkSize = 256;
+
+/*!
+ * \private
+ * \brief The DeferredMessagesScope class makes \a messages current for the lifetime of the scope
+ */
+class DeferredMessagesScope
+{
+public:
+    DeferredMessagesScope(DeferredMessages *messages) : m_previous(currentDeferredMessages) {
+        currentDeferredMessages = messages;
+    }
+    ~DeferredMessagesScope() {
+        currentDeferredMessages = m_previous;
+    }
+private:
+    Q_DISABLE_COPY_MOVE(DeferredMessagesScope)
+    DeferredMessages *m_previous;
+};
+
+/*!
+ * \private
+ * \brief The DeferredMessagesTask class deserializes range of deferred messages
+ *
+ * \details Errors are collected instead of thrown, since exceptions can't leave pool threads.
+ */
+class DeferredMessagesTask : public QRunnable
+{
+public:
+    DeferredMessagesTask(QProtobufSerializerPrivate *serializer, const DeferredMessage *begin, const DeferredMessage *end,
+                         QSemaphore *finished) : m_serializer(serializer)
+      , m_begin(begin)
+      , m_end(end)
+      , m_finished(finished)
+      , m_elementBudget(QProtobufSerializerPrivate::elementBudget)
+      , m_error(NoDeserializationError) {
+        setAutoDelete(false);
+    }
+
+    void run() override {
+        {
+            DeserializationModeScope modeScope(m_serializer, m_elementBudget);
+            QtProtobufPrivate::DeserializationErrorScope scope;
+            for (const DeferredMessage *it = m_begin; it != m_end && scope.error() == NoDeserializationError; ++it) {
+                RecursionDepthScope depthScope(it->recursionDepth);
+                const QSignalBlocker blocker(it->object);
+                m_serializer->deserializeMessage(it->object, *(it->metaObject), it->data);
+            }
+            m_error = scope.error();
+        }
+        if (m_finished != nullptr) {
+            m_finished->release();
+        }
+    }
+
+    DeserializationError error() const {
+        return m_error;
+    }
+
+private:
+    Q_DISABLE_COPY_MOVE(DeferredMessagesTask)
+    QProtobufSerializerPrivate *m_serializer;
+    const DeferredMessage *m_begin;
+    const DeferredMessage *m_end;
+    QSemaphore *m_finished;
+    std::atomic<int> *m_elementBudget;
+    DeserializationError m_error;
+};
+
+//Deserializes elements of repeated message fields which decoding was deferred, in parallel
+void deserializeDeferredMessages(QProtobufSerializerPrivate *serializer, const DeferredMessages &deferredMessages)
+{
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const int chunkCount = std::min<int>(pool->maxThreadCount() + 1, static_cast<int>(deferredMessages.size()) / ParallelDecodeMinimumChunkSize);
+    if (chunkCount < 2) {
+        for (const auto &message : deferredMessages) {
+            RecursionDepthScope depthScope(message.recursionDepth);
+            const QSignalBlocker blocker(message.object);
+            serializer->deserializeMessage(message.object, *message.metaObject, message.data);
+            if (QtProtobufPrivate::deserializationError() != NoDeserializationError) {
+                return;
+            }
+        }
+        return;
+    }
+
+    //First chunk is deserialized in current thread, other chunks are deserialized by pool threads
+    const size_t chunkSize = (deferredMessages.size() + chunkCount - 1) / chunkCount;
+    const DeferredMessage *data = deferredMessages.data();
+    QSemaphore finished;
+    std::vector<std::unique_ptr<DeferredMessagesTask>> tasks;
+    tasks.reserve(chunkCount);
+    tasks.emplace_back(new DeferredMessagesTask(serializer, data, data + chunkSize, nullptr));
+    for (size_t begin = chunkSize; begin < deferredMessages.size(); begin += chunkSize) {
+        const size_t end = std::min(begin + chunkSize, deferredMessages.size());
+        tasks.emplace_back(new DeferredMessagesTask(serializer, data + begin, data + end, &finished));
+        if (!pool->tryStart(tasks.back().get())) {
+            //No free threads in pool, chunk is deserialized in current thread
+            tasks.back()->run();
+        }
+    }
+    tasks.front()->run();
+    finished.acquire(static_cast<int>(tasks.size()) - 1);
+
+    //Errors are reported when all threads are finished, so exceptions don't leave messages in use
+    for (const auto &task : tasks) {
+        if (task->error() != NoDeserializationError) {
+            QtProtobufPrivate::reportDeserializationError(task->error(), "Unable to deserialize element of repeated field");
+            return;
+        }
+    }
+}
+
+//Returns unknown fields stored in object, or nullptr if message type doesn't store them
+inline QByteArray *unknownFieldsOf(const QObject *object, const QProtobufMetaObject &metaObject)
+{
+    if (QProtobufSerializerPrivate::skipUnknownFields) {
+        return nullptr;
+    }
+    return metaObject.unknownFields != nullptr ? metaObject.unknownFields(const_cast<QObject *>(object)) : nullptr;
+}
+}
+
 template<>
-QByteArray QProtobufSerializerPrivate::serializeListType<QByteArray>(const QByteArrayList &listValue, int &outFieldIndex)
+void QProtobufSerializerPrivate::serializeListType<QByteArray>(const QByteArrayList &listValue, int &outFieldIndex, QByteArray &buffer)
 {
     qProtoDebug() << __func__ << "listValue.count" << listValue.count() << "outFiledIndex" << outFieldIndex;
 
     if (listValue.count() <= 0) {
         outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
-        return QByteArray();
+        return;
     }
 
-    QByteArray serializedList;
     for (auto &value : listValue) {
-        serializedList.append(QProtobufSerializerPrivate::encodeHeader(outFieldIndex, LengthDelimited));
-        serializedList.append(serializeLengthDelimited(value));
+        QProtobufSerializerPrivate::encodeHeader(outFieldIndex, LengthDelimited, buffer);
+        serializeLengthDelimited(value, buffer);
     }
 
     outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
-    return serializedList;
-}
-
-template<>
-void QProtobufSerializerPrivate::deserializeList<QByteArray>(QProtobufSelfcheckIterator &it, QVariant &previousValue)
-{
-    qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
-
-    QByteArrayList list = previousValue.value<QByteArrayList>();
-    list.append(deserializeLengthDelimited(it));
-    previousValue.setValue(list);
 }
 
 template<>
-void QProtobufSerializerPrivate::deserializeList<QString>(QProtobufSelfcheckIterator &it, QVariant &previousValue)
+void QProtobufSerializerPrivate::deserializeList<QByteArray>(QProtobufSelfcheckIterator &it, QByteArrayList &previousValue)
 {
     qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
 
-    QStringList list = previousValue.value<QStringList>();
-    QByteArray value = deserializeLengthDelimited(it);
-    list.append(QString::fromUtf8(value));
-    previousValue.setValue(list);
+    previousValue.append(deserializeLengthDelimited(it));
 }
 
 QProtobufSerializer::~QProtobufSerializer() = default;
@@ -80,40 +476,357 @@ QProtobufSerializer::QProtobufSerializer() : dPtr(new QProtobufSerializerPrivate
 
 QByteArray QProtobufSerializer::serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject) const
 {
-    QByteArray result;
-    for (const auto &field : metaObject.propertyOrdering) {
-        int propertyIndex = field.second;
-        int fieldIndex = field.first;
-        Q_ASSERT_X(fieldIndex < 536870912 && fieldIndex > 0, "", "fieldIndex is out of range");
-        QMetaProperty metaProperty = metaObject.staticMetaObject.property(propertyIndex);
-        const char *propertyName = metaProperty.name();
-        QVariant propertyValue = object->property(propertyName);
-        result.append(dPtr->serializeProperty(propertyValue, QProtobufMetaProperty(metaProperty,
-                                                                                   fieldIndex,
-                                                                                   field.second)));
+    QtProtobufPrivate::DeterministicSerializationScope deterministicScope(dPtr->deterministicEnabled);
+    if (metaObject.directSerializer != nullptr) {
+        //Generated serializers contain basic fields only, size pre-calculation gives nothing for them
+        QByteArray result = QProtobufBufferAllocator::current()->allocate(0);
+        metaObject.directSerializer(object, result);
+        return result;
+    }
+
+    QProtobufSerializerPrivate::SizeCache sizeCache;
+    SizeCacheScope scope(&sizeCache);
+
+    //Sizes of all nested messages are calculated and cached at this point
+    QByteArray result = QProtobufBufferAllocator::current()->allocate(dPtr->messageSize(object, metaObject));
+    dPtr->serializeMessage(object, metaObject, result);
+    return result;
+}
+
+bool QProtobufSerializer::serializeMessageTo(const QObject *object, const QProtobufMetaObject &metaObject, QIODevice *device) const
+{
+    QtProtobufPrivate::DeterministicSerializationScope deterministicScope(dPtr->deterministicEnabled);
+    QProtobufSerializerPrivate::SizeCache sizeCache;
+    SizeCacheScope scope(&sizeCache);
+
+    //Sizes of all nested messages are calculated in advance, so length-delimited sections never need
+    //to be patched and may be written to device piece by piece
+    dPtr->messageSize(object, metaObject);
+
+    QProtobufBufferAllocator *allocator = QProtobufBufferAllocator::current();
+    QByteArray buffer = allocator->allocate(QProtobufSerializerPrivate::StreamChunkSize);
+    StreamSink sink{device, &buffer, 0, false};
+    {
+        StreamSinkScope sinkScope(&sink);
+        dPtr->serializeMessage(object, metaObject, buffer);
     }
 
+    if (!sink.failed && !buffer.isEmpty() && device->write(buffer) != buffer.size()) {
+        sink.failed = true;
+    }
+    allocator->release(std::move(buffer));
+    return !sink.failed;
+}
+
+QByteArray QProtobufSerializer::serializeMessages(const std::vector<const QObject *> &objects, const QProtobufMetaObject &metaObject) const
+{
+    QtProtobufPrivate::DeterministicSerializationScope deterministicScope(dPtr->deterministicEnabled);
+    QProtobufSerializerPrivate::SizeCache sizeCache;
+    SizeCacheScope scope(&sizeCache);
+
+    //Sizes of all messages are calculated first, so resulting buffer is allocated once
+    std::vector<int> sizes;
+    sizes.reserve(objects.size());
+    int totalSize = 0;
+    for (const QObject *object : objects) {
+        const int size = dPtr->messageSize(object, metaObject);
+        sizes.push_back(size);
+        totalSize += QProtobufSerializerPrivate::lengthDelimitedSize(size);
+    }
+
+    QByteArray result = QProtobufBufferAllocator::current()->allocate(totalSize);
+    for (size_t i = 0; i < objects.size(); ++i) {
+        QProtobufSerializerPrivate::serializeVarintCommon<uint32_t>(sizes[i], result);
+        dPtr->serializeMessage(objects[i], metaObject, result);
+    }
     return result;
 }
 
+QByteArray QProtobufSerializer::serializeMessageFields(const QObject *object, const QProtobufMetaObject &metaObject, const quint32 *fields) const
+{
+    QtProtobufPrivate::DeterministicSerializationScope deterministicScope(dPtr->deterministicEnabled);
+    QByteArray result;
+    dPtr->serializeFields(object, metaObject, fields, result);
+    return result;
+}
+
+int QProtobufSerializer::messageSize(const QObject *object, const QProtobufMetaObject &metaObject) const
+{
+    return dPtr->messageSize(object, metaObject);
+}
+
 void QProtobufSerializer::deserializeMessage(QObject *object, const QProtobufMetaObject &metaObject, const QByteArray &data) const
 {
-    for (QProtobufSelfcheckIterator it(data); it != data.end();) {
-        dPtr->deserializeProperty(object, metaObject, it);
+    DeserializationModeScope modeScope(dPtr.get());
+#ifdef QT_PROTOBUF_NO_EXCEPTIONS
+    //Errors are reported to the outer scope, if any
+    QtProtobufPrivate::DeserializationErrorScope scope;
+#endif
+    if (!checkMessageSize(dPtr.get(), data)) {
+        return;
+    }
+    if (!dPtr->parallelDecodeEnabled || currentDeferredMessages != nullptr || data.size() < ParallelDecodeMinimumSize) {
+        dPtr->deserializeMessage(object, metaObject, data);
+        return;
+    }
+
+    //Message is split first, elements of repeated message fields are only indexed and decoded afterwards
+    DeferredMessages deferredMessages;
+    {
+        DeferredMessagesScope deferredScope(&deferredMessages);
+        dPtr->deserializeMessage(object, metaObject, data);
+    }
+    if (QtProtobufPrivate::deserializationError() == NoDeserializationError) {
+        deserializeDeferredMessages(dPtr.get(), deferredMessages);
+    }
+}
+
+void QProtobufSerializer::deserializeMessageFields(QObject *object, const QProtobufMetaObject &metaObject, const QByteArray &data,
+                                                   const QProtobufFieldMask &fieldMask) const
+{
+    DeserializationModeScope modeScope(dPtr.get());
+#ifdef QT_PROTOBUF_NO_EXCEPTIONS
+    //Errors are reported to the outer scope, if any
+    QtProtobufPrivate::DeserializationErrorScope scope;
+#endif
+    if (!checkMessageSize(dPtr.get(), data)) {
+        return;
+    }
+    dPtr->deserializeMessage(object, metaObject, data, &fieldMask);
+}
+
+void QProtobufSerializer::mergeMessage(QObject *object, const QProtobufMetaObject &metaObject, const QByteArray &data) const
+{
+    DeserializationModeScope modeScope(dPtr.get());
+#ifdef QT_PROTOBUF_NO_EXCEPTIONS
+    //Errors are reported to the outer scope, if any
+    QtProtobufPrivate::DeserializationErrorScope scope;
+#endif
+    if (!checkMessageSize(dPtr.get(), data)) {
+        return;
+    }
+    //Mode is restored even if deserialization is interrupted by exception
+    struct MergeFieldsScope {
+        MergeFieldsScope() : previous(QProtobufSerializerPrivate::mergeFields) {
+            QProtobufSerializerPrivate::mergeFields = true;
+        }
+        ~MergeFieldsScope() {
+            QProtobufSerializerPrivate::mergeFields = previous;
+        }
+        bool previous;
+    } mergeScope;
+    dPtr->deserializeMessage(object, metaObject, data);
+}
+
+void QProtobufSerializer::setZeroCopyBytesEnabled(bool enabled)
+{
+    dPtr->zeroCopyBytesEnabled = enabled;
+}
+
+bool QProtobufSerializer::isZeroCopyBytesEnabled() const
+{
+    return dPtr->zeroCopyBytesEnabled;
+}
+
+void QProtobufSerializer::setLazyMessagesEnabled(bool enabled)
+{
+    dPtr->lazyMessagesEnabled = enabled;
+}
+
+bool QProtobufSerializer::isLazyMessagesEnabled() const
+{
+    return dPtr->lazyMessagesEnabled;
+}
+
+void QProtobufSerializer::setPreserveUnknownFieldsEnabled(bool enabled)
+{
+    dPtr->preserveUnknownFieldsEnabled = enabled;
+}
+
+bool QProtobufSerializer::isPreserveUnknownFieldsEnabled() const
+{
+    return dPtr->preserveUnknownFieldsEnabled;
+}
+
+void QProtobufSerializer::setStringInterningEnabled(bool enabled)
+{
+    dPtr->stringInterningEnabled = enabled;
+}
+
+bool QProtobufSerializer::isStringInterningEnabled() const
+{
+    return dPtr->stringInterningEnabled;
+}
+
+void QProtobufSerializer::setParallelListSerializationEnabled(bool enabled)
+{
+    dPtr->parallelListSerializationEnabled = enabled;
+}
+
+bool QProtobufSerializer::isParallelListSerializationEnabled() const
+{
+    return dPtr->parallelListSerializationEnabled;
+}
+
+void QProtobufSerializer::setDeterministicEnabled(bool enabled)
+{
+    if (dPtr->deterministicEnabled != enabled) {
+        //Order of map entries stored in cache depends on this option
+        dPtr->clearEncodeCache();
+    }
+    dPtr->deterministicEnabled = enabled;
+}
+
+bool QProtobufSerializer::isDeterministicEnabled() const
+{
+    return dPtr->deterministicEnabled;
+}
+
+void QProtobufSerializer::setEncodeCacheEnabled(bool enabled)
+{
+    dPtr->encodeCacheEnabled = enabled;
+    if (!enabled) {
+        dPtr->clearEncodeCache();
+    }
+}
+
+bool QProtobufSerializer::isEncodeCacheEnabled() const
+{
+    return dPtr->encodeCacheEnabled;
+}
+
+void QProtobufSerializer::clearEncodeCache()
+{
+    dPtr->clearEncodeCache();
+}
+
+void QProtobufSerializer::setParallelDecodeEnabled(bool enabled)
+{
+    dPtr->parallelDecodeEnabled = enabled;
+}
+
+bool QProtobufSerializer::isParallelDecodeEnabled() const
+{
+    return dPtr->parallelDecodeEnabled;
+}
+
+void QProtobufSerializer::setMaxMessageSize(int size)
+{
+    dPtr->maxMessageSize = std::max(size, 0);
+}
+
+int QProtobufSerializer::maxMessageSize() const
+{
+    return dPtr->maxMessageSize;
+}
+
+void QProtobufSerializer::setMaxRecursionDepth(int depth)
+{
+    dPtr->maxRecursionDepth = std::max(depth, 0);
+}
+
+int QProtobufSerializer::maxRecursionDepth() const
+{
+    return dPtr->maxRecursionDepth;
+}
+
+void QProtobufSerializer::setMaxElementCount(int count)
+{
+    dPtr->maxElementCount = std::max(count, 0);
+}
+
+int QProtobufSerializer::maxElementCount() const
+{
+    return dPtr->maxElementCount;
+}
+
+void QProtobufSerializer::setMaxTotalElementCount(int count)
+{
+    dPtr->maxTotalElementCount = std::max(count, 0);
+}
+
+int QProtobufSerializer::maxTotalElementCount() const
+{
+    return dPtr->maxTotalElementCount;
+}
+
+void QtProtobufPrivate::deserializeLazyMessage(QObject *object, const QProtobufMetaObject &metaObject, const QByteArray &payload)
+{
+    //Payload is owned by lazy pointer, nested messages of it are parsed lazily as well
+    static QProtobufSerializer lazySerializer;
+    static const bool lazySerializerInitialized = (lazySerializer.setLazyMessagesEnabled(true), true);
+    Q_UNUSED(lazySerializerInitialized)
+
+    QtProtobufPrivate::DeserializationErrorScope scope;
+    static_cast<const QAbstractProtobufSerializer &>(lazySerializer).deserializeMessage(object, metaObject, payload);
+    if (scope.error() != NoDeserializationError) {
+        qProtoWarning() << "Lazy message" << metaObject.staticMetaObject.className() << "is malformed, error:" << scope.error();
     }
 }
 
+uint QtProtobuf::qHashMessage(const QObject *object, const QProtobufMetaObject &metaObject, uint seed)
+{
+    //Unknown fields are not compared by generated equality operators, so they don't affect hash
+    static thread_local QProtobufSerializer hashSerializer;
+    bool previousSkipUnknownFields = QProtobufSerializerPrivate::skipUnknownFields;
+    QProtobufSerializerPrivate::skipUnknownFields = true;
+    QByteArray data = static_cast<const QAbstractProtobufSerializer &>(hashSerializer).serializeMessage(object, metaObject);
+    QProtobufSerializerPrivate::skipUnknownFields = previousSkipUnknownFields;
+    return qHash(data, seed);
+}
+
 QByteArray QProtobufSerializer::serializeObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty) const
 {
-    QByteArray result = QProtobufSerializerPrivate::encodeHeader(metaProperty.protoFieldIndex(), LengthDelimited);
-    result.append(QProtobufSerializerPrivate::prependLengthDelimitedSize(serializeMessage(object, metaObject)));
+    QByteArray result;
+    serializeObjectTo(object, metaObject, metaProperty, result);
     return result;
 }
 
+void QProtobufSerializer::serializeObjectTo(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty, QByteArray &buffer) const
+{
+    int size = 0;
+    if (QProtobufSerializerPrivate::cachedMessageSize(object, size)) {
+        QProtobufSerializerPrivate::encodeLengthDelimitedHeader(metaProperty.protoFieldIndex(), size, buffer);
+        dPtr->serializeMessage(object, metaObject, buffer);
+        return;
+    }
+
+    QProtobufSerializerPrivate::encodeHeader(metaProperty.protoFieldIndex(), LengthDelimited, buffer);
+
+    if (currentStreamSink != nullptr) {
+        ++currentStreamSink->pendingSizes;
+    }
+    const int sizePosition = QProtobufSerializerPrivate::beginLengthDelimited(buffer);
+    dPtr->serializeMessage(object, metaObject, buffer);
+    QProtobufSerializerPrivate::endLengthDelimited(buffer, sizePosition);
+    if (currentStreamSink != nullptr) {
+        --currentStreamSink->pendingSizes;
+    }
+}
+
+int QProtobufSerializer::objectSize(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty) const
+{
+    int size = 0;
+    if (!QProtobufSerializerPrivate::cachedMessageSize(object, size)) {
+        size = dPtr->messageSize(object, metaObject);
+        QProtobufSerializerPrivate::cacheMessageSize(object, size);
+    }
+    return QProtobufSerializerPrivate::headerSize(metaProperty.protoFieldIndex(), LengthDelimited)
+            + QProtobufSerializerPrivate::lengthDelimitedSize(size);
+}
+
 void QProtobufSerializer::deserializeObject(QObject *object, const QProtobufMetaObject &metaObject, QProtobufSelfcheckIterator &it) const
 {
-    QByteArray array = QProtobufSerializerPrivate::deserializeLengthDelimited(it);
-    deserializeMessage(object, metaObject, array);
+    if (QProtobufSerializerPrivate::recursionDepthLimit > 0
+            && QProtobufSerializerPrivate::recursionDepth >= QProtobufSerializerPrivate::recursionDepthLimit) {
+        QtProtobufPrivate::reportDeserializationError(LimitExceededError, "Message exceeds nesting depth limit. Deserialization failed");
+        return;
+    }
+
+    //Nested message is parsed in place, using view to the parent message buffer
+    QByteArray array = QProtobufSerializerPrivate::deserializeLengthDelimitedView(it);
+    RecursionDepthScope depthScope(QProtobufSerializerPrivate::recursionDepth + 1);
+    dPtr->deserializeMessage(object, metaObject, array);
 }
 
 QByteArray QProtobufSerializer::serializeListObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty) const
@@ -121,21 +834,100 @@ QByteArray QProtobufSerializer::serializeListObject(const QObject *object, const
     return serializeObject(object, metaObject, metaProperty);
 }
 
+void QProtobufSerializer::serializeListObjectTo(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty, QByteArray &buffer) const
+{
+    serializeObjectTo(object, metaObject, metaProperty, buffer);
+    QProtobufSerializerPrivate::flushStreamChunk(buffer);
+}
+
+void QProtobufSerializer::serializeListObjectsTo(const std::vector<const QObject *> &objects, const QProtobufMetaObject &metaObject,
+                                                 const QProtobufMetaProperty &metaProperty, QByteArray &buffer) const
+{
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const int chunkCount = std::min<int>(pool->maxThreadCount() + 1, static_cast<int>(objects.size()) / ParallelListMinimumChunkSize);
+    //Nested messages written by other threads are not collected by encode cache
+    if (!dPtr->parallelListSerializationEnabled || dPtr->encodeCacheEnabled || parallelListWorker || chunkCount < 2) {
+        QAbstractProtobufSerializer::serializeListObjectsTo(objects, metaObject, metaProperty, buffer);
+        return;
+    }
+
+    //First chunk is serialized in current thread directly to buffer, other chunks are serialized by pool threads
+    const size_t chunkSize = (objects.size() + chunkCount - 1) / chunkCount;
+    QSemaphore finished;
+    std::vector<std::unique_ptr<ListChunkTask>> tasks;
+    tasks.reserve(chunkCount - 1);
+    for (size_t begin = chunkSize; begin < objects.size(); begin += chunkSize) {
+        const size_t end = std::min(begin + chunkSize, objects.size());
+        tasks.emplace_back(new ListChunkTask(this, objects.data() + begin, objects.data() + end, metaObject, metaProperty, &finished));
+        if (!pool->tryStart(tasks.back().get())) {
+            //No free threads in pool, chunk is serialized in current thread
+            tasks.back()->run();
+        }
+    }
+
+    for (size_t i = 0; i < chunkSize; ++i) {
+        serializeListObjectTo(objects[i], metaObject, metaProperty, buffer);
+    }
+
+    finished.acquire(static_cast<int>(tasks.size()));
+    for (const auto &task : tasks) {
+        buffer.append(task->buffer());
+    }
+}
+
 bool QProtobufSerializer::deserializeListObject(QObject *object, const QProtobufMetaObject &metaObject, QProtobufSelfcheckIterator &it) const
 {
+    if (currentDeferredMessages != nullptr) {
+        //Element is skipped and decoded later, in parallel with other elements
+        QByteArray array = QProtobufSerializerPrivate::deserializeLengthDelimitedView(it);
+        if (QtProtobufPrivate::deserializationError() == NoDeserializationError) {
+            currentDeferredMessages->push_back({object, &metaObject, array, QProtobufSerializerPrivate::recursionDepth + 1});
+        }
+        return true;
+    }
+
     deserializeObject(object, metaObject, it);
     return true;
 }
 
 QByteArray QProtobufSerializer::serializeMapPair(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty) const
 {
-    QByteArray result = QProtobufSerializerPrivate::encodeHeader(metaProperty.protoFieldIndex(), LengthDelimited);
-    result.append(QProtobufSerializerPrivate::prependLengthDelimitedSize(
-                      dPtr->serializeProperty(key, QProtobufMetaProperty(metaProperty, 1, QString())) +
-                      dPtr->serializeProperty(value, QProtobufMetaProperty(metaProperty, 2, QString()))));
+    QByteArray result;
+    serializeMapPairTo(key, value, metaProperty, result);
     return result;
 }
 
+void QProtobufSerializer::serializeMapPairTo(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty, QByteArray &buffer) const
+{
+    const QString emptyJsonName;
+    const QProtobufMetaProperty keyProperty(metaProperty, 1, emptyJsonName);
+    const QProtobufMetaProperty valueProperty(metaProperty, 2, emptyJsonName);
+    if (currentSizeCache != nullptr) {
+        //Sizes of nested messages are cached already, so pair size calculation is cheap
+        const int size = dPtr->propertySize(key, keyProperty) + dPtr->propertySize(value, valueProperty);
+        QProtobufSerializerPrivate::encodeLengthDelimitedHeader(metaProperty.protoFieldIndex(), size, buffer);
+        dPtr->serializeProperty(key, keyProperty, buffer);
+        dPtr->serializeProperty(value, valueProperty, buffer);
+        QProtobufSerializerPrivate::flushStreamChunk(buffer);
+        return;
+    }
+
+    QProtobufSerializerPrivate::encodeHeader(metaProperty.protoFieldIndex(), LengthDelimited, buffer);
+    const int sizePosition = QProtobufSerializerPrivate::beginLengthDelimited(buffer);
+    dPtr->serializeProperty(key, keyProperty, buffer);
+    dPtr->serializeProperty(value, valueProperty, buffer);
+    QProtobufSerializerPrivate::endLengthDelimited(buffer, sizePosition);
+}
+
+int QProtobufSerializer::mapPairSize(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty) const
+{
+    const QString emptyJsonName;
+    const int size = dPtr->propertySize(key, QProtobufMetaProperty(metaProperty, 1, emptyJsonName))
+            + dPtr->propertySize(value, QProtobufMetaProperty(metaProperty, 2, emptyJsonName));
+    return QProtobufSerializerPrivate::headerSize(metaProperty.protoFieldIndex(), LengthDelimited)
+            + QProtobufSerializerPrivate::lengthDelimitedSize(size);
+}
+
 bool QProtobufSerializer::deserializeMapPair(QVariant &key, QVariant &value, QProtobufSelfcheckIterator &it) const
 {
     dPtr->deserializeMapPair(key, value, it);
@@ -146,9 +938,11 @@ QByteArray QProtobufSerializer::serializeEnum(int64 value, const QMetaEnum &/*me
 {
     WireTypes type = Varint;
     int fieldIndex = metaProperty.protoFieldIndex();
-    QByteArray result = QProtobufSerializerPrivate::serializeBasic<int64>(value, fieldIndex);
-    if (fieldIndex != QtProtobufPrivate::NotUsedFieldIndex) {
-        result.prepend(QProtobufSerializerPrivate::encodeHeader(metaProperty.protoFieldIndex(), type));
+    QByteArray result = QProtobufSerializerPrivate::encodeHeader(fieldIndex, type);
+    const int headerSize = result.size();
+    QProtobufSerializerPrivate::serializeBasic<int64>(value, fieldIndex, result);
+    if (fieldIndex == QtProtobufPrivate::NotUsedFieldIndex) {
+        result.remove(0, headerSize);
     }
     return result;
 }
@@ -157,31 +951,34 @@ QByteArray QProtobufSerializer::serializeEnumList(const QList<int64> &value, con
 {
     WireTypes type = LengthDelimited;
     int fieldIndex = metaProperty.protoFieldIndex();
-    QByteArray result = QProtobufSerializerPrivate::serializeListType<int64>(value, fieldIndex);
-    if (fieldIndex != QtProtobufPrivate::NotUsedFieldIndex) {
-        result.prepend(QProtobufSerializerPrivate::encodeHeader(metaProperty.protoFieldIndex(), type));
+    QByteArray result = QProtobufSerializerPrivate::encodeHeader(fieldIndex, type);
+    const int headerSize = result.size();
+    QProtobufSerializerPrivate::serializeListType<int64>(value, fieldIndex, result);
+    if (fieldIndex == QtProtobufPrivate::NotUsedFieldIndex) {
+        result.remove(0, headerSize);
     }
     return result;
 }
 
 void QProtobufSerializer::deserializeEnum(int64 &value, const QMetaEnum &/*metaEnum*/, QProtobufSelfcheckIterator &it) const
 {
-    QVariant variantValue;
-    QProtobufSerializerPrivate::deserializeBasic<int64>(it, variantValue);
-    value = variantValue.value<int64>();
+    QProtobufSerializerPrivate::deserializeBasic<int64>(it, value);
 }
 
 void QProtobufSerializer::deserializeEnumList(QList<int64> &value, const QMetaEnum &/*metaEnum*/, QProtobufSelfcheckIterator &it) const
 {
-    QVariant variantValue;
-    QProtobufSerializerPrivate::deserializeList<int64>(it, variantValue);
-    value = variantValue.value<QList<int64>>();
+    QProtobufSerializerPrivate::deserializeList<int64>(it, value);
 }
 
 QProtobufSerializerPrivate::QProtobufSerializerPrivate(QProtobufSerializer *q) : q_ptr(q)
 {
-    //if handlers is not empty intialization already done
-    if (handlers.empty()) {
+    registerBasicHandlers();
+}
+
+void QProtobufSerializerPrivate::registerBasicHandlers()
+{
+    //Basic handlers are registered once, by first caller
+    static const bool basicHandlersRegistered = [] {
         wrapSerializer<float, serializeBasic, deserializeBasic<float>, Fixed32>();
         wrapSerializer<double, serializeBasic, deserializeBasic<double>, Fixed64>();
         wrapSerializer<int32, serializeBasic, deserializeBasic<int32>, Varint>();
@@ -197,27 +994,64 @@ QProtobufSerializerPrivate::QProtobufSerializerPrivate(QProtobufSerializer *q) :
         wrapSerializer<bool, uint32, serializeBasic<uint32>, deserializeBasic<uint32>, Varint>();
         wrapSerializer<QString, serializeBasic, deserializeBasic<QString>, LengthDelimited>();
         wrapSerializer<QByteArray, serializeBasic, deserializeBasic<QByteArray>, LengthDelimited>();
+        //UTF-8 strings have the same wire format as bytes
+        wrapSerializer<utf8string, QByteArray, serializeBasic, deserializeBasic<QByteArray>, LengthDelimited>();
+
+        //Lists of scalars are written packed, but non-packed elements are accepted as well
+        wrapListSerializer<float, Fixed32>();
+        wrapListSerializer<double, Fixed64>();
+        wrapListSerializer<fixed32, Fixed32>();
+        wrapListSerializer<fixed64, Fixed64>();
+        wrapListSerializer<sfixed32, Fixed32>();
+        wrapListSerializer<sfixed64, Fixed64>();
+        wrapListSerializer<int32, Varint>();
+        wrapListSerializer<int64, Varint>();
+        wrapListSerializer<sint32, Varint>();
+        wrapListSerializer<sint64, Varint>();
+        wrapListSerializer<uint32, Varint>();
+        wrapListSerializer<uint64, Varint>();
+        //Repeated strings and bytes are not packed, serializers write header for each element
+        wrapSerializer<QStringList, QStringList, serializeListType<QString>, deserializeList<QString>, UnknownWireType>();
+        wrapSerializer<QByteArrayList, serializeListType, deserializeList<QByteArray>, UnknownWireType>();
+        return true;
+    }();
+    Q_UNUSED(basicHandlersRegistered)
+}
 
-        wrapSerializer<FloatList, serializeListType, deserializeList<float>, LengthDelimited>();
-        wrapSerializer<DoubleList, serializeListType, deserializeList<double>, LengthDelimited>();
-        wrapSerializer<fixed32List, serializeListType, deserializeList<fixed32>, LengthDelimited>();
-        wrapSerializer<fixed64List, serializeListType, deserializeList<fixed64>, LengthDelimited>();
-        wrapSerializer<sfixed32List, serializeListType, deserializeList<sfixed32>, LengthDelimited>();
-        wrapSerializer<sfixed64List, serializeListType, deserializeList<sfixed64>, LengthDelimited>();
-        wrapSerializer<int32List, serializeListType, deserializeList<int32>, LengthDelimited>();
-        wrapSerializer<int64List, serializeListType, deserializeList<int64>, LengthDelimited>();
-        wrapSerializer<sint32List, serializeListType, deserializeList<sint32>, LengthDelimited>();
-        wrapSerializer<sint64List, serializeListType, deserializeList<sint64>, LengthDelimited>();
-        wrapSerializer<uint32List, serializeListType, deserializeList<uint32>, LengthDelimited>();
-        wrapSerializer<uint64List, serializeListType, deserializeList<uint64>, LengthDelimited>();
-        wrapSerializer<QStringList, QStringList, serializeListType<QString>, deserializeList<QString>, LengthDelimited>();
-        wrapSerializer<QByteArrayList, serializeListType, deserializeList<QByteArray>, LengthDelimited>();
+QProtobufSerializerPrivate::SerializerRegistry &QProtobufSerializerPrivate::handlers()
+{
+    static SerializerRegistry _handlers;
+    return _handlers;
+}
+
+const QProtobufSerializerPrivate::SerializationHandlers *QProtobufSerializerPrivate::findHandlers(int userType)
+{
+    const SerializationHandlers *typeHandlers = handlers().find(userType);
+    if (typeHandlers != nullptr) {
+        return typeHandlers;
     }
+
+    const auto &complexHandler = QtProtobufPrivate::findHandler(userType);
+    if (complexHandler.serializer == nullptr && complexHandler.deserializer == nullptr) {
+        //Type is not registered yet, lookup result is not cached
+        return nullptr;
+    }
+    return handlers().insert(userType, {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, UnknownWireType, &complexHandler, nullptr, UnknownWireType});
 }
 
 void QProtobufSerializerPrivate::skipVarint(QProtobufSelfcheckIterator &it)
 {
-    while ((*it) & 0x80) {
+    if (it.size() >= maxVarintSize<uint64_t>()) {
+        uint64_t value = 0;
+        const int length = decodeBoundedVarint(it.data(), value);
+        if (length > 0) {
+            it.advanceUnchecked(length);
+            return;
+        }
+    }
+
+    //Iterator doesn't move outside of container, so the end of data is checked explicitly
+    while (it.size() > 0 && ((*it) & 0x80)) {
         ++it;
     }
     ++it;
@@ -225,9 +1059,47 @@ void QProtobufSerializerPrivate::skipVarint(QProtobufSelfcheckIterator &it)
 
 void QProtobufSerializerPrivate::skipLengthDelimited(QProtobufSelfcheckIterator &it)
 {
-    //Get length of lenght-delimited field
-    uint32 length = QProtobufSerializerPrivate::deserializeVarintCommon<uint32>(it);
-    it += length;
+    //Payload is skipped at once, after single bounds check
+    const uint32 length = QProtobufSerializerPrivate::deserializeVarintCommon<uint32>(it);
+    if (length > static_cast<uint32>(it.size())) {
+        QtProtobufPrivate::reportDeserializationError(UnexpectedEndOfStreamError,
+                                                      "Skipped field is out of message bounds. Deserialization failed");
+        it.advanceUnchecked(it.size());
+        return;
+    }
+    it.advanceUnchecked(static_cast<int>(length));
+}
+
+int QProtobufSerializerPrivate::countLengthDelimitedEntries(const QProtobufSelfcheckIterator &it, int fieldNumber)
+{
+    char header[maxVarintSize<uint32_t>()];
+    const int headerSize = encodeVarint<uint32_t>((fieldNumber << 3) | LengthDelimited, header);
+    const char *data = it.data();
+    const char *end = data + it.size();
+    int count = 0;
+    //Entries are not validated, counting stops at the first entry that doesn't fit to data
+    while (data < end) {
+        quint32 length = 0;
+        bool complete = false;
+        for (int shift = 0; data < end && shift < 32; shift += 7) {
+            const uchar byte = static_cast<uchar>(*data++);
+            length |= static_cast<quint32>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                complete = true;
+                break;
+            }
+        }
+        if (!complete || length > static_cast<quint32>(end - data)) {
+            break;
+        }
+        data += length;
+        ++count;
+        if (end - data < headerSize || std::memcmp(data, header, headerSize) != 0) {
+            break;
+        }
+        data += headerSize;
+    }
+    return count;
 }
 
 int QProtobufSerializerPrivate::skipSerializedFieldBytes(QProtobufSelfcheckIterator &it, WireTypes type)
@@ -248,79 +1120,539 @@ int QProtobufSerializerPrivate::skipSerializedFieldBytes(QProtobufSelfcheckItera
         break;
     case WireTypes::UnknownWireType:
     default:
-        throw std::invalid_argument("Cannot skip due to undefined length of the redundant field.");
+        QtProtobufPrivate::reportDeserializationError(InvalidFormatError, "Cannot skip due to undefined length of the redundant field.");
+        break;
     }
 
     return std::distance(initialIt, QByteArray::const_iterator(it));
 }
 
 
-QByteArray QProtobufSerializerPrivate::serializeProperty(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty)
+void QProtobufSerializerPrivate::serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject, QByteArray &buffer)
+{
+    const quint64 revision = encodeCacheEnabled ? metaObject.revisionOf(object) : 0;
+    if (revision == 0) {
+        //Changes of message that doesn't track revision can't be detected, so message that contains it isn't cached
+        if (currentEncodeCollector != nullptr) {
+            currentEncodeCollector->cacheable = false;
+        }
+        writeMessage(object, metaObject, buffer);
+        return;
+    }
+
+    EncodeCacheCollector *parent = currentEncodeCollector;
+    if (parent != nullptr) {
+        parent->nested.emplace_back(object, revision);
+    }
+
+    QByteArray encoded;
+    if (findEncoded(object, revision, encoded)) {
+        buffer.append(encoded);
+        return;
+    }
+
+    EncodeCacheCollector collector;
+    const int position = buffer.size();
+    {
+        EncodeCollectorScope scope(&collector);
+        writeMessage(object, metaObject, buffer);
+    }
+
+    //Streaming serialization flushes buffer while message is written, so its bytes are not available
+    if (!collector.cacheable || currentStreamSink != nullptr) {
+        if (parent != nullptr) {
+            parent->cacheable = false;
+        }
+        return;
+    }
+    storeEncoded(object, metaObject, revision, buffer.mid(position), std::move(collector.nested));
+}
+
+void QProtobufSerializerPrivate::writeMessage(const QObject *object, const QProtobufMetaObject &metaObject, QByteArray &buffer)
+{
+    const QByteArray *unknownFields = unknownFieldsOf(object, metaObject);
+    if (metaObject.directSerializer != nullptr) {
+        metaObject.directSerializer(object, buffer);
+        if (unknownFields != nullptr) {
+            buffer.append(*unknownFields);
+        }
+        return;
+    }
+
+    //Fields that were never set hold default values and are not visited
+    serializeFields(object, metaObject, metaObject.presenceOf(object), buffer);
+
+    //Unknown fields are written as received, without re-encoding
+    if (unknownFields != nullptr) {
+        buffer.append(*unknownFields);
+    }
+}
+
+void QProtobufSerializerPrivate::serializeFields(const QObject *object, const QProtobufMetaObject &metaObject, const quint32 *fields,
+                                                 QByteArray &buffer)
+{
+    const QProtobufFieldPlan &plan = metaObject.fieldPlan();
+    const quint32 *presence = metaObject.presenceOf(object);
+    plan.forEachPresentField(fields, [&](const QProtobufFieldPlanEntry &field) {
+        const int propertyIndex = field.orderingInfo.qtProperty;
+        int fieldIndex = field.fieldNumber;
+        Q_ASSERT_X(fieldIndex < 536870912 && fieldIndex > 0, "", "fieldIndex is out of range");
+
+        //Basic types are read from object directly, without boxing to QVariant
+        const SerializationHandlers *typeHandlers = field.handlers != nullptr ? field.handlers
+                                                                              : findHandlers(field.userType);
+        if (typeHandlers != nullptr && typeHandlers->propertySerializer != nullptr) {
+            const WireTypes type = typeHandlers->type;
+            const int headerPosition = buffer.size();
+            if (type == field.orderingInfo.wireType) {
+                //Header is precomputed by generator
+                buffer.append(field.orderingInfo.wireTag, field.orderingInfo.wireTagSize);
+            } else if (type != UnknownWireType) {
+                QProtobufSerializerPrivate::encodeHeader(fieldIndex, type, buffer);
+            }
+            typeHandlers->propertySerializer(object, propertyIndex, fieldIndex, buffer);
+            if (fieldIndex == QtProtobufPrivate::NotUsedFieldIndex
+                    && type != UnknownWireType) {
+                //Optional fields that are set are sent even with default value
+                if (plan.isExplicitlySet(field, presence)) {
+                    serializeDefaultValue(type, buffer);
+                } else {
+                    buffer.resize(headerPosition);
+                }
+            }
+            return;
+        }
+
+        const int fieldPosition = buffer.size();
+        QVariant propertyValue = field.metaProperty.read(object);
+        serializeProperty(propertyValue, field.metaProperty, buffer, typeHandlers);
+        if (buffer.size() == fieldPosition && plan.isExplicitlySet(field, presence)) {
+            encodeHeader(fieldIndex, field.orderingInfo.wireType, buffer);
+            serializeDefaultValue(field.orderingInfo.wireType, buffer);
+        }
+        flushStreamChunk(buffer);
+    });
+}
+
+void QProtobufSerializerPrivate::serializeProperty(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty, QByteArray &buffer,
+                                                   const SerializationHandlers *typeHandlers)
 {
     qProtoDebug() << __func__ << "propertyValue" << propertyValue << "fieldIndex" << metaProperty.protoFieldIndex()
                   << static_cast<QMetaType::Type>(propertyValue.type());
 
-    QByteArray result;
-    WireTypes type = UnknownWireType;
-
     int userType = propertyValue.userType();
 
     //TODO: replace with some common function
     int fieldIndex = metaProperty.protoFieldIndex();
-    auto basicIt = handlers.find(userType);
-    if (basicIt != handlers.end()) {
-        type = basicIt->second.type;
-        result.append(basicIt->second.serializer(propertyValue, fieldIndex));
-        if (fieldIndex != QtProtobufPrivate::NotUsedFieldIndex
+    if (typeHandlers == nullptr) {
+        typeHandlers = findHandlers(userType);
+    }
+    if (typeHandlers == nullptr) {
+        qProtoCritical() << "No serializer registered for type" << QMetaType::typeName(userType) << "field is skipped";
+        return;
+    }
+
+    if (typeHandlers->complexHandler == nullptr) {
+        WireTypes type = typeHandlers->type;
+        //Header is written in advance and dropped if serializer decides that field shouldn't be sent
+        const int headerPosition = buffer.size();
+        if (type != UnknownWireType) {
+            QProtobufSerializerPrivate::encodeHeader(fieldIndex, type, buffer);
+        }
+        typeHandlers->serializer(propertyValue, fieldIndex, buffer);
+        if (fieldIndex == QtProtobufPrivate::NotUsedFieldIndex
                 && type != UnknownWireType) {
-            result.prepend(QProtobufSerializerPrivate::encodeHeader(metaProperty.protoFieldIndex(), type));
+            buffer.resize(headerPosition);
         }
-    } else {
-        auto handler = QtProtobufPrivate::findHandler(userType);
-        handler.serializer(q_ptr, propertyValue, metaProperty, result);
+    } else if (typeHandlers->complexHandler->wireSerializer != nullptr) {
+        //Enumerations and maps of basic types are written without boxing of each element
+        typeHandlers->complexHandler->wireSerializer(propertyValue, fieldIndex, buffer);
+    } else if (typeHandlers->complexHandler->serializer != nullptr) {
+        typeHandlers->complexHandler->serializer(q_ptr, propertyValue, metaProperty, buffer);
     }
-    return result;
 }
 
-void QProtobufSerializerPrivate::deserializeProperty(QObject *object, const QProtobufMetaObject &metaObject, QProtobufSelfcheckIterator &it)
+void QProtobufSerializerPrivate::deserializeMessage(QObject *object, const QProtobufMetaObject &metaObject, const QByteArray &data,
+                                                    const QProtobufFieldMask *fieldMask)
+{
+    //Generated direct deserializer skips unknown fields, doesn't count elements of repeated fields and doesn't intern strings
+    if (metaObject.directDeserializer != nullptr && fieldMask == nullptr && !preserveUnknownFields && !mergeFields
+            && elementCountLimit == 0 && elementBudget == nullptr
+            && (stringInternTable == nullptr || !metaObject.fieldPlan().internsStrings)) {
+        //Sender of the same schema writes fields in known order, so field lookup is not needed
+        if (metaObject.orderedDeserializer != nullptr && metaObject.schemaFingerprint != 0
+                && metaObject.schemaFingerprint == QtProtobufPrivate::SchemaFingerprintScope::current()) {
+            metaObject.orderedDeserializer(object, data);
+        } else {
+            metaObject.directDeserializer(object, data);
+        }
+        return;
+    }
+
+    //Collected repeated fields are written to object even if deserialization is interrupted
+    struct RepeatedValuesCommit {
+        ~RepeatedValuesCommit() {
+            const auto &fields = metaObject.fieldPlan().fields;
+            for (size_t i = 0; i < values.size(); ++i) {
+                if (values[i].value.isValid()) {
+                    fields[i].metaProperty.write(object, values[i].value);
+                }
+            }
+        }
+        QObject *object;
+        const QProtobufMetaObject &metaObject;
+        RepeatedValues values;
+    } commit{object, metaObject, {}};
+
+    //Most senders write fields in field number order, so next field is predicted to follow the previous one
+    size_t expectedField = 0;
+    for (QProtobufSelfcheckIterator it(data); it != data.end()
+         && QtProtobufPrivate::deserializationError() == NoDeserializationError;) {
+        deserializeProperty(object, metaObject, it, commit.values, fieldMask, expectedField);
+    }
+}
+
+int QProtobufSerializerPrivate::messageSize(const QObject *object, const QProtobufMetaObject &metaObject)
+{
+    if (encodeCacheEnabled) {
+        QByteArray encoded;
+        const quint64 revision = metaObject.revisionOf(object);
+        if (revision != 0 && findEncoded(object, revision, encoded)) {
+            return encoded.size();
+        }
+    }
+
+    int size = 0;
+    const QProtobufFieldPlan &plan = metaObject.fieldPlan();
+    const quint32 *presence = metaObject.presenceOf(object);
+    plan.forEachPresentField(presence, [&](const QProtobufFieldPlanEntry &field) {
+        const int propertyIndex = field.orderingInfo.qtProperty;
+
+        const SerializationHandlers *typeHandlers = field.handlers != nullptr ? field.handlers
+                                                                              : findHandlers(field.userType);
+        if (typeHandlers != nullptr && typeHandlers->propertySizer != nullptr) {
+            const WireTypes type = typeHandlers->type;
+            int fieldIndex = field.fieldNumber;
+            const int valueSize = typeHandlers->propertySizer(object, propertyIndex, fieldIndex);
+            if (type == UnknownWireType) {
+                size += valueSize;
+            } else if (fieldIndex != QtProtobufPrivate::NotUsedFieldIndex) {
+                size += (type == field.orderingInfo.wireType ? field.orderingInfo.wireTagSize : headerSize(fieldIndex, type)) + valueSize;
+            } else if (plan.isExplicitlySet(field, presence)) {
+                size += (type == field.orderingInfo.wireType ? field.orderingInfo.wireTagSize : headerSize(field.fieldNumber, type))
+                        + defaultValueSize(type);
+            }
+            return;
+        }
+
+        QVariant propertyValue = field.metaProperty.read(object);
+        const int propertyValueSize = propertySize(propertyValue, field.metaProperty, typeHandlers);
+        if (propertyValueSize == 0 && plan.isExplicitlySet(field, presence)) {
+            size += headerSize(field.fieldNumber, field.orderingInfo.wireType) + defaultValueSize(field.orderingInfo.wireType);
+        } else {
+            size += propertyValueSize;
+        }
+    });
+
+    const QByteArray *unknownFields = unknownFieldsOf(object, metaObject);
+    if (unknownFields != nullptr) {
+        size += unknownFields->size();
+    }
+    return size;
+}
+
+int QProtobufSerializerPrivate::propertySize(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty,
+                                             const SerializationHandlers *typeHandlers)
+{
+    int userType = propertyValue.userType();
+    int fieldIndex = metaProperty.protoFieldIndex();
+    if (typeHandlers == nullptr) {
+        typeHandlers = findHandlers(userType);
+    }
+    if (typeHandlers == nullptr) {
+        return 0;
+    }
+
+    if (typeHandlers->complexHandler == nullptr) {
+        WireTypes type = typeHandlers->type;
+        int size = typeHandlers->sizer(propertyValue, fieldIndex);
+        if (type == UnknownWireType) {
+            return size;
+        }
+        return fieldIndex != QtProtobufPrivate::NotUsedFieldIndex ? headerSize(fieldIndex, type) + size : 0;
+    }
+
+    const auto &handler = *(typeHandlers->complexHandler);
+    if (handler.wireSizer) {
+        return handler.wireSizer(propertyValue, fieldIndex);
+    }
+
+    if (handler.sizer) {
+        return handler.sizer(q_ptr, propertyValue, metaProperty);
+    }
+
+    if (!handler.serializer) {
+        return 0;
+    }
+
+    //Handler is not able to calculate size, so the only way is to serialize the value
+    QProtobufBufferAllocator *allocator = QProtobufBufferAllocator::current();
+    QByteArray buffer = allocator->allocate(0);
+    handler.serializer(q_ptr, propertyValue, metaProperty, buffer);
+    const int size = buffer.size();
+    allocator->release(std::move(buffer));
+    return size;
+}
+
+bool QProtobufSerializerPrivate::findEncoded(const QObject *object, quint64 revision, QByteArray &data) const
+{
+    QMutexLocker locker(&encodeCacheMutex);
+    auto it = encodeCache.find(object);
+    if (it == encodeCache.end() || it->second.revision != revision || !isEncodedValid(it->second)) {
+        return false;
+    }
+    data = it->second.data;
+    return true;
+}
+
+bool QProtobufSerializerPrivate::isEncodedValid(const EncodedMessage &entry) const
+{
+    if (entry.object.isNull() || entry.metaObject->revisionOf(entry.object.data()) != entry.revision) {
+        return false;
+    }
+
+    //Nested messages could be changed by their own setters, without change of the message that holds them
+    for (const auto &nested : entry.nested) {
+        auto it = encodeCache.find(nested.first);
+        if (it == encodeCache.end() || it->second.revision != nested.second || !isEncodedValid(it->second)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void QProtobufSerializerPrivate::storeEncoded(const QObject *object, const QProtobufMetaObject &metaObject, quint64 revision,
+                                              QByteArray &&data, std::vector<std::pair<const QObject *, quint64>> &&nested)
+{
+    QMutexLocker locker(&encodeCacheMutex);
+    if (encodeCache.size() >= encodeCacheSweepSize) {
+        for (auto it = encodeCache.begin(); it != encodeCache.end();) {
+            it = it->second.object.isNull() ? encodeCache.erase(it) : std::next(it);
+        }
+        encodeCacheSweepSize = std::max(EncodeCacheMinimumSweepSize, encodeCache.size() * 2);
+    }
+
+    EncodedMessage &entry = encodeCache[object];
+    entry.object = const_cast<QObject *>(object);
+    entry.metaObject = &metaObject;
+    entry.revision = revision;
+    entry.data = std::move(data);
+    entry.nested = std::move(nested);
+}
+
+void QProtobufSerializerPrivate::clearEncodeCache()
+{
+    QMutexLocker locker(&encodeCacheMutex);
+    encodeCache.clear();
+    encodeCacheSweepSize = 0;
+}
+
+void QProtobufSerializerPrivate::cacheMessageSize(const QObject *object, int size)
+{
+    if (currentSizeCache != nullptr) {
+        (*currentSizeCache)[object] = size;
+    }
+}
+
+void QProtobufSerializerPrivate::flushStreamChunk(QByteArray &buffer)
+{
+    if (currentStreamSink == nullptr || currentStreamSink->buffer != &buffer
+            || currentStreamSink->pendingSizes > 0 || buffer.size() < StreamChunkSize) {
+        return;
+    }
+
+    if (!currentStreamSink->failed && currentStreamSink->device->write(buffer) != buffer.size()) {
+        qProtoWarning() << "Unable to write serialized message to device:" << currentStreamSink->device->errorString();
+        currentStreamSink->failed = true;
+    }
+    //Reserved capacity is kept, so buffer is reused for the next chunk
+    buffer.resize(0);
+}
+
+bool QProtobufSerializerPrivate::cachedMessageSize(const QObject *object, int &size)
+{
+    if (currentSizeCache == nullptr) {
+        return false;
+    }
+
+    auto it = currentSizeCache->find(object);
+    if (it == currentSizeCache->end()) {
+        return false;
+    }
+    size = it->second;
+    return true;
+}
+
+QString QProtobufSerializerPrivate::internString(const QByteArray &utf8)
+{
+    //Table is bounded, so fields of high cardinality don't hold every received value
+    constexpr int MaxInternedStrings = 4096;
+    auto it = stringInternTable->constFind(utf8);
+    if (it != stringInternTable->constEnd()) {
+        return *it;
+    }
+    QString value = QString::fromUtf8(utf8);
+    if (stringInternTable->size() < MaxInternedStrings) {
+        //Payload is view to deserialized buffer, so key is copied
+        stringInternTable->insert(QByteArray(utf8.constData(), utf8.size()), value);
+    }
+    return value;
+}
+
+void QProtobufSerializerPrivate::deserializeProperty(QObject *object, const QProtobufMetaObject &metaObject, QProtobufSelfcheckIterator &it,
+                                                     RepeatedValues &repeatedValues, const QProtobufFieldMask *fieldMask,
+                                                     size_t &expectedField)
 {
     //Each iteration we expect iterator is setup to beginning of next chunk
+    const char *fieldBegin = it.data();
     int fieldNumber = QtProtobufPrivate::NotUsedFieldIndex;
     WireTypes wireType = UnknownWireType;
     if (!QProtobufSerializerPrivate::decodeHeader(it, fieldNumber, wireType)) {
         qProtoCritical() << "Message received doesn't contains valid header byte. "
                             "Trying next, but seems stream is broken" << QString::number((*it), 16);
-        throw std::invalid_argument("Message received doesn't contains valid header byte. "
-                              "Seems stream is broken");
+        QtProtobufPrivate::reportDeserializationError(InvalidHeaderError, "Message received doesn't contains valid header byte. "
+                                                                          "Seems stream is broken");
+        return;
     }
 
-    auto propertyNumberIt = metaObject.propertyOrdering.find(fieldNumber);
+    //Masked out fields are skipped the same way as unknown ones, but silently
+    if (fieldMask != nullptr && !fieldMask->contains(fieldNumber)) {
+        skipSerializedFieldBytes(it, wireType);
+        return;
+    }
+
+    //Predicted field is checked first, then the previous one, that is repeated by non-packed lists and map entries
+    const auto &ordering = metaObject.propertyOrdering;
+    auto propertyNumberIt = ordering.end();
+    if (expectedField < ordering.size() && (ordering.begin() + expectedField)->first == fieldNumber) {
+        propertyNumberIt = ordering.begin() + expectedField;
+    } else if (expectedField > 0 && expectedField <= ordering.size() && (ordering.begin() + expectedField - 1)->first == fieldNumber) {
+        propertyNumberIt = ordering.begin() + expectedField - 1;
+    } else {
+        propertyNumberIt = ordering.find(fieldNumber);
+    }
     if (propertyNumberIt == std::end(metaObject.propertyOrdering)) {
-        auto bytesCount = QProtobufSerializerPrivate::skipSerializedFieldBytes(it, wireType);
-        qProtoWarning() << "Message received contains unexpected/optional field. WireType:" << wireType
-                        << ", field number: " << fieldNumber << "Skipped:" << (bytesCount + 1) << "bytes";
+        QProtobufSerializerPrivate::skipSerializedFieldBytes(it, wireType);
+        QtProtobufPrivate::StatisticsScope::unknownFieldSkipped();
+        QByteArray *unknownFields = preserveUnknownFields ? unknownFieldsOf(object, metaObject) : nullptr;
+        if (unknownFields != nullptr) {
+            //Field is stored with its header, as is
+            if (QtProtobufPrivate::deserializationError() == NoDeserializationError) {
+                unknownFields->append(fieldBegin, static_cast<int>(it.data() - fieldBegin));
+            }
+            return;
+        }
+        warnUnknownFieldSkipped(fieldNumber, wireType, static_cast<int>(it.data() - fieldBegin));
         return;
     }
 
-    int propertyIndex = propertyNumberIt->second;
-    QMetaProperty metaProperty = metaObject.staticMetaObject.property(propertyIndex);
+    const auto &fields = metaObject.fieldPlan().fields;
+    const size_t fieldPosition = static_cast<size_t>(propertyNumberIt - metaObject.propertyOrdering.begin());
+    const auto &field = fields[fieldPosition];
+    expectedField = fieldPosition + 1;
+
+    //Message payload is stored as is and parsed at first access, merge requires the message to be decoded
+    if (lazyMessages && !mergeFields && field.orderingInfo.lazySetter != nullptr && wireType == LengthDelimited) {
+        const QByteArray payload = deserializeLengthDelimitedView(it);
+        if (QtProtobufPrivate::deserializationError() == NoDeserializationError) {
+            field.orderingInfo.lazySetter(object, QByteArray(payload.constData(), payload.size()));
+        }
+        return;
+    }
+    const int propertyIndex = field.orderingInfo.qtProperty;
+    const QMetaProperty &metaProperty = field.metaProperty;
 
     qProtoDebug() << __func__ << " wireType: " << wireType << " metaProperty: " << metaProperty.typeName()
                   << "currentByte:" << QString::number((*it), 16);
 
-    QVariant newPropertyValue;
-    newPropertyValue = metaProperty.read(object);
-    int userType = metaProperty.userType();
+    const SerializationHandlers *typeHandlers = field.handlers != nullptr ? field.handlers
+                                                                          : findHandlers(field.userType);
+    if (typeHandlers == nullptr
+            || (typeHandlers->complexHandler != nullptr && typeHandlers->complexHandler->deserializer == nullptr)) {
+        QtProtobufPrivate::reportDeserializationError(NoDeserializerError, "No deserializer registered for type of received field");
+        return;
+    }
 
-    //TODO: replace with some common function
-    auto basicIt = handlers.find(userType);
-    if (basicIt != handlers.end()) {
-        basicIt->second.deserializer(it, newPropertyValue);
-    } else {
-        auto handler = QtProtobufPrivate::findHandler(userType);
-        handler.deserializer(q_ptr, it, newPropertyValue);
+    //Mode is restored even if deserialization is interrupted by exception
+    struct InternStringsScope {
+        InternStringsScope(bool enabled) : previous(QProtobufSerializerPrivate::internStrings) {
+            QProtobufSerializerPrivate::internStrings = enabled;
+        }
+        ~InternStringsScope() {
+            QProtobufSerializerPrivate::internStrings = previous;
+        }
+        bool previous;
+    } internScope(stringInternTable != nullptr && field.descriptor != nullptr && field.descriptor->internStrings);
+
+    //Lists of scalars and enumerations may be received packed or element by element, in any mix
+    const bool isEnumList = typeHandlers->complexHandler != nullptr && typeHandlers->complexHandler->wireElementDeserializer != nullptr;
+    const bool isScalarList = typeHandlers->elementDeserializer != nullptr;
+    const bool isNonPackedElement = (isScalarList || isEnumList) && wireType != LengthDelimited;
+    if (isNonPackedElement && wireType != (isScalarList ? typeHandlers->elementType : Varint)) {
+        QtProtobufPrivate::reportDeserializationError(InvalidFormatError, "Wire type of received field doesn't match type of list elements");
+        return;
+    }
+
+    //Elements of repeated fields are accumulated and written to object once
+    const bool isRepeated = isScalarList || (typeHandlers->complexHandler == nullptr ? typeHandlers->type == UnknownWireType
+                                                                                    : typeHandlers->complexHandler->type != QtProtobufPrivate::ObjectHandler);
+    if (isRepeated) {
+        if (repeatedValues.empty()) {
+            repeatedValues.resize(fields.size());
+        }
+        RepeatedValue &repeated = repeatedValues[fieldPosition];
+        //Elements of scalar lists are counted by their deserializers
+        if (!isScalarList && (!checkElementCount(++repeated.count) || !consumeElements(1))) {
+            return;
+        }
+        QVariant &repeatedValue = repeated.value;
+        if (!repeatedValue.isValid()) {
+            //Merged repeated fields are replaced by the received elements
+            repeatedValue = mergeFields ? QVariant(field.userType, nullptr) : metaProperty.read(object);
+            //Hash maps are allocated once for all entries that follow each other
+            if (typeHandlers->complexHandler != nullptr && typeHandlers->complexHandler->type == QtProtobufPrivate::MapHandler
+                    && typeHandlers->complexHandler->reserve != nullptr) {
+                typeHandlers->complexHandler->reserve(repeatedValue, countLengthDelimitedEntries(it, fieldNumber));
+            }
+        }
+        if (isNonPackedElement) {
+            if (isScalarList) {
+                typeHandlers->elementDeserializer(it, repeatedValue);
+            } else {
+                typeHandlers->complexHandler->wireElementDeserializer(it, repeatedValue);
+            }
+        } else if (typeHandlers->complexHandler == nullptr) {
+            typeHandlers->deserializer(it, repeatedValue);
+        } else if (typeHandlers->complexHandler->wireDeserializer != nullptr) {
+            typeHandlers->complexHandler->wireDeserializer(it, repeatedValue);
+        } else {
+            typeHandlers->complexHandler->deserializer(q_ptr, it, repeatedValue);
+        }
+        return;
     }
 
+    //Basic types are written to object directly, without boxing to QVariant
+    if (typeHandlers->complexHandler == nullptr) {
+        typeHandlers->propertyDeserializer(object, propertyIndex, it);
+        return;
+    }
+
+    QVariant newPropertyValue = metaProperty.read(object);
+    if (typeHandlers->complexHandler->wireDeserializer != nullptr) {
+        typeHandlers->complexHandler->wireDeserializer(it, newPropertyValue);
+    } else {
+        typeHandlers->complexHandler->deserializer(q_ptr, it, newPropertyValue);
+    }
     metaProperty.write(object, newPropertyValue);
 }
 
@@ -331,25 +1663,40 @@ void QProtobufSerializerPrivate::deserializeMapPair(QVariant &key, QVariant &val
     unsigned int count = QProtobufSerializerPrivate::deserializeVarintCommon<uint32>(it);
     qProtoDebug() << __func__ << "count:" << count;
     QProtobufSelfcheckIterator last = it + count;
-    while (it != last) {
+    while (it != last && QtProtobufPrivate::deserializationError() == NoDeserializationError) {
         QProtobufSerializerPrivate::decodeHeader(it, mapIndex, type);
         if (mapIndex == 1) {
             //Only simple types are supported as keys
-            int userType = key.userType();
-            auto &handler = handlers.at(userType);//throws if not found
-            handler.deserializer(it, key);
+            const SerializationHandlers *keyHandlers = findHandlers(key.userType());
+            if (keyHandlers == nullptr || keyHandlers->complexHandler != nullptr) {
+                QtProtobufPrivate::reportDeserializationError(NoDeserializerError, "Only basic types are supported as map keys");
+                return;
+            }
+            keyHandlers->deserializer(it, key);
         } else {
-            //TODO: replace with some common function
-            int userType = value.userType();
-            auto basicIt = handlers.find(userType);
-            if (basicIt != handlers.end()) {
-                basicIt->second.deserializer(it, value);
+            const SerializationHandlers *valueHandlers = findHandlers(value.userType());
+            if (valueHandlers == nullptr
+                    || (valueHandlers->complexHandler != nullptr && valueHandlers->complexHandler->deserializer == nullptr)) {
+                QtProtobufPrivate::reportDeserializationError(NoDeserializerError, "No deserializer registered for type of map value");
+                return;
+            }
+            if (valueHandlers->complexHandler == nullptr) {
+                valueHandlers->deserializer(it, value);
             } else {
-                auto handler = QtProtobufPrivate::findHandler(userType);
-                handler.deserializer(q_ptr, it, value);//throws if not implemented
+                valueHandlers->complexHandler->deserializer(q_ptr, it, value);
             }
         }
     }
 }
 
-QProtobufSerializerPrivate::SerializerRegistry QProtobufSerializerPrivate::handlers = {};
+thread_local bool QProtobufSerializerPrivate::zeroCopyBytes = false;
+thread_local bool QProtobufSerializerPrivate::lazyMessages = false;
+thread_local bool QProtobufSerializerPrivate::preserveUnknownFields = false;
+thread_local bool QProtobufSerializerPrivate::mergeFields = false;
+thread_local QProtobufSerializerPrivate::StringInternTable *QProtobufSerializerPrivate::stringInternTable = nullptr;
+thread_local bool QProtobufSerializerPrivate::internStrings = false;
+thread_local bool QProtobufSerializerPrivate::skipUnknownFields = false;
+thread_local int QProtobufSerializerPrivate::recursionDepthLimit = 0;
+thread_local int QProtobufSerializerPrivate::elementCountLimit = 0;
+thread_local int QProtobufSerializerPrivate::recursionDepth = 0;
+thread_local std::atomic<int> *QProtobufSerializerPrivate::elementBudget = nullptr;
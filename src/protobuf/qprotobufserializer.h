@@ -41,17 +41,166 @@ public:
     QProtobufSerializer();
     ~QProtobufSerializer();
 
+    /*!
+     * \brief Enables zero-copy deserialization of bytes fields
+     *
+     * \details When enabled, deserialized bytes fields are QByteArray::fromRawData views to the
+     *          deserialized buffer instead of its copies. The buffer must outlive the deserialized
+     *          messages and must not be modified while they are in use. Disabled by default.
+     *          Nested messages and strings are always parsed without intermediate copies.
+     */
+    void setZeroCopyBytesEnabled(bool enabled);
+    bool isZeroCopyBytesEnabled() const;
+
+    /*!
+     * \brief Enables lazy parsing of message fields
+     *
+     * \details When enabled, payload of singular message fields is copied and parsed at first access to the field.
+     *          Errors in lazily parsed payload are logged and don't throw. Disabled by default.
+     */
+    void setLazyMessagesEnabled(bool enabled);
+    bool isLazyMessagesEnabled() const;
+
+    /*!
+     * \brief Enables preservation of unknown fields
+     *
+     * \details When enabled, fields that are not known by message type are stored in message as received, and
+     *          written back without re-encoding when message is serialized. Unknown fields are skipped with a
+     *          warning otherwise. Disabled by default. Stored unknown fields are serialized regardless of this option.
+     */
+    void setPreserveUnknownFieldsEnabled(bool enabled);
+    bool isPreserveUnknownFieldsEnabled() const;
+
+    /*!
+     * \brief Enables interning of decoded strings
+     *
+     * \details When enabled, equal values of string fields that are marked for interning by INTERN_STRINGS generator
+     *          option share single implicitly shared QString within each deserialized message, including its nested
+     *          messages and elements of repeated fields. It saves memory and allocations when the same few values are
+     *          received many times, e.g. in long lists. Up to 4096 distinct values are interned per deserialization.
+     *          Fields that are not marked are not affected. Disabled by default.
+     */
+    void setStringInterningEnabled(bool enabled);
+    bool isStringInterningEnabled() const;
+
+    /*!
+     * \brief Enables parallel serialization of long repeated message fields
+     *
+     * \details When enabled, elements of repeated message fields that contain at least 1024 messages are
+     *          serialized by QThreadPool::globalInstance() threads to separate buffers, that are concatenated
+     *          in order afterwards. Messages must not be modified while serialization is in progress.
+     *          Disabled by default.
+     */
+    void setParallelListSerializationEnabled(bool enabled);
+    bool isParallelListSerializationEnabled() const;
+
+    /*!
+     * \brief Enables deterministic serialization
+     *
+     * \details Fields are always written in field number order and QMap fields in key order. When enabled,
+     *          entries of QHash map fields are written in key order too, so equal messages are serialized
+     *          to equal bytes, that may be hashed or compared. Disabled by default, since sorting of hash
+     *          keys takes extra time.
+     */
+    void setDeterministicEnabled(bool enabled);
+    bool isDeterministicEnabled() const;
+
+    /*!
+     * \brief Enables cache of serialized messages
+     *
+     * \details When enabled, serialized bytes of messages and of their nested messages are stored and written
+     *          again while messages are not changed. So when the same message is serialized repeatedly, only its
+     *          changed parts are encoded. Changes are detected by revisions of messages, that are updated by
+     *          generated setters, including setters of nested messages. Lists and maps modified through references
+     *          returned by getters and unknown fields stored by in-place deserialization are not tracked, use
+     *          setters or clearEncodeCache() in this case. Cache keeps copy of serialized bytes of every message
+     *          it holds, entries of destroyed messages are dropped eventually. Parallel list serialization is not
+     *          used while cache is enabled. Disabled by default.
+     */
+    void setEncodeCacheEnabled(bool enabled);
+    bool isEncodeCacheEnabled() const;
+
+    /*!
+     * \brief Drops all messages stored in encode cache
+     */
+    void clearEncodeCache();
+
+    /*!
+     * \brief Enables parallel deserialization of repeated message fields
+     *
+     * \details When enabled, messages that are 64 KiB or longer are deserialized in two passes. First pass
+     *          decodes the message and finds bounds of elements of repeated message fields, without decoding
+     *          the elements. Then the elements are decoded by QThreadPool::globalInstance() threads.
+     *          Disabled by default.
+     */
+    void setParallelDecodeEnabled(bool enabled);
+    bool isParallelDecodeEnabled() const;
+
+    /*!
+     * \brief Sets maximum size in bytes of top-level message accepted by deserializer
+     *
+     * \details Longer messages are rejected with LimitExceededError before any field is decoded.
+     *          0 means no limit, that is default.
+     */
+    void setMaxMessageSize(int size);
+    int maxMessageSize() const;
+
+    /*!
+     * \brief Sets maximum nesting depth of messages accepted by deserializer
+     *
+     * \details Top-level message has depth 0. Deserialization of message fields nested deeper is interrupted
+     *          with LimitExceededError, so recursive message types can't exhaust stack. 0 means no limit.
+     *          Default is 100.
+     */
+    void setMaxRecursionDepth(int depth);
+    int maxRecursionDepth() const;
+
+    /*!
+     * \brief Sets maximum number of elements of single repeated or map field accepted by deserializer
+     *
+     * \details Deserialization is interrupted with LimitExceededError when received field contains more elements.
+     *          0 means no limit, that is default. Generated direct deserializers are not used when limit is set.
+     */
+    void setMaxElementCount(int count);
+    int maxElementCount() const;
+
+    /*!
+     * \brief Sets maximum number of elements of all repeated and map fields of message, including nested messages
+     *
+     * \details Unlike maxElementCount(), limits memory that single message may take when elements are spread
+     *          over many fields and nesting levels. Elements are counted while they are received, so
+     *          deserialization is interrupted with LimitExceededError as soon as limit is reached. Packed field
+     *          counts as one more element. 0 means no limit, that is default. Generated direct deserializers are not
+     *          used when limit is set.
+     */
+    void setMaxTotalElementCount(int count);
+    int maxTotalElementCount() const;
+
 protected:
     QByteArray serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject) const override;
+    bool serializeMessageTo(const QObject *object, const QProtobufMetaObject &metaObject, QIODevice *device) const override;
+    QByteArray serializeMessages(const std::vector<const QObject *> &objects, const QProtobufMetaObject &metaObject) const override;
+    QByteArray serializeMessageFields(const QObject *object, const QProtobufMetaObject &metaObject, const quint32 *fields) const override;
     void deserializeMessage(QObject *object, const QProtobufMetaObject &metaObject, const QByteArray &data) const override;
+    void deserializeMessageFields(QObject *object, const QProtobufMetaObject &metaObject, const QByteArray &data,
+                                  const QProtobufFieldMask &fieldMask) const override;
+    void mergeMessage(QObject *object, const QProtobufMetaObject &metaObject, const QByteArray &data) const override;
+    int messageSize(const QObject *object, const QProtobufMetaObject &metaObject) const override;
 
     QByteArray serializeObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty) const override;
+    void serializeObjectTo(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty, QByteArray &buffer) const override;
+    int objectSize(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty) const override;
     void deserializeObject(QObject *object, const QProtobufMetaObject &metaObject, QProtobufSelfcheckIterator &it) const override;
 
     QByteArray serializeListObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty) const override;
+    void serializeListObjectTo(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty, QByteArray &buffer) const override;
+    void serializeListObjectsTo(const std::vector<const QObject *> &objects, const QProtobufMetaObject &metaObject,
+                                const QProtobufMetaProperty &metaProperty, QByteArray &buffer) const override;
     bool deserializeListObject(QObject *object, const QProtobufMetaObject &metaObject, QProtobufSelfcheckIterator &it) const override;
 
     QByteArray serializeMapPair(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty) const override;
+    void serializeMapPairTo(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty, QByteArray &buffer) const override;
+    int mapPairSize(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty) const override;
     bool deserializeMapPair(QVariant &key, QVariant &value, QProtobufSelfcheckIterator &it) const override;
 
     QByteArray serializeEnum(int64 value, const QMetaEnum &metaEnum, const QtProtobuf::QProtobufMetaProperty &metaProperty) const override;
@@ -25,11 +25,25 @@
 
 #include <QString>
 #include <QByteArray>
+#include <QtAlgorithms>
+#include <QtEndian>
+#include <QHash>
+#include <QMutex>
+#include <QPointer>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+#include <stdexcept>
 
 #include "qprotobufselfcheckiterator.h"
 #include "qtprotobuftypes.h"
 #include "qtprotobuflogging.h"
 #include "qabstractprotobufserializer.h"
+#include "qprotobufdispatchtable_p.h"
+#include "qprotobufutf8_p.h"
 
 namespace QtProtobuf {
 
@@ -47,12 +61,37 @@ public:
 
     /*!
      * \brief Serializer is interface function for serialize method
+     *
+     * \details Serializers append encoded value to the end of the provided buffer. If value shouldn't be
+     *          sent, serializer leaves buffer unchanged and sets field index to NotUsedFieldIndex.
      */
-    using Serializer = QByteArray(*)(const QVariant &, int &);
+    using Serializer = void(*)(const QVariant &, int &, QByteArray &);
     /*!
      * \brief Deserializer is interface function for deserialize method
      */
     using Deserializer = void(*)(QProtobufSelfcheckIterator &, QVariant &);
+    /*!
+     * \brief Sizer is interface function that calculates size of value serialized by Serializer
+     *
+     * \details Follows the same rules for field index as Serializer, header size is not included.
+     */
+    using Sizer = int(*)(const QVariant &, int &);
+
+    /*!
+     * \brief PropertySerializer is interface function that serializes property of object directly,
+     *        without boxing to QVariant
+     */
+    using PropertySerializer = void(*)(const QObject *, int, int &, QByteArray &);
+    /*!
+     * \brief PropertyDeserializer is interface function that deserializes property of object directly,
+     *        without boxing to QVariant
+     */
+    using PropertyDeserializer = void(*)(QObject *, int, QProtobufSelfcheckIterator &);
+    /*!
+     * \brief PropertySizer is interface function that calculates size of property of object directly,
+     *        without boxing to QVariant
+     */
+    using PropertySizer = int(*)(const QObject *, int, int &);
 
     /*!
      * \private
@@ -61,10 +100,17 @@ public:
     struct SerializationHandlers {
         Serializer serializer; /*!< serializer assigned to class */
         Deserializer deserializer;/*!< deserializer assigned to class */
-        WireTypes type;/*!< Serialization WireType */
+        Sizer sizer;/*!< size calculator assigned to class */
+        PropertySerializer propertySerializer;/*!< typed property serializer assigned to class */
+        PropertyDeserializer propertyDeserializer;/*!< typed property deserializer assigned to class */
+        PropertySizer propertySizer;/*!< typed property size calculator assigned to class */
+        WireTypes type;/*!< Serialization WireType. UnknownWireType means that serializer writes field headers itself */
+        const QtProtobufPrivate::SerializationHandler *complexHandler;/*!< handler of message, list, map or enum type. Basic handlers are empty if set */
+        Deserializer elementDeserializer;/*!< deserializer of single non-packed element, is set for packed lists of scalars only */
+        WireTypes elementType;/*!< WireType of non-packed element of packed list */
     };
 
-    using SerializerRegistry = std::unordered_map<int/*metatypeid*/, SerializationHandlers>;
+    using SerializerRegistry = QtProtobufPrivate::DispatchTable<SerializationHandlers>;
 
     QProtobufSerializerPrivate(QProtobufSerializer *q);
     ~QProtobufSerializerPrivate() = default;
@@ -72,71 +118,120 @@ public:
     //                               Serializers
     //###########################################################################
 
+    /*!
+     * \brief Checks if values of type \a V are encoded as fixed-width little-endian values
+     */
+    template <typename V>
+    using IsFixedType = std::integral_constant<bool, std::is_floating_point<V>::value
+                                               || std::is_same<V, fixed32>::value
+                                               || std::is_same<V, fixed64>::value
+                                               || std::is_same<V, sfixed32>::value
+                                               || std::is_same<V, sfixed64>::value>;
+
+    /*!
+     * \brief Writes fixed-width \a value to \a out in little-endian byte order
+     *
+     * \details Is plain copy on little-endian hosts, bytes are swapped on big-endian hosts
+     */
+    template <typename V,
+              typename std::enable_if_t<IsFixedType<V>::value, int> = 0>
+    static void encodeFixed(const V &value, char *out) {
+        using RawType = std::conditional_t<sizeof(V) == sizeof(quint32), quint32, quint64>;
+        RawType raw;
+        std::memcpy(&raw, static_cast<const void *>(&value), sizeof(V));
+        qToLittleEndian(raw, out);
+    }
+
+    /*!
+     * \brief Reads fixed-width little-endian value from \a in to \a value
+     */
+    template <typename V,
+              typename std::enable_if_t<IsFixedType<V>::value, int> = 0>
+    static void decodeFixed(const char *in, V &value) {
+        using RawType = std::conditional_t<sizeof(V) == sizeof(quint32), quint32, quint64>;
+        const RawType raw = qFromLittleEndian<RawType>(in);
+        std::memcpy(static_cast<void *>(&value), &raw, sizeof(V));
+    }
+
+    /*!
+     * \brief Maximum size of varint encoded value of type \a V
+     */
+    template <typename V>
+    static constexpr int maxVarintSize() {
+        return (sizeof(V) * 8 + 6) / 7;
+    }
+
+    /*!
+     * \brief Encodes \a value as varint to \a out
+     *
+     * \details Encoded size is calculated first from bit width of value, so bytes are stored without checking
+     *          of remaining value. \a out must have space for at least maxVarintSize<V>() bytes.
+     * \return Amount of bytes written to \a out
+     */
     template <typename V,
               typename std::enable_if_t<std::is_integral<V>::value
                                         && std::is_unsigned<V>::value, int> = 0>
-    static QByteArray serializeVarintCommon(const V &value) {
-        qProtoDebug() << __func__ << "value" << value;
-        V varint = value;
-        QByteArray result;
-
-        while (varint != 0) {
+    static int encodeVarint(V value, char *out) {
+        const int size = varintSize<V>(value);
+        for (int i = 0; i < size - 1; ++i) {
             //Put 7 bits to result buffer and mark as "not last" (0b10000000)
-            result.append((varint & 0b01111111) | 0b10000000);
+            out[i] = static_cast<char>((value & 0b01111111) | 0b10000000);
             //Divide values to chunks of 7 bits and move to next chunk
-            varint >>= 7;
-        }
-
-        if (result.isEmpty()) {
-            result.append('\0');
+            value >>= 7;
         }
+        //Last chunk has cleared last bit
+        out[size - 1] = static_cast<char>(value);
+        return size;
+    }
 
-        result.data()[result.size() - 1] &= ~0b10000000;
-        return result;
+    template <typename V,
+              typename std::enable_if_t<std::is_integral<V>::value
+                                        && std::is_unsigned<V>::value, int> = 0>
+    static void serializeVarintCommon(const V &value, QByteArray &buffer) {
+        qProtoDebug() << __func__ << "value" << value;
+        char encoded[maxVarintSize<V>()];
+        buffer.append(encoded, encodeVarint<V>(value, encoded));
     }
 
     //---------------Integral and floating point types serializers---------------
     /*!
      * \brief Serialization of fixed-length primitive types
      *
-     * Natural layout of bits is used: value is encoded in a byte array same way as it is located in memory
+     * Little-endian layout of bits is used: on little-endian hosts value is encoded in a byte array same way as
+     * it is located in memory
      *
      * \param[in] value Value to serialize
      * \param[out] outFieldIndex Index of the value in parent structure (ignored)
-     * \return Byte array with value encoded
+     * \param[out] buffer Byte array where encoded value is appended
      */
     template <typename V,
               typename std::enable_if_t<std::is_floating_point<V>::value, int> = 0>
-    static QByteArray serializeBasic(const V &value, int &/*outFieldIndex*/) {
+    static void serializeBasic(const V &value, int &/*outFieldIndex*/, QByteArray &buffer) {
         qProtoDebug() << __func__ << "value" << value;
-
-        //Reserve required number of bytes
-        QByteArray result(sizeof(V), '\0');
-        *reinterpret_cast<V *>(result.data()) = value;
-        return result;
+        char encoded[sizeof(V)];
+        encodeFixed(value, encoded);
+        buffer.append(encoded, sizeof(V));
     }
 
     /*!
      * \brief Serialization of fixed length integral types
      *
-     * \details Natural layout of bits is employed
+     * \details Little-endian layout of bits is employed
      *
      * \param[in] value Value to serialize
      * \param[out] outFieldIndex Index of the value in parent structure (ignored)
-     * \return Byte array with value encoded
+     * \param[out] buffer Byte array where encoded value is appended
      */
     template <typename V,
               typename std::enable_if_t<std::is_same<V, fixed32>::value
                                         || std::is_same<V, fixed64>::value
                                         || std::is_same<V, sfixed32>::value
                                         || std::is_same<V, sfixed64>::value, int> = 0>
-    static QByteArray serializeBasic(const V &value, int &/*outFieldIndex*/) {
+    static void serializeBasic(const V &value, int &/*outFieldIndex*/, QByteArray &buffer) {
         qProtoDebug() << __func__ << "value" << value;
-
-        //Reserve required number of bytes
-        QByteArray result(sizeof(V), '\0');
-        *reinterpret_cast<V *>(result.data()) = value;
-        return result;
+        char encoded[sizeof(V)];
+        encodeFixed(value, encoded);
+        buffer.append(encoded, sizeof(V));
     }
 
     /*!
@@ -148,12 +243,12 @@ public:
      *
      * \param[in] value Value to serialize
      * \param[out] outFieldIndex Index of the value in parent structure
-     * \return Byte array with value encoded
+     * \param[out] buffer Byte array where encoded value is appended
      */
     template <typename V,
               typename std::enable_if_t<std::is_integral<V>::value
                                         && std::is_signed<V>::value, int> = 0>
-    static QByteArray serializeBasic(const V &value, int &outFieldIndex) {
+    static void serializeBasic(const V &value, int &outFieldIndex, QByteArray &buffer) {
         qProtoDebug() << __func__ << "value" << value;
         using UV = typename std::make_unsigned<V>::type;
         UV uValue = 0;
@@ -161,16 +256,16 @@ public:
         //Use ZigZag convertion first and apply unsigned variant next
         V zigZagValue = (value << 1) ^ (value >> (sizeof(UV) * 8 - 1));
         uValue = static_cast<UV>(zigZagValue);
-        return serializeBasic(uValue, outFieldIndex);
+        serializeBasic(uValue, outFieldIndex, buffer);
     }
 
     template <typename V,
               typename std::enable_if_t<std::is_same<V, int32>::value
                                         || std::is_same<V, int64>::value, int> = 0>
-    static QByteArray serializeBasic(const V &value, int &outFieldIndex) {
+    static void serializeBasic(const V &value, int &outFieldIndex, QByteArray &buffer) {
         qProtoDebug() << __func__ << "value" << value;
         using UV = typename std::make_unsigned<V>::type;
-        return serializeBasic(static_cast<UV>(value), outFieldIndex);
+        serializeBasic(static_cast<UV>(value), outFieldIndex, buffer);
     }
 
     /*!
@@ -182,91 +277,259 @@ public:
     *
     * \param[in] value Value to serialize
     * \param[out] outFieldIndex Index of the value in parent structure
-    * \return Byte array with value encoded
+    * \param[out] buffer Byte array where encoded value is appended
     */
     template <typename V,
               typename std::enable_if_t<std::is_integral<V>::value
                                         && std::is_unsigned<V>::value, int> = 0>
-    static QByteArray serializeBasic(const V &value, int &outFieldIndex) {
+    static void serializeBasic(const V &value, int &outFieldIndex, QByteArray &buffer) {
         qProtoDebug() << __func__ << "value" << value;
-        V varint = value;
-        QByteArray result;
 
-        while (varint != 0) {
-            //Put 7 bits to result buffer and mark as "not last" (0b10000000)
-            result.append((varint & 0b01111111) | 0b10000000);
-            //Divide values to chunks of 7 bits and move to next chunk
-            varint >>= 7;
-        }
-
-        // Invalidate field index in case if serialized result is empty
+        // Invalidate field index in case if value is default, nothing is appended to buffer
         // NOTE: the field will not be sent if its index is equal to NotUsedFieldIndex
-        if (result.size() == 0) {
+        if (value == 0) {
             outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
-        } else {
-            //Mark last chunk as last by clearing last bit
-            result.data()[result.size() - 1] &= ~0b10000000;
+            return;
         }
-        return result;
+        serializeVarintCommon<V>(value, buffer);
     }
 
     //------------------QString and QByteArray types serializers-----------------
     template <typename V,
               typename std::enable_if_t<std::is_same<V, QString>::value, int> = 0>
-    static QByteArray serializeBasic(const V &value, int &/*outFieldIndex*/) {
-        return serializeLengthDelimited(value.toUtf8());
+    static void serializeBasic(const V &value, int &outFieldIndex, QByteArray &buffer) {
+        //Empty value is default one and is not sent
+        if (value.isEmpty()) {
+            outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
+            return;
+        }
+        serializeString(value, buffer);
     }
 
     template <typename V,
               typename std::enable_if_t<std::is_same<V, QByteArray>::value, int> = 0>
-    static QByteArray serializeBasic(const V &value, int &/*outFieldIndex*/) {
-        return serializeLengthDelimited(value);
+    static void serializeBasic(const V &value, int &outFieldIndex, QByteArray &buffer) {
+        if (value.isEmpty()) {
+            outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
+            return;
+        }
+        serializeLengthDelimited(value, buffer);
     }
 
     //--------------------------List types serializers---------------------------
+    /*!
+     * \brief Serialization of packed lists of fixed-width values
+     *
+     * \details Payload size is known in advance, so buffer is resized once and values are copied to it
+     */
+    template<typename V,
+             typename std::enable_if_t<IsFixedType<V>::value, int> = 0>
+    static void serializeListType(const QList<V> &listValue, int &outFieldIndex, QByteArray &buffer) {
+        qProtoDebug() << __func__ << "listValue.count" << listValue.count() << "outFiledIndex" << outFieldIndex;
+
+        if (listValue.count() <= 0) {
+            outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
+            return;
+        }
+
+        const int payloadSize = listValue.count() * static_cast<int>(sizeof(V));
+        serializeVarintCommon<uint32>(payloadSize, buffer);
+        const int payloadPosition = buffer.size();
+        buffer.resize(payloadPosition + payloadSize);
+        char *out = buffer.data() + payloadPosition;
+        for (const auto &value : listValue) {
+            encodeFixed(value, out);
+            out += sizeof(V);
+        }
+    }
+
     template<typename V,
              typename std::enable_if_t<!(std::is_same<V, QString>::value
-                                       || std::is_base_of<QObject, V>::value), int> = 0>
-    static QByteArray serializeListType(const QList<V> &listValue, int &outFieldIndex) {
+                                       || std::is_base_of<QObject, V>::value
+                                       || IsFixedType<V>::value), int> = 0>
+    static void serializeListType(const QList<V> &listValue, int &outFieldIndex, QByteArray &buffer) {
         qProtoDebug() << __func__ << "listValue.count" << listValue.count() << "outFiledIndex" << outFieldIndex;
 
         if (listValue.count() <= 0) {
             outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
-            return QByteArray();
+            return;
         }
 
+        //If internal field type is not LengthDelimited, exact amount of fields to be specified
+        const int sizePosition = beginLengthDelimited(buffer);
         int empty = QtProtobufPrivate::NotUsedFieldIndex;
-        QByteArray serializedList;
         for (auto &value : listValue) {
-            QByteArray element = serializeBasic<V>(value, empty);
-            if (element.isEmpty()) {
-                element.append('\0');
+            const int elementPosition = buffer.size();
+            serializeBasic<V>(value, empty, buffer);
+            if (elementPosition == buffer.size()) {
+                buffer.append('\0');
             }
-            serializedList.append(element);
         }
-        //If internal field type is not LengthDelimited, exact amount of fields to be specified
-        serializedList = prependLengthDelimitedSize(serializedList);
-        return serializedList;
+        endLengthDelimited(buffer, sizePosition);
     }
 
     template<typename V,
              typename std::enable_if_t<std::is_same<V, QString>::value, int> = 0>
-    static QByteArray serializeListType(const QStringList &listValue, int &outFieldIndex) {
+    static void serializeListType(const QStringList &listValue, int &outFieldIndex, QByteArray &buffer) {
         qProtoDebug() << __func__ << "listValue.count" << listValue.count() << "outFiledIndex" << outFieldIndex;
 
         if (listValue.count() <= 0) {
             outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
-            return QByteArray();
+            return;
         }
 
-        QByteArray serializedList;
         for (auto &value : listValue) {
-            serializedList.append(QProtobufSerializerPrivate::encodeHeader(outFieldIndex, LengthDelimited));
-            serializedList.append(serializeLengthDelimited(value.toUtf8()));
+            QProtobufSerializerPrivate::encodeHeader(outFieldIndex, LengthDelimited, buffer);
+            serializeString(value, buffer);
         }
 
         outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
-        return serializedList;
+    }
+
+    //###########################################################################
+    //                             Size calculators
+    //###########################################################################
+    template <typename V,
+              typename std::enable_if_t<std::is_integral<V>::value
+                                        && std::is_unsigned<V>::value, int> = 0>
+    static int varintSize(V value) {
+        //Each byte of varint holds 7 bits of value, zero value takes one byte. Size is looked up
+        //by number of leading zero bits
+        static const quint8 sizeByLeadingZeros[64] = {
+            10, 9, 9, 9, 9, 9, 9, 9, 8, 8, 8, 8, 8, 8, 8, 7,
+            7, 7, 7, 7, 7, 7, 6, 6, 6, 6, 6, 6, 6, 5, 5, 5,
+            5, 5, 5, 5, 4, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3,
+            3, 3, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1
+        };
+        return sizeByLeadingZeros[qCountLeadingZeroBits(static_cast<quint64>(value) | 1)];
+    }
+
+    static int headerSize(int fieldIndex, WireTypes wireType) {
+        return varintSize<uint32_t>((fieldIndex << 3) | wireType);
+    }
+
+    static int lengthDelimitedSize(int size) {
+        return varintSize<uint32_t>(size) + size;
+    }
+
+    /*!
+     * \brief Appends encoded default value of \a wireType to \a buffer, field header is not appended
+     */
+    static void serializeDefaultValue(WireTypes wireType, QByteArray &buffer) {
+        buffer.append(defaultValueSize(wireType), '\0');
+    }
+
+    static int defaultValueSize(WireTypes wireType) {
+        switch (wireType) {
+        case Fixed32:
+            return 4;
+        case Fixed64:
+            return 8;
+        default:
+            //Zero varint and empty length-delimited value take single zero byte
+            return 1;
+        }
+    }
+
+    template <typename V,
+              typename std::enable_if_t<std::is_floating_point<V>::value
+                                        || std::is_same<V, fixed32>::value
+                                        || std::is_same<V, fixed64>::value
+                                        || std::is_same<V, sfixed32>::value
+                                        || std::is_same<V, sfixed64>::value, int> = 0>
+    static int basicSize(const V &/*value*/, int &/*outFieldIndex*/) {
+        return sizeof(V);
+    }
+
+    template <typename V,
+              typename std::enable_if_t<std::is_integral<V>::value
+                                        && std::is_signed<V>::value, int> = 0>
+    static int basicSize(const V &value, int &outFieldIndex) {
+        using UV = typename std::make_unsigned<V>::type;
+        V zigZagValue = (value << 1) ^ (value >> (sizeof(UV) * 8 - 1));
+        return basicSize(static_cast<UV>(zigZagValue), outFieldIndex);
+    }
+
+    template <typename V,
+              typename std::enable_if_t<std::is_same<V, int32>::value
+                                        || std::is_same<V, int64>::value, int> = 0>
+    static int basicSize(const V &value, int &outFieldIndex) {
+        using UV = typename std::make_unsigned<V>::type;
+        return basicSize(static_cast<UV>(value), outFieldIndex);
+    }
+
+    template <typename V,
+              typename std::enable_if_t<std::is_integral<V>::value
+                                        && std::is_unsigned<V>::value, int> = 0>
+    static int basicSize(const V &value, int &outFieldIndex) {
+        if (value == 0) {
+            outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
+            return 0;
+        }
+        return varintSize<V>(value);
+    }
+
+    static int basicSize(const QString &value, int &outFieldIndex) {
+        if (value.isEmpty()) {
+            outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
+            return 0;
+        }
+        return lengthDelimitedSize(QtProtobufPrivate::utf8Size(value));
+    }
+
+    static int basicSize(const QByteArray &value, int &outFieldIndex) {
+        if (value.isEmpty()) {
+            outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
+            return 0;
+        }
+        return lengthDelimitedSize(value.size());
+    }
+
+    template<typename V,
+             typename std::enable_if_t<!(std::is_same<V, QString>::value
+                                       || std::is_same<V, QByteArray>::value
+                                       || std::is_base_of<QObject, V>::value), int> = 0>
+    static int basicSize(const QList<V> &listValue, int &outFieldIndex) {
+        if (listValue.count() <= 0) {
+            outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
+            return 0;
+        }
+
+        int size = 0;
+        int empty = QtProtobufPrivate::NotUsedFieldIndex;
+        for (auto &value : listValue) {
+            //Empty elements are serialized as single zero byte
+            size += std::max(basicSize(value, empty), 1);
+        }
+        return lengthDelimitedSize(size);
+    }
+
+    static int basicSize(const QStringList &listValue, int &outFieldIndex) {
+        int size = 0;
+        for (auto &value : listValue) {
+            size += headerSize(outFieldIndex, LengthDelimited) + lengthDelimitedSize(QtProtobufPrivate::utf8Size(value));
+        }
+        outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
+        return size;
+    }
+
+    static int basicSize(const QByteArrayList &listValue, int &outFieldIndex) {
+        int size = 0;
+        for (auto &value : listValue) {
+            size += headerSize(outFieldIndex, LengthDelimited) + lengthDelimitedSize(value.size());
+        }
+        outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
+        return size;
+    }
+
+    template <typename T>
+    static int sizeWrapper(const QVariant &variantValue, int &fieldIndex) {
+        if (variantValue.isNull()) {
+            fieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
+            return 0;
+        }
+        const T& value = *(static_cast<const T *>(variantValue.data()));
+        return basicSize(value, fieldIndex);
     }
 
     //###########################################################################
@@ -279,17 +542,28 @@ public:
         qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
 
         V value = 0;
+        //Longest varint fits to remaining data, so bytes are read without per-byte bounds checks
+        if (it.size() >= maxVarintSize<uint64_t>()) {
+            const int length = decodeBoundedVarint(it.data(), value);
+            if (length > 0) {
+                it.advanceUnchecked(length);
+                return value;
+            }
+            value = 0;
+        }
+
         int k = 0;
-        while (true) {
-            uint64_t byte = static_cast<uint64_t>(*it);
-            value += (byte & 0b01111111) << k;
+        while (it.size() > 0) {
+            const char byte = *it;
+            value += (static_cast<uint64_t>(byte) & 0b01111111) << k;
             k += 7;
-            if (((*it) & 0b10000000) == 0) {
-                break;
+            it.advanceUnchecked(1);
+            if ((byte & 0b10000000) == 0) {
+                return value;
             }
-            ++it;
         }
-        ++it;
+        QtProtobufPrivate::reportDeserializationError(UnexpectedEndOfStreamError,
+                                                      "Container is less than required fields number. Deserialization failed");
         return value;
     }
 
@@ -300,155 +574,708 @@ public:
                                         || std::is_same<V, fixed64>::value
                                         || std::is_same<V, sfixed32>::value
                                         || std::is_same<V, sfixed64>::value, int> = 0>
-    static void deserializeBasic(QProtobufSelfcheckIterator &it, QVariant &variantValue) {
+    static void deserializeBasic(QProtobufSelfcheckIterator &it, V &value) {
         qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
 
-        variantValue = QVariant::fromValue(*(V *)((QByteArray::const_iterator&)it));
-        it += sizeof(V);
+        const char *data = it.data();
+        if (it.size() < static_cast<int>(sizeof(V))) {
+            it += sizeof(V);//Reports error
+            return;
+        }
+        it.advanceUnchecked(sizeof(V));
+        decodeFixed(data, value);
     }
 
     template <typename V,
               typename std::enable_if_t<std::is_integral<V>::value
                                         && std::is_unsigned<V>::value, int> = 0>
-    static void deserializeBasic(QProtobufSelfcheckIterator &it, QVariant &variantValue) {
+    static void deserializeBasic(QProtobufSelfcheckIterator &it, V &value) {
         qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
 
-        variantValue = QVariant::fromValue(deserializeVarintCommon<V>(it));
+        value = deserializeVarintCommon<V>(it);
     }
 
     template <typename V,
               typename std::enable_if_t<std::is_integral<V>::value
                                         && std::is_signed<V>::value,int> = 0>
-    static void deserializeBasic(QProtobufSelfcheckIterator &it, QVariant &variantValue) {
+    static void deserializeBasic(QProtobufSelfcheckIterator &it, V &value) {
         qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
         using  UV = typename std::make_unsigned<V>::type;
         UV unsignedValue = deserializeVarintCommon<UV>(it);
-        V value = (unsignedValue >> 1) ^ (-1 * (unsignedValue & 1));
-        variantValue = QVariant::fromValue<V>(value);
+        value = (unsignedValue >> 1) ^ (-1 * (unsignedValue & 1));
     }
 
     template <typename V,
               typename std::enable_if_t<std::is_same<int32, V>::value
                                         || std::is_same<int64, V>::value, int> = 0>
-    static void deserializeBasic(QProtobufSelfcheckIterator &it, QVariant &variantValue) {
+    static void deserializeBasic(QProtobufSelfcheckIterator &it, V &value) {
         qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
         using  UV = typename std::make_unsigned<V>::type;
         UV unsignedValue = deserializeVarintCommon<UV>(it);
-        V value = static_cast<V>(unsignedValue);
-        variantValue = QVariant::fromValue(value);
+        value = static_cast<decltype(V::_t)>(unsignedValue);
     }
 
     //-----------------QString and QByteArray types deserializers----------------
     template <typename V,
               typename std::enable_if_t<std::is_same<QByteArray, V>::value, int> = 0>
-    static void deserializeBasic(QProtobufSelfcheckIterator &it, QVariant &variantValue) {
-        variantValue = QVariant::fromValue(deserializeLengthDelimited(it));
+    static void deserializeBasic(QProtobufSelfcheckIterator &it, V &value) {
+        value = deserializeLengthDelimited(it);
     }
 
     template <typename V,
               typename std::enable_if_t<std::is_same<QString, V>::value, int> = 0>
-    static void deserializeBasic(QProtobufSelfcheckIterator &it, QVariant &variantValue) {
-        variantValue = QVariant::fromValue(QString::fromUtf8(deserializeLengthDelimited(it)));
+    static void deserializeBasic(QProtobufSelfcheckIterator &it, V &value) {
+        value = deserializeString(deserializeLengthDelimitedView(it));
+    }
+
+    //---------------------Packed varint lists deserializers---------------------
+    /*!
+     * \brief Checks if values of type \a V are encoded as varints
+     */
+    template <typename V>
+    using IsVarintType = std::integral_constant<bool, std::is_integral<V>::value
+                                                || std::is_same<V, int32>::value
+                                                || std::is_same<V, int64>::value>;
+
+    /*!
+     * \brief Counts varints in packed \a data of \a size bytes
+     *
+     * \details Each varint is terminated by byte with cleared continuation bit, so amount of such bytes is amount
+     *          of varints. Data is scanned by 8 bytes per step.
+     */
+    static int countPackedVarints(const char *data, int size) {
+        int count = 0;
+        int i = 0;
+        for (; i + 8 <= size; i += 8) {
+            quint64 word;
+            std::memcpy(&word, data + i, sizeof(word));
+            count += qPopulationCount(~word & Q_UINT64_C(0x8080808080808080));
+        }
+        for (; i < size; ++i) {
+            if ((data[i] & 0b10000000) == 0) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    /*!
+     * \brief Decodes varint at \a data and moves \a data to next byte after it
+     *
+     * \details No bounds checks are performed, caller guarantees that varint is terminated inside of buffer
+     */
+    template <typename V,
+              typename std::enable_if_t<std::is_integral<V>::value
+                                        && std::is_unsigned<V>::value, int> = 0>
+    static V decodeVarint(const char *&data) {
+        V value = 0;
+        int k = 0;
+        uchar byte = 0;
+        do {
+            byte = static_cast<uchar>(*data++);
+            if (k < 64) {
+                value |= static_cast<V>(static_cast<uint64_t>(byte & 0b01111111) << k);
+            }
+            k += 7;
+        } while ((byte & 0b10000000) != 0);
+        return value;
+    }
+
+    /*!
+     * \brief Decodes varint from \a data reading not more than maxVarintSize<uint64_t>() bytes
+     *
+     * \details \a data must contain at least maxVarintSize<uint64_t>() bytes.
+     * \return Amount of decoded bytes, or 0 if varint is not terminated within maxVarintSize<uint64_t>() bytes
+     */
+    template <typename V>
+    static int decodeBoundedVarint(const char *data, V &value) {
+        int k = 0;
+        for (int i = 0; i < maxVarintSize<uint64_t>(); ++i) {
+            const uchar byte = static_cast<uchar>(data[i]);
+            value |= static_cast<V>(static_cast<uint64_t>(byte & 0b01111111) << k);
+            k += 7;
+            if ((byte & 0b10000000) == 0) {
+                return i + 1;
+            }
+        }
+        return 0;
+    }
+
+    template <typename V,
+              typename std::enable_if_t<std::is_integral<V>::value
+                                        && std::is_unsigned<V>::value, int> = 0>
+    static void decodePackedValue(const char *&data, V &value) {
+        value = decodeVarint<V>(data);
+    }
+
+    template <typename V,
+              typename std::enable_if_t<std::is_integral<V>::value
+                                        && std::is_signed<V>::value, int> = 0>
+    static void decodePackedValue(const char *&data, V &value) {
+        using  UV = typename std::make_unsigned<V>::type;
+        UV unsignedValue = decodeVarint<UV>(data);
+        value = (unsignedValue >> 1) ^ (-1 * (unsignedValue & 1));
+    }
+
+    template <typename V,
+              typename std::enable_if_t<std::is_same<int32, V>::value
+                                        || std::is_same<int64, V>::value, int> = 0>
+    static void decodePackedValue(const char *&data, V &value) {
+        using  UV = typename std::make_unsigned<V>::type;
+        UV unsignedValue = decodeVarint<UV>(data);
+        value = static_cast<decltype(V::_t)>(unsignedValue);
     }
 
     //-------------------------List types deserializers--------------------------
+    /*!
+     * \brief Deserializes packed list of varints and appends it to \a previousValue
+     *
+     * \details Payload bounds are checked once. Elements are counted before decoding to allocate list at once
+     *          and decoded directly from payload.
+     */
     template <typename V,
-              typename std::enable_if_t<!std::is_base_of<QObject, V>::value, int> = 0>
-    static void deserializeList(QProtobufSelfcheckIterator &it, QVariant &previousValue) {
+              typename std::enable_if_t<IsVarintType<V>::value, int> = 0>
+    static void deserializeList(QProtobufSelfcheckIterator &it, QList<V> &previousValue) {
+        qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
+
+        const uint32 size = deserializeVarintCommon<uint32>(it);
+        if (size > static_cast<uint32>(it.size())) {
+            it += static_cast<int>(size);//Reports error
+            return;
+        }
+
+        const char *data = it.data();
+        const char *end = data + size;
+        it.advanceUnchecked(static_cast<int>(size));
+        if (size > 0 && (*(end - 1) & 0b10000000) != 0) {
+            QtProtobufPrivate::reportDeserializationError(InvalidFormatError, "Packed field contains unterminated varint. Deserialization failed");
+            return;
+        }
+
+        const int count = countPackedVarints(data, static_cast<int>(size));
+        if (!checkElementCount(previousValue.size() + count) || !consumeElements(count)) {
+            return;
+        }
+
+        previousValue.reserve(previousValue.size() + count);
+        while (data != end) {
+            V value{};
+            decodePackedValue<V>(data, value);
+            previousValue.append(value);
+        }
+    }
+
+    /*!
+     * \brief Deserializes packed list of fixed-width values and appends it to \a previousValue
+     *
+     * \details Payload bounds are checked once and values are copied directly from payload
+     */
+    template <typename V,
+              typename std::enable_if_t<IsFixedType<V>::value, int> = 0>
+    static void deserializeList(QProtobufSelfcheckIterator &it, QList<V> &previousValue) {
+        qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
+
+        const uint32 size = deserializeVarintCommon<uint32>(it);
+        if (size > static_cast<uint32>(it.size())) {
+            it += static_cast<int>(size);//Reports error
+            return;
+        }
+
+        const char *data = it.data();
+        it.advanceUnchecked(static_cast<int>(size));
+        if (size % sizeof(V) != 0) {
+            QtProtobufPrivate::reportDeserializationError(InvalidFormatError, "Packed field size doesn't match size of elements. Deserialization failed");
+            return;
+        }
+
+        const int count = static_cast<int>(size / sizeof(V));
+        if (!checkElementCount(previousValue.size() + count) || !consumeElements(count)) {
+            return;
+        }
+
+        previousValue.reserve(previousValue.size() + count);
+        for (int i = 0; i < count; ++i) {
+            V value{};
+            decodeFixed(data, value);
+            data += sizeof(V);
+            previousValue.append(value);
+        }
+    }
+
+    template <typename V,
+              typename std::enable_if_t<!(std::is_same<V, QString>::value
+                                        || std::is_base_of<QObject, V>::value
+                                        || IsVarintType<V>::value
+                                        || IsFixedType<V>::value), int> = 0>
+    static void deserializeList(QProtobufSelfcheckIterator &it, QList<V> &previousValue) {
         qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
 
         QList<V> out;
         unsigned int count = deserializeVarintCommon<uint32>(it);
         QProtobufSelfcheckIterator lastVarint = it + count;
-        while (it != lastVarint) {
-            QVariant variantValue;
-            deserializeBasic<V>(it, variantValue);
-            out.append(variantValue.value<V>());
+        while (it != lastVarint && QtProtobufPrivate::deserializationError() == NoDeserializationError
+               && checkElementCount(out.size() + 1) && consumeElements(1)) {
+            V value{};
+            deserializeBasic<V>(it, value);
+            out.append(value);
         }
-        previousValue.setValue(out);
+        previousValue = out;
+    }
+
+    template <typename V,
+              typename std::enable_if_t<std::is_same<V, QString>::value, int> = 0>
+    static void deserializeList(QProtobufSelfcheckIterator &it, QStringList &previousValue) {
+        qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
+
+        previousValue.append(deserializeString(deserializeLengthDelimitedView(it)));
+    }
+
+    /*!
+     * \brief Deserializes single non-packed element of scalar list and appends it to \a previousValue
+     *
+     * \details Non-packed encoding is used by proto2 senders, each element is written with its own field header
+     */
+    template <typename V>
+    static void deserializeListElement(QProtobufSelfcheckIterator &it, QList<V> &previousValue) {
+        qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
+
+        if (!checkElementCount(previousValue.size() + 1) || !consumeElements(1)) {
+            return;
+        }
+        V value{};
+        deserializeBasic<V>(it, value);
+        if (QtProtobufPrivate::deserializationError() == NoDeserializationError) {
+            previousValue.append(value);
+        }
+    }
+
+    //---------------------Typed property access serializers---------------------
+    /*!
+     * \brief Reads value of property with absolute index \a propertyIndex directly to \a value
+     *
+     * \details Uses meta-object system property access that avoids boxing to QVariant. Type \a T must be
+     *          exactly the type of the property.
+     */
+    template <typename T>
+    static void readProperty(const QObject *object, int propertyIndex, T &value) {
+        void *argv[] = { &value, nullptr };
+        QMetaObject::metacall(const_cast<QObject *>(object), QMetaObject::ReadProperty, propertyIndex, argv);
+    }
+
+    /*!
+     * \brief Writes \a value to property with absolute index \a propertyIndex directly
+     *
+     * \details Uses meta-object system property access that avoids boxing to QVariant. Type \a T must be
+     *          exactly the type of the property.
+     */
+    template <typename T>
+    static void writeProperty(QObject *object, int propertyIndex, T &value) {
+        int status = -1;
+        int flags = 0;
+        void *argv[] = { &value, nullptr, &status, &flags };
+        QMetaObject::metacall(object, QMetaObject::WriteProperty, propertyIndex, argv);
+    }
+
+    //Unlike QVariant wrappers, property wrappers have no null value to check. Default values, including empty
+    //strings and bytes, are dropped by basic serializers and size calculators that set NotUsedFieldIndex.
+    template <typename T, typename S, void(*s)(const S &, int &, QByteArray &)>
+    static void serializePropertyWrapper(const QObject *object, int propertyIndex, int &fieldIndex, QByteArray &buffer) {
+        T value{};
+        readProperty(object, propertyIndex, value);
+        const S &serializedValue = value;
+        s(serializedValue, fieldIndex, buffer);
+    }
+
+    template <typename T, typename S>
+    static int propertySizeWrapper(const QObject *object, int propertyIndex, int &fieldIndex) {
+        T value{};
+        readProperty(object, propertyIndex, value);
+        const S &serializedValue = value;
+        return basicSize(serializedValue, fieldIndex);
+    }
+
+    template <typename T, typename S, void(*d)(QProtobufSelfcheckIterator &, S &),
+              typename std::enable_if_t<std::is_same<T, S>::value, int> = 0>
+    static void deserializePropertyWrapper(QObject *object, int propertyIndex, QProtobufSelfcheckIterator &it) {
+        //Deserializers of repeated fields use previous value
+        T value{};
+        readProperty(object, propertyIndex, value);
+        d(it, value);
+        writeProperty(object, propertyIndex, value);
+    }
+
+    template <typename T, typename S, void(*d)(QProtobufSelfcheckIterator &, S &),
+              typename std::enable_if_t<!std::is_same<T, S>::value, int> = 0>
+    static void deserializePropertyWrapper(QObject *object, int propertyIndex, QProtobufSelfcheckIterator &it) {
+        S deserializedValue{};
+        d(it, deserializedValue);
+        T value = deserializedValue;
+        writeProperty(object, propertyIndex, value);
     }
 
     //###########################################################################
     //                             Common functions
     //###########################################################################
-    static QByteArray deserializeLengthDelimited(QProtobufSelfcheckIterator &it) {
+    /*!
+     * \brief Reads length-delimited field without copying it
+     *
+     * \return QByteArray::fromRawData view to the field payload. View is valid while input buffer is alive
+     */
+    static QByteArray deserializeLengthDelimitedView(QProtobufSelfcheckIterator &it) {
         qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
 
         unsigned int length = deserializeVarintCommon<uint32>(it);
-        QByteArray result((QByteArray::const_iterator&)it, length); //TODO: it's possible to avoid buffer copying by setuping new "end of QByteArray";
+        if (length > static_cast<unsigned int>(it.size())) {
+            QtProtobufPrivate::reportDeserializationError(UnexpectedEndOfStreamError,
+                                                          "Length-delimited field is out of message bounds. Deserialization failed");
+            it.advanceUnchecked(it.size());
+            return QByteArray();
+        }
+        const char *data = it.data();
         it += length;
-        return result;
+        return QByteArray::fromRawData(data, length);
+    }
+
+    /*!
+     * \brief Reads length-delimited field
+     *
+     * \return Copy of the field payload, or view to the field payload if zero-copy bytes are enabled
+     *         for current deserialization
+     */
+    static QByteArray deserializeLengthDelimited(QProtobufSelfcheckIterator &it) {
+        QByteArray view = deserializeLengthDelimitedView(it);
+        return zeroCopyBytes ? view : QByteArray(view.constData(), view.size());
     }
 
-    static QByteArray serializeLengthDelimited(const QByteArray &data) {
+    /*!
+     * \brief Converts UTF-8 payload of string field to QString
+     *
+     * \details Strings of fields that are marked for interning share single QString per distinct value
+     *          within current deserialization
+     */
+    static QString deserializeString(const QByteArray &utf8) {
+        return internStrings ? internString(utf8) : QString::fromUtf8(utf8);
+    }
+    static QString internString(const QByteArray &utf8);
+
+    static void serializeLengthDelimited(const QByteArray &data, QByteArray &buffer) {
         qProtoDebug() << __func__ << "data.size" << data.size() << "data" << data.toHex();
-        QByteArray result(data);
-        //Varint serialize field size and apply result as starting point
-        result = prependLengthDelimitedSize(result);
-        return result;
+        //Varint serialize field size and apply data right after it
+        serializeVarintCommon<uint32_t>(data.size(), buffer);
+        buffer.append(data);
+    }
+
+    /*!
+     * \brief Serializes \a value as length-delimited UTF-8 string encoded right in \a buffer
+     */
+    static void serializeString(const QString &value, QByteArray &buffer) {
+        const int size = QtProtobufPrivate::utf8Size(value);
+        serializeVarintCommon<uint32_t>(size, buffer);
+        const int position = buffer.size();
+        buffer.resize(position + size);
+        QtProtobufPrivate::encodeUtf8(value, buffer.data() + position);
     }
 
     static bool decodeHeader(QProtobufSelfcheckIterator &it, int &fieldIndex, WireTypes &wireType);
+    static void encodeHeader(int fieldIndex, WireTypes wireType, QByteArray &buffer);
     static QByteArray encodeHeader(int fieldIndex, WireTypes wireType);
 
     /*!
-     * \brief Gets length of a byte-array and prepends to it its serialized length value
-     *      using the appropriate serialization algorithm
+     * \brief Appends header and \a size of length-delimited field to \a buffer with single append
      *
+     * \details Is used when size of payload is known in advance, e.g. cached by size calculation pass,
+     *          so payload is appended to \a buffer right after this call without moving
+     */
+    static void encodeLengthDelimitedHeader(int fieldIndex, int size, QByteArray &buffer)
+    {
+        char encoded[maxVarintSize<uint32_t>() * 2];
+        int length = encodeVarint<uint32_t>((static_cast<uint32_t>(fieldIndex) << 3) | LengthDelimited, encoded);
+        length += encodeVarint<uint32_t>(static_cast<uint32_t>(size), encoded + length);
+        buffer.append(encoded, length);
+    }
+
+    /*!
+     * \brief Reserves space for size of length-delimited field that is about to be written to \a buffer
+     *
+     * \details Payload of the field should be appended to \a buffer right after this call. The size is
+     *          written in place by endLengthDelimited, so payload doesn't require intermediate buffer.
+     *          One byte is reserved, which is enough for payloads shorter than 128 bytes. Longer payloads
+     *          are moved forward by the number of extra bytes required for the size.
      *
-     * \param[in, out] serializedList Byte-array to be prepended
+     * \param[in, out] buffer Byte-array where length-delimited field is serialized
+     * \return Position of the reserved size in \a buffer
      */
-    static QByteArray prependLengthDelimitedSize(const QByteArray &data)
+    static int beginLengthDelimited(QByteArray &buffer)
     {
-        return serializeVarintCommon<uint32_t>(data.size()) + data;
+        buffer.append('\0');
+        return buffer.size() - 1;
+    }
+
+    /*!
+     * \brief Writes the size of length-delimited field that was started using beginLengthDelimited
+     *
+     * \param[in, out] buffer Byte-array where length-delimited field is serialized
+     * \param[in] sizePosition Position of the reserved size returned by beginLengthDelimited
+     */
+    static void endLengthDelimited(QByteArray &buffer, int sizePosition)
+    {
+        const uint32_t size = buffer.size() - sizePosition - 1;
+        if (size < 0x80) {
+            buffer.data()[sizePosition] = static_cast<char>(size);
+            return;
+        }
+
+        char encodedSize[maxVarintSize<uint32_t>()];
+        const int encodedSizeLength = encodeVarint<uint32_t>(size, encodedSize);
+        buffer.insert(sizePosition + 1, encodedSize + 1, encodedSizeLength - 1);
+        buffer.data()[sizePosition] = encodedSize[0];
     }
 
     template <typename T,
-               QByteArray(*s)(const T &, int &)>
-    static QByteArray serializeWrapper(const QVariant &variantValue, int &fieldIndex) {
+               void(*s)(const T &, int &, QByteArray &)>
+    static void serializeWrapper(const QVariant &variantValue, int &fieldIndex, QByteArray &buffer) {
         if (variantValue.isNull()) {
             fieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
-            return QByteArray();
+            return;
         }
         const T& value = *(static_cast<const T *>(variantValue.data()));
-        return s(value, fieldIndex);
+        s(value, fieldIndex, buffer);
     }
 
-    template <typename T, QByteArray(*s)(const T &, int &), Deserializer d, WireTypes type,
+    template <typename T, void(*d)(QProtobufSelfcheckIterator &, T &)>
+    static void deserializeWrapper(QProtobufSelfcheckIterator &it, QVariant &variantValue) {
+        //Value is modified in place, so repeated fields accumulated in variant are not detached for each element
+        if (variantValue.userType() == qMetaTypeId<T>()) {
+            d(it, *static_cast<T *>(variantValue.data()));
+            return;
+        }
+        T value = variantValue.value<T>();
+        d(it, value);
+        variantValue = QVariant::fromValue<T>(value);
+    }
+
+    template <typename T, void(*s)(const T &, int &, QByteArray &), void(*d)(QProtobufSelfcheckIterator &, T &), WireTypes type,
     typename std::enable_if_t<!std::is_base_of<QObject, T>::value, int> = 0>
     static void wrapSerializer() {
-        handlers[qMetaTypeId<T>()] = {
-                serializeWrapper<T, s>,
-                d,
-                type
-        };
+        wrapSerializer<T, T, s, d, type>();
     }
 
-    template <typename T, typename S, QByteArray(*s)(const S &, int &), Deserializer d, WireTypes type,
+    template <typename T, typename S, void(*s)(const S &, int &, QByteArray &), void(*d)(QProtobufSelfcheckIterator &, S &), WireTypes type,
     typename std::enable_if_t<!std::is_base_of<QObject, T>::value, int> = 0>
     static void wrapSerializer() {
-        handlers[qMetaTypeId<T>()] = {
+        handlers().insert(qMetaTypeId<T>(), {
                 serializeWrapper<S, s>,
-                d,
-                type
-        };
+                deserializeWrapper<S, d>,
+                sizeWrapper<S>,
+                serializePropertyWrapper<T, S, s>,
+                deserializePropertyWrapper<T, S, d>,
+                propertySizeWrapper<T, S>,
+                type,
+                nullptr,
+                nullptr,
+                UnknownWireType
+        });
     }
 
+    /*!
+     * \brief Registers handlers of packed list of scalars \a V
+     *
+     * \details Lists are decoded from both packed and non-packed encodings, \a elementType is wire type of
+     *          non-packed element.
+     */
+    template <typename V, WireTypes elementType>
+    static void wrapListSerializer() {
+        using L = QList<V>;
+        handlers().insert(qMetaTypeId<L>(), {
+                serializeWrapper<L, serializeListType<V>>,
+                deserializeWrapper<L, deserializeList<V>>,
+                sizeWrapper<L>,
+                serializePropertyWrapper<L, L, serializeListType<V>>,
+                deserializePropertyWrapper<L, L, deserializeList<V>>,
+                propertySizeWrapper<L, L>,
+                LengthDelimited,
+                nullptr,
+                deserializeWrapper<L, deserializeListElement<V>>,
+                elementType
+        });
+    }
+
+    /*!
+     * \brief Counts entries of length-delimited field with \a fieldNumber that follow each other
+     *
+     * \details \a it points to the size of the first entry, its header is already decoded. Is used to preallocate
+     *          hash maps before their entries are decoded.
+     */
+    static int countLengthDelimitedEntries(const QProtobufSelfcheckIterator &it, int fieldNumber);
+
     // this set of 3 methods is used to skip bytes corresponding to an unexpected property
     // in a serialized message met while the message being deserialized
     static int skipSerializedFieldBytes(QProtobufSelfcheckIterator &it, WireTypes type);
     static void skipVarint(QProtobufSelfcheckIterator &it);
     static void skipLengthDelimited(QProtobufSelfcheckIterator &it);
 
-    QByteArray serializeProperty(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty);
-    void deserializeProperty(QObject *object, const QProtobufMetaObject &metaObject, QProtobufSelfcheckIterator &it);
+    /*!
+     * \brief Serializes \a object, serialized bytes are taken from and stored to encode cache if it's enabled
+     */
+    void serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject, QByteArray &buffer);
+    void writeMessage(const QObject *object, const QProtobufMetaObject &metaObject, QByteArray &buffer);
+    /*!
+     * \brief Serializes fields of \a object marked in \a fields words, all fields if \a fields is nullptr
+     * \details Unknown fields are not written
+     */
+    void serializeFields(const QObject *object, const QProtobufMetaObject &metaObject, const quint32 *fields, QByteArray &buffer);
+    void serializeProperty(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty, QByteArray &buffer,
+                           const SerializationHandlers *typeHandlers = nullptr);
+
+    /*!
+     * \brief Deserializes \a data to \a object
+     *
+     * \details Fields that are not in \a fieldMask are skipped if mask is set. Generated direct deserializer is
+     *          not used in this case and in merge mode.
+     */
+    void deserializeMessage(QObject *object, const QProtobufMetaObject &metaObject, const QByteArray &data,
+                            const QProtobufFieldMask *fieldMask = nullptr);
+
+    int messageSize(const QObject *object, const QProtobufMetaObject &metaObject);
+    int propertySize(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty,
+                     const SerializationHandlers *typeHandlers = nullptr);
+
+    /*!
+     * \brief Sizes of nested messages calculated while serialization of top-level message
+     *
+     * \details Sizes are calculated once before the message is written, so length of nested messages
+     *          is known at the moment when it's written and no payload moves are required.
+     */
+    using SizeCache = std::unordered_map<const QObject *, int>;
+    static void cacheMessageSize(const QObject *object, int size);
+    static bool cachedMessageSize(const QObject *object, int &size);
+
+    /*!
+     * \brief Serialized bytes of message stored by encode cache
+     *
+     * \details Entry is valid while message is alive, its revision is not changed and entries of nested messages,
+     *          which bytes are part of \a data, are valid too. Nested messages are listed with revisions they had
+     *          when \a data was written.
+     */
+    struct EncodedMessage {
+        QPointer<QObject> object;
+        const QProtobufMetaObject *metaObject;
+        quint64 revision;
+        QByteArray data;
+        std::vector<std::pair<const QObject *, quint64>> nested;
+    };
+    using EncodeCache = std::unordered_map<const QObject *, EncodedMessage>;
+    //Reads valid bytes of \a object with \a revision to \a data
+    bool findEncoded(const QObject *object, quint64 revision, QByteArray &data) const;
+    //Must be called with encodeCacheMutex locked
+    bool isEncodedValid(const EncodedMessage &entry) const;
+    void storeEncoded(const QObject *object, const QProtobufMetaObject &metaObject, quint64 revision, QByteArray &&data,
+                      std::vector<std::pair<const QObject *, quint64>> &&nested);
+    void clearEncodeCache();
+
+    //Size of chunks written to device by streaming serialization
+    static constexpr int StreamChunkSize = 64 * 1024;
+    /*!
+     * \brief Writes \a buffer to device of streaming serialization that is in progress in current thread
+     *
+     * \details Does nothing if \a buffer is not the buffer of streaming serialization, if it's shorter than
+     *          StreamChunkSize or if it contains length-delimited sections that are not yet complete.
+     */
+    static void flushStreamChunk(QByteArray &buffer);
+    /*!
+     * \brief Values of repeated fields collected while single message is deserialized
+     *
+     * \details Repeated and map fields that are not packed are received element by element. Elements are appended
+     *          to the value stored here and property is written once, when whole message is deserialized.
+     *          Values are indexed same as fields in QProtobufFieldPlan.
+     */
+    struct RepeatedValue {
+        QVariant value;
+        int count = 0;//Number of received elements, checked against element count limit
+    };
+    using RepeatedValues = std::vector<RepeatedValue>;
+    //expectedField is position of field in ordering table, that is expected to be received next
+    void deserializeProperty(QObject *object, const QProtobufMetaObject &metaObject, QProtobufSelfcheckIterator &it,
+                             RepeatedValues &repeatedValues, const QProtobufFieldMask *fieldMask, size_t &expectedField);
 
     void deserializeMapPair(QVariant &key, QVariant &value, QProtobufSelfcheckIterator &it);
+    bool zeroCopyBytesEnabled = false;
+    //Zero-copy bytes mode of deserialization that is in progress in current thread
+    static thread_local bool zeroCopyBytes;
+    bool lazyMessagesEnabled = false;
+    //Lazy messages mode of deserialization that is in progress in current thread
+    static thread_local bool lazyMessages;
+    bool preserveUnknownFieldsEnabled = false;
+    //Unknown fields preservation mode of deserialization that is in progress in current thread
+    static thread_local bool preserveUnknownFields;
+    //Merge mode of deserialization that is in progress in current thread
+    static thread_local bool mergeFields;
+    bool stringInterningEnabled = false;
+    //Decoded strings of deserialization that is in progress in current thread by UTF-8 payload,
+    //nullptr if string interning is disabled
+    using StringInternTable = QHash<QByteArray, QString>;
+    static thread_local StringInternTable *stringInternTable;
+    //Strings of field that is deserialized in current thread are interned
+    static thread_local bool internStrings;
+    //Unknown fields are not written by serialization that is in progress in current thread
+    static thread_local bool skipUnknownFields;
+    bool parallelListSerializationEnabled = false;
+    bool deterministicEnabled = false;
+    bool encodeCacheEnabled = false;
+    mutable QMutex encodeCacheMutex;
+    EncodeCache encodeCache;
+    //Entries of destroyed messages are dropped when cache grows to this size
+    size_t encodeCacheSweepSize = 0;
+    bool parallelDecodeEnabled = false;
+    int maxMessageSize = 0;
+    int maxRecursionDepth = 100;
+    int maxElementCount = 0;
+    int maxTotalElementCount = 0;
+    //Limits of deserialization that is in progress in current thread, 0 means no limit
+    static thread_local int recursionDepthLimit;
+    static thread_local int elementCountLimit;
+    //Nesting depth of message that is deserialized in current thread
+    static thread_local int recursionDepth;
+    //Number of elements that top-level message deserialized in current thread may still contain, nullptr means no limit
+    static thread_local std::atomic<int> *elementBudget;
+    //Reports LimitExceededError if \a count elements exceed element count limit
+    static bool checkElementCount(int count) {
+        if (elementCountLimit > 0 && count > elementCountLimit) {
+            QtProtobufPrivate::reportDeserializationError(LimitExceededError, "Repeated field exceeds element count limit. Deserialization failed");
+            return false;
+        }
+        return true;
+    }
+    //Takes \a count elements from budget of top-level message, reports LimitExceededError if budget is exhausted
+    static bool consumeElements(int count) {
+        if (elementBudget != nullptr && elementBudget->fetch_sub(count, std::memory_order_relaxed) < count) {
+            QtProtobufPrivate::reportDeserializationError(LimitExceededError, "Message exceeds total element count limit. Deserialization failed");
+            return false;
+        }
+        return true;
+    }
+    /*!
+     * \brief Looks up handlers of \a userType in dispatch table
+     * \details Handlers of complex types are resolved from QtProtobuf global serializers registry at first use
+     * \return pointer to handlers or nullptr if nothing is registered for \a userType
+     */
+    static const SerializationHandlers *findHandlers(int userType);
+    /*!
+     * \brief Registers handlers of basic types in dispatch table, only first call has effect
+     */
+    static void registerBasicHandlers();
 private:
-    static SerializerRegistry handlers;
+    static SerializerRegistry &handlers();
     QProtobufSerializer *q_ptr;
 };
 
+//Bytes lists are not packed, specializations are defined in qprotobufserializer.cpp
+template<>
+void QProtobufSerializerPrivate::serializeListType<QByteArray>(const QByteArrayList &listValue, int &outFieldIndex, QByteArray &buffer);
+
+template<>
+void QProtobufSerializerPrivate::deserializeList<QByteArray>(QProtobufSelfcheckIterator &it, QByteArrayList &previousValue);
+
 //###########################################################################
 //                             Common functions
 //###########################################################################
@@ -462,13 +1289,20 @@ private:
  *  bit number | 7  6  5  4  3 | 2  1  0
  * \param fieldIndex The index of a property in parent object
  * \param wireType Serialization type used for the property with index @p fieldIndex
- *
- * \return Varint encoded fieldIndex and wireType
+ * \param buffer Byte array where varint encoded fieldIndex and wireType are appended
  */
-inline QByteArray QProtobufSerializerPrivate::encodeHeader(int fieldIndex, WireTypes wireType)
+inline void QProtobufSerializerPrivate::encodeHeader(int fieldIndex, WireTypes wireType, QByteArray &buffer)
 {
     uint32_t header = (fieldIndex << 3) | wireType;
-    return serializeVarintCommon<uint32_t>(header);
+    char encoded[maxVarintSize<uint32_t>()];
+    buffer.append(encoded, encodeVarint<uint32_t>(header, encoded));
+}
+
+inline QByteArray QProtobufSerializerPrivate::encodeHeader(int fieldIndex, WireTypes wireType)
+{
+    QByteArray result;
+    encodeHeader(fieldIndex, wireType, result);
+    return result;
 }
 
 /*! \brief Decode a property field index and its serialization type from input bytes
@@ -35,6 +35,8 @@
 #include <QPluginLoader>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QMutex>
+#include <QAtomicPointer>
 
 namespace {
 const QLatin1String TypeNames("types");
@@ -131,12 +133,17 @@ class QProtobufSerializerRegistryPrivate
 {
 
 public:
+    //Plugin records by plugin name, published index is never modified, so it's read without locking
+    using PluginIndex = std::unordered_map<QString, const QProtobufSerializerRegistryPrivateRecord *>;
+
     QProtobufSerializerRegistryPrivate()
     {
         // create default impl
         std::shared_ptr<QProtobufSerializerRegistryPrivateRecord> plugin = std::shared_ptr<QProtobufSerializerRegistryPrivateRecord>(new QProtobufSerializerRegistryPrivateRecord());
         plugin->createDefaultImpl();
+        m_defaultPlugin = plugin.get();
         m_plugins[DefaultImpl] = plugin;
+        publish(DefaultImpl, plugin.get());
         m_pluginPath = QString::fromUtf8(QtProtobufPluginPath);
         QString envPluginPath = QString::fromUtf8(qgetenv("QT_PROTOBUF_PLUGIN_PATH"));
         if (!envPluginPath.isEmpty()) {
@@ -148,6 +155,7 @@ public:
     {
         assert(!name.isEmpty());
 
+        QMutexLocker locker(&m_loadLock);
         std::shared_ptr<QProtobufSerializerRegistryPrivateRecord> plugin = std::shared_ptr<QProtobufSerializerRegistryPrivateRecord>(new QProtobufSerializerRegistryPrivateRecord());
         QString libPath = m_pluginPath + QDir::separator() + LibPrefix + name + LibExtension;
         plugin->loadPluginMetadata(libPath);
@@ -156,6 +164,7 @@ public:
         if (m_plugins.find(pluginName) == m_plugins.end()) {
             plugin->loadPlugin();
             m_plugins[pluginName] = plugin;
+            publish(pluginName, plugin.get());
         } else {
             plugin->loader = nullptr;
             qProtoInfo() << "Serializer plugin with name" << pluginName << "is already loaded";
@@ -163,9 +172,39 @@ public:
         return pluginName;
     }
 
+    //Returns index of loaded plugins, doesn't lock
+    const PluginIndex &index() const
+    {
+        return *m_index.loadAcquire();
+    }
+
+    //Returns record of loaded plugin or nullptr, doesn't lock
+    const QProtobufSerializerRegistryPrivateRecord *findPlugin(const QString &plugin) const
+    {
+        const PluginIndex &plugins = index();
+        auto it = plugins.find(plugin);
+        return it != plugins.end() ? it->second : nullptr;
+    }
 
     std::unordered_map<QString/*pluginName*/, std::shared_ptr<QProtobufSerializerRegistryPrivateRecord>> m_plugins;
+    //Record of built-in serializers, it's not changed after construction
+    const QProtobufSerializerRegistryPrivateRecord *m_defaultPlugin;
     QString m_pluginPath;
+
+private:
+    //Publishes new index with loaded \a record, called when loading is finished and record is not changed anymore
+    void publish(const QString &pluginName, const QProtobufSerializerRegistryPrivateRecord *record)
+    {
+        std::unique_ptr<PluginIndex> index(m_indexes.empty() ? new PluginIndex : new PluginIndex(*m_indexes.back()));
+        (*index)[pluginName] = record;
+        m_index.storeRelease(index.get());
+        //Previous indexes are kept, since readers may still use them
+        m_indexes.push_back(std::move(index));
+    }
+
+    QMutex m_loadLock;
+    QAtomicPointer<const PluginIndex> m_index;
+    std::vector<std::unique_ptr<const PluginIndex>> m_indexes;
 };
 
 }
@@ -186,27 +225,66 @@ QString QProtobufSerializerRegistry::loadPlugin(const QString &name)
 
 std::shared_ptr<QAbstractProtobufSerializer> QProtobufSerializerRegistry::getSerializer(const QString &id)
 {
-    return dPtr->m_plugins[DefaultImpl]->serializers.at(id); //throws
+    return dPtr->m_defaultPlugin->serializers.at(id); //throws
 }
 
 std::shared_ptr<QAbstractProtobufSerializer> QProtobufSerializerRegistry::getSerializer(const QString &id, const QString &plugin)
 {
-    return dPtr->m_plugins[plugin]->serializers.at(id); //throws
+    return dPtr->index().at(plugin)->serializers.at(id); //throws
+}
+
+QAbstractProtobufSerializer *QProtobufSerializerRegistry::findSerializer(const QString &id, const QString &plugin) const
+{
+    const QProtobufSerializerRegistryPrivateRecord *record = plugin.isEmpty() ? dPtr->m_defaultPlugin : dPtr->findPlugin(plugin);
+    if (record == nullptr) {
+        return nullptr;
+    }
+    auto it = record->serializers.find(id);
+    return it != record->serializers.end() ? it->second.get() : nullptr;
+}
+
+QStringList QProtobufSerializerRegistry::preloadPlugins(const QStringList &plugins)
+{
+    QStringList loadedPlugins;
+    for (const QString &name : plugins) {
+        const QString pluginName = loadPlugin(name);
+        if (!pluginName.isEmpty()) {
+            loadedPlugins.append(pluginName);
+        }
+    }
+    return loadedPlugins;
 }
 
-std::unique_ptr<QAbstractProtobufSerializer> QProtobufSerializerRegistry::acquireSerializer(const QString &/*id*/, const QString &/*plugin*/)
+std::unique_ptr<QAbstractProtobufSerializer> QProtobufSerializerRegistry::acquireSerializer(const QString &id, const QString &plugin)
 {
-    Q_ASSERT_X(false, "QProtobufSerializerRegistry", "acquireSerializer is unimplemented");
+    if (!plugin.isEmpty()) {
+        qProtoWarning() << "Serializer" << id << "of plugin" << plugin << "can't be acquired, plugins provide shared serializers only";
+        return std::unique_ptr<QAbstractProtobufSerializer>();
+    }
+
+    if (id == ProtobufSerializer) {
+        return std::unique_ptr<QAbstractProtobufSerializer>(new QProtobufSerializer);
+    }
+    if (id == JsonSerializer) {
+        return std::unique_ptr<QAbstractProtobufSerializer>(new QProtobufJsonSerializer);
+    }
     return std::unique_ptr<QAbstractProtobufSerializer>();
 }
 
-float QProtobufSerializerRegistry::pluginVersion(const QString &plugin)
+QAbstractProtobufSerializer *QProtobufSerializerRegistry::threadSerializer(const QString &id)
 {
-    if (dPtr->m_plugins.find(plugin) == dPtr->m_plugins.end())
-        return 0.0;
+    static thread_local std::unordered_map<QString, std::unique_ptr<QAbstractProtobufSerializer>> serializers;
+    auto it = serializers.find(id);
+    if (it == serializers.end()) {
+        it = serializers.emplace(id, acquireSerializer(id)).first;
+    }
+    return it->second.get();
+}
 
-    std::shared_ptr<QProtobufSerializerRegistryPrivateRecord> implementation = dPtr->m_plugins[plugin];
-    if (implementation->metaData.isEmpty())
+float QProtobufSerializerRegistry::pluginVersion(const QString &plugin)
+{
+    const QProtobufSerializerRegistryPrivateRecord *implementation = dPtr->findPlugin(plugin);
+    if (implementation == nullptr || implementation->metaData.isEmpty())
         return 0.0;
 
     return implementation->metaData.value(Version).toFloat();
@@ -216,11 +294,10 @@ QStringList QProtobufSerializerRegistry::pluginSerializers(const QString &plugin
 {
     QStringList strList;
 
-    if (dPtr->m_plugins.find(plugin) == dPtr->m_plugins.end())
+    const QProtobufSerializerRegistryPrivateRecord *implementation = dPtr->findPlugin(plugin);
+    if (implementation == nullptr)
         return strList;
 
-    std::shared_ptr<QProtobufSerializerRegistryPrivateRecord> implementation = dPtr->m_plugins[plugin];
-
     QVariantList typeArray = implementation->metaData.value(TypeNames).toList();
     foreach(QVariant value, typeArray) {
         if (!value.toString().isEmpty()) {
@@ -232,11 +309,8 @@ QStringList QProtobufSerializerRegistry::pluginSerializers(const QString &plugin
 
 float QProtobufSerializerRegistry::pluginProtobufVersion(const QString &plugin)
 {
-    if (dPtr->m_plugins.find(plugin) == dPtr->m_plugins.end())
-        return 0.0;
-
-    std::shared_ptr<QProtobufSerializerRegistryPrivateRecord> implementation = dPtr->m_plugins[plugin];
-    if (implementation.get() && implementation->metaData.isEmpty())
+    const QProtobufSerializerRegistryPrivateRecord *implementation = dPtr->findPlugin(plugin);
+    if (implementation == nullptr || implementation->metaData.isEmpty())
         return 0.0;
 
     return implementation->metaData.value(ProtoVersion).toFloat();
@@ -244,11 +318,8 @@ float QProtobufSerializerRegistry::pluginProtobufVersion(const QString &plugin)
 
 int QProtobufSerializerRegistry::pluginRating(const QString &plugin)
 {
-    if (dPtr->m_plugins.find(plugin) == dPtr->m_plugins.end())
-        return 0;
-
-    std::shared_ptr<QProtobufSerializerRegistryPrivateRecord> implementation = dPtr->m_plugins[plugin];
-    if (implementation->metaData.isEmpty())
+    const QProtobufSerializerRegistryPrivateRecord *implementation = dPtr->findPlugin(plugin);
+    if (implementation == nullptr || implementation->metaData.isEmpty())
         return 0;
 
     return implementation->metaData.value(Rating).toInt();
@@ -49,13 +49,42 @@ class QProtobufSerializerRegistryPrivate;
  * \details Class reads list of plugins from folder defined by QT_INSTALL_PLUGINS variable.
  *          User can choose specific plugin or list of plugins with serializer implementations.
  *          Pay attention, QProtobufSerializerRegistry not load all plugins, but only required by user.
+ *          Plugins might be loaded at application startup using preloadPlugins(), so first call doesn't wait
+ *          for plugin library loading. Lookup of serializers of loaded plugins doesn't lock.
  */
 class Q_PROTOBUF_EXPORT QProtobufSerializerRegistry final
 {
 public:
     std::shared_ptr<QAbstractProtobufSerializer> getSerializer(const QString &id);
     std::shared_ptr<QAbstractProtobufSerializer> getSerializer(const QString &id, const QString &plugin);
-    std::unique_ptr<QAbstractProtobufSerializer> acquireSerializer(const QString &id, const QString &plugin);
+    /*!
+     * \brief Creates new instance of built-in serializer \a id, that isn't shared with other users
+     * \details Plugins provide shared serializers only, so nullptr is returned if \a plugin is not empty or
+     *          serializer \a id is unknown.
+     */
+    std::unique_ptr<QAbstractProtobufSerializer> acquireSerializer(const QString &id, const QString &plugin = QString());
+
+    /*!
+     * \brief Returns built-in serializer \a id owned by calling thread
+     * \details Serializer is created at first call in each thread and destroyed when thread exits. Options set on
+     *          returned serializer and its state, e.g. encode cache, are used by calling thread only, so threads that
+     *          encode messages with their own serializers don't share mutable state. Returned pointer must not be
+     *          used by other threads. nullptr is returned if serializer \a id is unknown.
+     */
+    QAbstractProtobufSerializer *threadSerializer(const QString &id);
+
+    /*!
+     * \brief Returns serializer \a id of loaded \a plugin or of built-in serializers if \a plugin is empty
+     * \details Lookup doesn't lock or allocate. Returned pointer is owned by registry and stays valid until
+     *          program exit, nullptr is returned if serializer is not found.
+     */
+    QAbstractProtobufSerializer *findSerializer(const QString &id, const QString &plugin = QString()) const;
+
+    /*!
+     * \brief Loads \a plugins and creates their serializers, intended to be called at application startup
+     * \return names of loaded plugins
+     */
+    QStringList preloadPlugins(const QStringList &plugins);
     float pluginVersion(const QString &plugin);
     QStringList pluginSerializers(const QString &plugin);
     float pluginProtobufVersion(const QString &plugin);
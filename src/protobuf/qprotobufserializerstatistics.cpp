@@ -0,0 +1,190 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qprotobufserializerstatistics.h"
+
+#include <QHash>
+#include <QReadWriteLock>
+
+#include <memory>
+
+using namespace QtProtobuf;
+
+namespace QtProtobufPrivate {
+
+//! \private
+struct MessageStatisticsEntry {
+    std::atomic<quint64> serializeCount{0};
+    std::atomic<qint64> serializeNanoseconds{0};
+    std::atomic<quint64> bytesProduced{0};
+    std::atomic<quint64> deserializeCount{0};
+    std::atomic<qint64> deserializeNanoseconds{0};
+    std::atomic<quint64> bytesConsumed{0};
+    std::atomic<quint64> unknownFields{0};
+    std::atomic<quint64> errors{0};
+    std::atomic<quint64> allocations{0};
+};
+
+}
+
+namespace  {
+using QtProtobufPrivate::MessageStatisticsEntry;
+
+struct StatisticsRegistry {
+    //! \brief Returns entry of \a typeName, entries are never removed so pointer stays valid
+    MessageStatisticsEntry *entry(const char *typeName) {
+        const QByteArray name = QByteArray::fromRawData(typeName, static_cast<int>(qstrlen(typeName)));
+        {
+            QReadLocker locker(&lock);
+            auto it = entries.constFind(name);
+            if (it != entries.constEnd()) {
+                return it.value().get();
+            }
+        }
+
+        QWriteLocker locker(&lock);
+        std::shared_ptr<MessageStatisticsEntry> &entry = entries[QByteArray(typeName)];
+        if (!entry) {
+            entry = std::make_shared<MessageStatisticsEntry>();
+        }
+        return entry.get();
+    }
+
+    QReadWriteLock lock;
+    QHash<QByteArray, std::shared_ptr<MessageStatisticsEntry>> entries;
+};
+
+StatisticsRegistry &registry()
+{
+    static StatisticsRegistry instance;
+    return instance;
+}
+
+//Innermost scope of current thread, nested messages are accounted for top-level message
+thread_local QtProtobufPrivate::StatisticsScope *currentScope = nullptr;
+thread_local MessageStatisticsEntry *currentEntry = nullptr;
+}
+
+std::atomic<bool> QProtobufSerializerStatistics::m_enabled{false};
+
+void QProtobufSerializerStatistics::setEnabled(bool enabled)
+{
+    m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+QProtobufMessageStatistics QProtobufSerializerStatistics::statistics(const QByteArray &typeName)
+{
+    QProtobufMessageStatistics result;
+    QReadLocker locker(&registry().lock);
+    auto it = registry().entries.constFind(typeName);
+    if (it == registry().entries.constEnd()) {
+        return result;
+    }
+
+    const MessageStatisticsEntry *entry = it.value().get();
+    result.serializeCount = entry->serializeCount.load(std::memory_order_relaxed);
+    result.serializeNanoseconds = entry->serializeNanoseconds.load(std::memory_order_relaxed);
+    result.bytesProduced = entry->bytesProduced.load(std::memory_order_relaxed);
+    result.deserializeCount = entry->deserializeCount.load(std::memory_order_relaxed);
+    result.deserializeNanoseconds = entry->deserializeNanoseconds.load(std::memory_order_relaxed);
+    result.bytesConsumed = entry->bytesConsumed.load(std::memory_order_relaxed);
+    result.unknownFields = entry->unknownFields.load(std::memory_order_relaxed);
+    result.errors = entry->errors.load(std::memory_order_relaxed);
+    result.allocations = entry->allocations.load(std::memory_order_relaxed);
+    return result;
+}
+
+QList<QByteArray> QProtobufSerializerStatistics::messageTypes()
+{
+    QReadLocker locker(&registry().lock);
+    return registry().entries.keys();
+}
+
+void QProtobufSerializerStatistics::reset()
+{
+    //Entries are kept, because they may be referenced by active scopes
+    QReadLocker locker(&registry().lock);
+    for (const auto &entry : registry().entries) {
+        entry->serializeCount = 0;
+        entry->serializeNanoseconds = 0;
+        entry->bytesProduced = 0;
+        entry->deserializeCount = 0;
+        entry->deserializeNanoseconds = 0;
+        entry->bytesConsumed = 0;
+        entry->unknownFields = 0;
+        entry->errors = 0;
+        entry->allocations = 0;
+    }
+}
+
+using namespace QtProtobufPrivate;
+
+void StatisticsScope::begin(const char *typeName, Operation operation, qint64 inputBytes)
+{
+    m_entry = registry().entry(typeName);
+    m_operation = operation;
+    m_inputBytes = inputBytes;
+    m_previous = currentScope;
+    currentScope = this;
+    currentEntry = m_entry;
+    m_timer.start();
+}
+
+void StatisticsScope::end()
+{
+    const qint64 elapsed = m_timer.nsecsElapsed();
+    if (m_operation == Serialize) {
+        m_entry->serializeCount.fetch_add(1, std::memory_order_relaxed);
+        m_entry->serializeNanoseconds.fetch_add(elapsed, std::memory_order_relaxed);
+        m_entry->bytesProduced.fetch_add(static_cast<quint64>(m_outputBytes), std::memory_order_relaxed);
+    } else {
+        m_entry->deserializeCount.fetch_add(1, std::memory_order_relaxed);
+        m_entry->deserializeNanoseconds.fetch_add(elapsed, std::memory_order_relaxed);
+        m_entry->bytesConsumed.fetch_add(static_cast<quint64>(m_inputBytes), std::memory_order_relaxed);
+    }
+    currentScope = m_previous;
+    currentEntry = m_previous != nullptr ? m_previous->m_entry : nullptr;
+}
+
+void StatisticsScope::errorOccurred()
+{
+    if (m_entry != nullptr) {
+        m_entry->errors.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void StatisticsScope::recordUnknownField()
+{
+    if (currentEntry != nullptr) {
+        currentEntry->unknownFields.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void StatisticsScope::recordAllocation()
+{
+    if (currentEntry != nullptr) {
+        currentEntry->allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,177 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufSerializerStatistics
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+
+#include <atomic>
+
+#include "qtprotobufglobal.h"
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufMessageStatistics struct contains serialization statistics of message type
+ * \details Statistics are collected for top-level messages passed to QAbstractProtobufSerializer, time and bytes
+ *          of nested messages are accounted for top-level message. Unknown fields and allocations of nested messages
+ *          are accounted for top-level message as well. Messages serialized or deserialized inside
+ *          generated code directly, bypassing QAbstractProtobufSerializer templates, are not accounted.
+ */
+struct QProtobufMessageStatistics {
+    quint64 serializeCount = 0;      //!< Number of serialized messages
+    qint64 serializeNanoseconds = 0; //!< Total time of serialization
+    quint64 bytesProduced = 0;       //!< Total size of serialized messages
+    quint64 deserializeCount = 0;    //!< Number of deserialized messages
+    qint64 deserializeNanoseconds = 0; //!< Total time of deserialization
+    quint64 bytesConsumed = 0;       //!< Total size of deserialized data
+    quint64 unknownFields = 0;       //!< Number of fields, that are skipped as unknown during deserialization
+    quint64 errors = 0;              //!< Number of failed deserializations, either thrown or reported
+    quint64 allocations = 0;         //!< Number of message objects allocated during deserialization of repeated fields
+};
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufSerializerStatistics class collects timing and allocation statistics of serialization
+ *        per message type
+ * \details Collection is disabled by default. When disabled, serialization checks single atomic flag only.
+ *          Statistics are collected for all serializers in all threads.
+ *          \code{.cpp}
+ *          QProtobufSerializerStatistics::setEnabled(true);
+ *          ...
+ *          for (const QByteArray &type : QProtobufSerializerStatistics::messageTypes()) {
+ *              qDebug() << type << QProtobufSerializerStatistics::statistics(type).deserializeNanoseconds;
+ *          }
+ *          \endcode
+ */
+class Q_PROTOBUF_EXPORT QProtobufSerializerStatistics
+{
+public:
+    /*!
+     * \brief Enables or disables collection of statistics
+     */
+    static void setEnabled(bool enabled);
+
+    /*!
+     * \brief Returns true if statistics are collected
+     */
+    static bool isEnabled() {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Returns statistics of message type with \a typeName, e.g. "qtprotobufnamespace::tests::SimpleStringMessage"
+     */
+    static QProtobufMessageStatistics statistics(const QByteArray &typeName);
+
+    /*!
+     * \brief Returns names of message types, which statistics are collected
+     */
+    static QList<QByteArray> messageTypes();
+
+    /*!
+     * \brief Resets statistics of all message types
+     */
+    static void reset();
+
+private:
+    QProtobufSerializerStatistics() = delete;
+
+    static std::atomic<bool> m_enabled;
+};
+
+}
+
+namespace QtProtobufPrivate {
+
+struct MessageStatisticsEntry;
+
+/*!
+ * \private
+ * \brief The StatisticsScope class records statistics of top-level message serialization while scope is alive
+ * \details Scope takes no action if statistics are disabled, when scope is created.
+ */
+class Q_PROTOBUF_EXPORT StatisticsScope
+{
+public:
+    enum Operation {
+        Serialize,
+        Deserialize
+    };
+
+    StatisticsScope(const char *typeName, Operation operation, qint64 inputBytes = 0) {
+        if (QtProtobuf::QProtobufSerializerStatistics::isEnabled()) {
+            begin(typeName, operation, inputBytes);
+        }
+    }
+
+    ~StatisticsScope() {
+        if (m_entry != nullptr) {
+            end();
+        }
+    }
+
+    //! \brief Sets size of serialized message, that is produced by scope
+    void setOutputBytes(qint64 bytes) {
+        m_outputBytes = bytes;
+    }
+
+    //! \brief Records deserialization error happened in scope
+    void errorOccurred();
+
+    //! \brief Records unknown field skipped by deserialization in current thread
+    static void unknownFieldSkipped() {
+        if (QtProtobuf::QProtobufSerializerStatistics::isEnabled()) {
+            recordUnknownField();
+        }
+    }
+
+    //! \brief Records message object allocated by deserialization in current thread
+    static void messageAllocated() {
+        if (QtProtobuf::QProtobufSerializerStatistics::isEnabled()) {
+            recordAllocation();
+        }
+    }
+
+private:
+    Q_DISABLE_COPY(StatisticsScope)
+
+    void begin(const char *typeName, Operation operation, qint64 inputBytes);
+    void end();
+    static void recordUnknownField();
+    static void recordAllocation();
+
+    MessageStatisticsEntry *m_entry = nullptr;
+    StatisticsScope *m_previous = nullptr;
+    Operation m_operation = Serialize;
+    qint64 m_inputBytes = 0;
+    qint64 m_outputBytes = 0;
+    QElapsedTimer m_timer;
+};
+
+}
@@ -0,0 +1,180 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qprotobufsliceddecoder.h"
+#include "qprotobufstreamparser.h"
+#include "qprotobufselfcheckiterator.h"
+#include "qtprotobuflogging.h"
+
+#include <algorithm>
+
+using namespace QtProtobuf;
+
+namespace QtProtobuf {
+
+//! \private
+class QProtobufSlicedDecoderPrivate
+{
+public:
+    QProtobufSlicedDecoderPrivate() : parser([this](int, WireTypes, const QByteArray &field) {
+                                          fields.append(field);
+                                      })
+      , position(0)
+      , sliceSize(QProtobufSlicedDecoder::DefaultSliceSize)
+      , running(false)
+      , scheduled(false) {}
+
+    QProtobufStreamParser parser;
+    QByteArray data;
+    QByteArray fields;
+    int position;
+    int sliceSize;
+    bool running;
+    bool scheduled;
+    std::function<void(const QByteArray &)> decodeFields;
+    std::function<void()> commit;
+};
+
+}
+
+QProtobufSlicedDecoder::QProtobufSlicedDecoder(QAbstractProtobufSerializer *serializer, QObject *parent) : QObject(parent)
+  , m_serializer(serializer)
+  , dPtr(new QProtobufSlicedDecoderPrivate)
+{
+    Q_ASSERT(m_serializer != nullptr);
+}
+
+QProtobufSlicedDecoder::~QProtobufSlicedDecoder() = default;
+
+void QProtobufSlicedDecoder::start(const QByteArray &data, const std::function<void(const QByteArray &)> &decodeFields,
+                                   const std::function<void()> &commit)
+{
+    abort();
+    dPtr->data = data;
+    dPtr->decodeFields = decodeFields;
+    dPtr->commit = commit;
+    dPtr->running = true;
+    schedule();
+}
+
+bool QProtobufSlicedDecoder::processNextSlice()
+{
+    if (!dPtr->running) {
+        return false;
+    }
+
+    const int count = std::min(dPtr->sliceSize, dPtr->data.size() - dPtr->position);
+    const bool valid = dPtr->parser.feed(QByteArray::fromRawData(dPtr->data.constData() + dPtr->position, count));
+    dPtr->position += count;
+
+    DeserializationError error = NoDeserializationError;
+    if (!dPtr->fields.isEmpty()) {
+        QtProtobufPrivate::DeserializationErrorScope scope;
+        dPtr->decodeFields(dPtr->fields);
+        dPtr->fields.resize(0);
+        error = scope.error();
+    }
+
+    if (error == NoDeserializationError && !valid) {
+        error = InvalidHeaderError;
+    }
+
+    const bool atEnd = dPtr->position >= dPtr->data.size();
+    if (error == NoDeserializationError && atEnd && !dPtr->parser.isAtFieldBoundary()) {
+        error = UnexpectedEndOfStreamError;
+    }
+
+    if (error != NoDeserializationError || atEnd) {
+        if (error != NoDeserializationError) {
+            qProtoWarning() << "Sliced decoding failed at byte" << dPtr->position << "error" << error;
+        }
+        finish(error);
+        return false;
+    }
+
+    emit progress(dPtr->position, dPtr->data.size());
+    return true;
+}
+
+void QProtobufSlicedDecoder::abort()
+{
+    dPtr->running = false;
+    dPtr->parser.reset();
+    dPtr->data.clear();
+    dPtr->fields.clear();
+    dPtr->position = 0;
+    dPtr->decodeFields = nullptr;
+    dPtr->commit = nullptr;
+}
+
+bool QProtobufSlicedDecoder::isRunning() const
+{
+    return dPtr->running;
+}
+
+int QProtobufSlicedDecoder::sliceSize() const
+{
+    return dPtr->sliceSize;
+}
+
+void QProtobufSlicedDecoder::setSliceSize(int sliceSize)
+{
+    dPtr->sliceSize = std::max(1, sliceSize);
+}
+
+qint64 QProtobufSlicedDecoder::bytesDecoded() const
+{
+    return dPtr->position;
+}
+
+qint64 QProtobufSlicedDecoder::bytesTotal() const
+{
+    return dPtr->data.size();
+}
+
+void QProtobufSlicedDecoder::processScheduledSlice()
+{
+    dPtr->scheduled = false;
+    if (processNextSlice()) {
+        schedule();
+    }
+}
+
+void QProtobufSlicedDecoder::finish(DeserializationError error)
+{
+    std::function<void()> commit = std::move(dPtr->commit);
+    abort();
+    commit();
+    emit finished(error);
+}
+
+void QProtobufSlicedDecoder::schedule()
+{
+    //Queued call is delivered at next event loop iteration, after events that are pending already
+    if (!dPtr->scheduled) {
+        dPtr->scheduled = true;
+        QMetaObject::invokeMethod(this, "processScheduledSlice", Qt::QueuedConnection);
+    }
+}
@@ -0,0 +1,161 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufSlicedDecoder
+
+#include <QObject>
+#include <QPointer>
+#include <QByteArray>
+
+#include <functional>
+#include <memory>
+
+#include "qtprotobufglobal.h"
+#include "qabstractprotobufserializer.h"
+
+namespace QtProtobuf {
+
+class QProtobufSlicedDecoderPrivate;
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufSlicedDecoder class decodes large messages by slices, returning control to event loop
+ *        between them
+ *
+ * \details Decoding of message of several megabytes by deserialize() blocks the thread for a long time. If message
+ *          can't be decoded in other thread, e.g. because it's used by QML, sliced decoder keeps GUI responsive:
+ *          at most sliceSize() bytes of message are decoded per event loop iteration, next slice is scheduled as
+ *          queued call. Message is split to slices by QProtobufStreamParser at top-level field boundaries, so
+ *          field that is larger than slice is decoded in the slice that completes it. Elements of repeated fields
+ *          are separate top-level fields, so long lists are spread over slices evenly.
+ *
+ *          Message is decoded to intermediate object and assigned to target message when decoding is finished,
+ *          so target message is never observed partially decoded.
+ *          \code
+ *          QProtobufSlicedDecoder *decoder = new QProtobufSlicedDecoder(&serializer, this);
+ *          connect(decoder, &QProtobufSlicedDecoder::finished, this, [this](QtProtobuf::DeserializationError error) {
+ *              ...
+ *          });
+ *          decoder->decode(&m_catalog, data);
+ *          \endcode
+ *
+ *          Serializer must produce protobuf wire format, e.g. QProtobufSerializer, and must outlive the decoder.
+ *          Decoder doesn't take ownership of serializer.
+ */
+class Q_PROTOBUF_EXPORT QProtobufSlicedDecoder : public QObject
+{
+    Q_OBJECT
+public:
+    enum {
+        DefaultSliceSize = 256 * 1024 //!< Default number of bytes decoded per slice
+    };
+
+    explicit QProtobufSlicedDecoder(QAbstractProtobufSerializer *serializer, QObject *parent = nullptr);
+    ~QProtobufSlicedDecoder() override;
+
+    /*!
+     * \brief Starts decoding of \a data to \a message
+     *
+     * \details First slice is decoded at next event loop iteration. Decoding that is in progress is aborted.
+     *          \a message is assigned when decoding is finished, if it's still alive. \a data is shared by decoder,
+     *          so it may be released after call.
+     */
+    template<typename T>
+    void decode(T *message, const QByteArray &data) {
+        Q_ASSERT(message != nullptr);
+        QAbstractProtobufSerializer *serializer = m_serializer;
+        std::shared_ptr<T> value = std::make_shared<T>();
+        QPointer<T> target(message);
+        start(data, [serializer, value](const QByteArray &fields) {
+            serializer->deserializeInPlace<T>(value.get(), fields);
+        }, [target, value]() {
+            if (!target.isNull()) {
+                *target = std::move(*value);
+            }
+        });
+    }
+
+    /*!
+     * \brief Decodes next slice immediately
+     *
+     * \details May be used to drive decoding manually, e.g. from frame callback of rendering loop.
+     * \return true if decoding is not finished yet
+     */
+    bool processNextSlice();
+
+    /*!
+     * \brief Stops decoding that is in progress. finished() is not emitted and target message is not changed
+     */
+    void abort();
+
+    /*!
+     * \brief Returns true if decoding is started and not finished yet
+     */
+    bool isRunning() const;
+
+    /*!
+     * \brief Maximum number of bytes of message decoded per slice
+     */
+    int sliceSize() const;
+    void setSliceSize(int sliceSize);
+
+    /*!
+     * \brief Returns number of bytes of current message that are decoded already
+     */
+    qint64 bytesDecoded() const;
+
+    /*!
+     * \brief Returns size of current message
+     */
+    qint64 bytesTotal() const;
+
+signals:
+    /*!
+     * \brief Is emitted after every slice that doesn't finish decoding
+     */
+    void progress(qint64 bytesDecoded, qint64 bytesTotal);
+
+    /*!
+     * \brief Is emitted when message is decoded and assigned to target message
+     * \details In case of \a error target message contains fields that were decoded before error happened.
+     */
+    void finished(QtProtobuf::DeserializationError error);
+
+private slots:
+    void processScheduledSlice();
+
+private:
+    Q_DISABLE_COPY_MOVE(QProtobufSlicedDecoder)
+
+    void start(const QByteArray &data, const std::function<void(const QByteArray &)> &decodeFields,
+               const std::function<void()> &commit);
+    void finish(DeserializationError error);
+    void schedule();
+
+    QAbstractProtobufSerializer *m_serializer;
+    std::unique_ptr<QProtobufSlicedDecoderPrivate> dPtr;
+};
+
+}
@@ -0,0 +1,185 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufSpaceUsed
+
+#include "qtprotobufglobal.h"
+#include "qtprotobuftypes.h"
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+#include <QSharedPointer>
+
+#include <cstddef>
+
+template <typename T>
+class QProtobufLazyMessagePointer;
+
+namespace QtProtobuf {
+
+/*!
+ * \addtogroup QtProtobuf
+ * \{
+ */
+
+/*!
+ * \brief Heap bytes owned by QObject part of message
+ *
+ * \details Private data of QObject is not part of public API, so its public base size is used as lower bound.
+ *          Dynamic properties and connections of message object are not counted.
+ */
+constexpr size_t QObjectSpaceUsed = sizeof(QObjectData);
+
+/*!
+ * \brief Family of functions that return heap bytes owned by field value, not including size of value itself
+ *
+ * \details Implicitly shared data is counted fully by every value that refers it, so sum over several messages
+ *          that share strings or lists is upper bound of their memory. Fields of types that have no overload,
+ *          e.g. value types or Qt types, are counted by their inline size only.
+ * \see spaceUsed() method of generated messages
+ */
+template <typename T>
+size_t spaceUsedOf(const T &value);
+size_t spaceUsedOf(const QString &value);
+size_t spaceUsedOf(const QByteArray &value);
+size_t spaceUsedOf(const utf8string &value);
+template <typename T>
+size_t spaceUsedOf(const QList<T> &value);
+template <typename T>
+size_t spaceUsedOf(const QVector<T> &value);
+template <typename K, typename V>
+size_t spaceUsedOf(const QHash<K, V> &value);
+template <typename K, typename V>
+size_t spaceUsedOf(const QMap<K, V> &value);
+template <typename T>
+size_t spaceUsedOf(const QSharedPointer<T> &value);
+template <typename T>
+size_t spaceUsedOf(const QProtobufLazyMessagePointer<T> &value);
+
+/*! \} */
+
+namespace QtProtobufPrivate {
+//Generated messages report memory they own including their own size, other types own no heap memory
+template <typename T>
+auto spaceUsedOfObject(const T &value, int) -> decltype(value.spaceUsed(), size_t()) {
+    return value.spaceUsed() - sizeof(T);
+}
+
+template <typename T>
+size_t spaceUsedOfObject(const T &, long) {
+    return 0;
+}
+}
+
+template <typename T>
+size_t spaceUsedOf(const T &value) {
+    return QtProtobufPrivate::spaceUsedOfObject(value, 0);
+}
+
+inline size_t spaceUsedOf(const QString &value) {
+    //Shared null, empty and raw data strings have no allocated capacity
+    return value.capacity() > 0 ? sizeof(QArrayData) + static_cast<size_t>(value.capacity() + 1) * sizeof(QChar) : 0;
+}
+
+inline size_t spaceUsedOf(const QByteArray &value) {
+    return value.capacity() > 0 ? sizeof(QArrayData) + static_cast<size_t>(value.capacity() + 1) : 0;
+}
+
+inline size_t spaceUsedOf(const utf8string &value) {
+    return spaceUsedOf(static_cast<const QByteArray &>(value));
+}
+
+template <typename T>
+size_t spaceUsedOf(const QList<T> &value) {
+    if (value.isEmpty()) {
+        return 0;
+    }
+    //Large and static types are stored by QList in separately allocated nodes
+    size_t size = sizeof(QListData::Data) + static_cast<size_t>(value.size()) * sizeof(void *);
+    if (QTypeInfo<T>::isLarge || QTypeInfo<T>::isStatic) {
+        size += static_cast<size_t>(value.size()) * sizeof(T);
+    }
+    for (const auto &element : value) {
+        size += spaceUsedOf(element);
+    }
+    return size;
+}
+
+template <typename T>
+size_t spaceUsedOf(const QVector<T> &value) {
+    if (value.capacity() == 0) {
+        return 0;
+    }
+    size_t size = sizeof(QArrayData) + static_cast<size_t>(value.capacity()) * sizeof(T);
+    for (const auto &element : value) {
+        size += spaceUsedOf(element);
+    }
+    return size;
+}
+
+template <typename K, typename V>
+size_t spaceUsedOf(const QHash<K, V> &value) {
+    if (value.capacity() == 0) {
+        return 0;
+    }
+    size_t size = sizeof(QHashData) + static_cast<size_t>(value.capacity()) * sizeof(void *)
+            + static_cast<size_t>(value.size()) * sizeof(QHashNode<K, V>);
+    for (auto it = value.constBegin(); it != value.constEnd(); ++it) {
+        size += spaceUsedOf(it.key()) + spaceUsedOf(it.value());
+    }
+    return size;
+}
+
+template <typename K, typename V>
+size_t spaceUsedOf(const QMap<K, V> &value) {
+    if (value.isEmpty()) {
+        return 0;
+    }
+    size_t size = sizeof(QMapDataBase) + static_cast<size_t>(value.size()) * sizeof(QMapNode<K, V>);
+    for (auto it = value.constBegin(); it != value.constEnd(); ++it) {
+        size += spaceUsedOf(it.key()) + spaceUsedOf(it.value());
+    }
+    return size;
+}
+
+template <typename T>
+size_t spaceUsedOf(const QSharedPointer<T> &value) {
+    if (value.isNull()) {
+        return 0;
+    }
+    return sizeof(QtSharedPointer::ExternalRefCountData) + sizeof(T) + spaceUsedOf(*value);
+}
+
+template <typename T>
+size_t spaceUsedOf(const QProtobufLazyMessagePointer<T> &value) {
+    return value.spaceUsed();
+}
+
+}
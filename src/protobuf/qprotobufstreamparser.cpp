@@ -0,0 +1,195 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qprotobufstreamparser.h"
+#include "qtprotobuflogging.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace QtProtobuf;
+
+namespace {
+//Maximum field number allowed by protobuf
+const uint64_t MaxFieldNumber = 536870911;
+//Maximum bits in varint encoded value
+const int MaxVarintShift = 63;
+}
+
+QProtobufStreamParser::QProtobufStreamParser(const FieldHandler &handler) : m_handler(handler)
+  , m_state(HeaderState)
+  , m_varint(0)
+  , m_varintShift(0)
+  , m_remaining(0)
+  , m_fieldNumber(0)
+  , m_wireType(UnknownWireType)
+  , m_sink(nullptr)
+{
+}
+
+void QProtobufStreamParser::setFieldSink(int fieldNumber, QIODevice *device)
+{
+    if (device == nullptr) {
+        m_sinks.remove(fieldNumber);
+        return;
+    }
+    m_sinks.insert(fieldNumber, device);
+}
+
+bool QProtobufStreamParser::feed(const QByteArray &chunk)
+{
+    const char *data = chunk.constData();
+    const char *const end = data + chunk.size();
+    while (data != end) {
+        switch (m_state) {
+        case HeaderState:
+        case VarintState:
+        case SizeState: {
+            const uint8_t byte = static_cast<uint8_t>(*data++);
+            m_field.append(static_cast<char>(byte));
+            if (m_varintShift > MaxVarintShift) {
+                qProtoWarning() << "Varint is too long";
+                m_state = ErrorState;
+                return false;
+            }
+            m_varint |= static_cast<uint64_t>(byte & 0x7f) << m_varintShift;
+            m_varintShift += 7;
+            if (byte & 0x80) {
+                break;
+            }
+
+            const uint64_t value = m_varint;
+            m_varint = 0;
+            m_varintShift = 0;
+            if (m_state == VarintState) {
+                completeField();
+            } else if (m_state == SizeState) {
+                if (value > static_cast<uint64_t>(std::numeric_limits<int>::max() - m_field.size())) {
+                    qProtoWarning() << "Length-delimited field is too long" << value;
+                    m_state = ErrorState;
+                    return false;
+                }
+                m_remaining = static_cast<int>(value);
+                m_sink = m_sinks.value(m_fieldNumber);
+                if (m_remaining == 0) {
+                    completeField();
+                } else {
+                    if (m_sink == nullptr) {
+                        m_field.reserve(m_field.size() + m_remaining);
+                    }
+                    m_state = PayloadState;
+                }
+            } else {
+                m_fieldNumber = static_cast<int>(value >> 3);
+                m_wireType = static_cast<WireTypes>(value & 0x07);
+                if (m_fieldNumber == 0 || (value >> 3) > MaxFieldNumber) {
+                    qProtoWarning() << "Invalid field number" << (value >> 3);
+                    m_state = ErrorState;
+                    return false;
+                }
+
+                switch (m_wireType) {
+                case Varint:
+                    m_state = VarintState;
+                    break;
+                case Fixed64:
+                    m_remaining = 8;
+                    m_state = FixedState;
+                    break;
+                case Fixed32:
+                    m_remaining = 4;
+                    m_state = FixedState;
+                    break;
+                case LengthDelimited:
+                    m_state = SizeState;
+                    break;
+                default:
+                    qProtoWarning() << "Unsupported wire type" << m_wireType;
+                    m_state = ErrorState;
+                    return false;
+                }
+            }
+        }
+            break;
+        case FixedState:
+        case PayloadState: {
+            //Payload is copied by the largest available pieces
+            const int count = static_cast<int>(std::min<qint64>(end - data, m_remaining));
+            if (m_sink == nullptr) {
+                m_field.append(data, count);
+            } else if (!writeToSink(data, count)) {
+                m_state = ErrorState;
+                return false;
+            }
+            data += count;
+            m_remaining -= count;
+            if (m_remaining == 0) {
+                completeField();
+            }
+        }
+            break;
+        case ErrorState:
+            return false;
+        }
+    }
+    return m_state != ErrorState;
+}
+
+void QProtobufStreamParser::reset()
+{
+    m_state = HeaderState;
+    m_field.clear();
+    m_varint = 0;
+    m_varintShift = 0;
+    m_remaining = 0;
+    m_fieldNumber = 0;
+    m_wireType = UnknownWireType;
+    m_sink = nullptr;
+}
+
+void QProtobufStreamParser::completeField()
+{
+    m_state = HeaderState;
+    m_sink = nullptr;
+    const QByteArray field = m_field;
+    m_field.clear();
+    if (m_handler) {
+        m_handler(m_fieldNumber, m_wireType, field);
+    }
+}
+
+bool QProtobufStreamParser::writeToSink(const char *data, int count)
+{
+    while (count > 0) {
+        const qint64 written = m_sink->write(data, count);
+        if (written <= 0) {
+            qProtoWarning() << "Unable to write field" << m_fieldNumber << "to sink:" << m_sink->errorString();
+            return false;
+        }
+        data += written;
+        count -= static_cast<int>(written);
+    }
+    return true;
+}
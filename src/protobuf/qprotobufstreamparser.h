@@ -0,0 +1,163 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufStreamParser
+
+#include <QByteArray>
+#include <QHash>
+#include <QPointer>
+#include <QIODevice>
+
+#include <functional>
+#include <cstdint>
+
+#include "qtprotobufglobal.h"
+#include "qtprotobuftypes.h"
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufStreamParser class is incremental parser of protobuf message received by chunks
+ *
+ * \details Chunks of serialized message are pushed to parser in order they are received. Chunks may be split
+ *          at any byte. Every top-level field is passed to the handler as soon as it's received completely,
+ *          only bytes of the field that is not completed yet are kept by parser between feed() calls.
+ *
+ *          Field bytes passed to the handler contain field header and payload exactly as they were received,
+ *          so they may be deserialized or stored as is.
+ *          \code
+ *          QProtobufStreamParser parser([](int fieldNumber, QtProtobuf::WireTypes wireType, const QByteArray &field) {
+ *              ...
+ *          });
+ *          while (device->bytesAvailable() > 0) {
+ *              if (!parser.feed(device->read(4096))) {
+ *                  break; //Invalid data
+ *              }
+ *          }
+ *          if (!parser.isAtFieldBoundary()) {
+ *              //Message is truncated
+ *          }
+ *          \endcode
+ *
+ *          Payloads of large length-delimited fields, e.g. \c bytes fields of file transfer messages, may be
+ *          written directly to QIODevice using setFieldSink(). Such payloads are never kept in memory, so memory
+ *          used by parser doesn't depend on size of the field:
+ *          \code
+ *          QTemporaryFile file;
+ *          file.open();
+ *          parser.setFieldSink(FileChunk::QtProtobufFieldEnum::ContentProtoFieldNumber, &file);
+ *          \endcode
+ */
+class Q_PROTOBUF_EXPORT QProtobufStreamParser
+{
+public:
+    /*!
+     * \brief Handler of completed top-level field
+     * \param[in] fieldNumber Number of the field
+     * \param[in] wireType Wire type of the field
+     * \param[in] field Encoded field including field header
+     */
+    using FieldHandler = std::function<void(int fieldNumber, QtProtobuf::WireTypes wireType, const QByteArray &field)>;
+
+    explicit QProtobufStreamParser(const FieldHandler &handler);
+    ~QProtobufStreamParser() = default;
+
+    /*!
+     * \brief Parses next \a chunk of the message
+     *
+     * \details Calls handler for every field that is completed by \a chunk.
+     * \return false if data is not valid protobuf message. All next chunks are ignored until reset() is called
+     */
+    bool feed(const QByteArray &chunk);
+
+    /*!
+     * \brief Writes payload of length-delimited field with \a fieldNumber to \a device as it's received
+     *
+     * \details Payload is written by the pieces it's received by. Payloads of repeated occurrences of the
+     *          field are appended to \a device one by one. The handler is still called for every completed
+     *          field, but \a field contains field header and payload size only. Fields with the same number but
+     *          other wire type are passed to the handler as usual. Write error of \a device is treated as
+     *          invalid data. Set nullptr \a device to remove sink of the field.
+     *
+     * \note Parser doesn't take ownership of \a device. Device must stay alive while payload of the field is received.
+     */
+    void setFieldSink(int fieldNumber, QIODevice *device);
+
+    /*!
+     * \brief Returns device that payload of field with \a fieldNumber is written to, or nullptr if field
+     *        is passed to the handler as usual
+     */
+    QIODevice *fieldSink(int fieldNumber) const {
+        return m_sinks.value(fieldNumber);
+    }
+
+    /*!
+     * \brief Returns true if all received fields are completed, so the message may end at this point
+     */
+    bool isAtFieldBoundary() const {
+        return m_state == HeaderState && m_field.isEmpty();
+    }
+
+    /*!
+     * \brief Returns true if invalid data was received
+     */
+    bool hasError() const {
+        return m_state == ErrorState;
+    }
+
+    /*!
+     * \brief Drops incomplete field and error state, next chunk is parsed as beginning of the new message
+     */
+    void reset();
+
+private:
+    Q_DISABLE_COPY_MOVE(QProtobufStreamParser)
+
+    enum State {
+        HeaderState,
+        VarintState,
+        FixedState,
+        SizeState,
+        PayloadState,
+        ErrorState
+    };
+
+    void completeField();
+    bool writeToSink(const char *data, int count);
+
+    FieldHandler m_handler;
+    State m_state;
+    QByteArray m_field;
+    uint64_t m_varint;
+    int m_varintShift;
+    int m_remaining;
+    int m_fieldNumber;
+    WireTypes m_wireType;
+    QHash<int, QPointer<QIODevice>> m_sinks;
+    QIODevice *m_sink;
+};
+
+}
@@ -0,0 +1,129 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufUtf8
+
+#include <QString>
+#include <QByteArray>
+
+namespace QtProtobufPrivate {
+
+/*!
+ * \private
+ * \brief Returns size of \a value encoded to UTF-8 by encodeUtf8
+ *
+ * \details Unpaired surrogates are encoded as '?', same as QString::toUtf8 does.
+ */
+inline int utf8Size(const QString &value)
+{
+    const ushort *data = value.utf16();
+    const int length = value.size();
+    int size = 0;
+    for (int i = 0; i < length; ++i) {
+        const ushort unicode = data[i];
+        if (unicode < 0x80) {
+            size += 1;
+        } else if (unicode < 0x800) {
+            size += 2;
+        } else if (!QChar::isSurrogate(unicode)) {
+            size += 3;
+        } else if (QChar::isHighSurrogate(unicode) && i + 1 < length && QChar::isLowSurrogate(data[i + 1])) {
+            size += 4;
+            ++i;
+        } else {
+            size += 1;
+        }
+    }
+    return size;
+}
+
+/*!
+ * \private
+ * \brief Writes \a value encoded to UTF-8 to \a out
+ *
+ * \details \a out must have at least utf8Size(\a value) bytes. Result is byte-to-byte equal to
+ *          QString::toUtf8, but no intermediate QByteArray is allocated.
+ * \return pointer to first byte after encoded data
+ */
+inline char *encodeUtf8(const QString &value, char *out)
+{
+    const ushort *data = value.utf16();
+    const int length = value.size();
+    for (int i = 0; i < length; ++i) {
+        const ushort unicode = data[i];
+        if (unicode < 0x80) {
+            *out++ = static_cast<char>(unicode);
+        } else if (unicode < 0x800) {
+            *out++ = static_cast<char>(0xc0 | (unicode >> 6));
+            *out++ = static_cast<char>(0x80 | (unicode & 0x3f));
+        } else if (!QChar::isSurrogate(unicode)) {
+            *out++ = static_cast<char>(0xe0 | (unicode >> 12));
+            *out++ = static_cast<char>(0x80 | ((unicode >> 6) & 0x3f));
+            *out++ = static_cast<char>(0x80 | (unicode & 0x3f));
+        } else if (QChar::isHighSurrogate(unicode) && i + 1 < length && QChar::isLowSurrogate(data[i + 1])) {
+            const uint codePoint = QChar::surrogateToUcs4(unicode, data[++i]);
+            *out++ = static_cast<char>(0xf0 | (codePoint >> 18));
+            *out++ = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+            *out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+            *out++ = static_cast<char>(0x80 | (codePoint & 0x3f));
+        } else {
+            *out++ = '?';
+        }
+    }
+    return out;
+}
+
+/*!
+ * \private
+ * \brief Appends \a value encoded to UTF-8 to the end of \a buffer
+ */
+inline void appendUtf8(const QString &value, QByteArray &buffer)
+{
+    const int position = buffer.size();
+    buffer.resize(position + utf8Size(value));
+    encodeUtf8(value, buffer.data() + position);
+}
+
+/*!
+ * \private
+ * \brief Returns thread-local buffer for temporary encoding work
+ *
+ * \details Buffer is empty, but keeps capacity reached by previous use, so steady state doesn't allocate.
+ *          Content is valid until next call on the same thread, callers must not keep it.
+ */
+inline QByteArray &scratchBuffer()
+{
+    thread_local QByteArray buffer;
+    if (!buffer.isDetached()) {
+        buffer = QByteArray();
+    }
+    if (buffer.capacity() == 0) {
+        buffer.reserve(256);
+    }
+    buffer.resize(0);
+    return buffer;
+}
+
+}
@@ -0,0 +1,507 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qprotobufwireformat.h"
+
+#include "qprotobufselfcheckiterator.h"
+#include "qprotobufserializer_p.h"
+
+#include <stdexcept>
+
+using namespace QtProtobuf;
+
+namespace {
+thread_local bool deterministicSerialization = false;
+
+template<typename V>
+void writeBasicField(QByteArray &buffer, int fieldNumber, const V &value, WireTypes type)
+{
+    //Header is written in advance and dropped if value shouldn't be sent
+    const int headerPosition = buffer.size();
+    QProtobufSerializerPrivate::encodeHeader(fieldNumber, type, buffer);
+    int fieldIndex = fieldNumber;
+    QProtobufSerializerPrivate::serializeBasic<V>(value, fieldIndex, buffer);
+    if (fieldIndex == QtProtobufPrivate::NotUsedFieldIndex) {
+        buffer.resize(headerPosition);
+    }
+}
+
+template<typename V>
+int basicFieldSize(int fieldNumber, const V &value, WireTypes type)
+{
+    int fieldIndex = fieldNumber;
+    const int size = QProtobufSerializerPrivate::basicSize(value, fieldIndex);
+    return fieldIndex != QtProtobufPrivate::NotUsedFieldIndex ? QProtobufSerializerPrivate::headerSize(fieldNumber, type) + size : 0;
+}
+
+template<typename V>
+void writeListField(QByteArray &buffer, int fieldNumber, const QList<V> &value)
+{
+    const int headerPosition = buffer.size();
+    QProtobufSerializerPrivate::encodeHeader(fieldNumber, LengthDelimited, buffer);
+    int fieldIndex = fieldNumber;
+    QProtobufSerializerPrivate::serializeListType<V>(value, fieldIndex, buffer);
+    if (fieldIndex == QtProtobufPrivate::NotUsedFieldIndex) {
+        buffer.resize(headerPosition);
+    }
+}
+
+}
+
+bool QtProtobufPrivate::setThreadDeterministicSerialization(bool enabled)
+{
+    const bool previous = deterministicSerialization;
+    deterministicSerialization = enabled;
+    return previous;
+}
+
+bool QtProtobufPrivate::isDeterministicSerialization()
+{
+    return deterministicSerialization;
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, float value)
+{
+    writeBasicField(buffer, fieldNumber, value, Fixed32);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, double value)
+{
+    writeBasicField(buffer, fieldNumber, value, Fixed64);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, int32 value)
+{
+    writeBasicField(buffer, fieldNumber, value, Varint);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, int64 value)
+{
+    writeBasicField(buffer, fieldNumber, value, Varint);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, uint32 value)
+{
+    writeBasicField(buffer, fieldNumber, value, Varint);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, uint64 value)
+{
+    writeBasicField(buffer, fieldNumber, value, Varint);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, sint32 value)
+{
+    writeBasicField(buffer, fieldNumber, value, Varint);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, sint64 value)
+{
+    writeBasicField(buffer, fieldNumber, value, Varint);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, fixed32 value)
+{
+    writeBasicField(buffer, fieldNumber, value, Fixed32);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, fixed64 value)
+{
+    writeBasicField(buffer, fieldNumber, value, Fixed64);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, sfixed32 value)
+{
+    writeBasicField(buffer, fieldNumber, value, Fixed32);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, sfixed64 value)
+{
+    writeBasicField(buffer, fieldNumber, value, Fixed64);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, bool value)
+{
+    writeBasicField<uint32>(buffer, fieldNumber, value, Varint);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, const QString &value)
+{
+    writeBasicField(buffer, fieldNumber, value, LengthDelimited);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, const QByteArray &value)
+{
+    writeBasicField(buffer, fieldNumber, value, LengthDelimited);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, const FloatList &value)
+{
+    writeListField(buffer, fieldNumber, value);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, const DoubleList &value)
+{
+    writeListField(buffer, fieldNumber, value);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, const int32List &value)
+{
+    writeListField(buffer, fieldNumber, value);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, const int64List &value)
+{
+    writeListField(buffer, fieldNumber, value);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, const uint32List &value)
+{
+    writeListField(buffer, fieldNumber, value);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, const uint64List &value)
+{
+    writeListField(buffer, fieldNumber, value);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, const sint32List &value)
+{
+    writeListField(buffer, fieldNumber, value);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, const sint64List &value)
+{
+    writeListField(buffer, fieldNumber, value);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, const fixed32List &value)
+{
+    writeListField(buffer, fieldNumber, value);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, const fixed64List &value)
+{
+    writeListField(buffer, fieldNumber, value);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, const sfixed32List &value)
+{
+    writeListField(buffer, fieldNumber, value);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, const sfixed64List &value)
+{
+    writeListField(buffer, fieldNumber, value);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, const QStringList &value)
+{
+    //Strings and bytes lists are not packed, each element has own header
+    int fieldIndex = fieldNumber;
+    QProtobufSerializerPrivate::serializeListType<QString>(value, fieldIndex, buffer);
+}
+
+void QProtobufWireFormat::writeField(QByteArray &buffer, int fieldNumber, const QByteArrayList &value)
+{
+    int fieldIndex = fieldNumber;
+    QProtobufSerializerPrivate::serializeListType<QByteArray>(value, fieldIndex, buffer);
+}
+
+int QProtobufWireFormat::fieldSize(int fieldNumber, float value)
+{
+    return basicFieldSize(fieldNumber, value, Fixed32);
+}
+
+int QProtobufWireFormat::fieldSize(int fieldNumber, double value)
+{
+    return basicFieldSize(fieldNumber, value, Fixed64);
+}
+
+int QProtobufWireFormat::fieldSize(int fieldNumber, int32 value)
+{
+    return basicFieldSize(fieldNumber, value, Varint);
+}
+
+int QProtobufWireFormat::fieldSize(int fieldNumber, int64 value)
+{
+    return basicFieldSize(fieldNumber, value, Varint);
+}
+
+int QProtobufWireFormat::fieldSize(int fieldNumber, uint32 value)
+{
+    return basicFieldSize(fieldNumber, value, Varint);
+}
+
+int QProtobufWireFormat::fieldSize(int fieldNumber, uint64 value)
+{
+    return basicFieldSize(fieldNumber, value, Varint);
+}
+
+int QProtobufWireFormat::fieldSize(int fieldNumber, sint32 value)
+{
+    return basicFieldSize(fieldNumber, value, Varint);
+}
+
+int QProtobufWireFormat::fieldSize(int fieldNumber, sint64 value)
+{
+    return basicFieldSize(fieldNumber, value, Varint);
+}
+
+int QProtobufWireFormat::fieldSize(int fieldNumber, fixed32 value)
+{
+    return basicFieldSize(fieldNumber, value, Fixed32);
+}
+
+int QProtobufWireFormat::fieldSize(int fieldNumber, fixed64 value)
+{
+    return basicFieldSize(fieldNumber, value, Fixed64);
+}
+
+int QProtobufWireFormat::fieldSize(int fieldNumber, sfixed32 value)
+{
+    return basicFieldSize(fieldNumber, value, Fixed32);
+}
+
+int QProtobufWireFormat::fieldSize(int fieldNumber, sfixed64 value)
+{
+    return basicFieldSize(fieldNumber, value, Fixed64);
+}
+
+int QProtobufWireFormat::fieldSize(int fieldNumber, bool value)
+{
+    return basicFieldSize<uint32>(fieldNumber, value, Varint);
+}
+
+int QProtobufWireFormat::fieldSize(int fieldNumber, const QString &value)
+{
+    return basicFieldSize(fieldNumber, value, LengthDelimited);
+}
+
+int QProtobufWireFormat::fieldSize(int fieldNumber, const QByteArray &value)
+{
+    return basicFieldSize(fieldNumber, value, LengthDelimited);
+}
+
+int QProtobufWireFormat::beginLengthDelimited(QByteArray &buffer, int fieldNumber)
+{
+    QProtobufSerializerPrivate::encodeHeader(fieldNumber, LengthDelimited, buffer);
+    return QProtobufSerializerPrivate::beginLengthDelimited(buffer);
+}
+
+void QProtobufWireFormat::endLengthDelimited(QByteArray &buffer, int sizePosition)
+{
+    QProtobufSerializerPrivate::endLengthDelimited(buffer, sizePosition);
+}
+
+int QProtobufWireFormat::lengthDelimitedSize(int fieldNumber, int payloadSize)
+{
+    return QProtobufSerializerPrivate::headerSize(fieldNumber, LengthDelimited)
+            + QProtobufSerializerPrivate::lengthDelimitedSize(payloadSize);
+}
+
+void QProtobufWireFormat::readFieldHeader(QProtobufSelfcheckIterator &it, int &fieldNumber, WireTypes &wireType)
+{
+    if (!QProtobufSerializerPrivate::decodeHeader(it, fieldNumber, wireType)) {
+        qProtoCritical() << "Message received doesn't contains valid header byte. "
+                            "Trying next, but seems stream is broken" << QString::number((*it), 16);
+        QtProtobufPrivate::reportDeserializationError(InvalidHeaderError, "Message received doesn't contains valid header byte. "
+                                                                          "Seems stream is broken");
+    }
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, float &value)
+{
+    QProtobufSerializerPrivate::deserializeBasic<float>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, double &value)
+{
+    QProtobufSerializerPrivate::deserializeBasic<double>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, int32 &value)
+{
+    QProtobufSerializerPrivate::deserializeBasic<int32>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, int64 &value)
+{
+    QProtobufSerializerPrivate::deserializeBasic<int64>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, uint32 &value)
+{
+    QProtobufSerializerPrivate::deserializeBasic<uint32>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, uint64 &value)
+{
+    QProtobufSerializerPrivate::deserializeBasic<uint64>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, sint32 &value)
+{
+    QProtobufSerializerPrivate::deserializeBasic<sint32>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, sint64 &value)
+{
+    QProtobufSerializerPrivate::deserializeBasic<sint64>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, fixed32 &value)
+{
+    QProtobufSerializerPrivate::deserializeBasic<fixed32>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, fixed64 &value)
+{
+    QProtobufSerializerPrivate::deserializeBasic<fixed64>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, sfixed32 &value)
+{
+    QProtobufSerializerPrivate::deserializeBasic<sfixed32>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, sfixed64 &value)
+{
+    QProtobufSerializerPrivate::deserializeBasic<sfixed64>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, bool &value)
+{
+    uint32 intValue = 0;
+    QProtobufSerializerPrivate::deserializeBasic<uint32>(it, intValue);
+    value = intValue != 0;
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, QString &value)
+{
+    QProtobufSerializerPrivate::deserializeBasic<QString>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, QByteArray &value)
+{
+    QProtobufSerializerPrivate::deserializeBasic<QByteArray>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, FloatList &value)
+{
+    QProtobufSerializerPrivate::deserializeList<float>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, DoubleList &value)
+{
+    QProtobufSerializerPrivate::deserializeList<double>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, int32List &value)
+{
+    QProtobufSerializerPrivate::deserializeList<int32>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, int64List &value)
+{
+    QProtobufSerializerPrivate::deserializeList<int64>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, uint32List &value)
+{
+    QProtobufSerializerPrivate::deserializeList<uint32>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, uint64List &value)
+{
+    QProtobufSerializerPrivate::deserializeList<uint64>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, sint32List &value)
+{
+    QProtobufSerializerPrivate::deserializeList<sint32>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, sint64List &value)
+{
+    QProtobufSerializerPrivate::deserializeList<sint64>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, fixed32List &value)
+{
+    QProtobufSerializerPrivate::deserializeList<fixed32>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, fixed64List &value)
+{
+    QProtobufSerializerPrivate::deserializeList<fixed64>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, sfixed32List &value)
+{
+    QProtobufSerializerPrivate::deserializeList<sfixed32>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, sfixed64List &value)
+{
+    QProtobufSerializerPrivate::deserializeList<sfixed64>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, QStringList &value)
+{
+    QProtobufSerializerPrivate::deserializeList<QString>(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, QByteArrayList &value)
+{
+    QProtobufSerializerPrivate::deserializeList<QByteArray>(it, value);
+}
+
+int QProtobufWireFormat::readLength(QProtobufSelfcheckIterator &it)
+{
+    return static_cast<int>(QProtobufSerializerPrivate::deserializeVarintCommon<uint32>(it));
+}
+
+void QProtobufWireFormat::appendVarint(QByteArray &buffer, uint64_t value)
+{
+    QProtobufSerializerPrivate::serializeVarintCommon<uint64_t>(value, buffer);
+}
+
+int QProtobufWireFormat::varintSize(uint64_t value)
+{
+    return QProtobufSerializerPrivate::varintSize<uint64_t>(value);
+}
+
+uint64_t QProtobufWireFormat::readVarint(QProtobufSelfcheckIterator &it)
+{
+    return QProtobufSerializerPrivate::deserializeVarintCommon<uint64_t>(it);
+}
+
+void QProtobufWireFormat::skipField(QProtobufSelfcheckIterator &it, WireTypes wireType)
+{
+    auto bytesCount = QProtobufSerializerPrivate::skipSerializedFieldBytes(it, wireType);
+    qProtoWarning() << "Message received contains unexpected/optional field. WireType:" << wireType
+                    << "Skipped:" << (bytesCount + 1) << "bytes";
+}
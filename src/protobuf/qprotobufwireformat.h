@@ -0,0 +1,475 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufWireFormat
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QByteArrayList>
+#include <QMap>
+#include <QHash>
+
+#include <algorithm>
+#include <vector>
+
+#include "qtprotobufglobal.h"
+#include "qtprotobuftypes.h"
+#include "qprotobufselfcheckiterator.h"
+
+namespace QtProtobufPrivate {
+
+/*!
+ * \private
+ * \brief Enables or disables deterministic serialization in current thread and returns previous state
+ */
+extern Q_PROTOBUF_EXPORT bool setThreadDeterministicSerialization(bool enabled);
+
+/*!
+ * \private
+ * \brief Returns true if maps serialized in current thread must be written in key order
+ */
+extern Q_PROTOBUF_EXPORT bool isDeterministicSerialization();
+
+/*!
+ * \private
+ * \brief The DeterministicSerializationScope class sets deterministic serialization mode of current thread
+ *        while scope is alive
+ */
+class DeterministicSerializationScope
+{
+public:
+    explicit DeterministicSerializationScope(bool enabled) : m_previous(setThreadDeterministicSerialization(enabled)) {}
+    ~DeterministicSerializationScope() {
+        setThreadDeterministicSerialization(m_previous);
+    }
+private:
+    Q_DISABLE_COPY_MOVE(DeterministicSerializationScope)
+    bool m_previous;
+};
+
+/*!
+ * \private
+ * \brief Calls \a visitor for every entry of \a map
+ *
+ * \details QMap is iterated in key order already, so it's visited as is.
+ */
+template<typename K, typename V, typename Visitor>
+void forEachMapEntry(const QMap<K, V> &map, Visitor visitor) {
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+        visitor(it.key(), it.value());
+    }
+}
+
+/*!
+ * \private
+ * \brief Calls \a visitor for every entry of \a map
+ *
+ * \details Entries are visited in hash order, or in key order if deterministic serialization is enabled
+ *          in current thread.
+ */
+template<typename K, typename V, typename Visitor>
+void forEachMapEntry(const QHash<K, V> &map, Visitor visitor) {
+    if (!isDeterministicSerialization() || map.size() < 2) {
+        for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+            visitor(it.key(), it.value());
+        }
+        return;
+    }
+
+    std::vector<typename QHash<K, V>::const_iterator> entries;
+    entries.reserve(static_cast<size_t>(map.size()));
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+        entries.push_back(it);
+    }
+    std::sort(entries.begin(), entries.end(), [](const typename QHash<K, V>::const_iterator &a,
+                                                 const typename QHash<K, V>::const_iterator &b) {
+        return a.key() < b.key();
+    });
+    for (const auto &it : entries) {
+        visitor(it.key(), it.value());
+    }
+}
+
+}
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufWireFormat class provides protobuf wire format primitives for generated code
+ *
+ * \details Is used by messages generated with DIRECT option and by serializers of native well-known types. Generated
+ *          serializeTo() and parseFrom() methods encode and decode fields of basic types directly, without meta-object
+ *          system involved. Field values that equal to default are not written, same as QProtobufSerializer does.
+ */
+class Q_PROTOBUF_EXPORT QProtobufWireFormat
+{
+public:
+    /*!
+     * \brief Appends \a value of field with \a fieldNumber to \a buffer
+     */
+    static void writeField(QByteArray &buffer, int fieldNumber, float value);
+    static void writeField(QByteArray &buffer, int fieldNumber, double value);
+    static void writeField(QByteArray &buffer, int fieldNumber, int32 value);
+    static void writeField(QByteArray &buffer, int fieldNumber, int64 value);
+    static void writeField(QByteArray &buffer, int fieldNumber, uint32 value);
+    static void writeField(QByteArray &buffer, int fieldNumber, uint64 value);
+    static void writeField(QByteArray &buffer, int fieldNumber, sint32 value);
+    static void writeField(QByteArray &buffer, int fieldNumber, sint64 value);
+    static void writeField(QByteArray &buffer, int fieldNumber, fixed32 value);
+    static void writeField(QByteArray &buffer, int fieldNumber, fixed64 value);
+    static void writeField(QByteArray &buffer, int fieldNumber, sfixed32 value);
+    static void writeField(QByteArray &buffer, int fieldNumber, sfixed64 value);
+    static void writeField(QByteArray &buffer, int fieldNumber, bool value);
+    static void writeField(QByteArray &buffer, int fieldNumber, const QString &value);
+    static void writeField(QByteArray &buffer, int fieldNumber, const QByteArray &value);
+    static void writeField(QByteArray &buffer, int fieldNumber, const FloatList &value);
+    static void writeField(QByteArray &buffer, int fieldNumber, const DoubleList &value);
+    static void writeField(QByteArray &buffer, int fieldNumber, const int32List &value);
+    static void writeField(QByteArray &buffer, int fieldNumber, const int64List &value);
+    static void writeField(QByteArray &buffer, int fieldNumber, const uint32List &value);
+    static void writeField(QByteArray &buffer, int fieldNumber, const uint64List &value);
+    static void writeField(QByteArray &buffer, int fieldNumber, const sint32List &value);
+    static void writeField(QByteArray &buffer, int fieldNumber, const sint64List &value);
+    static void writeField(QByteArray &buffer, int fieldNumber, const fixed32List &value);
+    static void writeField(QByteArray &buffer, int fieldNumber, const fixed64List &value);
+    static void writeField(QByteArray &buffer, int fieldNumber, const sfixed32List &value);
+    static void writeField(QByteArray &buffer, int fieldNumber, const sfixed64List &value);
+    static void writeField(QByteArray &buffer, int fieldNumber, const QStringList &value);
+    static void writeField(QByteArray &buffer, int fieldNumber, const QByteArrayList &value);
+
+    /*!
+     * \brief Appends enumeration \a value of field with \a fieldNumber to \a buffer
+     *
+     * \details Enumerations are encoded as int64 values, same as QProtobufSerializer does. Lists of enumerations
+     *          are packed.
+     */
+    template<typename T,
+             typename std::enable_if_t<std::is_enum<T>::value, int> = 0>
+    static void writeField(QByteArray &buffer, int fieldNumber, T value) {
+        writeField(buffer, fieldNumber, int64(static_cast<int64_t>(value)));
+    }
+
+    template<typename T,
+             typename std::enable_if_t<std::is_enum<T>::value, int> = 0>
+    static void writeField(QByteArray &buffer, int fieldNumber, const QList<T> &value) {
+        if (value.isEmpty()) {
+            return;
+        }
+        const int sizePosition = beginLengthDelimited(buffer, fieldNumber);
+        for (const T element : value) {
+            appendVarint(buffer, static_cast<uint64_t>(static_cast<int64_t>(element)));
+        }
+        endLengthDelimited(buffer, sizePosition);
+    }
+
+    /*!
+     * \brief Appends entries of map \a value of field with \a fieldNumber to \a buffer
+     *
+     * \details Keys and values are written directly, without boxing to QVariant. Key and value that equal to
+     *          default are omitted from the entry, same as QProtobufSerializer does.
+     */
+    template<typename K, typename V>
+    static void writeField(QByteArray &buffer, int fieldNumber, const QMap<K, V> &value) {
+        writeMapField(buffer, fieldNumber, value);
+    }
+
+    template<typename K, typename V>
+    static void writeField(QByteArray &buffer, int fieldNumber, const QHash<K, V> &value) {
+        writeMapField(buffer, fieldNumber, value);
+    }
+
+    /*!
+     * \brief Calculates size of field with \a fieldNumber and \a value written by writeField, including header
+     */
+    static int fieldSize(int fieldNumber, float value);
+    static int fieldSize(int fieldNumber, double value);
+    static int fieldSize(int fieldNumber, int32 value);
+    static int fieldSize(int fieldNumber, int64 value);
+    static int fieldSize(int fieldNumber, uint32 value);
+    static int fieldSize(int fieldNumber, uint64 value);
+    static int fieldSize(int fieldNumber, sint32 value);
+    static int fieldSize(int fieldNumber, sint64 value);
+    static int fieldSize(int fieldNumber, fixed32 value);
+    static int fieldSize(int fieldNumber, fixed64 value);
+    static int fieldSize(int fieldNumber, sfixed32 value);
+    static int fieldSize(int fieldNumber, sfixed64 value);
+    static int fieldSize(int fieldNumber, bool value);
+    static int fieldSize(int fieldNumber, const QString &value);
+    static int fieldSize(int fieldNumber, const QByteArray &value);
+
+    template<typename T,
+             typename std::enable_if_t<std::is_enum<T>::value, int> = 0>
+    static int fieldSize(int fieldNumber, T value) {
+        return fieldSize(fieldNumber, int64(static_cast<int64_t>(value)));
+    }
+
+    template<typename T,
+             typename std::enable_if_t<std::is_enum<T>::value, int> = 0>
+    static int fieldSize(int fieldNumber, const QList<T> &value) {
+        if (value.isEmpty()) {
+            return 0;
+        }
+        int size = 0;
+        for (const T element : value) {
+            size += varintSize(static_cast<uint64_t>(static_cast<int64_t>(element)));
+        }
+        return lengthDelimitedSize(fieldNumber, size);
+    }
+
+    template<typename K, typename V>
+    static int fieldSize(int fieldNumber, const QMap<K, V> &value) {
+        return mapFieldSize(fieldNumber, value);
+    }
+
+    template<typename K, typename V>
+    static int fieldSize(int fieldNumber, const QHash<K, V> &value) {
+        return mapFieldSize(fieldNumber, value);
+    }
+
+    /*!
+     * \brief Decodes field header at \a it position
+     * \param[out] fieldNumber Number of decoded field
+     * \param[out] wireType Wire type of decoded field
+     * \throws std::invalid_argument if header is invalid, see QtProtobufPrivate::reportDeserializationError
+     */
+    static void readFieldHeader(QProtobufSelfcheckIterator &it, int &fieldNumber, WireTypes &wireType);
+
+    /*!
+     * \brief Skips header of field with \a fieldNumber and \a wireType if it's at \a it position
+     *
+     * \details Is used by generated ordered deserializers. Header is compared byte by byte with encoded one,
+     *          so for constant arguments check is reduced to one or two comparisons.
+     * \return false if there is other field or no data at \a it position, \a it is not moved in this case
+     */
+    static bool takeFieldHeader(QProtobufSelfcheckIterator &it, int fieldNumber, WireTypes wireType) {
+        const char *data = it.data();
+        const int size = it.size();
+        int length = 0;
+        for (uint32_t header = (static_cast<uint32_t>(fieldNumber) << 3) | wireType; ; header >>= 7) {
+            const uint8_t expected = header >= 0x80 ? static_cast<uint8_t>((header & 0x7f) | 0x80) : static_cast<uint8_t>(header);
+            if (length >= size || static_cast<uint8_t>(data[length]) != expected) {
+                return false;
+            }
+            ++length;
+            if (header < 0x80) {
+                break;
+            }
+        }
+        it.advanceUnchecked(length);
+        return true;
+    }
+
+    /*!
+     * \brief Decodes field value at \a it position to \a value
+     *
+     * \details Values of repeated fields are appended to \a value, any other values are replaced. Packed lists
+     *          are expected, see readRepeatedField for lists that may be received non-packed.
+     * \throws std::out_of_range if data is shorter than required by field, see QtProtobufPrivate::reportDeserializationError
+     */
+    static void readField(QProtobufSelfcheckIterator &it, float &value);
+    static void readField(QProtobufSelfcheckIterator &it, double &value);
+    static void readField(QProtobufSelfcheckIterator &it, int32 &value);
+    static void readField(QProtobufSelfcheckIterator &it, int64 &value);
+    static void readField(QProtobufSelfcheckIterator &it, uint32 &value);
+    static void readField(QProtobufSelfcheckIterator &it, uint64 &value);
+    static void readField(QProtobufSelfcheckIterator &it, sint32 &value);
+    static void readField(QProtobufSelfcheckIterator &it, sint64 &value);
+    static void readField(QProtobufSelfcheckIterator &it, fixed32 &value);
+    static void readField(QProtobufSelfcheckIterator &it, fixed64 &value);
+    static void readField(QProtobufSelfcheckIterator &it, sfixed32 &value);
+    static void readField(QProtobufSelfcheckIterator &it, sfixed64 &value);
+    static void readField(QProtobufSelfcheckIterator &it, bool &value);
+    static void readField(QProtobufSelfcheckIterator &it, QString &value);
+    static void readField(QProtobufSelfcheckIterator &it, QByteArray &value);
+    static void readField(QProtobufSelfcheckIterator &it, FloatList &value);
+    static void readField(QProtobufSelfcheckIterator &it, DoubleList &value);
+    static void readField(QProtobufSelfcheckIterator &it, int32List &value);
+    static void readField(QProtobufSelfcheckIterator &it, int64List &value);
+    static void readField(QProtobufSelfcheckIterator &it, uint32List &value);
+    static void readField(QProtobufSelfcheckIterator &it, uint64List &value);
+    static void readField(QProtobufSelfcheckIterator &it, sint32List &value);
+    static void readField(QProtobufSelfcheckIterator &it, sint64List &value);
+    static void readField(QProtobufSelfcheckIterator &it, fixed32List &value);
+    static void readField(QProtobufSelfcheckIterator &it, fixed64List &value);
+    static void readField(QProtobufSelfcheckIterator &it, sfixed32List &value);
+    static void readField(QProtobufSelfcheckIterator &it, sfixed64List &value);
+    static void readField(QProtobufSelfcheckIterator &it, QStringList &value);
+    static void readField(QProtobufSelfcheckIterator &it, QByteArrayList &value);
+
+    /*!
+     * \brief Decodes enumeration value at \a it position to \a value
+     *
+     * \details Packed list of enumerations is appended to \a value.
+     */
+    template<typename T,
+             typename std::enable_if_t<std::is_enum<T>::value, int> = 0>
+    static void readField(QProtobufSelfcheckIterator &it, T &value) {
+        value = static_cast<T>(static_cast<int64_t>(readVarint(it)));
+    }
+
+    template<typename T,
+             typename std::enable_if_t<std::is_enum<T>::value, int> = 0>
+    static void readField(QProtobufSelfcheckIterator &it, QList<T> &value) {
+        const int size = readLength(it);
+        const QProtobufSelfcheckIterator last = it + size;
+        while (it != last && QtProtobufPrivate::deserializationError() == NoDeserializationError) {
+            value.append(static_cast<T>(static_cast<int64_t>(readVarint(it))));
+        }
+    }
+
+    /*!
+     * \brief Decodes elements of repeated field at \a it position and appends them to \a value
+     *
+     * \details Both packed and non-packed encodings are accepted, \a wireType is wire type of decoded field header.
+     *          Non-packed element is appended in place, without copying of \a value.
+     */
+    template<typename T>
+    static void readRepeatedField(QProtobufSelfcheckIterator &it, WireTypes wireType, QList<T> &value) {
+        if (wireType == LengthDelimited) {
+            readField(it, value);
+            return;
+        }
+        T element{};
+        readField(it, element);
+        if (QtProtobufPrivate::deserializationError() == NoDeserializationError) {
+            value.append(element);
+        }
+    }
+
+    static void readRepeatedField(QProtobufSelfcheckIterator &it, WireTypes /*wireType*/, QStringList &value) {
+        readField(it, value);
+    }
+
+    /*!
+     * \brief Decodes single map entry at \a it position and inserts it to \a value
+     *
+     * \details Entry fields other than key and value are skipped. Missing key or value is default-constructed.
+     */
+    template<typename K, typename V>
+    static void readField(QProtobufSelfcheckIterator &it, QMap<K, V> &value) {
+        readMapEntry(it, value);
+    }
+
+    template<typename K, typename V>
+    static void readField(QProtobufSelfcheckIterator &it, QHash<K, V> &value) {
+        readMapEntry(it, value);
+    }
+
+    /*!
+     * \brief Skips value of field with \a wireType at \a it position
+     */
+    static void skipField(QProtobufSelfcheckIterator &it, WireTypes wireType);
+
+    /*!
+     * \brief Appends header of length-delimited field with \a fieldNumber to \a buffer and reserves space for its length
+     * \return Position of reserved length that is passed to endLengthDelimited() when payload is written
+     */
+    static int beginLengthDelimited(QByteArray &buffer, int fieldNumber);
+
+    /*!
+     * \brief Writes length of payload appended to \a buffer after beginLengthDelimited() call
+     */
+    static void endLengthDelimited(QByteArray &buffer, int sizePosition);
+
+    /*!
+     * \brief Calculates size of length-delimited field with \a fieldNumber and payload of \a payloadSize bytes
+     */
+    static int lengthDelimitedSize(int fieldNumber, int payloadSize);
+
+    /*!
+     * \brief Decodes length of length-delimited field at \a it position
+     */
+    static int readLength(QProtobufSelfcheckIterator &it);
+
+    /*!
+     * \brief Decodes fields of embedded message at \a it position
+     *
+     * \details \a readField is called with iterator and number of each field. Fields that \a readField
+     *          doesn't read and returns false for are skipped.
+     */
+    template<typename F>
+    static void readMessageFields(QProtobufSelfcheckIterator &it, F readField) {
+        const int size = readLength(it);
+        const QProtobufSelfcheckIterator last = it + size;
+        while (it != last && QtProtobufPrivate::deserializationError() == NoDeserializationError) {
+            int fieldNumber = 0;
+            WireTypes wireType = UnknownWireType;
+            readFieldHeader(it, fieldNumber, wireType);
+            if (!readField(it, fieldNumber)) {
+                skipField(it, wireType);
+            }
+        }
+    }
+
+private:
+    QProtobufWireFormat() = delete;
+
+    static void appendVarint(QByteArray &buffer, uint64_t value);
+    static int varintSize(uint64_t value);
+    static uint64_t readVarint(QProtobufSelfcheckIterator &it);
+
+    template<typename M>
+    static void writeMapField(QByteArray &buffer, int fieldNumber, const M &value) {
+        QtProtobufPrivate::forEachMapEntry(value, [&buffer, fieldNumber](const typename M::key_type &key,
+                                                                         const typename M::mapped_type &entryValue) {
+            const int sizePosition = beginLengthDelimited(buffer, fieldNumber);
+            writeField(buffer, 1, key);
+            writeField(buffer, 2, entryValue);
+            endLengthDelimited(buffer, sizePosition);
+        });
+    }
+
+    template<typename M>
+    static int mapFieldSize(int fieldNumber, const M &value) {
+        int size = 0;
+        for (auto it = value.constBegin(); it != value.constEnd(); ++it) {
+            size += lengthDelimitedSize(fieldNumber, fieldSize(1, it.key()) + fieldSize(2, it.value()));
+        }
+        return size;
+    }
+
+    template<typename M>
+    static void readMapEntry(QProtobufSelfcheckIterator &it, M &value) {
+        typename M::key_type key{};
+        typename M::mapped_type entryValue{};
+        readMessageFields(it, [&key, &entryValue](QProtobufSelfcheckIterator &fieldIt, int fieldNumber) {
+            if (fieldNumber == 1) {
+                readField(fieldIt, key);
+            } else if (fieldNumber == 2) {
+                readField(fieldIt, entryValue);
+            } else {
+                return false;
+            }
+            return true;
+        });
+        if (QtProtobufPrivate::deserializationError() == NoDeserializationError) {
+            value[key] = entryValue;
+        }
+    }
+};
+
+}
@@ -25,33 +25,90 @@
 
 #include "qtprotobuftypes.h"
 #include "qprotobufobject.h"
+#include "qtprotobuflogging.h"
 
-#include <type_traits>
+#include <QElapsedTimer>
 
-#define registerProtobufType(X) qRegisterMetaType<X>(# X);\
-                                qRegisterMetaType<X>("QtProtobuf::"# X)
+#include <mutex>
+#include <type_traits>
 
 namespace QtProtobuf {
 
 namespace  {
+//Registers converter unless it's already known, e.g. int64_t and qlonglong are the same type on some platforms
+template<typename From, typename To, typename F>
+void registerConverterOnce(F converter) {
+    if (!QMetaType::hasRegisteredConverterFunction<From, To>()) {
+        QMetaType::registerConverter<From, To>(converter);
+    }
+}
+
 template<typename T>
 void registerBasicConverters() {
-    QMetaType::registerConverter<int32_t, T>(T::fromType);
-    QMetaType::registerConverter<T, int32_t>(T::toType);
-    QMetaType::registerConverter<int64_t, T>(T::fromType);
-    QMetaType::registerConverter<T, int64_t>(T::toType);
-    QMetaType::registerConverter<uint32_t, T>(T::fromType);
-    QMetaType::registerConverter<T, uint32_t>(T::toType);
-    QMetaType::registerConverter<uint64_t, T>(T::fromType);
-    QMetaType::registerConverter<T, uint64_t>(T::toType);
-    QMetaType::registerConverter<qulonglong, T>(T::fromType);
-    QMetaType::registerConverter<T, qulonglong>(T::toType);
-    QMetaType::registerConverter<qlonglong, T>(T::fromType);
-    QMetaType::registerConverter<T, qlonglong>(T::toType);
-    QMetaType::registerConverter<double, T>(T::fromType);
-    QMetaType::registerConverter<T, double>(T::toType);
-    QMetaType::registerConverter<T, QString>(T::toString);
+    registerConverterOnce<int32_t, T>(T::fromType);
+    registerConverterOnce<T, int32_t>(T::toType);
+    registerConverterOnce<int64_t, T>(T::fromType);
+    registerConverterOnce<T, int64_t>(T::toType);
+    registerConverterOnce<uint32_t, T>(T::fromType);
+    registerConverterOnce<T, uint32_t>(T::toType);
+    registerConverterOnce<uint64_t, T>(T::fromType);
+    registerConverterOnce<T, uint64_t>(T::toType);
+    registerConverterOnce<qulonglong, T>(T::fromType);
+    registerConverterOnce<T, qulonglong>(T::toType);
+    registerConverterOnce<qlonglong, T>(T::fromType);
+    registerConverterOnce<T, qlonglong>(T::toType);
+    registerConverterOnce<double, T>(T::fromType);
+    registerConverterOnce<T, double>(T::toType);
+    registerConverterOnce<T, QString>(T::toString);
+}
+
+template<typename T>
+void registerProtobufType(const char *name) {
+    //Short name is registered as typedef of full name, to avoid second type lookup in registry
+    const int id = qRegisterMetaType<T>((QByteArray("QtProtobuf::") + name).constData());
+    QMetaType::registerNormalizedTypedef(name, id);
 }
+
+struct BasicTypeRegistration {
+    const char *name;
+    void (*registerType)(const char *);
+};
+
+const BasicTypeRegistration BasicTypes[] = {
+    {"int32", registerProtobufType<int32>},
+    {"int64", registerProtobufType<int64>},
+    {"uint32", registerProtobufType<uint32>},
+    {"uint64", registerProtobufType<uint64>},
+    {"sint32", registerProtobufType<sint32>},
+    {"sint64", registerProtobufType<sint64>},
+    {"fixed32", registerProtobufType<fixed32>},
+    {"fixed64", registerProtobufType<fixed64>},
+    {"sfixed32", registerProtobufType<sfixed32>},
+    {"sfixed64", registerProtobufType<sfixed64>},
+    {"int32List", registerProtobufType<int32List>},
+    {"int64List", registerProtobufType<int64List>},
+    {"uint32List", registerProtobufType<uint32List>},
+    {"uint64List", registerProtobufType<uint64List>},
+    {"sint32List", registerProtobufType<sint32List>},
+    {"sint64List", registerProtobufType<sint64List>},
+    {"fixed32List", registerProtobufType<fixed32List>},
+    {"fixed64List", registerProtobufType<fixed64List>},
+    {"sfixed32List", registerProtobufType<sfixed32List>},
+    {"sfixed64List", registerProtobufType<sfixed64List>},
+    {"DoubleList", registerProtobufType<DoubleList>},
+    {"FloatList", registerProtobufType<FloatList>},
+    {"utf8string", registerProtobufType<utf8string>}
+};
+
+//Types of QtProtobuf that are converted from and to Qt integral types
+void (*const BasicConverters[])() = {
+    registerBasicConverters<int32>,
+    registerBasicConverters<int64>,
+    registerBasicConverters<sfixed32>,
+    registerBasicConverters<sfixed64>,
+    registerBasicConverters<fixed32>,
+    registerBasicConverters<fixed64>
+};
 }
 
 std::list<RegisterFunction>& registerFunctions() {
@@ -59,46 +116,55 @@ std::list<RegisterFunction>& registerFunctions() {
     return registrationList;
 }
 
-void qRegisterProtobufTypes() {
+namespace {
+//Registers types defined by QtProtobuf library itself, once
+void registerBasicTypes() {
     static bool registred = false;
     if (registred) {
         return;
     }
     registred = true;
-    registerProtobufType(int32);
-    registerProtobufType(int64);
-    registerProtobufType(uint32);
-    registerProtobufType(uint64);
-    registerProtobufType(sint32);
-    registerProtobufType(sint64);
-    registerProtobufType(fixed32);
-    registerProtobufType(fixed64);
-    registerProtobufType(sfixed32);
-    registerProtobufType(sfixed64);
-
-    registerProtobufType(int32List);
-    registerProtobufType(int64List);
-    registerProtobufType(uint32List);
-    registerProtobufType(uint64List);
-    registerProtobufType(sint32List);
-    registerProtobufType(sint64List);
-    registerProtobufType(fixed32List);
-    registerProtobufType(fixed64List);
-    registerProtobufType(sfixed32List);
-    registerProtobufType(sfixed64List);
-
-    registerProtobufType(DoubleList);
-    registerProtobufType(FloatList);
-
-    registerBasicConverters<int32>();
-    registerBasicConverters<int64>();
-    registerBasicConverters<sfixed32>();
-    registerBasicConverters<sfixed64>();
-    registerBasicConverters<fixed32>();
-    registerBasicConverters<fixed64>();
+    for (const auto &type : BasicTypes) {
+        type.registerType(type.name);
+    }
+    for (auto registerConverters : BasicConverters) {
+        registerConverters();
+    }
 
+    registerConverterOnce<utf8string, QString>(utf8string::toQString);
+    registerConverterOnce<QString, utf8string>(utf8string::fromQString);
+}
+
+//Guards both eager and on demand registration
+std::recursive_mutex &registrationMutex() {
+    static std::recursive_mutex mutex;
+    return mutex;
+}
+}
+
+void qRegisterProtobufTypes() {
+    std::lock_guard<std::recursive_mutex> lock(registrationMutex());
+    QElapsedTimer timer;
+    timer.start();
+    registerBasicTypes();
     for (auto registerFunc : registerFunctions()) {
         registerFunc();
     }
+    qProtoDebug() << "Registered" << registerFunctions().size() << "message types in" << timer.nsecsElapsed() / 1000 << "us";
+}
+
+void registerTypeOnce(LazyTypeRegistration &registration, void (*initializer)()) {
+    if (registration.registered.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(registrationMutex());
+    if (registration.started) {
+        return;
+    }
+    registration.started = true;
+    registerBasicTypes();
+    initializer();
+    registration.registered.store(true, std::memory_order_release);
 }
 }
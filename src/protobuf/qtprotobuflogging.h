@@ -29,7 +29,11 @@
 
 Q_PROTOBUF_EXPORT Q_DECLARE_LOGGING_CATEGORY(qtprotobuflog)
 
+#ifdef QT_PROTOBUF_NO_DEBUG_LOGGING
+#define qProtoDebug(...) QT_NO_QDEBUG_MACRO()
+#else
 #define qProtoDebug(...) qCDebug(qtprotobuflog, __VA_ARGS__)
+#endif
 #define qProtoInfo(...) qCInfo(qtprotobuflog, __VA_ARGS__)
 #define qProtoWarning(...) qCWarning(qtprotobuflog, __VA_ARGS__)
 #define qProtoCritical(...) qCCritical(qtprotobuflog, __VA_ARGS__)
@@ -28,10 +28,18 @@
 #include "qtprotobufglobal.h"
 
 #include <QList>
+#include <QByteArray>
+#include <QString>
 #include <QMap>
+#include <QHash>
 #include <QMetaType>
 
 #include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <initializer_list>
 #include <functional>
 #include <list>
 #include <type_traits>
@@ -55,13 +63,65 @@ enum WireTypes {
     Fixed32 = 5           //!< fixed32, sfixed32, float
 };
 
+/*!
+ * \ingroup QtProtobuf
+ * \brief The DeserializationError enumeration contains errors reported by deserializers
+ *
+ * \see QAbstractProtobufSerializer::tryDeserialize
+ */
+enum DeserializationError {
+    NoDeserializationError = 0,  //!< Message is deserialized successfully
+    InvalidHeaderError,          //!< Field header is malformed
+    NoDeserializerError,         //!< No deserializer is registered for type of received field
+    UnexpectedEndOfStreamError,  //!< Field exceeds bounds of received message
+    InvalidFormatError,          //!< Field payload is malformed
+    LimitExceededError           //!< Message exceeds size, nesting depth or element count limits of deserializer
+};
+
 //! \private
 struct PropertyOrderingInfo {
+    /*!
+     * \brief LazyMessageSetter is generated function that stores serialized payload of message field to
+     *        be parsed at first access
+     */
+    using LazyMessageSetter = void(*)(QObject *, const QByteArray &);
+
     PropertyOrderingInfo(int _qtProperty, const QString &_jsonName) : qtProperty(_qtProperty)
-      , jsonName(_jsonName) {}
+      , jsonName(_jsonName)
+      , wireType(UnknownWireType)
+      , wireTag{}
+      , wireTagSize(0)
+      , lazySetter(nullptr)
+      , protoName(nullptr) {}
+
+    /*!
+     * \brief Constructs ordering info with field header for \a fieldIndex and \a wireType encoded in advance
+     * \details \a _protoName is original field name from .proto file, accepted by json deserializer
+     *          along with \a _jsonName
+     */
+    PropertyOrderingInfo(int _qtProperty, const QString &_jsonName, int fieldIndex, WireTypes _wireType,
+                         LazyMessageSetter _lazySetter = nullptr, const char *_protoName = nullptr) : qtProperty(_qtProperty)
+      , jsonName(_jsonName)
+      , wireType(_wireType)
+      , wireTag{}
+      , wireTagSize(0)
+      , lazySetter(_lazySetter)
+      , protoName(_protoName) {
+        uint32_t header = (static_cast<uint32_t>(fieldIndex) << 3) | _wireType;
+        while (header >= 0b10000000) {
+            wireTag[wireTagSize++] = static_cast<char>((header & 0b01111111) | 0b10000000);
+            header >>= 7;
+        }
+        wireTag[wireTagSize++] = static_cast<char>(header);
+    }
 
     int qtProperty;
     QString jsonName;
+    WireTypes wireType; //!< Wire type of precomputed field header, UnknownWireType if header is not precomputed
+    char wireTag[5]; //!< Varint encoded field header
+    int wireTagSize; //!< Size of encoded field header
+    LazyMessageSetter lazySetter; //!< Setter of unparsed payload, is generated for singular message fields only
+    const char *protoName; //!< Field name as declared in .proto file, nullptr if unknown
     template<typename T,
              typename std::enable_if_t<std::is_integral<T>::value, int> = 0>
     operator T() const { return qtProperty; }
@@ -73,9 +133,147 @@ struct PropertyOrderingInfo {
     bool operator==(const QString &_jsonName) const { return _jsonName == jsonName; }
 };
 
-//! \private
-//!
-using QProtobufPropertyOrdering = std::unordered_map<int, PropertyOrderingInfo>;
+/*!
+ * \private
+ * \ingroup QtProtobuf
+ * \brief The QProtobufPropertyOrdering class is contiguous table that maps protobuf field numbers to properties
+ *
+ * \details Fields are stored sorted by field number, so iteration order is deterministic and matches
+ * field number order. Field numbers below DenseIndexLimit are resolved using direct index lookup,
+ * bigger field numbers are resolved using binary search.
+ */
+class QProtobufPropertyOrdering {
+public:
+    using value_type = std::pair<int, PropertyOrderingInfo>;
+    using const_iterator = std::vector<value_type>::const_iterator;
+    using iterator = const_iterator;
+
+    //! \brief Maximum field number that is resolved using direct index lookup
+    static constexpr int DenseIndexLimit = 128;
+
+    QProtobufPropertyOrdering() = default;
+    QProtobufPropertyOrdering(std::initializer_list<value_type> fields) : m_fields(fields) {
+        std::stable_sort(m_fields.begin(), m_fields.end(), [](const value_type &a, const value_type &b) {
+            return a.first < b.first;
+        });
+        const int denseSize = m_fields.empty() ? 0 : std::min(m_fields.back().first + 1, static_cast<int>(DenseIndexLimit));
+        m_denseIndex.assign(static_cast<size_t>(std::max(denseSize, 0)), -1);
+        for (size_t i = 0; i < m_fields.size() && m_fields[i].first < denseSize; ++i) {
+            if (m_fields[i].first >= 0) {
+                m_denseIndex[static_cast<size_t>(m_fields[i].first)] = static_cast<int>(i);
+            }
+        }
+    }
+
+    const_iterator begin() const { return m_fields.cbegin(); }
+    const_iterator end() const { return m_fields.cend(); }
+    const_iterator cbegin() const { return m_fields.cbegin(); }
+    const_iterator cend() const { return m_fields.cend(); }
+
+    size_t size() const { return m_fields.size(); }
+    bool empty() const { return m_fields.empty(); }
+
+    /*!
+     * \brief Looks up property assigned to \a fieldNumber
+     * \return iterator pointing to found field or end() if field is not in table
+     */
+    const_iterator find(int fieldNumber) const {
+        if (fieldNumber >= 0 && static_cast<size_t>(fieldNumber) < m_denseIndex.size()) {
+            const int index = m_denseIndex[static_cast<size_t>(fieldNumber)];
+            return index < 0 ? end() : begin() + index;
+        }
+        auto it = std::lower_bound(begin(), end(), fieldNumber, [](const value_type &field, int number) {
+            return field.first < number;
+        });
+        return (it != end() && it->first == fieldNumber) ? it : end();
+    }
+
+    size_t count(int fieldNumber) const { return find(fieldNumber) != end() ? 1 : 0; }
+
+    /*!
+     * \brief Returns property info assigned to \a fieldNumber
+     * \throws std::out_of_range if \a fieldNumber is not in table
+     */
+    const PropertyOrderingInfo &at(int fieldNumber) const {
+        auto it = find(fieldNumber);
+        if (it == end()) {
+#ifndef QT_PROTOBUF_NO_EXCEPTIONS
+            throw std::out_of_range("Field number is not in property ordering");
+#else
+            qFatal("Field number is not in property ordering");
+#endif
+        }
+        return it->second;
+    }
+
+private:
+    std::vector<value_type> m_fields;
+    std::vector<int> m_denseIndex;
+};
+
+class QProtobufMetaObject;
+
+/*!
+ * \private
+ * \ingroup QtProtobuf
+ * \brief The FieldKind enumeration reflects field types as they are declared in .proto file
+ */
+enum class FieldKind : unsigned char {
+    Int32,
+    Int64,
+    UInt32,
+    UInt64,
+    SInt32,
+    SInt64,
+    Fixed32,
+    Fixed64,
+    SFixed32,
+    SFixed64,
+    Float,
+    Double,
+    Bool,
+    String,
+    Bytes,
+    Enum,
+    Message,
+    Map
+};
+
+/*!
+ * \private
+ * \ingroup QtProtobuf
+ * \brief Returns metatype identifier of \a T, is referenced by generated field descriptors
+ */
+template<typename T>
+int metaTypeIdOf() {
+    return qMetaTypeId<T>();
+}
+
+/*!
+ * \private
+ * \ingroup QtProtobuf
+ * \brief The QProtobufFieldDescriptor struct describes message field known at generation time
+ *
+ * \details Descriptors are generated as static tables of literals and function pointers, so tables are
+ *          initialized at compile time. Table of message type follows field number order, same as
+ *          QProtobufPropertyOrdering. Serializers resolve field types using descriptors instead of
+ *          looking up type names of meta-object properties.
+ */
+struct QProtobufFieldDescriptor {
+    using MetaTypeResolver = int(*)();
+
+    int fieldNumber;
+    int qtProperty;                         //!< Index of property in message meta-object
+    WireTypes wireType;
+    FieldKind kind;
+    bool repeated;
+    bool explicitPresence;                  //!< Field is declared as proto3 optional, it's sent with default value if set
+    const char *jsonName;
+    const char *protoName;
+    MetaTypeResolver metaType;              //!< Returns metatype identifier of property
+    const QProtobufMetaObject *nestedType;  //!< Meta-object of message type of field, nullptr for other fields
+    bool internStrings;                     //!< Decoded strings of field are interned, see QProtobufSerializer::setStringInterningEnabled
+};
 
 /*!
  * \private
@@ -96,6 +294,12 @@ struct transparent {
     static QString toString(transparent t) { return QString::number(t._t); }
 };
 
+//! \private
+template<typename T, int I>
+inline uint qHash(transparent<T, I> key, uint seed = 0) {
+    return ::qHash(key._t, seed);
+}
+
 /*!
  * \brief int32 signed 32-bit integer
  * \ingroup QtProtobuf
@@ -252,10 +456,36 @@ using FloatList = QList<float>;
  */
 using DoubleList = QList<double>;
 
+/*!
+ * \ingroup QtProtobuf
+ * \brief utf8string is protobuf string stored as UTF-8 encoded bytes
+ *
+ * \details utf8string is used for singular string fields of messages generated with UTF8 option. It's serialized
+ *          and deserialized as is, without conversion to UTF-16 and back, QString is built only when toString()
+ *          is called.
+ */
+class utf8string : public QByteArray
+{
+public:
+    utf8string() = default;
+    utf8string(const QByteArray &data) : QByteArray(data) {}
+    utf8string(const char *data) : QByteArray(data) {}
+    utf8string(const QString &string) : QByteArray(string.toUtf8()) {}
+
+    QString toString() const { return QString::fromUtf8(*this); }
+
+    static QString toQString(const utf8string &value) { return value.toString(); }
+    static utf8string fromQString(const QString &string) { return utf8string(string); }
+};
+
 /*!
  * \ingroup QtProtobuf
  * \brief qRegisterProtobufTypes
  * This method should be called in all applications that supposed to use QtProtobuf
+ *
+ * \details Registers all linked message types at once. Generated message types are also registered on demand,
+ *          the first time they are serialized or deserialized, with types of their fields. So the call is required
+ *          only if message types are used by meta-type system before, e.g. in QML or QVariant conversions.
  */
 Q_PROTOBUF_EXPORT void qRegisterProtobufTypes();
 
@@ -275,11 +505,34 @@ struct ProtoTypeRegistrar {
     }
 };
 
+/*!
+ * \private
+ * \brief State of on demand registration of generated type
+ *
+ * \details Intended to be static, so it's zero-initialized and doesn't need dynamic initialization.
+ */
+struct LazyTypeRegistration {
+    std::atomic<bool> registered;
+    bool started;
+};
+
+/*!
+ * \private
+ * \brief Calls \a initializer unless type of \a registration is registered or its registration is in progress
+ *
+ * \details Registration of a type registers types of its fields, that may refer the type back, so recursive calls
+ *          return immediately. Other threads wait until registration is finished.
+ */
+Q_PROTOBUF_EXPORT void registerTypeOnce(LazyTypeRegistration &registration, void (*initializer)());
+
 template<typename T>
 bool repeatedValueCompare(const QList<QSharedPointer<T>>& a, const QList<QSharedPointer<T>>& b) {
     if (a.size() != b.size()) {
         return false;
     }
+    if (a.isSharedWith(b)) {
+        return true;
+    }
     auto itA = std::begin(a);
     auto itB = std::begin(b);
     while (itA != std::end(a) && itB != std::end(b)) {
@@ -303,6 +556,9 @@ bool repeatedValueCompare(const QMap<K, QSharedPointer<V>>& a, const QMap<K, QSh
     if (a.size() != b.size()) {
         return false;
     }
+    if (a.isSharedWith(b)) {
+        return true;
+    }
 
     for (auto itA = a.keyValueBegin(); itA != a.keyValueEnd(); ++itA) {
         if (b.value((*itA).first) != (*itA).second
@@ -314,6 +570,31 @@ bool repeatedValueCompare(const QMap<K, QSharedPointer<V>>& a, const QMap<K, QSh
     return true;
 }
 
+template<typename K, typename V>
+bool repeatedValueCompare(const QHash<K, V>& a, const QHash<K, V>& b) {
+    return a == b;
+}
+
+template<typename K, typename V>
+bool repeatedValueCompare(const QHash<K, QSharedPointer<V>>& a, const QHash<K, QSharedPointer<V>>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    if (a.isSharedWith(b)) {
+        return true;
+    }
+
+    for (auto itA = a.constBegin(); itA != a.constEnd(); ++itA) {
+        const QSharedPointer<V> valueB = b.value(itA.key());
+        if (valueB != itA.value()
+                && (valueB.isNull() || itA.value().isNull() || *valueB != *itA.value())) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 }
 
 Q_DECLARE_METATYPE(QtProtobuf::int32)
@@ -340,6 +621,7 @@ Q_DECLARE_METATYPE(QtProtobuf::sfixed64List)
 
 Q_DECLARE_METATYPE(QtProtobuf::FloatList)
 Q_DECLARE_METATYPE(QtProtobuf::DoubleList)
+Q_DECLARE_METATYPE(QtProtobuf::utf8string)
 
 namespace std {
 //! \private
@@ -48,9 +48,14 @@
 #include <QQuaternion>
 #include <QImage>
 #include <QBuffer>
+#include <QtEndian>
+
+#include <cstring>
+#include <type_traits>
 
 #include <qtprotobuftypes.h>
 #include <qtprotobufqttypes.h>
+#include <qprotobufwireformat.h>
 
 #include "qabstractprotobufserializer.h"
 #include "qabstractprotobufserializer_p.h"
@@ -69,6 +74,9 @@ namespace QtProtobuf {
 }
 
 ::QChar convert(const ::QtProtobuf::QChar &from) {
+    if (from.character().isEmpty()) {
+        return ::QChar(static_cast<ushort>(from.code()));
+    }
     QDataStream stream(from.character());
     ::QChar ret;
     stream >> ret;
@@ -83,6 +91,9 @@ namespace QtProtobuf {
 }
 
 ::QUuid convert(const ::QtProtobuf::QUuid &from) {
+    if (!from.rfc4122().isEmpty()) {
+        return ::QUuid::fromRfc4122(from.rfc4122());
+    }
     return ::QUuid(from.uuid());
 }
 
@@ -175,6 +186,10 @@ namespace QtProtobuf {
     for (auto point : from.points()) {
         polygon.append(convert(*point));
     }
+    const sint32List &coordinates = from.coordinates();
+    for (int i = 0; i + 1 < coordinates.size(); i += 2) {
+        polygon.append(::QPoint(coordinates.at(i), coordinates.at(i + 1)));
+    }
     return polygon;
 }
 
@@ -191,6 +206,10 @@ namespace QtProtobuf {
     for (auto point : from.points()) {
         polygon.append(convert(*point));
     }
+    const DoubleList &coordinates = from.coordinates();
+    for (int i = 0; i + 1 < coordinates.size(); i += 2) {
+        polygon.append(::QPointF(coordinates.at(i), coordinates.at(i + 1)));
+    }
     return polygon;
 }
 
@@ -262,21 +281,769 @@ namespace QtProtobuf {
     return ::QtProtobuf::QQuaternion(from.scalar(), convert(from.vector()));
 }
 
+namespace {
+
+const char RawImageFormat[] = "raw";
+
+struct ImageEncodingSettings {
+    QtImageEncoding encoding = QtImageEncoding::Png;
+    int quality = -1;
+};
+
+ImageEncodingSettings &imageEncodingSettings() {
+    static ImageEncodingSettings settings;
+    return settings;
+}
+
+QByteArray encodeImage(const ::QImage &image, QString &format) {
+    const ImageEncodingSettings &settings = imageEncodingSettings();
+    const char *formatName = settings.encoding == QtImageEncoding::Jpeg ? "JPEG" : "PNG";
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, formatName, settings.quality);
+    format = QLatin1String(formatName);
+    return data;
+}
+
+int rawImageDataSize(const ::QImage &image) {
+    return image.bytesPerLine() * image.height();
+}
+
+uint32List rawImageColorTable(const ::QImage &image) {
+    uint32List colorTable;
+    const QVector<QRgb> colors = image.colorTable();
+    colorTable.reserve(colors.size());
+    for (QRgb color : colors) {
+        colorTable.append(color);
+    }
+    return colorTable;
+}
+
+//Image is constructed on top of received buffer, buffer is released together with image data
+::QImage rawImage(const QByteArray &data, int width, int height, int bytesPerLine, int pixelFormat, const uint32List &colorTable) {
+    if (width <= 0 || height <= 0 || bytesPerLine <= 0
+            || pixelFormat <= ::QImage::Format_Invalid || pixelFormat >= ::QImage::NImageFormats
+            || static_cast<qint64>(bytesPerLine) * height > data.size()) {
+        return ::QImage();
+    }
+
+    QByteArray *holder = new QByteArray(data);
+    ::QImage image(reinterpret_cast<const uchar *>(holder->constData()), width, height, bytesPerLine,
+                   static_cast<::QImage::Format>(pixelFormat),
+                   [](void *info) { delete static_cast<QByteArray *>(info); }, holder);
+    if (image.isNull()) {
+        delete holder;
+        return image;
+    }
+
+    if (!colorTable.isEmpty()) {
+        QVector<QRgb> colors;
+        colors.reserve(colorTable.size());
+        for (uint32 color : colorTable) {
+            colors.append(color);
+        }
+        image.setColorTable(colors);
+    }
+    return image;
+}
+
+}
+
 ::QImage convert(const ::QtProtobuf::QImage &from) {
+    if (from.format() == QLatin1String(RawImageFormat)) {
+        return rawImage(from.data(), from.width(), from.height(), from.bytesPerLine(), from.pixelFormat(), from.colorTable());
+    }
     return ::QImage::fromData(from.data(), from.format().toLatin1().data());
 }
 
 ::QtProtobuf::QImage convert(const ::QImage &from) {
+    ::QtProtobuf::QImage result;
+    if (imageEncodingSettings().encoding == QtImageEncoding::Raw) {
+        result.setData(QByteArray(reinterpret_cast<const char *>(from.constBits()), rawImageDataSize(from)));
+        result.setFormat(QLatin1String(RawImageFormat));
+        result.setWidth(from.width());
+        result.setHeight(from.height());
+        result.setBytesPerLine(from.bytesPerLine());
+        result.setPixelFormat(from.format());
+        result.setColorTable(rawImageColorTable(from));
+        return result;
+    }
+
+    QString format;
+    result.setData(encodeImage(from, format));
+    result.setFormat(format);
+    return result;
+}
+
+namespace {
+
+//Direct wire codecs write the same fields as messages from QtCore.proto and QtGui.proto, without intermediate objects
+template<typename T, size_t N>
+void writeFields(QByteArray &buffer, const T (&values)[N]) {
+    for (size_t i = 0; i < N; i++) {
+        QProtobufWireFormat::writeField(buffer, static_cast<int>(i + 1), values[i]);
+    }
+}
+
+template<typename T, size_t N>
+int fieldsSize(const T (&values)[N]) {
+    int size = 0;
+    for (size_t i = 0; i < N; i++) {
+        size += QProtobufWireFormat::fieldSize(static_cast<int>(i + 1), values[i]);
+    }
+    return size;
+}
+
+template<typename T, size_t N>
+void readFields(QProtobufSelfcheckIterator &it, T (&values)[N]) {
+    QProtobufWireFormat::readMessageFields(it, [&values](QProtobufSelfcheckIterator &fieldIt, int fieldNumber) {
+        if (fieldNumber < 1 || fieldNumber > static_cast<int>(N)) {
+            return false;
+        }
+        QProtobufWireFormat::readField(fieldIt, values[fieldNumber - 1]);
+        return true;
+    });
+}
+
+void writePayload(QByteArray &buffer, const ::QUuid &value) {
+    const QString values[] = {value.toString()};
+    writeFields(buffer, values);
+}
+
+int payloadSize(const ::QUuid &value) {
+    const QString values[] = {value.toString()};
+    return fieldsSize(values);
+}
+
+void readPayload(QProtobufSelfcheckIterator &it, ::QUuid &value) {
+    QString uuid;
+    QByteArray rfc4122;
+    QProtobufWireFormat::readMessageFields(it, [&uuid, &rfc4122](QProtobufSelfcheckIterator &fieldIt, int fieldNumber) {
+        if (fieldNumber == 1) {
+            QProtobufWireFormat::readField(fieldIt, uuid);
+        } else if (fieldNumber == 2) {
+            QProtobufWireFormat::readField(fieldIt, rfc4122);
+        } else {
+            return false;
+        }
+        return true;
+    });
+    value = rfc4122.isEmpty() ? ::QUuid(uuid) : ::QUuid::fromRfc4122(rfc4122);
+}
+
+//QChar is written as big-endian code unit, same as QDataStream does
+void writePayload(QByteArray &buffer, const ::QChar &value) {
+    const char character[] = {static_cast<char>(value.unicode() >> 8), static_cast<char>(value.unicode() & 0xff)};
+    QProtobufWireFormat::writeField(buffer, 1, QByteArray::fromRawData(character, sizeof(character)));
+}
+
+int payloadSize(const ::QChar &/*value*/) {
+    return QProtobufWireFormat::lengthDelimitedSize(1, 2);
+}
+
+void readPayload(QProtobufSelfcheckIterator &it, ::QChar &value) {
+    QByteArray character;
+    uint32 code = 0;
+    QProtobufWireFormat::readMessageFields(it, [&character, &code](QProtobufSelfcheckIterator &fieldIt, int fieldNumber) {
+        if (fieldNumber == 1) {
+            QProtobufWireFormat::readField(fieldIt, character);
+        } else if (fieldNumber == 2) {
+            QProtobufWireFormat::readField(fieldIt, code);
+        } else {
+            return false;
+        }
+        return true;
+    });
+    if (character.size() >= 2) {
+        code = (static_cast<uchar>(character.at(0)) << 8) | static_cast<uchar>(character.at(1));
+    }
+    value = ::QChar(static_cast<ushort>(code));
+}
+
+void writePayload(QByteArray &buffer, const ::QTime &value) {
+    const sint32 values[] = {value.msecsSinceStartOfDay()};
+    writeFields(buffer, values);
+}
+
+int payloadSize(const ::QTime &value) {
+    const sint32 values[] = {value.msecsSinceStartOfDay()};
+    return fieldsSize(values);
+}
+
+void readPayload(QProtobufSelfcheckIterator &it, ::QTime &value) {
+    sint32 values[1] = {};
+    readFields(it, values);
+    value = ::QTime::fromMSecsSinceStartOfDay(values[0]);
+}
+
+void writePayload(QByteArray &buffer, const ::QDate &value) {
+    const sint32 values[] = {value.year(), value.month(), value.day()};
+    writeFields(buffer, values);
+}
+
+int payloadSize(const ::QDate &value) {
+    const sint32 values[] = {value.year(), value.month(), value.day()};
+    return fieldsSize(values);
+}
+
+void readPayload(QProtobufSelfcheckIterator &it, ::QDate &value) {
+    sint32 values[3] = {};
+    readFields(it, values);
+    value = ::QDate(values[0], values[1], values[2]);
+}
+
+void writePayload(QByteArray &buffer, const ::QSize &value) {
+    const sint32 values[] = {value.width(), value.height()};
+    writeFields(buffer, values);
+}
+
+int payloadSize(const ::QSize &value) {
+    const sint32 values[] = {value.width(), value.height()};
+    return fieldsSize(values);
+}
+
+void readPayload(QProtobufSelfcheckIterator &it, ::QSize &value) {
+    sint32 values[2] = {};
+    readFields(it, values);
+    value = ::QSize(values[0], values[1]);
+}
+
+void writePayload(QByteArray &buffer, const ::QSizeF &value) {
+    const double values[] = {value.width(), value.height()};
+    writeFields(buffer, values);
+}
+
+int payloadSize(const ::QSizeF &value) {
+    const double values[] = {value.width(), value.height()};
+    return fieldsSize(values);
+}
+
+void readPayload(QProtobufSelfcheckIterator &it, ::QSizeF &value) {
+    double values[2] = {};
+    readFields(it, values);
+    value = ::QSizeF(values[0], values[1]);
+}
+
+void writePayload(QByteArray &buffer, const ::QPoint &value) {
+    const sint32 values[] = {value.x(), value.y()};
+    writeFields(buffer, values);
+}
+
+int payloadSize(const ::QPoint &value) {
+    const sint32 values[] = {value.x(), value.y()};
+    return fieldsSize(values);
+}
+
+void readPayload(QProtobufSelfcheckIterator &it, ::QPoint &value) {
+    sint32 values[2] = {};
+    readFields(it, values);
+    value = ::QPoint(values[0], values[1]);
+}
+
+void writePayload(QByteArray &buffer, const ::QPointF &value) {
+    const double values[] = {value.x(), value.y()};
+    writeFields(buffer, values);
+}
+
+int payloadSize(const ::QPointF &value) {
+    const double values[] = {value.x(), value.y()};
+    return fieldsSize(values);
+}
+
+void readPayload(QProtobufSelfcheckIterator &it, ::QPointF &value) {
+    double values[2] = {};
+    readFields(it, values);
+    value = ::QPointF(values[0], values[1]);
+}
+
+void writePayload(QByteArray &buffer, const ::QColor &value) {
+    const uint32 values[] = {value.rgba()};
+    writeFields(buffer, values);
+}
+
+int payloadSize(const ::QColor &value) {
+    const uint32 values[] = {value.rgba()};
+    return fieldsSize(values);
+}
+
+void readPayload(QProtobufSelfcheckIterator &it, ::QColor &value) {
+    uint32 values[1] = {};
+    readFields(it, values);
+    value = ::QColor::fromRgba(values[0]);
+}
+
+void writePayload(QByteArray &buffer, const ::QMatrix4x4 &value) {
+    //QMatrix4x4::constData returns values in column-major order, message fields are in row-major order
+    float values[16];
+    for (int i = 0; i < 16; i++) {
+        values[i] = value.constData()[(i % 4) * 4 + i / 4];
+    }
+    writeFields(buffer, values);
+}
+
+int payloadSize(const ::QMatrix4x4 &value) {
+    float values[16];
+    for (int i = 0; i < 16; i++) {
+        values[i] = value.constData()[(i % 4) * 4 + i / 4];
+    }
+    return fieldsSize(values);
+}
+
+void readPayload(QProtobufSelfcheckIterator &it, ::QMatrix4x4 &value) {
+    float values[16] = {};
+    readFields(it, values);
+    value = ::QMatrix4x4(values);
+}
+
+void writePayload(QByteArray &buffer, const ::QVector2D &value) {
+    const float values[] = {value.x(), value.y()};
+    writeFields(buffer, values);
+}
+
+int payloadSize(const ::QVector2D &value) {
+    const float values[] = {value.x(), value.y()};
+    return fieldsSize(values);
+}
+
+void readPayload(QProtobufSelfcheckIterator &it, ::QVector2D &value) {
+    float values[2] = {};
+    readFields(it, values);
+    value = ::QVector2D(values[0], values[1]);
+}
+
+void writePayload(QByteArray &buffer, const ::QVector3D &value) {
+    const float values[] = {value.x(), value.y(), value.z()};
+    writeFields(buffer, values);
+}
+
+int payloadSize(const ::QVector3D &value) {
+    const float values[] = {value.x(), value.y(), value.z()};
+    return fieldsSize(values);
+}
+
+void readPayload(QProtobufSelfcheckIterator &it, ::QVector3D &value) {
+    float values[3] = {};
+    readFields(it, values);
+    value = ::QVector3D(values[0], values[1], values[2]);
+}
+
+void writePayload(QByteArray &buffer, const ::QVector4D &value) {
+    const float values[] = {value.x(), value.y(), value.z(), value.w()};
+    writeFields(buffer, values);
+}
+
+int payloadSize(const ::QVector4D &value) {
+    const float values[] = {value.x(), value.y(), value.z(), value.w()};
+    return fieldsSize(values);
+}
+
+void readPayload(QProtobufSelfcheckIterator &it, ::QVector4D &value) {
+    float values[4] = {};
+    readFields(it, values);
+    value = ::QVector4D(values[0], values[1], values[2], values[3]);
+}
+
+void writePayload(QByteArray &buffer, const ::QTransform &value) {
+    const double values[] = {value.m11(), value.m12(), value.m13(),
+                             value.m21(), value.m22(), value.m23(),
+                             value.m31(), value.m32(), value.m33()};
+    writeFields(buffer, values);
+}
+
+int payloadSize(const ::QTransform &value) {
+    const double values[] = {value.m11(), value.m12(), value.m13(),
+                             value.m21(), value.m22(), value.m23(),
+                             value.m31(), value.m32(), value.m33()};
+    return fieldsSize(values);
+}
+
+void readPayload(QProtobufSelfcheckIterator &it, ::QTransform &value) {
+    double values[9] = {};
+    readFields(it, values);
+    value = ::QTransform(values[0], values[1], values[2],
+                         values[3], values[4], values[5],
+                         values[6], values[7], values[8]);
+}
+
+//Nested messages are written even if they are empty, same as message fields of generated messages
+template<typename QType>
+void writeNested(QByteArray &buffer, int fieldNumber, const QType &value) {
+    const int sizePosition = QProtobufWireFormat::beginLengthDelimited(buffer, fieldNumber);
+    writePayload(buffer, value);
+    QProtobufWireFormat::endLengthDelimited(buffer, sizePosition);
+}
+
+template<typename QType>
+int nestedSize(int fieldNumber, const QType &value) {
+    return QProtobufWireFormat::lengthDelimitedSize(fieldNumber, payloadSize(value));
+}
+
+void writePayload(QByteArray &buffer, const ::QDateTime &value) {
+    writeNested(buffer, 1, value.date());
+    writeNested(buffer, 2, value.time());
+}
+
+int payloadSize(const ::QDateTime &value) {
+    return nestedSize(1, value.date()) + nestedSize(2, value.time());
+}
+
+void readPayload(QProtobufSelfcheckIterator &it, ::QDateTime &value) {
+    ::QDate date;
+    ::QTime time;
+    QProtobufWireFormat::readMessageFields(it, [&date, &time](QProtobufSelfcheckIterator &fieldIt, int fieldNumber) {
+        if (fieldNumber == 1) {
+            readPayload(fieldIt, date);
+        } else if (fieldNumber == 2) {
+            readPayload(fieldIt, time);
+        } else {
+            return false;
+        }
+        return true;
+    });
+    value = ::QDateTime(date, time);
+}
+
+void writePayload(QByteArray &buffer, const ::QRect &value) {
+    writeNested(buffer, 1, value.topLeft());
+    writeNested(buffer, 2, value.size());
+}
+
+int payloadSize(const ::QRect &value) {
+    return nestedSize(1, value.topLeft()) + nestedSize(2, value.size());
+}
+
+void readPayload(QProtobufSelfcheckIterator &it, ::QRect &value) {
+    ::QPoint position(0, 0);
+    ::QSize size(0, 0);
+    QProtobufWireFormat::readMessageFields(it, [&position, &size](QProtobufSelfcheckIterator &fieldIt, int fieldNumber) {
+        if (fieldNumber == 1) {
+            readPayload(fieldIt, position);
+        } else if (fieldNumber == 2) {
+            readPayload(fieldIt, size);
+        } else {
+            return false;
+        }
+        return true;
+    });
+    value = ::QRect(position, size);
+}
+
+void writePayload(QByteArray &buffer, const ::QRectF &value) {
+    writeNested(buffer, 1, value.topLeft());
+    writeNested(buffer, 2, value.size());
+}
+
+int payloadSize(const ::QRectF &value) {
+    return nestedSize(1, value.topLeft()) + nestedSize(2, value.size());
+}
+
+void readPayload(QProtobufSelfcheckIterator &it, ::QRectF &value) {
+    ::QPointF position(0.0, 0.0);
+    ::QSizeF size(0.0, 0.0);
+    QProtobufWireFormat::readMessageFields(it, [&position, &size](QProtobufSelfcheckIterator &fieldIt, int fieldNumber) {
+        if (fieldNumber == 1) {
+            readPayload(fieldIt, position);
+        } else if (fieldNumber == 2) {
+            readPayload(fieldIt, size);
+        } else {
+            return false;
+        }
+        return true;
+    });
+    value = ::QRectF(position, size);
+}
+
+void writePayload(QByteArray &buffer, const ::QQuaternion &value) {
+    QProtobufWireFormat::writeField(buffer, 1, value.scalar());
+    writeNested(buffer, 2, value.vector());
+}
+
+int payloadSize(const ::QQuaternion &value) {
+    return QProtobufWireFormat::fieldSize(1, value.scalar()) + nestedSize(2, value.vector());
+}
+
+void readPayload(QProtobufSelfcheckIterator &it, ::QQuaternion &value) {
+    float scalar = 0.0f;
+    ::QVector3D vector;
+    QProtobufWireFormat::readMessageFields(it, [&scalar, &vector](QProtobufSelfcheckIterator &fieldIt, int fieldNumber) {
+        if (fieldNumber == 1) {
+            QProtobufWireFormat::readField(fieldIt, scalar);
+        } else if (fieldNumber == 2) {
+            readPayload(fieldIt, vector);
+        } else {
+            return false;
+        }
+        return true;
+    });
+    value = ::QQuaternion(scalar, vector);
+}
+
+void writePayload(QByteArray &buffer, const ::QPolygon &value) {
+    for (const ::QPoint &point : value) {
+        writeNested(buffer, 1, point);
+    }
+}
+
+int payloadSize(const ::QPolygon &value) {
+    int size = 0;
+    for (const ::QPoint &point : value) {
+        size += nestedSize(1, point);
+    }
+    return size;
+}
+
+void readPayload(QProtobufSelfcheckIterator &it, ::QPolygon &value) {
+    value.clear();
+    QProtobufWireFormat::readMessageFields(it, [&value](QProtobufSelfcheckIterator &fieldIt, int fieldNumber) {
+        if (fieldNumber == 1) {
+            ::QPoint point;
+            readPayload(fieldIt, point);
+            value.append(point);
+        } else if (fieldNumber == 2) {
+            sint32List coordinates;
+            QProtobufWireFormat::readField(fieldIt, coordinates);
+            value.reserve(value.size() + coordinates.size() / 2);
+            for (int i = 0; i + 1 < coordinates.size(); i += 2) {
+                value.append(::QPoint(coordinates.at(i), coordinates.at(i + 1)));
+            }
+        } else {
+            return false;
+        }
+        return true;
+    });
+}
+
+void writePayload(QByteArray &buffer, const ::QPolygonF &value) {
+    for (const ::QPointF &point : value) {
+        writeNested(buffer, 1, point);
+    }
+}
+
+int payloadSize(const ::QPolygonF &value) {
+    int size = 0;
+    for (const ::QPointF &point : value) {
+        size += nestedSize(1, point);
+    }
+    return size;
+}
+
+//Packed doubles are little-endian IEEE 754 values, same as QPointF storage on little-endian platforms with double qreal
+constexpr bool PointFMatchesWireFormat = Q_BYTE_ORDER == Q_LITTLE_ENDIAN && std::is_same<qreal, double>::value
+        && sizeof(::QPointF) == 2 * sizeof(double);
+
+void readPackedCoordinates(QProtobufSelfcheckIterator &it, ::QPolygonF &polygon) {
+    const int length = QProtobufWireFormat::readLength(it);
+    if (length < 0 || length > it.size()) {
+        it += length;
+        return;
+    }
+
+    const int count = length / static_cast<int>(2 * sizeof(double));
+    const int offset = polygon.size();
+    polygon.resize(offset + count);
+    if (PointFMatchesWireFormat) {
+        std::memcpy(static_cast<void *>(polygon.data() + offset), it.data(), count * sizeof(::QPointF));
+    } else {
+        const char *data = it.data();
+        for (int i = 0; i < count; i++) {
+            double coordinates[2];
+            for (double &coordinate : coordinates) {
+                const quint64 bits = qFromLittleEndian<quint64>(data);
+                std::memcpy(&coordinate, &bits, sizeof(double));
+                data += sizeof(double);
+            }
+            polygon[offset + i] = ::QPointF(coordinates[0], coordinates[1]);
+        }
+    }
+    it += length;
+}
+
+void writePackedCoordinates(QByteArray &buffer, const ::QPolygonF &polygon) {
+    if (polygon.isEmpty()) {
+        return;
+    }
+
+    const int sizePosition = QProtobufWireFormat::beginLengthDelimited(buffer, 2);
+    if (PointFMatchesWireFormat) {
+        buffer.append(reinterpret_cast<const char *>(polygon.constData()), polygon.size() * static_cast<int>(sizeof(::QPointF)));
+    } else {
+        for (const ::QPointF &point : polygon) {
+            for (double coordinate : {static_cast<double>(point.x()), static_cast<double>(point.y())}) {
+                quint64 bits = 0;
+                std::memcpy(&bits, &coordinate, sizeof(double));
+                bits = qToLittleEndian(bits);
+                buffer.append(reinterpret_cast<const char *>(&bits), sizeof(bits));
+            }
+        }
+    }
+    QProtobufWireFormat::endLengthDelimited(buffer, sizePosition);
+}
+
+int packedCoordinatesSize(const ::QPolygonF &polygon) {
+    return polygon.isEmpty() ? 0 : QProtobufWireFormat::lengthDelimitedSize(2, polygon.size() * static_cast<int>(2 * sizeof(double)));
+}
+
+void readPayload(QProtobufSelfcheckIterator &it, ::QPolygonF &value) {
+    value.clear();
+    QProtobufWireFormat::readMessageFields(it, [&value](QProtobufSelfcheckIterator &fieldIt, int fieldNumber) {
+        if (fieldNumber == 1) {
+            ::QPointF point;
+            readPayload(fieldIt, point);
+            value.append(point);
+        } else if (fieldNumber == 2) {
+            readPackedCoordinates(fieldIt, value);
+        } else {
+            return false;
+        }
+        return true;
+    });
+}
+
+//Unlike writeNested, these templates are defined after payload codecs of all types, so overloads for nested types are visible
+template<typename QType>
+void serializeDirect(const QVariant &value, int fieldNumber, QByteArray &buffer) {
+    const int sizePosition = QProtobufWireFormat::beginLengthDelimited(buffer, fieldNumber);
+    writePayload(buffer, *static_cast<const QType *>(value.constData()));
+    QProtobufWireFormat::endLengthDelimited(buffer, sizePosition);
+}
+
+template<typename QType>
+int directSize(const QVariant &value, int fieldNumber) {
+    return QProtobufWireFormat::lengthDelimitedSize(fieldNumber, payloadSize(*static_cast<const QType *>(value.constData())));
+}
+
+template<typename QType>
+void deserializeDirect(QProtobufSelfcheckIterator &it, QVariant &value) {
+    QType result;
+    readPayload(it, result);
+    value = QVariant::fromValue<QType>(result);
+}
+
+//Raw pixel buffer is appended to wire buffer directly from image memory
+void serializeRawImage(const QVariant &value, int fieldNumber, QByteArray &buffer) {
+    const ::QImage &image = *static_cast<const ::QImage *>(value.constData());
+    const int sizePosition = QProtobufWireFormat::beginLengthDelimited(buffer, fieldNumber);
+    QProtobufWireFormat::writeField(buffer, 1, QByteArray::fromRawData(reinterpret_cast<const char *>(image.constBits()), rawImageDataSize(image)));
+    QProtobufWireFormat::writeField(buffer, 2, QString(QLatin1String(RawImageFormat)));
+    QProtobufWireFormat::writeField(buffer, 3, int32(image.width()));
+    QProtobufWireFormat::writeField(buffer, 4, int32(image.height()));
+    QProtobufWireFormat::writeField(buffer, 5, int32(image.bytesPerLine()));
+    QProtobufWireFormat::writeField(buffer, 6, int32(image.format()));
+    QProtobufWireFormat::writeField(buffer, 7, rawImageColorTable(image));
+    QProtobufWireFormat::endLengthDelimited(buffer, sizePosition);
+}
+
+int rawImageSize(const QVariant &value, int fieldNumber) {
+    const ::QImage &image = *static_cast<const ::QImage *>(value.constData());
+    const int dataSize = rawImageDataSize(image);
+    const int size = (dataSize > 0 ? QProtobufWireFormat::lengthDelimitedSize(1, dataSize) : 0)
+            + QProtobufWireFormat::fieldSize(2, QString(QLatin1String(RawImageFormat)))
+            + QProtobufWireFormat::fieldSize(3, int32(image.width()))
+            + QProtobufWireFormat::fieldSize(4, int32(image.height()))
+            + QProtobufWireFormat::fieldSize(5, int32(image.bytesPerLine()))
+            + QProtobufWireFormat::fieldSize(6, int32(image.format()))
+            + QProtobufWireFormat::fieldSize(7, rawImageColorTable(image));
+    return QProtobufWireFormat::lengthDelimitedSize(fieldNumber, size);
+}
+
+void serializeEncodedImage(const QVariant &value, int fieldNumber, QByteArray &buffer) {
+    QString format;
+    const QByteArray data = encodeImage(*static_cast<const ::QImage *>(value.constData()), format);
+    const int sizePosition = QProtobufWireFormat::beginLengthDelimited(buffer, fieldNumber);
+    QProtobufWireFormat::writeField(buffer, 1, data);
+    QProtobufWireFormat::writeField(buffer, 2, format);
+    QProtobufWireFormat::endLengthDelimited(buffer, sizePosition);
+}
+
+void deserializeImage(QProtobufSelfcheckIterator &it, QVariant &value) {
     QByteArray data;
-    QBuffer buffer(&data);
-    buffer.open(QIODevice::WriteOnly);
-    from.save(&buffer, "PNG");
-    qProtoWarning() << "QImage always is sent in PNG format";
-    return ::QtProtobuf::QImage(data, "PNG");
+    QString format;
+    int32 metrics[4] = {0, 0, 0, 0};
+    uint32List colorTable;
+    QProtobufWireFormat::readMessageFields(it, [&data, &format, &metrics, &colorTable](QProtobufSelfcheckIterator &fieldIt, int fieldNumber) {
+        if (fieldNumber == 1) {
+            QProtobufWireFormat::readField(fieldIt, data);
+        } else if (fieldNumber == 2) {
+            QProtobufWireFormat::readField(fieldIt, format);
+        } else if (fieldNumber >= 3 && fieldNumber <= 6) {
+            QProtobufWireFormat::readField(fieldIt, metrics[fieldNumber - 3]);
+        } else if (fieldNumber == 7) {
+            QProtobufWireFormat::readField(fieldIt, colorTable);
+        } else {
+            return false;
+        }
+        return true;
+    });
+
+    if (format == QLatin1String(RawImageFormat)) {
+        value = QVariant::fromValue(rawImage(data, metrics[0], metrics[1], metrics[2], metrics[3], colorTable));
+    } else {
+        value = QVariant::fromValue(::QImage::fromData(data, format.toLatin1().constData()));
+    }
+}
+
+//Compact codecs write only fields added for QtTypesEncoding::Compact, deserializeDirect reads both forms
+void serializeCompactUuid(const QVariant &value, int fieldNumber, QByteArray &buffer) {
+    const QByteArray rfc4122 = value.value<::QUuid>().toRfc4122();
+    const int sizePosition = QProtobufWireFormat::beginLengthDelimited(buffer, fieldNumber);
+    QProtobufWireFormat::writeField(buffer, 2, rfc4122);
+    QProtobufWireFormat::endLengthDelimited(buffer, sizePosition);
+}
+
+int compactUuidSize(const QVariant &/*value*/, int fieldNumber) {
+    return QProtobufWireFormat::lengthDelimitedSize(fieldNumber, QProtobufWireFormat::lengthDelimitedSize(2, 16));
+}
+
+void serializeCompactChar(const QVariant &value, int fieldNumber, QByteArray &buffer) {
+    const uint32 code = value.value<::QChar>().unicode();
+    const int sizePosition = QProtobufWireFormat::beginLengthDelimited(buffer, fieldNumber);
+    QProtobufWireFormat::writeField(buffer, 2, code);
+    QProtobufWireFormat::endLengthDelimited(buffer, sizePosition);
+}
+
+int compactCharSize(const QVariant &value, int fieldNumber) {
+    const uint32 code = value.value<::QChar>().unicode();
+    return QProtobufWireFormat::lengthDelimitedSize(fieldNumber, QProtobufWireFormat::fieldSize(2, code));
+}
+
+sint32List polygonCoordinates(const ::QPolygon &polygon) {
+    sint32List coordinates;
+    coordinates.reserve(polygon.size() * 2);
+    for (const ::QPoint &point : polygon) {
+        coordinates.append(point.x());
+        coordinates.append(point.y());
+    }
+    return coordinates;
+}
+
+void serializeCompactPolygon(const QVariant &value, int fieldNumber, QByteArray &buffer) {
+    const int sizePosition = QProtobufWireFormat::beginLengthDelimited(buffer, fieldNumber);
+    QProtobufWireFormat::writeField(buffer, 2, polygonCoordinates(*static_cast<const ::QPolygon *>(value.constData())));
+    QProtobufWireFormat::endLengthDelimited(buffer, sizePosition);
+}
+
+int compactPolygonSize(const QVariant &value, int fieldNumber) {
+    return QProtobufWireFormat::lengthDelimitedSize(fieldNumber,
+                                                    QProtobufWireFormat::fieldSize(2, polygonCoordinates(*static_cast<const ::QPolygon *>(value.constData()))));
+}
+
+void serializeCompactPolygonF(const QVariant &value, int fieldNumber, QByteArray &buffer) {
+    const int sizePosition = QProtobufWireFormat::beginLengthDelimited(buffer, fieldNumber);
+    writePackedCoordinates(buffer, *static_cast<const ::QPolygonF *>(value.constData()));
+    QProtobufWireFormat::endLengthDelimited(buffer, sizePosition);
+}
+
+int compactPolygonFSize(const QVariant &value, int fieldNumber) {
+    return QProtobufWireFormat::lengthDelimitedSize(fieldNumber, packedCoordinatesSize(*static_cast<const ::QPolygonF *>(value.constData())));
+}
+
 }
 
 template <typename QType, typename PType>
-void registerQtTypeHandler() {
+void registerQtTypeHandler(QtProtobufPrivate::WireSerializer wireSerializer = nullptr,
+                           QtProtobufPrivate::WireDeserializer wireDeserializer = nullptr,
+                           QtProtobufPrivate::WireSizer wireSizer = nullptr) {
     QtProtobufPrivate::registerHandler(qMetaTypeId<QType>(), {
                                            [](const QtProtobuf::QAbstractProtobufSerializer *serializer, const QVariant &value, const QtProtobuf::QProtobufMetaProperty &property, QByteArray &buffer) {
                                                PType object(convert(value.value<QType>()));
@@ -286,34 +1053,74 @@ void registerQtTypeHandler() {
                                                PType object;
                                                serializer->deserializeObject(&object, PType::protobufMetaObject, it);
                                                value = QVariant::fromValue<QType>(convert(object));
-                                           }, QtProtobufPrivate::ObjectHandler });
+                                           }, QtProtobufPrivate::ObjectHandler, nullptr, nullptr, 0, nullptr,
+                                           wireSerializer, wireDeserializer, wireSizer, nullptr });
 }
 
-void qRegisterProtobufQtTypes() {
+//Binary serializer uses direct wire codecs, other serializers receive value converted to generated message
+template <typename QType, typename PType>
+void registerDirectQtTypeHandler() {
+    registerQtTypeHandler<QType, PType>(serializeDirect<QType>, deserializeDirect<QType>, directSize<QType>);
+}
+
+namespace {
+
+//Size of compressed image is known only after encoding, so encoded images are not sized in advance
+void registerImageHandler() {
+    if (imageEncodingSettings().encoding == QtImageEncoding::Raw) {
+        registerQtTypeHandler<::QImage, ::QtProtobuf::QImage>(serializeRawImage, deserializeImage, rawImageSize);
+    } else {
+        registerQtTypeHandler<::QImage, ::QtProtobuf::QImage>(serializeEncodedImage, deserializeImage);
+    }
+}
+
+}
+
+void qSetProtobufImageEncoding(QtImageEncoding encoding, int quality) {
+    ImageEncodingSettings &settings = imageEncodingSettings();
+    settings.encoding = encoding;
+    settings.quality = quality;
+    registerImageHandler();
+}
+
+void qRegisterProtobufQtTypes(QtTypesEncoding encoding) {
+    //Handlers are the same for repeated calls with the same encoding, so only first call registers them
+    static int registeredEncoding = -1;
+    if (registeredEncoding == static_cast<int>(encoding)) {
+        return;
+    }
+    registeredEncoding = static_cast<int>(encoding);
+
     registerQtTypeHandler<::QUrl, ::QtProtobuf::QUrl>();
-    registerQtTypeHandler<::QChar, ::QtProtobuf::QChar>();
-    registerQtTypeHandler<::QUuid, ::QtProtobuf::QUuid>();
-    registerQtTypeHandler<::QTime, ::QtProtobuf::QTime>();
-    registerQtTypeHandler<::QDate, ::QtProtobuf::QDate>();
-    registerQtTypeHandler<::QDateTime, ::QtProtobuf::QDateTime>();
-    registerQtTypeHandler<::QDateTime, ::QtProtobuf::QDateTime>();
-    registerQtTypeHandler<::QSize, ::QtProtobuf::QSize>();
-    registerQtTypeHandler<::QSizeF, ::QtProtobuf::QSizeF>();
-    registerQtTypeHandler<::QPoint, ::QtProtobuf::QPoint>();
-    registerQtTypeHandler<::QPointF, ::QtProtobuf::QPointF>();
-    registerQtTypeHandler<::QRect, ::QtProtobuf::QRect>();
-    registerQtTypeHandler<::QRectF, ::QtProtobuf::QRectF>();
-    registerQtTypeHandler<::QPolygon, ::QtProtobuf::QPolygon>();
-    registerQtTypeHandler<::QPolygonF, ::QtProtobuf::QPolygonF>();
-
-    registerQtTypeHandler<::QColor, ::QtProtobuf::QColor>();
-    registerQtTypeHandler<::QMatrix4x4, ::QtProtobuf::QMatrix4x4>();
-    registerQtTypeHandler<::QVector2D, ::QtProtobuf::QVector2D>();
-    registerQtTypeHandler<::QVector3D, ::QtProtobuf::QVector3D>();
-    registerQtTypeHandler<::QVector4D, ::QtProtobuf::QVector4D>();
-    registerQtTypeHandler<::QTransform, ::QtProtobuf::QTransform>();
-    registerQtTypeHandler<::QQuaternion, ::QtProtobuf::QQuaternion>();
-    registerQtTypeHandler<::QImage, ::QtProtobuf::QImage>();
+    if (encoding == QtTypesEncoding::Compact) {
+        registerQtTypeHandler<::QChar, ::QtProtobuf::QChar>(serializeCompactChar, deserializeDirect<::QChar>, compactCharSize);
+        registerQtTypeHandler<::QUuid, ::QtProtobuf::QUuid>(serializeCompactUuid, deserializeDirect<::QUuid>, compactUuidSize);
+        registerQtTypeHandler<::QPolygon, ::QtProtobuf::QPolygon>(serializeCompactPolygon, deserializeDirect<::QPolygon>, compactPolygonSize);
+        registerQtTypeHandler<::QPolygonF, ::QtProtobuf::QPolygonF>(serializeCompactPolygonF, deserializeDirect<::QPolygonF>, compactPolygonFSize);
+    } else {
+        registerDirectQtTypeHandler<::QChar, ::QtProtobuf::QChar>();
+        registerDirectQtTypeHandler<::QUuid, ::QtProtobuf::QUuid>();
+        registerDirectQtTypeHandler<::QPolygon, ::QtProtobuf::QPolygon>();
+        registerDirectQtTypeHandler<::QPolygonF, ::QtProtobuf::QPolygonF>();
+    }
+    registerDirectQtTypeHandler<::QTime, ::QtProtobuf::QTime>();
+    registerDirectQtTypeHandler<::QDate, ::QtProtobuf::QDate>();
+    registerDirectQtTypeHandler<::QDateTime, ::QtProtobuf::QDateTime>();
+    registerDirectQtTypeHandler<::QSize, ::QtProtobuf::QSize>();
+    registerDirectQtTypeHandler<::QSizeF, ::QtProtobuf::QSizeF>();
+    registerDirectQtTypeHandler<::QPoint, ::QtProtobuf::QPoint>();
+    registerDirectQtTypeHandler<::QPointF, ::QtProtobuf::QPointF>();
+    registerDirectQtTypeHandler<::QRect, ::QtProtobuf::QRect>();
+    registerDirectQtTypeHandler<::QRectF, ::QtProtobuf::QRectF>();
+
+    registerDirectQtTypeHandler<::QColor, ::QtProtobuf::QColor>();
+    registerDirectQtTypeHandler<::QMatrix4x4, ::QtProtobuf::QMatrix4x4>();
+    registerDirectQtTypeHandler<::QVector2D, ::QtProtobuf::QVector2D>();
+    registerDirectQtTypeHandler<::QVector3D, ::QtProtobuf::QVector3D>();
+    registerDirectQtTypeHandler<::QVector4D, ::QtProtobuf::QVector4D>();
+    registerDirectQtTypeHandler<::QTransform, ::QtProtobuf::QTransform>();
+    registerDirectQtTypeHandler<::QQuaternion, ::QtProtobuf::QQuaternion>();
+    registerImageHandler();
 }
 
 }
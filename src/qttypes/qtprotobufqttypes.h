@@ -82,6 +82,13 @@
  * ...
  * \endcode
  *
+ * By default QUuid is sent as string, QChar as bytes produced by QDataStream and polygons as repeated point messages.
+ * Pass QtProtobuf::QtTypesEncoding::Compact to registration method to send QUuid as 16 bytes in RFC 4122 order, QChar as varint code unit
+ * and QPolygon/QPolygonF as packed arrays of interleaved coordinates. Messages in both encodings are accepted on deserialization.
+ *
+ * QImage is sent in PNG format by default. Use QtProtobuf::qSetProtobufImageEncoding() to send JPEG images or uncompressed pixel buffer,
+ * e.g. for video frames where compression takes most of serialization time.
+ *
  * All supported message are described in special .proto files:
  *
  * - QtCore.proto - contains description of Qt types from QtCore module
@@ -119,9 +126,34 @@
  */
 
 namespace QtProtobuf {
+/*!
+ * \brief The QtTypesEncoding enum selects binary encoding of Qt types that have compact form in QtCore.proto
+ */
+enum class QtTypesEncoding {
+    Standard, //!< QUuid is written as string, QChar as big-endian bytes, polygons as repeated point messages
+    Compact //!< QUuid is written as 16 bytes in RFC 4122 order, QChar as varint code unit, polygons as packed coordinates
+};
+
 /*!
  * \brief qRegisterProtobufQtTypes registers serializers set for Qt types supported by QtProtobufQtTypes
+ * \param encoding binary encoding used to serialize QUuid, QChar, QPolygon and QPolygonF
  * \note Call it before any serialization\deserialization of messages that use QtProtobufQtTypes directly on indirectly
  */
-Q_PROTOBUF_QT_TYPES_EXPORT void qRegisterProtobufQtTypes();
+Q_PROTOBUF_QT_TYPES_EXPORT void qRegisterProtobufQtTypes(QtTypesEncoding encoding = QtTypesEncoding::Standard);
+
+/*!
+ * \brief The QtImageEncoding enum selects how QImage is sent
+ */
+enum class QtImageEncoding {
+    Png, //!< Lossless compressed image, default
+    Jpeg, //!< Lossy compressed image, alpha channel is not preserved
+    Raw //!< Uncompressed pixel buffer with size, stride and pixel format, received image uses deserialized buffer without copying
+};
+
+/*!
+ * \brief qSetProtobufImageEncoding sets \a encoding used to serialize QImage fields
+ * \param quality compression quality in range 0..100 passed to QImage::save(), -1 selects default quality
+ * \note Encoding is global for all QImage fields, images in any encoding are accepted on deserialization
+ */
+Q_PROTOBUF_QT_TYPES_EXPORT void qSetProtobufImageEncoding(QtImageEncoding encoding, int quality = -1);
 }
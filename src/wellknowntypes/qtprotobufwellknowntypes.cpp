@@ -0,0 +1,280 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of qtprotobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qtprotobufwellknowntypes.h"
+
+#include <QProtobufWireFormat>
+
+#include "qabstractprotobufserializer.h"
+#include "qabstractprotobufserializer_p.h"
+
+#include "google/protobuf/timestamp.qpb.h"
+#include "google/protobuf/duration.qpb.h"
+#include "google/protobuf/wrappers.qpb.h"
+
+namespace QtProtobuf {
+
+namespace {
+
+const qint64 NanosPerSecond = 1000000000;
+const qint64 NanosPerMSec = 1000000;
+const qint64 MSecsPerSecond = 1000;
+
+//Timestamp nanos are always positive, so seconds are rounded down for time points before epoch
+void splitTimestamp(const QDateTime &value, int64 &seconds, int32 &nanos) {
+    const qint64 msecs = value.toMSecsSinceEpoch();
+    qint64 wholeSeconds = msecs / MSecsPerSecond;
+    qint64 remainder = msecs % MSecsPerSecond;
+    if (remainder < 0) {
+        --wholeSeconds;
+        remainder += MSecsPerSecond;
+    }
+    seconds = wholeSeconds;
+    nanos = static_cast<int32_t>(remainder * NanosPerMSec);
+}
+
+QDateTime joinTimestamp(int64 seconds, int32 nanos) {
+    return QDateTime::fromMSecsSinceEpoch(seconds * MSecsPerSecond + nanos / NanosPerMSec, Qt::UTC);
+}
+
+//Duration seconds and nanos have the same sign
+void splitDuration(std::chrono::nanoseconds value, int64 &seconds, int32 &nanos) {
+    seconds = value.count() / NanosPerSecond;
+    nanos = static_cast<int32_t>(value.count() % NanosPerSecond);
+}
+
+std::chrono::nanoseconds joinDuration(int64 seconds, int32 nanos) {
+    return std::chrono::nanoseconds(seconds * NanosPerSecond + nanos);
+}
+
+void serializeTimestamp(const QVariant &value, int fieldNumber, QByteArray &buffer) {
+    const QDateTime &dateTime = *static_cast<const QDateTime *>(value.constData());
+    if (!dateTime.isValid()) {
+        return;
+    }
+    int64 seconds;
+    int32 nanos;
+    splitTimestamp(dateTime, seconds, nanos);
+    const int sizePosition = QProtobufWireFormat::beginLengthDelimited(buffer, fieldNumber);
+    QProtobufWireFormat::writeField(buffer, 1, seconds);
+    QProtobufWireFormat::writeField(buffer, 2, nanos);
+    QProtobufWireFormat::endLengthDelimited(buffer, sizePosition);
+}
+
+int timestampSize(const QVariant &value, int fieldNumber) {
+    const QDateTime &dateTime = *static_cast<const QDateTime *>(value.constData());
+    if (!dateTime.isValid()) {
+        return 0;
+    }
+    int64 seconds;
+    int32 nanos;
+    splitTimestamp(dateTime, seconds, nanos);
+    return QProtobufWireFormat::lengthDelimitedSize(fieldNumber, QProtobufWireFormat::fieldSize(1, seconds)
+                                                    + QProtobufWireFormat::fieldSize(2, nanos));
+}
+
+//Received fields are merged to the previous value, same as for messages
+void deserializeTimestamp(QProtobufSelfcheckIterator &it, QVariant &value) {
+    int64 seconds = 0;
+    int32 nanos = 0;
+    const QDateTime previous = value.value<QDateTime>();
+    if (previous.isValid()) {
+        splitTimestamp(previous, seconds, nanos);
+    }
+    QProtobufWireFormat::readMessageFields(it, [&seconds, &nanos](QProtobufSelfcheckIterator &fieldIt, int fieldNumber) {
+        if (fieldNumber == 1) {
+            QProtobufWireFormat::readField(fieldIt, seconds);
+        } else if (fieldNumber == 2) {
+            QProtobufWireFormat::readField(fieldIt, nanos);
+        } else {
+            return false;
+        }
+        return true;
+    });
+    value = QVariant::fromValue(joinTimestamp(seconds, nanos));
+}
+
+void serializeDuration(const QVariant &value, int fieldNumber, QByteArray &buffer) {
+    const auto &duration = *static_cast<const std::chrono::nanoseconds *>(value.constData());
+    if (duration.count() == 0) {
+        return;
+    }
+    int64 seconds;
+    int32 nanos;
+    splitDuration(duration, seconds, nanos);
+    const int sizePosition = QProtobufWireFormat::beginLengthDelimited(buffer, fieldNumber);
+    QProtobufWireFormat::writeField(buffer, 1, seconds);
+    QProtobufWireFormat::writeField(buffer, 2, nanos);
+    QProtobufWireFormat::endLengthDelimited(buffer, sizePosition);
+}
+
+int durationSize(const QVariant &value, int fieldNumber) {
+    const auto &duration = *static_cast<const std::chrono::nanoseconds *>(value.constData());
+    if (duration.count() == 0) {
+        return 0;
+    }
+    int64 seconds;
+    int32 nanos;
+    splitDuration(duration, seconds, nanos);
+    return QProtobufWireFormat::lengthDelimitedSize(fieldNumber, QProtobufWireFormat::fieldSize(1, seconds)
+                                                    + QProtobufWireFormat::fieldSize(2, nanos));
+}
+
+void deserializeDuration(QProtobufSelfcheckIterator &it, QVariant &value) {
+    int64 seconds;
+    int32 nanos;
+    splitDuration(value.value<std::chrono::nanoseconds>(), seconds, nanos);
+    QProtobufWireFormat::readMessageFields(it, [&seconds, &nanos](QProtobufSelfcheckIterator &fieldIt, int fieldNumber) {
+        if (fieldNumber == 1) {
+            QProtobufWireFormat::readField(fieldIt, seconds);
+        } else if (fieldNumber == 2) {
+            QProtobufWireFormat::readField(fieldIt, nanos);
+        } else {
+            return false;
+        }
+        return true;
+    });
+    value = QVariant::fromValue(joinDuration(seconds, nanos));
+}
+
+template<typename T>
+void serializeOptional(const QVariant &value, int fieldNumber, QByteArray &buffer) {
+    const auto &optional = *static_cast<const QProtobufOptional<T> *>(value.constData());
+    if (!optional.hasValue()) {
+        return;
+    }
+    const int sizePosition = QProtobufWireFormat::beginLengthDelimited(buffer, fieldNumber);
+    QProtobufWireFormat::writeField(buffer, 1, optional.value());
+    QProtobufWireFormat::endLengthDelimited(buffer, sizePosition);
+}
+
+template<typename T>
+int optionalSize(const QVariant &value, int fieldNumber) {
+    const auto &optional = *static_cast<const QProtobufOptional<T> *>(value.constData());
+    if (!optional.hasValue()) {
+        return 0;
+    }
+    return QProtobufWireFormat::lengthDelimitedSize(fieldNumber, QProtobufWireFormat::fieldSize(1, optional.value()));
+}
+
+template<typename T>
+void deserializeOptional(QProtobufSelfcheckIterator &it, QVariant &value) {
+    T result = value.value<QProtobufOptional<T>>().value();
+    QProtobufWireFormat::readMessageFields(it, [&result](QProtobufSelfcheckIterator &fieldIt, int fieldNumber) {
+        if (fieldNumber != 1) {
+            return false;
+        }
+        QProtobufWireFormat::readField(fieldIt, result);
+        return true;
+    });
+    value = QVariant::fromValue(QProtobufOptional<T>(result));
+}
+
+//Unset values are converted to empty messages
+void convert(const QDateTime &from, google::protobuf::Timestamp &to) {
+    if (!from.isValid()) {
+        return;
+    }
+    int64 seconds;
+    int32 nanos;
+    splitTimestamp(from, seconds, nanos);
+    to.setSeconds(seconds);
+    to.setNanos(nanos);
+}
+
+void convert(const google::protobuf::Timestamp &from, QDateTime &to) {
+    to = joinTimestamp(from.seconds(), from.nanos());
+}
+
+void convert(const std::chrono::nanoseconds &from, google::protobuf::Duration &to) {
+    int64 seconds;
+    int32 nanos;
+    splitDuration(from, seconds, nanos);
+    to.setSeconds(seconds);
+    to.setNanos(nanos);
+}
+
+void convert(const google::protobuf::Duration &from, std::chrono::nanoseconds &to) {
+    to = joinDuration(from.seconds(), from.nanos());
+}
+
+template<typename T, typename PType>
+void convert(const QProtobufOptional<T> &from, PType &to) {
+    if (from.hasValue()) {
+        to.setValue(from.value());
+    }
+}
+
+template<typename T, typename PType>
+void convert(const PType &from, QProtobufOptional<T> &to) {
+    to = QProtobufOptional<T>(from.value());
+}
+
+//Serializers that are not able to use wire format handlers, e.g. json serializer, get value converted to generated message
+template<typename NativeType, typename PType,
+         QtProtobufPrivate::WireSerializer wireSerializer,
+         QtProtobufPrivate::WireDeserializer wireDeserializer,
+         QtProtobufPrivate::WireSizer wireSizer>
+void registerWellKnownTypeHandler() {
+    qRegisterMetaType<NativeType>();
+    QtProtobufPrivate::registerHandler(qMetaTypeId<NativeType>(), {
+                                           [](const QtProtobuf::QAbstractProtobufSerializer *serializer, const QVariant &value, const QtProtobuf::QProtobufMetaProperty &property, QByteArray &buffer) {
+                                               PType object;
+                                               convert(value.value<NativeType>(), object);
+                                               buffer.append(serializer->serializeObject(&object, PType::protobufMetaObject, property));
+                                           },
+                                           [](const QtProtobuf::QAbstractProtobufSerializer *serializer, QtProtobuf::QProtobufSelfcheckIterator &it, QVariant &value) {
+                                               PType object;
+                                               serializer->deserializeObject(&object, PType::protobufMetaObject, it);
+                                               NativeType nativeValue;
+                                               convert(object, nativeValue);
+                                               value = QVariant::fromValue<NativeType>(nativeValue);
+                                           }, QtProtobufPrivate::ObjectHandler, nullptr, &PType::protobufMetaObject, 0, nullptr,
+                                           wireSerializer, wireDeserializer, wireSizer, nullptr });
+}
+
+template<typename T, typename PType>
+void registerOptionalHandler() {
+    registerWellKnownTypeHandler<QProtobufOptional<T>, PType, serializeOptional<T>, deserializeOptional<T>, optionalSize<T>>();
+}
+
+}
+
+void qRegisterProtobufWellKnownTypes() {
+    registerWellKnownTypeHandler<QDateTime, google::protobuf::Timestamp, serializeTimestamp, deserializeTimestamp, timestampSize>();
+    registerWellKnownTypeHandler<std::chrono::nanoseconds, google::protobuf::Duration, serializeDuration, deserializeDuration, durationSize>();
+
+    registerOptionalHandler<double, google::protobuf::DoubleValue>();
+    registerOptionalHandler<float, google::protobuf::FloatValue>();
+    registerOptionalHandler<int64, google::protobuf::Int64Value>();
+    registerOptionalHandler<uint64, google::protobuf::UInt64Value>();
+    registerOptionalHandler<int32, google::protobuf::Int32Value>();
+    registerOptionalHandler<uint32, google::protobuf::UInt32Value>();
+    registerOptionalHandler<bool, google::protobuf::BoolValue>();
+    registerOptionalHandler<QString, google::protobuf::StringValue>();
+    registerOptionalHandler<QByteArray, google::protobuf::BytesValue>();
+}
+
+}
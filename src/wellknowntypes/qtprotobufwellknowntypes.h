@@ -0,0 +1,192 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of qtprotobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QtProtobufWellKnownTypes
+
+#include <QMetaType>
+#include <QString>
+#include <QByteArray>
+#include <QDateTime>
+
+#include <chrono>
+
+#include <qtprotobuftypes.h>
+#include <qtprotobufwellknowntypesglobal.h>
+
+/*!
+ * \defgroup QtProtobufWellKnownTypes
+ * \brief Google Protobuf Well-Known types library for QtProtobuf
+ *
+ * \details QtProtobufWellKnownTypes contains follwing <a href="https://developers.google.com/protocol-buffers/docs/reference/google.protobuf">Protobuf Well-Known types</a>:
+ *    - Any
+ *    - Timestamp
+ *    - Struct
+ *    - Value
+ *    - ListValue
+ *    - SourceContext
+ *    - DoubleValue
+ *    - FloatValue
+ *    - Int64Value
+ *    - UInt64Value
+ *    - Int32Value
+ *    - UInt32Value
+ *    - BoolValue
+ *    - StringValue
+ *    - BytesValue
+ *    - Type
+ *    - Field
+ *    - Enum
+ *    - EnumValue
+ *    - Option
+ *    - Empty
+ *    - FieldMask
+ *    - Api
+ *    - Method
+ *    - Mixin
+ *    - Duration
+ *
+ *
+ * To use well-known type in your project you may include corresponding google .proto file in your interface:
+ *
+ * \code
+ * syntax = "proto3";
+ * package somepackage;
+ *
+ * import "google/protobuf/empty.proto";
+ * import "google/protobuf/timestamp.proto";
+ *
+ * message AnimationMessage {
+ *     uint32 animationId = 1;
+ *     google.protobuf.Timestamp startTime = 2;
+ *     google.protobuf.Timestamp endTime = 3;
+ * }
+ *
+ * service AnimationService {
+ *     rpc startAnimation(AnimationMessage) returns (google.protobuf.Empty) {}
+ * }
+ * \endcode
+ *
+ * It's also possible to use some of generated well-known types directly, simply include corresponding header:
+ *
+ * \code
+ * #include <google/protobuf/any.qpb.h>
+ * ...
+ *     google::protobuf::Any someAnyVariable;
+ *     someAnyVariable.setType_url("http://somedomain.org/someTypeDescription");
+ *     someAnyVariable.setValue(data);
+ * ...
+ * \endcode
+ *
+ * In both scenarious you also need to link QtProtobuf WellKnownTypes library by adding following lines to
+ * **CMakeLists.txt** for your target.
+ * \code
+ *     target_link_libraries(YourTargetName PRIVATE QtProtobuf::ProtobufWellKnownTypes)
+ * \endcode
+ *
+ * \subsubsection nativewellknowntypes Native well-known types
+ *
+ * Messages generated with NATIVE_WELLKNOWN option use native types for singular fields of following well-known types:
+ *    - Timestamp as QDateTime. Invalid QDateTime is not serialized. Timestamp precision is limited by QDateTime to milliseconds.
+ *    - Duration as std::chrono::nanoseconds. Zero duration is not serialized.
+ *    - DoubleValue, FloatValue, Int64Value, UInt64Value, Int32Value, UInt32Value, BoolValue, StringValue and BytesValue as
+ *      QtProtobuf::QProtobufOptional of corresponding scalar type, e.g. QtProtobuf::Int32Optional.
+ *
+ * Values of such fields are encoded and decoded directly, without intermediate message objects. Repeated fields and maps
+ * keep using generated messages. Native types serializers are registered by explicit call:
+ * \code
+ * ... //E.g. somewhere in main.cpp
+ * QtProtobuf::qRegisterProtobufWellKnownTypes();
+ * ...
+ * \endcode
+ *
+ * \note QtProtobufQtTypes library registers own serializer for QDateTime, serializer that is registered last is used for all
+ *       QDateTime fields. Avoid mixing of QtProtobuf.QDateTime and native Timestamp fields in one application.
+ */
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobufWellKnownTypes
+ * \brief The QProtobufOptional class holds value of well-known wrapper type field, that may be unset
+ *
+ * \details Default constructed QProtobufOptional has no value and is not serialized. Value equal to default value
+ *          of type T is serialized, unlike scalar fields.
+ */
+template<typename T>
+class QProtobufOptional
+{
+public:
+    QProtobufOptional() : m_value{}, m_hasValue(false) {}
+    QProtobufOptional(const T &value) : m_value(value), m_hasValue(true) {}
+
+    bool hasValue() const { return m_hasValue; }
+    const T &value() const { return m_value; }
+    T valueOr(const T &defaultValue) const { return m_hasValue ? m_value : defaultValue; }
+
+    void reset() {
+        m_value = T{};
+        m_hasValue = false;
+    }
+
+    bool operator ==(const QProtobufOptional &other) const {
+        return m_hasValue == other.m_hasValue && (!m_hasValue || m_value == other.m_value);
+    }
+
+    bool operator !=(const QProtobufOptional &other) const {
+        return !(*this == other);
+    }
+
+private:
+    T m_value;
+    bool m_hasValue;
+};
+
+using DoubleOptional = QProtobufOptional<double>;
+using FloatOptional = QProtobufOptional<float>;
+using Int64Optional = QProtobufOptional<int64>;
+using UInt64Optional = QProtobufOptional<uint64>;
+using Int32Optional = QProtobufOptional<int32>;
+using UInt32Optional = QProtobufOptional<uint32>;
+using BoolOptional = QProtobufOptional<bool>;
+using StringOptional = QProtobufOptional<QString>;
+using BytesOptional = QProtobufOptional<QByteArray>;
+
+/*!
+ * \brief qRegisterProtobufWellKnownTypes registers serializers of native types used for well-known types
+ * \note Call it before any serialization\deserialization of messages generated with NATIVE_WELLKNOWN option
+ */
+Q_PROTOBUF_WELLKNOWN_TYPES_EXPORT void qRegisterProtobufWellKnownTypes();
+}
+
+Q_DECLARE_METATYPE(std::chrono::nanoseconds)
+Q_DECLARE_METATYPE(QtProtobuf::DoubleOptional)
+Q_DECLARE_METATYPE(QtProtobuf::FloatOptional)
+Q_DECLARE_METATYPE(QtProtobuf::Int64Optional)
+Q_DECLARE_METATYPE(QtProtobuf::UInt64Optional)
+Q_DECLARE_METATYPE(QtProtobuf::Int32Optional)
+Q_DECLARE_METATYPE(QtProtobuf::UInt32Optional)
+Q_DECLARE_METATYPE(QtProtobuf::BoolOptional)
+Q_DECLARE_METATYPE(QtProtobuf::StringOptional)
+Q_DECLARE_METATYPE(QtProtobuf::BytesOptional)
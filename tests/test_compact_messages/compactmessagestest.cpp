@@ -0,0 +1,127 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "compactmessages.qpb.h"
+
+#include <QProtobufSerializer>
+#include <QSignalSpy>
+
+#include <gtest/gtest.h>
+
+using namespace qtprotobufnamespace::compactmessages::tests;
+
+namespace QtProtobuf {
+namespace tests {
+
+class CompactMessagesTest : public ::testing::Test
+{
+public:
+    CompactMessagesTest() = default;
+    void SetUp() override;
+    static void SetUpTestCase();
+protected:
+    std::unique_ptr<QProtobufSerializer> serializer;
+};
+
+void CompactMessagesTest::SetUpTestCase()
+{
+    QtProtobuf::qRegisterProtobufTypes();
+}
+
+void CompactMessagesTest::SetUp()
+{
+    serializer.reset(new QProtobufSerializer);
+}
+
+static void fillShape(Shape &shape)
+{
+    shape.setName("triangle");
+    shape.setColor(Shape::GREEN);
+    shape.setWeights({1, -2, 3});
+    shape.setTags({{"sides", 3}});
+    shape.setOrigin(Point(1, -1));
+    shape.setPoints({QSharedPointer<Point>(new Point(0, 0)), QSharedPointer<Point>(new Point(2, 0))});
+}
+
+TEST_F(CompactMessagesTest, AssignmentTest)
+{
+    Shape source;
+    fillShape(source);
+
+    Shape target;
+    QSignalSpy nameSpy(&target, &Shape::nameChanged);
+    QSignalSpy originSpy(&target, &Shape::originChanged);
+    target = source;
+    ASSERT_TRUE(target == source);
+    ASSERT_EQ(1, nameSpy.count());
+    ASSERT_EQ(1, originSpy.count());
+
+    //Nested message is copied, not shared
+    source.setOrigin(Point(5, -1));
+    ASSERT_EQ(1, target.origin().x());
+
+    //Unchanged fields don't emit signals
+    target = source;
+    ASSERT_EQ(1, nameSpy.count());
+    ASSERT_EQ(2, originSpy.count());
+    ASSERT_TRUE(target.serialize(serializer.get()) == source.serialize(serializer.get()));
+}
+
+TEST_F(CompactMessagesTest, ClearTest)
+{
+    Shape test;
+    fillShape(test);
+    test.clear();
+    ASSERT_TRUE(test == Shape());
+    ASSERT_TRUE(test.serialize(serializer.get()).isEmpty());
+}
+
+TEST_F(CompactMessagesTest, MergeFieldsTest)
+{
+    Shape source;
+    fillShape(source);
+
+    Shape target;
+    target.setName("square");
+    target.mergeFields(source, {2, 5});
+    ASSERT_EQ(QString("square"), target.name());
+    ASSERT_EQ(Shape::GREEN, target.color());
+    ASSERT_TRUE(target.origin() == Point(1, -1));
+    ASSERT_TRUE(target.weights().isEmpty());
+    ASSERT_TRUE(target.points().isEmpty());
+}
+
+TEST_F(CompactMessagesTest, SerializationTest)
+{
+    Shape test;
+    fillShape(test);
+
+    Shape deserialized;
+    deserialized.deserialize(serializer.get(), test.serialize(serializer.get()));
+    ASSERT_TRUE(deserialized == test);
+}
+
+} // tests
+} // QtProtobuf
@@ -0,0 +1,216 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "directserialization.qpb.h"
+
+#include <QProtobufSerializer>
+#include <QProtobufWireFormat>
+
+#include <gtest/gtest.h>
+
+using namespace qtprotobufnamespace::directserialization::tests;
+
+namespace QtProtobuf {
+namespace tests {
+
+class DirectSerializationTest : public ::testing::Test
+{
+public:
+    DirectSerializationTest() = default;
+    void SetUp() override;
+    static void SetUpTestCase();
+protected:
+    std::unique_ptr<QProtobufSerializer> serializer;
+};
+
+void DirectSerializationTest::SetUpTestCase()
+{
+    QtProtobuf::qRegisterProtobufTypes();
+}
+
+void DirectSerializationTest::SetUp()
+{
+    serializer.reset(new QProtobufSerializer);
+}
+
+TEST_F(DirectSerializationTest, GeneratedSerializersTest)
+{
+    ASSERT_TRUE(EmptyMessage::protobufMetaObject.directSerializer != nullptr);
+    ASSERT_TRUE(EmptyMessage::protobufMetaObject.directDeserializer != nullptr);
+    ASSERT_TRUE(ScalarMessage::protobufMetaObject.directSerializer != nullptr);
+    ASSERT_TRUE(ScalarMessage::protobufMetaObject.directDeserializer != nullptr);
+    ASSERT_TRUE(RepeatedMessage::protobufMetaObject.directSerializer != nullptr);
+    ASSERT_TRUE(RepeatedMessage::protobufMetaObject.directDeserializer != nullptr);
+
+    //Messages with message fields use meta-object system based serialization
+    ASSERT_TRUE(NestedMessage::protobufMetaObject.directSerializer == nullptr);
+    ASSERT_TRUE(NestedMessage::protobufMetaObject.directDeserializer == nullptr);
+}
+
+TEST_F(DirectSerializationTest, ScalarMessageSerializeTest)
+{
+    ScalarMessage test;
+    QByteArray result = test.serialize(serializer.get());
+    ASSERT_TRUE(result.isEmpty());
+
+    test.setTestFieldInt(15);
+    test.setTestFieldSInt(-1);
+    test.setTestFieldFixed(1);
+    test.setTestFieldDouble(0.5);
+    test.setTestFieldBool(true);
+    test.setTestFieldString("qwerty");
+    test.setTestFieldBytes(QByteArray::fromHex("0102"));
+    test.setTestFieldEnum(ScalarMessage::LOCAL_ENUM_VALUE2);
+
+    result = test.serialize(serializer.get());
+    ASSERT_STREQ(result.toHex().toStdString().c_str(),
+                 "080f10011d0100000021000000000000e03f280132067177657274793a0201024002");
+
+    QByteArray direct;
+    test.serializeTo(direct);
+    ASSERT_TRUE(direct == result);
+}
+
+TEST_F(DirectSerializationTest, EmptyStringAndBytesSerializeTest)
+{
+    ScalarMessage test;
+    test.setTestFieldInt(15);
+    test.setTestFieldString("");
+    test.setTestFieldBytes(QByteArray(""));
+
+    //Empty string and bytes are default values and are not sent
+    QByteArray direct;
+    test.serializeTo(direct);
+    ASSERT_STREQ(direct.toHex().toStdString().c_str(), "080f");
+    ASSERT_EQ(0, QtProtobuf::QProtobufWireFormat::fieldSize(6, QString("")));
+    ASSERT_EQ(0, QtProtobuf::QProtobufWireFormat::fieldSize(7, QByteArray("")));
+    ASSERT_TRUE(direct == test.serialize(serializer.get()));
+
+    test.setTestFieldString("qwerty");
+    test.setTestFieldString(QString(""));
+    direct.clear();
+    test.serializeTo(direct);
+    ASSERT_STREQ(direct.toHex().toStdString().c_str(), "080f");
+}
+
+TEST_F(DirectSerializationTest, ScalarMessageDeserializeTest)
+{
+    ScalarMessage test;
+    test.deserialize(serializer.get(), QByteArray::fromHex("080f10011d0100000021000000000000e03f280132067177657274793a0201024002"));
+    ASSERT_EQ(test.testFieldInt(), 15);
+    ASSERT_EQ(test.testFieldSInt(), -1);
+    ASSERT_EQ(test.testFieldFixed(), 1);
+    ASSERT_DOUBLE_EQ(test.testFieldDouble(), 0.5);
+    ASSERT_TRUE(test.testFieldBool());
+    ASSERT_STREQ(test.testFieldString().toStdString().c_str(), "qwerty");
+    ASSERT_TRUE(test.testFieldBytes() == QByteArray::fromHex("0102"));
+    ASSERT_EQ(test.testFieldEnum(), ScalarMessage::LOCAL_ENUM_VALUE2);
+}
+
+TEST_F(DirectSerializationTest, RepeatedMessageTest)
+{
+    RepeatedMessage test;
+    test.setTestRepeatedInt({1, 2, 300});
+    test.setTestRepeatedString({"a", "bc"});
+    QByteArray result = test.serialize(serializer.get());
+    ASSERT_STREQ(result.toHex().toStdString().c_str(), "0a040102ac0212016112026263");
+
+    RepeatedMessage deserialized;
+    deserialized.parseFrom(result);
+    ASSERT_TRUE(deserialized == test);
+}
+
+TEST_F(DirectSerializationTest, RepeatedMessageNonPackedTest)
+{
+    RepeatedMessage test;
+    test.parseFrom(QByteArray::fromHex("08010a0102120161"
+                                       "08ac02"));
+    ASSERT_TRUE(test.testRepeatedInt() == QtProtobuf::int32List({1, 2, 300}));
+    ASSERT_TRUE(test.testRepeatedString() == QStringList({"a"}));
+}
+
+TEST_F(DirectSerializationTest, UnknownFieldTest)
+{
+    ScalarMessage test;
+    test.deserialize(serializer.get(), QByteArray::fromHex("7801080f"));
+    ASSERT_EQ(test.testFieldInt(), 15);
+}
+
+TEST_F(DirectSerializationTest, NestedMessageTest)
+{
+    NestedMessage test;
+    test.setTestFieldScalar(ScalarMessage{15, 0, 0, 0.0, false, "", {}, ScalarMessage::LOCAL_ENUM_VALUE0});
+    QByteArray result = test.serialize(serializer.get());
+    ASSERT_STREQ(result.toHex().toStdString().c_str(), "0a02080f");
+
+    NestedMessage deserialized;
+    deserialized.deserialize(serializer.get(), result);
+    ASSERT_EQ(deserialized.testFieldScalar().testFieldInt(), 15);
+}
+
+TEST_F(DirectSerializationTest, SchemaFingerprintTest)
+{
+    ASSERT_NE(ScalarMessage::protobufMetaObject.schemaFingerprint, 0u);
+    ASSERT_NE(RepeatedMessage::protobufMetaObject.schemaFingerprint, 0u);
+    ASSERT_NE(ScalarMessage::protobufMetaObject.schemaFingerprint, RepeatedMessage::protobufMetaObject.schemaFingerprint);
+    ASSERT_TRUE(ScalarMessage::protobufMetaObject.orderedDeserializer != nullptr);
+    ASSERT_TRUE(RepeatedMessage::protobufMetaObject.orderedDeserializer != nullptr);
+
+    ASSERT_EQ(NestedMessage::protobufMetaObject.schemaFingerprint, 0u);
+    ASSERT_TRUE(NestedMessage::protobufMetaObject.orderedDeserializer == nullptr);
+}
+
+TEST_F(DirectSerializationTest, DeserializeFromPeerTest)
+{
+    const quint64 fingerprint = ScalarMessage::protobufMetaObject.schemaFingerprint;
+    const QByteArray ordered = QByteArray::fromHex("080f10011d0100000021000000000000e03f280132067177657274793a0201024002");
+    //String field moved to the end and unknown field in the middle are handled by generic parser
+    const QByteArray shuffled = QByteArray::fromHex("080f10011d0100000021000000000000e03f280178013a02010240023206717765727479");
+    for (const QByteArray &data : {ordered, shuffled}) {
+        ScalarMessage expected;
+        expected.deserialize(serializer.get(), data);
+
+        ScalarMessage test;
+        serializer->deserializeFromPeer(&test, data, fingerprint);
+        ASSERT_TRUE(test == expected);
+        ASSERT_EQ(test.testFieldInt(), 15);
+        ASSERT_STREQ(test.testFieldString().toStdString().c_str(), "qwerty");
+        ASSERT_EQ(test.testFieldEnum(), ScalarMessage::LOCAL_ENUM_VALUE2);
+    }
+
+    //Peer with different schema is parsed by generic parser
+    ScalarMessage test;
+    serializer->deserializeFromPeer(&test, ordered, fingerprint + 1);
+    ASSERT_STREQ(test.testFieldString().toStdString().c_str(), "qwerty");
+
+    RepeatedMessage repeated;
+    serializer->deserializeFromPeer(&repeated, QByteArray::fromHex("0a040102ac0212016112026263"),
+                                    RepeatedMessage::protobufMetaObject.schemaFingerprint);
+    ASSERT_TRUE(repeated.testRepeatedInt() == QtProtobuf::int32List({1, 2, 300}));
+    ASSERT_TRUE(repeated.testRepeatedString() == QStringList({"a", "bc"}));
+}
+
+} // tests
+} // QtProtobuf
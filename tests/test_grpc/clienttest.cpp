@@ -25,23 +25,52 @@
 
 #include "testservice_grpc.qpb.h"
 #include <QGrpcHttp2Channel>
+#include <QGrpcBalancingChannel>
+#include <QGrpcCachingChannel>
+#include <QGrpcInProcessChannel>
+#include <QGrpcWebChannel>
+#include <QGrpcMetrics>
+#include <QGrpcClientInterceptor>
+#include <QGrpcRetryInterceptor>
+#include <QGrpcConcurrencyLimiter>
+#include <QGrpcTracer>
+#include <QGrpcReconnectPolicy>
+#include <QGrpcCallBatch>
+#include <QGrpcUploadQueue>
+#include <QGrpcStreamMultiplexer>
 #ifdef QT_PROTOBUF_NATIVE_GRPC_CHANNEL
 #include <QGrpcChannel>
+#include <QGrpcServer>
 #endif
 #include <QGrpcCredentials>
+#include <QGrpcAsyncCallCredentials>
 #include <QGrpcInsecureCredentials>
 
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QFileInfo>
+#include <QDir>
 #include <QCryptographicHash>
 #include <QThread>
+#include <QMutex>
+#include <QHash>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QtEndian>
 
 #include <QCoreApplication>
 
+#include <atomic>
+#include <functional>
+#include <deque>
+#include <vector>
+
 #include <gtest/gtest.h>
 #include <gtest/gtest-param-test.h>
 
 #include <qprotobufserializer.h>
+#include "qprotobufserializerregistry_p.h"
 
 using namespace qtprotobufnamespace::tests;
 using namespace QtProtobuf;
@@ -57,6 +86,14 @@ public:
         return c;
     }
 
+    static TestServiceClient * createHttp2IoThreadClient() {
+        auto *c = new TestServiceClient();
+        auto channel = std::make_shared<QGrpcHttp2Channel>(ClientTest::m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials());
+        channel->setIoThreadEnabled(true);
+        c->attachChannel(channel);
+        return c;
+    }
+
 #ifdef QT_PROTOBUF_NATIVE_GRPC_CHANNEL
     static TestServiceClient * createGrpcSocketClient() {
         auto *c = new TestServiceClient();
@@ -91,6 +128,7 @@ const QString ClientTest::m_echoServerAddressNative("localhost:50051");
 const QString ClientTest::m_echoServerSocket("unix:///tmp/test.sock");
 createTestServiceClientFunc* ClientTest::clientCreators[]{
     ClientTest::createHttp2Client,
+    ClientTest::createHttp2IoThreadClient,
 #ifdef QT_PROTOBUF_NATIVE_GRPC_CHANNEL
     ClientTest::createGrpcHttpClient,
     ClientTest::createGrpcSocketClient,
@@ -159,6 +197,340 @@ TEST_P(ClientTest, StringEchoAsync2Test)
     testClient->deleteLater();
 }
 
+TEST_P(ClientTest, StringEchoAsyncCallbackTest)
+{
+    auto testClient = (*GetParam())();
+    SimpleStringMessage result;
+    SimpleStringMessage request;
+    request.setTestFieldString("Hello beach!");
+    QGrpcStatus status{QGrpcStatus::Unknown};
+    QEventLoop waiter;
+    testClient->testMethod(request, [&result, &status, &waiter](const QGrpcStatus &callStatus, SimpleStringMessage &&message) {
+        status = callStatus;
+        result = std::move(message);
+        waiter.quit();
+    });
+
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+    ASSERT_EQ(status.code(), QGrpcStatus::Ok);
+    ASSERT_STREQ(result.testFieldString().toStdString().c_str(), "Hello beach!");
+    testClient->deleteLater();
+}
+
+TEST_P(ClientTest, StringEchoCallBatchTest)
+{
+    auto testClient = (*GetParam())();
+    const int callCount = 20;
+    const int maxInFlight = 4;
+    QGrpcCallBatch batch(maxInFlight);
+    int received = 0;
+    int maxObservedInFlight = 0;
+    bool finished = false;
+    QEventLoop waiter;
+    QObject::connect(&batch, &QGrpcCallBatch::finished, &waiter, [&finished, &waiter]() {
+        finished = true;
+        waiter.quit();
+    });
+
+    for (int i = 0; i < callCount; i++) {
+        SimpleStringMessage request;
+        request.setTestFieldString(QString("Hello beach %1").arg(i));
+        ASSERT_TRUE(batch.add(testClient, &TestServiceClient::testMethod, request,
+                              [&batch, &received, &maxObservedInFlight, i](const QGrpcStatus &status, SimpleStringMessage &&message) {
+            maxObservedInFlight = std::max(maxObservedInFlight, batch.inFlightCount());
+            if (status.code() == QGrpcStatus::Ok
+                    && message.testFieldString() == QString("Hello beach %1").arg(i)) {
+                ++received;
+            }
+        }));
+    }
+    ASSERT_LE(batch.inFlightCount(), maxInFlight);
+    batch.close();
+
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+    ASSERT_TRUE(finished);
+    ASSERT_EQ(received, callCount);
+    ASSERT_EQ(batch.completedCount(), callCount);
+    ASSERT_EQ(batch.failedCount(), 0);
+    ASSERT_LE(maxObservedInFlight, maxInFlight);
+    testClient->deleteLater();
+}
+
+TEST_F(ClientTest, CallBatchPriorityTest)
+{
+    QGrpcCallBatch batch(1);
+    std::vector<QString> started;
+    std::deque<QGrpcCallBatch::CompletionHandler> pending;
+    auto makeCall = [&started, &pending](const QString &name) {
+        return [&started, &pending, name](const QGrpcCallBatch::CompletionHandler &done) {
+            started.push_back(name);
+            pending.push_back(done);
+        };
+    };
+
+    ASSERT_TRUE(batch.add(makeCall("first")));
+    ASSERT_TRUE(batch.add(makeCall("low"), QGrpcCallOptions::LowPriority));
+    ASSERT_TRUE(batch.add(makeCall("normal")));
+    ASSERT_TRUE(batch.add(makeCall("high1"), QGrpcCallOptions::HighPriority));
+    ASSERT_TRUE(batch.add(makeCall("high2"), QGrpcCallOptions::HighPriority));
+    ASSERT_EQ(4, batch.queuedCount());
+
+    //Completions are delivered in thread of batch directly, so next call is started right away
+    for (size_t i = 0; i < 5; ++i) {
+        ASSERT_EQ(i + 1, pending.size());
+        pending[i](QGrpcStatus{QGrpcStatus::Ok});
+    }
+
+    ASSERT_TRUE((started == std::vector<QString>{"first", "high1", "high2", "normal", "low"}));
+    ASSERT_EQ(0, batch.queuedCount());
+    ASSERT_EQ(5, batch.completedCount());
+
+    //Priority of call is sent as HTTP/2 stream weight
+    TestServiceClient testClient;
+    testClient.attachChannel(std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials()));
+    QtProtobuf::QGrpcCallOptions options;
+    options.setPriority(QGrpcCallOptions::HighPriority);
+    ASSERT_EQ(QGrpcCallOptions::HighPriority, options.priority());
+    ASSERT_FALSE(options.isEmpty());
+
+    SimpleStringMessage request;
+    request.setTestFieldString("Hello beach!");
+    QEventLoop waiter;
+    QGrpcAsyncReplyShared reply = testClient.testMethod(request, options);
+    SimpleStringMessage result;
+    QObject::connect(reply.get(), &QGrpcAsyncReply::finished, &m_app, [reply, &result, &waiter]() {
+        result = reply->read<SimpleStringMessage>();
+        waiter.quit();
+    });
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+    ASSERT_STREQ(result.testFieldString().toStdString().c_str(), "Hello beach!");
+}
+
+
+TEST_F(ClientTest, ConcurrencyLimiterTest)
+{
+    QGrpcConcurrencyLimiter limiter(2, 1, 4);
+    limiter.setMaxQueued(1);
+    ASSERT_EQ(2, limiter.limit());
+
+    std::deque<QGrpcClientInterceptor::ResponseHandler> pending;
+    std::vector<QGrpcStatus::StatusCode> results;
+    QGrpcClientInterceptor::Next next = [&pending](const QByteArray &, const QGrpcCallOptions &, const QGrpcClientInterceptor::ResponseHandler &handler) {
+        pending.push_back(handler);
+    };
+    auto call = [&limiter, &results, &next](const QGrpcCallOptions &options = {}) {
+        limiter.interceptCall("service", "method", {}, options, [&results](const QGrpcStatus &status, const QByteArray &, const QGrpcMetadata &) {
+            results.push_back(status.code());
+        }, next);
+    };
+
+    call();
+    call();
+    ASSERT_EQ(2, limiter.inFlightCount());
+    //Third call waits in queue, fourth one is rejected
+    call();
+    ASSERT_EQ(1, limiter.queuedCount());
+    call();
+    ASSERT_EQ(1, limiter.rejectedCount());
+    ASSERT_TRUE((results == std::vector<QGrpcStatus::StatusCode>{QGrpcStatus::ResourceExhausted}));
+
+    //Overloaded server decreases limit, queued call is not admitted
+    pending[0](QGrpcStatus{QGrpcStatus::Unavailable}, {}, {});
+    ASSERT_EQ(1, limiter.limit());
+    ASSERT_EQ(1, limiter.inFlightCount());
+    ASSERT_EQ(1, limiter.queuedCount());
+    ASSERT_EQ(2u, pending.size());
+
+    //Successful call releases slot for queued call
+    pending[1](QGrpcStatus{QGrpcStatus::Ok}, {}, {});
+    ASSERT_EQ(0, limiter.queuedCount());
+    ASSERT_EQ(1, limiter.inFlightCount());
+    ASSERT_EQ(3u, pending.size());
+    pending[2](QGrpcStatus{QGrpcStatus::Ok}, {}, {});
+    ASSERT_EQ(0, limiter.inFlightCount());
+    ASSERT_GE(limiter.limit(), 1);
+    ASSERT_LE(limiter.limit(), 4);
+    ASSERT_EQ(4u, results.size());
+
+    //Limiter passes calls of real client
+    auto sharedLimiter = std::make_shared<QGrpcConcurrencyLimiter>(4);
+    TestServiceClient testClient;
+    testClient.attachChannel(std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials()));
+    testClient.addInterceptor(sharedLimiter);
+    SimpleStringMessage request;
+    QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+    request.setTestFieldString("Hello beach!");
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_STREQ(result->testFieldString().toStdString().c_str(), "Hello beach!");
+    ASSERT_EQ(0, sharedLimiter->inFlightCount());
+    delete result;
+}
+
+TEST_F(ClientTest, UploadQueueTest)
+{
+    QProtobufSerializer serializer;
+    std::deque<QGrpcUploadQueue::CompletionHandler> pending;
+    std::vector<int> counts;
+    QGrpcUploadQueue queue([&pending, &counts](const QByteArray &, int count, const QGrpcUploadQueue::CompletionHandler &done) {
+        counts.push_back(count);
+        pending.push_back(done);
+    });
+    queue.setMaxBatchCount(2);
+    queue.setRetryPolicy(std::make_shared<QGrpcReconnectPolicy>(std::chrono::milliseconds(10), std::chrono::milliseconds(10), 1.0, 0.0, 1));
+    ASSERT_TRUE(queue.isValid());
+
+    for (int i = 0; i < 5; ++i) {
+        SimpleStringMessage message;
+        message.setTestFieldString(QString("Record %1").arg(i));
+        ASSERT_TRUE(queue.enqueue(message));
+    }
+
+    //Full batches are sent right away, within limit of batches in flight
+    ASSERT_TRUE((counts == std::vector<int>{2, 2}));
+    ASSERT_EQ(2, queue.inFlightCount());
+    ASSERT_EQ(5, queue.queuedCount());
+
+    pending[0](QGrpcStatus{QGrpcStatus::Ok});
+    ASSERT_EQ(2, queue.sentCount());
+    //Incomplete batch waits for delay
+    ASSERT_EQ(2u, counts.size());
+    queue.flush();
+    ASSERT_TRUE((counts == std::vector<int>{2, 2, 1}));
+
+    //Failed batch is retried once, then dropped
+    int dropped = 0;
+    QObject::connect(&queue, &QGrpcUploadQueue::batchDropped, &m_app, [&dropped](const QGrpcStatus &, int count) {
+        dropped += count;
+    });
+    pending[1](QGrpcStatus{QGrpcStatus::Unavailable});
+    pending[2](QGrpcStatus{QGrpcStatus::Ok});
+    QEventLoop waiter;
+    QTimer::singleShot(200, &waiter, &QEventLoop::quit);
+    waiter.exec();
+    ASSERT_EQ(4u, counts.size());
+    ASSERT_EQ(2, counts[3]);
+    pending[3](QGrpcStatus{QGrpcStatus::Unavailable});
+    ASSERT_EQ(2, dropped);
+    ASSERT_EQ(0, queue.queuedCount());
+    ASSERT_EQ(0, queue.queuedSize());
+
+    //File queue keeps messages, that are not sent, between runs
+    const QString fileName = QDir::tempPath() + "/qtgrpcuploadqueue.log";
+    QFile::remove(fileName);
+    {
+        QGrpcUploadQueue fileQueue([](const QByteArray &, int, const QGrpcUploadQueue::CompletionHandler &) {}, fileName);
+        ASSERT_TRUE(fileQueue.isValid());
+        for (int i = 0; i < 3; ++i) {
+            SimpleStringMessage message;
+            message.setTestFieldString(QString("Stored %1").arg(i));
+            ASSERT_TRUE(fileQueue.enqueue(message));
+        }
+        fileQueue.flush();
+        ASSERT_EQ(1, fileQueue.inFlightCount());
+    }
+
+    QByteArray received;
+    int receivedCount = 0;
+    QGrpcUploadQueue fileQueue([&received, &receivedCount](const QByteArray &batch, int count, const QGrpcUploadQueue::CompletionHandler &done) {
+        received = batch;
+        receivedCount = count;
+        done(QGrpcStatus{QGrpcStatus::Ok});
+    }, fileName);
+    ASSERT_EQ(3, fileQueue.queuedCount());
+    fileQueue.flush();
+    ASSERT_EQ(3, receivedCount);
+    QList<QSharedPointer<SimpleStringMessage>> messages = serializer.deserializeBatch<SimpleStringMessage>(received);
+    ASSERT_EQ(3, messages.count());
+    ASSERT_STREQ("Stored 2", messages.at(2)->testFieldString().toStdString().c_str());
+    ASSERT_EQ(0, fileQueue.queuedCount());
+    ASSERT_EQ(0, QFileInfo(fileName).size());
+    QFile::remove(fileName);
+}
+
+TEST_P(ClientTest, StringEchoAsyncCoalescingTest)
+{
+    auto testClient = (*GetParam())();
+    testClient->setCallCoalescingEnabled(true);
+    SimpleStringMessage request;
+    request.setTestFieldString("Hello beach!");
+
+    QEventLoop waiter;
+    QGrpcAsyncReplyShared abortedReply = testClient->testMethod(request);
+    QGrpcAsyncReplyShared reply1 = testClient->testMethod(request);
+    QGrpcAsyncReplyShared reply2 = testClient->testMethod(request);
+
+    QGrpcStatus::StatusCode abortedStatus = QGrpcStatus::Ok;
+    QObject::connect(abortedReply.get(), &QGrpcAsyncReply::error, &m_app, [&abortedStatus](const QGrpcStatus &status) {
+        abortedStatus = status.code();
+    });
+
+    int finishedCount = 0;
+    SimpleStringMessage result1;
+    SimpleStringMessage result2;
+    QObject::connect(reply1.get(), &QGrpcAsyncReply::finished, &m_app, [reply1, &result1, &finishedCount, &waiter]() {
+        result1 = reply1->read<SimpleStringMessage>();
+        if (++finishedCount == 2) {
+            waiter.quit();
+        }
+    });
+    QObject::connect(reply2.get(), &QGrpcAsyncReply::finished, &m_app, [reply2, &result2, &finishedCount, &waiter]() {
+        result2 = reply2->read<SimpleStringMessage>();
+        if (++finishedCount == 2) {
+            waiter.quit();
+        }
+    });
+
+    //Aborting one of joined calls doesn't affect the others
+    abortedReply->abort();
+
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+    ASSERT_EQ(abortedStatus, QGrpcStatus::Aborted);
+    ASSERT_EQ(finishedCount, 2);
+    ASSERT_STREQ(result1.testFieldString().toStdString().c_str(), "Hello beach!");
+    ASSERT_STREQ(result2.testFieldString().toStdString().c_str(), "Hello beach!");
+    testClient->deleteLater();
+}
+
+TEST_P(ClientTest, StringEchoAsyncCallOptionsTest)
+{
+    auto testClient = (*GetParam())();
+    SimpleStringMessage request;
+    request.setTestFieldString("sleep");
+
+    QtProtobuf::QGrpcCallOptions options;
+    options.addMetadata("x-trace-id", "0123456789abcdef");
+    options.setDeadline(std::chrono::milliseconds(200));
+    ASSERT_FALSE(options.isEmpty());
+
+    QEventLoop waiter;
+    QGrpcAsyncReplyShared reply = testClient->testMethod(request, options);
+    QGrpcStatus::StatusCode status = QGrpcStatus::Ok;
+    QObject::connect(reply.get(), &QGrpcAsyncReply::error, &m_app, [&status, &waiter](const QGrpcStatus &error) {
+        status = error.code();
+        waiter.quit();
+    });
+
+    //Deadline of call overrides deadline of channel
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+    ASSERT_EQ(status, QGrpcStatus::DeadlineExceeded);
+
+    request.setTestFieldString("Hello beach!");
+    options.setDeadline(std::chrono::seconds(5));
+    reply = testClient->testMethod(request, options);
+    SimpleStringMessage result;
+    QObject::connect(reply.get(), &QGrpcAsyncReply::finished, &m_app, [reply, &result, &waiter]() {
+        result = reply->read<SimpleStringMessage>();
+        waiter.quit();
+    });
+    waiter.exec();
+    ASSERT_STREQ(result.testFieldString().toStdString().c_str(), "Hello beach!");
+    testClient->deleteLater();
+}
 
 TEST_P(ClientTest, StringEchoImmediateAsyncAbortTest)
 {
@@ -227,6 +599,90 @@ TEST_P(ClientTest, StringEchoDeferredAsyncAbortTest)
     testClient->deleteLater();
 }
 
+TEST_P(ClientTest, StringEchoInFlightAbortTest)
+{
+    auto testClient = (*GetParam())();
+    SimpleStringMessage request;
+    request.setTestFieldString("sleep");
+    QGrpcAsyncReplyShared reply = testClient->testMethod(request);
+
+    bool aborted = false;
+    int finishedCount = 0;
+    int errorCount = 0;
+    QObject::connect(reply.get(), &QGrpcAsyncReply::finished, &m_app, [&finishedCount] {
+        ++finishedCount;
+    });
+    QObject::connect(reply.get(), &QGrpcAsyncReply::error, &m_app, [&aborted, &errorCount](const QGrpcStatus &status) {
+        //Aborted error is emitted by abort() itself, anything after it is delivered by cancelled call
+        if (aborted || status.code() != QGrpcStatus::Aborted) {
+            ++errorCount;
+        }
+    });
+
+    QEventLoop waiter;
+    QTimer::singleShot(200, &waiter, [&aborted, reply] {
+        reply->abort();
+        aborted = true;
+    });
+    //Server answers sleep request in 1 second, so reply would be delivered by now if call wasn't cancelled
+    QTimer::singleShot(2000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+
+    ASSERT_TRUE(aborted);
+    EXPECT_EQ(0, finishedCount);
+    EXPECT_EQ(0, errorCount);
+
+    //Channel is still usable after the call is cancelled
+    request.setTestFieldString("After abort");
+    QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+    ASSERT_TRUE(testClient->testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_STREQ(result->testFieldString().toStdString().c_str(), "After abort");
+    delete result;
+    testClient->deleteLater();
+}
+
+TEST_F(ClientTest, StringEchoInFlightReplyDestroyedTest)
+{
+    for (bool ioThread : {false, true}) {
+        auto channel = std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials());
+        channel->setIoThreadEnabled(ioThread);
+        auto *testClient = new TestServiceClient;
+        testClient->attachChannel(channel);
+
+        SimpleStringMessage request;
+        request.setTestFieldString("sleep");
+        QGrpcAsyncReplyShared reply = testClient->testMethod(request);
+        QPointer<QGrpcAsyncReply> replyPointer(reply.get());
+
+        int signalCount = 0;
+        QObject::connect(reply.get(), &QGrpcAsyncReply::finished, &m_app, [&signalCount] {
+            ++signalCount;
+        });
+        QObject::connect(reply.get(), &QGrpcAsyncReply::error, &m_app, [&signalCount] {
+            ++signalCount;
+        });
+        reply.reset();
+
+        //Reply is owned by client, so it's destroyed together with client while call is in flight
+        QEventLoop waiter;
+        QTimer::singleShot(200, testClient, &QObject::deleteLater);
+        QTimer::singleShot(2000, &waiter, &QEventLoop::quit);
+        waiter.exec();
+
+        EXPECT_TRUE(replyPointer.isNull());
+        EXPECT_EQ(0, signalCount);
+
+        //Channel is still usable after the call is cancelled
+        TestServiceClient nextClient;
+        nextClient.attachChannel(channel);
+        request.setTestFieldString("After destroy");
+        QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+        ASSERT_TRUE(nextClient.testMethod(request, result) == QGrpcStatus::Ok);
+        ASSERT_STREQ(result->testFieldString().toStdString().c_str(), "After destroy");
+        delete result;
+    }
+}
+
 TEST_P(ClientTest, StringEchoStreamTest)
 {
     auto testClient = (*GetParam())();
@@ -259,6 +715,36 @@ TEST_P(ClientTest, StringEchoStreamTest)
     testClient->deleteLater();
 }
 
+TEST_P(ClientTest, StringEchoStreamLatestMessageTest)
+{
+    auto testClient = (*GetParam())();
+    SimpleStringMessage request;
+    request.setTestFieldString("Stream");
+
+    QEventLoop waiter;
+
+    int i = 0;
+    QString latest;
+    auto stream = testClient->subscribeTestMethodServerStream(request);
+    stream->setLatestMessageOnly(true);
+    ASSERT_TRUE(stream->isLatestMessageOnly());
+    QObject::connect(stream.get(), &QGrpcStream::messageReceived, &m_app, [&latest, &i, &waiter, stream]() {
+        latest = stream->read<SimpleStringMessage>().testFieldString();
+        ++i;
+        if (latest == "Stream4") {
+            waiter.quit();
+        }
+    });
+
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+
+    //Intermediate messages may be dropped, but the latest one is always delivered
+    ASSERT_LE(i, 4);
+    ASSERT_STREQ(latest.toStdString().c_str(), "Stream4");
+    testClient->deleteLater();
+}
+
 TEST_P(ClientTest, StringEchoStreamAbortTest)
 {
     auto testClient = (*GetParam())();
@@ -359,6 +845,95 @@ TEST_P(ClientTest, StringEchoStreamTestRet)
     testClient->deleteLater();
 }
 
+TEST_P(ClientTest, StringEchoStreamSharedRetTest)
+{
+    auto testClient = (*GetParam())();
+    SimpleStringMessage request;
+    QPointer<SimpleStringMessage> result1(new SimpleStringMessage);
+    QPointer<SimpleStringMessage> result2(new SimpleStringMessage);
+
+    request.setTestFieldString("Stream");
+
+    QEventLoop waiter;
+
+    auto stream1 = testClient->subscribeTestMethodServerStream(request, result1);
+    auto stream2 = testClient->subscribeTestMethodServerStream(request, result2);
+    ASSERT_EQ(stream1, stream2);
+
+    int i = 0;
+    int j = 0;
+    QObject::connect(result1.data(), &SimpleStringMessage::testFieldStringChanged, &m_app, [&i]() {
+        i++;
+    });
+    QObject::connect(result2.data(), &SimpleStringMessage::testFieldStringChanged, &m_app, [&j]() {
+        j++;
+    });
+
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+
+    ASSERT_EQ(i, 4);
+    ASSERT_EQ(j, 4);
+    ASSERT_STREQ(result1->testFieldString().toStdString().c_str(), "Stream4");
+    ASSERT_STREQ(result2->testFieldString().toStdString().c_str(), "Stream4");
+    delete result1;
+    delete result2;
+    testClient->deleteLater();
+}
+
+TEST_P(ClientTest, StringEchoStreamBackgroundDeserializationTest)
+{
+    auto testClient = (*GetParam())();
+    testClient->setBackgroundDeserializationEnabled(true);
+    SimpleStringMessage request;
+    QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+
+    request.setTestFieldString("Stream");
+
+    QEventLoop waiter;
+
+    testClient->subscribeTestMethodServerStream(request, result);
+
+    int i = 0;
+    bool isClientThread = true;
+    QObject::connect(result.data(), &SimpleStringMessage::testFieldStringChanged, &m_app, [&i, &isClientThread, &waiter]() {
+        isClientThread = isClientThread && QThread::currentThread() == m_app.thread();
+        if (++i == 4) {
+            waiter.quit();
+        }
+    });
+
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+
+    ASSERT_EQ(i, 4);
+    ASSERT_TRUE(isClientThread);
+    ASSERT_STREQ(result->testFieldString().toStdString().c_str(), "Stream4");
+    delete result;
+    testClient->deleteLater();
+}
+
+TEST_P(ClientTest, StringEchoAsyncReadInBackgroundTest)
+{
+    auto testClient = (*GetParam())();
+    SimpleStringMessage request;
+    request.setTestFieldString("Hello beach!");
+    QEventLoop waiter;
+
+    QString result;
+    QGrpcAsyncReplyShared reply = testClient->testMethod(request);
+    QObject::connect(reply.get(), &QGrpcAsyncReply::finished, &m_app, [reply, &result, &waiter]() {
+        reply->readInBackground<SimpleStringMessage>(&waiter, [&result, &waiter](const SimpleStringMessage &message) {
+            result = message.testFieldString();
+            waiter.quit();
+        });
+    });
+
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+    ASSERT_STREQ(result.toStdString().c_str(), "Hello beach!");
+    testClient->deleteLater();
+}
 
 TEST_P(ClientTest, HugeBlobEchoStreamTest)
 {
@@ -732,30 +1307,106 @@ TEST_P(ClientTest, StringEchoAsyncThreadTest)
     testClient->deleteLater();
 }
 
-TEST_P(ClientTest, StringEchoStreamThreadTest)
+TEST_P(ClientTest, StringEchoAsyncFutureThreadTest)
 {
     auto testClient = (*GetParam())();
-    SimpleStringMessage result;
     SimpleStringMessage request;
-    request.setTestFieldString("Stream");
+    SimpleStringMessage result;
+    request.setTestFieldString("Hello beach from thread!");
 
-    int i = 0;
-    bool threadsOk = true;
+    QGrpcStatus status{QGrpcStatus::Unknown};
     std::shared_ptr<QThread> thread(QThread::create([&](){
-        QEventLoop waiter;
-        QThread *validThread = QThread::currentThread();
-        auto stream = testClient->subscribeTestMethodServerStream(request);
-        QObject::connect(stream.get(), &QGrpcStream::messageReceived, &waiter, [&result, &i, &waiter, stream, &threadsOk, validThread]() {
-            SimpleStringMessage ret = stream->read<SimpleStringMessage>();
-            result.setTestFieldString(result.testFieldString() + ret.testFieldString());
-            ++i;
-            if (i == 4) {
-                waiter.quit();
-            }
-            threadsOk &= stream->thread() != QThread::currentThread();
-            threadsOk &= validThread == QThread::currentThread();
-        });
-
+        //Worker thread waits for future without event loop
+        QGrpcAsyncReplyShared reply = testClient->testMethod(request);
+        QFuture<QGrpcStatus> future = reply->future();
+        future.waitForFinished();
+        status = future.result();
+        result = reply->read<SimpleStringMessage>();
+    }));
+
+    QEventLoop wait;
+    QObject::connect(thread.get(), &QThread::finished, &wait, &QEventLoop::quit);
+    QTimer::singleShot(20000, &wait, &QEventLoop::quit);
+    thread->start();
+    wait.exec();
+
+    ASSERT_TRUE(thread->isFinished());
+    ASSERT_EQ(status.code(), QGrpcStatus::Ok);
+    ASSERT_STREQ(result.testFieldString().toStdString().c_str(), "Hello beach from thread!");
+    testClient->deleteLater();
+}
+
+TEST_P(ClientTest, StringEchoAsyncMultiThreadingTest)
+{
+    auto testClient = (*GetParam())();
+    testClient->setMultiThreadingEnabled(true);
+    SimpleStringMessage request;
+    request.setTestFieldString("Hello beach from thread!");
+
+    std::vector<SimpleStringMessage> results(4);
+    std::vector<int> threadsOk(4, 0);
+    std::vector<std::shared_ptr<QThread>> threads;
+    for (size_t i = 0; i < results.size(); i++) {
+        threads.push_back(std::shared_ptr<QThread>(QThread::create([&, i](){
+            QEventLoop waiter;
+            QGrpcAsyncReplyShared reply = testClient->testMethod(request);
+            //Reply is owned by calling thread, client thread is not involved
+            bool ok = reply->thread() == QThread::currentThread();
+            QObject::connect(reply.get(), &QGrpcAsyncReply::finished, &waiter, [reply, &results, &waiter, &ok, i]() {
+                ok = ok && reply->thread() == QThread::currentThread();
+                results[i] = reply->read<SimpleStringMessage>();
+                waiter.quit();
+            });
+            QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+            waiter.exec();
+            threadsOk[i] = ok ? 1 : 0;
+        })));
+    }
+
+    int finishedCount = 0;
+    QEventLoop wait;
+    for (auto &thread : threads) {
+        QObject::connect(thread.get(), &QThread::finished, &wait, [&finishedCount, &wait, &threads]() {
+            if (++finishedCount == static_cast<int>(threads.size())) {
+                wait.quit();
+            }
+        });
+        thread->start();
+    }
+    QTimer::singleShot(20000, &wait, &QEventLoop::quit);
+    wait.exec();
+
+    for (size_t i = 0; i < results.size(); i++) {
+        ASSERT_TRUE(threadsOk[i]);
+        ASSERT_STREQ(results[i].testFieldString().toStdString().c_str(), "Hello beach from thread!");
+    }
+    testClient->deleteLater();
+}
+
+TEST_P(ClientTest, StringEchoStreamThreadTest)
+{
+    auto testClient = (*GetParam())();
+    SimpleStringMessage result;
+    SimpleStringMessage request;
+    request.setTestFieldString("Stream");
+
+    int i = 0;
+    bool threadsOk = true;
+    std::shared_ptr<QThread> thread(QThread::create([&](){
+        QEventLoop waiter;
+        QThread *validThread = QThread::currentThread();
+        auto stream = testClient->subscribeTestMethodServerStream(request);
+        QObject::connect(stream.get(), &QGrpcStream::messageReceived, &waiter, [&result, &i, &waiter, stream, &threadsOk, validThread]() {
+            SimpleStringMessage ret = stream->read<SimpleStringMessage>();
+            result.setTestFieldString(result.testFieldString() + ret.testFieldString());
+            ++i;
+            if (i == 4) {
+                waiter.quit();
+            }
+            threadsOk &= stream->thread() != QThread::currentThread();
+            threadsOk &= validThread == QThread::currentThread();
+        });
+
         threadsOk &= stream->thread() != QThread::currentThread();
         QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
         waiter.exec();
@@ -773,6 +1424,1548 @@ TEST_P(ClientTest, StringEchoStreamThreadTest)
     testClient->deleteLater();
 }
 
+TEST_P(ClientTest, ClientStreamStringTest)
+{
+    auto testClient = (*GetParam())();
+    SimpleStringMessage result;
+    SimpleStringMessage request;
+
+    QEventLoop waiter;
+
+    bool finished = false;
+    auto stream = testClient->streamTestMethodClientStream();
+    QObject::connect(stream.get(), &QGrpcClientStream::messageReceived, &m_app, [&result, stream]() {
+        result = stream->read<SimpleStringMessage>();
+    });
+    QObject::connect(stream.get(), &QGrpcClientStream::finished, &m_app, [&finished, &waiter]() {
+        finished = true;
+        waiter.quit();
+    });
+
+    for (int i = 1; i <= 3; i++) {
+        request.setTestFieldString(QString("Stream%1").arg(i));
+        ASSERT_TRUE(stream->write(request));
+    }
+    stream->writesDone();
+    ASSERT_FALSE(stream->write(request));
+
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+
+    ASSERT_TRUE(finished);
+    ASSERT_STREQ(result.testFieldString().toStdString().c_str(), "Stream1Stream2Stream3");
+    testClient->deleteLater();
+}
+
+TEST_P(ClientTest, BidirectionalStreamStringTest)
+{
+    auto testClient = (*GetParam())();
+    SimpleStringMessage result;
+    SimpleStringMessage request;
+
+    QEventLoop waiter;
+
+    int i = 0;
+    auto stream = testClient->streamTestMethodBiStream();
+    QObject::connect(stream.get(), &QGrpcClientStream::messageReceived, &m_app, [&result, &i, stream]() {
+        SimpleStringMessage ret = stream->read<SimpleStringMessage>();
+        ++i;
+        result.setTestFieldString(result.testFieldString() + ret.testFieldString());
+    });
+    QObject::connect(stream.get(), &QGrpcClientStream::finished, &waiter, &QEventLoop::quit);
+
+    for (int j = 1; j <= 4; j++) {
+        request.setTestFieldString(QString("Stream%1").arg(j));
+        stream->write(request);
+    }
+    stream->writesDone();
+
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+
+    ASSERT_EQ(i, 4);
+    ASSERT_STREQ(result.testFieldString().toStdString().c_str(), "Stream1Stream2Stream3Stream4");
+    testClient->deleteLater();
+}
+
+TEST_P(ClientTest, BidirectionalStreamMultiplexerTest)
+{
+    auto testClient = (*GetParam())();
+    QProtobufSerializer serializer;
+
+    //Echo server returns control messages too, they are delivered to topic they are written for
+    auto stream = testClient->streamTestMethodBiStream();
+    QGrpcStreamMultiplexer multiplexer(stream, [&serializer](const QByteArray &data) {
+        SimpleStringMessage message;
+        message.deserialize(&serializer, data);
+        return message.testFieldString().section('/', 0, 0).toUtf8();
+    }, [&serializer](const QByteArray &topic, bool subscribed) {
+        return SimpleStringMessage(QString::fromUtf8(topic) + (subscribed ? "/subscribe" : "/unsubscribe")).serialize(&serializer);
+    });
+
+    QStringList topicA;
+    QStringList topicB;
+    QList<QByteArray> unhandled;
+    ASSERT_TRUE(multiplexer.subscribe("a", [&serializer, &topicA](const QByteArray &data) {
+        SimpleStringMessage message;
+        message.deserialize(&serializer, data);
+        topicA.append(message.testFieldString());
+    }));
+    ASSERT_TRUE(multiplexer.subscribe("b", [&serializer, &topicB](const QByteArray &data) {
+        SimpleStringMessage message;
+        message.deserialize(&serializer, data);
+        topicB.append(message.testFieldString());
+    }));
+    QObject::connect(&multiplexer, &QGrpcStreamMultiplexer::unhandledMessage, &m_app, [&unhandled](const QByteArray &topic) {
+        unhandled.append(topic);
+    });
+
+    QEventLoop waiter;
+    QObject::connect(&multiplexer, &QGrpcStreamMultiplexer::finished, &waiter, &QEventLoop::quit);
+    stream->write(SimpleStringMessage("a/1"));
+    stream->write(SimpleStringMessage("c/2"));
+    stream->write(SimpleStringMessage("b/3"));
+    stream->writesDone();
+
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+
+    ASSERT_EQ(multiplexer.receivedCount(), 5u);
+    ASSERT_TRUE(topicA == QStringList({"a/subscribe", "a/1"}));
+    ASSERT_TRUE(topicB == QStringList({"b/subscribe", "b/3"}));
+    ASSERT_TRUE(unhandled == QList<QByteArray>({"c"}));
+
+    multiplexer.unsubscribe("b");
+    ASSERT_TRUE(multiplexer.isSubscribed("a"));
+    ASSERT_FALSE(multiplexer.isSubscribed("b"));
+    ASSERT_TRUE(multiplexer.topics() == QList<QByteArray>({"a"}));
+    testClient->deleteLater();
+}
+
+TEST_F(ClientTest, MethodDeadlineTest)
+{
+    auto channel = std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials());
+    channel->setMethodDeadline("qtprotobufnamespace.tests.TestService", "testMethod", std::chrono::milliseconds(200));
+    TestServiceClient testClient;
+    testClient.attachChannel(channel);
+
+    SimpleStringMessage request;
+    QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+    request.setTestFieldString("sleep");
+    ASSERT_EQ(QGrpcStatus::DeadlineExceeded, testClient.testMethod(request, result).code());
+
+    channel->resetMethodDeadline("qtprotobufnamespace.tests.TestService", "testMethod");
+    ASSERT_EQ(std::chrono::milliseconds(6000), channel->defaultDeadline());
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_STREQ(result->testFieldString().toStdString().c_str(), "sleep");
+    delete result;
+}
+
+TEST_F(ClientTest, CompressionTest)
+{
+    if (!QGrpcHttp2Channel::isCompressionSupported()) {
+        //QtGrpc is built without compression support
+        return;
+    }
+
+    auto channel = std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials());
+    channel->setCompressionThreshold(0);
+    channel->setDefaultCompression(QGrpcHttp2Channel::GzipCompression);
+    TestServiceClient testClient;
+    testClient.attachChannel(channel);
+
+    SimpleStringMessage request;
+    QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+    request.setTestFieldString(QString("Compressed").repeated(100));
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_TRUE(result->testFieldString() == request.testFieldString());
+    delete result;
+}
+
+TEST_F(ClientTest, LargeMessageEchoTest)
+{
+    //Large uncompressed request is sent from framed device instead of copied body
+    auto channel = std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials());
+    TestServiceClient testClient;
+    testClient.attachChannel(channel);
+
+    SimpleStringMessage request;
+    QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+    request.setTestFieldString(QString("Large").repeated(200 * 1024) + "end");
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_TRUE(result->testFieldString() == request.testFieldString());
+    delete result;
+}
+
+TEST_F(ClientTest, SerializerSelectionTest)
+{
+    auto channel = std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials());
+    ASSERT_EQ(QString("protobuf"), channel->serializerId());
+    ASSERT_EQ(QByteArray("application/grpc"), channel->contentType());
+
+    ASSERT_TRUE(channel->setSerializer("json"));
+    EXPECT_EQ(QString("json"), channel->serializerId());
+    EXPECT_EQ(QByteArray("application/grpc+json"), channel->contentType());
+    EXPECT_EQ(QProtobufSerializerRegistry::instance().findSerializer("json"), channel->serializer().get());
+
+    EXPECT_FALSE(channel->setSerializer("unknown"));
+    EXPECT_EQ(QString("json"), channel->serializerId());
+}
+
+TEST_F(ClientTest, ConnectAheadTest)
+{
+    auto channel = std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials());
+    channel->setConnectionCount(2);
+    channel->connectAhead();
+    //Repeated warm-up while connections are being established is harmless
+    channel->connectAhead();
+
+    TestServiceClient testClient;
+    testClient.attachChannel(channel);
+    SimpleStringMessage request;
+    request.setTestFieldString("Warm");
+    QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_STREQ(result->testFieldString().toStdString().c_str(), "Warm");
+    delete result;
+}
+
+TEST_F(ClientTest, SharedConnectionTest)
+{
+    auto firstChannel = std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials());
+    auto secondChannel = std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials());
+    ASSERT_FALSE(firstChannel->isConnectionSharingEnabled());
+    firstChannel->setConnectionSharingEnabled(true);
+    secondChannel->setConnectionSharingEnabled(true);
+    ASSERT_TRUE(firstChannel->isConnectionSharingEnabled());
+
+    TestServiceClient firstClient;
+    firstClient.attachChannel(firstChannel);
+    TestServiceClient secondClient;
+    secondClient.attachChannel(secondChannel);
+
+    SimpleStringMessage request;
+    request.setTestFieldString("Shared");
+    QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+    ASSERT_TRUE(firstClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_STREQ(result->testFieldString().toStdString().c_str(), "Shared");
+    ASSERT_TRUE(secondClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_STREQ(result->testFieldString().toStdString().c_str(), "Shared");
+
+    //Connection stays usable by other channel, when channel that shared it is detached
+    firstClient.attachChannel(std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials()));
+    firstChannel.reset();
+    ASSERT_TRUE(secondClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_STREQ(result->testFieldString().toStdString().c_str(), "Shared");
+    delete result;
+}
+
+TEST_F(ClientTest, StreamReadBufferTest)
+{
+    auto channel = std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials());
+    ASSERT_EQ(4 * 1024 * 1024, channel->streamReadBufferSize());
+    channel->setStreamReadBufferSize(-1);
+    ASSERT_EQ(0, channel->streamReadBufferSize());
+    //Buffer that is smaller than single frame still delivers messages, they are read by parts
+    channel->setStreamReadBufferSize(8);
+    ASSERT_EQ(8, channel->streamReadBufferSize());
+
+    TestServiceClient testClient;
+    testClient.attachChannel(channel);
+    SimpleStringMessage request;
+    request.setTestFieldString("Stream");
+    SimpleStringMessage result;
+    QEventLoop waiter;
+    int i = 0;
+    auto stream = testClient.subscribeTestMethodServerStream(request);
+    QObject::connect(stream.get(), &QGrpcStream::messageReceived, &m_app, [&result, &i, &waiter, stream]() {
+        result.setTestFieldString(result.testFieldString() + stream->read<SimpleStringMessage>().testFieldString());
+        if (++i == 4) {
+            waiter.quit();
+        }
+    });
+
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+
+    ASSERT_EQ(i, 4);
+    ASSERT_STREQ(result.testFieldString().toStdString().c_str(), "Stream1Stream2Stream3Stream4");
+}
+
+TEST_F(ClientTest, StreamReadBufferBackpressureTest)
+{
+    auto channel = std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials());
+    //Single message of stream fills the buffer
+    channel->setStreamReadBufferSize(8);
+
+    TestServiceClient testClient;
+    testClient.attachChannel(channel);
+    SimpleStringMessage request;
+    request.setTestFieldString("Stream");
+    QStringList results;
+    QList<qint64> receivedAt;
+    qint64 resumedAt = 0;
+    QElapsedTimer timer;
+    QEventLoop waiter;
+    auto stream = testClient.subscribeTestMethodServerStream(request);
+    QObject::connect(stream.get(), &QGrpcStream::messageReceived, &m_app, [&results, &receivedAt, &resumedAt, &timer, &waiter, stream]() {
+        results.append(stream->read<SimpleStringMessage>().testFieldString());
+        receivedAt.append(timer.elapsed());
+        if (results.size() == 1) {
+            //Stream is not consumed while server sends next two messages
+            QThread::msleep(2500);
+            resumedAt = timer.elapsed();
+        } else if (results.size() == 4) {
+            waiter.quit();
+        }
+    });
+
+    timer.start();
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+
+    ASSERT_EQ((QStringList{"Stream1", "Stream2", "Stream3", "Stream4"}), results);
+    //Messages sent by server while reading was paused are delivered once it's resumed, nothing is lost
+    ASSERT_GE(receivedAt[1], resumedAt);
+    ASSERT_LT(receivedAt[2] - resumedAt, 500);
+    //Reading goes on after buffered messages are taken, the last message is received when server sends it
+    ASSERT_GT(receivedAt[3] - receivedAt[2], 200);
+}
+
+TEST_F(ClientTest, ConnectionPoolTest)
+{
+    auto channel = std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials());
+    ASSERT_EQ(1, channel->connectionCount());
+    channel->setConnectionCount(0);
+    ASSERT_EQ(1, channel->connectionCount());
+    channel->setConnectionCount(3);
+    ASSERT_EQ(3, channel->connectionCount());
+    TestServiceClient testClient;
+    testClient.attachChannel(channel);
+
+    SimpleStringMessage request;
+    request.setTestFieldString("Pool");
+    QEventLoop waiter;
+    int finishedCount = 0;
+    std::vector<QGrpcAsyncReplyShared> replies;
+    for (int i = 0; i < 6; i++) {
+        auto reply = testClient.testMethod(request);
+        QObject::connect(reply.get(), &QGrpcAsyncReply::finished, &m_app, [reply, &finishedCount, &waiter]() {
+            ASSERT_STREQ(reply->read<SimpleStringMessage>().testFieldString().toStdString().c_str(), "Pool");
+            if (++finishedCount == 6) {
+                waiter.quit();
+            }
+        });
+        replies.push_back(reply);
+    }
+
+    //Pool is shrunk while calls are active
+    channel->setConnectionCount(2);
+    ASSERT_EQ(2, channel->connectionCount());
+
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+    ASSERT_EQ(6, finishedCount);
+}
+
+TEST_F(ClientTest, BalancingChannelEjectionTest)
+{
+    std::vector<std::shared_ptr<QAbstractGrpcChannel>> channels {
+        std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials()),
+        std::make_shared<QGrpcHttp2Channel>(QUrl("http://localhost:50050", QUrl::StrictMode), QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials())
+    };
+    auto channel = std::make_shared<QGrpcBalancingChannel>(channels, QGrpcBalancingChannel::RoundRobin);
+    channel->setEjectionThreshold(1);
+    TestServiceClient testClient;
+    testClient.attachChannel(channel);
+
+    SimpleStringMessage request;
+    QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+    request.setTestFieldString("Balancing");
+    ASSERT_EQ(2, channel->healthyChannelCount());
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_EQ(QGrpcStatus::Unavailable, testClient.testMethod(request, result).code());
+    ASSERT_EQ(1, channel->healthyChannelCount());
+
+    //Calls are not made using ejected channel
+    for (int i = 0; i < 3; i++) {
+        ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+        ASSERT_STREQ(result->testFieldString().toStdString().c_str(), "Balancing");
+    }
+    delete result;
+}
+
+TEST_F(ClientTest, CachingChannelTest)
+{
+    auto channel = std::make_shared<QGrpcCachingChannel>(std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials()));
+    channel->enableCaching("qtprotobufnamespace.tests.TestService", "testMethod", std::chrono::seconds(60));
+    TestServiceClient testClient;
+    testClient.attachChannel(channel);
+
+    SimpleStringMessage request;
+    QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+    request.setTestFieldString("Cached");
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_EQ(0, channel->hitCount());
+
+    result->setTestFieldString("");
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_STREQ(result->testFieldString().toStdString().c_str(), "Cached");
+    ASSERT_EQ(1, channel->hitCount());
+
+    //Cached response is delivered to asynchronous calls as well
+    QEventLoop waiter;
+    QGrpcAsyncReplyShared reply = testClient.testMethod(request);
+    SimpleStringMessage asyncResult;
+    QObject::connect(reply.get(), &QGrpcAsyncReply::finished, &m_app, [reply, &asyncResult, &waiter]() {
+        asyncResult = reply->read<SimpleStringMessage>();
+        waiter.quit();
+    });
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+    ASSERT_STREQ(asyncResult.testFieldString().toStdString().c_str(), "Cached");
+    ASSERT_EQ(2, channel->hitCount());
+
+    //Arguments are part of cache key
+    request.setTestFieldString("Not cached");
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_STREQ(result->testFieldString().toStdString().c_str(), "Not cached");
+    ASSERT_EQ(2, channel->hitCount());
+
+    channel->invalidate("qtprotobufnamespace.tests.TestService", "testMethod");
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_EQ(2, channel->hitCount());
+    delete result;
+}
+
+//Returns HTTP/2 frame of \a type with \a payload
+static QByteArray http2Frame(quint8 type, quint8 flags, quint32 streamId, const QByteArray &payload = {})
+{
+    QByteArray frame(9, '\0');
+    qToBigEndian<quint32>(static_cast<quint32>(payload.size()) << 8 | type, frame.data());
+    frame[4] = static_cast<char>(flags);
+    qToBigEndian<quint32>(streamId, frame.data() + 5);
+    return frame + payload;
+}
+
+//Returns HPACK header block, where every header is literal without indexing
+static QByteArray hpackHeaders(const QList<QPair<QByteArray, QByteArray>> &headers)
+{
+    QByteArray block;
+    for (const auto &header : headers) {
+        block.append('\0');
+        block.append(static_cast<char>(header.first.size()));
+        block.append(header.first);
+        block.append(static_cast<char>(header.second.size()));
+        block.append(header.second);
+    }
+    return block;
+}
+
+//Returns gRPC frame of \a message, that is cut to \a size bytes if it's given
+static QByteArray grpcFrame(const QByteArray &message, bool compressed = false, int size = -1)
+{
+    QByteArray frame(5, '\0');
+    frame[0] = compressed ? 1 : 0;
+    qToBigEndian<qint32>(message.size(), frame.data() + 1);
+    frame.append(message);
+    return size < 0 ? frame : frame.left(size);
+}
+
+//Received HTTP/2 frame of \a type with \a payload
+using Http2FrameObserver = std::function<void(quint8 type, quint32 streamId, const QByteArray &payload)>;
+
+//Emulates prior knowledge HTTP/2 server, that answers every request with reply \a body and \a headers
+//followed by Ok status trailers. Frames sent by client are passed to \a observer
+static void serveHttp2Reply(QTcpServer &server, const QList<QPair<QByteArray, QByteArray>> &headers, const QByteArray &body,
+                            const Http2FrameObserver &observer = nullptr)
+{
+    const QByteArray preface("PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n");
+    QObject::connect(&server, &QTcpServer::newConnection, &server, [&server, headers, body, preface, observer] {
+        QTcpSocket *socket = server.nextPendingConnection();
+        std::shared_ptr<QByteArray> buffer(new QByteArray);
+        socket->write(http2Frame(0x4, 0x0, 0));
+        QObject::connect(socket, &QTcpSocket::readyRead, socket, [socket, buffer, headers, body, preface, observer] {
+            buffer->append(socket->readAll());
+            if (buffer->startsWith(preface)) {
+                buffer->remove(0, preface.size());
+            }
+            while (buffer->size() >= 9) {
+                const int length = static_cast<int>(qFromBigEndian<quint32>(buffer->constData()) >> 8);
+                if (buffer->size() < 9 + length) {
+                    return;
+                }
+                const quint8 type = static_cast<quint8>(buffer->at(3));
+                const quint8 flags = static_cast<quint8>(buffer->at(4));
+                const quint32 streamId = qFromBigEndian<quint32>(buffer->constData() + 5) & 0x7fffffff;
+                if (observer) {
+                    observer(type, streamId, buffer->mid(9, length));
+                }
+                buffer->remove(0, 9 + length);
+                if (type == 0x4 && !(flags & 0x1)) {
+                    //Settings are acknowledged
+                    socket->write(http2Frame(0x4, 0x1, 0));
+                } else if ((type == 0x0 || type == 0x1) && (flags & 0x1) && streamId != 0) {
+                    //Request stream is ended, so reply is sent
+                    socket->write(http2Frame(0x1, 0x4, streamId, QByteArray(1, static_cast<char>(0x88)) + hpackHeaders(headers)));
+                    socket->write(http2Frame(0x0, 0x0, streamId, body));
+                    socket->write(http2Frame(0x1, 0x5, streamId, hpackHeaders({{"grpc-status", "0"}})));
+                }
+            }
+        });
+        QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+    });
+}
+
+TEST_F(ClientTest, UnaryReplyValidationTest)
+{
+    QProtobufSerializer serializer;
+    SimpleStringMessage response;
+    response.setTestFieldString("Invalid reply");
+    const QByteArray message = response.serialize(&serializer);
+
+    struct InvalidReply {
+        QList<QPair<QByteArray, QByteArray>> headers;
+        QByteArray body;
+        QGrpcStatus::StatusCode expectedStatus;
+    };
+    const std::vector<InvalidReply> invalidReplies = {
+        //Unary reply with more than one message
+        {{{"content-type", "application/grpc"}}, grpcFrame(message) + grpcFrame(message), QGrpcStatus::Internal},
+        //Reply ended in the middle of frame
+        {{{"content-type", "application/grpc"}}, grpcFrame(message, false, message.size()), QGrpcStatus::Internal},
+        //Compressed message of unknown encoding
+        {{{"content-type", "application/grpc"}, {"grpc-encoding", "snappy"}}, grpcFrame(message, true), QGrpcStatus::Unimplemented}
+    };
+
+    for (const auto &invalidReply : invalidReplies) {
+        QTcpServer server;
+        ASSERT_TRUE(server.listen(QHostAddress::LocalHost));
+        serveHttp2Reply(server, invalidReply.headers, invalidReply.body);
+
+        TestServiceClient testClient;
+        testClient.attachChannel(std::make_shared<QGrpcHttp2Channel>(QUrl(QString("http://localhost:%1").arg(server.serverPort())),
+                                                                     QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials()));
+        SimpleStringMessage request;
+        request.setTestFieldString("Invalid reply");
+        QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+        EXPECT_EQ(invalidReply.expectedStatus, testClient.testMethod(request, result).code());
+        EXPECT_TRUE(result->testFieldString().isEmpty());
+        delete result;
+    }
+}
+
+//Returns gRPC-Web trailers frame, that carries \a trailers encoded like HTTP/1.1 header fields
+static QByteArray grpcWebTrailers(const QByteArray &trailers)
+{
+    QByteArray frame = grpcFrame(trailers);
+    frame[0] = static_cast<char>(0x80);
+    return frame;
+}
+
+//Emulates gRPC-Web proxy, that answers request with \a headers and response body. Body is sent by \a parts
+//100 ms apart, request of client is stored to \a request
+static void serveGrpcWebReply(QTcpServer &proxy, const QByteArray &headers, const QList<QByteArray> &parts, QByteArray &request)
+{
+    QObject::connect(&proxy, &QTcpServer::newConnection, &proxy, [&proxy, &request, headers, parts] {
+        QTcpSocket *socket = proxy.nextPendingConnection();
+        QObject::connect(socket, &QTcpSocket::readyRead, socket, [socket, &request, headers, parts] {
+            request += socket->readAll();
+            if (!request.contains("\r\n\r\n")) {
+                return;
+            }
+            int contentLength = 0;
+            for (const auto &part : parts) {
+                contentLength += part.size();
+            }
+            socket->write("HTTP/1.1 200 OK\r\ncontent-type: application/grpc-web+proto\r\n" + headers
+                          + "connection: close\r\ncontent-length: " + QByteArray::number(contentLength) + "\r\n\r\n");
+            for (int i = 0; i < parts.size(); ++i) {
+                QTimer::singleShot(i * 100, socket, [socket, part = parts[i], last = i == parts.size() - 1] {
+                    socket->write(part);
+                    if (last) {
+                        socket->disconnectFromHost();
+                    }
+                });
+            }
+            if (parts.isEmpty()) {
+                socket->disconnectFromHost();
+            }
+        });
+        QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+    });
+}
+
+TEST_F(ClientTest, WebChannelTest)
+{
+    //gRPC-Web proxy is emulated by server, that answers with message frame and trailers frame in response body
+    QProtobufSerializer serializer;
+    SimpleStringMessage response;
+    response.setTestFieldString("gRPC-Web");
+    const QByteArray body = grpcFrame(response.serialize(&serializer)) + grpcWebTrailers("grpc-status:0\r\ngrpc-message:OK\r\n");
+
+    QTcpServer proxy;
+    ASSERT_TRUE(proxy.listen(QHostAddress::LocalHost));
+    QByteArray request;
+    serveGrpcWebReply(proxy, {}, {body}, request);
+
+    auto channel = std::make_shared<QGrpcWebChannel>(QUrl(QString("http://localhost:%1").arg(proxy.serverPort())),
+                                                     QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials());
+    ASSERT_EQ(QByteArray("application/grpc-web+proto"), channel->contentType());
+    TestServiceClient testClient;
+    testClient.attachChannel(channel);
+
+    SimpleStringMessage arg;
+    arg.setTestFieldString("Web");
+    QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+    ASSERT_TRUE(testClient.testMethod(arg, result) == QGrpcStatus::Ok);
+    EXPECT_STREQ("gRPC-Web", result->testFieldString().toStdString().c_str());
+    EXPECT_TRUE(request.startsWith("POST /qtprotobufnamespace.tests.TestService/testMethod "));
+    EXPECT_TRUE(request.toLower().contains("content-type: application/grpc-web+proto"));
+    delete result;
+}
+
+TEST_F(ClientTest, WebChannelStreamTest)
+{
+    //Every message frame of stream is sent by proxy separately
+    QProtobufSerializer serializer;
+    QList<QByteArray> parts;
+    for (int i = 1; i <= 3; ++i) {
+        parts.append(grpcFrame(SimpleStringMessage(QString("Web%1").arg(i)).serialize(&serializer)));
+    }
+    parts.append(grpcWebTrailers("grpc-status:0\r\n"));
+
+    QTcpServer proxy;
+    ASSERT_TRUE(proxy.listen(QHostAddress::LocalHost));
+    QByteArray request;
+    serveGrpcWebReply(proxy, {}, parts, request);
+
+    TestServiceClient testClient;
+    testClient.attachChannel(std::make_shared<QGrpcWebChannel>(QUrl(QString("http://localhost:%1").arg(proxy.serverPort())),
+                                                               QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials()));
+    SimpleStringMessage arg;
+    arg.setTestFieldString("Web");
+    QStringList results;
+    QList<qint64> receivedAt;
+    int messagesBeforeFinish = -1;
+    bool failed = false;
+    QElapsedTimer timer;
+    timer.start();
+    QEventLoop waiter;
+    auto stream = testClient.subscribeTestMethodServerStream(arg);
+    QObject::connect(stream.get(), &QGrpcStream::messageReceived, &waiter, [&results, &receivedAt, &timer, stream] {
+        results.append(stream->read<SimpleStringMessage>().testFieldString());
+        receivedAt.append(timer.elapsed());
+    });
+    QObject::connect(stream.get(), &QGrpcStream::finished, &waiter, [&results, &messagesBeforeFinish, &waiter] {
+        messagesBeforeFinish = results.size();
+        waiter.quit();
+    });
+    QObject::connect(stream.get(), &QGrpcStream::error, &waiter, [&failed, &waiter] {
+        failed = true;
+        waiter.quit();
+    });
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+
+    ASSERT_FALSE(failed);
+    ASSERT_EQ(3, messagesBeforeFinish);
+    ASSERT_EQ((QStringList{"Web1", "Web2", "Web3"}), results);
+    //Messages are delivered while response body is still arriving, frames are sent 100 ms apart
+    ASSERT_GE(receivedAt[2] - receivedAt[0], 150);
+    EXPECT_TRUE(request.startsWith("POST /qtprotobufnamespace.tests.TestService/testMethodServerStream "));
+}
+
+TEST_F(ClientTest, WebChannelStatusTest)
+{
+    struct StatusReply {
+        QByteArray headers;
+        QByteArray body;
+        QGrpcStatus::StatusCode expectedStatus;
+        QString expectedMessage;
+    };
+    const std::vector<StatusReply> statusReplies = {
+        //Trailers-only response, status is sent in headers and body is empty
+        {"grpc-status: 5\r\ngrpc-message: Not%20found\r\n", {}, QGrpcStatus::NotFound, "Not found"},
+        //Error status in trailers frame of body
+        {{}, grpcWebTrailers("grpc-status:7\r\ngrpc-message:Denied\r\n"), QGrpcStatus::PermissionDenied, "Denied"}
+    };
+
+    for (const auto &statusReply : statusReplies) {
+        QTcpServer proxy;
+        ASSERT_TRUE(proxy.listen(QHostAddress::LocalHost));
+        QByteArray request;
+        serveGrpcWebReply(proxy, statusReply.headers, {statusReply.body}, request);
+
+        TestServiceClient testClient;
+        testClient.attachChannel(std::make_shared<QGrpcWebChannel>(QUrl(QString("http://localhost:%1").arg(proxy.serverPort())),
+                                                                   QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials()));
+        SimpleStringMessage arg;
+        arg.setTestFieldString("Web");
+        QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+        const QGrpcStatus status = testClient.testMethod(arg, result);
+        EXPECT_EQ(statusReply.expectedStatus, status.code());
+        EXPECT_EQ(statusReply.expectedMessage, status.message());
+        EXPECT_TRUE(result->testFieldString().isEmpty());
+        delete result;
+    }
+}
+
+TEST_F(ClientTest, InProcessChannelTest)
+{
+    auto channel = std::make_shared<QGrpcInProcessChannel>();
+    channel->registerMethod<SimpleStringMessage, SimpleStringMessage>("qtprotobufnamespace.tests.TestService", "testMethod",
+        [](const SimpleStringMessage &arg, SimpleStringMessage &ret) {
+            ret.setTestFieldString(arg.testFieldString());
+            return QGrpcStatus{QGrpcStatus::Ok};
+        });
+    TestServiceClient testClient;
+    testClient.attachChannel(channel);
+
+    SimpleStringMessage request;
+    QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+    request.setTestFieldString("In-process");
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_STREQ(result->testFieldString().toStdString().c_str(), "In-process");
+
+    QEventLoop waiter;
+    QGrpcAsyncReplyShared reply = testClient.testMethod(request);
+    SimpleStringMessage asyncResult;
+    QObject::connect(reply.get(), &QGrpcAsyncReply::finished, &m_app, [reply, &asyncResult, &waiter]() {
+        asyncResult = reply->read<SimpleStringMessage>();
+        waiter.quit();
+    });
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+    ASSERT_STREQ(asyncResult.testFieldString().toStdString().c_str(), "In-process");
+
+    channel->unregisterMethod("qtprotobufnamespace.tests.TestService", "testMethod");
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Unimplemented);
+    delete result;
+}
+
+TEST_F(ClientTest, InProcessServiceTest)
+{
+    class TestServiceImpl : public TestServiceServer {
+    public:
+        QGrpcStatus testMethod(const SimpleStringMessage &arg, SimpleStringMessage &ret) override {
+            ret.setTestFieldString(arg.testFieldString());
+            return QGrpcStatus{QGrpcStatus::Ok};
+        }
+        QGrpcStatus testMethodStatusMessage(const SimpleStringMessage &arg, SimpleStringMessage &) override {
+            return QGrpcStatus{QGrpcStatus::Internal, arg.testFieldString()};
+        }
+        QGrpcStatus testMethodNonCompatibleArgRet(const SimpleIntMessage &, SimpleStringMessage &) override {
+            return QGrpcStatus{QGrpcStatus::Unimplemented};
+        }
+    };
+
+    TestServiceImpl service;
+    ASSERT_EQ(3, service.methods().size());
+
+    auto channel = std::make_shared<QGrpcInProcessChannel>();
+    channel->registerService(&service);
+    TestServiceClient testClient;
+    testClient.attachChannel(channel);
+
+    SimpleStringMessage request;
+    QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+    request.setTestFieldString("Served");
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_STREQ(result->testFieldString().toStdString().c_str(), "Served");
+
+    QGrpcStatus status = testClient.testMethodStatusMessage(request, result);
+    ASSERT_EQ(QGrpcStatus::Internal, status.code());
+    ASSERT_STREQ(status.message().toStdString().c_str(), "Served");
+    delete result;
+}
+
+TEST_F(ClientTest, AsyncCallCredentialsTest)
+{
+    std::atomic<int> fetchCount(0);
+    QGrpcAsyncCallCredentials callCredentials([&fetchCount](QGrpcCredentialMap &credentials, std::chrono::milliseconds &validity) {
+        ++fetchCount;
+        QThread::msleep(50);
+        credentials = {{QLatin1String("authorization"), QVariant::fromValue(QByteArray("Bearer token"))}};
+        validity = std::chrono::milliseconds(500);
+        return true;
+    }, std::chrono::milliseconds(200));
+
+    TestServiceClient testClient;
+    testClient.attachChannel(std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, callCredentials | QGrpcInsecureChannelCredentials()));
+    SimpleStringMessage request;
+    QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+    request.setTestFieldString("Hello beach!");
+
+    //The first call waits for credentials
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_TRUE(callCredentials.isValid());
+    ASSERT_EQ(1, fetchCount.load());
+
+    //Credentials are refreshed ahead of expiry, calls are not blocked by refresh
+    QThread::msleep(350);
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+    QThread::msleep(100);
+    ASSERT_EQ(2, fetchCount.load());
+    ASSERT_TRUE(callCredentials.isValid());
+    delete result;
+}
+
+#ifdef QT_PROTOBUF_NATIVE_GRPC_CHANNEL
+TEST_F(ClientTest, NativeServerTest)
+{
+    class TestServiceImpl : public TestServiceServer {
+    public:
+        QGrpcStatus testMethod(const SimpleStringMessage &arg, SimpleStringMessage &ret) override {
+            ret.setTestFieldString(arg.testFieldString());
+            return QGrpcStatus{QGrpcStatus::Ok};
+        }
+        QGrpcStatus testMethodStatusMessage(const SimpleStringMessage &arg, SimpleStringMessage &) override {
+            return QGrpcStatus{QGrpcStatus::Internal, arg.testFieldString()};
+        }
+        QGrpcStatus testMethodNonCompatibleArgRet(const SimpleIntMessage &, SimpleStringMessage &) override {
+            return QGrpcStatus{QGrpcStatus::Unimplemented};
+        }
+    };
+
+    TestServiceImpl service;
+    QGrpcServer server(2);
+    server.addService(&service);
+    ASSERT_TRUE(server.start("localhost:50053", grpc::InsecureServerCredentials()));
+    ASSERT_TRUE(server.isRunning());
+
+    TestServiceClient testClient;
+    testClient.attachChannel(std::make_shared<QGrpcChannel>(QUrl("localhost:50053"), grpc::InsecureChannelCredentials()));
+
+    SimpleStringMessage request;
+    QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+    request.setTestFieldString("Served");
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_STREQ(result->testFieldString().toStdString().c_str(), "Served");
+
+    QGrpcStatus status = testClient.testMethodStatusMessage(request, result);
+    ASSERT_EQ(QGrpcStatus::Internal, status.code());
+    ASSERT_STREQ(status.message().toStdString().c_str(), "Served");
+
+    server.shutdown();
+    ASSERT_FALSE(server.isRunning());
+    delete result;
+}
+
+TEST_F(ClientTest, NativeChannelOptionsTest)
+{
+    grpc::ChannelArguments arguments;
+    arguments.SetMaxSendMessageSize(1024);
+    auto channel = std::make_shared<QGrpcChannel>(m_echoServerAddressNative, grpc::InsecureChannelCredentials(), arguments);
+    ASSERT_EQ(0, channel->defaultDeadline().count());
+    ASSERT_EQ(GRPC_COMPRESS_NONE, channel->defaultCompression());
+    ASSERT_FALSE(channel->isWaitForReady());
+
+    channel->setDefaultDeadline(std::chrono::milliseconds(200));
+    channel->setDefaultCompression(GRPC_COMPRESS_GZIP);
+    channel->setWaitForReady(true);
+    ASSERT_EQ(200, channel->defaultDeadline().count());
+    ASSERT_EQ(GRPC_COMPRESS_GZIP, channel->defaultCompression());
+    ASSERT_TRUE(channel->isWaitForReady());
+
+    TestServiceClient testClient;
+    testClient.attachChannel(channel);
+    SimpleStringMessage request;
+    QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+
+    request.setTestFieldString("Hello beach!");
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_STREQ(result->testFieldString().toStdString().c_str(), "Hello beach!");
+
+    //Deadline of channel aborts call
+    request.setTestFieldString("sleep");
+    ASSERT_EQ(QGrpcStatus::DeadlineExceeded, testClient.testMethod(request, result).code());
+
+    //Message exceeds send limit of channel arguments
+    request.setTestFieldString(QString(4096, 'a'));
+    ASSERT_EQ(QGrpcStatus::ResourceExhausted, testClient.testMethod(request, result).code());
+
+    QtProtobuf::QGrpcCallOptions options;
+    options.setWaitForReady(false);
+    ASSERT_FALSE(options.isEmpty());
+    ASSERT_TRUE(options.hasWaitForReady());
+    ASSERT_FALSE(options.waitForReady());
+    delete result;
+}
+#endif
+
+TEST_F(ClientTest, Http2FlowControlTest)
+{
+    auto channel = std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials());
+    channel->setStreamReceiveWindowSize(1024 * 1024);
+    channel->setSessionReceiveWindowSize(4 * 1024 * 1024);
+    channel->setMaxFrameSize(65536);
+    ASSERT_EQ(1024 * 1024, channel->streamReceiveWindowSize());
+    ASSERT_EQ(4 * 1024 * 1024, channel->sessionReceiveWindowSize());
+    ASSERT_EQ(65536, channel->maxFrameSize());
+    ASSERT_EQ(1024 * 1024, channel->autoTunedWindowSize());
+
+    channel->setWindowAutoTuningEnabled(true);
+    ASSERT_TRUE(channel->isWindowAutoTuningEnabled());
+    //Configured window is minimal window of auto-tuning
+    ASSERT_EQ(1024 * 1024, channel->autoTunedWindowSize());
+
+    TestServiceClient testClient;
+    testClient.attachChannel(channel);
+    SimpleStringMessage request;
+    QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+    request.setTestFieldString(QString(256 * 1024, 'a'));
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_EQ(request.testFieldString(), result->testFieldString());
+    delete result;
+}
+
+TEST_F(ClientTest, Http2FlowControlSettingsTest)
+{
+    QProtobufSerializer serializer;
+    SimpleStringMessage response;
+    response.setTestFieldString("Window");
+
+    //Configured windows are announced to server by SETTINGS and connection WINDOW_UPDATE frames
+    QHash<quint16, quint32> settings;
+    quint32 sessionWindowIncrement = 0;
+    QTcpServer server;
+    ASSERT_TRUE(server.listen(QHostAddress::LocalHost));
+    serveHttp2Reply(server, {{"content-type", "application/grpc"}}, grpcFrame(response.serialize(&serializer)),
+                    [&settings, &sessionWindowIncrement](quint8 type, quint32 streamId, const QByteArray &payload) {
+        if (type == 0x4) {
+            for (int i = 0; i + 6 <= payload.size(); i += 6) {
+                settings.insert(qFromBigEndian<quint16>(payload.constData() + i), qFromBigEndian<quint32>(payload.constData() + i + 2));
+            }
+        } else if (type == 0x8 && streamId == 0 && sessionWindowIncrement == 0) {
+            sessionWindowIncrement = qFromBigEndian<quint32>(payload.constData()) & 0x7fffffff;
+        }
+    });
+
+    auto channel = std::make_shared<QGrpcHttp2Channel>(QUrl(QString("http://localhost:%1").arg(server.serverPort())),
+                                                       QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials());
+    channel->setStreamReceiveWindowSize(1024 * 1024);
+    channel->setSessionReceiveWindowSize(4 * 1024 * 1024);
+    channel->setMaxFrameSize(65536);
+
+    TestServiceClient testClient;
+    testClient.attachChannel(channel);
+    SimpleStringMessage request;
+    request.setTestFieldString("Window");
+    QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_STREQ("Window", result->testFieldString().toStdString().c_str());
+    delete result;
+
+    //SETTINGS_INITIAL_WINDOW_SIZE
+    ASSERT_EQ(1024u * 1024u, settings.value(0x4));
+    //SETTINGS_MAX_FRAME_SIZE
+    ASSERT_EQ(65536u, settings.value(0x5));
+    //Connection window starts from default 65535 bytes defined by HTTP/2
+    ASSERT_EQ(4u * 1024u * 1024u - 65535u, sessionWindowIncrement);
+}
+
+TEST_F(ClientTest, IoThreadTest)
+{
+    auto channel = std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials());
+    ASSERT_FALSE(channel->isIoThreadEnabled());
+    channel->setConnectionCount(2);
+    channel->setIoThreadEnabled(true);
+    ASSERT_TRUE(channel->isIoThreadEnabled());
+    ASSERT_EQ(2, channel->connectionCount());
+
+    TestServiceClient testClient;
+    testClient.attachChannel(channel);
+    SimpleStringMessage request;
+    QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+    request.setTestFieldString("Hello beach!");
+    //Calling thread is blocked until call is completed in I/O thread
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_STREQ(result->testFieldString().toStdString().c_str(), "Hello beach!");
+    delete result;
+
+    //Messages are delivered in thread of stream
+    request.setTestFieldString("Stream");
+    QString streamResult;
+    bool inStreamThread = true;
+    QEventLoop waiter;
+    int i = 0;
+    auto stream = testClient.subscribeTestMethodServerStream(request);
+    QObject::connect(stream.get(), &QGrpcStream::messageReceived, &m_app, [&streamResult, &inStreamThread, &i, &waiter, stream]() {
+        inStreamThread &= QThread::currentThread() == stream->thread();
+        streamResult += stream->read<SimpleStringMessage>().testFieldString();
+        if (++i == 4) {
+            waiter.quit();
+        }
+    });
+
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+
+    ASSERT_EQ(i, 4);
+    ASSERT_TRUE(inStreamThread);
+    ASSERT_STREQ(streamResult.toStdString().c_str(), "Stream1Stream2Stream3Stream4");
+
+    channel->setIoThreadEnabled(false);
+    ASSERT_FALSE(channel->isIoThreadEnabled());
+    ASSERT_EQ(2, channel->connectionCount());
+}
+
+TEST_F(ClientTest, MetricsTest)
+{
+    auto metrics = std::make_shared<QGrpcMetrics>();
+    TestServiceClient testClient;
+    testClient.attachChannel(std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials()));
+    testClient.setMetrics(metrics);
+    ASSERT_EQ(metrics, testClient.metrics());
+
+    SimpleStringMessage request;
+    QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+    request.setTestFieldString("Measured");
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+    testClient.testMethodStatusMessage(request, result);
+
+    QEventLoop waiter;
+    QGrpcAsyncReplyShared reply = testClient.testMethod(request);
+    QObject::connect(reply.get(), &QGrpcAsyncReply::finished, &waiter, &QEventLoop::quit);
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+
+    QGrpcMethodMetrics *testMethodMetrics = metrics->method("qtprotobufnamespace.tests.TestService", "testMethod");
+    ASSERT_EQ(2u, testMethodMetrics->callCount());
+    ASSERT_EQ(2u, testMethodMetrics->statusCount(QGrpcStatus::Ok));
+    ASSERT_EQ(0, testMethodMetrics->inFlightCount());
+    ASSERT_GT(testMethodMetrics->requestBytes(), 0u);
+    ASSERT_EQ(testMethodMetrics->requestBytes(), testMethodMetrics->responseBytes());
+    ASSERT_GT(testMethodMetrics->latencySum().count(), 0);
+    ASSERT_GT(testMethodMetrics->latencyPercentile(50).count(), 0);
+
+    QGrpcMethodMetrics *statusMetrics = metrics->method("qtprotobufnamespace.tests.TestService", "testMethodStatusMessage");
+    ASSERT_EQ(1u, statusMetrics->callCount());
+    ASSERT_EQ(0u, statusMetrics->statusCount(QGrpcStatus::Ok));
+    ASSERT_EQ(2, metrics->methods().size());
+
+    QByteArray exported = metrics->toPrometheus();
+    ASSERT_TRUE(exported.contains("qtgrpc_client_started_total{grpc_service=\"qtprotobufnamespace.tests.TestService\",grpc_method=\"testMethod\"} 2\n"));
+    ASSERT_TRUE(exported.contains("qtgrpc_client_handled_total{grpc_service=\"qtprotobufnamespace.tests.TestService\",grpc_method=\"testMethod\",grpc_code=\"Ok\"} 2\n"));
+    ASSERT_TRUE(exported.contains("qtgrpc_client_handling_seconds_bucket{grpc_service=\"qtprotobufnamespace.tests.TestService\",grpc_method=\"testMethod\",le=\"+Inf\"} 2\n"));
+    delete result;
+}
+
+TEST_F(ClientTest, MetricsReleasedWhileCallPendingTest)
+{
+    auto metrics = std::make_shared<QGrpcMetrics>();
+    std::weak_ptr<QGrpcMetrics> weakMetrics = metrics;
+    TestServiceClient testClient;
+    testClient.attachChannel(std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials()));
+    testClient.setMetrics(metrics);
+
+    SimpleStringMessage request;
+    request.setTestFieldString("sleep");
+    QGrpcAsyncReplyShared reply = testClient.testMethod(request);
+
+    //Pending call keeps metrics alive, after they are detached from client
+    testClient.setMetrics(nullptr);
+    metrics.reset();
+    ASSERT_FALSE(weakMetrics.expired());
+
+    QEventLoop waiter;
+    QObject::connect(reply.get(), &QGrpcAsyncReply::finished, &waiter, &QEventLoop::quit);
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+    ASSERT_STREQ(reply->read<SimpleStringMessage>().testFieldString().toStdString().c_str(), "sleep");
+}
+
+TEST_F(ClientTest, TracerTest)
+{
+    class TestSpan : public QGrpcSpan {
+    public:
+        void addEvent(Event event) override {
+            QMutexLocker locker(&mutex);
+            events.append(event);
+        }
+        void finish(const QGrpcStatus &status) override {
+            QMutexLocker locker(&mutex);
+            finishedStatus = status.code();
+            ++finishCount;
+        }
+
+        QMutex mutex;
+        QList<Event> events;
+        QGrpcStatus::StatusCode finishedStatus = QGrpcStatus::Unknown;
+        int finishCount = 0;
+    };
+
+    class TestTracer : public QGrpcTracer {
+    public:
+        std::shared_ptr<QGrpcSpan> startSpan(const QString &service, const QString &method, QGrpcMetadata &metadata) override {
+            EXPECT_STREQ("qtprotobufnamespace.tests.TestService", service.toStdString().c_str());
+            methods.append(method);
+            context.child().inject(metadata);
+            injected = metadata;
+            span = std::make_shared<TestSpan>();
+            return span;
+        }
+
+        QGrpcTraceContext context = QGrpcTraceContext::generate();
+        QStringList methods;
+        QGrpcMetadata injected;
+        std::shared_ptr<TestSpan> span;
+    };
+
+    auto tracer = std::make_shared<TestTracer>();
+    TestServiceClient testClient;
+    testClient.attachChannel(std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials()));
+    testClient.setTracer(tracer);
+    ASSERT_EQ(tracer, testClient.tracer());
+
+    SimpleStringMessage request;
+    request.setTestFieldString("Traced");
+    QGrpcCallOptions options;
+    options.addMetadata("x-test", "value");
+    QGrpcAsyncReplyShared reply = testClient.testMethod(request, options);
+    ASSERT_EQ(QStringList{"testMethod"}, tracer->methods);
+    ASSERT_EQ(2, reply->options().metadata().size());
+    QGrpcTraceContext sent = QGrpcTraceContext::fromMetadata(reply->options().metadata());
+    ASSERT_TRUE(sent.isValid());
+    ASSERT_TRUE(sent.traceId() == tracer->context.traceId());
+    ASSERT_FALSE(sent.spanId() == tracer->context.spanId());
+
+    QString result;
+    QEventLoop waiter;
+    QObject::connect(reply.get(), &QGrpcAsyncReply::finished, &waiter, [reply, &result, &waiter] {
+        result = reply->read<SimpleStringMessage>().testFieldString();
+        waiter.quit();
+    });
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+
+    ASSERT_STREQ("Traced", result.toStdString().c_str());
+    std::shared_ptr<TestSpan> span = tracer->span;
+    QMutexLocker locker(&span->mutex);
+    ASSERT_EQ(1, span->finishCount);
+    ASSERT_EQ(QGrpcStatus::Ok, span->finishedStatus);
+    ASSERT_EQ((QList<QGrpcSpan::Event>{QGrpcSpan::RequestSent, QGrpcSpan::FirstByteReceived, QGrpcSpan::MessageReceived,
+                                       QGrpcSpan::MessageDelivered, QGrpcSpan::DeserializationStarted,
+                                       QGrpcSpan::DeserializationFinished}), span->events);
+}
+
+TEST_F(ClientTest, TraceContextTest)
+{
+    QGrpcTraceContext context(QByteArray::fromHex("4bf92f3577b34da6a3ce929d0e0e4736"), QByteArray::fromHex("00f067aa0ba902b7"));
+    ASSERT_TRUE(context.isValid());
+    ASSERT_STREQ("00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01", context.toTraceparent().constData());
+
+    QGrpcTraceContext parsed = QGrpcTraceContext::fromTraceparent("00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-00");
+    ASSERT_TRUE(parsed.isValid());
+    ASSERT_FALSE(parsed.isSampled());
+    ASSERT_TRUE(parsed.traceId() == context.traceId());
+
+    ASSERT_FALSE(QGrpcTraceContext::fromTraceparent("00-00000000000000000000000000000000-00f067aa0ba902b7-01").isValid());
+    ASSERT_FALSE(QGrpcTraceContext::fromTraceparent("00-4BF92F3577B34DA6A3CE929D0E0E4736-00f067aa0ba902b7-01").isValid());
+    ASSERT_FALSE(QGrpcTraceContext::fromTraceparent("01-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01").isValid());
+    ASSERT_FALSE(QGrpcTraceContext().isValid());
+
+    QGrpcMetadata metadata{{"traceparent", "invalid"}};
+    context.inject(metadata);
+    ASSERT_EQ(1, metadata.size());
+    ASSERT_TRUE(QGrpcTraceContext::fromMetadata(metadata).spanId() == context.spanId());
+    ASSERT_TRUE(context.child().traceId() == context.traceId());
+}
+
+TEST_F(ClientTest, InterceptorTest)
+{
+    class CountingInterceptor : public QGrpcClientInterceptor {
+    public:
+        void interceptCall(const QString &, const QString &method, const QByteArray &arg, const QGrpcCallOptions &options,
+                           const ResponseHandler &handler, const Next &next) override {
+            methods.append(method);
+            QGrpcCallOptions interceptedOptions(options);
+            interceptedOptions.addMetadata("x-intercepted", "1");
+            next(arg, interceptedOptions, [this, handler](const QGrpcStatus &status, const QByteArray &data, const QGrpcMetadata &metadata) {
+                ++responses;
+                handler(status, data, metadata);
+            });
+        }
+
+        QGrpcStatus interceptStream(const QString &, const QString &, QByteArray &arg) override {
+            SimpleStringMessage request;
+            request.setTestFieldString("Intercepted");
+            arg = request.serialize(&serializer);
+            return {};
+        }
+
+        bool interceptStreamMessage(const QString &, const QString &, QByteArray &) override {
+            //Second message of stream is dropped
+            return ++streamMessages != 2;
+        }
+
+        QProtobufSerializer serializer;
+        QStringList methods;
+        int responses = 0;
+        int streamMessages = 0;
+    };
+
+    class CachingInterceptor : public QGrpcClientInterceptor {
+    public:
+        void interceptCall(const QString &, const QString &, const QByteArray &arg, const QGrpcCallOptions &options,
+                           const ResponseHandler &handler, const Next &next) override {
+            auto it = cache.constFind(arg);
+            if (it != cache.constEnd()) {
+                ++hits;
+                handler({}, it.value(), {});
+                return;
+            }
+
+            EXPECT_TRUE(options.metadata().contains(qMakePair(QByteArray("x-intercepted"), QByteArray("1"))));
+            next(arg, options, [this, arg, handler](const QGrpcStatus &status, const QByteArray &data, const QGrpcMetadata &metadata) {
+                if (status.code() == QGrpcStatus::Ok) {
+                    cache.insert(arg, data);
+                }
+                handler(status, data, metadata);
+            });
+        }
+
+        QHash<QByteArray, QByteArray> cache;
+        int hits = 0;
+    };
+
+    auto counting = std::make_shared<CountingInterceptor>();
+    auto caching = std::make_shared<CachingInterceptor>();
+    TestServiceClient testClient;
+    testClient.attachChannel(std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials()));
+    testClient.addInterceptor(counting);
+    testClient.addInterceptor(caching);
+    ASSERT_EQ(2u, testClient.interceptors().size());
+
+    SimpleStringMessage request;
+    request.setTestFieldString("Cached");
+    for (int i = 0; i < 2; ++i) {
+        QString result;
+        QEventLoop waiter;
+        QGrpcAsyncReplyShared reply = testClient.testMethod(request);
+        QObject::connect(reply.get(), &QGrpcAsyncReply::finished, &waiter, [reply, &result, &waiter] {
+            result = reply->read<SimpleStringMessage>().testFieldString();
+            waiter.quit();
+        });
+        QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+        waiter.exec();
+        ASSERT_STREQ("Cached", result.toStdString().c_str());
+    }
+    ASSERT_EQ(1, caching->hits);
+    ASSERT_EQ(2, counting->responses);
+
+    QPointer<SimpleStringMessage> result(new SimpleStringMessage);
+    ASSERT_TRUE(testClient.testMethod(request, result) == QGrpcStatus::Ok);
+    ASSERT_STREQ("Cached", result->testFieldString().toStdString().c_str());
+    ASSERT_EQ(2, caching->hits);
+    ASSERT_EQ((QStringList{"testMethod", "testMethod", "testMethod"}), counting->methods);
+    delete result;
+
+    QString streamResult;
+    QEventLoop waiter;
+    auto stream = testClient.subscribeTestMethodServerStream(request);
+    int received = 0;
+    QObject::connect(stream.get(), &QGrpcStream::messageReceived, &waiter, [&streamResult, &received, &waiter, stream]() {
+        streamResult += stream->read<SimpleStringMessage>().testFieldString();
+        if (++received == 3) {
+            waiter.quit();
+        }
+    });
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+    ASSERT_EQ(4, counting->streamMessages);
+    ASSERT_STREQ("Intercepted1Intercepted3Intercepted4", streamResult.toStdString().c_str());
+
+    testClient.removeInterceptor(caching);
+    ASSERT_EQ(1u, testClient.interceptors().size());
+}
+
+TEST_F(ClientTest, RetryInterceptorTest)
+{
+    //Fails first attempts of every call with Unavailable
+    class FlakyInterceptor : public QGrpcClientInterceptor {
+    public:
+        void interceptCall(const QString &, const QString &, const QByteArray &arg, const QGrpcCallOptions &options,
+                           const ResponseHandler &handler, const Next &next) override {
+            ++attempts;
+            if (failures > 0) {
+                --failures;
+                handler({QGrpcStatus::Unavailable, QLatin1String("Flaky")}, {}, {});
+                return;
+            }
+            next(arg, options, handler);
+        }
+
+        int failures = 0;
+        int attempts = 0;
+    };
+
+    auto budget = std::make_shared<QGrpcRetryBudget>(6.0, 1.0);
+    auto retry = std::make_shared<QGrpcRetryInterceptor>(budget);
+    auto flaky = std::make_shared<FlakyInterceptor>();
+    retry->setRetryPolicy("qtprotobufnamespace.tests.TestService", "testMethod",
+                          std::make_shared<QGrpcRetryPolicy>(3, QList<QGrpcStatus::StatusCode>{QGrpcStatus::Unavailable},
+                                                             std::chrono::milliseconds(10), std::chrono::milliseconds(10), 1.0, 0.0));
+    ASSERT_TRUE(retry->retryPolicy("qtprotobufnamespace.tests.TestService", "testMethodBlobServerStream") == nullptr);
+
+    TestServiceClient testClient;
+    testClient.attachChannel(std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials()));
+    testClient.addInterceptor(retry);
+    testClient.addInterceptor(flaky);
+
+    SimpleStringMessage request;
+    request.setTestFieldString("Retried");
+    flaky->failures = 2;
+    QString result;
+    QEventLoop waiter;
+    QGrpcAsyncReplyShared reply = testClient.testMethod(request);
+    QObject::connect(reply.get(), &QGrpcAsyncReply::finished, &waiter, [reply, &result, &waiter] {
+        result = reply->read<SimpleStringMessage>().testFieldString();
+        waiter.quit();
+    });
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+    ASSERT_STREQ("Retried", result.toStdString().c_str());
+    ASSERT_EQ(3, flaky->attempts);
+    ASSERT_DOUBLE_EQ(5.0, budget->tokens());
+
+    //Synchronous calls are retried in calling thread
+    flaky->failures = 1;
+    flaky->attempts = 0;
+    QPointer<SimpleStringMessage> syncResult(new SimpleStringMessage);
+    ASSERT_TRUE(testClient.testMethod(request, syncResult) == QGrpcStatus::Ok);
+    ASSERT_STREQ("Retried", syncResult->testFieldString().toStdString().c_str());
+    ASSERT_EQ(2, flaky->attempts);
+    ASSERT_DOUBLE_EQ(5.0, budget->tokens());
+    delete syncResult;
+
+    //Retries stop once budget is drained below half
+    flaky->failures = 3;
+    flaky->attempts = 0;
+    ASSERT_TRUE(testClient.testMethod(request, syncResult) == QGrpcStatus::Unavailable);
+    ASSERT_EQ(2, flaky->attempts);
+    ASSERT_FALSE(budget->isRetryAllowed());
+}
+
+TEST_F(ClientTest, RetryHedgingTest)
+{
+    //Stalls first attempt of call on server, hedged attempts are passed as is
+    class StallingInterceptor : public QGrpcClientInterceptor {
+    public:
+        void interceptCall(const QString &, const QString &, const QByteArray &arg, const QGrpcCallOptions &options,
+                           const ResponseHandler &handler, const Next &next) override {
+            if (++attempts > 1) {
+                next(arg, options, handler);
+                return;
+            }
+            QProtobufSerializer serializer;
+            std::shared_ptr<int> guard = std::make_shared<int>(0);
+            stalledGuard = guard;
+            next(SimpleStringMessage("sleep").serialize(&serializer), options, [this, handler, guard](const QGrpcStatus &status, const QByteArray &data, const QGrpcMetadata &metadata) {
+                ++stalledResponses;
+                handler(status, data, metadata);
+            });
+        }
+
+        int attempts = 0;
+        int stalledResponses = 0;
+        //Expires once stalled attempt is released by client
+        std::weak_ptr<int> stalledGuard;
+    };
+
+    auto budget = std::make_shared<QGrpcRetryBudget>(6.0, 1.0);
+    auto retry = std::make_shared<QGrpcRetryInterceptor>(budget);
+    auto stalling = std::make_shared<StallingInterceptor>();
+    auto policy = std::make_shared<QGrpcRetryPolicy>(2, QList<QGrpcStatus::StatusCode>{}, std::chrono::milliseconds(10),
+                                                     std::chrono::milliseconds(10), 1.0, 0.0);
+    policy->setHedgingEnabled(true, std::chrono::milliseconds(200));
+    retry->setRetryPolicy("qtprotobufnamespace.tests.TestService", "testMethod", policy);
+
+    TestServiceClient testClient;
+    testClient.attachChannel(std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials()));
+    testClient.addInterceptor(retry);
+    testClient.addInterceptor(stalling);
+
+    SimpleStringMessage request;
+    request.setTestFieldString("Hedged");
+    QString result;
+    int finished = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QEventLoop waiter;
+    QGrpcAsyncReplyShared reply = testClient.testMethod(request);
+    QObject::connect(reply.get(), &QGrpcAsyncReply::finished, &waiter, [reply, &result, &finished, &waiter] {
+        result = reply->read<SimpleStringMessage>().testFieldString();
+        ++finished;
+        waiter.quit();
+    });
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+    ASSERT_STREQ("Hedged", result.toStdString().c_str());
+    ASSERT_EQ(2, stalling->attempts);
+    //Server replies to stalled attempt after 1 second
+    ASSERT_LT(timer.elapsed(), 1000);
+
+    //Stalled attempt is cancelled, so its response never reaches interceptors
+    QTimer::singleShot(1500, &waiter, &QEventLoop::quit);
+    waiter.exec();
+    ASSERT_EQ(0, stalling->stalledResponses);
+    ASSERT_TRUE(stalling->stalledGuard.expired());
+    ASSERT_EQ(1, finished);
+    ASSERT_EQ(2, stalling->attempts);
+}
+
+TEST_F(ClientTest, RetryPolicyTest)
+{
+    std::chrono::milliseconds delay(0);
+    QGrpcRetryPolicy policy(3, {QGrpcStatus::Unavailable, QGrpcStatus::ResourceExhausted},
+                            std::chrono::milliseconds(100), std::chrono::milliseconds(150), 2.0, 0.0);
+    ASSERT_TRUE(policy.retryDelay(1, QGrpcStatus(QGrpcStatus::Unavailable), delay));
+    ASSERT_EQ(std::chrono::milliseconds(100), delay);
+    ASSERT_TRUE(policy.retryDelay(2, QGrpcStatus(QGrpcStatus::ResourceExhausted), delay));
+    ASSERT_EQ(std::chrono::milliseconds(150), delay);
+    ASSERT_FALSE(policy.retryDelay(3, QGrpcStatus(QGrpcStatus::Unavailable), delay));
+    ASSERT_FALSE(policy.retryDelay(1, QGrpcStatus(QGrpcStatus::InvalidArgument), delay));
+
+    ASSERT_FALSE(policy.isHedgingEnabled());
+    policy.setHedgingEnabled(true);
+    ASSERT_TRUE(policy.isHedgingEnabled());
+    ASSERT_EQ(std::chrono::milliseconds(0), policy.hedgingDelay());
+    ASSERT_DOUBLE_EQ(95.0, policy.hedgingPercentile());
+
+    QGrpcRetryBudget budget(4.0, 0.5);
+    ASSERT_TRUE(budget.isRetryAllowed());
+    budget.recordFailure();
+    ASSERT_TRUE(budget.isRetryAllowed());
+    budget.recordFailure();
+    ASSERT_FALSE(budget.isRetryAllowed());
+    budget.recordSuccess();
+    ASSERT_TRUE(budget.isRetryAllowed());
+    ASSERT_DOUBLE_EQ(2.5, budget.tokens());
+}
+
+TEST_F(ClientTest, ReconnectPolicyTest)
+{
+    std::chrono::milliseconds delay(0);
+    QGrpcReconnectPolicy policy(std::chrono::milliseconds(100), std::chrono::milliseconds(300), 2.0, 0.0, 4);
+    QGrpcStatus status(QGrpcStatus::Unavailable);
+    ASSERT_TRUE(policy.reconnectDelay(1, status, delay));
+    ASSERT_EQ(std::chrono::milliseconds(100), delay);
+    ASSERT_TRUE(policy.reconnectDelay(2, status, delay));
+    ASSERT_EQ(std::chrono::milliseconds(200), delay);
+    ASSERT_TRUE(policy.reconnectDelay(4, status, delay));
+    ASSERT_EQ(std::chrono::milliseconds(300), delay);
+    ASSERT_FALSE(policy.reconnectDelay(5, status, delay));
+
+    QGrpcReconnectPolicy jitterPolicy(std::chrono::milliseconds(1000), std::chrono::milliseconds(1000), 1.0, 0.5);
+    for (int i = 1; i < 100; i++) {
+        ASSERT_TRUE(jitterPolicy.reconnectDelay(i, status, delay));
+        ASSERT_GE(delay.count(), 500);
+        ASSERT_LE(delay.count(), 1500);
+    }
+}
+
+TEST_F(ClientTest, StreamReconnectDisabledTest)
+{
+    auto channel = std::make_shared<QGrpcHttp2Channel>(QUrl("http://localhost:50050", QUrl::StrictMode), QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials());
+    channel->setReconnectPolicy(nullptr);
+    TestServiceClient testClient;
+    testClient.attachChannel(channel);
+
+    SimpleStringMessage request;
+    request.setTestFieldString("Stream");
+
+    int errors = 0;
+    auto stream = testClient.subscribeTestMethodServerStream(request);
+    QObject::connect(stream.get(), &QGrpcStream::error, &m_app, [&errors]() {
+        ++errors;
+    });
+
+    QEventLoop waiter;
+    QTimer::singleShot(3000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+
+    ASSERT_EQ(1, errors);
+
+    //Stream policy overrides policy of channel
+    stream->setReconnectPolicy(std::make_shared<QGrpcReconnectPolicy>());
+    ASSERT_TRUE(stream->reconnectPolicy() != nullptr);
+}
+
+TEST_F(ClientTest, StreamResumeTest)
+{
+    auto channel = std::make_shared<QGrpcHttp2Channel>(QUrl("http://localhost:50050", QUrl::StrictMode), QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials());
+    channel->setReconnectPolicy(std::make_shared<QGrpcReconnectPolicy>(std::chrono::milliseconds(100), std::chrono::milliseconds(100), 1.0, 0.0, 2));
+    TestServiceClient testClient;
+    testClient.attachChannel(channel);
+
+    SimpleStringMessage request;
+    request.setTestFieldString("Stream");
+
+    int resumeCount = 0;
+    auto stream = testClient.subscribeTestMethodServerStream(request);
+    stream->setResumeHandler<SimpleStringMessage, SimpleStringMessage>([&resumeCount](SimpleStringMessage &arg, const SimpleStringMessage &lastMessage) {
+        ++resumeCount;
+        //No messages are received from unavailable server
+        ASSERT_TRUE(lastMessage.testFieldString().isEmpty());
+        arg.setTestFieldString(arg.testFieldString() + "+");
+    });
+
+    QEventLoop waiter;
+    QTimer::singleShot(3000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+
+    //Stream is restored twice with argument updated by resume handler
+    ASSERT_EQ(2, resumeCount);
+    QProtobufSerializer serializer;
+    SimpleStringMessage resumed;
+    resumed.deserialize(&serializer, stream->arg());
+    ASSERT_STREQ("Stream++", resumed.testFieldString().toStdString().c_str());
+}
+
+TEST_F(ClientTest, KeepaliveStreamTest)
+{
+    auto channel = std::make_shared<QGrpcHttp2Channel>(m_echoServerAddress, QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials());
+    ASSERT_EQ(std::chrono::milliseconds::zero(), channel->keepaliveInterval());
+    ASSERT_EQ(std::chrono::milliseconds(20000), channel->keepaliveTimeout());
+    //Server sends stream messages once a second, so connection is probed between messages
+    channel->setKeepaliveInterval(std::chrono::milliseconds(300));
+    channel->setKeepaliveTimeout(std::chrono::milliseconds(2000));
+    channel->setIdleTimeout(std::chrono::milliseconds(200));
+    TestServiceClient testClient;
+    testClient.attachChannel(channel);
+
+    SimpleStringMessage result;
+    SimpleStringMessage request;
+    request.setTestFieldString("Stream");
+
+    QEventLoop waiter;
+    int i = 0;
+    auto stream = testClient.subscribeTestMethodServerStream(request);
+    QObject::connect(stream.get(), &QGrpcStream::messageReceived, &m_app, [&result, &i, &waiter, stream]() {
+        SimpleStringMessage ret = stream->read<SimpleStringMessage>();
+        result.setTestFieldString(result.testFieldString() + ret.testFieldString());
+        if (++i == 4) {
+            waiter.quit();
+        }
+    });
+
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+
+    ASSERT_EQ(i, 4);
+    ASSERT_STREQ(result.testFieldString().toStdString().c_str(), "Stream1Stream2Stream3Stream4");
+
+    //Idle connection is established again
+    QPointer<SimpleStringMessage> echo(new SimpleStringMessage);
+    QTimer::singleShot(1000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+    ASSERT_TRUE(testClient.testMethod(request, echo) == QGrpcStatus::Ok);
+    ASSERT_STREQ(echo->testFieldString().toStdString().c_str(), "Stream");
+    delete echo;
+}
+
 TEST_F(ClientTest, AttachChannelThreadTest)
 {
     ::testing::FLAGS_gtest_death_test_style = "threadsafe";
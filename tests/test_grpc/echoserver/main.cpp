@@ -57,6 +57,30 @@ public:
         return ::grpc::Status();
     }
 
+    ::grpc::Status testMethodClientStream(grpc::ServerContext *, ::grpc::ServerReader<qtprotobufnamespace::tests::SimpleStringMessage> *reader,
+                                          qtprotobufnamespace::tests::SimpleStringMessage *response) override
+    {
+        std::cerr << "testMethodClientStream called" << std::endl;
+        qtprotobufnamespace::tests::SimpleStringMessage msg;
+        std::string result;
+        while (reader->Read(&msg)) {
+            result += msg.testfieldstring();
+        }
+        response->set_testfieldstring(result);
+        return ::grpc::Status();
+    }
+
+    ::grpc::Status testMethodBiStream(grpc::ServerContext *,
+                                      ::grpc::ServerReaderWriter<qtprotobufnamespace::tests::SimpleStringMessage, qtprotobufnamespace::tests::SimpleStringMessage> *stream) override
+    {
+        std::cerr << "testMethodBiStream called" << std::endl;
+        qtprotobufnamespace::tests::SimpleStringMessage msg;
+        while (stream->Read(&msg)) {
+            stream->Write(msg);
+        }
+        return ::grpc::Status();
+    }
+
     ::grpc::Status testMethodStatusMessage(::grpc::ServerContext*,
                                                    const ::qtprotobufnamespace::tests::SimpleStringMessage* request,
                                                    ::qtprotobufnamespace::tests::SimpleStringMessage*) override
@@ -23,15 +23,17 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
-#include "testserviceserver.h"
+#include "testservice_grpc.qpb.h"
 
 #include <gtest/gtest.h>
 
 using namespace qtprotobufnamespace::tests;
-using namespace qtprotobuf;
+using namespace QtProtobuf;
 
 class TestServiceServerImpl : public TestServiceServer {
-    SimpleStringMessage testMethod(const SimpleStringMessage &) override { return SimpleStringMessage(); }
+    QGrpcStatus testMethod(const SimpleStringMessage &, SimpleStringMessage &) override { return QGrpcStatus{QGrpcStatus::Ok}; }
+    QGrpcStatus testMethodStatusMessage(const SimpleStringMessage &, SimpleStringMessage &) override { return QGrpcStatus{QGrpcStatus::Ok}; }
+    QGrpcStatus testMethodNonCompatibleArgRet(const SimpleIntMessage &, SimpleStringMessage &) override { return QGrpcStatus{QGrpcStatus::Ok}; }
 };
 
 class ServerTest : public ::testing::Test
@@ -40,5 +42,6 @@ class ServerTest : public ::testing::Test
 
 TEST_F(ServerTest, CheckMethodsGeneration)
 {
-//    TestServiceServerImpl testServer;
+    TestServiceServerImpl testServer;
+    ASSERT_EQ(3, testServer.methods().size());
 }
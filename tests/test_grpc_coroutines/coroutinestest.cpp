@@ -0,0 +1,130 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "testservice_grpc.qpb.h"
+#include <QGrpcHttp2Channel>
+#include <QGrpcAwaitableReply>
+#include <QGrpcCredentials>
+#include <QGrpcInsecureCredentials>
+
+#include <QTimer>
+#include <QEventLoop>
+#include <QCoreApplication>
+
+#include <coroutine>
+#include <exception>
+
+#include <gtest/gtest.h>
+
+using namespace qtprotobufnamespace::tests;
+using namespace QtProtobuf;
+
+namespace {
+//Coroutine that starts immediately and is owned by nobody, frame is released once coroutine is finished
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+DetachedTask awaitEcho(TestServiceClient &client, QString value, QGrpcAwaitResult<SimpleStringMessage> &result,
+                       bool &finished, QEventLoop &waiter)
+{
+    SimpleStringMessage request;
+    request.setTestFieldString(value);
+    result = co_await client.testMethodAwaitable(request);
+    finished = true;
+    waiter.quit();
+}
+
+DetachedTask awaitReply(const QGrpcAsyncReplyShared &reply, QGrpcAwaitResult<SimpleStringMessage> &result, bool &finished)
+{
+    result = co_await QGrpcAwaitableReply<SimpleStringMessage>(reply);
+    finished = true;
+}
+}
+
+class CoroutinesTest : public ::testing::Test
+{
+protected:
+    static void SetUpTestCase() {
+        QtProtobuf::qRegisterProtobufTypes();
+    }
+
+    void SetUp() override {
+        m_client.attachChannel(std::make_shared<QGrpcHttp2Channel>(QUrl("http://localhost:50051", QUrl::StrictMode),
+                                                                   QGrpcInsecureChannelCredentials() | QGrpcInsecureCallCredentials()));
+    }
+
+    TestServiceClient m_client;
+    static QCoreApplication m_app;
+    static int m_argc;
+};
+
+int CoroutinesTest::m_argc(0);
+QCoreApplication CoroutinesTest::m_app(m_argc, nullptr);
+
+TEST_F(CoroutinesTest, AwaitUnaryEchoTest)
+{
+    QEventLoop waiter;
+    QGrpcAwaitResult<SimpleStringMessage> result;
+    bool finished = false;
+    awaitEcho(m_client, "Awaited echo", result, finished, waiter);
+    //Coroutine is suspended until reply arrives
+    ASSERT_FALSE(finished);
+
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+
+    ASSERT_TRUE(finished);
+    ASSERT_TRUE(result.status == QGrpcStatus::Ok);
+    ASSERT_STREQ(result.message.testFieldString().toStdString().c_str(), "Awaited echo");
+}
+
+TEST_F(CoroutinesTest, AwaitFinishedReplyTest)
+{
+    SimpleStringMessage request;
+    request.setTestFieldString("Finished echo");
+    QGrpcAsyncReplyShared reply = m_client.testMethod(request);
+
+    QEventLoop waiter;
+    QObject::connect(reply.get(), &QGrpcAsyncReply::finished, &waiter, &QEventLoop::quit);
+    QTimer::singleShot(20000, &waiter, &QEventLoop::quit);
+    waiter.exec();
+    ASSERT_TRUE(reply->future().isFinished());
+
+    //Reply is finished already, so coroutine isn't suspended
+    QGrpcAwaitResult<SimpleStringMessage> result;
+    bool finished = false;
+    awaitReply(reply, result, finished);
+
+    ASSERT_TRUE(finished);
+    ASSERT_TRUE(result.status == QGrpcStatus::Ok);
+    ASSERT_STREQ(result.message.testFieldString().toStdString().c_str(), "Finished echo");
+}
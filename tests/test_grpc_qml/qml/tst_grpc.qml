@@ -87,6 +87,23 @@ TestCase {
         }
     }
 
+    GrpcStream {
+        id: serverStreamThrottled
+        property var values: []
+
+        enabled: false
+        throttleInterval: 2500
+        client: TestServiceClient
+        method: "testMethodServerStream"
+        argument: stringMsg
+        onMessageReceived: {
+            values.push(value.testFieldString);
+        }
+        onError: {
+            console.log("Stream error: " + status.code + " " + status.message)
+        }
+    }
+
     GrpcStream {
         id: serverStreamInvalid
         property bool ok: false
@@ -138,6 +155,23 @@ TestCase {
         compare(called && !errorCalled, true, "testMethod was not called proper way")
     }
 
+    function test_stringEchoReplyTest() {
+        stringMsg.testFieldString = "test_stringEchoReplyTest";
+        var results = [];
+        var errorCalled = false;
+        for (var i = 0; i < 3; i++) {
+            TestServiceClient.testMethodReply(stringMsg).then(function(result) {
+                results.push(result.testFieldString);
+            }, function(status) {
+                errorCalled = true
+            })
+        }
+        wait(300)
+        compare(errorCalled, false, "testMethodReply failed")
+        compare(results.length, 3, "testMethodReply callback was not called for each call")
+        compare(results[2], "test_stringEchoReplyTest", "testMethodReply result is invalid")
+    }
+
     function test_statusTest() {
         stringMsg.testFieldString = "test_statusTest";
         var called = false;
@@ -182,6 +216,16 @@ TestCase {
         compare(serverStreamCancel.updateCount, 3, "Stream failed, update was not called right amount times")
     }
 
+    function test_serverStreamThrottled() {
+        stringMsg.testFieldString = "test_serverStreamThrottled";
+        serverStreamThrottled.enabled = true;
+        wait(20000);
+        var values = serverStreamThrottled.values;
+        verify(values.length > 1 && values.length < 4, "Stream messages were not throttled")
+        compare(values[0], "test_serverStreamThrottled1", "First message was not delivered immediately")
+        compare(values[values.length - 1], "test_serverStreamThrottled4", "Latest message was not delivered before stream finished")
+    }
+
     function test_serverStreamInvalid() {
         serverStreamInvalid.enabled = true;
         wait(500);
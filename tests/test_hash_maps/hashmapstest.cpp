@@ -0,0 +1,145 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "hashmaps.qpb.h"
+
+#include <QProtobufSerializer>
+#include <qprotobufjsonserializer.h>
+
+#include <gtest/gtest.h>
+
+using namespace qtprotobufnamespace::hashmaps::tests;
+
+namespace QtProtobuf {
+namespace tests {
+
+class HashMapsTest : public ::testing::Test
+{
+public:
+    HashMapsTest() = default;
+    void SetUp() override;
+    static void SetUpTestCase();
+protected:
+    std::unique_ptr<QProtobufSerializer> serializer;
+};
+
+void HashMapsTest::SetUpTestCase()
+{
+    QtProtobuf::qRegisterProtobufTypes();
+}
+
+void HashMapsTest::SetUp()
+{
+    serializer.reset(new QProtobufSerializer);
+}
+
+TEST_F(HashMapsTest, FieldTypesTest)
+{
+    ASSERT_TRUE((std::is_same<Inventory::NamesEntry, QHash<QtProtobuf::sint32, QString>>::value));
+    ASSERT_TRUE((std::is_same<Inventory::PricesEntry, QHash<QString, QtProtobuf::sfixed64>>::value));
+    ASSERT_TRUE((std::is_same<Inventory::ItemsEntry, QHash<QString, QSharedPointer<Item>>>::value));
+}
+
+TEST_F(HashMapsTest, SerializationTest)
+{
+    Inventory test;
+    test.setNames({{10, {"ten"}}});
+    test.setPrices({{"a", 5}});
+    ASSERT_STREQ(test.serialize(serializer.get()).toHex().toStdString().c_str(),
+                 "0a070814120374656e120c0a0161110500000000000000");
+}
+
+TEST_F(HashMapsTest, DeterministicSerializationTest)
+{
+    ASSERT_FALSE(serializer->isDeterministicEnabled());
+    serializer->setDeterministicEnabled(true);
+
+    Inventory test;
+    test.setNames({{10, {"x"}}, {-1, {"m"}}, {2, {"t"}}});
+    test.setPrices({{"b", -7}, {"a", 5}});
+    ASSERT_STREQ(test.serialize(serializer.get()).toHex().toStdString().c_str(),
+                 "0a05080112016d0a0508041201740a050814120178120c0a0161110500000000000000120c0a016211f9ffffffffffffff");
+
+    //Map entries of message values are sorted by key too, regardless of hash layout
+    Inventory::ItemsEntry items;
+    Inventory::ItemsEntry reversedItems;
+    for (int i = 0; i < 100; ++i) {
+        items.insert(QString::number(i), QSharedPointer<Item>(new Item{1}));
+        reversedItems.insert(QString::number(99 - i), QSharedPointer<Item>(new Item{1}));
+    }
+    reversedItems.reserve(1024);
+    Inventory source;
+    source.setItems(items);
+    Inventory reversed;
+    reversed.setItems(reversedItems);
+    const QByteArray result = source.serialize(serializer.get());
+    ASSERT_TRUE(result == reversed.serialize(serializer.get()));
+    ASSERT_TRUE(result.startsWith(QByteArray::fromHex("1a070a0130120208021a070a013112020802")));
+}
+
+TEST_F(HashMapsTest, DeserializationTest)
+{
+    Inventory test;
+    test.deserialize(serializer.get(), QByteArray::fromHex("0a070814120374656e0a07080212036f6e65120c0a0161110500000000000000"));
+    ASSERT_TRUE(test.names() == Inventory::NamesEntry({{10, {"ten"}}, {1, {"one"}}}));
+    ASSERT_TRUE(test.prices() == Inventory::PricesEntry({{"a", 5}}));
+}
+
+TEST_F(HashMapsTest, LargeMapTest)
+{
+    Inventory::NamesEntry names;
+    Inventory::ItemsEntry items;
+    for (int i = 0; i < 10000; ++i) {
+        names.insert(i, QString::number(i));
+        items.insert(QString::number(i), QSharedPointer<Item>(new Item{i}));
+    }
+    Inventory source;
+    source.setNames(names);
+    source.setItems(items);
+
+    Inventory test;
+    test.deserialize(serializer.get(), source.serialize(serializer.get()));
+    ASSERT_EQ(10000, test.names().count());
+    ASSERT_TRUE(test.names() == names);
+    ASSERT_EQ(10000, test.items().count());
+    ASSERT_EQ(42, test.items().value("42")->count());
+    ASSERT_TRUE(test == source);
+}
+
+TEST_F(HashMapsTest, JsonTest)
+{
+    QProtobufJsonSerializer jsonSerializer;
+    Inventory source;
+    source.setNames({{10, {"ten"}}, {-1, {"minus one"}}});
+    source.setPrices({{"a", 5}, {"b", -7}});
+    source.setItems({{"item", QSharedPointer<Item>(new Item{3})}});
+
+    Inventory test;
+    test.deserialize(&jsonSerializer, source.serialize(&jsonSerializer));
+    ASSERT_TRUE(test == source);
+}
+
+} // tests
+} // QtProtobuf
@@ -0,0 +1,121 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "internedstrings.qpb.h"
+
+#include <QProtobufSerializer>
+
+#include <gtest/gtest.h>
+
+using namespace qtprotobufnamespace::internedstrings::tests;
+
+namespace QtProtobuf {
+namespace tests {
+
+class InternedStringsTest : public ::testing::Test
+{
+public:
+    InternedStringsTest() = default;
+    void SetUp() override;
+    static void SetUpTestCase();
+protected:
+    std::unique_ptr<QProtobufSerializer> serializer;
+    QByteArray series;
+};
+
+void InternedStringsTest::SetUpTestCase()
+{
+    QtProtobuf::qRegisterProtobufTypes();
+}
+
+void InternedStringsTest::SetUp()
+{
+    serializer.reset(new QProtobufSerializer);
+
+    Series source;
+    Series::SamplesRepeated samples;
+    for (int i = 0; i < 100; ++i) {
+        QSharedPointer<Sample> sample(new Sample);
+        sample->setUnit(i % 2 == 0 ? "celsius" : "kelvin");
+        sample->setHost("host");
+        sample->setTags({"indoor", "sensor"});
+        sample->setLabels({{"room", "kitchen"}});
+        sample->setValue(i);
+        samples.append(sample);
+    }
+    source.setSamples(samples);
+    series = source.serialize(serializer.get());
+}
+
+TEST_F(InternedStringsTest, DisabledByDefaultTest)
+{
+    ASSERT_FALSE(serializer->isStringInterningEnabled());
+
+    Series test;
+    test.deserialize(serializer.get(), series);
+    ASSERT_EQ(100, test.samples().count());
+    ASSERT_TRUE(test.samples()[0]->unit() == test.samples()[2]->unit());
+    ASSERT_FALSE(test.samples()[0]->unit().isSharedWith(test.samples()[2]->unit()));
+}
+
+TEST_F(InternedStringsTest, InternedFieldsTest)
+{
+    serializer->setStringInterningEnabled(true);
+    ASSERT_TRUE(serializer->isStringInterningEnabled());
+
+    Series test;
+    test.deserialize(serializer.get(), series);
+    ASSERT_EQ(100, test.samples().count());
+    const Sample &first = *test.samples()[0];
+    for (int i = 0; i < 100; ++i) {
+        const Sample &sample = *test.samples()[i];
+        ASSERT_TRUE(sample.unit() == (i % 2 == 0 ? "celsius" : "kelvin"));
+        ASSERT_TRUE(sample.unit().isSharedWith(test.samples()[i % 2]->unit()));
+        ASSERT_TRUE(sample.tags() == QStringList({"indoor", "sensor"}));
+        ASSERT_TRUE(sample.tags()[1].isSharedWith(first.tags()[1]));
+        ASSERT_TRUE(sample.labels().value("room").isSharedWith(first.labels().value("room")));
+        ASSERT_EQ(i, sample.value());
+    }
+
+    //Fields that are not marked for interning are decoded as usual
+    ASSERT_TRUE(first.host() == test.samples()[1]->host());
+    ASSERT_FALSE(first.host().isSharedWith(test.samples()[1]->host()));
+}
+
+TEST_F(InternedStringsTest, SeparateDeserializationsTest)
+{
+    serializer->setStringInterningEnabled(true);
+
+    //Interned strings are not kept between deserializations
+    Series first;
+    first.deserialize(serializer.get(), series);
+    Series second;
+    second.deserialize(serializer.get(), series);
+    ASSERT_TRUE(first == second);
+    ASSERT_FALSE(first.samples()[0]->unit().isSharedWith(second.samples()[0]->unit()));
+}
+
+} // tests
+} // QtProtobuf
@@ -0,0 +1,130 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "nativewellknown.qpb.h"
+
+#include <QProtobufSerializer>
+#include <qprotobufjsonserializer.h>
+#include <QtProtobufWellKnownTypes>
+
+#include <gtest/gtest.h>
+
+using namespace qtprotobufnamespace::nativewellknown::tests;
+
+namespace QtProtobuf {
+namespace tests {
+
+class NativeWellKnownTypesTest : public ::testing::Test
+{
+public:
+    NativeWellKnownTypesTest() = default;
+    void SetUp() override;
+    static void SetUpTestCase();
+protected:
+    std::unique_ptr<QProtobufSerializer> serializer;
+};
+
+void NativeWellKnownTypesTest::SetUpTestCase()
+{
+    QtProtobuf::qRegisterProtobufTypes();
+    QtProtobuf::qRegisterProtobufWellKnownTypes();
+}
+
+void NativeWellKnownTypesTest::SetUp()
+{
+    serializer.reset(new QProtobufSerializer);
+}
+
+TEST_F(NativeWellKnownTypesTest, FieldTypesTest)
+{
+    NativeWellKnownMessage test;
+    ASSERT_TRUE((std::is_same<decltype(test.testFieldTimestamp()), QDateTime>::value));
+    ASSERT_TRUE((std::is_same<decltype(test.testFieldDuration()), std::chrono::nanoseconds>::value));
+    ASSERT_TRUE((std::is_same<decltype(test.testFieldInt32()), QtProtobuf::Int32Optional>::value));
+    ASSERT_TRUE((std::is_same<decltype(test.testFieldString()), QtProtobuf::StringOptional>::value));
+
+    ASSERT_FALSE(test.testFieldTimestamp().isValid());
+    ASSERT_EQ(test.testFieldDuration().count(), 0);
+    ASSERT_FALSE(test.testFieldInt32().hasValue());
+    ASSERT_TRUE(test.serialize(serializer.get()).isEmpty());
+}
+
+TEST_F(NativeWellKnownTypesTest, SerializeTest)
+{
+    NativeWellKnownMessage test;
+    test.setTestFieldTimestamp(QDateTime::fromMSecsSinceEpoch(1500, Qt::UTC));
+    test.setTestFieldDuration(std::chrono::milliseconds(-2250));
+    test.setTestFieldInt32(QtProtobuf::Int32Optional(0));
+    test.setTestFieldString(QtProtobuf::StringOptional("abc"));
+
+    QByteArray result = test.serialize(serializer.get());
+    ASSERT_STREQ(result.toHex().toStdString().c_str(),
+                 "0a0808011080cab5ee01121608feffffffffffffffff0110809be588ffffffffff011a0022050a03616263");
+}
+
+TEST_F(NativeWellKnownTypesTest, DeserializeTest)
+{
+    NativeWellKnownMessage test;
+    test.deserialize(serializer.get(), QByteArray::fromHex("0a0808011080cab5ee01121608feffffffffffffffff0110809be588ffffffffff011a0022050a03616263"));
+    ASSERT_TRUE(test.testFieldTimestamp() == QDateTime::fromMSecsSinceEpoch(1500, Qt::UTC));
+    ASSERT_EQ(test.testFieldDuration().count(), -2250000000LL);
+    ASSERT_TRUE(test.testFieldInt32().hasValue());
+    ASSERT_EQ(test.testFieldInt32().value(), 0);
+    ASSERT_STREQ(test.testFieldString().value().toStdString().c_str(), "abc");
+}
+
+TEST_F(NativeWellKnownTypesTest, TimestampBeforeEpochTest)
+{
+    NativeWellKnownMessage test;
+    test.setTestFieldTimestamp(QDateTime::fromMSecsSinceEpoch(-1001, Qt::UTC));
+    QByteArray result = test.serialize(serializer.get());
+    ASSERT_STREQ(result.toHex().toStdString().c_str(), "0a1108feffffffffffffffff0110c08faedc03");
+
+    NativeWellKnownMessage deserialized;
+    deserialized.deserialize(serializer.get(), result);
+    ASSERT_EQ(deserialized.testFieldTimestamp().toMSecsSinceEpoch(), -1001);
+}
+
+TEST_F(NativeWellKnownTypesTest, RepeatedTimestampTest)
+{
+    NativeWellKnownMessage test;
+    test.setTestRepeatedTimestamp({QSharedPointer<google::protobuf::Timestamp>(new google::protobuf::Timestamp(1))});
+    QByteArray result = test.serialize(serializer.get());
+    ASSERT_STREQ(result.toHex().toStdString().c_str(), "2a020801");
+}
+
+TEST_F(NativeWellKnownTypesTest, JsonTest)
+{
+    QProtobufJsonSerializer jsonSerializer;
+    NativeWellKnownMessage test;
+    test.setTestFieldInt32(QtProtobuf::Int32Optional(15));
+
+    NativeWellKnownMessage deserialized;
+    deserialized.deserialize(&jsonSerializer, test.serialize(&jsonSerializer));
+    ASSERT_TRUE(deserialized.testFieldInt32() == QtProtobuf::Int32Optional(15));
+}
+
+} // tests
+} // QtProtobuf
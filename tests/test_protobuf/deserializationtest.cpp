@@ -27,6 +27,15 @@
 
 #include "simpletest.qpb.h"
 
+#include <qprotobufstreamparser.h>
+#include <qprotobufsliceddecoder.h>
+#include <qprotobufcolumndecoder.h>
+#include <qprotobufmappedfile.h>
+#include <qprotobufserializerstatistics.h>
+
+#include <QTemporaryFile>
+#include <QBuffer>
+
 using namespace qtprotobufnamespace::tests;
 using namespace QtProtobuf::tests;
 using namespace QtProtobuf;
@@ -395,6 +404,20 @@ TEST_F(DeserializationTest, RepeatedStringMessageTest)
     ASSERT_TRUE(test.testRepeatedString() == QStringList({"aaaa","bbbbb","ccc","dddddd","eeeee"}));
 }
 
+TEST_F(DeserializationTest, RepeatedStringAccumulationTest)
+{
+    RepeatedStringMessage test;
+    test.setTestRepeatedString({"zz"});
+    int changedCount = 0;
+    QObject::connect(&test, &RepeatedStringMessage::testRepeatedStringChanged, [&changedCount] { ++changedCount; });
+
+    //Elements are appended to existing value and property is written once per message
+    static_cast<QAbstractProtobufSerializer *>(serializer.get())->deserializeMessage(&test, RepeatedStringMessage::protobufMetaObject,
+                                                                                 QByteArray::fromHex("0a04616161610a0562626262620a03636363"));
+    ASSERT_TRUE(test.testRepeatedString() == QStringList({"zz", "aaaa", "bbbbb", "ccc"}));
+    EXPECT_EQ(1, changedCount);
+}
+
 TEST_F(DeserializationTest, RepeatedBytesMessageTest)
 {
     RepeatedBytesMessage test;
@@ -431,6 +454,24 @@ TEST_F(DeserializationTest, RepeatedDoubleMessageTest)
     ASSERT_TRUE(test.testRepeatedDouble() == DoubleList({0.1, 0.2, 0.3, 0.4, 0.5}));
 }
 
+TEST_F(DeserializationTest, UnalignedFixedWidthTest)
+{
+    //Fixed-width values are read from any offset, view is shifted by one byte to misalign payload
+    const QByteArray packed = QByteArray::fromHex("000a289a9999999999b93f9a9999999999c93f333333333333d33f9a9999999999d93f000000000000e03f");
+    RepeatedDoubleMessage repeated;
+    repeated.deserialize(serializer.get(), QByteArray::fromRawData(packed.constData() + 1, packed.size() - 1));
+    ASSERT_TRUE(repeated.testRepeatedDouble() == DoubleList({0.1, 0.2, 0.3, 0.4, 0.5}));
+
+    const QByteArray single = QByteArray::fromHex("0041cdcccccccccc10c0");
+    SimpleDoubleMessage test;
+    test.deserialize(serializer.get(), QByteArray::fromRawData(single.constData() + 1, single.size() - 1));
+    ASSERT_DOUBLE_EQ(-4.2, test.testFieldDouble());
+
+    //Serialized bytes don't depend on host byte order
+    test.setTestFieldDouble(-4.2);
+    ASSERT_TRUE(test.serialize(serializer.get()) == QByteArray::fromHex("41cdcccccccccc10c0"));
+}
+
 TEST_F(DeserializationTest, RepeatedIntMessageTest)
 {
     RepeatedIntMessage test;
@@ -444,6 +485,152 @@ TEST_F(DeserializationTest, RepeatedIntMessageTest)
     ASSERT_TRUE(test2.testRepeatedInt() == int32List({1, 321, -65999, 123245, -3, 3}));
 }
 
+TEST_F(DeserializationTest, RepeatedIntMessageLargeTest)
+{
+    int32List values;
+    for (int i = 0; i < 10000; i++) {
+        values.append(i % 2 == 0 ? i * 1000 : -i);
+    }
+
+    RepeatedIntMessage source;
+    source.setTestRepeatedInt(values);
+    RepeatedIntMessage test;
+    test.deserialize(serializer.get(), source.serialize(serializer.get()));
+    ASSERT_EQ(10000, test.testRepeatedInt().count());
+    ASSERT_TRUE(test.testRepeatedInt() == values);
+}
+
+TEST_F(DeserializationTest, RepeatedIntMessageUnterminatedTest)
+{
+    RepeatedIntMessage test;
+    EXPECT_THROW(test.deserialize(serializer.get(), QByteArray::fromHex("0a030102c1")), std::invalid_argument);
+    EXPECT_THROW(test.deserialize(serializer.get(), QByteArray::fromHex("0a05010203")), std::out_of_range);
+}
+
+TEST_F(DeserializationTest, RepeatedIntMessageNonPackedTest)
+{
+    RepeatedIntMessage test;
+    test.deserialize(serializer.get(), QByteArray::fromHex("080108c1020803"));
+    ASSERT_TRUE(test.testRepeatedInt() == int32List({1, 321, 3}));
+
+    //Packed and non-packed elements are appended in order they are received
+    test.deserialize(serializer.get(), QByteArray::fromHex("0a02010208030a0104"));
+    ASSERT_TRUE(test.testRepeatedInt() == int32List({1, 2, 3, 4}));
+
+    EXPECT_THROW(test.deserialize(serializer.get(), QByteArray::fromHex("090100000000000000")), std::invalid_argument);
+}
+
+TEST_F(DeserializationTest, VarintBufferTailTest)
+{
+    SimpleUInt64Message test;
+    //Longest varint that ends exactly at buffer end
+    test.deserialize(serializer.get(), QByteArray::fromHex("08ffffffffffffffffff01"));
+    ASSERT_EQ(UINT64_MAX, test.testFieldInt());
+
+    //Varint followed by unexpected field
+    test.deserialize(serializer.get(), QByteArray::fromHex("08ac021001"));
+    ASSERT_EQ(300u, test.testFieldInt());
+
+    EXPECT_THROW(test.deserialize(serializer.get(), QByteArray::fromHex("08ffff")), std::out_of_range);
+}
+
+TEST_F(DeserializationTest, DeserializeInPlaceTest)
+{
+    ComplexMessage test;
+    serializer->deserializeInPlace(&test, QByteArray::fromHex("081912083206717765727479"));
+    ASSERT_EQ(25, test.testFieldInt());
+    ASSERT_TRUE(test.testComplexField().testFieldString() == QString("qwerty"));
+
+    //Fields that are not in data are not reset
+    serializer->deserializeInPlace(&test, QByteArray::fromHex("0819"));
+    ASSERT_EQ(25, test.testFieldInt());
+    ASSERT_TRUE(test.testComplexField().testFieldString() == QString("qwerty"));
+
+    test.deserialize(serializer.get(), QByteArray::fromHex("0819"));
+    ASSERT_TRUE(test.testComplexField().testFieldString().isEmpty());
+}
+
+TEST_F(DeserializationTest, MergeTest)
+{
+    ComplexMessage test;
+    test.deserialize(serializer.get(), QByteArray::fromHex("081912083206717765727479"));
+
+    int intChangedCount = 0;
+    int complexChangedCount = 0;
+    int stringChangedCount = 0;
+    QObject::connect(&test, &ComplexMessage::testFieldIntChanged, [&intChangedCount] { ++intChangedCount; });
+    QObject::connect(&test, &ComplexMessage::testComplexFieldChanged, [&complexChangedCount] { ++complexChangedCount; });
+    QObject::connect(&test.testComplexField(), &SimpleStringMessage::testFieldStringChanged, [&stringChangedCount] { ++stringChangedCount; });
+
+    //Unchanged values don't emit signals
+    test.merge(serializer.get(), QByteArray::fromHex("0819"));
+    ASSERT_EQ(25, test.testFieldInt());
+    ASSERT_TRUE(test.testComplexField().testFieldString() == QString("qwerty"));
+    EXPECT_EQ(0, intChangedCount);
+
+    test.merge(serializer.get(), QByteArray::fromHex("081a"));
+    ASSERT_EQ(26, test.testFieldInt());
+    ASSERT_TRUE(test.testComplexField().testFieldString() == QString("qwerty"));
+    EXPECT_EQ(1, intChangedCount);
+
+    //Nested message is merged in place
+    test.merge(serializer.get(), QByteArray::fromHex("12083206617364666768"));
+    ASSERT_EQ(26, test.testFieldInt());
+    ASSERT_TRUE(test.testComplexField().testFieldString() == QString("asdfgh"));
+    EXPECT_EQ(1, intChangedCount);
+    EXPECT_EQ(0, complexChangedCount);
+    EXPECT_EQ(1, stringChangedCount);
+
+    //Received repeated field replaces existing value
+    RepeatedIntMessage repeated;
+    int repeatedChangedCount = 0;
+    QObject::connect(&repeated, &RepeatedIntMessage::testRepeatedIntChanged, [&repeatedChangedCount] { ++repeatedChangedCount; });
+    repeated.merge(serializer.get(), QByteArray::fromHex("0a03010203"));
+    repeated.merge(serializer.get(), QByteArray::fromHex("0a03010203"));
+    ASSERT_TRUE(repeated.testRepeatedInt() == int32List({1, 2, 3}));
+    EXPECT_EQ(1, repeatedChangedCount);
+}
+
+TEST_F(DeserializationTest, ClearAndReuseTest)
+{
+    ComplexMessage test;
+    test.deserialize(serializer.get(), QByteArray::fromHex("081912083206717765727479"));
+    const SimpleStringMessage *nested = &test.testComplexField();
+
+    test.clear();
+    ASSERT_EQ(0, test.testFieldInt());
+    ASSERT_TRUE(test.testComplexField().testFieldString().isEmpty());
+    ASSERT_TRUE(test == ComplexMessage());
+
+    //Nested message object is reused by next deserialization
+    serializer->deserializeInPlace(&test, QByteArray::fromHex("081912083206717765727479"));
+    ASSERT_EQ(nested, &test.testComplexField());
+    ASSERT_EQ(25, test.testFieldInt());
+    ASSERT_TRUE(test.testComplexField().testFieldString() == QString("qwerty"));
+
+    RepeatedStringMessage repeated;
+    repeated.setTestRepeatedString({"aaa", "bbb"});
+    repeated.clear();
+    ASSERT_TRUE(repeated.testRepeatedString().isEmpty());
+}
+
+TEST_F(DeserializationTest, TryDeserializeErrorTest)
+{
+    SimpleUInt64Message test;
+    EXPECT_EQ(NoDeserializationError, serializer->tryDeserialize(&test, QByteArray::fromHex("08ac02")));
+    ASSERT_EQ(300u, test.testFieldInt());
+
+    EXPECT_EQ(UnexpectedEndOfStreamError, serializer->tryDeserialize(&test, QByteArray::fromHex("08ffff")));
+
+    //Fields deserialized before invalid header are kept
+    EXPECT_EQ(InvalidHeaderError, serializer->tryDeserialize(&test, QByteArray::fromHex("080107")));
+    ASSERT_EQ(1u, test.testFieldInt());
+
+    //Error state is not leaked to following deserializations
+    EXPECT_NO_THROW(test.deserialize(serializer.get(), QByteArray::fromHex("0802")));
+    ASSERT_EQ(2u, test.testFieldInt());
+}
+
 TEST_F(DeserializationTest, RepeatedSIntMessageTest)
 {
     RepeatedSIntMessage test;
@@ -492,6 +679,22 @@ TEST_F(DeserializationTest, RepeatedFixedIntMessageTest)
     ASSERT_TRUE(test.testRepeatedInt() == fixed32List({1, 321, 65999, 12324523, 3, 3}));
 }
 
+TEST_F(DeserializationTest, RepeatedFixedIntMessageInvalidSizeTest)
+{
+    RepeatedFixedIntMessage test;
+    EXPECT_THROW(test.deserialize(serializer.get(), QByteArray::fromHex("0a0301000000")), std::invalid_argument);
+    EXPECT_THROW(test.deserialize(serializer.get(), QByteArray::fromHex("0a0801000000")), std::out_of_range);
+}
+
+TEST_F(DeserializationTest, RepeatedFixedIntMessageNonPackedTest)
+{
+    RepeatedFixedIntMessage test;
+    test.deserialize(serializer.get(), QByteArray::fromHex("0d010000000d41010000"));
+    ASSERT_TRUE(test.testRepeatedInt() == fixed32List({1, 321}));
+
+    EXPECT_THROW(test.deserialize(serializer.get(), QByteArray::fromHex("0801")), std::invalid_argument);
+}
+
 TEST_F(DeserializationTest, RepeatedSFixedIntMessageTest)
 {
     RepeatedSFixedIntMessage test;
@@ -534,6 +737,351 @@ TEST_F(DeserializationTest, RepeatedComplexMessageTest)
     ASSERT_TRUE(test.testRepeatedComplex().at(0)->testComplexField().testFieldString() == QString("qwerty"));
 }
 
+TEST_F(DeserializationTest, RepeatedComplexMessageArenaTest)
+{
+    QProtobufArena arena;
+    {
+        RepeatedComplexMessage test;
+        serializer->deserialize(&test, QByteArray::fromHex("0a0c0819120832067177657274790a0c0819120832067177657274790a0c081912083206717765727479"), &arena);
+        ASSERT_EQ(3, test.testRepeatedComplex().count());
+        ASSERT_EQ(25, test.testRepeatedComplex().at(2)->testFieldInt());
+        ASSERT_TRUE(test.testRepeatedComplex().at(2)->testComplexField().testFieldString() == QString("qwerty"));
+        EXPECT_EQ(3, arena.liveObjects());
+        EXPECT_LT(0u, arena.spaceAllocated());
+    }
+    EXPECT_EQ(0, arena.liveObjects());
+
+    arena.reset();
+    EXPECT_EQ(0u, arena.spaceAllocated());
+}
+
+TEST_F(DeserializationTest, RepeatedComplexMessageReuseTest)
+{
+    RepeatedComplexMessage test;
+    serializer->deserializeReusing(&test, QByteArray::fromHex("0a0c0819120832067177657274790a0c081912083206717765727479"));
+    ASSERT_EQ(2, test.testRepeatedComplex().count());
+    const ComplexMessage *first = test.testRepeatedComplex().at(0).data();
+
+    //Elements are reused, fields that are not received are reset
+    serializer->deserializeReusing(&test, QByteArray::fromHex("0a1508d3feffffffffffffff0112083206717765727479"));
+    ASSERT_EQ(1, test.testRepeatedComplex().count());
+    EXPECT_EQ(first, test.testRepeatedComplex().at(0).data());
+    EXPECT_EQ(-173, test.testRepeatedComplex().at(0)->testFieldInt());
+    EXPECT_TRUE(test.testRepeatedComplex().at(0)->testComplexField().testFieldString() == QString("qwerty"));
+
+    serializer->deserializeReusing(&test, QByteArray::fromHex("0a020819"));
+    ASSERT_EQ(1, test.testRepeatedComplex().count());
+    EXPECT_EQ(first, test.testRepeatedComplex().at(0).data());
+    EXPECT_EQ(25, test.testRepeatedComplex().at(0)->testFieldInt());
+    EXPECT_TRUE(test.testRepeatedComplex().at(0)->testComplexField().testFieldString().isEmpty());
+}
+
+TEST_F(DeserializationTest, SerializerStatisticsTest)
+{
+    const QByteArray typeName(RepeatedComplexMessage::staticMetaObject.className());
+    QProtobufSerializerStatistics::reset();
+
+    RepeatedComplexMessage test;
+    test.deserialize(serializer.get(), QByteArray::fromHex("0a0c081912083206717765727479"));
+    EXPECT_EQ(0u, QProtobufSerializerStatistics::statistics(typeName).deserializeCount);
+
+    QProtobufSerializerStatistics::setEnabled(true);
+    ASSERT_TRUE(QProtobufSerializerStatistics::isEnabled());
+    //1002 varint field number 2 is unknown
+    const QByteArray data = QByteArray::fromHex("0a0c0819120832067177657274790a0c0819120832067177657274791002");
+    test.deserialize(serializer.get(), data);
+    QByteArray result = test.serialize(serializer.get());
+
+    ASSERT_TRUE(QProtobufSerializerStatistics::messageTypes().contains(typeName));
+    QProtobufMessageStatistics statistics = QProtobufSerializerStatistics::statistics(typeName);
+    EXPECT_EQ(1u, statistics.deserializeCount);
+    EXPECT_EQ(static_cast<quint64>(data.size()), statistics.bytesConsumed);
+    EXPECT_EQ(1u, statistics.unknownFields);
+    EXPECT_EQ(2u, statistics.allocations);
+    EXPECT_EQ(0u, statistics.errors);
+    EXPECT_EQ(1u, statistics.serializeCount);
+    EXPECT_EQ(static_cast<quint64>(result.size()), statistics.bytesProduced);
+    EXPECT_LE(0, statistics.deserializeNanoseconds);
+
+    EXPECT_THROW(test.deserialize(serializer.get(), QByteArray::fromHex("0a1508")), std::out_of_range);
+    QProtobufSerializerStatistics::setEnabled(false);
+    statistics = QProtobufSerializerStatistics::statistics(typeName);
+    EXPECT_EQ(2u, statistics.deserializeCount);
+    EXPECT_EQ(1u, statistics.errors);
+
+    QProtobufSerializerStatistics::reset();
+    EXPECT_EQ(0u, QProtobufSerializerStatistics::statistics(typeName).deserializeCount);
+}
+
+TEST_F(DeserializationTest, LazyMessageFieldTest)
+{
+    serializer->setLazyMessagesEnabled(true);
+    ComplexMessage test;
+    test.deserialize(serializer.get(), QByteArray::fromHex("081912083206717765727479"));
+    ASSERT_EQ(25, test.testFieldInt());
+    ASSERT_TRUE(test.testComplexField().testFieldString() == QString("qwerty"));
+
+    //Malformed nested message is not parsed until it's accessed
+    EXPECT_NO_THROW(test.deserialize(serializer.get(), QByteArray::fromHex("08191203320aff")));
+    ASSERT_EQ(25, test.testFieldInt());
+    EXPECT_NO_THROW(test.testComplexField());
+    ASSERT_TRUE(test.testComplexField().testFieldString().isEmpty());
+}
+
+TEST_F(DeserializationTest, DefaultMessageFieldTest)
+{
+    ComplexMessage test1;
+    ComplexMessage test2;
+    //Unset message fields share one default instance
+    ASSERT_EQ(&test1.testComplexField(), &test2.testComplexField());
+    ASSERT_TRUE(test1 == test2);
+
+    ComplexMessage copy(test1);
+    ASSERT_EQ(&test1.testComplexField(), &copy.testComplexField());
+
+    test2.deserialize(serializer.get(), QByteArray::fromHex("081912083206717765727479"));
+    ASSERT_NE(&test1.testComplexField(), &test2.testComplexField());
+    ASSERT_TRUE(test2.testComplexField().testFieldString() == QString("qwerty"));
+    ASSERT_TRUE(test1.testComplexField().testFieldString().isEmpty());
+    ASSERT_FALSE(test1 == test2);
+}
+
+TEST_F(DeserializationTest, CopyMessageTest)
+{
+    RepeatedComplexMessage repeated;
+    repeated.deserialize(serializer.get(), QByteArray::fromHex("0a0708011203320161"));
+
+    //Repeated fields are implicitly shared by copies
+    const RepeatedComplexMessage repeatedCopy(repeated);
+    ASSERT_TRUE(repeatedCopy == repeated);
+    ASSERT_EQ(&repeated.testRepeatedComplex().at(0), &repeatedCopy.testRepeatedComplex().at(0));
+
+    //Materialized nested message is cloned
+    ComplexMessage test;
+    test.deserialize(serializer.get(), QByteArray::fromHex("081912083206717765727479"));
+    ASSERT_TRUE(test.testComplexField().testFieldString() == QString("qwerty"));
+    ComplexMessage copy(test);
+    ASSERT_TRUE(copy == test);
+    ASSERT_NE(&test.testComplexField(), &copy.testComplexField());
+    copy.testComplexField_p()->setTestFieldString("asdfgh");
+    ASSERT_TRUE(test.testComplexField().testFieldString() == QString("qwerty"));
+}
+
+TEST_F(DeserializationTest, OneofMessageTest)
+{
+    //Member received last is active
+    OneofMessage test;
+    test.deserialize(serializer.get(), QByteArray::fromHex("100a1a026162"));
+    ASSERT_EQ(OneofMessage::TestOneofCase::TestOneofFieldString, test.testOneofCase());
+    ASSERT_EQ(0, test.testOneofFieldInt());
+    ASSERT_TRUE(test.testOneofFieldString() == QString("ab"));
+
+    test.deserialize(serializer.get(), QByteArray::fromHex("080122080801120432026162"));
+    ASSERT_EQ(OneofMessage::TestOneofCase::TestOneofComplexField, test.testOneofCase());
+    ASSERT_EQ(1, test.testFieldInt());
+    ASSERT_EQ(1, test.testOneofComplexField().testFieldInt());
+    ASSERT_TRUE(test.testOneofComplexField().testComplexField().testFieldString() == QString("ab"));
+    ASSERT_TRUE(test.testOneofFieldString().isEmpty());
+
+    //Active member is kept by copies and moves
+    OneofMessage copy(test);
+    ASSERT_TRUE(copy == test);
+    ASSERT_EQ(OneofMessage::TestOneofCase::TestOneofComplexField, copy.testOneofCase());
+
+    OneofMessage moved(std::move(copy));
+    ASSERT_TRUE(moved == test);
+    ASSERT_EQ(OneofMessage::TestOneofCase::NotSet, copy.testOneofCase());
+
+    OneofMessage assigned;
+    assigned.setTestOneofFieldInt(5);
+    assigned = test;
+    ASSERT_TRUE(assigned == test);
+    ASSERT_EQ(0, assigned.testOneofFieldInt());
+
+    assigned.clear();
+    ASSERT_EQ(OneofMessage::TestOneofCase::NotSet, assigned.testOneofCase());
+    ASSERT_FALSE(assigned == test);
+    ASSERT_TRUE(assigned.serialize(serializer.get()).isEmpty());
+}
+
+TEST_F(DeserializationTest, OptionalFieldsTest)
+{
+    OptionalMessage test;
+    test.deserialize(serializer.get(), QByteArray::fromHex("08001d00000000"));
+    ASSERT_TRUE(test.hasTestFieldInt());
+    ASSERT_EQ(0, test.testFieldInt());
+    ASSERT_FALSE(test.hasTestFieldString());
+    ASSERT_TRUE(test.hasTestFieldFixedInt32());
+
+    test.deserialize(serializer.get(), QByteArray::fromHex("1202717765"));
+    ASSERT_FALSE(test.hasTestFieldInt());
+    ASSERT_TRUE(test.hasTestFieldString());
+    ASSERT_TRUE(test.testFieldString() == QString("qwe"));
+}
+
+TEST_F(DeserializationTest, FieldMaskTest)
+{
+    ComplexMessage test;
+    serializer->deserialize(&test, QByteArray::fromHex("081912083206717765727479"), QProtobufFieldMask{2});
+    ASSERT_EQ(0, test.testFieldInt());
+    ASSERT_TRUE(test.testComplexField().testFieldString() == QString("qwerty"));
+
+    //Masked out fields are not decoded
+    EXPECT_NO_THROW(serializer->deserialize(&test, QByteArray::fromHex("08191203320aff"), QProtobufFieldMask{1}));
+    ASSERT_EQ(25, test.testFieldInt());
+    ASSERT_TRUE(test.testComplexField().testFieldString().isEmpty());
+
+    QProtobufFieldMask mask;
+    EXPECT_TRUE(mask.isEmpty());
+    mask.add(200);
+    EXPECT_TRUE(mask.contains(200));
+    EXPECT_FALSE(mask.contains(1));
+}
+
+TEST_F(DeserializationTest, PreserveUnknownFieldsTest)
+{
+    serializer->setPreserveUnknownFieldsEnabled(true);
+    ASSERT_TRUE(serializer->isPreserveUnknownFieldsEnabled());
+
+    SimpleIntMessage test;
+    //1002 varint field number 2, 1a03717765 length delimited field number 3
+    test.deserialize(serializer.get(), QByteArray::fromHex("080110021a03717765"));
+    ASSERT_EQ(1, test.testFieldInt());
+
+    SimpleIntMessage copy(test);
+    QByteArray result = copy.serialize(serializer.get());
+    ASSERT_STREQ(result.toHex().toStdString().c_str(), "080110021a03717765");
+    ASSERT_EQ(result.size(), copy.byteSize(serializer.get()));
+
+    serializer->setPreserveUnknownFieldsEnabled(false);
+    copy.deserialize(serializer.get(), QByteArray::fromHex("080110021a03717765"));
+    ASSERT_STREQ(copy.serialize(serializer.get()).toHex().toStdString().c_str(), "0801");
+}
+
+TEST_F(DeserializationTest, StreamParserTest)
+{
+    QList<int> fieldNumbers;
+    QByteArray fields;
+    QProtobufStreamParser parser([&fieldNumbers, &fields](int fieldNumber, WireTypes, const QByteArray &field) {
+        fieldNumbers.append(fieldNumber);
+        fields.append(field);
+    });
+
+    const QByteArray data = QByteArray::fromHex("081912083206717765727479");
+    for (int i = 0; i < data.size(); ++i) {
+        ASSERT_TRUE(parser.feed(data.mid(i, 1)));
+        if (i == 1) {
+            ASSERT_EQ(1, fieldNumbers.count());
+            ASSERT_TRUE(parser.isAtFieldBoundary());
+        } else if (i == 2) {
+            ASSERT_FALSE(parser.isAtFieldBoundary());
+        }
+    }
+    ASSERT_TRUE(parser.isAtFieldBoundary());
+    ASSERT_EQ((QList<int>{1, 2}), fieldNumbers);
+    ASSERT_TRUE(fields == data);
+
+    ComplexMessage test;
+    test.deserialize(serializer.get(), fields);
+    ASSERT_EQ(25, test.testFieldInt());
+    ASSERT_TRUE(test.testComplexField().testFieldString() == QString("qwerty"));
+
+    //Invalid wire type
+    ASSERT_FALSE(parser.feed(QByteArray::fromHex("0f00")));
+    ASSERT_TRUE(parser.hasError());
+    ASSERT_FALSE(parser.feed(data));
+    parser.reset();
+    ASSERT_TRUE(parser.feed(data.left(5)));
+    ASSERT_FALSE(parser.isAtFieldBoundary());
+    ASSERT_EQ(3, fieldNumbers.count());
+}
+
+TEST_F(DeserializationTest, StreamParserFieldSinkTest)
+{
+    QList<int> fieldNumbers;
+    QByteArray fields;
+    QProtobufStreamParser parser([&fieldNumbers, &fields](int fieldNumber, WireTypes, const QByteArray &field) {
+        fieldNumbers.append(fieldNumber);
+        fields.append(field);
+    });
+
+    QBuffer sink;
+    sink.open(QIODevice::WriteOnly);
+    parser.setFieldSink(2, &sink);
+    ASSERT_EQ(&sink, parser.fieldSink(2));
+    ASSERT_EQ(nullptr, parser.fieldSink(1));
+
+    const QByteArray payload = QByteArray(100000, 'x');
+    QByteArray data = QByteArray::fromHex("0819");
+    data.append(QByteArray::fromHex("12a08d06"));
+    data.append(payload);
+    data.append(QByteArray::fromHex("1203717765"));
+    for (int i = 0; i < data.size(); i += 4096) {
+        ASSERT_TRUE(parser.feed(data.mid(i, 4096)));
+    }
+    ASSERT_TRUE(parser.isAtFieldBoundary());
+    ASSERT_EQ((QList<int>{1, 2, 2}), fieldNumbers);
+    ASSERT_STREQ(fields.toHex().toStdString().c_str(), "081912a08d061203");
+    ASSERT_TRUE(sink.data() == payload + "qwe");
+
+    //Write errors are treated as invalid data
+    parser.reset();
+    sink.close();
+    ASSERT_FALSE(parser.feed(QByteArray::fromHex("1203717765")));
+    ASSERT_TRUE(parser.hasError());
+
+    parser.reset();
+    parser.setFieldSink(2, nullptr);
+    ASSERT_TRUE(parser.feed(QByteArray::fromHex("1203717765")));
+    ASSERT_TRUE(fields.endsWith(QByteArray::fromHex("1203717765")));
+}
+
+TEST_F(DeserializationTest, ParallelDecodeTest)
+{
+    const QByteArray element = QByteArray::fromHex("0a0c081912083206717765727479");
+    const QByteArray data = element.repeated(5000);
+    ASSERT_FALSE(serializer->isParallelDecodeEnabled());
+    serializer->setParallelDecodeEnabled(true);
+
+    RepeatedComplexMessage test;
+    test.deserialize(serializer.get(), data);
+    ASSERT_EQ(5000, test.testRepeatedComplex().count());
+    for (const auto &message : test.testRepeatedComplex()) {
+        ASSERT_EQ(25, message->testFieldInt());
+        ASSERT_TRUE(message->testComplexField().testFieldString() == QString("qwerty"));
+    }
+
+    //Errors in elements decoded by pool threads are reported to caller
+    QByteArray invalidData = data;
+    invalidData.replace(element.size() * 3000, element.size(), QByteArray::fromHex("0a0c0819120832ff717765727479"));
+    EXPECT_NE(NoDeserializationError, serializer->tryDeserialize(&test, invalidData));
+}
+
+TEST_F(DeserializationTest, ColumnDecoderTest)
+{
+    QVector<qint32> ints;
+    QVector<qint64> wrongType;
+    QVector<QString> messages;
+    QProtobufColumnDecoder decoder(ComplexMessage::protobufMetaObject);
+    ASSERT_FALSE(decoder.bind("testFieldInt", &wrongType));
+    ASSERT_FALSE(decoder.bind("testComplexField", &messages));
+    ASSERT_FALSE(decoder.bind(3, &ints));
+    ASSERT_TRUE(decoder.bind("testFieldInt", &ints));
+
+    //Second row doesn't contain int field, it gets default value
+    ASSERT_EQ(NoDeserializationError, decoder.decode(QByteArray::fromHex("0a0c081912083206717765727479"
+                                                                         "0a0a12083206717765727479"
+                                                                         "0a0b08d3feffffffffffffff01"
+                                                                         "120208010a02082a"), 1));
+    ASSERT_EQ(4, decoder.rowCount());
+    ASSERT_TRUE(ints == QVector<qint32>({25, 0, -173, 42}));
+
+    ASSERT_EQ(NoDeserializationError, decoder.decodeRow(QByteArray::fromHex("0801")));
+    ASSERT_TRUE(ints == QVector<qint32>({25, 0, -173, 42, 1}));
+
+    ASSERT_NE(NoDeserializationError, decoder.decode(QByteArray::fromHex("0a0c0819"), 1));
+}
+
 TEST_F(DeserializationTest, SIntMessageDeserializeTest)
 {
     SimpleSIntMessage test;
@@ -666,6 +1214,29 @@ TEST_F(DeserializationTest, SimpleSInt32StringMapDeserializeTest)
     ASSERT_TRUE(test.mapField() == SimpleSInt32StringMapMessage::MapFieldEntry({{10, {"ten"}}, {-42, {"minus fourty two"}}, {15, {"fifteen"}}}));
 }
 
+TEST_F(DeserializationTest, SimpleSInt32StringMapMissingKeyDeserializeTest)
+{
+    //First entry has no key, second one contains field that is not a part of map entry
+    SimpleSInt32StringMapMessage test;
+    test.deserialize(serializer.get(), QByteArray::fromHex("0a05120374656e0a090814180112036f6e65"));
+    ASSERT_TRUE(test.mapField() == SimpleSInt32StringMapMessage::MapFieldEntry({{0, {"ten"}}, {10, {"one"}}}));
+}
+
+TEST_F(DeserializationTest, SimpleSInt32StringMapLargeDeserializeTest)
+{
+    SimpleSInt32StringMapMessage::MapFieldEntry map;
+    for (int i = -5000; i < 5000; ++i) {
+        map.insert(i, QString::number(i));
+    }
+    SimpleSInt32StringMapMessage source;
+    source.setMapField(map);
+
+    SimpleSInt32StringMapMessage test;
+    test.deserialize(serializer.get(), source.serialize(serializer.get()));
+    ASSERT_EQ(test.mapField().count(), 10000);
+    ASSERT_TRUE(test.mapField() == map);
+}
+
 TEST_F(DeserializationTest, SimpleUInt32StringMapDeserializeTest)
 {
     SimpleUInt32StringMapMessage test;
@@ -867,6 +1438,24 @@ TEST_F(DeserializationTest, RedundantFieldIsIgnoredAtDeserializationTest)
     EXPECT_STREQ(test.testComplexField().testFieldString().toStdString().c_str(), "qwerty");
 }
 
+TEST_F(DeserializationTest, RedundantFieldOutOfBoundsTest)
+{
+    ComplexMessage test;
+    //Length of field number 6 exceeds message
+    EXPECT_THROW(test.deserialize(serializer.get(), QByteArray::fromHex("320a7177")), std::out_of_range);
+    //Length of field number 6 doesn't fit to int
+    EXPECT_THROW(test.deserialize(serializer.get(), QByteArray::fromHex("32ffffffff0f7177")), std::out_of_range);
+
+    //Many redundant fields are skipped
+    QByteArray data;
+    for (int i = 0; i < 1000; ++i) {
+        data.append(QByteArray::fromHex("3206717765727479"));
+    }
+    data.append(QByteArray::fromHex("08ac02"));
+    ASSERT_NO_THROW(test.deserialize(serializer.get(), data));
+    EXPECT_EQ(test.testFieldInt(), 300);
+}
+
 TEST_F(DeserializationTest, FieldIndexRangeTest)
 {
     FieldIndexTest1Message msg1(0);
@@ -901,3 +1490,180 @@ TEST_F(DeserializationTest, SimpleEnumListMessageTest)
                 SimpleEnumListMessage::LOCAL_ENUM_VALUE2,
                 SimpleEnumListMessage::LOCAL_ENUM_VALUE3}));
 }
+
+TEST_F(DeserializationTest, SimpleEnumListMessageNonPackedTest)
+{
+    SimpleEnumListMessage msg;
+    msg.deserialize(serializer.get(), QByteArray::fromHex("08030a0201020800"));
+    ASSERT_TRUE((msg.localEnumList() == SimpleEnumListMessage::LocalEnumRepeated {SimpleEnumListMessage::LOCAL_ENUM_VALUE3,
+                SimpleEnumListMessage::LOCAL_ENUM_VALUE1,
+                SimpleEnumListMessage::LOCAL_ENUM_VALUE2,
+                SimpleEnumListMessage::LOCAL_ENUM_VALUE0}));
+}
+
+TEST_F(DeserializationTest, ZeroCopyBytesTest)
+{
+    const QByteArray data = QByteArray::fromHex("0a060102030405060a04ffffffff");
+    ASSERT_FALSE(serializer->isZeroCopyBytesEnabled());
+
+    RepeatedBytesMessage test;
+    test.deserialize(serializer.get(), data);
+    ASSERT_EQ(2, test.testRepeatedBytes().count());
+    ASSERT_NE(test.testRepeatedBytes().at(0).constData(), data.constData() + 2);
+
+    serializer->setZeroCopyBytesEnabled(true);
+    test.deserialize(serializer.get(), data);
+    ASSERT_EQ(2, test.testRepeatedBytes().count());
+    ASSERT_EQ(test.testRepeatedBytes().at(0).constData(), data.constData() + 2);
+    ASSERT_EQ(test.testRepeatedBytes().at(1).constData(), data.constData() + 10);
+    ASSERT_TRUE(test.testRepeatedBytes() == QByteArrayList({QByteArray::fromHex("010203040506"),
+                                                             QByteArray::fromHex("ffffffff")}));
+    serializer->setZeroCopyBytesEnabled(false);
+}
+
+TEST_F(DeserializationTest, MappedFileTest)
+{
+    QTemporaryFile file;
+    ASSERT_TRUE(file.open());
+    file.write(QByteArray::fromHex("0a060102030405060a04ffffffff"));
+    file.close();
+
+    QProtobufMappedFile mappedFile(file.fileName());
+    ASSERT_TRUE(mappedFile.isValid());
+    ASSERT_EQ(14, mappedFile.size());
+
+    serializer->setZeroCopyBytesEnabled(true);
+    RepeatedBytesMessage test;
+    test.deserialize(serializer.get(), mappedFile.data());
+    ASSERT_EQ(2, test.testRepeatedBytes().count());
+    ASSERT_EQ(test.testRepeatedBytes().at(0).constData(), mappedFile.data().constData() + 2);
+    ASSERT_TRUE(test.testRepeatedBytes().at(1) == QByteArray::fromHex("ffffffff"));
+    serializer->setZeroCopyBytesEnabled(false);
+
+    QProtobufMappedFile missingFile(file.fileName() + ".missing");
+    ASSERT_FALSE(missingFile.isValid());
+    ASSERT_TRUE(missingFile.data().isEmpty());
+}
+
+TEST_F(DeserializationTest, DeserializationLimitsTest)
+{
+    const QByteArray packedData = QByteArray::fromHex("0a03010203");
+    //{{1, {"a"}}, {2, {"b"}}}
+    const QByteArray nestedData = QByteArray::fromHex("0a0708011203320161" "0a0708021203320162");
+    ASSERT_EQ(0, serializer->maxMessageSize());
+    ASSERT_EQ(100, serializer->maxRecursionDepth());
+    ASSERT_EQ(0, serializer->maxElementCount());
+
+    RepeatedIntMessage repeatedInt;
+    serializer->setMaxMessageSize(4);
+    EXPECT_EQ(LimitExceededError, serializer->tryDeserialize(&repeatedInt, packedData));
+    serializer->setMaxMessageSize(5);
+    EXPECT_EQ(NoDeserializationError, serializer->tryDeserialize(&repeatedInt, packedData));
+    serializer->setMaxMessageSize(0);
+
+    serializer->setMaxElementCount(2);
+    EXPECT_EQ(LimitExceededError, serializer->tryDeserialize(&repeatedInt, packedData));
+    serializer->setMaxElementCount(3);
+    EXPECT_EQ(NoDeserializationError, serializer->tryDeserialize(&repeatedInt, packedData));
+    EXPECT_TRUE(repeatedInt.testRepeatedInt() == int32List({1, 2, 3}));
+
+    RepeatedComplexMessage repeatedComplex;
+    serializer->setMaxElementCount(1);
+    EXPECT_EQ(LimitExceededError, serializer->tryDeserialize(&repeatedComplex, nestedData));
+    serializer->setMaxElementCount(0);
+
+    serializer->setMaxRecursionDepth(1);
+    EXPECT_EQ(LimitExceededError, serializer->tryDeserialize(&repeatedComplex, nestedData));
+    serializer->setMaxRecursionDepth(2);
+    EXPECT_EQ(NoDeserializationError, serializer->tryDeserialize(&repeatedComplex, nestedData));
+    ASSERT_EQ(2, repeatedComplex.testRepeatedComplex().count());
+    EXPECT_STREQ("b", repeatedComplex.testRepeatedComplex().at(1)->testComplexField().testFieldString().toStdString().c_str());
+    serializer->setMaxRecursionDepth(100);
+}
+
+TEST_F(DeserializationTest, TotalElementCountLimitTest)
+{
+    ASSERT_EQ(0, serializer->maxTotalElementCount());
+
+    //Packed field counts as one more element
+    RepeatedIntMessage repeatedInt;
+    serializer->setMaxTotalElementCount(3);
+    EXPECT_EQ(LimitExceededError, serializer->tryDeserialize(&repeatedInt, QByteArray::fromHex("0a03010203")));
+    serializer->setMaxTotalElementCount(4);
+    EXPECT_EQ(NoDeserializationError, serializer->tryDeserialize(&repeatedInt, QByteArray::fromHex("0a03010203")));
+
+    //Limit is shared by all fields of message
+    RepeatedComplexMessage repeatedComplex;
+    serializer->setMaxTotalElementCount(1);
+    EXPECT_EQ(LimitExceededError, serializer->tryDeserialize(&repeatedComplex, QByteArray::fromHex("0a0708011203320161" "0a0708021203320162")));
+    serializer->setMaxTotalElementCount(2);
+    EXPECT_EQ(NoDeserializationError, serializer->tryDeserialize(&repeatedComplex, QByteArray::fromHex("0a0708011203320161" "0a0708021203320162")));
+    EXPECT_EQ(2, repeatedComplex.testRepeatedComplex().count());
+    serializer->setMaxTotalElementCount(0);
+}
+
+TEST_F(DeserializationTest, ChangeSignalsTest)
+{
+    ComplexMessage test;
+    int intChangedCount = 0;
+    int complexChangedCount = 0;
+    QObject::connect(&test, &ComplexMessage::testFieldIntChanged, [&intChangedCount] { ++intChangedCount; });
+    QObject::connect(&test, &ComplexMessage::testComplexFieldChanged, [&complexChangedCount] { ++complexChangedCount; });
+
+    //Signals are emitted once per changed field, when decoded message is assigned
+    test.deserialize(serializer.get(), QByteArray::fromHex("081912083206717765727479"));
+    EXPECT_EQ(1, intChangedCount);
+    EXPECT_EQ(1, complexChangedCount);
+    EXPECT_FALSE(test.signalsBlocked());
+
+    //Messages created by deserializer are not left blocked
+    RepeatedComplexMessage repeated;
+    repeated.deserialize(serializer.get(), QByteArray::fromHex("0a0708011203320161"));
+    ASSERT_EQ(1, repeated.testRepeatedComplex().count());
+    EXPECT_FALSE(repeated.testRepeatedComplex().at(0)->signalsBlocked());
+    EXPECT_FALSE(repeated.testRepeatedComplex().at(0)->testComplexField().signalsBlocked());
+}
+
+TEST_F(DeserializationTest, SlicedDecoderTest)
+{
+    const QByteArray element = QByteArray::fromHex("0a0c081912083206717765727479");
+    const QByteArray data = element.repeated(1000);
+
+    QProtobufSlicedDecoder decoder(serializer.get());
+    decoder.setSliceSize(1000);
+    int progressCount = 0;
+    QList<DeserializationError> errors;
+    QObject::connect(&decoder, &QProtobufSlicedDecoder::progress, [&progressCount] { ++progressCount; });
+    QObject::connect(&decoder, &QProtobufSlicedDecoder::finished, [&errors](DeserializationError error) {
+        errors.append(error);
+    });
+
+    RepeatedComplexMessage test;
+    decoder.decode(&test, data);
+    ASSERT_TRUE(decoder.isRunning());
+    ASSERT_EQ(data.size(), decoder.bytesTotal());
+    while (decoder.processNextSlice()) {
+        //Target message is assigned once decoding is finished
+        ASSERT_TRUE(test.testRepeatedComplex().isEmpty());
+    }
+    ASSERT_FALSE(decoder.isRunning());
+    ASSERT_EQ(data.size() / 1000 - 1, progressCount);
+    ASSERT_EQ(QList<DeserializationError>{NoDeserializationError}, errors);
+    ASSERT_EQ(1000, test.testRepeatedComplex().count());
+    EXPECT_EQ(25, test.testRepeatedComplex().at(999)->testFieldInt());
+    EXPECT_TRUE(test.testRepeatedComplex().at(999)->testComplexField().testFieldString() == QString("qwerty"));
+
+    //Truncated message
+    decoder.decode(&test, data.left(data.size() - 3));
+    while (decoder.processNextSlice());
+    ASSERT_EQ(UnexpectedEndOfStreamError, errors.last());
+
+    //Aborted decoding doesn't change target message
+    RepeatedComplexMessage aborted;
+    decoder.decode(&aborted, data);
+    ASSERT_TRUE(decoder.processNextSlice());
+    decoder.abort();
+    ASSERT_FALSE(decoder.processNextSlice());
+    ASSERT_TRUE(aborted.testRepeatedComplex().isEmpty());
+    ASSERT_EQ(2, errors.count());
+}
@@ -0,0 +1,174 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "simpletest.qpb.h"
+
+#include <QProtobufDynamicMessage>
+#include <QProtobufSerializer>
+#include <QProtobufWireFormat>
+
+#include <gtest/gtest.h>
+
+using namespace qtprotobufnamespace::tests;
+
+namespace QtProtobuf {
+namespace tests {
+
+class DynamicMessageTest : public ::testing::Test
+{
+public:
+    DynamicMessageTest() = default;
+    void SetUp() override {
+        serializer.reset(new QProtobufSerializer);
+    }
+    static void SetUpTestCase() {
+        QtProtobuf::qRegisterProtobufTypes();
+    }
+
+protected:
+    static QByteArray fieldProto(const QString &name, int number, int label, int type, const QString &typeName = {}) {
+        QByteArray result;
+        QProtobufWireFormat::writeField(result, 1, name);
+        QProtobufWireFormat::writeField(result, 3, int32(number));
+        QProtobufWireFormat::writeField(result, 4, int32(label));
+        QProtobufWireFormat::writeField(result, 5, int32(type));
+        QProtobufWireFormat::writeField(result, 6, typeName);
+        return result;
+    }
+
+    //package example; message Point { sint32 x = 1; sint32 y = 2; }
+    //message Path { string name = 1; repeated Point points = 2; repeated int32 tags = 3; }
+    static QByteArray descriptorSet() {
+        QByteArray point;
+        QProtobufWireFormat::writeField(point, 1, QString("Point"));
+        QProtobufWireFormat::writeField(point, 2, fieldProto("x", 1, 1, 17));
+        QProtobufWireFormat::writeField(point, 2, fieldProto("y", 2, 1, 17));
+
+        QByteArray path;
+        QProtobufWireFormat::writeField(path, 1, QString("Path"));
+        QProtobufWireFormat::writeField(path, 2, fieldProto("name", 1, 1, 9));
+        QProtobufWireFormat::writeField(path, 2, fieldProto("points", 2, 3, 11, ".example.Point"));
+        QProtobufWireFormat::writeField(path, 2, fieldProto("tags", 3, 3, 5));
+
+        QByteArray file;
+        QProtobufWireFormat::writeField(file, 2, QString("example"));
+        QProtobufWireFormat::writeField(file, 4, path);
+        QProtobufWireFormat::writeField(file, 4, point);
+        QProtobufWireFormat::writeField(file, 12, QString("proto3"));
+
+        QByteArray set;
+        QProtobufWireFormat::writeField(set, 1, file);
+        return set;
+    }
+
+    std::unique_ptr<QProtobufSerializer> serializer;
+};
+
+TEST_F(DynamicMessageTest, FileDescriptorSetTest)
+{
+    QProtobufDescriptorPool pool;
+    ASSERT_TRUE(pool.addFileDescriptorSet(descriptorSet()));
+    ASSERT_TRUE(pool.messageTypes() == QStringList({"example.Path", "example.Point"}));
+
+    const QProtobufMessageDescriptor *path = pool.find("example.Path");
+    ASSERT_TRUE(path != nullptr);
+    ASSERT_EQ(path->fields().size(), 3);
+    ASSERT_TRUE(path->fields()[1].messageType == pool.find("example.Point"));
+    ASSERT_TRUE(path->fields()[1].repeated);
+    ASSERT_TRUE(path->fields()[2].packed);
+
+    ASSERT_FALSE(pool.addFileDescriptorSet(QByteArray::fromHex("0a05")));
+}
+
+TEST_F(DynamicMessageTest, SerializationTest)
+{
+    QProtobufDescriptorPool pool;
+    pool.addFileDescriptorSet(descriptorSet());
+
+    QProtobufDynamicMessage point(pool.find("example.Point"));
+    ASSERT_TRUE(point.setValue("x", -1));
+    ASSERT_TRUE(point.setValue(2, 0));
+    ASSERT_TRUE(point.serialize() == QByteArray::fromHex("0801"));
+
+    QProtobufDynamicMessage path(pool.find("example.Path"));
+    ASSERT_TRUE(path.setValue("name", "p"));
+    ASSERT_TRUE(path.setValue("points", QVariantList({QVariant::fromValue(point), QVariant::fromValue(point)})));
+    ASSERT_TRUE(path.setValue("tags", QVariantList({0, 300})));
+    ASSERT_FALSE(path.setValue("points", QVariantList({1})));
+    ASSERT_FALSE(path.setValue(4, 1));
+
+    const QByteArray data = path.serialize();
+    ASSERT_STREQ(data.toHex().toStdString().c_str(), "0a017012020801120208011a0300ac02");
+
+    QProtobufDynamicMessage received(pool.find("example.Path"));
+    ASSERT_EQ(received.deserialize(data), NoDeserializationError);
+    ASSERT_TRUE(received == path);
+    ASSERT_STREQ(received.value("name").toString().toStdString().c_str(), "p");
+    ASSERT_EQ(received.value(2).toList().size(), 2);
+    ASSERT_EQ(received.value(2).toList()[0].value<QProtobufDynamicMessage>().value("x").toInt(), -1);
+    ASSERT_TRUE(received.value("tags").toList() == QVariantList({0, 300}));
+
+    const QVariantMap map = received.toVariantMap();
+    ASSERT_TRUE(map["name"] == QVariant("p"));
+    ASSERT_TRUE(map["tags"] == QVariant(QVariantList({0, 300})));
+    ASSERT_TRUE(map["points"].toList()[1].toMap()["x"] == QVariant(-1));
+}
+
+TEST_F(DynamicMessageTest, UnknownFieldsTest)
+{
+    QProtobufDescriptorPool pool;
+    pool.addFileDescriptorSet(descriptorSet());
+
+    //Non-packed tags, unknown field 5 and field with unexpected wire type are accepted
+    QProtobufDynamicMessage message(pool.find("example.Path"));
+    ASSERT_EQ(message.deserialize(QByteArray::fromHex("180118022807090100000000000000")), NoDeserializationError);
+    ASSERT_TRUE(message.value("tags").toList() == QVariantList({1, 2}));
+    ASSERT_TRUE(message.unknownFields() == QByteArray::fromHex("2807090100000000000000"));
+    ASSERT_TRUE(message.serialize() == QByteArray::fromHex("1a0201022807090100000000000000"));
+
+    ASSERT_EQ(message.deserialize(QByteArray::fromHex("0a05")), UnexpectedEndOfStreamError);
+}
+
+TEST_F(DynamicMessageTest, GeneratedTypesTest)
+{
+    QProtobufDescriptorPool pool;
+    const QProtobufMessageDescriptor *descriptor = pool.addMessageType(ComplexMessage::protobufMetaObject);
+    ASSERT_TRUE(descriptor != nullptr);
+    ASSERT_STREQ(descriptor->fullName().toStdString().c_str(), "qtprotobufnamespace.tests.ComplexMessage");
+    ASSERT_TRUE(pool.find("qtprotobufnamespace.tests.SimpleStringMessage") != nullptr);
+
+    ComplexMessage source(42, SimpleStringMessage{"qwerty"});
+    QProtobufDynamicMessage message(descriptor);
+    ASSERT_EQ(message.deserialize(source.serialize(serializer.get())), NoDeserializationError);
+    ASSERT_EQ(message.value("testFieldInt").toInt(), 42);
+    ASSERT_STREQ(message.value(2).value<QProtobufDynamicMessage>().value(6).toString().toStdString().c_str(), "qwerty");
+
+    ComplexMessage result;
+    result.deserialize(serializer.get(), message.serialize());
+    ASSERT_TRUE(result == source);
+}
+
+} // tests
+} // QtProtobuf
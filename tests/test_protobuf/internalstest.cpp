@@ -67,5 +67,89 @@ TEST_F(InternalsTest, NullPointerGetterMessageTest)
     ASSERT_TRUE(msg.testComplexField_p() != nullptr);
 }
 
+TEST_F(InternalsTest, PrecomputedWireTagTest)
+{
+    const auto &shortTag = SimpleIntMessage::propertyOrdering.at(1);
+    ASSERT_EQ(QtProtobuf::Varint, shortTag.wireType);
+    ASSERT_EQ(1, shortTag.wireTagSize);
+    ASSERT_EQ(0x08, static_cast<unsigned char>(shortTag.wireTag[0]));
+
+    const auto &longTag = FieldIndexTest1Message::propertyOrdering.at(31);
+    ASSERT_EQ(QtProtobuf::Varint, longTag.wireType);
+    ASSERT_EQ(2, longTag.wireTagSize);
+    ASSERT_EQ(0xf8, static_cast<unsigned char>(longTag.wireTag[0]));
+    ASSERT_EQ(0x01, static_cast<unsigned char>(longTag.wireTag[1]));
+}
+
+TEST_F(InternalsTest, PropertyOrderingLookupTest)
+{
+    const auto &ordering = ComplexMessage::propertyOrdering;
+    ASSERT_EQ(2u, ordering.size());
+    ASSERT_EQ(1, ordering.begin()->first);
+    ASSERT_EQ(2, (ordering.begin() + 1)->first);
+    ASSERT_TRUE(ordering.find(3) == ordering.end());
+    ASSERT_TRUE(ordering.find(0) == ordering.end());
+    ASSERT_TRUE(ordering.find(-1) == ordering.end());
+    ASSERT_THROW(ordering.at(3), std::out_of_range);
+
+    const auto &sparseOrdering = FieldIndexTest2Message::propertyOrdering;
+    ASSERT_EQ(1u, sparseOrdering.size());
+    ASSERT_TRUE(sparseOrdering.find(8191) != sparseOrdering.end());
+    ASSERT_EQ(1, sparseOrdering.at(8191).qtProperty);
+    ASSERT_TRUE(sparseOrdering.find(8190) == sparseOrdering.end());
+    ASSERT_TRUE(sparseOrdering.find(1) == sparseOrdering.end());
+}
+
+TEST_F(InternalsTest, FieldDescriptorsTest)
+{
+    const QtProtobuf::QProtobufFieldDescriptor *descriptors = ComplexMessage::protobufMetaObject.fieldDescriptors;
+    ASSERT_TRUE(descriptors != nullptr);
+    ASSERT_EQ(1, descriptors[0].fieldNumber);
+    ASSERT_EQ(QtProtobuf::Varint, descriptors[0].wireType);
+    ASSERT_TRUE(QtProtobuf::FieldKind::Int32 == descriptors[0].kind);
+    ASSERT_FALSE(descriptors[0].repeated);
+    ASSERT_STREQ("testFieldInt", descriptors[0].jsonName);
+    ASSERT_TRUE(descriptors[0].nestedType == nullptr);
+
+    ASSERT_EQ(2, descriptors[1].fieldNumber);
+    ASSERT_EQ(QtProtobuf::LengthDelimited, descriptors[1].wireType);
+    ASSERT_TRUE(QtProtobuf::FieldKind::Message == descriptors[1].kind);
+    ASSERT_EQ(&SimpleStringMessage::protobufMetaObject, descriptors[1].nestedType);
+
+    //Descriptors resolve the same metatypes as properties of meta-object
+    for (int i = 0; i < 2; i++) {
+        ASSERT_EQ(ComplexMessage::staticMetaObject.property(descriptors[i].qtProperty).userType(), descriptors[i].metaType());
+    }
+
+    const QtProtobuf::QProtobufFieldDescriptor &repeated = RepeatedComplexMessage::protobufMetaObject.fieldDescriptors[0];
+    ASSERT_TRUE(repeated.repeated);
+    ASSERT_EQ(&ComplexMessage::protobufMetaObject, repeated.nestedType);
+    ASSERT_EQ(RepeatedComplexMessage::staticMetaObject.property(repeated.qtProperty).userType(), repeated.metaType());
+}
+
+namespace {
+int lazyRegistrationCount = 0;
+QtProtobuf::LazyTypeRegistration lazyRegistration;
+void lazyRegistrationInitializer()
+{
+    ++lazyRegistrationCount;
+    //Recursive registration of the same type is ignored
+    QtProtobuf::registerTypeOnce(lazyRegistration, lazyRegistrationInitializer);
+}
+}
+
+TEST_F(InternalsTest, LazyTypeRegistrationTest)
+{
+    QtProtobuf::registerTypeOnce(lazyRegistration, lazyRegistrationInitializer);
+    QtProtobuf::registerTypeOnce(lazyRegistration, lazyRegistrationInitializer);
+    ASSERT_EQ(1, lazyRegistrationCount);
+    ASSERT_TRUE(lazyRegistration.registered);
+
+    //Types of fields are registered with message
+    RepeatedComplexMessage::ensureTypesRegistered();
+    ASSERT_NE(QMetaType::UnknownType, QMetaType::type("qtprotobufnamespace::tests::ComplexMessage*"));
+    ASSERT_NE(QMetaType::UnknownType, QMetaType::type("qtprotobufnamespace::tests::SimpleStringMessage*"));
+}
+
 }
 }
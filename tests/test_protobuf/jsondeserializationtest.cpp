@@ -258,6 +258,18 @@ TEST_F(JsonDeserializationTest, StringMessageSerializeTest)
     EXPECT_STREQ(test.testFieldString().toStdString().c_str(), "-Infinity");
 }
 
+TEST_F(JsonDeserializationTest, StringUnescapingDeserializeTest)
+{
+    SimpleStringMessage test;
+    test.deserialize(serializer.get(), QByteArray(R"({"testFieldString":"Tab\there \"q\" back\\slash \/ \u00e9 \ud83d\ude00"})"));
+    EXPECT_TRUE(test.testFieldString() == QString::fromUtf8("Tab\there \"q\" back\\slash / \xc3\xa9 \xf0\x9f\x98\x80"));
+
+    test.setTestFieldString(QString::fromUtf8("Round trip of \"quoted\"\r\n text with \\ and \x1f" " control \xc3\xa9"));
+    SimpleStringMessage copy;
+    copy.deserialize(serializer.get(), test.serialize(serializer.get()));
+    EXPECT_TRUE(copy.testFieldString() == test.testFieldString());
+}
+
 TEST_F(JsonDeserializationTest, BytesMessageSerializeTest)
 {
     SimpleBytesMessage test;
@@ -272,6 +284,24 @@ TEST_F(JsonDeserializationTest, BytesMessageSerializeTest)
     EXPECT_TRUE(test.testFieldBytes().isEmpty());
 }
 
+TEST_F(JsonDeserializationTest, BytesBase64RoundTripTest)
+{
+    SimpleBytesMessage test;
+    SimpleBytesMessage copy;
+    QByteArray data;
+    for (int i = 0; i < 20; ++i) {
+        test.setTestFieldBytes(data);
+        QByteArray json = test.serialize(serializer.get());
+        EXPECT_TRUE(json == QByteArray("{\"testFieldBytes\":\"") + data.toBase64() + "\"}");
+        copy.deserialize(serializer.get(), json);
+        EXPECT_TRUE(copy.testFieldBytes() == data);
+        data.append(static_cast<char>(0xF0 + i));
+    }
+
+    copy.deserialize(serializer.get(), QByteArray("{\"testFieldBytes\":\"-_-_\"}"));
+    EXPECT_STREQ(copy.testFieldBytes().toHex().toStdString().c_str(), "fbffbf");
+}
+
 TEST_F(JsonDeserializationTest, ComplexTypeSerializeTest)
 {
     ComplexMessage test;
@@ -316,6 +346,16 @@ TEST_F(JsonDeserializationTest, ComplexTypeSerializeTest)
 
 }
 
+TEST_F(JsonDeserializationTest, ComplexMessageWhitespaceAndNestingTest)
+{
+    ComplexMessage test;
+    test.deserialize(serializer.get(), QByteArray("{ \"unknownField\" : {\"a\":[1,{\"b\":\"}]\"}],\"c\":null},\n"
+                                                  "  \"testComplexField\" : { \"testFieldString\" : \"a \\\"quoted\\\" {value}\" } ,\n"
+                                                  "  \"testFieldInt\" : 42 }"));
+    EXPECT_STREQ(test.testComplexField().testFieldString().toStdString().c_str(), "a \"quoted\" {value}");
+    EXPECT_EQ(test.testFieldInt(), 42);
+}
+
 TEST_F(JsonDeserializationTest, RepeatedIntMessageTest)
 {
     RepeatedIntMessage test;
@@ -441,6 +481,23 @@ TEST_F(JsonDeserializationTest, RepeatedStringMessageTest)
     EXPECT_TRUE(test.testRepeatedString().isEmpty());
 }
 
+TEST_F(JsonDeserializationTest, RepeatedStringSeparatorsMessageTest)
+{
+    RepeatedStringMessage test;
+    test.deserialize(serializer.get(), "{\"testRepeatedString\":[ \"a,b\" , \"[c]\",\"{d}\",\"e\\\",f\" ]}");
+    EXPECT_TRUE(test.testRepeatedString() == QStringList({"a,b","[c]","{d}","e\",f"}));
+
+    QStringList large;
+    QByteArray json("{\"testRepeatedString\":[");
+    for (int i = 0; i < 1000; ++i) {
+        large.append(QString::number(i));
+        json.append(i > 0 ? ",\"" : "\"").append(QByteArray::number(i)).append("\"");
+    }
+    json.append("]}");
+    test.deserialize(serializer.get(), json);
+    EXPECT_TRUE(test.testRepeatedString() == large);
+}
+
 TEST_F(JsonDeserializationTest, RepeatedDoubleMessageTest)
 {
     RepeatedDoubleMessage test;
@@ -554,6 +611,14 @@ TEST_F(JsonDeserializationTest, SimpleEnumMessageSerializeTest)
     EXPECT_EQ(test.localEnum(), SimpleEnumMessage::LOCAL_ENUM_VALUE2);
 }
 
+TEST_F(JsonDeserializationTest, SimpleFileEnumMessageDeserializeTest)
+{
+    SimpleFileEnumMessage test;
+    test.deserialize(serializer.get(), "{\"globalEnum\":\"TEST_ENUM_VALUE3\",\"globalEnumList\":[\"TEST_ENUM_VALUE4\",\"TEST_ENUM_VALUE3\"]}");
+    EXPECT_EQ(test.globalEnum(), TestEnumGadget::TEST_ENUM_VALUE3);
+    EXPECT_TRUE(test.globalEnumList() == TestEnumGadget::TestEnumRepeated({TestEnumGadget::TEST_ENUM_VALUE4, TestEnumGadget::TEST_ENUM_VALUE3}));
+}
+
 
 TEST_F(JsonDeserializationTest, SimpleEnumListMessageTest)
 {
@@ -595,6 +660,18 @@ TEST_F(JsonDeserializationTest, RepeatedComplexMessageTest)
     EXPECT_TRUE(test.testRepeatedComplex().isEmpty());
 }
 
+TEST_F(JsonDeserializationTest, NestedComplexMessageMapTest)
+{
+    SimpleStringComplexMessageMapMessage test;
+    test.deserialize(serializer.get(), "{\"mapField\":{\"first\":{\"testFieldInt\":1,\"testComplexField\":{\"testFieldString\":\"{[,]}\"}},"
+                                       " \"second\" : {\"testComplexField\":{\"testFieldString\":\"qwerty\"},\"testFieldInt\":2}}}");
+    ASSERT_EQ(test.mapField().size(), 2);
+    EXPECT_EQ(test.mapField()["first"]->testFieldInt(), 1);
+    EXPECT_STREQ(test.mapField()["first"]->testComplexField().testFieldString().toStdString().c_str(), "{[,]}");
+    EXPECT_EQ(test.mapField()["second"]->testFieldInt(), 2);
+    EXPECT_STREQ(test.mapField()["second"]->testComplexField().testFieldString().toStdString().c_str(), "qwerty");
+}
+
 TEST_F(JsonDeserializationTest, SimpleFixed32StringMapSerializeTest)
 {
     SimpleFixed32StringMapMessage test;
@@ -744,5 +821,18 @@ TEST_F(JsonDeserializationTest, SimpleStringStringMapSerializeTest)
     ASSERT_EQ(test.mapField().size(), 0);
 }
 
+TEST_F(JsonDeserializationTest, ProtoFieldNameDeserializeTest)
+{
+    MessageUnderscoreField msg;
+    msg.deserialize(serializer.get(), QByteArray("{\"underScoreMessageField\":42}"));
+    EXPECT_EQ(msg.underScoreMessageField(), 42);
+
+    msg.deserialize(serializer.get(), QByteArray("{\"underScore_Message_field\":-15}"));
+    EXPECT_EQ(msg.underScoreMessageField(), -15);
+
+    msg.deserialize(serializer.get(), QByteArray("{\"underScoreMessage_field\":7}"));
+    EXPECT_EQ(msg.underScoreMessageField(), 0);
+}
+
 }
 }
@@ -24,10 +24,14 @@
  */
 
 #include <gtest/gtest.h>
+#include <QBuffer>
 #include <QByteArray>
 #include <QString>
+#include <limits>
 
 #include <qprotobufjsonserializer.h>
+#include <qprotobufjsonlinesstream.h>
+#include <qprotobufserializer.h>
 
 #include "simpletest.qpb.h"
 
@@ -138,6 +142,30 @@ TEST_F(JsonSerializationTest, UInt64MessageSerializeTest)
     ASSERT_STREQ(QString::fromUtf8(result).toStdString().c_str(), "{\"testFieldInt\":555}");
 }
 
+TEST_F(JsonSerializationTest, IntegerLimitsSerializeTest)
+{
+    SimpleSInt64Message msg;
+    msg.setTestFieldInt(std::numeric_limits<int64_t>::min());
+    QByteArray result = msg.serialize(serializer.get());
+    ASSERT_STREQ(QString::fromUtf8(result).toStdString().c_str(), "{\"testFieldInt\":-9223372036854775808}");
+
+    msg.setTestFieldInt(std::numeric_limits<int64_t>::max());
+    result = msg.serialize(serializer.get());
+    ASSERT_STREQ(QString::fromUtf8(result).toStdString().c_str(), "{\"testFieldInt\":9223372036854775807}");
+
+    SimpleUInt64Message unsignedMsg;
+    unsignedMsg.setTestFieldInt(std::numeric_limits<uint64_t>::max());
+    result = unsignedMsg.serialize(serializer.get());
+    ASSERT_STREQ(QString::fromUtf8(result).toStdString().c_str(), "{\"testFieldInt\":18446744073709551615}");
+}
+
+TEST_F(JsonSerializationTest, EmptyMessageSerializeTest)
+{
+    EmptyMessage msg;
+    QByteArray result = msg.serialize(serializer.get());
+    ASSERT_STREQ(QString::fromUtf8(result).toStdString().c_str(), "{}");
+}
+
 
 TEST_F(JsonSerializationTest, FloatMessageSerializeTest)
 {
@@ -148,11 +176,11 @@ TEST_F(JsonSerializationTest, FloatMessageSerializeTest)
 
     test.setTestFieldFloat(FLT_MIN);
     result = test.serialize(serializer.get());
-    EXPECT_STREQ(QString::fromUtf8(result).toStdString().c_str(), "{\"testFieldFloat\":1.17549e-38}");
+    EXPECT_STREQ(QString::fromUtf8(result).toStdString().c_str(), "{\"testFieldFloat\":1.1754944e-38}");
 
     test.setTestFieldFloat(FLT_MAX);
     result = test.serialize(serializer.get());
-    EXPECT_STREQ(QString::fromUtf8(result).toStdString().c_str(), "{\"testFieldFloat\":3.40282e+38}");
+    EXPECT_STREQ(QString::fromUtf8(result).toStdString().c_str(), "{\"testFieldFloat\":3.4028235e+38}");
 
     test.setTestFieldFloat(-4.2f);
     result = test.serialize(serializer.get());
@@ -195,6 +223,15 @@ TEST_F(JsonSerializationTest, StringMessageSerializeTest)
     EXPECT_STREQ(QString::fromUtf8(result).toStdString().c_str(), "{\"testFieldString\":\"qwerty\"}");
 }
 
+TEST_F(JsonSerializationTest, StringEscapingSerializeTest)
+{
+    SimpleStringMessage test;
+    test.setTestFieldString("Long text without escaped characters, \"quoted\"\n\tC:\\path\x01" "end");
+    QByteArray result = test.serialize(serializer.get());
+    EXPECT_STREQ(QString::fromUtf8(result).toStdString().c_str(),
+                 R"({"testFieldString":"Long text without escaped characters, \"quoted\"\n\tC:\\path\u0001end"})");
+}
+
 TEST_F(JsonSerializationTest, BytesMessageSerializeTest)
 {
     SimpleBytesMessage test;
@@ -409,6 +446,27 @@ TEST_F(JsonSerializationTest, RepeatedFloatMessageTest)
     EXPECT_STREQ(QString::fromUtf8(result).toStdString().c_str(), "{\"testRepeatedFloat\":[]}");
 }
 
+TEST_F(JsonSerializationTest, FloatingPointRoundTripTest)
+{
+    RepeatedFloatMessage floatTest;
+    floatTest.setTestRepeatedFloat({1.0f / 3.0f, 16777216.0f, 1e-7f, -1.5e30f});
+    QByteArray result = floatTest.serialize(serializer.get());
+    EXPECT_STREQ(result.toStdString().c_str(), "{\"testRepeatedFloat\":[0.33333334,16777216,1e-7,-1.5e+30]}");
+
+    RepeatedFloatMessage floatCopy;
+    floatCopy.deserialize(serializer.get(), result);
+    EXPECT_TRUE(floatCopy.testRepeatedFloat() == floatTest.testRepeatedFloat());
+
+    RepeatedDoubleMessage doubleTest;
+    doubleTest.setTestRepeatedDouble({1.0 / 3.0, 1e21, 0.000001, 123456.789});
+    result = doubleTest.serialize(serializer.get());
+    EXPECT_STREQ(result.toStdString().c_str(), "{\"testRepeatedDouble\":[0.3333333333333333,1e+21,0.000001,123456.789]}");
+
+    RepeatedDoubleMessage doubleCopy;
+    doubleCopy.deserialize(serializer.get(), result);
+    EXPECT_TRUE(doubleCopy.testRepeatedDouble() == doubleTest.testRepeatedDouble());
+}
+
 TEST_F(JsonSerializationTest, RepeatedComplexMessageTest)
 {
     SimpleStringMessage stringMsg;
@@ -447,6 +505,17 @@ TEST_F(JsonSerializationTest, SimpleEnumMessageSerializeTest)
     EXPECT_STREQ(QString::fromUtf8(result).toStdString().c_str(), "{\"localEnum\":\"LOCAL_ENUM_VALUE2\"}");
 }
 
+TEST_F(JsonSerializationTest, SimpleFileEnumMessageSerializeTest)
+{
+    //TEST_ENUM_VALUE3 and TEST_ENUM_VALUE4 values don't match their key indices
+    SimpleFileEnumMessage test;
+    test.setGlobalEnum(TestEnumGadget::TEST_ENUM_VALUE3);
+    test.setGlobalEnumList({TestEnumGadget::TEST_ENUM_VALUE4, TestEnumGadget::TEST_ENUM_VALUE3});
+    QByteArray result = test.serialize(serializer.get());
+    EXPECT_STREQ(QString::fromUtf8(result).toStdString().c_str(),
+                 "{\"globalEnum\":\"TEST_ENUM_VALUE3\",\"globalEnumList\":[\"TEST_ENUM_VALUE4\",\"TEST_ENUM_VALUE3\"]}");
+}
+
 
 TEST_F(JsonSerializationTest, SimpleEnumListMessageTest)
 {
@@ -574,5 +643,176 @@ TEST_F(JsonSerializationTest, SimpleStringStringMapSerializeTest)
                  "{\"mapField\":{\"ben\":\"ten\",\"sweet\":\"fifteen\",\"what is the answer?\":\"fourty two\"}}");
 }
 
+TEST_F(JsonSerializationTest, OmitDefaultValuesSerializeTest)
+{
+    serializer->setOmitDefaultValuesEnabled(true);
+
+    ComplexMessage test;
+    ASSERT_STREQ(test.serialize(serializer.get()).toStdString().c_str(), "{}");
+
+    test.setTestFieldInt(42);
+    ASSERT_STREQ(test.serialize(serializer.get()).toStdString().c_str(), "{\"testFieldInt\":42}");
+
+    SimpleStringMessage stringMsg;
+    stringMsg.setTestFieldString("qwerty");
+    test.setTestFieldInt(0);
+    test.setTestComplexField(stringMsg);
+    ASSERT_STREQ(test.serialize(serializer.get()).toStdString().c_str(), "{\"testComplexField\":{\"testFieldString\":\"qwerty\"}}");
+
+    RepeatedIntMessage repeated;
+    ASSERT_STREQ(repeated.serialize(serializer.get()).toStdString().c_str(), "{}");
+    repeated.setTestRepeatedInt({0});
+    ASSERT_STREQ(repeated.serialize(serializer.get()).toStdString().c_str(), "{\"testRepeatedInt\":[0]}");
+
+    SimpleEnumMessage enumMsg;
+    enumMsg.setLocalEnum(SimpleEnumMessage::LOCAL_ENUM_VALUE0);
+    ASSERT_STREQ(enumMsg.serialize(serializer.get()).toStdString().c_str(), "{}");
+
+    SimpleStringStringMapMessage mapMsg;
+    ASSERT_STREQ(mapMsg.serialize(serializer.get()).toStdString().c_str(), "{}");
+}
+
+TEST_F(JsonSerializationTest, ProtoFieldNamesSerializeTest)
+{
+    MessageUnderscoreField test;
+    test.setUnderScoreMessageField(123);
+    serializer->setProtoFieldNamesEnabled(true);
+    QByteArray result = test.serialize(serializer.get());
+    ASSERT_STREQ(result.toStdString().c_str(), "{\"underScore_Message_field\":123}");
+
+    MessageUnderscoreField deserialized;
+    deserialized.deserialize(serializer.get(), result);
+    ASSERT_EQ(123, deserialized.underScoreMessageField());
+}
+
+TEST_F(JsonSerializationTest, EnumsAsIntegersSerializeTest)
+{
+    serializer->setEnumsAsIntegersEnabled(true);
+    SimpleEnumMessage test;
+    test.setLocalEnum(SimpleEnumMessage::LOCAL_ENUM_VALUE2);
+    QByteArray result = test.serialize(serializer.get());
+    ASSERT_STREQ(result.toStdString().c_str(), "{\"localEnum\":2}");
+
+    SimpleEnumMessage deserialized;
+    deserialized.deserialize(serializer.get(), result);
+    ASSERT_EQ(SimpleEnumMessage::LOCAL_ENUM_VALUE2, deserialized.localEnum());
+
+    SimpleEnumListMessage listMsg;
+    listMsg.setLocalEnumList({SimpleEnumListMessage::LOCAL_ENUM_VALUE1, SimpleEnumListMessage::LOCAL_ENUM_VALUE3});
+    ASSERT_STREQ(listMsg.serialize(serializer.get()).toStdString().c_str(), "{\"localEnumList\":[1,3]}");
+}
+
+TEST_F(JsonSerializationTest, BinaryTranscodingTest)
+{
+    QProtobufSerializer binarySerializer;
+
+    ComplexMessage test;
+    test.setTestFieldInt(42);
+    test.setTestComplexField(SimpleStringMessage{"qwerty"});
+    QByteArray json = serializer->transcodeFromBinary<ComplexMessage>(test.serialize(&binarySerializer));
+    ASSERT_TRUE(json == test.serialize(serializer.get()));
+
+    ComplexMessage result;
+    result.deserialize(&binarySerializer, serializer->transcodeToBinary<ComplexMessage>(json));
+    ASSERT_TRUE(result == test);
+
+    SimpleInt32ComplexMessageMapMessage mapTest;
+    mapTest.setMapField({{10, QSharedPointer<ComplexMessage>(new ComplexMessage{16 , {"ten sixteen"}})},
+                         {-42, QSharedPointer<ComplexMessage>(new ComplexMessage{10 , {"minus fourty two"}})}});
+    json = serializer->transcodeFromBinary<SimpleInt32ComplexMessageMapMessage>(mapTest.serialize(&binarySerializer));
+    ASSERT_TRUE(json == mapTest.serialize(serializer.get()));
+
+    SimpleInt32ComplexMessageMapMessage mapResult;
+    mapResult.deserialize(&binarySerializer, serializer->transcodeToBinary<SimpleInt32ComplexMessageMapMessage>(json));
+    ASSERT_EQ(2, mapResult.mapField().count());
+    ASSERT_EQ(16, mapResult.mapField()[10]->testFieldInt());
+    ASSERT_STREQ("minus fourty two", mapResult.mapField()[-42]->testComplexField().testFieldString().toStdString().c_str());
+
+    RepeatedComplexMessage repeatedTest;
+    repeatedTest.setTestRepeatedComplex({QSharedPointer<ComplexMessage>(new ComplexMessage{1, {"one"}}),
+                                         QSharedPointer<ComplexMessage>(new ComplexMessage{2, {"two"}})});
+    json = serializer->transcodeFromBinary<RepeatedComplexMessage>(repeatedTest.serialize(&binarySerializer));
+    ASSERT_TRUE(json == repeatedTest.serialize(serializer.get()));
+
+    RepeatedComplexMessage repeatedResult;
+    repeatedResult.deserialize(&binarySerializer, serializer->transcodeToBinary<RepeatedComplexMessage>(json));
+    ASSERT_EQ(2, repeatedResult.testRepeatedComplex().count());
+    ASSERT_EQ(2, repeatedResult.testRepeatedComplex()[1]->testFieldInt());
+
+    SimpleEnumListMessage enumTest;
+    enumTest.setLocalEnumList({SimpleEnumListMessage::LOCAL_ENUM_VALUE1, SimpleEnumListMessage::LOCAL_ENUM_VALUE3});
+    json = serializer->transcodeFromBinary<SimpleEnumListMessage>(enumTest.serialize(&binarySerializer));
+    ASSERT_STREQ(json.toStdString().c_str(), "{\"localEnumList\":[\"LOCAL_ENUM_VALUE1\",\"LOCAL_ENUM_VALUE3\"]}");
+    ASSERT_TRUE(serializer->transcodeToBinary<SimpleEnumListMessage>(json) == enumTest.serialize(&binarySerializer));
+}
+
+TEST_F(JsonSerializationTest, JsonLinesStreamTest)
+{
+    QBuffer device;
+    ASSERT_TRUE(device.open(QIODevice::ReadWrite));
+    {
+        QProtobufJsonLinesStream stream(&device, serializer.get());
+        for (int i = 0; i < 10000; ++i) {
+            SimpleIntMessage test;
+            test.setTestFieldInt(i);
+            ASSERT_TRUE(stream.write(test));
+        }
+        SimpleStringMessage stringMsg;
+        stringMsg.setTestFieldString("multi\nline");
+        ASSERT_TRUE(stream.write(stringMsg));
+    }
+    //Messages are coalesced, but all of them are written when stream is destroyed
+    ASSERT_TRUE(device.data().startsWith("{\"testFieldInt\":0}\n{\"testFieldInt\":1}\n"));
+    ASSERT_TRUE(device.data().endsWith("{\"testFieldInt\":9999}\n{\"testFieldString\":\"multi\\nline\"}\n"));
+
+    device.seek(0);
+    QProtobufJsonLinesStream stream(&device, serializer.get());
+    SimpleIntMessage test;
+    for (int i = 0; i < 10000; ++i) {
+        ASSERT_TRUE(stream.read(&test));
+        ASSERT_EQ(i, test.testFieldInt());
+    }
+    SimpleStringMessage stringMsg;
+    ASSERT_TRUE(stream.read(&stringMsg));
+    ASSERT_STREQ("multi\nline", stringMsg.testFieldString().toStdString().c_str());
+    ASSERT_FALSE(stream.read(&test));
+    ASSERT_FALSE(stream.hasError());
+
+    QByteArray data("{\"testFieldInt\":1}\r\n\n{\"testFieldInt\":2}");
+    QProtobufJsonLinesStream dataStream(data, serializer.get());
+    ASSERT_TRUE(dataStream.read(&test));
+    ASSERT_EQ(1, test.testFieldInt());
+    ASSERT_TRUE(dataStream.read(&test));
+    ASSERT_EQ(2, test.testFieldInt());
+    ASSERT_FALSE(dataStream.read(&test));
+    ASSERT_FALSE(dataStream.write(test));
+}
+
+TEST_F(JsonSerializationTest, SerializeToDeviceTest)
+{
+    SimpleStringMessage stringMsg;
+    stringMsg.setTestFieldString("qwerty");
+    QList<QSharedPointer<ComplexMessage>> list;
+    for (int i = 0; i < 10000; ++i) {
+        QSharedPointer<ComplexMessage> msg(new ComplexMessage);
+        msg->setTestFieldInt(i);
+        msg->setTestComplexField(stringMsg);
+        list.append(msg);
+    }
+    RepeatedComplexMessage test;
+    test.setTestRepeatedComplex(list);
+
+    QBuffer device;
+    ASSERT_TRUE(device.open(QIODevice::WriteOnly));
+    ASSERT_TRUE(serializer->serializeTo<RepeatedComplexMessage>(&test, &device));
+    QByteArray result = test.serialize(serializer.get());
+    ASSERT_GT(result.size(), 64 * 1024);
+    ASSERT_TRUE(device.data() == result);
+
+    QBuffer readOnlyDevice;
+    ASSERT_TRUE(readOnlyDevice.open(QIODevice::ReadOnly));
+    ASSERT_FALSE(serializer->serializeTo<RepeatedComplexMessage>(&test, &readOnlyDevice));
+}
+
 }
 }
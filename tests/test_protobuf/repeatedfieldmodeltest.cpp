@@ -0,0 +1,133 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "simpletest.qpb.h"
+
+#include <QProtobufRepeatedFieldModel>
+#include <QSignalSpy>
+
+#include <gtest/gtest.h>
+
+using namespace qtprotobufnamespace::tests;
+
+namespace QtProtobuf {
+namespace tests {
+
+class RepeatedFieldModelTest : public ::testing::Test
+{
+public:
+    RepeatedFieldModelTest() = default;
+    static void SetUpTestCase() {
+        QtProtobuf::qRegisterProtobufTypes();
+    }
+
+protected:
+    static ComplexMessageRepeated complexList(std::initializer_list<std::pair<int, const char *>> values) {
+        ComplexMessageRepeated list;
+        for (const auto &value : values) {
+            list.append(QSharedPointer<ComplexMessage>(new ComplexMessage(value.first, SimpleStringMessage{value.second})));
+        }
+        return list;
+    }
+};
+
+TEST_F(RepeatedFieldModelTest, UpdateInPlaceTest)
+{
+    QProtobufRepeatedFieldModel<ComplexMessage> model;
+    model.setKeyProperty("testFieldInt");
+    model.update(complexList({{1, "a"}, {2, "b"}, {3, "c"}}));
+    ASSERT_EQ(model.rowCount(), 3);
+    ComplexMessage *second = model.items().at(1).data();
+
+    QSignalSpy insertedSpy(&model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy removedSpy(&model, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy changedSpy(&model, &QAbstractItemModel::dataChanged);
+    QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+
+    model.update(complexList({{1, "a"}, {2, "bb"}, {3, "c"}}));
+    EXPECT_EQ(insertedSpy.count(), 0);
+    EXPECT_EQ(removedSpy.count(), 0);
+    EXPECT_EQ(resetSpy.count(), 0);
+    ASSERT_EQ(changedSpy.count(), 1);
+    EXPECT_EQ(changedSpy.at(0).at(0).value<QModelIndex>().row(), 1);
+    EXPECT_EQ(model.items().at(1).data(), second);
+    EXPECT_STREQ(second->testComplexField().testFieldString().toStdString().c_str(), "bb");
+}
+
+TEST_F(RepeatedFieldModelTest, InsertRemoveTest)
+{
+    QProtobufRepeatedFieldModel<ComplexMessage> model;
+    model.setKeyProperty("testFieldInt");
+    model.update(complexList({{1, "a"}, {2, "b"}, {3, "c"}}));
+    ComplexMessage *third = model.items().at(2).data();
+
+    QSignalSpy insertedSpy(&model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy removedSpy(&model, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy countSpy(&model, &QProtobufRepeatedFieldModelBase::countChanged);
+
+    model.update(complexList({{1, "a"}, {3, "c"}, {4, "d"}}));
+    ASSERT_EQ(removedSpy.count(), 1);
+    EXPECT_EQ(removedSpy.at(0).at(1).toInt(), 1);
+    ASSERT_EQ(insertedSpy.count(), 1);
+    EXPECT_EQ(insertedSpy.at(0).at(1).toInt(), 2);
+    EXPECT_EQ(countSpy.count(), 0);
+    ASSERT_EQ(model.rowCount(), 3);
+    EXPECT_EQ(model.items().at(1).data(), third);
+    EXPECT_EQ(model.items().at(2)->testFieldInt(), 4);
+
+    model.update({});
+    EXPECT_EQ(model.rowCount(), 0);
+    EXPECT_EQ(countSpy.count(), 1);
+}
+
+TEST_F(RepeatedFieldModelTest, MoveTest)
+{
+    QProtobufRepeatedFieldModel<ComplexMessage> model;
+    model.update(complexList({{1, "a"}, {2, "b"}, {3, "c"}}));
+    ComplexMessage *first = model.items().at(0).data();
+
+    QSignalSpy movedSpy(&model, &QAbstractItemModel::rowsMoved);
+    QSignalSpy insertedSpy(&model, &QAbstractItemModel::rowsInserted);
+
+    model.update(complexList({{2, "b"}, {3, "c"}, {1, "a"}}));
+    EXPECT_EQ(insertedSpy.count(), 0);
+    EXPECT_FALSE(movedSpy.isEmpty());
+    EXPECT_EQ(model.items().at(2).data(), first);
+}
+
+TEST_F(RepeatedFieldModelTest, RolesTest)
+{
+    QProtobufRepeatedFieldModel<ComplexMessage> model;
+    model.update(complexList({{5, "a"}}));
+    const QHash<int, QByteArray> roles = model.roleNames();
+    const int intRole = roles.key("testFieldInt");
+    ASSERT_NE(intRole, 0);
+    EXPECT_EQ(model.data(model.index(0), intRole).toInt(), 5);
+    EXPECT_EQ(model.data(model.index(0), roles.key("modelData")).value<QObject *>(), model.get(0));
+    EXPECT_EQ(model.get(1), nullptr);
+}
+
+} // tests
+} // QtProtobuf
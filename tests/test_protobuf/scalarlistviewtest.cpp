@@ -0,0 +1,102 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "simpletest.qpb.h"
+
+#include <QProtobufScalarListView>
+#include <QSignalSpy>
+
+#include <gtest/gtest.h>
+
+using namespace qtprotobufnamespace::tests;
+
+namespace QtProtobuf {
+namespace tests {
+
+class ScalarListViewTest : public ::testing::Test
+{
+public:
+    ScalarListViewTest() = default;
+    static void SetUpTestCase() {
+        QtProtobuf::qRegisterProtobufTypes();
+    }
+};
+
+TEST_F(ScalarListViewTest, PropertyTest)
+{
+    RepeatedDoubleMessage test;
+    QProtobufScalarListView *view = test.testRepeatedDoubleView();
+    ASSERT_TRUE(view != nullptr);
+    ASSERT_EQ(view, test.testRepeatedDoubleView());
+    ASSERT_EQ(&test, view->parent());
+    ASSERT_EQ(view, test.property("testRepeatedDoubleView").value<QProtobufScalarListView *>());
+    ASSERT_EQ(0, view->count());
+}
+
+TEST_F(ScalarListViewTest, ElementsTest)
+{
+    RepeatedDoubleMessage test;
+    QProtobufScalarListView *view = test.testRepeatedDoubleView();
+    QSignalSpy spy(view, &QProtobufScalarListView::changed);
+
+    test.setTestRepeatedDouble({0.1, 0.2, 0.3, 0.4});
+    ASSERT_EQ(1, spy.count());
+    ASSERT_EQ(4, view->count());
+    ASSERT_DOUBLE_EQ(0.3, view->at(2));
+    ASSERT_DOUBLE_EQ(0.0, view->at(4));
+    ASSERT_DOUBLE_EQ(0.0, view->at(-1));
+
+    QByteArray buffer = view->toArrayBuffer();
+    ASSERT_EQ(4 * static_cast<int>(sizeof(double)), buffer.size());
+    const double *values = reinterpret_cast<const double *>(buffer.constData());
+    ASSERT_DOUBLE_EQ(0.1, values[0]);
+    ASSERT_DOUBLE_EQ(0.4, values[3]);
+
+    buffer = view->toArrayBuffer(1, 2);
+    ASSERT_EQ(2 * static_cast<int>(sizeof(double)), buffer.size());
+    values = reinterpret_cast<const double *>(buffer.constData());
+    ASSERT_DOUBLE_EQ(0.2, values[0]);
+    ASSERT_DOUBLE_EQ(0.3, values[1]);
+
+    ASSERT_EQ(sizeof(double), static_cast<size_t>(view->toArrayBuffer(3, 10).size()));
+    ASSERT_TRUE(view->toArrayBuffer(5).isEmpty());
+}
+
+TEST_F(ScalarListViewTest, IntegerElementsTest)
+{
+    RepeatedIntMessage test;
+    test.setTestRepeatedInt({1, -2, 3});
+    QProtobufScalarListView *view = test.testRepeatedIntView();
+    ASSERT_EQ(3, view->count());
+    ASSERT_DOUBLE_EQ(-2.0, view->at(1));
+
+    //View reads current content of field
+    test.setTestRepeatedInt({5});
+    ASSERT_EQ(1, view->count());
+    ASSERT_DOUBLE_EQ(5.0, view->at(0));
+}
+
+} // tests
+} // QtProtobuf
@@ -27,6 +27,13 @@
 
 #include "simpletest.qpb.h"
 
+#include <QBuffer>
+#include <qprotobufdelimitedstream.h>
+#include <qprotobufbufferallocator.h>
+#include <qprotobufserializerregistry_p.h>
+
+#include <thread>
+
 using namespace qtprotobufnamespace::tests;
 using namespace QtProtobuf::tests;
 using namespace QtProtobuf;
@@ -875,6 +882,14 @@ TEST_F(SerializationTest, StringMessageSerializeTest)
     test.setTestFieldString("oepSNLIVG08UJpk2W7JtTkkBxyK06X0lQ6ML7IMd55K8XC1Tpsc1kDWym5v8z68b4FQup9O95QSgAvjHIA15OX6Bu68esbQFT9LPzSADJ6qSGBTYBHX5QSZg32trCdHMj80XuDHqyBgM4uf6RKq2mgWb8Ovxxr0NwLxjHOfhJ8Mrfd2R7hbUgjespbYoQhbgHEj2gKEV3QvnumYmrVXe1BkCzZhKVXodDhj0OfAE67viAy4i3Oag1hr1z4Azo8O5Xq68POEZ1CsZPo2DXNNR8ebVCdYOz0Q6JLPSl5jasLCFrQN7EiVNjQmCrSsZHRgLNylvgoEFxGYxXJ9gmK4mr0OGdZcGJORRGZOQCpQMhXmhezFalNIJXMPPXaRVXiRhRAPCNUEie8DtaCWAMqz4nNUxRMZ5UcXBXsXPshygzkyyXnNWTIDojFlrcsnKqSkQ1G6E85gSZbtIYBh7sqO6GDXHjOrXVaVCVCUubjcJKThlyslt29zHuIs5JGppXxX1");
     result = test.serialize(serializer.get());
     ASSERT_STREQ(result.toHex().toStdString().c_str(), "3280046f6570534e4c4956473038554a706b3257374a74546b6b4278794b303658306c51364d4c37494d6435354b3858433154707363316b4457796d3576387a3638623446517570394f393551536741766a48494131354f583642753638657362514654394c507a5341444a367153474254594248583551535a67333274724364484d6a383058754448717942674d34756636524b71326d675762384f76787872304e774c786a484f66684a384d726664325237686255676a65737062596f5168626748456a32674b45563351766e756d596d7256586531426b437a5a684b56586f6444686a304f6641453637766941793469334f6167316872317a34417a6f384f3558713638504f455a3143735a506f3244584e4e52386562564364594f7a3051364a4c50536c356a61734c434672514e374569564e6a516d437253735a4852674c4e796c76676f454678475978584a39676d4b346d72304f47645a63474a4f5252475a4f514370514d68586d68657a46616c4e494a584d50505861525658695268524150434e55456965384474614357414d717a346e4e5578524d5a355563584258735850736879677a6b7979586e4e575449446f6a466c7263736e4b71536b5131473645383567535a6274495942683773714f36474458486a4f72585661564356435575626a634a4b54686c79736c7432397a48754973354a47707058785831");
+
+    //Strings are encoded to UTF-8 in place, result must match QString::toUtf8 including surrogates handling
+    const ushort unicode[] = {0x61, 0xe9, 0x20ac, 0xd83d, 0xde00, 0xd800, 0x62, 0xdc00};
+    const QString mixed = QString::fromUtf16(unicode, sizeof(unicode) / sizeof(unicode[0]));
+    test.setTestFieldString(mixed);
+    result = test.serialize(serializer.get());
+    const QByteArray utf8 = mixed.toUtf8();
+    ASSERT_TRUE(result == QByteArray("\x32") + static_cast<char>(utf8.size()) + utf8);
 }
 
 TEST_F(SerializationTest, ComplexTypeSerializeTest)
@@ -1302,6 +1317,426 @@ TEST_F(SerializationTest, EmptyStringMessageTest)
     ASSERT_TRUE(result.isEmpty());
 }
 
+TEST_F(SerializationTest, EmptyValueResetTest)
+{
+    SimpleStringMessage stringMsg("qwerty");
+    stringMsg.setTestFieldString("");
+    ASSERT_TRUE(stringMsg.serialize(serializer.get()).isEmpty());
+    ASSERT_EQ(0, stringMsg.byteSize(serializer.get()));
+    ASSERT_EQ(qHash(SimpleStringMessage()), qHash(stringMsg));
+
+    SimpleBytesMessage bytesMsg;
+    bytesMsg.setTestFieldBytes(QByteArray::fromHex("0102"));
+    bytesMsg.setTestFieldBytes(QByteArray(""));
+    ASSERT_TRUE(bytesMsg.serialize(serializer.get()).isEmpty());
+    ASSERT_EQ(0, bytesMsg.byteSize(serializer.get()));
+    ASSERT_EQ(qHash(SimpleBytesMessage()), qHash(bytesMsg));
+}
+
+TEST_F(SerializationTest, FieldPresenceTest)
+{
+    SimpleStringMessage msg("qwerty");
+    ASSERT_STREQ(msg.serialize(serializer.get()).toHex().toStdString().c_str(),
+                 "3206717765727479");
+
+    SimpleStringMessage copy(msg);
+    ASSERT_STREQ(copy.serialize(serializer.get()).toHex().toStdString().c_str(),
+                 "3206717765727479");
+
+    SimpleStringMessage moved(std::move(copy));
+    ASSERT_STREQ(moved.serialize(serializer.get()).toHex().toStdString().c_str(),
+                 "3206717765727479");
+
+    msg.clear();
+    ASSERT_TRUE(msg.serialize(serializer.get()).isEmpty());
+
+    msg = moved;
+    ASSERT_STREQ(msg.serialize(serializer.get()).toHex().toStdString().c_str(),
+                 "3206717765727479");
+
+    msg.setTestFieldString({});
+    ASSERT_TRUE(msg.serialize(serializer.get()).isEmpty());
+    ASSERT_EQ(0, msg.byteSize(serializer.get()));
+}
+
+TEST_F(SerializationTest, DeltaSerializationTest)
+{
+    ComplexMessage source;
+    source.setTestFieldInt(42);
+    source.markClean();
+
+    SimpleStringMessage stringMsg;
+    stringMsg.setTestFieldString("qwerty");
+    source.setTestComplexField(stringMsg);
+    QByteArray delta = source.serializeDelta(serializer.get());
+    ASSERT_STREQ(delta.toHex().toStdString().c_str(),
+                 "010212083206717765727479");
+
+    ComplexMessage target;
+    target.setTestFieldInt(7);
+    int intChangedCount = 0;
+    int complexChangedCount = 0;
+    QObject::connect(&target, &ComplexMessage::testFieldIntChanged, [&intChangedCount] { ++intChangedCount; });
+    QObject::connect(&target, &ComplexMessage::testComplexFieldChanged, [&complexChangedCount] { ++complexChangedCount; });
+
+    target.mergeDelta(serializer.get(), delta);
+    EXPECT_EQ(7, target.testFieldInt());
+    EXPECT_STREQ(target.testComplexField().testFieldString().toStdString().c_str(), "qwerty");
+    EXPECT_EQ(0, intChangedCount);
+    EXPECT_EQ(1, complexChangedCount);
+
+    //Fields changed to default values are applied as well
+    source.markClean();
+    source.setTestFieldInt(0);
+    delta = source.serializeDelta(serializer.get());
+    ASSERT_STREQ(delta.toHex().toStdString().c_str(),
+                 "0101");
+    target.mergeDelta(serializer.get(), delta);
+    EXPECT_EQ(0, target.testFieldInt());
+    EXPECT_STREQ(target.testComplexField().testFieldString().toStdString().c_str(), "qwerty");
+    EXPECT_EQ(1, intChangedCount);
+    EXPECT_EQ(1, complexChangedCount);
+
+    source.markClean();
+    delta = source.serializeDelta(serializer.get());
+    ASSERT_STREQ(delta.toHex().toStdString().c_str(),
+                 "00");
+    target.mergeDelta(serializer.get(), delta);
+    EXPECT_EQ(1, intChangedCount);
+    EXPECT_EQ(1, complexChangedCount);
+}
+
+TEST_F(SerializationTest, ByteSizeTest)
+{
+    SimpleStringMessage stringMsg;
+    stringMsg.setTestFieldString(QString(200, 'q'));
+
+    QSharedPointer<ComplexMessage> msg(new ComplexMessage);
+    msg->setTestFieldInt(-45);
+    msg->setTestComplexField(stringMsg);
+
+    RepeatedComplexMessage test;
+    ASSERT_EQ(0, test.byteSize(serializer.get()));
+
+    test.setTestRepeatedComplex({msg, msg, msg});
+    QByteArray result = test.serialize(serializer.get());
+    ASSERT_EQ(result.size(), test.byteSize(serializer.get()));
+
+    SimpleStringStringMapMessage mapMsg;
+    mapMsg.setMapField({{"key1", QString::fromUtf8("\xd0\xb7\xd0\xbd\xd0\xb0\xd1\x87\xd0\xb5\xd0\xbd\xd0\xb8\xd0\xb5")}, {"key2", "value2"}});
+    result = mapMsg.serialize(serializer.get());
+    ASSERT_EQ(result.size(), mapMsg.byteSize(serializer.get()));
+}
+
+TEST_F(SerializationTest, SerializeToDeviceTest)
+{
+    SimpleStringMessage stringMsg;
+    stringMsg.setTestFieldString("qwerty");
+    QList<QSharedPointer<ComplexMessage>> list;
+    for (int i = 0; i < 10000; ++i) {
+        QSharedPointer<ComplexMessage> msg(new ComplexMessage);
+        msg->setTestFieldInt(i);
+        msg->setTestComplexField(stringMsg);
+        list.append(msg);
+    }
+    RepeatedComplexMessage test;
+    test.setTestRepeatedComplex(list);
+
+    QBuffer device;
+    ASSERT_TRUE(device.open(QIODevice::WriteOnly));
+    ASSERT_TRUE(serializer->serializeTo<RepeatedComplexMessage>(&test, &device));
+    QByteArray result = test.serialize(serializer.get());
+    ASSERT_GT(result.size(), 64 * 1024);
+    ASSERT_TRUE(device.data() == result);
+
+    QBuffer readOnlyDevice;
+    ASSERT_TRUE(readOnlyDevice.open(QIODevice::ReadOnly));
+    ASSERT_FALSE(serializer->serializeTo<RepeatedComplexMessage>(&test, &readOnlyDevice));
+}
+
+TEST_F(SerializationTest, ParallelListSerializationTest)
+{
+    QList<QSharedPointer<ComplexMessage>> list;
+    for (int i = 0; i < 5000; ++i) {
+        QSharedPointer<ComplexMessage> msg(new ComplexMessage);
+        SimpleStringMessage stringMsg;
+        stringMsg.setTestFieldString(QString::number(i));
+        msg->setTestFieldInt(i);
+        msg->setTestComplexField(stringMsg);
+        list.append(msg);
+    }
+    RepeatedComplexMessage test;
+    test.setTestRepeatedComplex(list);
+
+    ASSERT_FALSE(serializer->isParallelListSerializationEnabled());
+    const QByteArray sequentialResult = test.serialize(serializer.get());
+
+    serializer->setParallelListSerializationEnabled(true);
+    const QByteArray parallelResult = test.serialize(serializer.get());
+    ASSERT_TRUE(parallelResult == sequentialResult);
+
+    RepeatedComplexMessage result;
+    result.deserialize(serializer.get(), parallelResult);
+    ASSERT_EQ(5000, result.testRepeatedComplex().count());
+    ASSERT_EQ(4999, result.testRepeatedComplex().last()->testFieldInt());
+    ASSERT_TRUE(result.testRepeatedComplex().last()->testComplexField().testFieldString() == QString("4999"));
+}
+
+TEST_F(SerializationTest, BatchSerializationTest)
+{
+    SimpleIntMessage first;
+    first.setTestFieldInt(15);
+    SimpleIntMessage second;
+    SimpleIntMessage third;
+    third.setTestFieldInt(300);
+
+    QByteArray result = serializer->serializeBatch<SimpleIntMessage>({&first, &second, &third});
+    ASSERT_STREQ(result.toHex().toStdString().c_str(), "02080f000308ac02");
+
+    QList<QSharedPointer<SimpleIntMessage>> messages = serializer->deserializeBatch<SimpleIntMessage>(result);
+    ASSERT_EQ(3, messages.count());
+    ASSERT_EQ(15, messages.at(0)->testFieldInt());
+    ASSERT_EQ(0, messages.at(1)->testFieldInt());
+    ASSERT_EQ(300, messages.at(2)->testFieldInt());
+
+    ASSERT_TRUE(serializer->serializeBatch<SimpleIntMessage>({}).isEmpty());
+    ASSERT_TRUE(serializer->deserializeBatch<SimpleIntMessage>(QByteArray()).isEmpty());
+
+    QtProtobufPrivate::DeserializationErrorScope scope;
+    messages = serializer->deserializeBatch<SimpleIntMessage>(QByteArray::fromHex("02080f0308"));
+    ASSERT_EQ(1, messages.count());
+    ASSERT_EQ(UnexpectedEndOfStreamError, scope.error());
+}
+
+TEST_F(SerializationTest, DelimitedStreamTest)
+{
+    QBuffer device;
+    ASSERT_TRUE(device.open(QIODevice::ReadWrite));
+    {
+        QProtobufDelimitedStream stream(&device, serializer.get());
+        for (int i = 0; i < 10000; ++i) {
+            SimpleIntMessage test;
+            test.setTestFieldInt(i);
+            ASSERT_TRUE(stream.write(test));
+        }
+        SimpleIntMessage empty;
+        ASSERT_TRUE(stream.write(empty));
+    }
+    //Messages are coalesced, but all of them are written when stream is destroyed
+    ASSERT_TRUE(device.data().startsWith(QByteArray::fromHex("000208010208")));
+
+    device.seek(0);
+    QProtobufDelimitedStream stream(&device, serializer.get());
+    SimpleIntMessage test;
+    for (int i = 0; i < 10000; ++i) {
+        ASSERT_TRUE(stream.read(&test));
+        ASSERT_EQ(i, test.testFieldInt());
+    }
+    test.setTestFieldInt(1);
+    ASSERT_TRUE(stream.read(&test));
+    ASSERT_EQ(0, test.testFieldInt());
+    ASSERT_FALSE(stream.read(&test));
+    ASSERT_FALSE(stream.hasError());
+
+    QBuffer truncatedDevice;
+    truncatedDevice.setData(QByteArray::fromHex("0208010208"));
+    ASSERT_TRUE(truncatedDevice.open(QIODevice::ReadOnly));
+    QProtobufDelimitedStream truncatedStream(&truncatedDevice, serializer.get());
+    ASSERT_TRUE(truncatedStream.read(&test));
+    ASSERT_EQ(1, test.testFieldInt());
+    ASSERT_FALSE(truncatedStream.read(&test));
+    ASSERT_TRUE(truncatedStream.hasError());
+}
+
+TEST_F(SerializationTest, BufferPoolTest)
+{
+    QProtobufBufferPool pool;
+    QByteArray buffer = pool.allocate(1000);
+    ASSERT_TRUE(buffer.isEmpty());
+    ASSERT_GE(buffer.capacity(), 1000);
+    const char *storage = buffer.constData();
+
+    //Shared buffer is not recycled
+    QByteArray copy = buffer;
+    pool.release(std::move(buffer));
+    ASSERT_EQ(0, pool.cachedSize());
+
+    buffer = std::move(copy);
+    buffer.append(QByteArray(900, 'a'));
+    pool.release(std::move(buffer));
+    ASSERT_GT(pool.cachedSize(), 0);
+
+    //Storage of released buffer is reused by allocation of the same size class
+    QByteArray reused = pool.allocate(950);
+    ASSERT_TRUE(reused.isEmpty());
+    ASSERT_EQ(storage, reused.constData());
+    ASSERT_EQ(0, pool.cachedSize());
+
+    pool.release(std::move(reused));
+    pool.trim();
+    ASSERT_EQ(0, pool.cachedSize());
+
+    //Serializer allocates output buffers using allocator of current thread
+    SimpleIntMessage test;
+    test.setTestFieldInt(15);
+    pool.release(pool.allocate(100));
+    {
+        QtProtobufPrivate::BufferAllocatorScope scope(&pool);
+        ASSERT_EQ(&pool, QProtobufBufferAllocator::current());
+        QByteArray result = test.serialize(serializer.get());
+        ASSERT_STREQ(result.toHex().toStdString().c_str(), "080f");
+        ASSERT_EQ(0, pool.cachedSize());
+        pool.release(std::move(result));
+        ASSERT_GT(pool.cachedSize(), 0);
+    }
+    ASSERT_NE(&pool, QProtobufBufferAllocator::current());
+}
+
+TEST_F(SerializationTest, OneofMessageTest)
+{
+    OneofMessage test;
+    ASSERT_EQ(OneofMessage::TestOneofCase::NotSet, test.testOneofCase());
+    test.setTestFieldInt(1);
+    ASSERT_TRUE(test.serialize(serializer.get()) == QByteArray::fromHex("0801"));
+
+    test.setTestOneofFieldInt(5);
+    ASSERT_EQ(OneofMessage::TestOneofCase::TestOneofFieldInt, test.testOneofCase());
+    ASSERT_TRUE(test.serialize(serializer.get()) == QByteArray::fromHex("0801100a"));
+
+    //Activation of other member resets previously active one
+    test.setTestOneofFieldString("ab");
+    ASSERT_EQ(OneofMessage::TestOneofCase::TestOneofFieldString, test.testOneofCase());
+    ASSERT_EQ(0, test.testOneofFieldInt());
+    ASSERT_TRUE(test.serialize(serializer.get()) == QByteArray::fromHex("08011a026162"));
+
+    ComplexMessage complex;
+    complex.setTestFieldInt(2);
+    test.setTestOneofComplexField(complex);
+    ASSERT_EQ(OneofMessage::TestOneofCase::TestOneofComplexField, test.testOneofCase());
+    ASSERT_TRUE(test.testOneofFieldString().isEmpty());
+    ASSERT_TRUE(test.serialize(serializer.get()).startsWith(QByteArray::fromHex("080122")));
+
+    //Inactive message member is not serialized
+    test.clearTestOneof();
+    ASSERT_EQ(OneofMessage::TestOneofCase::NotSet, test.testOneofCase());
+    ASSERT_TRUE(test.testOneofComplexField() == ComplexMessage());
+    ASSERT_TRUE(test.serialize(serializer.get()) == QByteArray::fromHex("0801"));
+}
+
+TEST_F(SerializationTest, OptionalFieldsTest)
+{
+    OptionalMessage test;
+    ASSERT_FALSE(test.hasTestFieldInt());
+    ASSERT_TRUE(test.serialize(serializer.get()).isEmpty());
+
+    //Optional fields that are set are sent even with default values
+    test.setTestFieldInt(0);
+    test.setTestFieldString("");
+    test.setTestFieldFixedInt32(0);
+    test.setTestFieldPlainInt(0);
+    ASSERT_TRUE(test.hasTestFieldInt());
+    ASSERT_TRUE(test.hasTestFieldString());
+    ASSERT_TRUE(test.hasTestFieldFixedInt32());
+    QByteArray result = test.serialize(serializer.get());
+    ASSERT_TRUE(result == QByteArray::fromHex("080012001d00000000"));
+    ASSERT_EQ(result.size(), test.byteSize(serializer.get()));
+
+    test.clearTestFieldInt();
+    ASSERT_FALSE(test.hasTestFieldInt());
+    ASSERT_FALSE(test == OptionalMessage());
+    ASSERT_TRUE(test.serialize(serializer.get()) == QByteArray::fromHex("12001d00000000"));
+
+    test.clear();
+    ASSERT_FALSE(test.hasTestFieldString());
+    ASSERT_TRUE(test == OptionalMessage());
+    ASSERT_TRUE(test.serialize(serializer.get()).isEmpty());
+}
+
+TEST_F(SerializationTest, EncodeCacheTest)
+{
+    QProtobufSerializer reference;
+    ASSERT_FALSE(serializer->isEncodeCacheEnabled());
+    serializer->setEncodeCacheEnabled(true);
+
+    RepeatedComplexMessage test;
+    test.setTestRepeatedComplex({QSharedPointer<ComplexMessage>(new ComplexMessage{1, {"one"}}),
+                                 QSharedPointer<ComplexMessage>(new ComplexMessage{2, {"two"}})});
+    QByteArray result = test.serialize(serializer.get());
+    ASSERT_TRUE(result == test.serialize(&reference));
+    ASSERT_TRUE(result == test.serialize(serializer.get()));
+    ASSERT_EQ(result.size(), test.byteSize(serializer.get()));
+
+    //Nested messages changed by their own setters
+    test.testRepeatedComplex().at(1)->setTestFieldInt(42);
+    result = test.serialize(serializer.get());
+    ASSERT_TRUE(result == test.serialize(&reference));
+    test.testRepeatedComplex().at(0)->testComplexField_p()->setTestFieldString("three");
+    result = test.serialize(serializer.get());
+    ASSERT_TRUE(result == test.serialize(&reference));
+    ASSERT_EQ(result.size(), test.byteSize(serializer.get()));
+
+    //Field replaced by setter
+    test.setTestRepeatedComplex({QSharedPointer<ComplexMessage>(new ComplexMessage{3, {"four"}})});
+    ASSERT_TRUE(test.serialize(serializer.get()) == test.serialize(&reference));
+
+    //Cleared and copied messages
+    ComplexMessage complex{5, {"five"}};
+    ASSERT_TRUE(complex.serialize(serializer.get()) == complex.serialize(&reference));
+    complex.clear();
+    ASSERT_TRUE(complex.serialize(serializer.get()).isEmpty());
+    complex = ComplexMessage{6, {"six"}};
+    ASSERT_TRUE(complex.serialize(serializer.get()) == complex.serialize(&reference));
+
+    serializer->clearEncodeCache();
+    ASSERT_TRUE(complex.serialize(serializer.get()) == complex.serialize(&reference));
+}
+
+TEST_F(SerializationTest, ThreadSerializerTest)
+{
+    QProtobufSerializerRegistry &registry = QProtobufSerializerRegistry::instance();
+    ASSERT_TRUE(registry.acquireSerializer("protobuf") != nullptr);
+    ASSERT_TRUE(registry.acquireSerializer("protobuf").get() != registry.findSerializer("protobuf"));
+    ASSERT_TRUE(registry.acquireSerializer("protobuf", "SomePlugin") == nullptr);
+    ASSERT_TRUE(registry.acquireSerializer("SomeName") == nullptr);
+    ASSERT_TRUE(registry.threadSerializer("SomeName") == nullptr);
+
+    QAbstractProtobufSerializer *mainSerializer = registry.threadSerializer("protobuf");
+    ASSERT_TRUE(mainSerializer != nullptr);
+    ASSERT_EQ(mainSerializer, registry.threadSerializer("protobuf"));
+    ASSERT_NE(mainSerializer, registry.threadSerializer("json"));
+
+    RepeatedComplexMessage test;
+    test.setTestRepeatedComplex({QSharedPointer<ComplexMessage>(new ComplexMessage{1, {"one"}}),
+                                 QSharedPointer<ComplexMessage>(new ComplexMessage{2, {"two"}})});
+    const QByteArray expected = test.serialize(serializer.get());
+
+    //Each thread encodes with its own serializer and options
+    std::vector<QAbstractProtobufSerializer *> threadSerializers(4, nullptr);
+    std::vector<int> results(threadSerializers.size(), 0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadSerializers.size(); ++i) {
+        threads.emplace_back([&, i]() {
+            auto threadSerializer = static_cast<QProtobufSerializer *>(QProtobufSerializerRegistry::instance().threadSerializer("protobuf"));
+            threadSerializer->setEncodeCacheEnabled(true);
+            threadSerializers[i] = threadSerializer;
+            bool equal = true;
+            for (int j = 0; j < 100; ++j) {
+                equal = equal && test.serialize(threadSerializer) == expected;
+            }
+            results[i] = equal ? 1 : 0;
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    for (size_t i = 0; i < threadSerializers.size(); ++i) {
+        ASSERT_EQ(1, results[i]);
+        ASSERT_NE(mainSerializer, threadSerializers[i]);
+    }
+    ASSERT_FALSE(static_cast<QProtobufSerializer *>(mainSerializer)->isEncodeCacheEnabled());
+}
+
 TEST_F(SerializationTest, DISABLED_BenchmarkTest)
 {
     qtprotobufnamespace::tests::SimpleIntMessage msg;
@@ -78,3 +78,18 @@ TEST_F(SerializationPluginTest, UnknownPluginLoadedSerializeTest)
 {
     ASSERT_ANY_THROW(QProtobufSerializerRegistry::instance().getSerializer("SomeName", loadedTestPlugin));
 }
+
+TEST_F(SerializationPluginTest, FindSerializerTest)
+{
+    EXPECT_EQ(QProtobufSerializerRegistry::instance().findSerializer(ProtobufSerializator, loadedTestPlugin),
+              serializers[ProtobufSerializator].get());
+    EXPECT_EQ(QProtobufSerializerRegistry::instance().findSerializer(ProtobufSerializator),
+              QProtobufSerializerRegistry::instance().getSerializer(ProtobufSerializator).get());
+    EXPECT_EQ(QProtobufSerializerRegistry::instance().findSerializer("SomeName", loadedTestPlugin), nullptr);
+    EXPECT_EQ(QProtobufSerializerRegistry::instance().findSerializer(ProtobufSerializator, "SomePlugin"), nullptr);
+}
+
+TEST_F(SerializationPluginTest, PreloadPluginsTest)
+{
+    EXPECT_EQ(QProtobufSerializerRegistry::instance().preloadPlugins({Serializationplugin}), QStringList{loadedTestPlugin});
+}
@@ -106,6 +106,41 @@ TEST_F(QtTypesQtCoreTest, QUuidTest)
     EXPECT_TRUE(QUuid("{4bcbcdc3-c5b3-4d34-97fe-af78c825cc7d}") == msg.testField());
 }
 
+TEST_F(QtTypesQtCoreTest, CompactEncodingTest)
+{
+    QtProtobuf::qRegisterProtobufQtTypes(QtProtobuf::QtTypesEncoding::Compact);
+
+    qtprotobufnamespace::qttypes::tests::QCharMessage charMsg;
+    charMsg.setTestField(QChar('q'));
+    EXPECT_TRUE(QByteArray::fromHex("0a021071") == charMsg.serialize(serializer.get()));
+
+    qtprotobufnamespace::qttypes::tests::QUuidMessage uuidMsg;
+    uuidMsg.setTestField(QUuid("{4bcbcdc3-c5b3-4d34-97fe-af78c825cc7d}"));
+    EXPECT_TRUE(QByteArray::fromHex("0a1212104bcbcdc3c5b34d3497feaf78c825cc7d") == uuidMsg.serialize(serializer.get()));
+
+    qtprotobufnamespace::qttypes::tests::QPolygonMessage polygonMsg;
+    polygonMsg.setTestField(QPolygon({QPoint(10, 0), QPoint(20, 20), QPoint(0, 20)}));
+    EXPECT_TRUE(QByteArray::fromHex("0a081206140028280028") == polygonMsg.serialize(serializer.get()));
+
+    qtprotobufnamespace::qttypes::tests::QPolygonFMessage polygonFMsg;
+    polygonFMsg.setTestField(QPolygonF({QPointF(10, 0), QPointF(20, 20)}));
+    EXPECT_TRUE(QByteArray::fromHex("0a2212200000000000002440000000000000000000000000000034400000000000003440") == polygonFMsg.serialize(serializer.get()));
+
+    QtProtobuf::qRegisterProtobufQtTypes();
+
+    polygonFMsg.setTestField({});
+    polygonFMsg.deserialize(serializer.get(), QByteArray::fromHex("0a2212200000000000002440000000000000000000000000000034400000000000003440"));
+    EXPECT_EQ(polygonFMsg.testField(), QPolygonF({QPointF(10, 0), QPointF(20, 20)}));
+
+    charMsg.setTestField({});
+    charMsg.deserialize(serializer.get(), QByteArray::fromHex("0a0310ac41"));
+    EXPECT_TRUE(QChar(8364) == charMsg.testField());
+
+    uuidMsg.setTestField({});
+    uuidMsg.deserialize(serializer.get(), QByteArray::fromHex("0a1212104bcbcdc3c5b34d3497feaf78c825cc7d"));
+    EXPECT_TRUE(QUuid("{4bcbcdc3-c5b3-4d34-97fe-af78c825cc7d}") == uuidMsg.testField());
+}
+
 TEST_F(QtTypesQtCoreTest, QTimeTest)
 {
     assertMessagePropertyRegistered<qtprotobufnamespace::qttypes::tests::QTimeMessage, QTime>(1, "QTime", "testField");
@@ -319,6 +354,40 @@ TEST_F(QtTypesQtCoreTest, QPolygonTest)
     EXPECT_EQ(msg.testField()[2], QPoint(0, 20));
 }
 
+TEST_F(QtTypesQtCoreTest, ZeroComponentsTest)
+{
+    //Zero components are not sent, so they must be restored as zeros by reader
+    qtprotobufnamespace::qttypes::tests::QTimeMessage timeMsg;
+    timeMsg.setTestField(QTime(0, 0));
+    qtprotobufnamespace::qttypes::tests::QTimeMessage timeResult;
+    timeResult.deserialize(serializer.get(), timeMsg.serialize(serializer.get()));
+    EXPECT_EQ(QTime(0, 0), timeResult.testField());
+
+    qtprotobufnamespace::qttypes::tests::QSizeMessage sizeMsg;
+    sizeMsg.setTestField(QSize(0, 7));
+    qtprotobufnamespace::qttypes::tests::QSizeMessage sizeResult;
+    sizeResult.deserialize(serializer.get(), sizeMsg.serialize(serializer.get()));
+    EXPECT_EQ(QSize(0, 7), sizeResult.testField());
+
+    qtprotobufnamespace::qttypes::tests::QPointMessage pointMsg;
+    pointMsg.setTestField(QPoint(0, 5));
+    qtprotobufnamespace::qttypes::tests::QPointMessage pointResult;
+    pointResult.deserialize(serializer.get(), pointMsg.serialize(serializer.get()));
+    EXPECT_EQ(QPoint(0, 5), pointResult.testField());
+
+    qtprotobufnamespace::qttypes::tests::QRectMessage rectMsg;
+    rectMsg.setTestField(QRect(QPoint(0, 0), QSize(500, 0)));
+    qtprotobufnamespace::qttypes::tests::QRectMessage rectResult;
+    rectResult.deserialize(serializer.get(), rectMsg.serialize(serializer.get()));
+    EXPECT_EQ(QRect(QPoint(0, 0), QSize(500, 0)), rectResult.testField());
+
+    qtprotobufnamespace::qttypes::tests::QPolygonMessage polygonMsg;
+    polygonMsg.setTestField(QPolygon({QPoint(0, 0), QPoint(0, 20), QPoint(10, 0)}));
+    qtprotobufnamespace::qttypes::tests::QPolygonMessage polygonResult;
+    polygonResult.deserialize(serializer.get(), polygonMsg.serialize(serializer.get()));
+    EXPECT_EQ(QPolygon({QPoint(0, 0), QPoint(0, 20), QPoint(10, 0)}), polygonResult.testField());
+}
+
 TEST_F(QtTypesQtCoreTest, QPolygonFTest)
 {
     assertMessagePropertyRegistered<qtprotobufnamespace::qttypes::tests::QPolygonFMessage, QPolygonF>(1, "QPolygonF", "testField");
@@ -75,6 +75,18 @@ TEST_F(QtTypesQtGuiTest, QColorTest)
     EXPECT_EQ(QColor("green"), msg.testField());
 }
 
+TEST_F(QtTypesQtGuiTest, QColorZeroTest)
+{
+    //Transparent black is zero rgba value, that is not sent
+    qtprotobufnamespace::qttypes::tests::QColorMessage msg;
+    msg.setTestField(QColor(0, 0, 0, 0));
+
+    qtprotobufnamespace::qttypes::tests::QColorMessage result;
+    result.setTestField(QColor("red"));
+    result.deserialize(serializer.get(), msg.serialize(serializer.get()));
+    EXPECT_EQ(QColor(0, 0, 0, 0), result.testField());
+}
+
 TEST_F(QtTypesQtGuiTest, QMatrix4x4Test)
 {
     assertMessagePropertyRegistered<qtprotobufnamespace::qttypes::tests::QMatrix4x4Message, QMatrix4x4>(1, "QMatrix4x4", "testField");
@@ -195,5 +207,22 @@ TEST_F(QtTypesQtGuiTest, QImageTest)
     msg.deserialize(serializer.get(), result);
     EXPECT_EQ(initialImage, msg.testField());
 }
+
+TEST_F(QtTypesQtGuiTest, QImageRawTest)
+{
+    QtProtobuf::qSetProtobufImageEncoding(QtProtobuf::QtImageEncoding::Raw);
+
+    qtprotobufnamespace::qttypes::tests::QImageMessage msg;
+    QImage initialImage("./testimage.png");
+    msg.setTestField(initialImage);
+
+    auto result = msg.serialize(serializer.get());
+    QtProtobuf::qSetProtobufImageEncoding(QtProtobuf::QtImageEncoding::Png);
+
+    msg.setTestField({});
+    msg.deserialize(serializer.get(), result);
+    EXPECT_EQ(initialImage, msg.testField());
+    EXPECT_EQ(initialImage.format(), msg.testField().format());
+}
 }
 }
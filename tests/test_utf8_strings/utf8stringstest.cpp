@@ -0,0 +1,108 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "utf8strings.qpb.h"
+
+#include <QProtobufSerializer>
+#include <qprotobufjsonserializer.h>
+
+#include <gtest/gtest.h>
+
+using namespace qtprotobufnamespace::utf8strings::tests;
+
+namespace QtProtobuf {
+namespace tests {
+
+class Utf8StringsTest : public ::testing::Test
+{
+public:
+    Utf8StringsTest() = default;
+    void SetUp() override;
+    static void SetUpTestCase();
+protected:
+    std::unique_ptr<QProtobufSerializer> serializer;
+};
+
+void Utf8StringsTest::SetUpTestCase()
+{
+    QtProtobuf::qRegisterProtobufTypes();
+}
+
+void Utf8StringsTest::SetUp()
+{
+    serializer.reset(new QProtobufSerializer);
+}
+
+TEST_F(Utf8StringsTest, FieldTypesTest)
+{
+    ASSERT_TRUE((std::is_same<decltype(User().name()), QtProtobuf::utf8string>::value));
+    //Repeated fields and maps are not affected
+    ASSERT_TRUE((std::is_same<std::decay_t<decltype(User().aliases())>, QStringList>::value));
+    ASSERT_TRUE((std::is_same<std::decay_t<decltype(User().attributes())>, QMap<QString, QString>>::value));
+}
+
+TEST_F(Utf8StringsTest, SerializationTest)
+{
+    User test;
+    test.setName(QString::fromUtf8("Gr\xC3\xBC\xC3\x9F" "e"));
+    test.setId(1);
+    ASSERT_TRUE(test.name() == QByteArray("Gr\xC3\xBC\xC3\x9F" "e"));
+    ASSERT_TRUE(test.serialize(serializer.get()) == QByteArray::fromHex("0a074772c3bcc39f651002"));
+}
+
+TEST_F(Utf8StringsTest, DeserializationTest)
+{
+    User test;
+    test.deserialize(serializer.get(), QByteArray::fromHex("0a074772c3bcc39f651002"));
+    ASSERT_TRUE(test.name() == QByteArray("Gr\xC3\xBC\xC3\x9F" "e"));
+    ASSERT_EQ(QString::fromUtf8("Gr\xC3\xBC\xC3\x9F" "e"), test.name().toString());
+    ASSERT_EQ(1, test.id());
+}
+
+TEST_F(Utf8StringsTest, JsonTest)
+{
+    QProtobufJsonSerializer jsonSerializer;
+    User test;
+    test.setName("say \"hi\"");
+    QByteArray json = test.serialize(&jsonSerializer);
+    ASSERT_TRUE(json.contains("\"name\":\"say \\\"hi\\\"\""));
+
+    User deserialized;
+    deserialized.deserialize(&jsonSerializer, json);
+    ASSERT_TRUE(deserialized.name() == QByteArray("say \"hi\""));
+}
+
+TEST_F(Utf8StringsTest, VariantTest)
+{
+    User test;
+    test.setName("name");
+    //Converter to QString is registered, so meta-object system users get string
+    ASSERT_EQ(QString("name"), test.property("name").toString());
+    ASSERT_TRUE(test.setProperty("name", QString("other")));
+    ASSERT_TRUE(test.name() == "other");
+}
+
+} // tests
+} // QtProtobuf
@@ -0,0 +1,130 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "valuetypes.qpb.h"
+
+#include <QProtobufSerializer>
+
+#include <gtest/gtest.h>
+
+using namespace qtprotobufnamespace::valuetypes::tests;
+
+namespace QtProtobuf {
+namespace tests {
+
+class ValueTypesTest : public ::testing::Test
+{
+public:
+    ValueTypesTest() = default;
+    void SetUp() override;
+    static void SetUpTestCase();
+protected:
+    std::unique_ptr<QProtobufSerializer> serializer;
+};
+
+void ValueTypesTest::SetUpTestCase()
+{
+    QtProtobuf::qRegisterProtobufTypes();
+}
+
+void ValueTypesTest::SetUp()
+{
+    serializer.reset(new QProtobufSerializer);
+}
+
+static PointValue makePoint(sint32 x, sint32 y)
+{
+    PointValue point;
+    point.x = x;
+    point.y = y;
+    return point;
+}
+
+TEST_F(ValueTypesTest, ValueTypeLayoutTest)
+{
+    //Value type contains fields only
+    ASSERT_EQ(2 * sizeof(sint32), sizeof(PointValue));
+    ASSERT_TRUE((std::is_same<std::decay_t<decltype(Polyline().points())>, PointValueRepeated>::value));
+}
+
+TEST_F(ValueTypesTest, ConversionTest)
+{
+    Point message(3, -4);
+    PointValue value(message);
+    ASSERT_EQ(3, value.x);
+    ASSERT_EQ(-4, value.y);
+    ASSERT_TRUE(value == makePoint(3, -4));
+    ASSERT_TRUE(value != makePoint(3, 4));
+
+    Point copy;
+    value.copyTo(copy);
+    ASSERT_TRUE(copy == message);
+}
+
+TEST_F(ValueTypesTest, RepeatedValueSerializationTest)
+{
+    Polyline test;
+    test.setPoints({makePoint(1, -1), makePoint(3, 4)});
+    test.setName("ab");
+    QByteArray result = test.serialize(serializer.get());
+    ASSERT_TRUE(result == QByteArray::fromHex("0a04080210010a040806100812026162"));
+
+    Polyline deserialized;
+    deserialized.deserialize(serializer.get(), result);
+    ASSERT_EQ(2, deserialized.points().count());
+    ASSERT_TRUE(deserialized.points().at(0) == makePoint(1, -1));
+    ASSERT_TRUE(deserialized.points().at(1) == makePoint(3, 4));
+    ASSERT_TRUE(deserialized.name() == QString("ab"));
+    ASSERT_TRUE(deserialized == test);
+
+    //Elements are stored contiguously
+    ASSERT_EQ(&deserialized.points().at(0) + 1, &deserialized.points().at(1));
+}
+
+TEST_F(ValueTypesTest, ValueSerializationTest)
+{
+    QByteArray result = serializer->serializeValue(makePoint(1, -1));
+    ASSERT_TRUE(result == QByteArray::fromHex("08021001"));
+
+    PointValue deserialized = makePoint(5, 5);
+    serializer->deserializeValue(&deserialized, QByteArray::fromHex("1008"));
+    //Fields not stored in data are reset
+    ASSERT_TRUE(deserialized == makePoint(0, 4));
+
+    //Value types are copied and moved without QObject involved
+    ASSERT_TRUE(std::is_nothrow_move_constructible<PointValue>::value);
+    ASSERT_TRUE(std::is_trivially_copyable<PointValue>::value);
+}
+
+TEST_F(ValueTypesTest, SingularMessageFieldTest)
+{
+    //Singular message fields keep using QObject based messages
+    Label test;
+    test.setPosition(Point(1, -1));
+    ASSERT_TRUE(test.serialize(serializer.get()) == QByteArray::fromHex("0a0408021001"));
+}
+
+} // tests
+} // QtProtobuf